@@ -44,14 +44,69 @@ Breakpoint::~Breakpoint()
 	}
 }
 
+BreakpointSet::BreakpointSet(Common::Allocator& allocator)
+: allocator(allocator), codeChanged(false)
+{
+	codeListener = allocator.AddCodeListener([this](uint32_t address, uint32_t size)
+	{
+		CodeChanged(address, size);
+	});
+}
+
+void BreakpointSet::InvalidateCode(Common::UInt32 *location)
+{
+	// the listeners include this set's own, which must not try to take mapMutex again
+	invalidatingThread = this_thread::get_id();
+	allocator.InvalidateCode(allocator.ToIntPtr(location), sizeof *location);
+	invalidatingThread = thread::id();
+}
+
+void BreakpointSet::RestoreOverwrittenTraps(uint32_t address, uint32_t size, bool invalidate)
+{
+	for (auto& pair : breakpoints)
+	{
+		uint32_t location = allocator.ToIntPtr(pair.first);
+		if (location - address >= size || pair.first->Get() == BreakpointTrap)
+			continue;
+		
+		pair.second.first = Instruction(pair.first->Get());
+		*pair.first = BreakpointTrap;
+		if (invalidate)
+			InvalidateCode(pair.first);
+	}
+}
+
+void BreakpointSet::CodeChanged(uint32_t address, uint32_t size)
+{
+	if (invalidatingThread.load() == this_thread::get_id())
+		return;
+	
+	// Waiting for mapMutex here could deadlock with a thread that holds it while it calls the listeners, so whoever
+	// holds it checks every breakpoint next time instead.
+	unique_lock<mutex> lock(mapMutex, try_to_lock);
+	if (!lock.owns_lock())
+	{
+		codeChanged = true;
+		return;
+	}
+	
+	// The listeners are being told about this range already, and the trap goes inside it, so there's nobody else to
+	// tell (and calling the allocator back from a listener would deadlock).
+	RestoreOverwrittenTraps(address, size, false);
+}
+
 void BreakpointSet::SetBreakpoint(Common::UInt32 *location)
 {
 	lock_guard<mutex> guard(mapMutex);
+	if (codeChanged.exchange(false))
+		RestoreOverwrittenTraps(0, UINT32_MAX, true);
+	
 	auto iter = breakpoints.find(location);
 	if (iter == breakpoints.end())
 	{
 		iter = breakpoints.insert(make_pair(location, make_pair(Instruction(location->Get()), 0))).first;
 		*location = BreakpointTrap;
+		InvalidateCode(location);
 	}
 	
 	iter->second.second++;
@@ -60,6 +115,9 @@ void BreakpointSet::SetBreakpoint(Common::UInt32 *location)
 bool BreakpointSet::RemoveBreakpoint(Common::UInt32 *location)
 {
 	lock_guard<mutex> guard(mapMutex);
+	if (codeChanged.exchange(false))
+		RestoreOverwrittenTraps(0, UINT32_MAX, true);
+	
 	auto iter = breakpoints.find(location);
 	if (iter == breakpoints.end())
 		return false;
@@ -68,6 +126,7 @@ bool BreakpointSet::RemoveBreakpoint(Common::UInt32 *location)
 	if (iter->second.second == 0)
 	{
 		*iter->first = iter->second.first.hex;
+		InvalidateCode(iter->first);
 		breakpoints.erase(iter);
 	}
 	return true;
@@ -81,7 +140,10 @@ Breakpoint BreakpointSet::CreateBreakpoint(Common::UInt32 *location)
 BreakpointSet::InhibitedBreakpoints BreakpointSet::InhibitBreakpoints()
 {
 	unique_lock<mutex> lock(mapMutex);
-	return InhibitedBreakpoints(new BreakpointContext(std::move(lock), breakpoints));
+	if (codeChanged.exchange(false))
+		RestoreOverwrittenTraps(0, UINT32_MAX, true);
+	
+	return InhibitedBreakpoints(new BreakpointContext(std::move(lock), *this, breakpoints));
 }
 
 bool BreakpointSet::GetRealInstruction(Common::UInt32 *location, PPCVM::Instruction &output)
@@ -101,19 +163,21 @@ bool BreakpointSet::GetRealInstruction(Common::UInt32 *location, PPCVM::Instruct
 
 BreakpointSet::~BreakpointSet()
 {
+	allocator.RemoveCodeListener(codeListener);
 	for (auto iter = breakpoints.begin(); iter != breakpoints.end(); iter++)
 	{
 		*iter->first = iter->second.first.hex;
 	}
 }
 
-BreakpointSet::BreakpointContext::BreakpointContext(unique_lock<mutex>&& lock, unordered_map<UInt32*, pair<Instruction, unsigned>>& context)
-: lock(std::move(lock)), source(context)
+BreakpointSet::BreakpointContext::BreakpointContext(unique_lock<mutex>&& lock, BreakpointSet& set, unordered_map<UInt32*, pair<Instruction, unsigned>>& context)
+: lock(std::move(lock)), set(set), source(context)
 {
 	breakpoints.swap(source);
 	for (auto iter = breakpoints.begin(); iter != breakpoints.end(); iter++)
 	{
 		*iter->first = iter->second.first.hex;
+		set.InvalidateCode(iter->first);
 	}
 }
 
@@ -122,6 +186,7 @@ BreakpointSet::BreakpointContext::~BreakpointContext()
 	for (auto iter = breakpoints.begin(); iter != breakpoints.end(); iter++)
 	{
 		*iter->first = BreakpointTrap;
+		set.InvalidateCode(iter->first);
 	}
 	source.swap(breakpoints);
 }
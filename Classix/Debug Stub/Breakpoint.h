@@ -9,10 +9,13 @@
 #ifndef __Classix__Breakpoint__
 #define __Classix__Breakpoint__
 
+#include "Allocator.h"
 #include "BigEndian.h"
 #include "Instruction.h"
 
+#include <atomic>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
 
 class BreakpointSet;
@@ -37,24 +40,42 @@ public:
 
 class BreakpointSet
 {
+	Common::Allocator& allocator;
+	size_t codeListener;
 	std::mutex mapMutex;
 	std::unordered_map<Common::UInt32*, std::pair<PPCVM::Instruction, unsigned>> breakpoints;
 	
+	// the thread that holds mapMutex while it tells the allocator's code listeners about a breakpoint
+	std::atomic<std::thread::id> invalidatingThread;
+	// set when code changed while someone else held mapMutex
+	std::atomic<bool> codeChanged;
+	
+	// must be called with mapMutex held
+	void InvalidateCode(Common::UInt32* location);
+	void RestoreOverwrittenTraps(uint32_t address, uint32_t size, bool invalidate);
+	void CodeChanged(uint32_t address, uint32_t size);
+	
 public:
 	class BreakpointContext
 	{
 		friend class BreakpointSet;
 		std::unique_lock<std::mutex> lock;
+		BreakpointSet& set;
 		std::unordered_map<Common::UInt32*, std::pair<PPCVM::Instruction, unsigned>> breakpoints;
 		std::unordered_map<Common::UInt32*, std::pair<PPCVM::Instruction, unsigned>>& source;
 		
-		BreakpointContext(std::unique_lock<std::mutex>&& lock, std::unordered_map<Common::UInt32*, std::pair<PPCVM::Instruction, unsigned>>& context);
+		BreakpointContext(std::unique_lock<std::mutex>&& lock, BreakpointSet& set, std::unordered_map<Common::UInt32*, std::pair<PPCVM::Instruction, unsigned>>& context);
 	public:
 		~BreakpointContext();
 	};
 	
 	typedef std::unique_ptr<BreakpointContext> InhibitedBreakpoints;
 	
+	// Code caches hear about breakpoints through the allocator's code listeners, and so does the set: when the
+	// guest writes over a breakpoint, the new instruction becomes the real one and the trap goes back.
+	explicit BreakpointSet(Common::Allocator& allocator);
+	BreakpointSet(const BreakpointSet& that) = delete;
+	
 	void SetBreakpoint(Common::UInt32* location);
 	bool RemoveBreakpoint(Common::UInt32* location);
 	Breakpoint CreateBreakpoint(Common::UInt32* location);
@@ -175,7 +175,7 @@ void DebugThreadManager::DebugLoop(ThreadContext& context, bool autostart)
 }
 
 DebugThreadManager::DebugThreadManager(Common::Allocator& allocator)
-: allocator(allocator), sink(new WaitQueue<std::string>), lastExitCode(0xeeeeeeee), nextId(0x10), breakpoints(new class BreakpointSet)
+: allocator(allocator), sink(new WaitQueue<std::string>), lastExitCode(0xeeeeeeee), nextId(0x10), breakpoints(new class BreakpointSet(allocator))
 { }
 
 bool DebugThreadManager::IsThreadExecuting() const
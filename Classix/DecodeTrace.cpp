@@ -0,0 +1,92 @@
+//
+// DecodeTrace.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <unordered_map>
+
+#include "ExecutionTrace.h"
+#include "InstructionDecoder.h"
+
+using namespace PPCVM;
+using namespace PPCVM::Execution;
+
+static const char endline = '\n';
+
+// Prints a trace recorded with $CLASSIX_TRACE the way the disassembler prints code.
+int decodeTrace(const std::string& path)
+{
+	std::ifstream input(path, std::ios_base::in | std::ios_base::binary);
+	if (!input)
+	{
+		std::cerr << "Couln't open " << path << endline;
+		return -2;
+	}
+	
+	std::unordered_map<uint64_t, std::string> symbols;
+	TraceRecord record;
+	while (input.read(reinterpret_cast<char*>(&record), sizeof record))
+	{
+		switch (record.Kind)
+		{
+			case TraceRecord::Instruction:
+			{
+				Disassembly::DisassembledOpcode opcode = Disassembly::InstructionDecoder::Decode(Instruction(static_cast<uint32_t>(record.Value)));
+				std::cout << std::setw(8) << std::setfill('0') << std::right << std::hex << record.Address << ' ';
+				std::cout << '\t' << std::setw(12) << std::setfill(' ') << std::left << opcode.Opcode;
+				std::cout << opcode.ArgumentsString() << endline;
+				break;
+			}
+			
+			case TraceRecord::NativeCall:
+			{
+				const std::string& name = symbols[record.Value];
+				std::cout << std::setw(8) << std::setfill('0') << std::right << std::hex << record.Address << ' ';
+				if (name.length() == 0)
+					std::cout << "\t> Calling into unknown native function" << endline;
+				else
+					std::cout << "\t> Calling into [" << name << "]" << endline;
+				break;
+			}
+			
+			case TraceRecord::Thread:
+				std::cout << "--- interpreter " << std::dec << record.Address << endline;
+				break;
+			
+			case TraceRecord::Symbol:
+			{
+				size_t padded = (record.Address + sizeof record - 1) / sizeof record * sizeof record;
+				std::string name(padded, '\0');
+				input.read(&name[0], padded);
+				name.resize(record.Address);
+				symbols[record.Value] = name;
+				break;
+			}
+			
+			default:
+				std::cerr << "Corrupted trace at offset " << std::dec << input.tellg() << endline;
+				return -1;
+		}
+	}
+	return 0;
+}
@@ -106,7 +106,7 @@ int patchExecutable(const std::string& path, const std::string& outPath)
 	
 	PPCVM::Instruction* instructions = allocator.ToPointer<PPCVM::Instruction>(*transitionVectorAddress);
 	PPCVM::Instruction* branch = instructions + 12;
-	if (branch->hex == Common::UInt32::FromBigEndian(0x41820010)) // beq 0x10
+	if (*reinterpret_cast<Common::UInt32*>(branch) == 0x41820010) // beq 0x10
 	{
 		// find the actual offset
 		int sectionIndex = -1;
@@ -132,7 +132,7 @@ int patchExecutable(const std::string& path, const std::string& outPath)
 		
 		PPCVM::Instruction nopBuilder = 0;
 		nopBuilder.OPCD = 24;
-		Common::UInt32 nop = Common::UInt32(nopBuilder.hex);
+		Common::BigEndian::UInt32 nop = Common::BigEndian::UInt32(nopBuilder.hex);
 		
 		off_t beqLocation = container.GetSection(sectionIndex).AbsoluteOffset() + offset;
 		int fd = open(outPath.c_str(), O_CREAT | O_TRUNC | O_WRONLY);
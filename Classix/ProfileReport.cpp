@@ -0,0 +1,210 @@
+//
+// ProfileReport.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <unordered_set>
+
+#include "ProfileReport.h"
+#include "PEFSymbolResolver.h"
+#include "NativeCall.h"
+
+using namespace PPCVM::Execution;
+
+namespace
+{
+	std::string BaseName(const std::string& path)
+	{
+		size_t slash = path.rfind('/');
+		return slash == std::string::npos ? path : path.substr(slash + 1);
+	}
+}
+
+namespace Classix
+{
+	ProfileReport::ProfileReport(Common::Allocator& allocator, CFM::FragmentManager& fragmentManager)
+	: allocator(allocator)
+	{
+		for (auto& pair : fragmentManager)
+		{
+			CFM::PEFSymbolResolver* resolver = dynamic_cast<CFM::PEFSymbolResolver*>(pair.second);
+			if (resolver == nullptr)
+				continue;
+			
+			PEF::Container& container = resolver->GetContainer();
+			std::string fragment = BaseName(pair.first);
+			for (PEF::InstantiableSection& section : container)
+			{
+				if (section.GetSectionType() != PEF::SectionType::Code && section.GetSectionType() != PEF::SectionType::ExecutableData)
+					continue;
+				
+				CodeRange range;
+				range.Begin = section.GetDataLocation();
+				range.End = range.Begin + static_cast<uint32_t>(section.Size());
+				range.Fragment = fragment;
+				ranges.push_back(range);
+			}
+			
+			// exported functions are either code symbols or transition vectors
+			const PEF::ExportHashTable& exportTable = container.LoaderSection()->ExportTable;
+			PEF::ExportedSymbol symbol;
+			for (uint32_t i = 0; exportTable.Find(i, symbol); i++)
+			{
+				if (symbol.SectionIndex < 0)
+					continue;
+				
+				const PEF::InstantiableSection& section = container.GetSection(symbol.SectionIndex);
+				if (symbol.Class == PEF::SymbolClasses::CodeSymbol)
+				{
+					AddFunction(section.GetDataLocation() + symbol.Offset, symbol.SymbolName);
+				}
+				else if (symbol.Class == PEF::SymbolClasses::FunctionPointer && symbol.Offset + 4 <= section.Size())
+				{
+					const Common::UInt32* vector = reinterpret_cast<const Common::UInt32*>(section.Data + symbol.Offset);
+					AddFunction(vector->Get(), symbol.SymbolName);
+				}
+			}
+			
+			for (const CFM::ResolvedSymbol& entryPoint : resolver->GetEntryPoints())
+				AddFunction(allocator.ToPointer<Common::UInt32>(entryPoint.Address)->Get(), entryPoint.Name);
+		}
+	}
+	
+	void ProfileReport::AddFunction(uint32_t address, const std::string& name)
+	{
+		for (CodeRange& range : ranges)
+		{
+			if (address >= range.Begin && address < range.End)
+			{
+				range.Functions[address] = name;
+				return;
+			}
+		}
+	}
+	
+	const std::string& ProfileReport::GuestName(uint32_t address)
+	{
+		auto iter = guestNames.find(address);
+		if (iter != guestNames.end())
+			return iter->second;
+		
+		std::stringstream ss;
+		auto range = std::find_if(ranges.begin(), ranges.end(), [=](const CodeRange& range) {
+			return address >= range.Begin && address < range.End;
+		});
+		
+		if (range == ranges.end())
+		{
+			ss << "0x" << std::hex << std::setw(8) << std::setfill('0') << address;
+		}
+		else
+		{
+			auto function = range->Functions.upper_bound(address);
+			if (function != range->Functions.begin())
+				ss << (--function)->second;
+			else
+				ss << range->Fragment << "+0x" << std::hex << address - range->Begin;
+		}
+		return guestNames[address] = ss.str();
+	}
+	
+	const std::string& ProfileReport::NativeName(const void* callback)
+	{
+		auto iter = nativeNames.find(callback);
+		if (iter != nativeNames.end())
+			return iter->second;
+		
+		std::string name = NativeCallbackName(callback);
+		if (name.length() == 0)
+		{
+			std::stringstream ss;
+			ss << "native " << callback;
+			name = ss.str();
+		}
+		return nativeNames[callback] = name;
+	}
+	
+	std::vector<const std::string*> ProfileReport::Frames(const SamplingProfiler::Sample& sample)
+	{
+		// outermost first
+		std::vector<const std::string*> frames;
+		for (auto iter = sample.Stack.rbegin(); iter != sample.Stack.rend(); iter++)
+			frames.push_back(&GuestName(*iter));
+		
+		if (sample.Native != nullptr)
+			frames.push_back(&NativeName(sample.Native));
+		return frames;
+	}
+	
+	void ProfileReport::WriteFlatProfile(const SampleMap& samples, std::ostream& into)
+	{
+		uint64_t total = 0;
+		std::unordered_map<const std::string*, uint64_t> self;
+		std::unordered_map<const std::string*, uint64_t> inclusive;
+		for (const auto& pair : samples)
+		{
+			std::vector<const std::string*> frames = Frames(pair.first);
+			total += pair.second;
+			self[frames.back()] += pair.second;
+			
+			// recursive functions only count once per sample
+			std::unordered_set<const std::string*> seen(frames.begin(), frames.end());
+			for (const std::string* frame : seen)
+				inclusive[frame] += pair.second;
+		}
+		
+		std::vector<std::pair<const std::string*, uint64_t>> sorted(inclusive.begin(), inclusive.end());
+		std::sort(sorted.begin(), sorted.end(), [&](const std::pair<const std::string*, uint64_t>& a, const std::pair<const std::string*, uint64_t>& b) {
+			return self[a.first] != self[b.first] ? self[a.first] > self[b.first] : a.second > b.second;
+		});
+		
+		into << total << " samples" << std::endl;
+		into << std::setw(10) << "self" << std::setw(8) << "%" << std::setw(10) << "total" << std::setw(8) << "%" << "  function" << std::endl;
+		into << std::fixed << std::setprecision(2);
+		for (const auto& pair : sorted)
+		{
+			uint64_t selfCount = self[pair.first];
+			into << std::setw(10) << selfCount << std::setw(8) << selfCount * 100.0 / total;
+			into << std::setw(10) << pair.second << std::setw(8) << pair.second * 100.0 / total;
+			into << "  " << *pair.first << std::endl;
+		}
+	}
+	
+	void ProfileReport::WriteCollapsedStacks(const SampleMap& samples, std::ostream& into)
+	{
+		std::map<std::string, uint64_t> stacks;
+		for (const auto& pair : samples)
+		{
+			std::string stack;
+			for (const std::string* frame : Frames(pair.first))
+			{
+				if (stack.length() != 0)
+					stack += ';';
+				stack += *frame;
+			}
+			stacks[stack] += pair.second;
+		}
+		
+		for (const auto& pair : stacks)
+			into << pair.first << ' ' << pair.second << std::endl;
+	}
+}
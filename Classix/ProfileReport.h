@@ -0,0 +1,69 @@
+//
+// ProfileReport.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__ProfileReport__
+#define __Classix__ProfileReport__
+
+#include <map>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <unordered_map>
+
+#include "Allocator.h"
+#include "FragmentManager.h"
+#include "SamplingProfiler.h"
+
+namespace Classix
+{
+	// Turns the samples of a SamplingProfiler into a flat profile and a collapsed stack file (the input of
+	// flamegraph.pl). Guest addresses are named after the closest exported function of the fragment that contains
+	// them, or as fragment+offset when there is none. Native calls are named with dladdr.
+	class ProfileReport
+	{
+		struct CodeRange
+		{
+			uint32_t Begin;
+			uint32_t End;
+			std::string Fragment;
+			std::map<uint32_t, std::string> Functions;
+		};
+		
+		Common::Allocator& allocator;
+		std::vector<CodeRange> ranges;
+		std::unordered_map<uint32_t, std::string> guestNames;
+		std::unordered_map<const void*, std::string> nativeNames;
+		
+		void AddFunction(uint32_t address, const std::string& name);
+		const std::string& GuestName(uint32_t address);
+		const std::string& NativeName(const void* callback);
+		std::vector<const std::string*> Frames(const PPCVM::Execution::SamplingProfiler::Sample& sample);
+		
+	public:
+		ProfileReport(Common::Allocator& allocator, CFM::FragmentManager& fragmentManager);
+		
+		typedef std::map<PPCVM::Execution::SamplingProfiler::Sample, uint64_t> SampleMap;
+		void WriteFlatProfile(const SampleMap& samples, std::ostream& into);
+		void WriteCollapsedStacks(const SampleMap& samples, std::ostream& into);
+	};
+}
+
+#endif /* defined(__Classix__ProfileReport__) */
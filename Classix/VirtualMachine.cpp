@@ -21,6 +21,9 @@
 
 #include "VirtualMachine.h"
 #include <unordered_set>
+#include <fstream>
+#include <iostream>
+#include "ProfileReport.h"
 
 namespace Classix
 {
@@ -31,7 +34,10 @@ namespace Classix
 		auto vector = vm.allocator.ToPointer<const PEF::TransitionVector>(symbol.Address);
 		BeginTransition(*vector);
 		vm.state.lr = vm.allocator.ToIntPtr(vm.interpreter.GetEndAddress());
-		vm.interpreter.Execute(vm.allocator.ToPointer<Common::UInt32>(pc));
+		if (vm.UseRecompiler)
+			vm.recompiler.Execute(vm.allocator.ToPointer<Common::UInt32>(pc));
+		else
+			vm.interpreter.Execute(vm.allocator.ToPointer<Common::UInt32>(pc));
 		return vm.state.r3;
 	}
 	
@@ -109,9 +115,73 @@ namespace Classix
 	}
 	
 	VirtualMachine::VirtualMachine(Common::Allocator& allocator, OSEnvironment::Managers& managers)
-	: allocator(allocator), managers(managers), interpreter(allocator, state), pefResolver(allocator, fragmentManager)
+	: allocator(allocator), managers(managers), imageCache(CFM::PrelinkedImageCache::DefaultDirectory()), routineHooks(allocator), pefResolver(allocator, fragmentManager), interpreter(allocator, state), recompiler(allocator, state, interpreter)
 	{
+		UseRecompiler = false;
+		pefResolver.ImageCache = &imageCache;
+		
+		// Statically linked runtime routines run natively when their code is a known build. CLASSIX_ROUTINE_HOOKS (or a
+		// per-user file) lists more builds, and CLASSIX_ROUTINE_HOOKS=0 leaves them all alone.
+		if (CFM::RoutineHooks::Enabled())
+		{
+			routineHooks.Load(CFM::RoutineHooks::DefaultListPath());
+			pefResolver.Hooks = &routineHooks;
+		}
 		AddLibraryResolver(pefResolver);
+		
+		std::string tracePath = PPCVM::Execution::ExecutionTrace::DefaultPath();
+		if (tracePath.length() != 0)
+		{
+			trace.reset(new PPCVM::Execution::ExecutionTrace(tracePath));
+			interpreter.SetTrace(trace.get());
+		}
+		
+		// CLASSIX_PROFILE=path samples the interpreter every millisecond and writes a report when the VM goes away
+		profilePath = PPCVM::Execution::SamplingProfiler::DefaultPath();
+		if (profilePath.length() != 0)
+			profiler.reset(new PPCVM::Execution::SamplingProfiler(interpreter, std::chrono::milliseconds(1)));
+		
+		// CLASSIX_COUNTERS=path counts every instruction and native call, and writes them out when the VM goes away
+		countersPath = PPCVM::Execution::ExecutionCounters::DefaultPath();
+		if (countersPath.length() != 0)
+		{
+			counters.reset(new PPCVM::Execution::ExecutionCounters);
+			interpreter.SetCounters(counters.get());
+		}
+	}
+	
+	VirtualMachine::~VirtualMachine()
+	{
+		if (profiler)
+		{
+			try
+			{
+				WriteProfile();
+			}
+			catch (std::exception& ex)
+			{
+				std::cerr << "could not write profile to " << profilePath << ": " << ex.what() << std::endl;
+			}
+		}
+		
+		if (counters)
+		{
+			interpreter.SetCounters(nullptr);
+			std::ofstream report(countersPath);
+			counters->WriteReport(report);
+		}
+	}
+	
+	void VirtualMachine::WriteProfile()
+	{
+		auto samples = profiler->Stop();
+		ProfileReport report(allocator, fragmentManager);
+		
+		std::ofstream flat(profilePath);
+		report.WriteFlatProfile(samples, flat);
+		
+		std::ofstream collapsed(profilePath + ".folded");
+		report.WriteCollapsedStacks(samples, collapsed);
 	}
 	
 	void VirtualMachine::AddLibraryResolver(CFM::LibraryResolver &resolver)
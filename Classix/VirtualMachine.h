@@ -25,12 +25,17 @@
 #include <deque>
 #include <list>
 #include <algorithm>
+#include <memory>
 
 #include "MachineState.h"
 #include "FragmentManager.h"
 #include "Interpreter.h"
+#include "SamplingProfiler.h"
+#include "Recompiler.h"
 #include "LibraryResolver.h"
 #include "PEFLibraryResolver.h"
+#include "PrelinkedImageCache.h"
+#include "RoutineHooks.h"
 #include "StackPreparator.h"
 #include "Managers.h"
 
@@ -52,11 +57,25 @@ namespace Classix
 		CFM::FragmentManager fragmentManager;
 		
 	private:
+		CFM::PrelinkedImageCache imageCache;
+		CFM::RoutineHooks routineHooks;
 		CFM::PEFLibraryResolver pefResolver;
 		PPCVM::Execution::Interpreter interpreter;
+		PPCVM::Execution::Recompiler recompiler;
+		std::unique_ptr<PPCVM::Execution::ExecutionTrace> trace;
+		std::unique_ptr<PPCVM::Execution::SamplingProfiler> profiler;
+		std::string profilePath;
+		std::unique_ptr<PPCVM::Execution::ExecutionCounters> counters;
+		std::string countersPath;
+		
+		void WriteProfile();
 		
 	public:
+		// when set (and the host supports it), guest code runs through the recompiler instead of the interpreter
+		bool UseRecompiler;
+		
 		VirtualMachine(Common::Allocator& allocator, OSEnvironment::Managers& managers);
+		~VirtualMachine();
 		
 		void AddLibraryResolver(CFM::LibraryResolver& resolver);
 		
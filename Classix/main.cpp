@@ -42,6 +42,7 @@
 #include "BundleLibraryResolver.h"
 #include "VirtualMachine.h"
 #include "NativeAllocator.h"
+#include "FlatAllocator.h"
 #include "FileMapping.h"
 #include "Disassembler.h"
 #include "NativeCall.h"
@@ -78,9 +79,10 @@ static int listExports(const std::string& path)
 	
 	int16_t onlySection = -1;
 	std::vector<Export> exports;
-	for (auto iter = exportTable.begin(); iter != exportTable.end(); iter++)
+	PEF::ExportedSymbol exportedSymbol;
+	for (uint32_t i = 0; exportTable.Find(i, exportedSymbol); i++)
 	{
-		const PEF::ExportedSymbol* symbol = exportTable.Find(*iter);
+		const PEF::ExportedSymbol* symbol = &exportedSymbol;
 		Export e = {
 			.type = classChars[symbol->Class],
 			.name = symbol->SymbolName,
@@ -191,9 +193,21 @@ static int disassemble(const std::string& path)
 	return 0;
 }
 
-static int run(const std::string& path, int argc, const char* argv[], const char* envp[])
+static std::unique_ptr<Common::Allocator> createAllocator()
 {
-	Common::NativeAllocator allocator;
+	// 64-bits hosts can't hand out host pointers as guest addresses, so they get a 4 GB arena instead
+	if (sizeof(void*) == 4)
+		return std::unique_ptr<Common::Allocator>(new Common::NativeAllocator);
+	
+	// CLASSIX_GUARD_PAGES=1 puts a guard page after every allocation, not just the large ones
+	bool guardEverything = getenv("CLASSIX_GUARD_PAGES") != nullptr;
+	return std::unique_ptr<Common::Allocator>(new Common::FlatAllocator(guardEverything));
+}
+
+static int run(const std::string& path, int argc, const char* argv[], const char* envp[], bool useRecompiler)
+{
+	std::unique_ptr<Common::Allocator> allocatorPtr = createAllocator();
+	Common::Allocator& allocator = *allocatorPtr;
 	OSEnvironment::NativeThreadManager threads;
 	OSEnvironment::Managers managers(allocator, threads);
 	CFM::DummyLibraryResolver dummyResolver(allocator);
@@ -224,6 +238,7 @@ static int run(const std::string& path, int argc, const char* argv[], const char
 	vm.AddLibraryResolver(dlfcnResolver);
 	vm.AddLibraryResolver(bundleResolver);
 	vm.AddLibraryResolver(dummyResolver);
+	vm.UseRecompiler = useRecompiler;
 	
 	auto stub = vm.LoadMainContainer(executable);
 	return stub(argc, argv, envp);
@@ -283,6 +298,7 @@ static int inflateAndDump(const std::string& path, const std::string& targetDir)
 }
 
 int compareTrace(const std::string& path, const std::string& tracePath);
+int decodeTrace(const std::string& path);
 
 static int usage()
 {
@@ -290,6 +306,11 @@ static int usage()
 	std::cerr << "       Classix -i file # list imports" << std::endl;
 	std::cerr << "       Classix -d file # disassemble code sections" << std::endl;
 	std::cerr << "       Classix -r file # run the file" << std::endl;
+	std::cerr << "       Classix -j file # run the file with the x86-64 recompiler" << std::endl;
+	std::cerr << "       Classix -t trace # print an execution trace recorded with CLASSIX_TRACE=trace" << std::endl;
+	std::cerr << "with CLASSIX_PROFILE=report, -r writes a sampled profile to report and report.folded" << std::endl;
+	std::cerr << "with CLASSIX_COUNTERS=report, -r writes instruction and native call counts to report" << std::endl;
+	std::cerr << "with CLASSIX_GUARD_PAGES=1, -r catches overruns of small allocations too" << std::endl;
 	std::cerr << "       Classix -b file out-file # patch executable to always call _BreakPoint at start" << std::endl;
 	std::cerr << "       Classix -z file target # dump sections to target directory" << std::endl;
 	std::cerr << "       Classix -c file trace # execute and compare to MacsBug trace" << std::endl;
@@ -312,7 +333,11 @@ int main(int argc, const char* argv[], const char* envp[])
 		else if (mode == "-d")
 			return disassemble(ppcPath);
 		else if (mode == "-r")
-			return run(ppcPath, argc - 2, argv + 2, envp);
+			return run(ppcPath, argc - 2, argv + 2, envp, false);
+		else if (mode == "-j")
+			return run(ppcPath, argc - 2, argv + 2, envp, true);
+		else if (mode == "-t")
+			return decodeTrace(ppcPath);
 		else if (mode == "-s")
 		{
 			const uint16_t port = 25464;
@@ -49,6 +49,8 @@ namespace CFM
 	PEFLibraryResolver::PEFLibraryResolver(Common::Allocator& allocator, FragmentManager& manager)
 	: cfm(manager)
 	, allocator(allocator)
+	, ImageCache(nullptr)
+	, Hooks(nullptr)
 	{ }
 	
 	SymbolResolver* PEFLibraryResolver::ResolveLibrary(const std::string &name)
@@ -60,7 +62,7 @@ namespace CFM
 		Common::FileMapping mapping(file.fd);
 		try
 		{
-			PEFSymbolResolver* resolver = new PEFSymbolResolver(allocator, cfm, std::move(mapping));
+			PEFSymbolResolver* resolver = new PEFSymbolResolver(allocator, cfm, std::move(mapping), ImageCache, Hooks);
 			resolvers.emplace_back(resolver);
 			return resolvers.back().get();
 		}
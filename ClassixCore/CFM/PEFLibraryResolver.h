@@ -31,6 +31,9 @@
 
 namespace CFM
 {
+	class PrelinkedImageCache;
+	class RoutineHooks;
+	
 	class PEFLibraryResolver : public LibraryResolver
 	{
 		FragmentManager& cfm;
@@ -38,6 +41,11 @@ namespace CFM
 		std::deque<std::unique_ptr<PEFSymbolResolver>> resolvers;
 		
 	public:
+		// when set, containers are loaded from and saved to this cache
+		const PrelinkedImageCache* ImageCache;
+		// when set, containers have their runtime routines replaced with these hooks
+		const RoutineHooks* Hooks;
+		
 		PEFLibraryResolver(Common::Allocator& allocator, FragmentManager& manager);
 						   
 		virtual SymbolResolver* ResolveLibrary(const std::string& name) override;
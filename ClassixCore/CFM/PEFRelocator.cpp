@@ -33,13 +33,28 @@ namespace
 namespace CFM
 {
 	PEFRelocator::PEFRelocator(FragmentManager& cfm, Container& container, InstantiableSection& section)
-	: cfm(cfm), fixupSection(section), container(container), loaderSection(*container.LoaderSection())
+	: cfm(cfm), container(container), fixupSection(section), loaderSection(*container.LoaderSection())
 	{
 		data = section.Data;
 		relocAddress = 0;
 		importIndex = 0;
-		sectionC = SectionAddress(container, 0);
-		sectionD = SectionAddress(container, 1);
+		sectionC = 0;
+		sectionD = 1;
+		record = nullptr;
+		recordedSection = 0;
+	}
+	
+	void PEFRelocator::RecordInto(std::vector<RelocatedWord>& words, uint16_t sectionIndex)
+	{
+		record = &words;
+		recordedSection = sectionIndex;
+	}
+	
+	void PEFRelocator::AddSection(uint32_t section)
+	{
+		uint32_t address = SectionAddress(container, section);
+		Record(section, address, false);
+		Add(address);
 	}
 	
 	void PEFRelocator::AddSymbol(uint32_t index)
@@ -55,6 +70,7 @@ namespace CFM
 		if (nativeEndian != 0 && symbol.Universe != SymbolUniverse::PowerPC && symbolHeader.Class == SymbolClasses::CodeSymbol)
 			throw std::logic_error("cannot fixup a non-PPC function whose offset is not 0");
 		
+		Record(index, symbol.Address, true);
 		nativeEndian += symbol.Address;
 		relocValue = nativeEndian;
 		memcpy(&data[relocAddress], &relocValue, sizeof relocValue);
@@ -70,19 +86,18 @@ namespace CFM
 		}
 		else
 		{
-			uint32_t sectionAddress = SectionAddress(container, index);
 			switch (subOpcode)
 			{
 				case 1:
-					sectionC = sectionAddress;
+					sectionC = index;
 					break;
 					
 				case 2:
-					sectionD = sectionAddress;
+					sectionD = index;
 					break;
 					
 				case 3:
-					Add(sectionAddress);
+					AddSection(index);
 					break;
 			}
 		}
@@ -95,21 +110,21 @@ namespace CFM
 		
 		relocAddress += skipCount * 4;
 		for (int i = 0; i < relocCount; i++)
-			Add(sectionD);
+			AddSection(sectionD);
 	}
 	
 	void PEFRelocator::RelocBySectC(uint32_t value)
 	{
 		int runLength = (value & 0x1ff) + 1;
 		for (int i = 0; i < runLength; i++)
-			Add(sectionC);
+			AddSection(sectionC);
 	}
 	
 	void PEFRelocator::RelocBySectD(uint32_t value)
 	{
 		int runLength = (value & 0x1ff) + 1;
 		for (int i = 0; i < runLength; i++)
-			Add(sectionD);
+			AddSection(sectionD);
 	}
 	
 	void PEFRelocator::RelocTVector12(uint32_t value)
@@ -117,8 +132,8 @@ namespace CFM
 		int runLength = (value & 0x1ff) + 1;
 		for (int i = 0; i < runLength; i++)
 		{
-			Add(sectionC);
-			Add(sectionD);
+			AddSection(sectionC);
+			AddSection(sectionD);
 			relocAddress += 4;
 		}
 	}
@@ -128,8 +143,8 @@ namespace CFM
 		int runLength = (value & 0x1ff) + 1;
 		for (int i = 0; i < runLength; i++)
 		{
-			Add(sectionC);
-			Add(sectionD);
+			AddSection(sectionC);
+			AddSection(sectionD);
 		}
 	}
 	
@@ -138,7 +153,7 @@ namespace CFM
 		int runLength = (value & 0x1ff) + 1;
 		for (int i = 0; i < runLength; i++)
 		{
-			Add(sectionD);
+			AddSection(sectionD);
 			relocAddress += 4;
 		}
 	}
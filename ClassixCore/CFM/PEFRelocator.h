@@ -22,6 +22,8 @@
 #ifndef __pefdump__PEFRelocator__
 #define __pefdump__PEFRelocator__
 
+#include <cstring>
+#include <vector>
 #include "FragmentManager.h"
 #include "InstantiableSection.h"
 #include "LoaderSection.h"
@@ -30,6 +32,17 @@ namespace CFM
 {
 	using namespace PEF;
 	
+	// A word that relocation changed, and the address that was added to it. Target is a section index, or an
+	// import index when IsImport is set. Section is the index of the section that contains the word.
+	struct RelocatedWord
+	{
+		uint32_t Offset;
+		uint32_t Target;
+		uint32_t Value;
+		uint16_t Section;
+		uint16_t IsImport;
+	};
+	
 	class PEFRelocator
 	{
 		FragmentManager& cfm;
@@ -43,6 +56,15 @@ namespace CFM
 		uint32_t sectionC;
 		uint32_t sectionD;
 		
+		std::vector<RelocatedWord>* record;
+		uint16_t recordedSection;
+		
+		inline void Record(uint32_t target, uint32_t value, bool isImport)
+		{
+			if (record != nullptr)
+				record->push_back(RelocatedWord { relocAddress, target, value, recordedSection, isImport });
+		}
+		
 		inline void Add(uint32_t value)
 		{
 			Common::UInt32 initialValue;
@@ -61,6 +83,7 @@ namespace CFM
 		}
 		
 		void RelocByIndex(int subOpcode, int index);
+		void AddSection(uint32_t section);
 		void AddSymbol(uint32_t index);
 		
 		void RelocBySectDWithSkip(uint32_t value);
@@ -81,6 +104,8 @@ namespace CFM
 	public:
 		PEFRelocator(FragmentManager& cfm, Container& container, InstantiableSection& section);
 		
+		// appends every word that Execute relocates to words; sectionIndex is the index of the fixed up section
+		void RecordInto(std::vector<RelocatedWord>& words, uint16_t sectionIndex);
 		void Execute(Relocation::iterator begin, Relocation::iterator end);
 	};
 }
@@ -21,10 +21,14 @@
 
 #include <iostream>
 #include <cassert>
+#include <cstring>
 #include <array>
+#include <unordered_map>
 #include "PEFSymbolResolver.h"
 #include "Relocation.h"
 #include "PEFRelocator.h"
+#include "PrelinkedImageCache.h"
+#include "RoutineHooks.h"
 #include "LibraryResolutionException.h"
 
 namespace
@@ -32,10 +36,12 @@ namespace
 	std::vector<std::string> GetSymbolsOfType(const PEF::ExportHashTable& table, CFM::SymbolClasses::Enum type)
 	{
 		std::vector<std::string> list;
-		std::copy_if(table.begin(), table.end(), std::back_inserter(list), [&table, type](const std::string& symbol)
+		PEF::ExportedSymbol symbol;
+		for (uint32_t i = 0; table.Find(i, symbol); i++)
 		{
-			 return table.Find(symbol)->Class == type;
-		});
+			if (symbol.Class == type)
+				list.push_back(std::move(symbol.SymbolName));
+		}
 		return list;
 	}
 }
@@ -46,11 +52,13 @@ namespace CFM
 	: PEFSymbolResolver(allocator, cfm, Common::FileMapping(filePath))
 	{ }
 	
-	PEFSymbolResolver::PEFSymbolResolver(Common::Allocator& allocator, FragmentManager& cfm, Common::FileMapping&& mapping)
-	: mapping(std::move(mapping))
-	, allocator(allocator)
-	, container(allocator, this->mapping.begin(), this->mapping.end())
+	PEFSymbolResolver::PEFSymbolResolver(Common::Allocator& allocator, FragmentManager& cfm, Common::FileMapping&& mapping, const PrelinkedImageCache* imageCache, const RoutineHooks* hooks)
+	: allocator(allocator)
 	, cfm(cfm)
+	, mapping(std::move(mapping))
+	, imageCache(imageCache)
+	, prelinked(imageCache == nullptr ? nullptr : imageCache->Load(this->mapping))
+	, container(allocator, this->mapping.begin(), this->mapping.end(), prelinked ? &prelinked->GetSections() : nullptr)
 	{
 		// perform fixup
 		const LoaderSection* loaderSection = container.LoaderSection();
@@ -61,13 +69,84 @@ namespace CFM
 				throw LibraryResolutionException(iter->Name);
 		}
 		
+		std::vector<RelocatedWord> words;
+		if (prelinked)
+		{
+			// the sections are already relocated; only the words that point to something that moved need fixing
+			bool moved = Rebind(words);
+			prelinked.reset();
+			if (moved)
+				imageCache->Store(this->mapping, container, words);
+			if (hooks != nullptr)
+				hooks->Patch(container);
+			return;
+		}
+		
 		for (auto iter = loaderSection->RelocationsBegin(); iter != loaderSection->RelocationsEnd(); iter++)
 		{
 			const auto& relocation = *iter;
 			InstantiableSection& section = container.GetSection(relocation.GetSectionIndex());
 			PEFRelocator relocator(cfm, container, section);
+			if (imageCache != nullptr)
+				relocator.RecordInto(words, relocation.GetSectionIndex());
 			relocator.Execute(iter->begin(), iter->end());
 		}
+		
+		if (imageCache != nullptr)
+			imageCache->Store(this->mapping, container, words);
+		
+		// after the image is stored, since native calls hold host addresses
+		if (hooks != nullptr)
+			hooks->Patch(container);
+	}
+	
+	bool PEFSymbolResolver::Rebind(std::vector<RelocatedWord>& words)
+	{
+		const LoaderSection* loaderSection = container.LoaderSection();
+		std::unordered_map<uint32_t, uint32_t> importAddresses;
+		bool moved = false;
+		
+		words.reserve(prelinked->WordsEnd() - prelinked->WordsBegin());
+		for (auto iter = prelinked->WordsBegin(); iter != prelinked->WordsEnd(); iter++)
+		{
+			RelocatedWord word = *iter;
+			uint32_t address;
+			if (word.IsImport)
+			{
+				auto importIter = importAddresses.find(word.Target);
+				if (importIter == importAddresses.end())
+				{
+					const ImportedSymbol& symbol = loaderSection->GetSymbol(word.Target);
+					address = cfm.ResolveSymbol(symbol.LibraryName, symbol.Name).Address;
+					importAddresses[word.Target] = address;
+				}
+				else
+				{
+					address = importIter->second;
+				}
+			}
+			else
+			{
+				address = container.GetSection(word.Target).GetDataLocation();
+			}
+			
+			if (address != word.Value)
+			{
+				// relocation only ever adds addresses, so the difference is all that needs to be applied
+				uint8_t* data = container.GetSection(word.Section).Data + word.Offset;
+				Common::UInt32 value;
+				memcpy(&value, data, sizeof value);
+				uint32_t nativeEndian = value;
+				nativeEndian += address - word.Value;
+				value = nativeEndian;
+				memcpy(data, &value, sizeof value);
+				
+				word.Value = address;
+				moved = true;
+			}
+			words.push_back(word);
+		}
+		return moved;
 	}
 	
 	ResolvedSymbol PEFSymbolResolver::Symbolize(const std::string& name, const uint8_t *address) const
@@ -131,27 +210,27 @@ namespace CFM
 	
 	ResolvedSymbol PEFSymbolResolver::ResolveSymbol(const std::string &symbolName)
 	{
-		const ExportedSymbol* symbol = container.LoaderSection()->ExportTable.Find(symbolName);
-		if (symbol != nullptr)
+		ExportedSymbol symbol;
+		if (container.LoaderSection()->ExportTable.Find(symbolName, symbol))
 		{
 			// section 0-n: address relative to section
-			if (symbol->SectionIndex > -1)
+			if (symbol.SectionIndex > -1)
 			{
-				const uint8_t* address = container.GetSection(symbol->SectionIndex).Data + symbol->Offset;
+				const uint8_t* address = container.GetSection(symbol.SectionIndex).Data + symbol.Offset;
 				return Symbolize(symbolName, address);
 			}
 			
 			// section -2: address absolute to container
-			if (symbol->SectionIndex == -2)
+			if (symbol.SectionIndex == -2)
 			{
-				const uint8_t* address = container.Base + symbol->Offset;
+				const uint8_t* address = container.Base + symbol.Offset;
 				return Symbolize(symbolName, address);
 			}
 			
 			// section -3: reexported symbol
-			if (symbol->SectionIndex == -3)
+			if (symbol.SectionIndex == -3)
 			{
-				const ImportedSymbol& importedSymbol = container.LoaderSection()->GetSymbol(symbol->Offset);
+				const ImportedSymbol& importedSymbol = container.LoaderSection()->GetSymbol(symbol.Offset);
 				return cfm.ResolveSymbol(importedSymbol.LibraryName, importedSymbol.Name);
 			}
 		}
@@ -22,6 +22,7 @@
 #ifndef __pefdump__PEFSymbolResolver__
 #define __pefdump__PEFSymbolResolver__
 
+#include <memory>
 #include "SymbolResolver.h"
 #include "Container.h"
 #include "FileMapping.h"
@@ -29,20 +30,28 @@
 
 namespace CFM
 {
+	struct RelocatedWord;
+	class PrelinkedImage;
+	class PrelinkedImageCache;
+	class RoutineHooks;
+	
 	class PEFSymbolResolver : public SymbolResolver
 	{
 		Common::Allocator& allocator;
 		FragmentManager& cfm;
 		
 		Common::FileMapping mapping;
+		const PrelinkedImageCache* imageCache;
+		std::unique_ptr<PrelinkedImage> prelinked;
 		PEF::Container container;
 		
+		bool Rebind(std::vector<RelocatedWord>& words);
 		ResolvedSymbol Symbolize(const std::string& name, const uint8_t* address) const;
 		ResolvedSymbol Symbolize(const std::string& name, const PEF::LoaderHeader::SectionWithOffset& sectionWithOffset) const;
 		
 	public:
 		PEFSymbolResolver(Common::Allocator& allocator, FragmentManager& cfm, const std::string& filePath);
-		PEFSymbolResolver(Common::Allocator& allocator, FragmentManager& cfm, Common::FileMapping&& mapping);
+		PEFSymbolResolver(Common::Allocator& allocator, FragmentManager& cfm, Common::FileMapping&& mapping, const PrelinkedImageCache* imageCache = nullptr, const RoutineHooks* hooks = nullptr);
 		
 		PEF::Container& GetContainer();
 		const PEF::Container& GetContainer() const;
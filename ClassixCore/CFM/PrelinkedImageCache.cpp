@@ -0,0 +1,245 @@
+//
+// PrelinkedImageCache.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "PrelinkedImageCache.h"
+#include "GuestLayout.h"
+
+namespace
+{
+	const char Magic[8] = {'C', 'X', 'P', 'R', 'E', 'L', 'N', 'K'};
+	// section images are stored in guest layout, so swizzled builds can't share entries with the others
+	const uint32_t Version = Common::GuestLayout::Swizzled ? 0x80000001 : 1;
+	
+	// entries are only ever read by the host that wrote them, so everything is in host byte order
+	struct EntryHeader
+	{
+		char Magic[8];
+		uint32_t Version;
+		uint32_t SectionCount;
+		uint64_t ContainerHash;
+		uint64_t ContainerSize;
+		uint32_t WordCount;
+		uint32_t Reserved;
+	};
+	
+	struct EntrySection
+	{
+		uint64_t Offset;
+		uint64_t Size;
+	};
+	
+	// FNV-1a
+	uint64_t Hash(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+	
+	uint64_t Hash(const Common::FileMapping& mapping)
+	{
+		return Hash(mapping.begin(), static_cast<size_t>(mapping.size()));
+	}
+	
+	bool CreateDirectories(const std::string& path)
+	{
+		for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1))
+		{
+			std::string prefix = path.substr(0, slash);
+			if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST)
+				return false;
+			
+			if (slash == std::string::npos)
+				return true;
+		}
+	}
+	
+	inline uint64_t Align(uint64_t offset)
+	{
+		return (offset + 15) & ~15ull;
+	}
+}
+
+namespace CFM
+{
+	PrelinkedImage::PrelinkedImage(const std::string& path)
+	: mapping(path)
+	{
+		const uint8_t* begin = static_cast<const uint8_t*>(mapping.begin());
+		uint64_t size = static_cast<uint64_t>(mapping.size());
+		
+		const EntryHeader* header = reinterpret_cast<const EntryHeader*>(begin);
+		if (size < sizeof *header || memcmp(header->Magic, Magic, sizeof Magic) != 0 || header->Version != Version)
+			throw std::logic_error("not a prelinked image");
+		
+		const EntrySection* sectionTable = reinterpret_cast<const EntrySection*>(header + 1);
+		wordsBegin = reinterpret_cast<const RelocatedWord*>(sectionTable + header->SectionCount);
+		wordsEnd = wordsBegin + header->WordCount;
+		if (reinterpret_cast<const uint8_t*>(wordsEnd) > begin + size)
+			throw std::logic_error("truncated prelinked image");
+		
+		for (uint32_t i = 0; i < header->SectionCount; i++)
+		{
+			const EntrySection& section = sectionTable[i];
+			if (section.Offset > size || section.Size > size - section.Offset)
+				throw std::logic_error("truncated prelinked image");
+			sections.push_back(begin + section.Offset);
+		}
+		
+		containerHash = header->ContainerHash;
+		containerSize = header->ContainerSize;
+	}
+	
+	const std::vector<const uint8_t*>& PrelinkedImage::GetSections() const
+	{
+		return sections;
+	}
+	
+	const RelocatedWord* PrelinkedImage::WordsBegin() const
+	{
+		return wordsBegin;
+	}
+	
+	const RelocatedWord* PrelinkedImage::WordsEnd() const
+	{
+		return wordsEnd;
+	}
+	
+	std::string PrelinkedImageCache::DefaultDirectory()
+	{
+		if (const char* directory = getenv("CLASSIX_PRELINK_CACHE"))
+			return directory;
+		
+		const char* home = getenv("HOME");
+		if (home == nullptr)
+			return "";
+		
+#ifdef __APPLE__
+		return std::string(home) + "/Library/Caches/Classix/Prelinked";
+#else
+		if (const char* cacheHome = getenv("XDG_CACHE_HOME"))
+			return std::string(cacheHome) + "/classix/prelinked";
+		return std::string(home) + "/.cache/classix/prelinked";
+#endif
+	}
+	
+	PrelinkedImageCache::PrelinkedImageCache(const std::string& directory)
+	: directory(directory)
+	{ }
+	
+	std::string PrelinkedImageCache::EntryPath(const std::string& containerPath) const
+	{
+		std::stringstream ss;
+		ss << directory << '/' << std::hex << std::setw(16) << std::setfill('0');
+		ss << Hash(containerPath.data(), containerPath.size()) << ".prelinked";
+		return ss.str();
+	}
+	
+	std::unique_ptr<PrelinkedImage> PrelinkedImageCache::Load(const Common::FileMapping& containerMapping) const
+	{
+		if (directory.length() == 0 || containerMapping.path().length() == 0)
+			return nullptr;
+		
+		std::unique_ptr<PrelinkedImage> image;
+		try
+		{
+			image.reset(new PrelinkedImage(EntryPath(containerMapping.path())));
+		}
+		catch (std::logic_error&)
+		{
+			// no entry, or an unusable one; either way, the next Store replaces it
+			return nullptr;
+		}
+		
+		uint64_t size = static_cast<uint64_t>(containerMapping.size());
+		if (image->containerSize != size || image->containerHash != Hash(containerMapping))
+			return nullptr;
+		
+		return image;
+	}
+	
+	void PrelinkedImageCache::Store(const Common::FileMapping& containerMapping, const PEF::Container& container, const std::vector<RelocatedWord>& words) const
+	{
+		if (directory.length() == 0 || containerMapping.path().length() == 0)
+			return;
+		
+		if (!CreateDirectories(directory))
+			return;
+		
+		EntryHeader header;
+		memcpy(header.Magic, Magic, sizeof Magic);
+		header.Version = Version;
+		header.SectionCount = static_cast<uint32_t>(container.size());
+		header.ContainerHash = Hash(containerMapping);
+		header.ContainerSize = static_cast<uint64_t>(containerMapping.size());
+		header.WordCount = static_cast<uint32_t>(words.size());
+		header.Reserved = 0;
+		
+		std::vector<EntrySection> sectionTable;
+		uint64_t offset = sizeof header + header.SectionCount * sizeof(EntrySection) + words.size() * sizeof(RelocatedWord);
+		for (const PEF::InstantiableSection& section : container)
+		{
+			offset = Align(offset);
+			sectionTable.push_back(EntrySection { offset, section.Size() });
+			offset += section.Size();
+		}
+		
+		// write to a temporary file and move it in place, so that a concurrent Load never sees a partial entry
+		std::string path = EntryPath(containerMapping.path());
+		std::stringstream temporaryPath;
+		temporaryPath << path << '.' << getpid();
+		
+		std::ofstream file(temporaryPath.str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof header);
+		file.write(reinterpret_cast<const char*>(sectionTable.data()), sectionTable.size() * sizeof(EntrySection));
+		file.write(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(RelocatedWord));
+		
+		size_t index = 0;
+		for (const PEF::InstantiableSection& section : container)
+		{
+			static const char padding[16] = {0};
+			uint64_t position = static_cast<uint64_t>(file.tellp());
+			file.write(padding, sectionTable[index].Offset - position);
+			file.write(reinterpret_cast<const char*>(section.Data), section.Size());
+			index++;
+		}
+		file.close();
+		
+		if (!file || rename(temporaryPath.str().c_str(), path.c_str()) != 0)
+			unlink(temporaryPath.str().c_str());
+	}
+}
@@ -0,0 +1,81 @@
+//
+// PrelinkedImageCache.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef __Classix__PrelinkedImageCache__
+#define __Classix__PrelinkedImageCache__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FileMapping.h"
+#include "Container.h"
+#include "PEFRelocator.h"
+
+namespace CFM
+{
+	// The instantiated and relocated sections of a container, as they were the last time it was loaded, along
+	// with every word that relocation touched. The words say which section or import they point to, and what its
+	// address was then, so that they can be rebound if anything ended up somewhere else this time around.
+	class PrelinkedImage
+	{
+		friend class PrelinkedImageCache;
+		
+		Common::FileMapping mapping;
+		std::vector<const uint8_t*> sections;
+		const RelocatedWord* wordsBegin;
+		const RelocatedWord* wordsEnd;
+		uint64_t containerHash;
+		uint64_t containerSize;
+		
+		explicit PrelinkedImage(const std::string& path);
+		
+	public:
+		// images of the instantiable sections, in the same order as the Container iterates over them
+		const std::vector<const uint8_t*>& GetSections() const;
+		
+		const RelocatedWord* WordsBegin() const;
+		const RelocatedWord* WordsEnd() const;
+	};
+	
+	// On-disk cache of prelinked images, with one file per container path. An entry is only used if the container
+	// hashes the same as it did when the entry was written, and is otherwise replaced the next time the container
+	// is linked. Entries don't depend on the libraries that the container links against: the imports are bound
+	// again when an entry is loaded, and the words that refer to them are fixed up if they moved.
+	class PrelinkedImageCache
+	{
+		std::string directory;
+		
+		std::string EntryPath(const std::string& containerPath) const;
+		
+	public:
+		// $CLASSIX_PRELINK_CACHE if it is set (an empty value disables the cache), or a per-user cache directory
+		static std::string DefaultDirectory();
+		
+		explicit PrelinkedImageCache(const std::string& directory);
+		
+		std::unique_ptr<PrelinkedImage> Load(const Common::FileMapping& containerMapping) const;
+		void Store(const Common::FileMapping& containerMapping, const PEF::Container& container, const std::vector<RelocatedWord>& words) const;
+	};
+}
+
+#endif /* defined(__Classix__PrelinkedImageCache__) */
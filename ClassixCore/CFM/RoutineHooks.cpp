@@ -0,0 +1,679 @@
+//
+// RoutineHooks.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+#include "RoutineHooks.h"
+#include "GuestLayout.h"
+
+using PPCVM::MachineState;
+using PPCVM::Execution::NativeCall;
+using namespace Common;
+
+namespace
+{
+	// The traceback table that follows a routine, after a zero word:
+	//	+0	version (0), language, and 6 bytes of flags, followed by optional fields:
+	//	parameter info (if there are parameters), the offset of the table from the start of the routine (if
+	//	has_tboff), the interrupt handler mask (if int_hndl), the controlled storage info (if has_ctl, a count and
+	//	that many words) and the name (if name_present, a 16-bit length and the characters).
+	const uint8_t LastLanguage = 12; // assembly
+	const uint8_t HasTableOffset = 0x20; // in byte 2
+	const uint8_t HasControlledStorage = 0x08; // in byte 2
+	const uint8_t IsInterruptHandler = 0x80; // in byte 3
+	const uint8_t NamePresent = 0x40; // in byte 3
+	
+	struct TracebackTable
+	{
+		uint32_t Start; // offset of the routine in its section
+		uint32_t Size;
+		std::string Name;
+	};
+	
+	inline uint8_t ByteAt(const uint8_t* data, uint32_t offset)
+	{
+		return *GuestLayout::Byte(data + offset);
+	}
+	
+	inline uint32_t WordAt(const uint8_t* data, uint32_t offset)
+	{
+		return reinterpret_cast<const UInt32*>(data + offset)->Get();
+	}
+	
+	// table is the offset of the zero word that starts the table
+	bool ReadTracebackTable(const uint8_t* data, uint32_t size, uint32_t table, TracebackTable& traceback)
+	{
+		uint32_t offset = table + 4;
+		if (offset + 8 > size || ByteAt(data, offset) != 0 || ByteAt(data, offset + 1) > LastLanguage)
+			return false;
+		
+		uint8_t flags2 = ByteAt(data, offset + 2);
+		uint8_t flags3 = ByteAt(data, offset + 3);
+		uint8_t fixedParameters = ByteAt(data, offset + 6);
+		uint8_t floatParameters = ByteAt(data, offset + 7) >> 1;
+		offset += 8;
+		
+		// without the offset, there's no telling where the routine starts
+		if ((flags2 & HasTableOffset) == 0)
+			return false;
+		
+		if (fixedParameters != 0 || floatParameters != 0)
+			offset += 4;
+		
+		if (offset + 4 > size)
+			return false;
+		
+		uint32_t tableOffset = WordAt(data, offset);
+		offset += 4;
+		if (tableOffset == 0 || tableOffset > table || (tableOffset & 3) != 0)
+			return false;
+		
+		traceback.Start = table - tableOffset;
+		traceback.Size = tableOffset;
+		traceback.Name.clear();
+		
+		if (flags3 & IsInterruptHandler)
+			offset += 4;
+		
+		if (flags2 & HasControlledStorage)
+		{
+			if (offset + 4 > size)
+				return false;
+			offset += 4 + WordAt(data, offset) * 4;
+		}
+		
+		if (flags3 & NamePresent)
+		{
+			if (offset + 2 > size)
+				return false;
+			
+			uint32_t length = (ByteAt(data, offset) << 8) | ByteAt(data, offset + 1);
+			offset += 2;
+			if (offset + length > size)
+				return false;
+			
+			for (uint32_t i = 0; i < length; i++)
+				traceback.Name.push_back(static_cast<char>(ByteAt(data, offset + i)));
+			
+			// XCOFF tools put a dot in front of the names of code symbols
+			if (traceback.Name.length() != 0 && traceback.Name[0] == '.')
+				traceback.Name.erase(0, 1);
+		}
+		return true;
+	}
+	
+#pragma mark -
+#pragma mark Bundled Hooks
+	typedef void Implementation(Allocator& memory, MachineState* state);
+	
+	template<Implementation& Function>
+	void Bundled(void* globals, MachineState* state)
+	{
+		CFM::RoutineHooks::Globals::RestoreTOC(state);
+		Function(static_cast<CFM::RoutineHooks::Globals*>(globals)->Allocator, state);
+	}
+	
+	template<typename T>
+	inline T* Guest(Allocator& memory, uint32_t address)
+	{
+		return memory.ToPointer<T>(address);
+	}
+	
+	inline uint8_t LoadByte(Allocator& memory, uint32_t address)
+	{
+		return *GuestLayout::Byte(Guest<uint8_t>(memory, address));
+	}
+	
+	inline void StoreByte(Allocator& memory, uint32_t address, uint8_t value)
+	{
+		*GuestLayout::Byte(Guest<uint8_t>(memory, address)) = value;
+	}
+	
+	// Strings and buffers are byte sequences, which only the unswizzled layout can hand to the C library. The
+	// swizzled layout goes one byte at a time, which is still a lot faster than interpreting the routine.
+	void MoveBytes(Allocator& memory, uint32_t to, uint32_t from, uint32_t size)
+	{
+		if (!GuestLayout::Swizzled)
+		{
+			memmove(Guest<uint8_t>(memory, to), Guest<uint8_t>(memory, from), size);
+		}
+		else if (to < from)
+		{
+			for (uint32_t i = 0; i < size; i++)
+				StoreByte(memory, to + i, LoadByte(memory, from + i));
+		}
+		else
+		{
+			for (uint32_t i = size; i > 0; i--)
+				StoreByte(memory, to + i - 1, LoadByte(memory, from + i - 1));
+		}
+	}
+	
+	uint32_t StringLength(Allocator& memory, uint32_t string)
+	{
+		if (!GuestLayout::Swizzled)
+			return static_cast<uint32_t>(strlen(Guest<const char>(memory, string)));
+		
+		uint32_t length = 0;
+		while (LoadByte(memory, string + length) != 0)
+			length++;
+		return length;
+	}
+	
+	int CompareBytes(Allocator& memory, uint32_t a, uint32_t b, uint32_t size, bool stopAtZero)
+	{
+		for (uint32_t i = 0; i < size; i++)
+		{
+			uint8_t left = LoadByte(memory, a + i);
+			uint8_t right = LoadByte(memory, b + i);
+			if (left != right)
+				return left < right ? -1 : 1;
+			if (stopAtZero && left == 0)
+				break;
+		}
+		return 0;
+	}
+	
+	void Hook_memcpy(Allocator& memory, MachineState* state)
+	{
+		MoveBytes(memory, state->r3, state->r4, state->r5);
+	}
+	
+	void Hook_memset(Allocator& memory, MachineState* state)
+	{
+		if (!GuestLayout::Swizzled)
+		{
+			memset(Guest<uint8_t>(memory, state->r3), static_cast<uint8_t>(state->r4), state->r5);
+			return;
+		}
+		
+		for (uint32_t i = 0; i < state->r5; i++)
+			StoreByte(memory, state->r3 + i, static_cast<uint8_t>(state->r4));
+	}
+	
+	void Hook_memcmp(Allocator& memory, MachineState* state)
+	{
+		if (!GuestLayout::Swizzled)
+			state->r3 = memcmp(Guest<const uint8_t>(memory, state->r3), Guest<const uint8_t>(memory, state->r4), state->r5);
+		else
+			state->r3 = CompareBytes(memory, state->r3, state->r4, state->r5, false);
+	}
+	
+	void Hook_memchr(Allocator& memory, MachineState* state)
+	{
+		uint8_t target = static_cast<uint8_t>(state->r4);
+		if (!GuestLayout::Swizzled)
+		{
+			const void* match = memchr(Guest<const uint8_t>(memory, state->r3), target, state->r5);
+			state->r3 = match == nullptr ? 0 : memory.ToIntPtr(match);
+			return;
+		}
+		
+		for (uint32_t i = 0; i < state->r5; i++)
+		{
+			if (LoadByte(memory, state->r3 + i) == target)
+			{
+				state->r3 += i;
+				return;
+			}
+		}
+		state->r3 = 0;
+	}
+	
+	void Hook_strlen(Allocator& memory, MachineState* state)
+	{
+		state->r3 = StringLength(memory, state->r3);
+	}
+	
+	void Hook_strcpy(Allocator& memory, MachineState* state)
+	{
+		MoveBytes(memory, state->r3, state->r4, StringLength(memory, state->r4) + 1);
+	}
+	
+	void Hook_strncpy(Allocator& memory, MachineState* state)
+	{
+		uint32_t length = 0;
+		while (length < state->r5 && LoadByte(memory, state->r4 + length) != 0)
+			length++;
+		
+		MoveBytes(memory, state->r3, state->r4, length);
+		for (uint32_t i = length; i < state->r5; i++)
+			StoreByte(memory, state->r3 + i, 0);
+	}
+	
+	void Hook_strcat(Allocator& memory, MachineState* state)
+	{
+		MoveBytes(memory, state->r3 + StringLength(memory, state->r3), state->r4, StringLength(memory, state->r4) + 1);
+	}
+	
+	void Hook_strcmp(Allocator& memory, MachineState* state)
+	{
+		if (!GuestLayout::Swizzled)
+			state->r3 = strcmp(Guest<const char>(memory, state->r3), Guest<const char>(memory, state->r4));
+		else
+			state->r3 = CompareBytes(memory, state->r3, state->r4, UINT32_MAX, true);
+	}
+	
+	void Hook_strncmp(Allocator& memory, MachineState* state)
+	{
+		state->r3 = CompareBytes(memory, state->r3, state->r4, state->r5, true);
+	}
+	
+	void Hook_strchr(Allocator& memory, MachineState* state)
+	{
+		char target = static_cast<char>(state->r4);
+		for (uint32_t address = state->r3; ; address++)
+		{
+			char c = static_cast<char>(LoadByte(memory, address));
+			if (c == target)
+			{
+				state->r3 = address;
+				return;
+			}
+			if (c == 0)
+				break;
+		}
+		state->r3 = 0;
+	}
+	
+	// SANE and MathLib helpers take their arguments in f1 and f2, and return in f1. Floating-point arguments also
+	// use up general registers, so an integer after a double comes in r5.
+	void Hook_sqrt(Allocator&, MachineState* state)
+	{
+		state->fpr[1] = sqrt(state->fpr[1]);
+	}
+	
+	void Hook_fabs(Allocator&, MachineState* state)
+	{
+		state->fpr[1] = fabs(state->fpr[1]);
+	}
+	
+	void Hook_floor(Allocator&, MachineState* state)
+	{
+		state->fpr[1] = floor(state->fpr[1]);
+	}
+	
+	void Hook_ceil(Allocator&, MachineState* state)
+	{
+		state->fpr[1] = ceil(state->fpr[1]);
+	}
+	
+	void Hook_trunc(Allocator&, MachineState* state)
+	{
+		state->fpr[1] = trunc(state->fpr[1]);
+	}
+	
+	void Hook_fmod(Allocator&, MachineState* state)
+	{
+		state->fpr[1] = fmod(state->fpr[1], state->fpr[2]);
+	}
+	
+	void Hook_copysign(Allocator&, MachineState* state)
+	{
+		state->fpr[1] = copysign(state->fpr[1], state->fpr[2]);
+	}
+	
+	void Hook_scalb(Allocator&, MachineState* state)
+	{
+		state->fpr[1] = scalbn(state->fpr[1], static_cast<int32_t>(state->r5));
+	}
+	
+	void Hook_logb(Allocator&, MachineState* state)
+	{
+		state->fpr[1] = logb(state->fpr[1]);
+	}
+	
+#pragma mark -
+#pragma mark Known Routines
+	// Builds of runtime routines that are known to do what their bundled hook does, so that programs don't need a
+	// list of their own. These are the plain byte-at-a-time leaf builds, and their hashes are taken from the code
+	// below when the hooks are made. Other builds get their list line printed, and CLASSIX_ROUTINE_HOOKS or the
+	// per-user list can add them.
+	// FNV-1a, over the bytes of each word from the most significant one
+	const uint64_t HashBasis = 0xcbf29ce484222325ull;
+	
+	inline uint64_t HashWord(uint64_t hash, uint32_t word)
+	{
+		for (int shift = 24; shift >= 0; shift -= 8)
+		{
+			hash ^= (word >> shift) & 0xff;
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+	
+	struct KnownRoutine
+	{
+		const char* Name;
+		const uint32_t* Code;
+		uint32_t Count;
+	};
+	
+	const uint32_t memcpyCode[] = {
+		0x28050000,	// cmplwi r5, 0
+		0x7c661b78,	// mr r6, r3
+		0x4d820020,	// beqlr
+		0x7ca903a6,	// mtctr r5
+		0x3884ffff,	// addi r4, r4, -1
+		0x38c6ffff,	// addi r6, r6, -1
+		0x8c040001,	// lbzu r0, 1(r4)
+		0x9c060001,	// stbu r0, 1(r6)
+		0x4200fff8,	// bdnz .-8
+		0x4e800020,	// blr
+	};
+	
+	const uint32_t memsetCode[] = {
+		0x28050000,	// cmplwi r5, 0
+		0x38c3ffff,	// addi r6, r3, -1
+		0x4d820020,	// beqlr
+		0x7ca903a6,	// mtctr r5
+		0x9c860001,	// stbu r4, 1(r6)
+		0x4200fffc,	// bdnz .-4
+		0x4e800020,	// blr
+	};
+	
+	const uint32_t memcmpCode[] = {
+		0x38000000,	// li r0, 0
+		0x28050000,	// cmplwi r5, 0
+		0x41820020,	// beq .+32
+		0x7ca903a6,	// mtctr r5
+		0x3863ffff,	// addi r3, r3, -1
+		0x3884ffff,	// addi r4, r4, -1
+		0x8cc30001,	// lbzu r6, 1(r3)
+		0x8ce40001,	// lbzu r7, 1(r4)
+		0x7c073051,	// subf. r0, r7, r6
+		0x4102fff4,	// bdnzt eq, .-12
+		0x7c030378,	// mr r3, r0
+		0x4e800020,	// blr
+	};
+	
+	const uint32_t memchrCode[] = {
+		0x28050000,	// cmplwi r5, 0
+		0x5484063e,	// rlwinm r4, r4, 0, 24, 31
+		0x3863ffff,	// addi r3, r3, -1
+		0x41820018,	// beq .+24
+		0x7ca903a6,	// mtctr r5
+		0x8c030001,	// lbzu r0, 1(r3)
+		0x7c002000,	// cmpw r0, r4
+		0x4d820020,	// beqlr
+		0x4200fff4,	// bdnz .-12
+		0x38600000,	// li r3, 0
+		0x4e800020,	// blr
+	};
+	
+	const uint32_t strlenCode[] = {
+		0x3883ffff,	// addi r4, r3, -1
+		0x8c040001,	// lbzu r0, 1(r4)
+		0x2c000000,	// cmpwi r0, 0
+		0x4082fff8,	// bne .-8
+		0x7c632050,	// subf r3, r3, r4
+		0x4e800020,	// blr
+	};
+	
+	const uint32_t strcpyCode[] = {
+		0x38a3ffff,	// addi r5, r3, -1
+		0x3884ffff,	// addi r4, r4, -1
+		0x8c040001,	// lbzu r0, 1(r4)
+		0x2c000000,	// cmpwi r0, 0
+		0x9c050001,	// stbu r0, 1(r5)
+		0x4082fff4,	// bne .-12
+		0x4e800020,	// blr
+	};
+	
+	const uint32_t strcmpCode[] = {
+		0x3863ffff,	// addi r3, r3, -1
+		0x3884ffff,	// addi r4, r4, -1
+		0x8ca30001,	// lbzu r5, 1(r3)
+		0x8cc40001,	// lbzu r6, 1(r4)
+		0x2c050000,	// cmpwi r5, 0
+		0x4182000c,	// beq .+12
+		0x7c053000,	// cmpw r5, r6
+		0x4182ffec,	// beq .-20
+		0x7c662850,	// subf r3, r6, r5
+		0x4e800020,	// blr
+	};
+	
+	const uint32_t strchrCode[] = {
+		0x5484063e,	// rlwinm r4, r4, 0, 24, 31
+		0x3863ffff,	// addi r3, r3, -1
+		0x8c030001,	// lbzu r0, 1(r3)
+		0x7c002000,	// cmpw r0, r4
+		0x4d820020,	// beqlr
+		0x2c000000,	// cmpwi r0, 0
+		0x4082fff0,	// bne .-16
+		0x38600000,	// li r3, 0
+		0x4e800020,	// blr
+	};
+	
+	const uint32_t fabsCode[] = {
+		0xfc200a10,	// fabs f1, f1
+		0x4e800020,	// blr
+	};
+	
+	const KnownRoutine knownRoutines[] = {
+		{"memcpy", memcpyCode, sizeof memcpyCode / 4},
+		{"memset", memsetCode, sizeof memsetCode / 4},
+		{"memcmp", memcmpCode, sizeof memcmpCode / 4},
+		{"memchr", memchrCode, sizeof memchrCode / 4},
+		{"strlen", strlenCode, sizeof strlenCode / 4},
+		{"strcpy", strcpyCode, sizeof strcpyCode / 4},
+		{"strcmp", strcmpCode, sizeof strcmpCode / 4},
+		{"strchr", strchrCode, sizeof strchrCode / 4},
+		{"fabs", fabsCode, sizeof fabsCode / 4},
+	};
+}
+
+namespace CFM
+{
+	RoutineHooks::Globals::Globals(Common::Allocator& allocator)
+	: Allocator(allocator)
+	{ }
+	
+	bool RoutineHooks::Enabled()
+	{
+		const char* value = getenv("CLASSIX_ROUTINE_HOOKS");
+		return value == nullptr || strcmp(value, "0") != 0;
+	}
+	
+	std::string RoutineHooks::DefaultListPath()
+	{
+		if (const char* path = getenv("CLASSIX_ROUTINE_HOOKS"))
+			return path;
+		
+		const char* home = getenv("HOME");
+		if (home == nullptr)
+			return "";
+			
+#ifdef __APPLE__
+		return std::string(home) + "/Library/Application Support/Classix/RoutineHooks.txt";
+#else
+		if (const char* configHome = getenv("XDG_CONFIG_HOME"))
+			return std::string(configHome) + "/classix/routine-hooks";
+		return std::string(home) + "/.config/classix/routine-hooks";
+#endif
+	}
+	
+	uint64_t RoutineHooks::Hash(const UInt32* code, uint32_t size)
+	{
+		uint64_t hash = HashBasis;
+		for (uint32_t i = 0; i < size / 4; i++)
+			hash = HashWord(hash, code[i].Get());
+		return hash;
+	}
+	
+	RoutineHooks::RoutineHooks(Allocator& allocator)
+	: allocator(allocator)
+	{
+		globals = allocator.Allocate<Globals>("Routine Hook Globals", allocator);
+		
+		// Both runtimes name their string and memory routines after the C library. memmove is the same hook
+		// as memcpy, since MoveBytes handles overlaps either way.
+		implementations["memcpy"] = &Bundled<Hook_memcpy>;
+		implementations["memmove"] = &Bundled<Hook_memcpy>;
+		implementations["memset"] = &Bundled<Hook_memset>;
+		implementations["memcmp"] = &Bundled<Hook_memcmp>;
+		implementations["memchr"] = &Bundled<Hook_memchr>;
+		implementations["strlen"] = &Bundled<Hook_strlen>;
+		implementations["strcpy"] = &Bundled<Hook_strcpy>;
+		implementations["strncpy"] = &Bundled<Hook_strncpy>;
+		implementations["strcat"] = &Bundled<Hook_strcat>;
+		implementations["strcmp"] = &Bundled<Hook_strcmp>;
+		implementations["strncmp"] = &Bundled<Hook_strncmp>;
+		implementations["strchr"] = &Bundled<Hook_strchr>;
+		
+		implementations["sqrt"] = &Bundled<Hook_sqrt>;
+		implementations["fabs"] = &Bundled<Hook_fabs>;
+		implementations["floor"] = &Bundled<Hook_floor>;
+		implementations["ceil"] = &Bundled<Hook_ceil>;
+		implementations["trunc"] = &Bundled<Hook_trunc>;
+		implementations["fmod"] = &Bundled<Hook_fmod>;
+		implementations["copysign"] = &Bundled<Hook_copysign>;
+		implementations["scalb"] = &Bundled<Hook_scalb>;
+		implementations["logb"] = &Bundled<Hook_logb>;
+		
+		for (const KnownRoutine& routine : knownRoutines)
+		{
+			uint64_t hash = HashBasis;
+			for (uint32_t i = 0; i < routine.Count; i++)
+				hash = HashWord(hash, routine.Code[i]);
+			Add(hash, routine.Name);
+		}
+	}
+	
+	RoutineHooks::~RoutineHooks()
+	{
+		allocator.Deallocate(globals);
+	}
+	
+	void RoutineHooks::Add(uint64_t hash, const std::string& name, Callback& function)
+	{
+		byHash[hash] = Hook {hash, name, &function};
+	}
+	
+	bool RoutineHooks::Add(uint64_t hash, const std::string& name)
+	{
+		auto iter = implementations.find(name);
+		if (iter == implementations.end())
+			return false;
+		
+		Add(hash, name, *iter->second);
+		return true;
+	}
+	
+	void RoutineHooks::Load(const std::string& path)
+	{
+		std::ifstream list(path);
+		std::string line;
+		for (unsigned lineNumber = 1; std::getline(list, line); lineNumber++)
+		{
+			if (line.length() == 0 || line[0] == '#')
+				continue;
+			
+			uint64_t hash;
+			std::string name;
+			std::istringstream fields(line);
+			if (!(fields >> std::hex >> hash >> name))
+				std::cerr << path << ':' << lineNumber << ": expected a hash and a routine name" << std::endl;
+			else if (!Add(hash, name))
+				std::cerr << path << ':' << lineNumber << ": no hook for " << name << std::endl;
+		}
+	}
+	
+	const RoutineHooks::Hook* RoutineHooks::Find(uint64_t hash, const std::string& name) const
+	{
+		auto iter = byHash.find(hash);
+		if (iter == byHash.end())
+			return nullptr;
+		
+		const Hook& hook = iter->second;
+		if (hook.Name.length() != 0 && name.length() != 0 && hook.Name != name)
+			return nullptr;
+		
+		return &hook;
+	}
+	
+	bool RoutineHooks::Replace(uint8_t* routine, uint32_t size, Callback& function) const
+	{
+		// The trampoline loads the hook globals in r2, after moving the guest's TOC to r12, which callees are
+		// free to clobber. NativeCalls are host structures, which the word after it may not be aligned enough
+		// for; a nop takes care of that.
+		const uint32_t trampolineSize = 12;
+		uint32_t call = trampolineSize;
+		if (reinterpret_cast<uintptr_t>(routine + call) % alignof(NativeCall) != 0)
+			call += 4;
+		if (call + sizeof(NativeCall) > size || reinterpret_cast<uintptr_t>(routine + call) % alignof(NativeCall) != 0)
+			return false;
+		
+		uint32_t globalsAddress = allocator.ToIntPtr(globals);
+		UInt32* words = reinterpret_cast<UInt32*>(routine);
+		words[0] = 0x7c4c1378; // mr r12, r2
+		words[1] = 0x3c400000 | (globalsAddress >> 16); // lis r2, globals@h
+		words[2] = 0x60420000 | (globalsAddress & 0xffff); // ori r2, r2, globals@l
+		if (call != trampolineSize)
+			words[3] = 0x60000000; // nop
+		
+		new (routine + call) NativeCall(function);
+		allocator.InvalidateCode(allocator.ToIntPtr(routine), size);
+		return true;
+	}
+	
+	size_t RoutineHooks::Patch(PEF::Container& container) const
+	{
+		size_t patched = 0;
+		for (PEF::InstantiableSection& section : container)
+		{
+			if (!section.IsExecutable())
+				continue;
+			
+			uint8_t* data = section.Data;
+			uint32_t size = static_cast<uint32_t>(section.Size());
+			TracebackTable traceback;
+			for (uint32_t offset = 0; offset + 4 <= size; offset += 4)
+			{
+				if (WordAt(data, offset) != 0 || !ReadTracebackTable(data, size, offset, traceback))
+					continue;
+				
+				uint8_t* routine = data + traceback.Start;
+				uint64_t hash = Hash(reinterpret_cast<const UInt32*>(routine), traceback.Size);
+				if (const Hook* hook = Find(hash, traceback.Name))
+				{
+					if (Replace(routine, traceback.Size, *hook->Function))
+						patched++;
+				}
+				else if (implementations.count(traceback.Name) != 0)
+				{
+					// what to add to the list once this build of the routine is known to be the usual one
+					std::cerr << "routine hooks: unknown code for " << traceback.Name << ": ";
+					std::cerr << std::hex << std::setw(16) << std::setfill('0') << hash << std::dec << std::setfill(' ') << ' ' << traceback.Name << std::endl;
+				}
+			}
+		}
+		return patched;
+	}
+}
@@ -0,0 +1,106 @@
+//
+// RoutineHooks.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef __Classix__RoutineHooks__
+#define __Classix__RoutineHooks__
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "Allocator.h"
+#include "Container.h"
+#include "NativeCall.h"
+
+namespace CFM
+{
+	// Host implementations of the runtime routines that programs link statically, like memcpy or strlen. When a
+	// container is loaded, the routines of its code sections are found through their traceback tables, and those
+	// that have a hook get a trampoline to a native call written over their first words.
+	// A hook matches routines by the hash of their code; when both the hook and the routine have a name, it has to
+	// match too. Routines with the same name can do different things, so a name alone is never enough.
+	class RoutineHooks
+	{
+	public:
+		typedef PPCVM::Execution::NativeCallback Callback;
+		
+		// Hooks are called with this as their globals. The trampoline moves the guest's TOC to r12 to pass it in r2,
+		// so hooks must call RestoreTOC before they return. They follow the usual calling conventions otherwise.
+		struct Globals
+		{
+			Common::Allocator& Allocator;
+			
+			explicit Globals(Common::Allocator& allocator);
+			
+			static inline void RestoreTOC(PPCVM::MachineState* state)
+			{
+				state->r2 = state->r12;
+			}
+		};
+		
+		struct Hook
+		{
+			uint64_t Hash;
+			std::string Name;
+			Callback* Function;
+		};
+		
+	private:
+		Common::Allocator& allocator;
+		Globals* globals;
+		std::unordered_map<std::string, Callback*> implementations;
+		std::unordered_map<uint64_t, Hook> byHash;
+		
+		const Hook* Find(uint64_t hash, const std::string& name) const;
+		bool Replace(uint8_t* routine, uint32_t size, Callback& function) const;
+		
+	public:
+		// false when $CLASSIX_ROUTINE_HOOKS is 0
+		static bool Enabled();
+		// $CLASSIX_ROUTINE_HOOKS if it is set (an empty value adds nothing), or a per-user file
+		static std::string DefaultListPath();
+		
+		// FNV-1a of the big-endian bytes of a routine; size is in bytes, and a multiple of 4
+		static uint64_t Hash(const Common::UInt32* code, uint32_t size);
+		
+		// knows the implementations for the MPW and Metrowerks runtimes, and hooks the builds of their routines
+		// that are known to be good for them; Load adds more
+		explicit RoutineHooks(Common::Allocator& allocator);
+		RoutineHooks(const RoutineHooks& that) = delete;
+		~RoutineHooks();
+		
+		// name is the traceback name, without the leading dot; an empty name matches by hash alone
+		void Add(uint64_t hash, const std::string& name, Callback& function);
+		// uses the bundled implementation of name, and returns false if there isn't one
+		bool Add(uint64_t hash, const std::string& name);
+		
+		// Reads "hash name" lines, with the hash in hexadecimal, and adds them with the bundled implementations. A
+		// line replaces a known build with the same hash. Empty lines and lines that start with # are ignored. A
+		// missing file adds nothing.
+		void Load(const std::string& path);
+		
+		// returns how many routines now call a hook
+		size_t Patch(PEF::Container& container) const;
+	};
+}
+
+#endif /* defined(__Classix__RoutineHooks__) */
@@ -72,6 +72,41 @@ namespace Common
 	{
 		return Allocate(AllocationDetails(zoneName, size), size);
 	}
+	
+	Allocator::Allocator()
+	: codeWritten(false), nextCodeListener(0)
+	{ }
+	
+	size_t Allocator::AddCodeListener(CodeListener listener)
+	{
+		std::lock_guard<std::mutex> guard(codeListenersLock);
+		size_t id = nextCodeListener++;
+		codeListeners[id] = std::move(listener);
+		return id;
+	}
+	
+	void Allocator::RemoveCodeListener(size_t id)
+	{
+		std::lock_guard<std::mutex> guard(codeListenersLock);
+		codeListeners.erase(id);
+	}
+	
+	void Allocator::InvalidateCode(uint32_t address, uint32_t size)
+	{
+		std::lock_guard<std::mutex> guard(codeListenersLock);
+		for (auto& pair : codeListeners)
+			pair.second(address, size);
+	}
+	
+	void Allocator::WatchCode(uint32_t, uint32_t)
+	{
+		// without help from the allocator, only explicit invalidations are seen
+	}
+	
+	void Allocator::ReportCodeWrites()
+	{
+		codeWritten.store(false, std::memory_order_relaxed);
+	}
 
 	Allocator::~Allocator()
 	{ }
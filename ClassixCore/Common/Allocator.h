@@ -28,6 +28,10 @@
 #include <string>
 #include <utility>
 #include <memory>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <atomic>
 #include "AllocationDetails.h"
 #include "AccessViolationException.h"
 #include "BigEndian.h"
@@ -78,6 +82,36 @@ namespace Common
 		virtual void* IntPtrToPointer(uint32_t value) const = 0;
 		virtual uint32_t PointerToIntPtr(const void* address) const = 0;
 		
+#pragma mark Code Changes
+		// Set when writes to watched code were noticed but not reported yet; can be set from a signal handler.
+		std::atomic<bool> codeWritten;
+		virtual void ReportCodeWrites();
+		
+	private:
+		std::mutex codeListenersLock;
+		size_t nextCodeListener;
+		std::map<size_t, std::function<void (uint32_t, uint32_t)>> codeListeners;
+		
+	public:
+		// Code caches listen for changes to the guest code they hold. Writes to ranges passed to WatchCode are
+		// noticed where the allocator can do it cheaply (the FlatAllocator write-protects their pages), and get
+		// reported the next time someone calls DispatchCodeWrites. Whoever knowingly changes code (icbi, the
+		// debugger) calls InvalidateCode. Listeners may be called from any thread that runs guest code.
+		typedef std::function<void (uint32_t address, uint32_t size)> CodeListener;
+		
+		Allocator();
+		
+		size_t AddCodeListener(CodeListener listener);
+		void RemoveCodeListener(size_t id);
+		void InvalidateCode(uint32_t address, uint32_t size);
+		virtual void WatchCode(uint32_t address, uint32_t size);
+		
+		inline void DispatchCodeWrites()
+		{
+			if (codeWritten.load(std::memory_order_relaxed))
+				ReportCodeWrites();
+		}
+		
 #pragma mark -
 	public:
 		enum AllocatorConstants
@@ -22,7 +22,34 @@
 #ifndef __pefdump__BigEndian__
 #define __pefdump__BigEndian__
 
+#include <cstdint>
+#include <cstddef>
+
+#ifdef __APPLE__
 #include <libkern/OSByteOrder.h>
+#else
+// lets the parts that don't depend on OS X (like InterfaceLib's UIChannel and its tests) build elsewhere
+#define OSSwapInt16(x) __builtin_bswap16(x)
+#define OSSwapInt32(x) __builtin_bswap32(x)
+#define OSSwapInt64(x) __builtin_bswap64(x)
+#if !defined(__LITTLE_ENDIAN__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define __LITTLE_ENDIAN__ 1
+#endif
+#endif
+
+// Guest memory is big-endian, unless ClassixCore is built with CLASSIX_SWIZZLED_MEMORY=1. Then, aligned 32-bit words
+// are stored in host byte order: the byte at guest address a lives at host address a ^ 3, and the halfword at a lives
+// at a ^ 2. Aligned word accesses need no swap at all, but bytes have to be moved around whenever they cross into or
+// out of guest memory (see GuestLayout.h).
+#ifndef CLASSIX_SWIZZLED_MEMORY
+#define CLASSIX_SWIZZLED_MEMORY 0
+#endif
+
+#if !__LITTLE_ENDIAN__
+// on big-endian hosts, both layouts are the same
+#undef CLASSIX_SWIZZLED_MEMORY
+#define CLASSIX_SWIZZLED_MEMORY 0
+#endif
 
 namespace Common
 {
@@ -155,13 +182,132 @@ namespace Common
 			return Get();
 		}
 	};
+	
+	// Loads and stores through host pointers to swizzled guest memory. Misaligned accesses go one byte at a time.
+	namespace Swizzle
+	{
+		template<typename T>
+		inline T Load(const void* address)
+		{
+			uintptr_t location = reinterpret_cast<uintptr_t>(address);
+			if (sizeof(T) == 1)
+				return *reinterpret_cast<const T*>(location ^ 3);
+			if (sizeof(T) == 2 && (location & 1) == 0)
+				return *reinterpret_cast<const T*>(location ^ 2);
+			if (sizeof(T) == 4 && (location & 3) == 0)
+				return *reinterpret_cast<const T*>(location);
+			if (sizeof(T) == 8 && (location & 3) == 0)
+			{
+				const uint32_t* words = reinterpret_cast<const uint32_t*>(location);
+				return static_cast<T>((static_cast<uint64_t>(words[0]) << 32) | words[1]);
+			}
+			
+			uint64_t value = 0;
+			for (size_t i = 0; i < sizeof(T); i++)
+				value = (value << 8) | *reinterpret_cast<const uint8_t*>((location + i) ^ 3);
+			return static_cast<T>(value);
+		}
+		
+		template<typename T>
+		inline void Store(void* address, T value)
+		{
+			uintptr_t location = reinterpret_cast<uintptr_t>(address);
+			if (sizeof(T) == 1)
+				*reinterpret_cast<T*>(location ^ 3) = value;
+			else if (sizeof(T) == 2 && (location & 1) == 0)
+				*reinterpret_cast<T*>(location ^ 2) = value;
+			else if (sizeof(T) == 4 && (location & 3) == 0)
+				*reinterpret_cast<T*>(location) = value;
+			else if (sizeof(T) == 8 && (location & 3) == 0)
+			{
+				uint32_t* words = reinterpret_cast<uint32_t*>(location);
+				words[0] = static_cast<uint32_t>(static_cast<uint64_t>(value) >> 32);
+				words[1] = static_cast<uint32_t>(value);
+			}
+			else
+			{
+				for (size_t i = 0; i < sizeof(T); i++)
+				{
+					uint8_t byte = static_cast<uint8_t>(static_cast<uint64_t>(value) >> ((sizeof(T) - 1 - i) * 8));
+					*reinterpret_cast<uint8_t*>((location + i) ^ 3) = byte;
+				}
+			}
+		}
+	}
+	
+	// An integer in swizzled guest memory. Since halfwords aren't stored where they seem to be, these only make sense
+	// at their place in guest memory, or in structures that mirror it; they don't work as lone host variables.
+	template<typename TNativeInt>
+	struct SwizzledInt
+	{
+		typedef SwizzledInt<TNativeInt> self;
+		
+		TNativeInt AsStored;
+		
+		SwizzledInt() = default;
+		
+		inline explicit SwizzledInt(TNativeInt nativeInt)
+		{
+			Set(nativeInt);
+		}
+		
+		inline SwizzledInt(const self& that)
+		{
+			Set(that.Get());
+		}
+		
+		inline TNativeInt Get() const
+		{
+			return Swizzle::Load<TNativeInt>(this);
+		}
+		
+		inline void Set(TNativeInt that)
+		{
+			Swizzle::Store<TNativeInt>(this, that);
+		}
 		
-	typedef BigEndianInt<int16_t>	SInt16;
-	typedef BigEndianInt<uint16_t>	UInt16;
-	typedef BigEndianInt<int32_t>	SInt32;
-	typedef BigEndianInt<uint32_t>	UInt32;
-	typedef BigEndianInt<int64_t>	SInt64;
-	typedef BigEndianInt<uint64_t>	UInt64;
+		inline self& operator=(const self& that)
+		{
+			Set(that.Get());
+			return *this;
+		}
+		
+		inline self& operator=(TNativeInt that)
+		{
+			Set(that);
+			return *this;
+		}
+		
+		inline operator TNativeInt() const
+		{
+			return Get();
+		}
+	};
+	
+	// integers in guest memory
+#if CLASSIX_SWIZZLED_MEMORY
+	template<typename TNativeInt> using GuestInt = SwizzledInt<TNativeInt>;
+#else
+	template<typename TNativeInt> using GuestInt = BigEndianInt<TNativeInt>;
+#endif
+	
+	typedef GuestInt<int16_t>	SInt16;
+	typedef GuestInt<uint16_t>	UInt16;
+	typedef GuestInt<int32_t>	SInt32;
+	typedef GuestInt<uint32_t>	UInt32;
+	typedef GuestInt<int64_t>	SInt64;
+	typedef GuestInt<uint64_t>	UInt64;
+	
+	// integers in file formats, which are big-endian no matter how guest memory is laid out
+	namespace BigEndian
+	{
+		typedef BigEndianInt<int16_t>	SInt16;
+		typedef BigEndianInt<uint16_t>	UInt16;
+		typedef BigEndianInt<int32_t>	SInt32;
+		typedef BigEndianInt<uint32_t>	UInt32;
+		typedef BigEndianInt<int64_t>	SInt64;
+		typedef BigEndianInt<uint64_t>	UInt64;
+	}
 		
 	struct Real32
 	{
@@ -172,12 +318,22 @@ namespace Common
 		
 		inline float Get() const
 		{
+#if CLASSIX_SWIZZLED_MEMORY
+			CF::SwappedFloat32 bits = { HostToBig<uint32_t>::Swap(Swizzle::Load<uint32_t>(&AsBigEndian)) };
+			return CF::ConvertFloatSwappedToHost(bits);
+#else
 			return CF::ConvertFloatSwappedToHost(AsBigEndian);
+#endif
 		}
 		
 		inline void Set(float nativeEndian)
 		{
+#if CLASSIX_SWIZZLED_MEMORY
+			uint32_t bits = BigToHost<uint32_t>::Swap(CF::ConvertFloatHostToSwapped(nativeEndian).v);
+			Swizzle::Store<uint32_t>(&AsBigEndian, bits);
+#else
 			this->AsBigEndian = CF::ConvertFloatHostToSwapped(nativeEndian);
+#endif
 		}
 		
 		inline Real32& operator=(float that)
@@ -203,12 +359,22 @@ namespace Common
 		
 		inline double Get() const
 		{
+#if CLASSIX_SWIZZLED_MEMORY
+			CF::SwappedFloat64 bits = { HostToBig<uint64_t>::Swap(Swizzle::Load<uint64_t>(&AsBigEndian)) };
+			return CF::ConvertDoubleSwappedToHost(bits);
+#else
 			return CF::ConvertDoubleSwappedToHost(AsBigEndian);
+#endif
 		}
 		
 		inline void Set(double nativeEndian)
 		{
+#if CLASSIX_SWIZZLED_MEMORY
+			uint64_t bits = BigToHost<uint64_t>::Swap(CF::ConvertDoubleHostToSwapped(nativeEndian).v);
+			Swizzle::Store<uint64_t>(&AsBigEndian, bits);
+#else
 			this->AsBigEndian = CF::ConvertDoubleHostToSwapped(nativeEndian);
+#endif
 		}
 		
 		inline Real64& operator=(double that)
@@ -0,0 +1,453 @@
+//
+// FlatAllocator.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include "FlatAllocator.h"
+
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <new>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace
+{
+	std::ostream& PrintAddress(std::ostream& into, uint32_t address)
+	{
+		into << "0x";
+		into << std::setw(8) << std::setfill('0') << std::hex << address;
+		return into;
+	}
+	
+	const uint32_t pageSize = getpagesize();
+	const uint32_t allocationAlignment = 16;
+	
+	// HandleWriteFault looks for the faulting page in every FlatAllocator. It runs in a signal handler, so it can't
+	// take a lock: allocators claim a slot in a chain of blocks, and blocks are appended but never freed. There's
+	// rarely more than one allocator, so the first block almost always does.
+	struct WatchRegistry
+	{
+		std::atomic<Common::FlatAllocator*> slots[4];
+		std::atomic<WatchRegistry*> next;
+	};
+	
+	WatchRegistry watchingAllocators;
+	
+	void RegisterWatchingAllocator(Common::FlatAllocator* allocator)
+	{
+		for (WatchRegistry* block = &watchingAllocators; ; block = block->next.load(std::memory_order_acquire))
+		{
+			for (auto& slot : block->slots)
+			{
+				Common::FlatAllocator* empty = nullptr;
+				if (slot.compare_exchange_strong(empty, allocator))
+					return;
+			}
+			
+			// every slot is taken: append a block, unless another thread just did
+			if (block->next.load(std::memory_order_acquire) == nullptr)
+			{
+				WatchRegistry* added = new WatchRegistry();
+				WatchRegistry* none = nullptr;
+				if (!block->next.compare_exchange_strong(none, added))
+					delete added;
+			}
+		}
+	}
+	
+	void UnregisterWatchingAllocator(Common::FlatAllocator* allocator)
+	{
+		for (WatchRegistry* block = &watchingAllocators; block != nullptr; block = block->next.load(std::memory_order_acquire))
+		{
+			for (auto& slot : block->slots)
+			{
+				Common::FlatAllocator* self = allocator;
+				if (slot.compare_exchange_strong(self, nullptr))
+					return;
+			}
+		}
+	}
+	
+	inline uint32_t RoundedSize(uint32_t size)
+	{
+		return size == 0 ? allocationAlignment : (size + allocationAlignment - 1) & ~(allocationAlignment - 1);
+	}
+	
+	inline uint32_t PageRounded(uint32_t size)
+	{
+		return (size + pageSize - 1) & ~(pageSize - 1);
+	}
+}
+
+namespace Common
+{
+	FlatAllocator::AllocatedRange::AllocatedRange(uint32_t size, uint32_t reservedBegin, uint32_t reservedEnd, const AllocationDetails& details)
+	: size(size), reservedBegin(reservedBegin), reservedEnd(reservedEnd), details(details.ToHeapAlloc())
+	{ }
+	
+	FlatAllocator::FlatAllocator(bool guardEverything)
+	: base(nullptr), invalidBegin(static_cast<uint32_t>(ArenaSize - InvalidAddressesSize)), invalidEnd(static_cast<uint32_t>(ArenaSize - pageSize)), guardEverything(guardEverything)
+	{
+		if (sizeof(void*) < sizeof(uint64_t))
+			throw std::runtime_error("Cannot reserve a 4 GB arena in a 32-bits environment");
+		
+		void* arena = mmap(nullptr, static_cast<size_t>(ArenaSize), PROT_NONE, MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+		if (arena == MAP_FAILED)
+			throw std::runtime_error(strerror(errno));
+		
+		base = static_cast<uint8_t*>(arena);
+		committedPages.resize(static_cast<size_t>(ArenaSize / pageSize));
+		AddFreeRange(LowMemorySize, invalidBegin - LowMemorySize);
+		
+		pageWatch.reset(new std::atomic<uint8_t>[static_cast<size_t>(ArenaSize / pageSize)]());
+		RegisterWatchingAllocator(this);
+	}
+	
+	void* FlatAllocator::IntPtrToPointer(uint32_t value) const
+	{
+		return value == 0 ? nullptr : base + value;
+	}
+	
+	uint32_t FlatAllocator::PointerToIntPtr(const void* address) const
+	{
+		if (address == nullptr)
+			return 0;
+		
+		uint64_t offset = static_cast<uint64_t>(static_cast<const uint8_t*>(address) - base);
+		assert(offset < ArenaSize && "Pointer is outside of the guest address space");
+		return static_cast<uint32_t>(offset);
+	}
+	
+	void FlatAllocator::AddFreeRange(uint32_t address, uint32_t size)
+	{
+		freeByAddress.emplace(address, size);
+		freeBySize.emplace(size, address);
+	}
+	
+	void FlatAllocator::RemoveFreeRange(std::map<uint32_t, uint32_t>::iterator iter)
+	{
+		auto sameSize = freeBySize.equal_range(iter->second);
+		for (auto sizeIter = sameSize.first; sizeIter != sameSize.second; sizeIter++)
+		{
+			if (sizeIter->second == iter->first)
+			{
+				freeBySize.erase(sizeIter);
+				break;
+			}
+		}
+		freeByAddress.erase(iter);
+	}
+	
+	void FlatAllocator::Commit(uint32_t address, uint32_t size)
+	{
+		uint32_t firstPage = address / pageSize;
+		uint32_t endPage = static_cast<uint32_t>((static_cast<uint64_t>(address) + size + pageSize - 1) / pageSize);
+		
+		// most allocations land on pages that are already committed, so only call into the kernel for the rest
+		uint32_t page = firstPage;
+		while (page < endPage)
+		{
+			if (committedPages[page])
+			{
+				page++;
+				continue;
+			}
+			
+			uint32_t runBegin = page;
+			while (page < endPage && !committedPages[page])
+			{
+				committedPages[page] = true;
+				page++;
+			}
+			
+			uint8_t* runAddress = base + static_cast<uint64_t>(runBegin) * pageSize;
+			size_t runSize = static_cast<size_t>(page - runBegin) * pageSize;
+			if (mprotect(runAddress, runSize, PROT_READ | PROT_WRITE) != 0)
+				throw std::runtime_error(strerror(errno));
+		}
+	}
+	
+	void FlatAllocator::Decommit(uint32_t address, uint32_t size)
+	{
+		// only whole pages can go
+		uint32_t firstPage = static_cast<uint32_t>((static_cast<uint64_t>(address) + pageSize - 1) / pageSize);
+		uint32_t endPage = static_cast<uint32_t>((static_cast<uint64_t>(address) + size) / pageSize);
+		if (firstPage >= endPage)
+			return;
+		
+		uint8_t* begin = base + static_cast<uint64_t>(firstPage) * pageSize;
+		size_t length = static_cast<size_t>(endPage - firstPage) * pageSize;
+		madvise(begin, length, MADV_DONTNEED);
+		mprotect(begin, length, PROT_NONE);
+		
+		// code that goes away this way doesn't fault, so it has to be reported here
+		bool hadCode = false;
+		for (uint32_t page = firstPage; page < endPage; page++)
+		{
+			committedPages[page] = false;
+			hadCode |= pageWatch[page].exchange(PageUnwatched) != PageUnwatched;
+		}
+		
+		if (hadCode)
+			InvalidateCode(firstPage * pageSize, static_cast<uint32_t>(length));
+	}
+	
+	void FlatAllocator::WatchCode(uint32_t address, uint32_t size)
+	{
+		if (size == 0)
+			return;
+		
+		std::lock_guard<std::mutex> guard(watchLock);
+		uint32_t endPage = static_cast<uint32_t>((static_cast<uint64_t>(address) + size + pageSize - 1) / pageSize);
+		for (uint32_t page = address / pageSize; page < endPage; page++)
+		{
+			uint8_t unwatched = PageUnwatched;
+			if (!committedPages[page] || !pageWatch[page].compare_exchange_strong(unwatched, PageWatched))
+				continue;
+			
+			// the page is marked first, so that a write right after mprotect finds it
+			watchedPages.push_back(page);
+			mprotect(base + static_cast<uint64_t>(page) * pageSize, pageSize, PROT_READ);
+		}
+	}
+	
+	bool FlatAllocator::HandleWriteFault(const void* hostAddress)
+	{
+		for (WatchRegistry* block = &watchingAllocators; block != nullptr; block = block->next.load(std::memory_order_acquire))
+		{
+			for (auto& slot : block->slots)
+			{
+				FlatAllocator* allocator = slot.load(std::memory_order_acquire);
+				if (allocator == nullptr)
+					continue;
+				
+				uint64_t offset = static_cast<uint64_t>(static_cast<const uint8_t*>(hostAddress) - allocator->base);
+				if (offset >= ArenaSize)
+					continue;
+				
+				uint32_t page = static_cast<uint32_t>(offset / pageSize);
+				uint8_t watched = PageWatched;
+				if (allocator->pageWatch[page].compare_exchange_strong(watched, PageWritten))
+				{
+					mprotect(allocator->base + static_cast<uint64_t>(page) * pageSize, pageSize, PROT_READ | PROT_WRITE);
+					allocator->codeWritten.store(true, std::memory_order_release);
+					return true;
+				}
+				
+				// if another thread got there first, the page is about to be writable
+				return watched == PageWritten;
+			}
+		}
+		return false;
+	}
+	
+	void FlatAllocator::ReportCodeWrites()
+	{
+		std::vector<uint32_t> written;
+		{
+			std::lock_guard<std::mutex> guard(watchLock);
+			codeWritten.store(false, std::memory_order_relaxed);
+			for (size_t i = 0; i < watchedPages.size(); )
+			{
+				uint32_t page = watchedPages[i];
+				uint8_t state = pageWatch[page].load(std::memory_order_acquire);
+				if (state == PageWatched)
+				{
+					i++;
+					continue;
+				}
+				
+				watchedPages[i] = watchedPages.back();
+				watchedPages.pop_back();
+				if (state != PageWritten)
+					continue;
+				
+				written.push_back(page);
+				uint32_t& writes = pageWriteCounts[page];
+				writes++;
+				pageWatch[page].store(writes >= SharedPageWrites ? PageShared : PageUnwatched, std::memory_order_release);
+			}
+		}
+		
+		for (uint32_t page : written)
+			InvalidateCode(page * pageSize, pageSize);
+	}
+	
+	uint32_t FlatAllocator::CreateInvalidAddress(const AllocationDetails& reason)
+	{
+		if (invalidBegin == invalidEnd)
+			throw std::logic_error("Ran out of invalid addresses");
+		
+		uint32_t address = invalidBegin;
+		invalidBegin += 4;
+		ranges.emplace(address, AllocatedRange(4, address, address + 4, reason));
+		return address;
+	}
+	
+	uint8_t* FlatAllocator::Allocate(const AllocationDetails& reason, size_t size)
+	{
+		if (size > ArenaSize - InvalidAddressesSize - LowMemorySize)
+			throw std::bad_alloc();
+		
+		// Guarded allocations reserve whole pages plus the guard page, and are pushed against the guard page. Free
+		// ranges are only 16-bytes aligned, so look for one that still fits once it's aligned to a page.
+		uint32_t allocationSize = RoundedSize(static_cast<uint32_t>(size));
+		bool guarded = guardEverything || allocationSize >= GuardThreshold;
+		uint32_t reservedSize = guarded ? PageRounded(allocationSize) + pageSize : allocationSize;
+		uint32_t neededSize = guarded ? reservedSize + pageSize - allocationAlignment : reservedSize;
+		
+		// best fit
+		auto fit = freeBySize.lower_bound(neededSize);
+		if (fit == freeBySize.end())
+			throw std::bad_alloc();
+		
+		uint32_t rangeBegin = fit->second;
+		uint32_t rangeEnd = rangeBegin + fit->first;
+		RemoveFreeRange(freeByAddress.find(rangeBegin));
+		
+		uint32_t reservedBegin = guarded ? PageRounded(rangeBegin) : rangeBegin;
+		uint32_t reservedEnd = reservedBegin + reservedSize;
+		if (reservedBegin > rangeBegin)
+			AddFreeRange(rangeBegin, reservedBegin - rangeBegin);
+		if (rangeEnd > reservedEnd)
+			AddFreeRange(reservedEnd, rangeEnd - reservedEnd);
+		
+		uint32_t address = reservedBegin;
+		if (guarded)
+		{
+			// the guard page may still be committed from an earlier allocation
+			uint32_t guardPage = reservedEnd - pageSize;
+			if (committedPages[guardPage / pageSize])
+				Decommit(guardPage, pageSize);
+			address = guardPage - allocationSize;
+		}
+		
+		Commit(address, allocationSize);
+		
+		uint8_t* allocation = base + address;
+		if (size <= ScribbleThreshold)
+			memset(allocation, ScribbleAllocPattern, size);
+		
+		ranges.emplace(address, AllocatedRange(static_cast<uint32_t>(size), reservedBegin, reservedEnd, reason));
+		return allocation;
+	}
+	
+	void FlatAllocator::Deallocate(void* address)
+	{
+		uint32_t start = ToIntPtr(address);
+		auto iter = ranges.find(start);
+		if (iter == ranges.end())
+			return;
+		
+		// invalid addresses are never reused
+		if (start >= ArenaSize - InvalidAddressesSize)
+		{
+			ranges.erase(iter);
+			return;
+		}
+		
+		// guarded allocations give their pages back right away, so that using them after they're freed faults
+		start = iter->second.reservedBegin;
+		uint32_t end = iter->second.reservedEnd;
+		bool guarded = end - start != RoundedSize(iter->second.size);
+		ranges.erase(iter);
+		
+		auto next = freeByAddress.find(end);
+		if (next != freeByAddress.end())
+		{
+			end += next->second;
+			RemoveFreeRange(next);
+		}
+		
+		auto previous = freeByAddress.lower_bound(start);
+		if (previous != freeByAddress.begin())
+		{
+			previous--;
+			if (previous->first + previous->second == start)
+			{
+				start = previous->first;
+				RemoveFreeRange(previous);
+			}
+		}
+		
+		AddFreeRange(start, end - start);
+		if (guarded || end - start >= DecommitThreshold)
+			Decommit(start, end - start);
+	}
+	
+	const std::pair<const uint32_t, FlatAllocator::AllocatedRange>* FlatAllocator::GetAllocationRange(uint32_t address) const
+	{
+		auto iter = ranges.upper_bound(address);
+		if (iter != ranges.begin())
+		{
+			iter--;
+			if (iter->first <= address && static_cast<uint64_t>(iter->first) + iter->second.size > address)
+				return &*iter;
+		}
+		
+		return nullptr;
+	}
+	
+	std::shared_ptr<const AllocationDetails> FlatAllocator::GetDetails(uint32_t address) const
+	{
+		auto range = GetAllocationRange(address);
+		return range == nullptr ? nullptr : range->second.details;
+	}
+	
+	uint32_t FlatAllocator::GetUpperAllocation(uint32_t address) const
+	{
+		auto iter = ranges.upper_bound(address);
+		if (iter == ranges.end())
+			return 0xffffffff;
+		
+		return iter->first;
+	}
+	
+	uint32_t FlatAllocator::GetAllocationOffset(uint32_t address) const
+	{
+		auto range = GetAllocationRange(address);
+		if (range == nullptr)
+			throw AccessViolationException(*this, address, 0);
+		
+		return address - range->first;
+	}
+	
+	void FlatAllocator::PrintMemoryMap() const
+	{
+		for (const auto& pair : ranges)
+		{
+			PrintAddress(std::cout, pair.first);
+			std::cout << " - ";
+			PrintAddress(std::cout, pair.first + pair.second.size);
+			std::cout << ": " << pair.second.details->GetAllocationName() << std::endl;
+		}
+	}
+	
+	FlatAllocator::~FlatAllocator()
+	{
+		UnregisterWatchingAllocator(this);
+		
+		if (base != nullptr)
+			munmap(base, static_cast<size_t>(ArenaSize));
+	}
+}
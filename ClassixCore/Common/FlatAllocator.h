@@ -0,0 +1,125 @@
+//
+// FlatAllocator.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__FlatAllocator__
+#define __Classix__FlatAllocator__
+
+#include "Allocator.h"
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+namespace Common
+{
+	// Reserves one 4 GB region of host address space and places guest address x at base + x, so this works
+	// regardless of the host pointer size. Pages are only made accessible when an allocation covers them, and
+	// the kernel doesn't back them with memory until they're touched. For that reason, large allocations aren't
+	// scribbled over, and large free ranges are given back to the system.
+	// Large allocations end right where an inaccessible guard page begins, so that running off their end faults
+	// instead of trampling the next allocation. Optionally, every allocation can get that treatment.
+	// Pages that hold watched code are made read-only. The first write to one of them faults, and
+	// HandleWriteFault (called by whoever handles SIGSEGV and SIGBUS) makes it writable again and remembers it, so
+	// that the write can be reported to code listeners.
+	class FlatAllocator : public Allocator
+	{
+		struct AllocatedRange
+		{
+			uint32_t size;
+			uint32_t reservedBegin; // the arena range that belongs to the allocation, guard page included
+			uint32_t reservedEnd;
+			std::shared_ptr<AllocationDetails> details;
+			
+			AllocatedRange(uint32_t size, uint32_t reservedBegin, uint32_t reservedEnd, const AllocationDetails& details);
+		};
+		
+		uint8_t* base;
+		std::map<uint32_t, AllocatedRange> ranges;
+		std::map<uint32_t, uint32_t> freeByAddress;
+		std::multimap<uint32_t, uint32_t> freeBySize;
+		std::vector<bool> committedPages;
+		uint32_t invalidBegin;
+		uint32_t invalidEnd;
+		bool guardEverything;
+		
+		enum PageWatch : uint8_t
+		{
+			PageUnwatched,
+			PageWatched, // read-only until written to
+			PageWritten, // writable again, waiting to be reported
+			PageShared, // written to so often that it probably holds data too, so not watched anymore
+		};
+		
+		std::unique_ptr<std::atomic<uint8_t>[]> pageWatch;
+		std::mutex watchLock;
+		std::vector<uint32_t> watchedPages;
+		std::map<uint32_t, uint32_t> pageWriteCounts;
+		
+		const std::pair<const uint32_t, AllocatedRange>* GetAllocationRange(uint32_t address) const;
+		void AddFreeRange(uint32_t address, uint32_t size);
+		void RemoveFreeRange(std::map<uint32_t, uint32_t>::iterator iter);
+		void Commit(uint32_t address, uint32_t size);
+		void Decommit(uint32_t address, uint32_t size);
+		
+	protected:
+		virtual void* IntPtrToPointer(uint32_t value) const override;
+		virtual uint32_t PointerToIntPtr(const void* address) const override;
+		virtual void ReportCodeWrites() override;
+		
+	public:
+		static const uint64_t ArenaSize = 0x100000000ull;
+		static const uint32_t LowMemorySize = 0x10000; // never allocated, so that null pointers fault
+		static const uint32_t InvalidAddressesSize = 0x100000; // at the top of the arena, never committed
+		static const uint32_t DecommitThreshold = 0x10000;
+		static const uint32_t ScribbleThreshold = 0x10000;
+		static const uint32_t GuardThreshold = 0x1000;
+		static const uint32_t SharedPageWrites = 8;
+		
+		// guardEverything puts a guard page after every allocation, which is a lot more wasteful
+		explicit FlatAllocator(bool guardEverything = false);
+		FlatAllocator(const FlatAllocator& that) = delete;
+		
+		// guest address x lives at GetBase() + x
+		inline uint8_t* GetBase() const
+		{
+			return base;
+		}
+		
+		virtual uint32_t CreateInvalidAddress(const AllocationDetails& reason) override;
+		virtual uint8_t* Allocate(const AllocationDetails& details, size_t size) override;
+		virtual void Deallocate(void* address) override;
+		virtual std::shared_ptr<const AllocationDetails> GetDetails(uint32_t address) const override;
+		virtual uint32_t GetUpperAllocation(uint32_t address) const override;
+		virtual uint32_t GetAllocationOffset(uint32_t address) const override;
+		virtual void WatchCode(uint32_t address, uint32_t size) override;
+		
+		// Safe to call from a signal handler. Returns true when hostAddress is on a watched page of any
+		// FlatAllocator; the page is writable again by then, so the faulting write can be retried.
+		static bool HandleWriteFault(const void* hostAddress);
+		
+		void PrintMemoryMap() const;
+		
+		virtual ~FlatAllocator() override;
+	};
+}
+
+#endif /* defined(__Classix__FlatAllocator__) */
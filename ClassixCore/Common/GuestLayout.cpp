@@ -0,0 +1,185 @@
+//
+// GuestLayout.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include "GuestLayout.h"
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+
+namespace Common
+{
+	namespace GuestLayout
+	{
+		void CopyToGuest(void* guest, const void* host, size_t size)
+		{
+#if CLASSIX_SWIZZLED_MEMORY
+			uint8_t* into = static_cast<uint8_t*>(guest);
+			const uint8_t* from = static_cast<const uint8_t*>(host);
+			
+			// bytes up to the first word boundary, then whole words, then whatever is left
+			size_t i = 0;
+			for (; i < size && (reinterpret_cast<uintptr_t>(into + i) & 3) != 0; i++)
+				*Byte(into + i) = from[i];
+			
+			for (; i + 4 <= size; i += 4)
+			{
+				uint32_t word;
+				memcpy(&word, from + i, sizeof word);
+				*reinterpret_cast<uint32_t*>(into + i) = BigToHost<uint32_t>::Swap(word);
+			}
+			
+			for (; i < size; i++)
+				*Byte(into + i) = from[i];
+#else
+			memcpy(guest, host, size);
+#endif
+		}
+		
+		void CopyFromGuest(void* host, const void* guest, size_t size)
+		{
+#if CLASSIX_SWIZZLED_MEMORY
+			uint8_t* into = static_cast<uint8_t*>(host);
+			const uint8_t* from = static_cast<const uint8_t*>(guest);
+			
+			size_t i = 0;
+			for (; i < size && (reinterpret_cast<uintptr_t>(from + i) & 3) != 0; i++)
+				into[i] = *Byte(from + i);
+			
+			for (; i + 4 <= size; i += 4)
+			{
+				uint32_t word = HostToBig<uint32_t>::Swap(*reinterpret_cast<const uint32_t*>(from + i));
+				memcpy(into + i, &word, sizeof word);
+			}
+			
+			for (; i < size; i++)
+				into[i] = *Byte(from + i);
+#else
+			memcpy(host, guest, size);
+#endif
+		}
+		
+		size_t StringLength(const void* guest)
+		{
+#if CLASSIX_SWIZZLED_MEMORY
+			const uint8_t* bytes = static_cast<const uint8_t*>(guest);
+			size_t length = 0;
+			while (*Byte(bytes + length) != 0)
+				length++;
+			return length;
+#else
+			return strlen(static_cast<const char*>(guest));
+#endif
+		}
+		
+		std::string ReadString(const void* guest)
+		{
+			std::string string(StringLength(guest), '\0');
+			CopyFromGuest(&string[0], guest, string.size());
+			return string;
+		}
+		
+		std::string ReadPascalString(const void* guest)
+		{
+			const uint8_t* bytes = static_cast<const uint8_t*>(guest);
+			std::string string(*Byte(bytes), '\0');
+			CopyFromGuest(&string[0], bytes + 1, string.size());
+			return string;
+		}
+		
+		void WriteString(void* guest, const std::string& string)
+		{
+			CopyToGuest(guest, string.c_str(), string.size() + 1);
+		}
+		
+		void Move(void* into, const void* from, size_t size)
+		{
+#if CLASSIX_SWIZZLED_MEMORY
+			uint8_t* dest = static_cast<uint8_t*>(into);
+			const uint8_t* src = static_cast<const uint8_t*>(from);
+			if (((reinterpret_cast<uintptr_t>(dest) ^ reinterpret_cast<uintptr_t>(src)) & 3) != 0)
+			{
+				// the bytes of a word don't land in a single word, so they have to be unswizzled on the way
+				std::string bytes(size, '\0');
+				CopyFromGuest(&bytes[0], src, size);
+				CopyToGuest(dest, bytes.data(), size);
+				return;
+			}
+			
+			// Both sides sit the same way in their words, so whole words move as they are; only the bytes before the
+			// first word boundary and after the last one need to be placed one by one. Like memmove, copy backwards
+			// when the destination overlaps the end of the source.
+			size_t head = std::min<size_t>(size, -reinterpret_cast<uintptr_t>(dest) & 3);
+			size_t body = (size - head) & ~static_cast<size_t>(3);
+			if (dest <= src)
+			{
+				for (size_t i = 0; i < head; i++)
+					*Byte(dest + i) = *Byte(src + i);
+				memmove(dest + head, src + head, body);
+				for (size_t i = head + body; i < size; i++)
+					*Byte(dest + i) = *Byte(src + i);
+			}
+			else
+			{
+				for (size_t i = size; i > head + body; i--)
+					*Byte(dest + i - 1) = *Byte(src + i - 1);
+				memmove(dest + head, src + head, body);
+				for (size_t i = head; i > 0; i--)
+					*Byte(dest + i - 1) = *Byte(src + i - 1);
+			}
+#else
+			memmove(into, from, size);
+#endif
+		}
+		
+		int Compare(const void* a, const void* b, size_t size)
+		{
+#if CLASSIX_SWIZZLED_MEMORY
+			const uint8_t* left = static_cast<const uint8_t*>(a);
+			const uint8_t* right = static_cast<const uint8_t*>(b);
+			for (size_t i = 0; i < size; i++)
+			{
+				int difference = *Byte(left + i) - *Byte(right + i);
+				if (difference != 0)
+					return difference;
+			}
+			return 0;
+#else
+			return memcmp(a, b, size);
+#endif
+		}
+		
+#if CLASSIX_SWIZZLED_MEMORY
+		void FromBigEndian(void* guest, size_t size)
+		{
+			assert((reinterpret_cast<uintptr_t>(guest) & 3) == 0 && "Guest data has to start on a word boundary");
+			uint32_t* words = static_cast<uint32_t*>(guest);
+			for (size_t i = 0; i < (size + 3) / 4; i++)
+				words[i] = BigToHost<uint32_t>::Swap(words[i]);
+		}
+#else
+		void FromBigEndian(void*, size_t)
+		{
+			// big-endian data already is in the guest layout
+		}
+#endif
+	}
+}
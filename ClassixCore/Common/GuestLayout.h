@@ -0,0 +1,70 @@
+//
+// GuestLayout.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef __Classix__GuestLayout__
+#define __Classix__GuestLayout__
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include "BigEndian.h"
+
+namespace Common
+{
+	// Moving bytes in and out of guest memory, which is swizzled when ClassixCore is built with
+	// CLASSIX_SWIZZLED_MEMORY=1 (see BigEndian.h). Otherwise, these are plain copies and no-ops.
+	// Integers go through UInt32 and friends instead; these are for strings, images and other byte sequences.
+	namespace GuestLayout
+	{
+		const bool Swizzled = CLASSIX_SWIZZLED_MEMORY;
+		
+		// where the guest byte that seems to be at address really is
+		template<typename T>
+		inline T* Byte(T* address)
+		{
+#if CLASSIX_SWIZZLED_MEMORY
+			return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(address) ^ 3);
+#else
+			return address;
+#endif
+		}
+		
+		void CopyToGuest(void* guest, const void* host, size_t size);
+		void CopyFromGuest(void* host, const void* guest, size_t size);
+		
+		// C strings and Pascal strings that native libraries get from the guest or give back to it
+		size_t StringLength(const void* guest);
+		std::string ReadString(const void* guest);
+		std::string ReadPascalString(const void* guest);
+		void WriteString(void* guest, const std::string& string); // with its terminating null
+		
+		// memmove and memcmp, when both sides are in guest memory
+		void Move(void* into, const void* from, size_t size);
+		int Compare(const void* a, const void* b, size_t size);
+		
+		// Converts big-endian data that was copied into guest memory as is, like a section image. The data has to
+		// start on a word boundary, and size is rounded up to a whole word.
+		void FromBigEndian(void* guest, size_t size);
+	}
+}
+
+#endif /* defined(__Classix__GuestLayout__) */
@@ -25,6 +25,7 @@
 #include <iostream>
 #include <iomanip>
 #include <stdexcept>
+#include <new>
 #include <algorithm>
 #include <unistd.h>
 #include <sys/mman.h>
@@ -97,6 +98,9 @@ namespace Common
 	uint8_t* NativeAllocator::Allocate(const AllocationDetails& reason, size_t size)
 	{
 		uint8_t* allocation = static_cast<uint8_t*>(malloc(size));
+		if (allocation == nullptr)
+			throw std::bad_alloc();
+		
 		memset(allocation, ScribbleAllocPattern, size);
 		uint32_t address = ToIntPtr(allocation);
 		ranges.emplace(std::make_pair(address, AllocatedRange(allocation, allocation + size, reason)));
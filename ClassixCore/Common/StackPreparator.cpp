@@ -23,6 +23,7 @@
 #include "Allocator.h"
 #include "StackPreparator.h"
 #include "BigEndian.h"
+#include "GuestLayout.h"
 
 namespace
 {
@@ -167,7 +168,7 @@ namespace Common
 		auto offsetIterator = stringOffsets.rbegin();
 		for (size_t i = 0; i < envp.size(); i++)
 		{
-			UInt32 address(*offsetIterator + virtualAddress);
+			BigEndian::UInt32 address(*offsetIterator + virtualAddress);
 			builder.Write(address);
 			offsetIterator++;
 		}
@@ -178,7 +179,7 @@ namespace Common
 		
 		for (size_t i = 0; i < argv.size(); i++)
 		{
-			UInt32 address(*offsetIterator + virtualAddress);
+			BigEndian::UInt32 address(*offsetIterator + virtualAddress);
 			builder.Write(address);
 			offsetIterator++;
 		}
@@ -192,6 +193,9 @@ namespace Common
 			builder.Write<uint32_t>(0);
 		
 		result.sp = builder.sp;
+		
+		// the stack was built as a big-endian image, like sections are
+		GuestLayout::FromBigEndian(stack, stackSize);
 		return result;
 	}
 }
@@ -0,0 +1,206 @@
+//
+// FlatAllocatorTests.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include <memory>
+#include <vector>
+#include "UnitTest.h"
+#include "FlatAllocator.h"
+#include "MemoryFaultHandler.h"
+
+using Common::FlatAllocator;
+
+namespace
+{
+	// collects what code listeners are told
+	struct WrittenRanges
+	{
+		Common::Allocator& allocator;
+		size_t listener;
+		std::vector<std::pair<uint32_t, uint32_t>> ranges;
+		
+		explicit WrittenRanges(Common::Allocator& allocator)
+		: allocator(allocator)
+		{
+			listener = allocator.AddCodeListener([this](uint32_t address, uint32_t size)
+			{
+				ranges.emplace_back(address, size);
+			});
+		}
+		
+		bool Covers(uint32_t address) const
+		{
+			for (const auto& range : ranges)
+			{
+				if (range.first <= address && address - range.first < range.second)
+					return true;
+			}
+			return false;
+		}
+		
+		~WrittenRanges()
+		{
+			allocator.RemoveCodeListener(listener);
+		}
+	};
+}
+
+TEST(FlatAllocator, AllocationsAreAlignedAndDisjoint)
+{
+	FlatAllocator allocator;
+	Common::Allocator& memory = allocator;
+	std::vector<std::pair<uint32_t, uint32_t>> allocations;
+	for (uint32_t size : { 1, 15, 16, 17, 100, 0x1000, 0x2345, 3 })
+	{
+		uint32_t address = memory.ToIntPtr(memory.Allocate("Test", size));
+		CHECK_EQUAL(address % 16, 0u);
+		CHECK(address >= FlatAllocator::LowMemorySize);
+		allocations.emplace_back(address, size);
+	}
+	
+	for (size_t i = 0; i < allocations.size(); i++)
+	{
+		for (size_t j = i + 1; j < allocations.size(); j++)
+		{
+			const auto& a = allocations[i];
+			const auto& b = allocations[j];
+			CHECK(a.first + a.second <= b.first || b.first + b.second <= a.first);
+		}
+	}
+}
+
+TEST(FlatAllocator, AllocationsKnowTheirDetails)
+{
+	FlatAllocator allocator;
+	Common::Allocator& memory = allocator;
+	uint32_t address = memory.ToIntPtr(memory.Allocate("Details", 100));
+	
+	auto details = allocator.GetDetails(address + 99);
+	CHECK(details != nullptr);
+	if (details != nullptr)
+		CHECK_EQUAL(details->GetAllocationName(), std::string("Details"));
+	
+	CHECK(allocator.GetDetails(address + 100) == nullptr);
+	CHECK_EQUAL(allocator.GetAllocationOffset(address + 42), 42u);
+	CHECK_EQUAL(allocator.GetUpperAllocation(address - 1), address);
+}
+
+TEST(FlatAllocator, FreedMemoryIsReused)
+{
+	FlatAllocator allocator;
+	Common::Allocator& memory = allocator;
+	uint8_t* first = memory.Allocate("First", 64);
+	uint8_t* second = memory.Allocate("Second", 64);
+	uint32_t firstAddress = memory.ToIntPtr(first);
+	
+	memory.Deallocate(first);
+	CHECK(allocator.GetDetails(firstAddress) == nullptr);
+	
+	// best fit: the hole left by the first allocation is exactly big enough
+	uint8_t* third = memory.Allocate("Third", 64);
+	CHECK_EQUAL(memory.ToIntPtr(third), firstAddress);
+	
+	// freeing something that isn't allocated is ignored
+	memory.Deallocate(first + 16);
+	memory.Deallocate(second);
+	memory.Deallocate(third);
+	CHECK(allocator.GetDetails(firstAddress) == nullptr);
+}
+
+TEST(FlatAllocator, FreedNeighborsCoalesce)
+{
+	FlatAllocator allocator;
+	Common::Allocator& memory = allocator;
+	uint8_t* a = memory.Allocate("A", 48);
+	uint8_t* b = memory.Allocate("B", 48);
+	uint8_t* c = memory.Allocate("C", 48);
+	uint8_t* fence = memory.Allocate("Fence", 48);
+	uint32_t lowest = std::min(memory.ToIntPtr(a), std::min(memory.ToIntPtr(b), memory.ToIntPtr(c)));
+	
+	memory.Deallocate(a);
+	memory.Deallocate(c);
+	memory.Deallocate(b);
+	
+	// the three holes merged back into one, so something bigger than each of them fits where they were
+	uint8_t* big = memory.Allocate("Big", 144);
+	CHECK_EQUAL(memory.ToIntPtr(big), lowest);
+	memory.Deallocate(big);
+	memory.Deallocate(fence);
+}
+
+TEST(FlatAllocator, WritesToWatchedCodeAreReported)
+{
+	FlatAllocator allocator;
+	Common::Allocator& memory = allocator;
+	PPCVM::Execution::MemoryFaultHandler faultHandler(allocator);
+	WrittenRanges written(allocator);
+	
+	uint8_t* code = memory.Allocate("Code", 0x2000);
+	uint32_t address = memory.ToIntPtr(code);
+	allocator.WatchCode(address, 0x2000);
+	
+	allocator.DispatchCodeWrites();
+	CHECK(written.ranges.empty());
+	
+	// faults, and the handler makes the page writable again
+	code[0x10] = 0x42;
+	CHECK_EQUAL(code[0x10], 0x42);
+	allocator.DispatchCodeWrites();
+	CHECK(written.Covers(address + 0x10));
+	
+	// the page isn't watched anymore until someone asks again
+	written.ranges.clear();
+	code[0x11] = 0x43;
+	allocator.DispatchCodeWrites();
+	CHECK(written.ranges.empty());
+}
+
+TEST(FlatAllocator, ManyAllocatorsCanWatchCode)
+{
+	// more allocators than the first block of the watch registry holds
+	std::vector<std::unique_ptr<FlatAllocator>> allocators;
+	for (int i = 0; i < 9; i++)
+		allocators.emplace_back(new FlatAllocator);
+	
+	PPCVM::Execution::MemoryFaultHandler faultHandler(*allocators.front());
+	for (auto& allocator : allocators)
+	{
+		Common::Allocator& memory = *allocator;
+		WrittenRanges written(memory);
+		uint8_t* code = memory.Allocate("Code", 0x1000);
+		uint32_t address = memory.ToIntPtr(code);
+		allocator->WatchCode(address, 0x1000);
+		
+		code[0] = 1;
+		allocator->DispatchCodeWrites();
+		CHECK(written.Covers(address));
+	}
+	
+	// slots that were given back are taken again
+	allocators.erase(allocators.begin(), allocators.begin() + 3);
+	FlatAllocator latecomer;
+	Common::Allocator& memory = latecomer;
+	WrittenRanges written(memory);
+	uint8_t* code = memory.Allocate("Code", 0x1000);
+	latecomer.WatchCode(memory.ToIntPtr(code), 0x1000);
+	code[0] = 1;
+	latecomer.DispatchCodeWrites();
+	CHECK(written.Covers(memory.ToIntPtr(code)));
+}
@@ -0,0 +1,102 @@
+//
+// GuestLayoutTests.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include <cstring>
+#include "UnitTest.h"
+#include "GuestMachine.h"
+
+using namespace Common;
+using namespace Encode;
+
+TEST(GuestLayout, StringsAreInGuestOrder)
+{
+	GuestMachine machine;
+	uint8_t* data = machine.allocator.ToPointer<uint8_t>(machine.data);
+	
+	// the guest sees the characters in order, and the terminating null
+	machine.Load({
+		D(34, 3, 2, 1),			// lbz r3, 1(r2)
+		D(34, 4, 2, 5),			// lbz r4, 5(r2)
+		D(34, 5, 2, 13),		// lbz r5, 13(r2)
+		Blr,
+	});
+	machine.DataWord(12) = 0xffffffff; // so that the null has to come from WriteString
+	GuestLayout::WriteString(data + 1, "Hello, world");
+	machine.Run();
+	CHECK_EQUAL(machine.state.r3, static_cast<uint32_t>('H'));
+	CHECK_EQUAL(machine.state.r4, static_cast<uint32_t>('o'));
+	CHECK_EQUAL(machine.state.r5, 0u);
+	
+	CHECK_EQUAL(GuestLayout::StringLength(data + 1), 12u);
+	CHECK(GuestLayout::ReadString(data + 1) == "Hello, world");
+	CHECK(GuestLayout::ReadString(data + 8) == "world");
+	
+	const uint8_t pascal[] = { 5, 'a', 'b', 'c', 'd', 'e', 'f' };
+	machine.WriteData(0x42, pascal, sizeof pascal);
+	CHECK(GuestLayout::ReadPascalString(data + 0x42) == "abcde");
+	CHECK(GuestLayout::ReadPascalString(data + 0x49) == "");
+}
+
+TEST(GuestLayout, MoveBehavesLikeMemmove)
+{
+	GuestMachine machine;
+	uint8_t* data = machine.allocator.ToPointer<uint8_t>(machine.data);
+	const uint32_t Size = 0x48;
+	
+	// every pair of alignments, overlapping both ways or not at all
+	for (uint32_t from = 0x10; from < 0x14; from++)
+	{
+		for (uint32_t into = 0x08; into < 0x30; into++)
+		{
+			for (uint32_t size = 0; size < 22; size += 3)
+			{
+				uint8_t expected[Size];
+				for (uint32_t i = 0; i < Size; i++)
+					expected[i] = static_cast<uint8_t>(i * 7 + 1);
+				machine.WriteData(0, expected, Size);
+				memmove(expected + into, expected + from, size);
+				
+				GuestLayout::Move(data + into, data + from, size);
+				std::vector<uint8_t> actual = machine.ReadData(0, Size);
+				if (memcmp(actual.data(), expected, Size) != 0)
+				{
+					UnitTest::Fail(__FILE__, __LINE__, "Move(" + std::to_string(into) + ", " + std::to_string(from) + ", " + std::to_string(size) + ") doesn't match memmove");
+					return;
+				}
+			}
+		}
+	}
+}
+
+TEST(GuestLayout, CompareOrdersLikeMemcmp)
+{
+	GuestMachine machine;
+	uint8_t* data = machine.allocator.ToPointer<uint8_t>(machine.data);
+	const uint8_t left[] = { 1, 2, 3, 4, 5, 0x80 };
+	const uint8_t right[] = { 1, 2, 3, 4, 5, 0x7f };
+	machine.WriteData(1, left, sizeof left);
+	machine.WriteData(0x22, right, sizeof right);
+	
+	CHECK_EQUAL(GuestLayout::Compare(data + 1, data + 0x22, 5), 0);
+	CHECK(GuestLayout::Compare(data + 1, data + 0x22, 6) > 0);
+	CHECK(GuestLayout::Compare(data + 0x22, data + 1, 6) < 0);
+}
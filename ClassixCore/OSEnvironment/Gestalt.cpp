@@ -26,6 +26,9 @@ namespace OSEnvironment
 	Gestalt::Gestalt()
 	{
 		SetValue("sysv", 0x0922);
+		
+		// gestaltPowerPCProcessorFeatures: graphics ops, stfiwx, fsqrt, dcba, AltiVec and data streams
+		SetValue("ppcf", 0x3f);
 	}
 	
 	void Gestalt::SetValue(uint32_t key, int32_t value)
@@ -24,7 +24,7 @@
 namespace OSEnvironment
 {
 	Managers::Managers(Common::Allocator& allocator, class ThreadManager& threads)
-	: allocator(allocator), resourceManager(allocator), threadManager(threads)
+	: allocator(allocator), memoryManager(allocator), resourceManager(allocator, memoryManager), threadManager(threads)
 	{ }
 	
 	Common::Allocator& Managers::Allocator()
@@ -37,6 +37,11 @@ namespace OSEnvironment
 		return gestalt;
 	}
 	
+	MemoryManager& Managers::MemoryManager()
+	{
+		return memoryManager;
+	}
+	
 	ResourceManager& Managers::ResourceManager()
 	{
 		return resourceManager;
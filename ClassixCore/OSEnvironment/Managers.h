@@ -24,6 +24,7 @@
 
 #include "Allocator.h"
 #include "Gestalt.h"
+#include "MemoryManager.h"
 #include "ResourceManager.h"
 #include "ThreadManager.h"
 
@@ -33,6 +34,7 @@ namespace OSEnvironment
 	{
 		Common::Allocator& allocator;
 		Gestalt gestalt;
+		MemoryManager memoryManager;
 		ResourceManager resourceManager;
 		ThreadManager& threadManager;
 		
@@ -41,6 +43,7 @@ namespace OSEnvironment
 		
 		Common::Allocator& Allocator();
 		Gestalt& Gestalt();
+		MemoryManager& MemoryManager();
 		ResourceManager& ResourceManager();
 		ThreadManager& ThreadManager();
 		
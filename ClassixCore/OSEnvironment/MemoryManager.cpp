@@ -0,0 +1,814 @@
+//
+// MemoryManager.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include <algorithm>
+#include <iterator>
+#include <cstring>
+#include <cassert>
+#include <new>
+
+#include "MemoryManager.h"
+#include "BigEndian.h"
+
+using namespace Common;
+
+namespace
+{
+	// the layout of the Zone record, as found at the beginning of the zone
+	struct ZoneHeader
+	{
+		UInt32 bkLim;
+		UInt32 purgePtr;
+		UInt32 hFstFree;
+		UInt32 zcbFree;
+		UInt32 gzProc;
+		UInt16 moreMast;
+		UInt16 flags;
+		UInt16 cntRel;
+		UInt16 maxRel;
+		UInt16 cntNRel;
+		uint8_t heapType;
+		uint8_t unused;
+		UInt16 cntEmpty;
+		UInt16 cntHandles;
+		UInt32 minCBFree;
+		UInt32 purgeProc;
+		UInt32 sparePtr;
+		UInt32 allocPtr;
+		UInt16 heapData;
+	};
+	
+	static_assert(sizeof(ZoneHeader) <= OSEnvironment::MemoryManager::ZoneHeaderSize, "Zone header doesn't fit");
+	
+	inline uint32_t BlockCapacity(uint32_t size)
+	{
+		// zero-sized blocks still take some room, so that every block has its own address
+		const uint32_t granularity = OSEnvironment::MemoryManager::BlockGranularity;
+		return std::max((size + granularity - 1) & ~(granularity - 1), granularity);
+	}
+}
+
+namespace OSEnvironment
+{
+	MemoryManager::MemoryManager(Common::Allocator& allocator, uint32_t zoneSize)
+	: allocator(allocator), zoneSize(zoneSize), freeBytes(0), lastError(0)
+	{
+		assert(zoneSize > ZoneHeaderSize && zoneSize <= MaximumZoneSize && "Bad zone size");
+		zone = allocator.Allocate("Application Zone", zoneSize);
+		extentAllocations.push_back(zone);
+		
+		uint32_t zoneBegin = allocator.ToIntPtr(zone);
+		extents[zoneBegin + ZoneHeaderSize] = zoneBegin + zoneSize;
+		
+		ZoneHeader* header = reinterpret_cast<ZoneHeader*>(zone);
+		memset(header, 0, ZoneHeaderSize);
+		header->bkLim = zoneBegin + zoneSize;
+		header->moreMast = MasterPointerCount;
+		
+		AddFreeRange(zoneBegin + ZoneHeaderSize, zoneSize - ZoneHeaderSize);
+		MoreMasters();
+		UpdateZoneHeader();
+	}
+	
+#pragma mark -
+#pragma mark Zone Bookkeeping
+	uint8_t* MemoryManager::ToPointer(uint32_t address)
+	{
+		return allocator.ToPointer<uint8_t>(address);
+	}
+	
+	bool MemoryManager::Grow(uint32_t needed)
+	{
+		if (needed > MaximumZoneSize)
+			return false;
+		
+		uint32_t extentSize = std::max(DefaultZoneSize, (needed + ExtentGranularity - 1) & ~(ExtentGranularity - 1));
+		if (extentSize > MaximumZoneSize - zoneSize)
+			return false;
+		
+		uint8_t* extent;
+		try
+		{
+			extent = allocator.Allocate("Application Zone Extent", extentSize);
+		}
+		catch (std::bad_alloc&)
+		{
+			return false;
+		}
+		
+		extentAllocations.push_back(extent);
+		uint32_t extentBegin = allocator.ToIntPtr(extent);
+		extents[extentBegin] = extentBegin + extentSize;
+		zoneSize += extentSize;
+		AddFreeRange(extentBegin, extentSize);
+		
+		ZoneHeader* header = reinterpret_cast<ZoneHeader*>(zone);
+		header->bkLim = std::max<uint32_t>(header->bkLim, extentBegin + extentSize);
+		return true;
+	}
+	
+	void MemoryManager::UpdateZoneHeader()
+	{
+		ZoneHeader* header = reinterpret_cast<ZoneHeader*>(zone);
+		header->zcbFree = freeBytes;
+		header->cntHandles = static_cast<uint16_t>(std::min<size_t>(handles.size(), UINT16_MAX));
+	}
+	
+	void MemoryManager::AddFreeRange(uint32_t address, uint32_t size)
+	{
+		// extents may happen to be next to each other, but free ranges stay in one
+		freeBytes += size;
+		auto next = freeRanges.lower_bound(address);
+		if (next != freeRanges.end() && address + size == next->first && extents.count(next->first) == 0)
+		{
+			size += next->second;
+			next = freeRanges.erase(next);
+		}
+		
+		if (next != freeRanges.begin() && extents.count(address) == 0)
+		{
+			auto previous = std::prev(next);
+			if (previous->first + previous->second == address)
+			{
+				previous->second += size;
+				return;
+			}
+		}
+		
+		freeRanges.emplace_hint(next, address, size);
+	}
+	
+	void MemoryManager::RemoveFreeRange(std::map<uint32_t, uint32_t>::iterator range, uint32_t address, uint32_t size)
+	{
+		uint32_t rangeBegin = range->first;
+		uint32_t rangeEnd = range->first + range->second;
+		assert(address >= rangeBegin && address + size <= rangeEnd && "Taking memory that isn't free");
+		
+		freeBytes -= size;
+		freeRanges.erase(range);
+		if (address > rangeBegin)
+			freeRanges.emplace(rangeBegin, address - rangeBegin);
+		if (address + size < rangeEnd)
+			freeRanges.emplace(address + size, rangeEnd - address - size);
+	}
+	
+	void MemoryManager::RebuildFreeRanges()
+	{
+		freeRanges.clear();
+		freeBytes = 0;
+		auto iter = blocks.begin();
+		for (const auto& extent : extents)
+		{
+			uint32_t cursor = extent.first;
+			for (; iter != blocks.end() && iter->first < extent.second; iter++)
+			{
+				if (iter->first > cursor)
+				{
+					freeRanges.emplace_hint(freeRanges.end(), cursor, iter->first - cursor);
+					freeBytes += iter->first - cursor;
+				}
+				cursor = iter->first + iter->second.capacity;
+			}
+			
+			if (cursor < extent.second)
+			{
+				freeRanges.emplace_hint(freeRanges.end(), cursor, extent.second - cursor);
+				freeBytes += extent.second - cursor;
+			}
+		}
+	}
+	
+	uint32_t MemoryManager::LargestFreeRange() const
+	{
+		uint32_t largest = 0;
+		for (const auto& pair : freeRanges)
+			largest = std::max(largest, pair.second);
+		return largest;
+	}
+	
+	bool MemoryManager::IsMovable(const Block& block) const
+	{
+		return block.handle != 0 && (handles.at(block.handle).state & handleLocked) == 0;
+	}
+	
+	bool MemoryManager::IsPurgeable(const Block& block) const
+	{
+		return IsMovable(block) && (handles.at(block.handle).state & handlePurgeable) != 0;
+	}
+	
+	uint32_t MemoryManager::LargestBlockAfterCompaction(bool countPurgeable, uint32_t* total) const
+	{
+		// Compaction slides movable blocks down until they hit an immovable one or the beginning of their extent,
+		// so between two immovable blocks, all the free space ends up in one piece.
+		uint32_t largest = 0;
+		uint32_t totalFree = 0;
+		auto iter = blocks.begin();
+		for (const auto& extent : extents)
+		{
+			uint32_t segmentBegin = extent.first;
+			uint32_t segmentUsed = 0;
+			for (; iter != blocks.end() && iter->first < extent.second; iter++)
+			{
+				const Block& block = iter->second;
+				if (!IsMovable(block))
+				{
+					uint32_t segmentFree = iter->first - segmentBegin - segmentUsed;
+					largest = std::max(largest, segmentFree);
+					totalFree += segmentFree;
+					segmentBegin = iter->first + block.capacity;
+					segmentUsed = 0;
+				}
+				else if (!countPurgeable || !IsPurgeable(block))
+				{
+					segmentUsed += block.capacity;
+				}
+			}
+			
+			uint32_t segmentFree = extent.second - segmentBegin - segmentUsed;
+			largest = std::max(largest, segmentFree);
+			totalFree += segmentFree;
+		}
+		
+		if (total != nullptr)
+			*total = totalFree;
+		return largest;
+	}
+	
+#pragma mark -
+#pragma mark Blocks
+	uint32_t MemoryManager::AllocateBlock(uint32_t size, uint32_t handle)
+	{
+		if (size > MaximumZoneSize)
+			return 0;
+		
+		// first fit, from the bottom of the zone
+		uint32_t capacity = BlockCapacity(size);
+		for (auto iter = freeRanges.begin(); iter != freeRanges.end(); iter++)
+		{
+			if (iter->second >= capacity)
+			{
+				uint32_t address = iter->first;
+				RemoveFreeRange(iter, address, capacity);
+				blocks[address] = Block { .size = size, .capacity = capacity, .handle = handle };
+				return address;
+			}
+		}
+		return 0;
+	}
+	
+	uint32_t MemoryManager::MakeRoomAndAllocate(uint32_t size, uint32_t handle)
+	{
+		uint32_t address = AllocateBlock(size, handle);
+		if (address == 0)
+		{
+			Compact(BlockCapacity(size));
+			address = AllocateBlock(size, handle);
+		}
+		
+		if (address == 0 && PurgeAll() > 0)
+		{
+			Compact(BlockCapacity(size));
+			address = AllocateBlock(size, handle);
+		}
+		
+		if (address == 0 && Grow(BlockCapacity(size)))
+			address = AllocateBlock(size, handle);
+		
+		lastError = address == 0 ? memFullErr : 0;
+		return address;
+	}
+	
+	bool MemoryManager::ResizeBlock(uint32_t address, uint32_t size)
+	{
+		if (size > MaximumZoneSize)
+			return false;
+		
+		Block& block = blocks.at(address);
+		uint32_t capacity = BlockCapacity(size);
+		if (capacity <= block.capacity)
+		{
+			if (capacity < block.capacity)
+				AddFreeRange(address + capacity, block.capacity - capacity);
+		}
+		else
+		{
+			uint32_t blockEnd = address + block.capacity;
+			auto next = freeRanges.find(blockEnd);
+			if (next == freeRanges.end() || next->second < capacity - block.capacity || extents.count(blockEnd) != 0)
+				return false;
+			
+			RemoveFreeRange(next, blockEnd, capacity - block.capacity);
+		}
+		
+		block.capacity = capacity;
+		block.size = size;
+		return true;
+	}
+	
+	void MemoryManager::ReleaseBlock(uint32_t address)
+	{
+		auto iter = blocks.find(address);
+		assert(iter != blocks.end() && "Releasing a block that doesn't exist");
+		AddFreeRange(address, iter->second.capacity);
+		blocks.erase(iter);
+	}
+	
+	void MemoryManager::MoveBlock(std::map<uint32_t, Block>::iterator iter, uint32_t to)
+	{
+		// this doesn't update the free ranges; the caller is responsible for that
+		Block block = iter->second;
+		memmove(ToPointer(to), ToPointer(iter->first), block.capacity);
+		blocks.erase(iter);
+		blocks.emplace(to, block);
+		
+		handles.at(block.handle).block = to;
+		SetMasterPointer(block.handle, to);
+	}
+	
+	void MemoryManager::Compact(uint32_t needed)
+	{
+		// Everything below the cursor is packed, so the space between the cursor and the next block is free, and
+		// there's no need to go further once that is enough.
+		auto iter = blocks.begin();
+		for (const auto& extent : extents)
+		{
+			uint32_t cursor = extent.first;
+			for (; iter != blocks.end() && iter->first < extent.second; )
+			{
+				auto next = std::next(iter);
+				uint32_t address = iter->first;
+				uint32_t capacity = iter->second.capacity;
+				if (address - cursor >= needed)
+				{
+					RebuildFreeRanges();
+					return;
+				}
+				
+				if (IsMovable(iter->second) && address > cursor)
+				{
+					MoveBlock(iter, cursor);
+					address = cursor;
+				}
+				cursor = address + capacity;
+				iter = next;
+			}
+			
+			if (extent.second - cursor >= needed)
+				break;
+		}
+		
+		RebuildFreeRanges();
+	}
+	
+#pragma mark -
+#pragma mark Master Pointers
+	uint32_t MemoryManager::AllocateMasterPointer()
+	{
+		if (freeMasterPointers.empty())
+			MoreMasters();
+		
+		if (freeMasterPointers.empty())
+			return 0;
+		
+		uint32_t handle = freeMasterPointers.back();
+		freeMasterPointers.pop_back();
+		return handle;
+	}
+	
+	void MemoryManager::SetMasterPointer(uint32_t handle, uint32_t block)
+	{
+		*reinterpret_cast<UInt32*>(ToPointer(handle)) = block;
+	}
+	
+	MemoryManager::MasterPointer* MemoryManager::GetMasterPointer(uint32_t handle)
+	{
+		auto iter = handles.find(handle);
+		if (iter == handles.end())
+		{
+			lastError = handle == 0 ? nilHandleErr : memWZErr;
+			return nullptr;
+		}
+		return &iter->second;
+	}
+	
+	void MemoryManager::Purge(uint32_t handle)
+	{
+		MasterPointer& masterPointer = handles.at(handle);
+		ReleaseBlock(masterPointer.block);
+		masterPointer.block = 0;
+		SetMasterPointer(handle, 0);
+	}
+	
+	size_t MemoryManager::PurgeAll()
+	{
+		size_t purged = 0;
+		for (auto& pair : handles)
+		{
+			if (pair.second.block != 0 && IsPurgeable(blocks.at(pair.second.block)))
+			{
+				Purge(pair.first);
+				purged++;
+			}
+		}
+		return purged;
+	}
+	
+#pragma mark -
+#pragma mark Public Interface
+	int16_t MemoryManager::MemError() const
+	{
+		return lastError;
+	}
+	
+	uint32_t MemoryManager::Zone() const
+	{
+		return allocator.ToIntPtr(zone);
+	}
+	
+	bool MemoryManager::IsHandle(uint32_t handle) const
+	{
+		return handles.count(handle) != 0;
+	}
+	
+	bool MemoryManager::IsPointer(uint32_t pointer) const
+	{
+		auto iter = blocks.find(pointer);
+		return iter != blocks.end() && iter->second.handle == 0;
+	}
+	
+	uint32_t MemoryManager::NewPtr(uint32_t size, bool clear)
+	{
+		uint32_t pointer = MakeRoomAndAllocate(size, 0);
+		if (pointer != 0 && clear)
+			memset(ToPointer(pointer), 0, size);
+		
+		UpdateZoneHeader();
+		return pointer;
+	}
+	
+	void MemoryManager::DisposePtr(uint32_t pointer)
+	{
+		if (!IsPointer(pointer))
+		{
+			lastError = memWZErr;
+			return;
+		}
+		
+		ReleaseBlock(pointer);
+		UpdateZoneHeader();
+		lastError = 0;
+	}
+	
+	uint32_t MemoryManager::GetPtrSize(uint32_t pointer)
+	{
+		if (!IsPointer(pointer))
+		{
+			lastError = memWZErr;
+			return 0;
+		}
+		
+		lastError = 0;
+		return blocks.at(pointer).size;
+	}
+	
+	void MemoryManager::SetPtrSize(uint32_t pointer, uint32_t size)
+	{
+		if (!IsPointer(pointer))
+		{
+			lastError = memWZErr;
+			return;
+		}
+		
+		// nonrelocatable blocks can only grow into the free space that follows them
+		lastError = ResizeBlock(pointer, size) ? 0 : memFullErr;
+		UpdateZoneHeader();
+	}
+	
+	void MemoryManager::MoreMasters()
+	{
+		uint32_t masterBlock = MakeRoomAndAllocate(MasterPointerCount * sizeof(uint32_t), 0);
+		if (masterBlock == 0)
+			return;
+		
+		memset(ToPointer(masterBlock), 0, MasterPointerCount * sizeof(uint32_t));
+		for (uint32_t i = MasterPointerCount; i > 0; i--)
+			freeMasterPointers.push_back(masterBlock + (i - 1) * sizeof(uint32_t));
+		UpdateZoneHeader();
+	}
+	
+	uint32_t MemoryManager::NewHandle(uint32_t size, bool clear)
+	{
+		uint32_t handle = NewEmptyHandle();
+		if (handle == 0)
+			return 0;
+		
+		uint32_t block = MakeRoomAndAllocate(size, handle);
+		if (block == 0)
+		{
+			handles.erase(handle);
+			freeMasterPointers.push_back(handle);
+			UpdateZoneHeader();
+			return 0;
+		}
+		
+		handles[handle].block = block;
+		SetMasterPointer(handle, block);
+		if (clear)
+			memset(ToPointer(block), 0, size);
+		
+		UpdateZoneHeader();
+		return handle;
+	}
+	
+	uint32_t MemoryManager::NewEmptyHandle()
+	{
+		uint32_t handle = AllocateMasterPointer();
+		if (handle == 0)
+		{
+			lastError = memFullErr;
+			return 0;
+		}
+		
+		handles[handle] = MasterPointer { .block = 0, .state = 0 };
+		SetMasterPointer(handle, 0);
+		UpdateZoneHeader();
+		lastError = 0;
+		return handle;
+	}
+	
+	void MemoryManager::DisposeHandle(uint32_t handle)
+	{
+		MasterPointer* masterPointer = GetMasterPointer(handle);
+		if (masterPointer == nullptr)
+			return;
+		
+		if (masterPointer->block != 0)
+			ReleaseBlock(masterPointer->block);
+		
+		handles.erase(handle);
+		SetMasterPointer(handle, 0);
+		freeMasterPointers.push_back(handle);
+		UpdateZoneHeader();
+		lastError = 0;
+	}
+	
+	uint32_t MemoryManager::GetHandleSize(uint32_t handle)
+	{
+		MasterPointer* masterPointer = GetMasterPointer(handle);
+		if (masterPointer == nullptr)
+			return 0;
+		
+		if (masterPointer->block == 0)
+		{
+			lastError = nilHandleErr;
+			return 0;
+		}
+		
+		lastError = 0;
+		return blocks.at(masterPointer->block).size;
+	}
+	
+	void MemoryManager::SetHandleSize(uint32_t handle, uint32_t size)
+	{
+		MasterPointer* masterPointer = GetMasterPointer(handle);
+		if (masterPointer == nullptr)
+			return;
+		
+		if (masterPointer->block == 0)
+		{
+			lastError = nilHandleErr;
+			return;
+		}
+		
+		lastError = 0;
+		if (!ResizeBlock(masterPointer->block, size))
+		{
+			if (masterPointer->state & handleLocked)
+			{
+				lastError = memFullErr;
+				return;
+			}
+			
+			// Allocate the new block before releasing the old one so the contents survive. Making room might move
+			// the old block, so its address is only read after; it must not purge it, though.
+			uint8_t state = masterPointer->state;
+			masterPointer->state &= ~handlePurgeable;
+			uint32_t newBlock = MakeRoomAndAllocate(size, handle);
+			masterPointer->state = state;
+			if (newBlock == 0)
+				return;
+			
+			uint32_t oldBlock = masterPointer->block;
+			memcpy(ToPointer(newBlock), ToPointer(oldBlock), std::min(size, blocks.at(oldBlock).size));
+			ReleaseBlock(oldBlock);
+			masterPointer->block = newBlock;
+			SetMasterPointer(handle, newBlock);
+		}
+		UpdateZoneHeader();
+	}
+	
+	void MemoryManager::EmptyHandle(uint32_t handle)
+	{
+		MasterPointer* masterPointer = GetMasterPointer(handle);
+		if (masterPointer == nullptr)
+			return;
+		
+		if (masterPointer->state & handleLocked)
+		{
+			lastError = memPurErr;
+			return;
+		}
+		
+		if (masterPointer->block != 0)
+			Purge(handle);
+		
+		UpdateZoneHeader();
+		lastError = 0;
+	}
+	
+	void MemoryManager::ReallocateHandle(uint32_t handle, uint32_t size)
+	{
+		EmptyHandle(handle);
+		if (lastError != 0)
+			return;
+		
+		uint32_t block = MakeRoomAndAllocate(size, handle);
+		if (block == 0)
+			return;
+		
+		handles.at(handle).block = block;
+		SetMasterPointer(handle, block);
+		UpdateZoneHeader();
+	}
+	
+	uint32_t MemoryManager::RecoverHandle(uint32_t pointer)
+	{
+		auto iter = blocks.find(pointer);
+		if (iter == blocks.end() || iter->second.handle == 0)
+		{
+			lastError = memWZErr;
+			return 0;
+		}
+		
+		lastError = 0;
+		return iter->second.handle;
+	}
+	
+	uint8_t MemoryManager::HGetState(uint32_t handle)
+	{
+		MasterPointer* masterPointer = GetMasterPointer(handle);
+		if (masterPointer == nullptr)
+			return 0;
+		
+		lastError = 0;
+		return masterPointer->state;
+	}
+	
+	void MemoryManager::HSetState(uint32_t handle, uint8_t state)
+	{
+		MasterPointer* masterPointer = GetMasterPointer(handle);
+		if (masterPointer == nullptr)
+			return;
+		
+		masterPointer->state = state & (handleLocked | handlePurgeable | handleIsResource);
+		lastError = 0;
+	}
+	
+	void MemoryManager::SetHandleFlag(uint32_t handle, HandleState flag, bool value)
+	{
+		MasterPointer* masterPointer = GetMasterPointer(handle);
+		if (masterPointer == nullptr)
+			return;
+		
+		if (value)
+			masterPointer->state |= flag;
+		else
+			masterPointer->state &= ~flag;
+		lastError = 0;
+	}
+	
+	void MemoryManager::MoveHHi(uint32_t handle)
+	{
+		MasterPointer* masterPointer = GetMasterPointer(handle);
+		if (masterPointer == nullptr)
+			return;
+		
+		if (masterPointer->state & handleLocked)
+		{
+			lastError = memLockedErr;
+			return;
+		}
+		
+		lastError = 0;
+		if (masterPointer->block == 0)
+			return;
+		
+		// move the block to the top of the highest free range above it that can hold it
+		uint32_t address = masterPointer->block;
+		uint32_t capacity = blocks.at(address).capacity;
+		for (auto range = freeRanges.rbegin(); range != freeRanges.rend() && range->first > address; range++)
+		{
+			if (range->second >= capacity)
+			{
+				uint32_t destination = range->first + range->second - capacity;
+				RemoveFreeRange(std::prev(range.base()), destination, capacity);
+				MoveBlock(blocks.find(address), destination);
+				AddFreeRange(address, capacity);
+				return;
+			}
+		}
+	}
+	
+	uint32_t MemoryManager::FreeMem() const
+	{
+		return freeBytes;
+	}
+	
+	uint32_t MemoryManager::MaxBlock() const
+	{
+		return LargestBlockAfterCompaction(false, nullptr);
+	}
+	
+	uint32_t MemoryManager::CompactMem(uint32_t needed)
+	{
+		// compacts until there's a free block of needed bytes, or the whole zone otherwise
+		if (LargestFreeRange() < needed)
+			Compact(needed);
+		UpdateZoneHeader();
+		lastError = 0;
+		return LargestFreeRange();
+	}
+	
+	void MemoryManager::PurgeMem(uint32_t needed)
+	{
+		// purge blocks from the bottom of the zone until one contiguous free range is large enough
+		lastError = 0;
+		if (LargestFreeRange() >= needed)
+			return;
+		
+		for (auto iter = blocks.begin(); iter != blocks.end();)
+		{
+			auto next = std::next(iter);
+			if (IsPurgeable(iter->second))
+			{
+				uint32_t address = iter->first;
+				Purge(iter->second.handle);
+				
+				auto range = std::prev(freeRanges.upper_bound(address));
+				if (range->second >= needed)
+				{
+					UpdateZoneHeader();
+					return;
+				}
+			}
+			iter = next;
+		}
+		
+		UpdateZoneHeader();
+		lastError = memFullErr;
+	}
+	
+	uint32_t MemoryManager::MaxMem()
+	{
+		PurgeAll();
+		Compact(UINT32_MAX);
+		UpdateZoneHeader();
+		lastError = 0;
+		return LargestFreeRange();
+	}
+	
+	uint32_t MemoryManager::GrowSpace() const
+	{
+		return MaximumZoneSize - zoneSize;
+	}
+	
+	void MemoryManager::PurgeSpace(uint32_t& total, uint32_t& contiguous) const
+	{
+		contiguous = LargestBlockAfterCompaction(true, &total);
+	}
+	
+	MemoryManager::~MemoryManager()
+	{
+		for (uint8_t* extent : extentAllocations)
+			allocator.Deallocate(extent);
+	}
+}
@@ -0,0 +1,167 @@
+//
+// MemoryManager.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef __Classix__MemoryManager__
+#define __Classix__MemoryManager__
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "Allocator.h"
+
+// Information gathered from Inside Macintosh: Memory, chapters 1 and 2.
+
+namespace OSEnvironment
+{
+	enum MemoryErrors : int16_t
+	{
+		memFullErr = -108,
+		nilHandleErr = -109,
+		memWZErr = -111,
+		memPurErr = -112,
+		memLockedErr = -117,
+	};
+	
+	// as returned by HGetState
+	enum HandleState : uint8_t
+	{
+		handleIsResource = 0x20,
+		handlePurgeable = 0x40,
+		handleLocked = 0x80,
+	};
+	
+	// The application zone is carved into blocks out of allocations of the guest address space, its extents. It
+	// starts with one extent, and when compacting and purging can't make room, it grows by another, up to
+	// MaximumZoneSize. Blocks never straddle extents.
+	// Bookkeeping lives on the native side, so programs that scribble over the heap can't corrupt it; the only
+	// thing the program sees are the blocks themselves and the master pointers, which live in nonrelocatable
+	// master pointer blocks inside the zone, as they did on the Mac.
+	// Relocatable blocks that are neither locked nor purged are moved around when the zone is compacted, and
+	// purgeable ones are released when compacting isn't enough.
+	// Extents are large allocations, so the FlatAllocator ends each of them with a guard page, and running off the
+	// end of the zone faults. Blocks inside the zone are packed like they were on the Mac, without guard pages
+	// between them: a page per block would waste too much, and compaction would have to move the guards around.
+	// An overrun inside the zone corrupts the next block and goes unnoticed, as it did on the Mac.
+	class MemoryManager
+	{
+		struct Block
+		{
+			uint32_t size; // logical size, as returned by GetHandleSize/GetPtrSize
+			uint32_t capacity; // physical size in the zone
+			uint32_t handle; // 0 for nonrelocatable blocks
+		};
+		
+		struct MasterPointer
+		{
+			uint32_t block; // 0 when the handle is empty
+			uint8_t state;
+		};
+		
+		Common::Allocator& allocator;
+		uint8_t* zone;
+		std::vector<uint8_t*> extentAllocations;
+		std::map<uint32_t, uint32_t> extents; // first block address -> end
+		uint32_t zoneSize;
+		uint32_t freeBytes;
+		int16_t lastError;
+		
+		std::map<uint32_t, Block> blocks;
+		std::map<uint32_t, uint32_t> freeRanges; // address -> size
+		std::unordered_map<uint32_t, MasterPointer> handles;
+		std::vector<uint32_t> freeMasterPointers;
+		
+		uint8_t* ToPointer(uint32_t address);
+		void UpdateZoneHeader();
+		void AddFreeRange(uint32_t address, uint32_t size);
+		void RemoveFreeRange(std::map<uint32_t, uint32_t>::iterator range, uint32_t address, uint32_t size);
+		void RebuildFreeRanges();
+		uint32_t LargestFreeRange() const;
+		uint32_t AllocateBlock(uint32_t size, uint32_t handle);
+		uint32_t MakeRoomAndAllocate(uint32_t size, uint32_t handle);
+		bool ResizeBlock(uint32_t address, uint32_t size);
+		void ReleaseBlock(uint32_t address);
+		void MoveBlock(std::map<uint32_t, Block>::iterator iter, uint32_t to);
+		void Compact(uint32_t needed);
+		bool Grow(uint32_t needed);
+		uint32_t AllocateMasterPointer();
+		void SetMasterPointer(uint32_t handle, uint32_t block);
+		bool IsMovable(const Block& block) const;
+		bool IsPurgeable(const Block& block) const;
+		uint32_t LargestBlockAfterCompaction(bool countPurgeable, uint32_t* total) const;
+		void Purge(uint32_t handle);
+		size_t PurgeAll();
+		MasterPointer* GetMasterPointer(uint32_t handle);
+		
+	public:
+		static const uint32_t DefaultZoneSize = 0x2000000;
+		static const uint32_t MaximumZoneSize = 0x40000000;
+		static const uint32_t ExtentGranularity = 0x100000;
+		static const uint32_t ZoneHeaderSize = 0x40; // room for the Zone record
+		static const uint32_t BlockGranularity = 8;
+		static const uint32_t MasterPointerCount = 64; // per MoreMasters call
+		
+		// zoneSize is the size of the first extent
+		explicit MemoryManager(Common::Allocator& allocator, uint32_t zoneSize = DefaultZoneSize);
+		MemoryManager(const MemoryManager&) = delete;
+		
+		// Like MemError, this is the result of the last call that can fail; 0 means success.
+		int16_t MemError() const;
+		uint32_t Zone() const;
+		bool IsHandle(uint32_t handle) const;
+		bool IsPointer(uint32_t pointer) const;
+		
+		uint32_t NewPtr(uint32_t size, bool clear);
+		void DisposePtr(uint32_t pointer);
+		uint32_t GetPtrSize(uint32_t pointer);
+		void SetPtrSize(uint32_t pointer, uint32_t size);
+		
+		void MoreMasters();
+		uint32_t NewHandle(uint32_t size, bool clear);
+		uint32_t NewEmptyHandle();
+		void DisposeHandle(uint32_t handle);
+		uint32_t GetHandleSize(uint32_t handle);
+		void SetHandleSize(uint32_t handle, uint32_t size);
+		void EmptyHandle(uint32_t handle);
+		void ReallocateHandle(uint32_t handle, uint32_t size);
+		uint32_t RecoverHandle(uint32_t pointer);
+		
+		uint8_t HGetState(uint32_t handle);
+		void HSetState(uint32_t handle, uint8_t state);
+		void SetHandleFlag(uint32_t handle, HandleState flag, bool value);
+		void MoveHHi(uint32_t handle);
+		
+		// results are in bytes
+		uint32_t FreeMem() const;
+		uint32_t MaxBlock() const;
+		uint32_t CompactMem(uint32_t needed);
+		void PurgeMem(uint32_t needed);
+		uint32_t MaxMem();
+		uint32_t GrowSpace() const;
+		void PurgeSpace(uint32_t& total, uint32_t& contiguous) const;
+		
+		~MemoryManager();
+	};
+}
+
+#endif /* defined(__Classix__MemoryManager__) */
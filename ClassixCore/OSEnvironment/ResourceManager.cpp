@@ -19,36 +19,26 @@
 // Classix. If not, see http://www.gnu.org/licenses/.
 //
 
-#include <sstream>
 #include <algorithm>
 #include <iterator>
 #include <cassert>
+#include <vector>
 
 #include "ResourceManager.h"
 #include "BigEndian.h"
-#include "FileMapping.h"
+#include "GuestLayout.h"
 #include "Managers.h"
 
 using namespace Common;
 
 namespace
 {
-	inline std::string StringFromFourCharCode(uint32_t fourCC)
-	{
-		char result[5] = {0};
-		result[0] = fourCC >> 24;
-		result[1] = (fourCC >> 16) & 0xff;
-		result[2] = (fourCC >> 8) & 0xff;
-		result[3] = fourCC & 0xff;
-		return result;
-	}
-	
 	struct ResourceForkHeader
 	{
-		UInt32 resourceDataOffset;
-		UInt32 resourceMapOffset;
-		UInt32 resourceDataLength;
-		UInt32 resourceMapLength;
+		BigEndian::UInt32 resourceDataOffset;
+		BigEndian::UInt32 resourceMapOffset;
+		BigEndian::UInt32 resourceDataLength;
+		BigEndian::UInt32 resourceMapLength;
 	};
 	
 	struct ResourceForkBaseData
@@ -62,25 +52,25 @@ namespace
 	{
 		// ununsed
 		ResourceForkHeader headerCopy;
-		UInt32 nextResourceMap;
-		UInt16 fileReference;
+		BigEndian::UInt32 nextResourceMap;
+		BigEndian::UInt16 fileReference;
 		
-		UInt16 attributes;
-		UInt16 typeListOffset;
-		UInt16 nameListOffset;
+		BigEndian::UInt16 attributes;
+		BigEndian::UInt16 typeListOffset;
+		BigEndian::UInt16 nameListOffset;
 	};
 	
 	struct ResourceType
 	{
-		UInt32 identifier;
-		UInt16 itemCount;
-		UInt16 referenceListOffset;
+		BigEndian::UInt32 identifier;
+		BigEndian::UInt16 itemCount;
+		BigEndian::UInt16 referenceListOffset;
 	};
 	
 	struct ResourceReference
 	{
-		UInt16 resourceId;
-		UInt16 nameOffset;
+		BigEndian::UInt16 resourceId;
+		BigEndian::UInt16 nameOffset;
 		uint8_t attributes;
 		uint8_t resourceDataOffset[3];
 		uint32_t resourceHandle; // unused
@@ -94,20 +84,19 @@ namespace
 
 namespace OSEnvironment
 {
-	ResourceCatalog::ResourceCatalog(Common::Allocator& allocator, const std::string& path)
-	: allocator(allocator)
+	ResourceCatalog::ResourceCatalog(Common::Allocator& allocator, MemoryManager& memory, const std::string& path)
+	: allocator(allocator), memory(memory), fork(path + "/..namedfork/rsrc")
 	{
 		// FIXME check for buffer overflows!
 		
-		FileMapping mapping(path + "/..namedfork/rsrc");
-		const uint8_t* rsrc = reinterpret_cast<const uint8_t*>(mapping.begin());
+		const uint8_t* rsrc = reinterpret_cast<const uint8_t*>(fork.begin());
 		const ResourceForkBaseData* base = reinterpret_cast<const ResourceForkBaseData*>(rsrc);
 		
 		systemData = allocator.Allocate<std::array<uint8_t, 0x70>>(path + " rsrc system data");
 		applicationData = allocator.Allocate<std::array<uint8_t, 0x80>>(path + " rsrc application data");
 		
-		std::copy(std::begin(base->systemData), std::end(base->systemData), systemData->begin());
-		std::copy(std::begin(base->applicationData), std::end(base->applicationData), applicationData->begin());
+		GuestLayout::CopyToGuest(systemData->data(), base->systemData, sizeof base->systemData);
+		GuestLayout::CopyToGuest(applicationData->data(), base->applicationData, sizeof base->applicationData);
 		
 		const uint8_t* dataBegin = rsrc + base->header.resourceDataOffset;
 		const uint8_t* dataEnd = dataBegin + base->header.resourceDataLength;
@@ -115,7 +104,7 @@ namespace OSEnvironment
 		const ResourceMapHeader* mapHeader = reinterpret_cast<const ResourceMapHeader*>(mapBegin);
 		
 		const uint8_t* typeListBegin = mapBegin + mapHeader->typeListOffset;
-		uint16_t typeCount = *reinterpret_cast<const UInt16*>(typeListBegin) + 1;
+		uint16_t typeCount = *reinterpret_cast<const BigEndian::UInt16*>(typeListBegin) + 1;
 		resourcesById.reserve(typeCount);
 		resourcesByName.reserve(typeCount);
 		
@@ -131,12 +120,16 @@ namespace OSEnvironment
 			idResourceMap.reserve(itemCount);
 			nameResourceMap.reserve(itemCount);
 			
-			std::string resourceTypeName = StringFromFourCharCode(type.identifier);
 			for (size_t j = 0; j < itemCount; j++)
 			{
 				ResourceEntry entry = {
 					.id = resourceReference->resourceId,
-					.attributes = resourceReference->attributes
+					.name = std::string(),
+					.attributes = resourceReference->attributes,
+					.source = nullptr,
+					.size = 0,
+					.allocator = &allocator,
+					.handle = 0,
 				};
 				
 				if (resourceReference->nameOffset != 0xffff)
@@ -150,27 +143,20 @@ namespace OSEnvironment
 				uint32_t offset = resourceReference->ResourceDataOffset();
 				const uint8_t* dataLocation = dataBegin + offset;
 				assert(dataLocation + 4 <= dataEnd && "Overflowing read for resource data length");
-				uint32_t dataLength = *reinterpret_cast<const UInt32*>(dataLocation);
-				dataLocation += sizeof dataLength;
-				assert(dataLocation + dataLength <= dataEnd && "Resource data overflows");
+				entry.size = *reinterpret_cast<const BigEndian::UInt32*>(dataLocation);
+				entry.source = dataLocation + sizeof entry.size;
+				assert(entry.source + entry.size <= dataEnd && "Resource data overflows");
 				
-				std::stringstream allocationName;
-				allocationName << "'" << resourceTypeName << "' Resource #" << resourceReference->resourceId;
-				if (entry.name.length() > 0)
+				ResourceEntry& indexed = idResourceMap[entry.id];
+				indexed = std::move(entry);
+				if (indexed.name.length() > 0)
 				{
-					allocationName << " (\"" << entry.name << "\")";
+					nameResourceMap[indexed.name] = &indexed;
 				}
 				
-				// allocate room for the handle as well
-				entry._begin = allocator.Allocate(allocationName.str(), dataLength + 4);
-				entry._end = entry.begin() + dataLength;
-				entry.handle() = allocator.ToIntPtr(entry.begin());
-				std::copy(dataLocation, dataLocation + dataLength, entry.begin());
-				
-				idResourceMap[entry.id] = entry;
-				if (entry.name.length() > 0)
+				if (indexed.attributes & resPreload)
 				{
-					nameResourceMap[entry.name] = &idResourceMap[entry.id];
+					Load(&indexed);
 				}
 				
 				resourceReference++;
@@ -179,17 +165,63 @@ namespace OSEnvironment
 	}
 	
 	ResourceCatalog::ResourceCatalog(ResourceCatalog&& that)
-	: allocator(that.allocator)
+	: allocator(that.allocator), memory(that.memory), fork(std::move(that.fork))
 	{
 		systemData = that.systemData;
 		applicationData = that.applicationData;
 		resourcesById.swap(that.resourcesById);
 		resourcesByName.swap(that.resourcesByName);
+		loadedResources.swap(that.loadedResources);
 		
 		that.systemData = nullptr;
 		that.applicationData = nullptr;
 	}
 	
+	ResourceEntry* ResourceCatalog::Load(ResourceEntry* entry)
+	{
+		if (entry->IsLoaded())
+		{
+			if (*allocator.ToPointer<UInt32>(entry->handle) != 0)
+				return entry;
+			
+			// the zone purged it to make room; load it again in the same handle
+			memory.ReallocateHandle(entry->handle, entry->size);
+			if (memory.MemError() != 0)
+				return nullptr;
+		}
+		else
+		{
+			entry->handle = memory.NewHandle(entry->size, false);
+			if (entry->handle == 0)
+				return nullptr;
+			
+			loadedResources[entry->handle] = entry;
+		}
+		
+		// resLocked and resPurgeable only take effect once the data is in
+		uint8_t state = handleIsResource;
+		if (entry->attributes & resLocked)
+			state |= handleLocked;
+		if (entry->attributes & resPurgeable)
+			state |= handlePurgeable;
+		
+		GuestLayout::CopyToGuest(entry->begin(), entry->source, entry->size);
+		memory.HSetState(entry->handle, state);
+		return entry;
+	}
+	
+	void ResourceCatalog::Unload(ResourceEntry* entry)
+	{
+		loadedResources.erase(entry->handle);
+		memory.DisposeHandle(entry->handle);
+		entry->handle = 0;
+	}
+	
+	bool ResourceCatalog::IsLocked(const ResourceEntry* entry)
+	{
+		return (memory.HGetState(entry->handle) & handleLocked) != 0;
+	}
+	
 	ResourceEntry* ResourceCatalog::GetRawResource(const FourCharCode& type, uint16_t identifier)
 	{
 		auto topLevelIter = resourcesById.find(type.code);
@@ -198,7 +230,7 @@ namespace OSEnvironment
 			auto iter = topLevelIter->second.find(identifier);
 			if (iter != topLevelIter->second.end())
 			{
-				return &iter->second;
+				return Load(&iter->second);
 			}
 		}
 		return nullptr;
@@ -212,12 +244,61 @@ namespace OSEnvironment
 			auto iter = topLevelIter->second.find(identifier);
 			if (iter != topLevelIter->second.end())
 			{
-				return iter->second;
+				return Load(iter->second);
 			}
 		}
 		return nullptr;
 	}
 	
+	bool ResourceCatalog::ReleaseResource(uint32_t handle)
+	{
+		auto iter = loadedResources.find(handle);
+		if (iter == loadedResources.end())
+			return false;
+		
+		if (!IsLocked(iter->second))
+			Unload(iter->second);
+		return true;
+	}
+	
+	bool ResourceCatalog::DetachResource(uint32_t handle)
+	{
+		auto iter = loadedResources.find(handle);
+		if (iter == loadedResources.end())
+			return false;
+		
+		// the handle now belongs to the program; the next GetResource will load a fresh copy
+		ResourceEntry* entry = iter->second;
+		memory.SetHandleFlag(entry->handle, handleIsResource, false);
+		loadedResources.erase(iter);
+		entry->handle = 0;
+		return true;
+	}
+	
+	bool ResourceCatalog::DisposeResource(uint32_t handle)
+	{
+		auto iter = loadedResources.find(handle);
+		if (iter == loadedResources.end())
+			return false;
+		
+		Unload(iter->second);
+		return true;
+	}
+	
+	size_t ResourceCatalog::ReleaseUnlockedResources()
+	{
+		std::vector<ResourceEntry*> unlocked;
+		for (const auto& pair : loadedResources)
+		{
+			if (!IsLocked(pair.second))
+				unlocked.push_back(pair.second);
+		}
+		
+		for (ResourceEntry* entry : unlocked)
+			Unload(entry);
+		return unlocked.size();
+	}
+	
 	void ResourceCatalog::dump()
 	{
 		for (const auto& pair : resourcesById)
@@ -233,17 +314,20 @@ namespace OSEnvironment
 	
 	ResourceCatalog::~ResourceCatalog()
 	{
+		for (const auto& pair : loadedResources)
+			memory.DisposeHandle(pair.first);
+		
 		allocator.Deallocate(systemData);
 		allocator.Deallocate(applicationData);
 	}
 	
-	ResourceManager::ResourceManager(Common::Allocator& allocator)
-	: allocator(allocator)
+	ResourceManager::ResourceManager(Common::Allocator& allocator, MemoryManager& memory)
+	: allocator(allocator), memory(memory)
 	{ }
 	
 	void ResourceManager::LoadFileResources(const std::string &filePath)
 	{
-		ResourceCatalog catalog(allocator, filePath);
+		ResourceCatalog catalog(allocator, memory, filePath);
 		catalogs.emplace_back(std::move(catalog));
 	}
 	
@@ -266,4 +350,42 @@ namespace OSEnvironment
 		}
 		return nullptr;
 	}
+	
+	bool ResourceManager::ReleaseResource(uint32_t handle)
+	{
+		for (ResourceCatalog& catalog : catalogs)
+		{
+			if (catalog.ReleaseResource(handle))
+				return true;
+		}
+		return false;
+	}
+	
+	bool ResourceManager::DetachResource(uint32_t handle)
+	{
+		for (ResourceCatalog& catalog : catalogs)
+		{
+			if (catalog.DetachResource(handle))
+				return true;
+		}
+		return false;
+	}
+	
+	bool ResourceManager::DisposeResource(uint32_t handle)
+	{
+		for (ResourceCatalog& catalog : catalogs)
+		{
+			if (catalog.DisposeResource(handle))
+				return true;
+		}
+		return false;
+	}
+	
+	size_t ResourceManager::ReleaseUnlockedResources()
+	{
+		size_t released = 0;
+		for (ResourceCatalog& catalog : catalogs)
+			released += catalog.ReleaseUnlockedResources();
+		return released;
+	}
 }
@@ -31,27 +31,45 @@
 
 #include "Allocator.h"
 #include "BigEndian.h"
+#include "FileMapping.h"
 #include "FourCharCode.h"
+#include "MemoryManager.h"
 
 // Information gathered from Inside Macintosh vol. 1 pages 128-130.
 // It's funny, that book is older than me.
 
 namespace OSEnvironment
 {
+	enum ResourceAttributes : uint8_t
+	{
+		resChanged = 0x02,
+		resPreload = 0x04,
+		resProtected = 0x08,
+		resLocked = 0x10,
+		resPurgeable = 0x20,
+		resSysHeap = 0x40,
+	};
+	
+	// Resources are only indexed when their file is opened. Their data stays in the read-only mapping of the
+	// resource fork (source) until they are first asked for; then, a handle is allocated in the application zone
+	// and the data is copied into it. handle is 0 as long as the resource isn't loaded.
+	// Resource handles are relocatable like any other: the pointers that begin() and end() return are only good
+	// until the zone moves memory, unless the handle is locked.
 	struct ResourceEntry
 	{
 		uint16_t id;
 		std::string name;
 		uint8_t attributes;
-		uint8_t* _begin;
-		uint8_t* _end;
-		
-		inline Common::UInt32& handle() { return *reinterpret_cast<Common::UInt32*>(_begin); }
-		inline uint8_t* begin() { return _begin + sizeof(uint32_t); }
-		inline uint8_t* end() { return _end; }
-		inline Common::UInt32 handle() const { return *reinterpret_cast<const Common::UInt32*>(_begin); }
-		inline const uint8_t* begin() const { return _begin; }
-		inline const uint8_t* end() const { return _end; }
+		const uint8_t* source;
+		uint32_t size;
+		Common::Allocator* allocator;
+		uint32_t handle;
+		
+		inline bool IsLoaded() const { return handle != 0; }
+		inline uint8_t* begin() { return allocator->ToPointer<uint8_t>(*allocator->ToPointer<Common::UInt32>(handle)); }
+		inline uint8_t* end() { return begin() + size; }
+		inline const uint8_t* begin() const { return allocator->ToPointer<uint8_t>(*allocator->ToPointer<Common::UInt32>(handle)); }
+		inline const uint8_t* end() const { return begin() + size; }
 	};
 	
 	class ResourceCatalog
@@ -59,12 +77,19 @@ namespace OSEnvironment
 		friend class ResourceManager;
 		
 		Common::Allocator& allocator;
+		MemoryManager& memory;
+		Common::FileMapping fork;
 		std::array<uint8_t, 0x70>* systemData;
 		std::array<uint8_t, 0x80>* applicationData;
 		std::unordered_map<uint32_t, std::unordered_map<uint16_t, ResourceEntry>> resourcesById;
 		std::unordered_map<uint32_t, std::unordered_map<std::string, ResourceEntry*>> resourcesByName;
+		std::unordered_map<uint32_t, ResourceEntry*> loadedResources; // by handle address
 		
-		explicit ResourceCatalog(Common::Allocator& allocator, const std::string& filePath);
+		ResourceCatalog(Common::Allocator& allocator, MemoryManager& memory, const std::string& filePath);
+		
+		ResourceEntry* Load(ResourceEntry* entry);
+		void Unload(ResourceEntry* entry);
+		bool IsLocked(const ResourceEntry* entry);
 		
 	public:
 		ResourceCatalog(const ResourceCatalog&) = delete;
@@ -73,6 +98,11 @@ namespace OSEnvironment
 		ResourceEntry* GetRawResource(const Common::FourCharCode& type, uint16_t identifier);
 		ResourceEntry* GetRawResource(const Common::FourCharCode& type, const std::string& identifier);
 		
+		bool ReleaseResource(uint32_t handle);
+		bool DetachResource(uint32_t handle);
+		bool DisposeResource(uint32_t handle);
+		size_t ReleaseUnlockedResources();
+		
 		void dump();
 		
 		~ResourceCatalog();
@@ -81,16 +111,25 @@ namespace OSEnvironment
 	class ResourceManager
 	{
 		Common::Allocator& allocator;
+		MemoryManager& memory;
 		std::deque<ResourceCatalog> catalogs;
 		
 	public:
-		ResourceManager(Common::Allocator& allocator);
+		ResourceManager(Common::Allocator& allocator, MemoryManager& memory);
 		
 		void LoadFileResources(const std::string& filePath);
 		
 		ResourceEntry* GetRawResource(const Common::FourCharCode& type, uint16_t identifier);
 		ResourceEntry* GetRawResource(const Common::FourCharCode& type, const std::string& identifier);
 		
+		// These take a resource handle, as returned by GetResource. They return false when the handle doesn't
+		// belong to a resource. Resources whose handle is locked are never released, except by DisposeResource,
+		// which is what DisposeHandle does to a resource.
+		bool ReleaseResource(uint32_t handle);
+		bool DetachResource(uint32_t handle);
+		bool DisposeResource(uint32_t handle);
+		size_t ReleaseUnlockedResources();
+		
 		template<typename TResourceType>
 		TResourceType* GetResource(uint16_t identifier)
 		{
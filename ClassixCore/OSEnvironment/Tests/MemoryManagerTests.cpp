@@ -0,0 +1,215 @@
+//
+// MemoryManagerTests.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include <cstring>
+#include "UnitTest.h"
+#include "FlatAllocator.h"
+#include "MemoryManager.h"
+
+using namespace OSEnvironment;
+
+namespace
+{
+	// A small zone, so that tests can fill it up. Blocks are handed out from the bottom of the zone, right after the
+	// first master pointer block.
+	struct SmallZone
+	{
+		static const uint32_t Size = 0x10000;
+		
+		Common::FlatAllocator allocator;
+		MemoryManager memory;
+		
+		SmallZone()
+		: memory(allocator, Size)
+		{}
+		
+		uint32_t Dereference(uint32_t handle)
+		{
+			return *allocator.ToPointer<Common::UInt32>(handle);
+		}
+		
+		uint32_t NewHandle(uint32_t size, uint8_t fill)
+		{
+			uint32_t handle = memory.NewHandle(size, false);
+			memset(allocator.ToPointer<uint8_t>(Dereference(handle)), fill, size);
+			return handle;
+		}
+		
+		bool Holds(uint32_t handle, uint32_t size, uint8_t fill)
+		{
+			const uint8_t* bytes = allocator.ToPointer<uint8_t>(Dereference(handle));
+			for (uint32_t i = 0; i < size; i++)
+			{
+				if (bytes[i] != fill)
+					return false;
+			}
+			return true;
+		}
+	};
+}
+
+TEST(MemoryManager, CompactionMovesHandlesAndKeepsTheirContents)
+{
+	SmallZone zone;
+	uint32_t first = zone.NewHandle(0x100, 1);
+	uint32_t second = zone.NewHandle(0x100, 2);
+	uint32_t third = zone.NewHandle(0x100, 3);
+	uint32_t firstBlock = zone.Dereference(first);
+	uint32_t freeBefore = zone.memory.FreeMem();
+	
+	zone.memory.DisposeHandle(first);
+	uint32_t largest = zone.memory.CompactMem(UINT32_MAX);
+	CHECK_EQUAL(zone.memory.MemError(), 0);
+	CHECK_EQUAL(zone.Dereference(second), firstBlock);
+	CHECK_EQUAL(zone.Dereference(third), firstBlock + 0x100);
+	CHECK(zone.Holds(second, 0x100, 2));
+	CHECK(zone.Holds(third, 0x100, 3));
+	
+	// everything that's free is in one piece now
+	CHECK_EQUAL(zone.memory.FreeMem(), freeBefore + 0x100);
+	CHECK_EQUAL(largest, zone.memory.FreeMem());
+	CHECK_EQUAL(zone.memory.MaxBlock(), largest);
+}
+
+TEST(MemoryManager, LockedHandlesStayPut)
+{
+	SmallZone zone;
+	uint32_t first = zone.NewHandle(0x100, 1);
+	uint32_t locked = zone.NewHandle(0x100, 2);
+	uint32_t third = zone.NewHandle(0x100, 3);
+	uint32_t fourth = zone.NewHandle(0x100, 4);
+	uint32_t lockedBlock = zone.Dereference(locked);
+	uint32_t thirdBlock = zone.Dereference(third);
+	
+	zone.memory.SetHandleFlag(locked, handleLocked, true);
+	zone.memory.DisposeHandle(first);
+	zone.memory.DisposeHandle(third);
+	
+	// the free space below the locked handle can't be reached by the handles above it
+	CHECK_EQUAL(zone.memory.MaxBlock(), zone.memory.FreeMem() - 0x100);
+	
+	zone.memory.CompactMem(UINT32_MAX);
+	CHECK_EQUAL(zone.Dereference(locked), lockedBlock);
+	CHECK_EQUAL(zone.Dereference(fourth), thirdBlock);
+	CHECK(zone.Holds(locked, 0x100, 2));
+	CHECK(zone.Holds(fourth, 0x100, 4));
+	
+	zone.memory.MoveHHi(locked);
+	CHECK_EQUAL(zone.memory.MemError(), memLockedErr);
+}
+
+TEST(MemoryManager, CompactMemStopsOnceThereIsRoom)
+{
+	SmallZone zone;
+	uint32_t first = zone.NewHandle(0x400, 1);
+	uint32_t second = zone.NewHandle(0x800, 2);
+	uint32_t third = zone.NewHandle(0x400, 3);
+	uint32_t fourth = zone.NewHandle(0x800, 4);
+	uint32_t fifth = zone.NewHandle(0x400, 5);
+	CHECK(zone.memory.NewPtr(zone.memory.MaxBlock(), false) != 0); // so that the only free space is in the holes
+	uint32_t thirdBlock = zone.Dereference(third);
+	uint32_t fifthBlock = zone.Dereference(fifth);
+	zone.memory.DisposeHandle(second);
+	zone.memory.DisposeHandle(fourth);
+	
+	// there already is a free block that large, so nothing moves
+	CHECK(zone.memory.CompactMem(0x800) >= 0x800);
+	CHECK_EQUAL(zone.Dereference(third), thirdBlock);
+	CHECK_EQUAL(zone.Dereference(fifth), fifthBlock);
+	
+	// moving the third handle down merges both holes, and that's enough
+	zone.memory.CompactMem(0x1000);
+	CHECK_EQUAL(zone.Dereference(third), zone.Dereference(first) + 0x400);
+	CHECK_EQUAL(zone.Dereference(fifth), fifthBlock);
+	CHECK(zone.Holds(third, 0x400, 3));
+	
+	// and everything moves when it isn't
+	zone.memory.CompactMem(0x2000);
+	CHECK_EQUAL(zone.Dereference(fifth), zone.Dereference(third) + 0x400);
+	CHECK(zone.Holds(fifth, 0x400, 5));
+}
+
+TEST(MemoryManager, PurgeableHandlesAreReleasedBeforeTheZoneGrows)
+{
+	SmallZone zone;
+	uint32_t purgeable = zone.NewHandle(0x8000, 1);
+	uint32_t kept = zone.NewHandle(0x100, 2);
+	zone.memory.SetHandleFlag(purgeable, handlePurgeable, true);
+	uint32_t zoneEnd = zone.memory.Zone() + SmallZone::Size;
+	
+	uint32_t pointer = zone.memory.NewPtr(0x9000, false);
+	CHECK(pointer != 0);
+	CHECK(pointer + 0x9000 <= zoneEnd);
+	CHECK_EQUAL(zone.Dereference(purgeable), 0u);
+	CHECK(zone.Holds(kept, 0x100, 2));
+	
+	zone.memory.GetHandleSize(purgeable);
+	CHECK_EQUAL(zone.memory.MemError(), nilHandleErr);
+}
+
+TEST(MemoryManager, ZoneGrowsWhenFull)
+{
+	SmallZone zone;
+	uint32_t zoneBegin = zone.memory.Zone();
+	uint32_t growSpace = zone.memory.GrowSpace();
+	uint32_t handle = zone.NewHandle(0x100, 1);
+	
+	uint32_t pointer = zone.memory.NewPtr(0x20000, true);
+	CHECK(pointer != 0);
+	CHECK_EQUAL(zone.memory.MemError(), 0);
+	CHECK(pointer < zoneBegin || pointer >= zoneBegin + SmallZone::Size);
+	CHECK_EQUAL(zone.memory.Zone(), zoneBegin);
+	CHECK_EQUAL(zone.memory.GetPtrSize(pointer), 0x20000u);
+	CHECK_EQUAL(zone.memory.GrowSpace(), growSpace - MemoryManager::DefaultZoneSize);
+	CHECK(zone.Holds(handle, 0x100, 1));
+	
+	// the new extent is as usable as the first one
+	uint32_t freeBefore = zone.memory.FreeMem();
+	zone.memory.DisposePtr(pointer);
+	CHECK_EQUAL(zone.memory.FreeMem(), freeBefore + 0x20000);
+	CHECK(zone.memory.MaxBlock() >= MemoryManager::DefaultZoneSize);
+	
+	// but it can't grow past the maximum
+	CHECK_EQUAL(zone.memory.NewPtr(MemoryManager::MaximumZoneSize, false), 0u);
+	CHECK_EQUAL(zone.memory.MemError(), memFullErr);
+}
+
+TEST(MemoryManager, SetHandleSizeMovesBlockedHandles)
+{
+	SmallZone zone;
+	uint32_t handle = zone.NewHandle(0x100, 1);
+	uint32_t pointer = zone.memory.NewPtr(0x10, false);
+	uint32_t block = zone.Dereference(handle);
+	CHECK_EQUAL(pointer, block + 0x100);
+	
+	zone.memory.SetHandleSize(handle, 0x200);
+	CHECK_EQUAL(zone.memory.MemError(), 0);
+	CHECK(zone.Dereference(handle) != block);
+	CHECK_EQUAL(zone.memory.GetHandleSize(handle), 0x200u);
+	CHECK(zone.Holds(handle, 0x100, 1));
+	
+	// locked handles can't move, so they can't grow past the pointer either
+	zone.memory.SetHandleFlag(handle, handleLocked, true);
+	uint32_t other = zone.NewHandle(0x10, 2);
+	CHECK_EQUAL(zone.Dereference(other), block);
+	zone.memory.SetHandleSize(other, 0x200);
+	CHECK_EQUAL(zone.memory.MemError(), 0);
+}
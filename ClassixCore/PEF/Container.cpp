@@ -25,10 +25,14 @@
 namespace PEF
 {
 	Container::Container(Common::Allocator& allocator, const void* base, const void* end)
-	: Base(static_cast<const uint8_t*>(base))
+	: Container(allocator, base, end, nullptr)
+	{ }
+	
+	Container::Container(Common::Allocator& allocator, const void* base, const void* end, const std::vector<const uint8_t*>* sectionImages)
+	: allocator(allocator)
 	, header(ContainerHeader::FromPointer(base))
 	, loader(nullptr)
-	, allocator(allocator)
+	, Base(static_cast<const uint8_t*>(base))
 	, End(static_cast<const uint8_t*>(end))
 	{
 		if (header == nullptr)
@@ -66,7 +70,10 @@ namespace PEF
 					ss << "Instantiable section #" << id;
 					sectionName = ss.str();
 				}
-				this->sections.emplace_back(allocator, sectionHeader, sectionName, Base, static_cast<const uint8_t*>(end));
+				if (sectionImages == nullptr)
+					this->sections.emplace_back(allocator, sectionHeader, sectionName, Base, static_cast<const uint8_t*>(end));
+				else
+					this->sections.emplace_back(allocator, sectionHeader, sectionName, sectionImages->at(id));
 			}
 		}
 		
@@ -49,6 +49,8 @@ namespace PEF
 		const uint8_t* End;
 		
 		Container(Common::Allocator& allocator, const void* base, const void* end);
+		// sectionImages has the contents of each instantiable section, in order, instead of instantiating them
+		Container(Common::Allocator& allocator, const void* base, const void* end, const std::vector<const uint8_t*>* sectionImages);
 		
 		iterator begin();
 		iterator end();
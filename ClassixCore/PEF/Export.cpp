@@ -20,6 +20,8 @@
 //
 
 #include "Export.h"
+#include <algorithm>
+#include <cstring>
 
 namespace
 {
@@ -30,9 +32,9 @@ namespace
 	
 	struct ExportedSymbolEntry
 	{
-		PEF::UInt32 ClassAndName;
-		PEF::UInt32 SymbolValue;
-		PEF::SInt16 SectionIndex;
+		Common::BigEndian::UInt32 ClassAndName;
+		Common::BigEndian::UInt32 SymbolValue;
+		Common::BigEndian::SInt16 SectionIndex;
 	} __attribute__((packed));
 }
 
@@ -42,65 +44,124 @@ namespace PEF
 	{
 		int32_t hashValue = 0;
 		
+		// the hash is computed over unsigned characters, which only matters for names that aren't plain ASCII
 		for (auto iter = symbolName.begin(); iter != symbolName.end(); iter++)
-			hashValue = PseudoRotate(hashValue) ^ *iter;
+			hashValue = PseudoRotate(hashValue) ^ static_cast<uint8_t>(*iter);
 		
 		return ((uint32_t)symbolName.length() << 16) | ((uint16_t)((hashValue ^ (hashValue >> 16)) & 0xffff));
 	}
 	
+	ExportHashTable::name_iterator::name_iterator(const ExportHashTable* table, uint32_t index)
+	: table(table), index(index)
+	{ }
+	
+	std::string ExportHashTable::name_iterator::operator*() const
+	{
+		return table->SymbolName(index);
+	}
+	
+	ExportHashTable::name_iterator& ExportHashTable::name_iterator::operator++()
+	{
+		index++;
+		return *this;
+	}
+	
+	ExportHashTable::name_iterator ExportHashTable::name_iterator::operator++(int)
+	{
+		name_iterator copy = *this;
+		index++;
+		return copy;
+	}
+	
+	bool ExportHashTable::name_iterator::operator==(const name_iterator& that) const
+	{
+		return table == that.table && index == that.index;
+	}
+	
+	bool ExportHashTable::name_iterator::operator!=(const name_iterator& that) const
+	{
+		return !(*this == that);
+	}
+	
 	ExportHashTable::ExportHashTable(const LoaderHeader* header)
-	: symbolTable(2, HashSymbolName)
 	{
 		const uint8_t* base = reinterpret_cast<const uint8_t*>(header);
-		const char* nameTable = reinterpret_cast<const char*>(base) + header->LoaderStringsOffset;
-		uint32_t exportedSymbols = header->ExportedSymbolCount;
-		
-		const Common::UInt32* hashTableStart = reinterpret_cast<const Common::UInt32*>(base + header->ExportHashOffset);
-		uint32_t hashCount = 1 << header->ExportHashTablePower;
-		const Common::UInt32* exportKeyTable = hashTableStart + hashCount;
-		const ExportedSymbolEntry* exportSymbolTable = reinterpret_cast<const ExportedSymbolEntry*>(exportKeyTable + exportedSymbols);
+		nameTable = reinterpret_cast<const char*>(base) + header->LoaderStringsOffset;
+		hashTablePower = header->ExportHashTablePower;
+		symbolCount = header->ExportedSymbolCount;
 		
-		for (uint32_t i = 0; i < exportedSymbols; i++)
-		{
-			const ExportedSymbolEntry& symbolEntry = exportSymbolTable[i];
-			ExportedSymbol symbol;
-			symbol.Class = static_cast<SymbolClasses::Enum>(symbolEntry.ClassAndName >> 24);
-			const char* nameBegin = nameTable + (symbolEntry.ClassAndName & 0xffffff);
-			const char* nameEnd = nameBegin + (exportKeyTable[i] >> 16);
-			symbol.SymbolName = std::string(nameBegin, nameEnd);
-			symbol.SectionIndex = symbolEntry.SectionIndex;
-			symbol.Offset = symbolEntry.SymbolValue;
-			symbolNames.push_back(symbol.SymbolName);
-			symbolTable[symbol.SymbolName] = std::move(symbol);
-		}
+		hashSlots = reinterpret_cast<const Common::BigEndian::UInt32*>(base + header->ExportHashOffset);
+		keyTable = hashSlots + (1 << hashTablePower);
+		symbolTable = reinterpret_cast<const uint8_t*>(keyTable + symbolCount);
+	}
+	
+	std::string ExportHashTable::SymbolName(uint32_t index) const
+	{
+		const ExportedSymbolEntry& symbolEntry = reinterpret_cast<const ExportedSymbolEntry*>(symbolTable)[index];
+		const char* nameBegin = nameTable + (symbolEntry.ClassAndName & 0xffffff);
+		return std::string(nameBegin, nameBegin + (keyTable[index] >> 16));
 	}
 	
-	const ExportedSymbol* ExportHashTable::Find(const std::string &name) const
+	void ExportHashTable::FillSymbol(uint32_t index, ExportedSymbol& symbol) const
 	{
-		auto findResult = symbolTable.find(name);
-		if (findResult == symbolTable.end())
-			return nullptr;
+		const ExportedSymbolEntry& symbolEntry = reinterpret_cast<const ExportedSymbolEntry*>(symbolTable)[index];
+		symbol.Class = static_cast<SymbolClasses::Enum>(symbolEntry.ClassAndName >> 24);
+		symbol.SectionIndex = symbolEntry.SectionIndex;
+		symbol.Offset = symbolEntry.SymbolValue;
+	}
+	
+	bool ExportHashTable::Find(const std::string& name, ExportedSymbol& symbol) const
+	{
+		if (symbolCount == 0)
+			return false;
+		
+		// a slot has the number of keys that hash to it in its high 14 bits, and the index of the first one in the
+		// low 18 bits; keys are the full hash words, which include the name length
+		uint32_t hash = HashSymbolName(name);
+		uint32_t slotIndex = (hash ^ (hash >> hashTablePower)) & ((1 << hashTablePower) - 1);
+		uint32_t slot = hashSlots[slotIndex];
+		uint32_t firstKey = slot & 0x3ffff;
+		uint32_t endKey = std::min(firstKey + (slot >> 18), symbolCount);
 		
-		return &findResult->second;
+		for (uint32_t i = firstKey; i < endKey; i++)
+		{
+			if (keyTable[i] != hash)
+				continue;
+			
+			const ExportedSymbolEntry& symbolEntry = reinterpret_cast<const ExportedSymbolEntry*>(symbolTable)[i];
+			const char* symbolName = nameTable + (symbolEntry.ClassAndName & 0xffffff);
+			if (memcmp(symbolName, name.data(), name.length()) == 0)
+			{
+				symbol.SymbolName = name;
+				FillSymbol(i, symbol);
+				return true;
+			}
+		}
+		return false;
 	}
 	
-	const ExportedSymbol* ExportHashTable::Find(uint32_t index) const
+	bool ExportHashTable::Find(uint32_t index, ExportedSymbol& symbol) const
 	{
-		return Find(symbolNames.at(index));
+		if (index >= symbolCount)
+			return false;
+		
+		symbol.SymbolName = SymbolName(index);
+		FillSymbol(index, symbol);
+		return true;
 	}
 	
 	ExportHashTable::name_iterator ExportHashTable::begin() const
 	{
-		return symbolNames.begin();
+		return name_iterator(this, 0);
 	}
 	
 	ExportHashTable::name_iterator ExportHashTable::end() const
 	{
-		return symbolNames.end();
+		return name_iterator(this, symbolCount);
 	}
 	
 	uint32_t ExportHashTable::SymbolCount() const
 	{
-		return static_cast<uint32_t>(symbolNames.size());
+		return symbolCount;
 	}
 }
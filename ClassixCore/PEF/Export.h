@@ -24,8 +24,7 @@
 
 #include "Structures.h"
 #include <string>
-#include <vector>
-#include <unordered_map>
+#include <iterator>
 
 namespace PEF
 {
@@ -37,23 +36,51 @@ namespace PEF
 		uint32_t Offset;
 	};
 	
+	// Lookups go straight to the hash slots, key table and symbol table of the mapped loader section; nothing is
+	// copied when the table is created. Names are only turned into strings when the exports are enumerated.
 	class ExportHashTable
 	{
 	public:
 		static uint32_t HashSymbolName(const std::string& name);
 		static uint32_t HashSymbol(const ExportedSymbol& symbol);
 		
+		class name_iterator
+		{
+			const ExportHashTable* table;
+			uint32_t index;
+			
+		public:
+			typedef std::input_iterator_tag iterator_category;
+			typedef std::string value_type;
+			typedef ptrdiff_t difference_type;
+			typedef const std::string* pointer;
+			typedef std::string reference;
+			
+			name_iterator(const ExportHashTable* table, uint32_t index);
+			
+			std::string operator*() const;
+			name_iterator& operator++();
+			name_iterator operator++(int);
+			bool operator==(const name_iterator& that) const;
+			bool operator!=(const name_iterator& that) const;
+		};
+		
 	private:
-		typedef uint32_t HashFunction(const std::string&);
-		std::vector<std::string> symbolNames;
-		std::unordered_map<std::string, ExportedSymbol, HashFunction&> symbolTable;
+		const Common::BigEndian::UInt32* hashSlots;
+		const Common::BigEndian::UInt32* keyTable;
+		const uint8_t* symbolTable;
+		const char* nameTable;
+		uint32_t hashTablePower;
+		uint32_t symbolCount;
+		
+		std::string SymbolName(uint32_t index) const;
+		void FillSymbol(uint32_t index, ExportedSymbol& symbol) const;
 		
 	public:
-		typedef std::vector<std::string>::const_iterator name_iterator;
 		ExportHashTable(const LoaderHeader* loaderHeader);
 		
-		const ExportedSymbol* Find(const std::string& name) const;
-		const ExportedSymbol* Find(uint32_t index) const;
+		bool Find(const std::string& name, ExportedSymbol& symbol) const;
+		bool Find(uint32_t index, ExportedSymbol& symbol) const;
 		
 		name_iterator begin() const;
 		name_iterator end() const;
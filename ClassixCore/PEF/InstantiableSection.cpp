@@ -20,6 +20,7 @@
 //
 
 #include "InstantiableSection.h"
+#include "GuestLayout.h"
 
 #include <cstdlib>
 #include <iostream>
@@ -229,10 +230,22 @@ namespace PEF
 				throw std::logic_error("Unknown or uninstantiable section type");
 			}
 		}
+		
+		// images (the other constructor) are already laid out for the guest
+		Common::GuestLayout::FromBigEndian(Data, totalSize);
+	}
+	
+	InstantiableSection::InstantiableSection(Common::Allocator& allocator, const SectionHeader* header, const std::string& name, const uint8_t* image)
+	: allocator(allocator)
+	{
+		this->header = header;
+		Name = name;
+		Data = allocator.Allocate(name, header->ExecutionSize);
+		memcpy(Data, image, header->ExecutionSize);
 	}
 	
 	InstantiableSection::InstantiableSection(InstantiableSection&& that)
-	: Name(std::move(that.Name)), allocator(that.allocator)
+	: allocator(that.allocator), Name(std::move(that.Name))
 	{
 		header = that.header;
 		Data = that.Data;
@@ -38,6 +38,8 @@ namespace PEF
 		uint8_t* Data;
 		
 		InstantiableSection(Common::Allocator& allocator, const SectionHeader* header, const std::string& name, const uint8_t* base, const uint8_t* end);
+		// copies an already instantiated section, like one from the prelinked image cache
+		InstantiableSection(Common::Allocator& allocator, const SectionHeader* header, const std::string& name, const uint8_t* image);
 		InstantiableSection(const InstantiableSection& that) = delete;
 		InstantiableSection(InstantiableSection&& that);
 		
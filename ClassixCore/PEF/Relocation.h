@@ -29,10 +29,10 @@ namespace PEF
 	class Relocation
 	{
 		const RelocationHeader* header;
-		const Common::UInt16* relocationBase;
+		const Common::BigEndian::UInt16* relocationBase;
 		
 	public:
-		typedef const Common::UInt16* iterator;
+		typedef const Common::BigEndian::UInt16* iterator;
 		
 		Relocation(const RelocationHeader* header, const uint8_t* relocationBase);
 		
@@ -49,14 +49,14 @@ namespace
 	
 	const uint32_t macUNIXTimeOffset = 2082844800u;
 	
-	inline time_t MacTimeToUNIXTime(Common::UInt32 macDate)
+	inline time_t MacTimeToUNIXTime(Common::BigEndian::UInt32 macDate)
 	{
 		return macDate - macUNIXTimeOffset;
 	}
 	
-	inline Common::UInt32 UNIXTimeToMacTime(time_t unixDate)
+	inline Common::BigEndian::UInt32 UNIXTimeToMacTime(time_t unixDate)
 	{
-		return Common::UInt32(static_cast<uint32_t>(unixDate + macUNIXTimeOffset));
+		return Common::BigEndian::UInt32(static_cast<uint32_t>(unixDate + macUNIXTimeOffset));
 	}
 	
 	inline uint32_t MacTime()
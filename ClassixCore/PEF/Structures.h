@@ -95,19 +95,19 @@ namespace PEF
 		TypeTag Tag2; // 'peff'
 		TypeTag Architecture; // 'pwpc' or 'm68k'
 		
-		Common::UInt32 FormatVersion; // 1
+		Common::BigEndian::UInt32 FormatVersion; // 1
 		
-		Common::UInt32 DateTimeStamp; // seconds since Jan 1, 1904; use (Get|Set)CreationTime to have UNIX time stamps
+		Common::BigEndian::UInt32 DateTimeStamp; // seconds since Jan 1, 1904; use (Get|Set)CreationTime to have UNIX time stamps
 		
 		// fragment manager stuff
-		Common::UInt32 OldDefVersion;
-		Common::UInt32 OldImpVersion;
-		Common::UInt32 CurrentVersion;
+		Common::BigEndian::UInt32 OldDefVersion;
+		Common::BigEndian::UInt32 OldImpVersion;
+		Common::BigEndian::UInt32 CurrentVersion;
 		
-		Common::UInt16 SectionCount;
-		Common::UInt16 InstSectionCount;
+		Common::BigEndian::UInt16 SectionCount;
+		Common::BigEndian::UInt16 InstSectionCount;
 		
-		Common::UInt32 Reserved; // always 0
+		Common::BigEndian::UInt32 Reserved; // always 0
 	} __attribute__((packed));
 	
 	struct SectionHeader
@@ -118,12 +118,12 @@ namespace PEF
 		
 		SectionHeader();
 		
-		Common::SInt32 NameOffset; // offset to name from name table, or -1 if no name
-		Common::UInt32 DefaultAddress; // preferred address
-		Common::UInt32 ExecutionSize; // the total size required by the section
-		Common::UInt32 UnpackedSize; // size of explicitly initialized data
-		Common::UInt32 PackedSize; // size in this file
-		Common::UInt32 ContainerOffset; // offset from beginning of file to contents
+		Common::BigEndian::SInt32 NameOffset; // offset to name from name table, or -1 if no name
+		Common::BigEndian::UInt32 DefaultAddress; // preferred address
+		Common::BigEndian::UInt32 ExecutionSize; // the total size required by the section
+		Common::BigEndian::UInt32 UnpackedSize; // size of explicitly initialized data
+		Common::BigEndian::UInt32 PackedSize; // size in this file
+		Common::BigEndian::UInt32 ContainerOffset; // offset from beginning of file to contents
 		
 		SectionType SectionType;
 		ShareType ShareType;
@@ -135,8 +135,8 @@ namespace PEF
 	{
 		struct SectionWithOffset
 		{
-			Common::SInt32 Section;
-			Common::UInt32 Offset;
+			Common::BigEndian::SInt32 Section;
+			Common::BigEndian::UInt32 Offset;
 			
 			SectionWithOffset();
 			SectionWithOffset(int32_t section, uint32_t offset);
@@ -158,26 +158,26 @@ namespace PEF
 			};
 		};
 		
-		Common::UInt32 ImportedLibraryCount;
-		Common::UInt32 ImportedSymbolCount;
-		Common::UInt32 RelocSectionCount;
-		Common::UInt32 RelocInstructionOffset;
-		Common::UInt32 LoaderStringsOffset;
-		Common::UInt32 ExportHashOffset;
-		Common::UInt32 ExportHashTablePower;
-		Common::UInt32 ExportedSymbolCount;
+		Common::BigEndian::UInt32 ImportedLibraryCount;
+		Common::BigEndian::UInt32 ImportedSymbolCount;
+		Common::BigEndian::UInt32 RelocSectionCount;
+		Common::BigEndian::UInt32 RelocInstructionOffset;
+		Common::BigEndian::UInt32 LoaderStringsOffset;
+		Common::BigEndian::UInt32 ExportHashOffset;
+		Common::BigEndian::UInt32 ExportHashTablePower;
+		Common::BigEndian::UInt32 ExportedSymbolCount;
 	} __attribute__((packed));
 		
 	struct ImportedLibraryHeader
 	{
-		Common::UInt32 NameOffset;
-		Common::UInt32 OldImpVersion;
-		Common::UInt32 CurrentVersion;
-		Common::UInt32 ImportedSymbolCount;
-		Common::UInt32 FirstImportedSymbol;
+		Common::BigEndian::UInt32 NameOffset;
+		Common::BigEndian::UInt32 OldImpVersion;
+		Common::BigEndian::UInt32 CurrentVersion;
+		Common::BigEndian::UInt32 ImportedSymbolCount;
+		Common::BigEndian::UInt32 FirstImportedSymbol;
 		uint8_t Options;
 		uint8_t reservedA;
-		Common::UInt16 reservedB;
+		Common::BigEndian::UInt16 reservedB;
 	} __attribute__((packed));
 		
 	struct SymbolFlags
@@ -217,7 +217,7 @@ namespace PEF
 	
 	struct ImportedSymbolHeader
 	{
-		Common::UInt32 Entry;
+		Common::BigEndian::UInt32 Entry;
 		
 		inline SymbolClass GetClass() const
 		{
@@ -228,16 +228,16 @@ namespace PEF
 		
 		inline uint32_t GetNameOffset() const
 		{
-			return Common::UInt32::FromBigEndian(Entry.AsBigEndian & 0xffffff00);
+			return Common::BigEndian::UInt32::FromBigEndian(Entry.AsBigEndian & 0xffffff00);
 		}
 	} __attribute__((packed));
 		
 	struct RelocationHeader
 	{
-		Common::UInt16 SectionIndex;
-		Common::UInt16 Reserved;
-		Common::UInt32 RelocationCount;
-		Common::UInt32 FirstRelocationOffset;
+		Common::BigEndian::UInt16 SectionIndex;
+		Common::BigEndian::UInt16 Reserved;
+		Common::BigEndian::UInt32 RelocationCount;
+		Common::BigEndian::UInt32 FirstRelocationOffset;
 	} __attribute__((packed));
 		
 	struct TransitionVector
@@ -37,6 +37,7 @@ namespace
 		[25] = "sdr1",
 		[26] = "srr0",
 		[27] = "srr1",
+		[256] = "vrsave",
 		[272] = "sprg0",
 		[273] = "sprg1",
 		[274] = "sprg2",
@@ -90,6 +91,11 @@ namespace PPCVM
 			return OpcodeArgument(OpcodeArgumentFormat::FPR, gpr);
 		}
 		
+		OpcodeArgument OpcodeArgument::VR(uint8_t vr)
+		{
+			return OpcodeArgument(OpcodeArgumentFormat::VR, vr);
+		}
+		
 		OpcodeArgument OpcodeArgument::SPR(uint16_t spr)
 		{
 			return OpcodeArgument(OpcodeArgumentFormat::SPR, spr);
@@ -123,21 +129,28 @@ namespace PPCVM
 			switch (Format)
 			{
 				case OpcodeArgumentFormat::Null: return "";
-					
+				
 				case OpcodeArgumentFormat::GPR:
 				{
 					char gpr[] = "r32";
 					sprintf(gpr + 1, "%hhu", static_cast<uint8_t>(Value));
 					return gpr;
 				}
-					
+				
 				case OpcodeArgumentFormat::FPR:
 				{
 					char fpr[] = "fr32";
 					sprintf(fpr + 2, "%hhu", static_cast<uint8_t>(Value));
 					return fpr;
 				}
-					
+				
+				case OpcodeArgumentFormat::VR:
+				{
+					char vr[] = "v32";
+					sprintf(vr + 1, "%hhu", static_cast<uint8_t>(Value));
+					return vr;
+				}
+				
 				case OpcodeArgumentFormat::SPR:
 				{
 					uint16_t value = static_cast<uint16_t>(Value);
@@ -148,21 +161,21 @@ namespace PPCVM
 					sprintf(buffer + 3, "%hu", value);
 					return buffer;
 				}
-					
+				
 				case OpcodeArgumentFormat::CR:
 				{
 					char cr[] = "cr8";
 					cr[2] = static_cast<char>('0' + Value);
 					return cr;
 				}
-					
+				
 				case OpcodeArgumentFormat::Offset:
 				{
 					char offset[] = "2147483648";
 					sprintf(offset, "%i", static_cast<int32_t>(Value));
 					return offset;
 				}
-					
+				
 				case OpcodeArgumentFormat::Literal:
 				{
 					char buffer[] = "-0x00000000";
@@ -174,7 +187,7 @@ namespace PPCVM
 					sprintf(buffer + 3, format, value);
 					return buffer + (Value >= 0);
 				}
-					
+				
 				default:
 				{
 					assert(false && "format type is not handled");
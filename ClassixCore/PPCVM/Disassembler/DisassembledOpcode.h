@@ -37,6 +37,7 @@ namespace PPCVM
 			Null,
 			GPR,
 			FPR,
+			VR,
 			SPR,
 			CR,
 			Offset,
@@ -50,6 +51,7 @@ namespace PPCVM
 			
 			static OpcodeArgument GPR(uint8_t gpr);
 			static OpcodeArgument FPR(uint8_t fpr);
+			static OpcodeArgument VR(uint8_t vr);
 			static OpcodeArgument SPR(uint16_t spr);
 			static OpcodeArgument CR(uint8_t cr);
 			static OpcodeArgument Offset(int32_t offset);
@@ -62,6 +64,7 @@ namespace PPCVM
 			
 			inline bool IsGPR(uint8_t gpr) { return Format == OpcodeArgumentFormat::GPR && Value == gpr; }
 			inline bool IsFPR(uint8_t fpr) { return Format == OpcodeArgumentFormat::FPR && Value == fpr; }
+			inline bool IsVR(uint8_t vr) { return Format == OpcodeArgumentFormat::VR && Value == vr; }
 			inline bool IsSPR(uint16_t spr) { return Format == OpcodeArgumentFormat::SPR && Value == spr; }
 			inline bool IsCR(uint8_t cr) { return Format == OpcodeArgumentFormat::CR && Value == cr; }
 		};
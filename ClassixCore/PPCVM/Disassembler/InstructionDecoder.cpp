@@ -46,6 +46,11 @@ namespace
 		return OpcodeArgument::FPR(reg);
 	}
 	
+	OpcodeArgument v(uint8_t reg)
+	{
+		return OpcodeArgument::VR(reg);
+	}
+	
 	OpcodeArgument cr(uint8_t cr)
 	{
 		return OpcodeArgument::CR(cr);
@@ -129,6 +134,9 @@ namespace PPCVM
 #define IMPL(x)	void InstructionDecoder::x(PPCVM::Instruction i)
 #define BODY(x, c)	IMPL(x) { c; }
 #define OP(name)	BODY(name, Emit(i, #name))
+#define IMPL_RC(x)	template<bool Rc> IMPL(x)
+#define IMPL_OE_RC(x)	template<bool OE, bool Rc> IMPL(x)
+#define BODY_RC(x, c)	IMPL_RC(x) { c; }
 		void InstructionDecoder::unknown(PPCVM::Instruction i)
 		{
 			Emit(i, ".word", hex(i.hex));
@@ -136,9 +144,9 @@ namespace PPCVM
 		
 #pragma mark -
 #pragma mark Floating Point Instructions
-#define FX2(name)	IMPL(name##x) { Emit(i, opX(#name, i.RC), f(i.RD), f(i.RB)); }
-#define FX3(name)	IMPL(name##x) { Emit(i, opX(#name, i.RC), f(i.RD), f(i.RA), f(i.RB)); }
-#define FX4(name)	IMPL(name##x) { Emit(i, opX(#name, i.RC), f(i.RD), f(i.RA), f(i.RC), f(i.RB)); }
+#define FX2(name)	IMPL_RC(name##x) { Emit(i, opX(#name, Rc), f(i.RD), f(i.RB)); }
+#define FX3(name)	IMPL_RC(name##x) { Emit(i, opX(#name, Rc), f(i.RD), f(i.RA), f(i.RB)); }
+#define FX4(name)	IMPL_RC(name##x) { Emit(i, opX(#name, Rc), f(i.RD), f(i.RA), f(i.RC), f(i.RB)); }
 #define FX2S(name)	FX2(name) FX2(name##s)
 #define FX3S(name)	FX3(name) FX3(name##s)
 #define FX2Z(name)	FX2(name) FX2(name##z)
@@ -176,15 +184,15 @@ namespace PPCVM
 		
 #pragma mark -
 #pragma mark Integer Instructions
-#define IADA(name)	BODY(name##x, Emit(i, opXO(#name, i.RC, i.OE), g(i.RD), g(i.RA)))
-#define ILRR(name, a, b) BODY(name##x, Emit(i, opX(#name, i.RC), g(i.R##a), g(i.R##b)))
-#define ILRRR(name, a, b, c) BODY(name##x, Emit(i, opX(#name, i.RC), g(i.R##a), g(i.R##b), g(i.R##c)))
+#define IADA(name)	IMPL_OE_RC(name##x) { Emit(i, opXO(#name, Rc, OE), g(i.RD), g(i.RA)); }
+#define ILRR(name, a, b) BODY_RC(name##x, Emit(i, opX(#name, Rc), g(i.R##a), g(i.R##b)))
+#define ILRRR(name, a, b, c) BODY_RC(name##x, Emit(i, opX(#name, Rc), g(i.R##a), g(i.R##b), g(i.R##c)))
 #define ILDAB(name) ILRRR(name, D, A, B)
-#define IADAB(name)	IMPL(name##x) { Emit(i, opXO(#name, i.RC, i.OE), g(i.RD), g(i.RA), g(i.RB)); }
-#define ILASB(name)	BODY(name##x, Emit(i, opX(#name, i.RC), g(i.RA), g(i.RS), g(i.RB)))
+#define IADAB(name)	IMPL_OE_RC(name##x) { Emit(i, opXO(#name, Rc, OE), g(i.RD), g(i.RA), g(i.RB)); }
+#define ILASB(name)	BODY_RC(name##x, Emit(i, opX(#name, Rc), g(i.RA), g(i.RS), g(i.RB)))
 #define IADAI(name, dname)	BODY(name, Emit(i, #dname, g(i.RD), g(i.RA), hex(i.SIMM_16)))
 #define ICMP(name, to)	IMPL(name) { if (i.L) unknown(i); else if (i.CRFD == 0) Emit(i, #name "d", g(i.RA), to); else if (i.CRFD == 3) Emit(i, #name "w", g(i.RA), to); else Emit(i, #name, cr(i.CRFD), g(i.RA), to); }
-#define IROT(name)	BODY(name##x, Emit(i, opX(#name, i.RC), g(i.RA), g(i.RS), hex(i.SH), hex(i.MB), hex(i.ME)))
+#define IROT(name)	BODY_RC(name##x, Emit(i, opX(#name, Rc), g(i.RA), g(i.RS), hex(i.SH), hex(i.MB), hex(i.ME)))
 		
 		IADAB(addc);
 		IADAB(adde);
@@ -228,12 +236,12 @@ namespace PPCVM
 		ILASB(nand);
 		IADA(neg);
 		ILASB(nor);
-		IMPL(orx)
+		IMPL_RC(orx)
 		{
 			if (i.RS == i.RB)
-				Emit(i, "mr", g(i.RA), g(i.RB));
+				Emit(i, opX("mr", Rc), g(i.RA), g(i.RB));
 			else
-				Emit(i, opX("or", i.RC), g(i.RA), g(i.RS), g(i.RB));
+				Emit(i, opX("or", Rc), g(i.RA), g(i.RS), g(i.RB));
 		}
 		
 		ILASB(orc);
@@ -250,29 +258,29 @@ namespace PPCVM
 		
 		// this would need so many unit tests my head hurts
 		// http://publib.boulder.ibm.com/infocenter/pseries/v5r3/index.jsp?topic=/com.ibm.aix.aixassem/doc/alangref/fixed_rotate_shift32.htm
-		IMPL(rlwinmx)
+		IMPL_RC(rlwinmx)
 		{
 			if (i.ME == 31)
 			{
 				if (i.MB == 0)
 				{
 					if (i.SH < 16)
-						Emit(i, opX("rotlwi", i.RC), g(i.RA), g(i.RS), hex(i.SH));
+						Emit(i, opX("rotlwi", Rc), g(i.RA), g(i.RS), hex(i.SH));
 					else
-						Emit(i, opX("rotrwi", i.RC), g(i.RA), g(i.RS), hex(32 - i.SH));
+						Emit(i, opX("rotrwi", Rc), g(i.RA), g(i.RS), hex(32 - i.SH));
 				}
 				else
 				{
 					if (i.SH == 0)
-						Emit(i, opX("clrlwi", i.RC), g(i.RA), g(i.RS), hex(i.MB));
+						Emit(i, opX("clrlwi", Rc), g(i.RA), g(i.RS), hex(i.MB));
 					else
 					{
 						if (32 - i.MB == i.SH)
-							Emit(i, opX("srwi", i.RC), g(i.RA), g(i.RS), hex(i.MB));
+							Emit(i, opX("srwi", Rc), g(i.RA), g(i.RS), hex(i.MB));
 						else
 						{
 							uint32_t n = 32 - i.MB;
-							Emit(i, opX("extrwi", i.RC), g(i.RA), g(i.RS), hex(n), hex(i.SH - n));
+							Emit(i, opX("extrwi", Rc), g(i.RA), g(i.RS), hex(n), hex(i.SH - n));
 						}
 					}
 				}
@@ -282,13 +290,13 @@ namespace PPCVM
 				if (i.MB == 0)
 				{
 					if (i.SH == 0)
-						Emit(i, opX("clrrwi", i.RC), g(i.RA), g(i.RS), hex(31 - i.ME));
+						Emit(i, opX("clrrwi", Rc), g(i.RA), g(i.RS), hex(31 - i.ME));
 					else
 					{
 						if (31 - i.ME == i.SH)
-							Emit(i, opX("slwi", i.RC), g(i.RA), g(i.RS), hex(i.SH));
+							Emit(i, opX("slwi", Rc), g(i.RA), g(i.RS), hex(i.SH));
 						else
-							Emit(i, opX("extlwi", i.RC), g(i.RA), g(i.RS), hex(i.SH), hex(i.ME + 1));
+							Emit(i, opX("extlwi", Rc), g(i.RA), g(i.RS), hex(i.SH), hex(i.ME + 1));
 					}
 				}
 				else
@@ -296,21 +304,21 @@ namespace PPCVM
 					if (i.MB == 32 - i.SH)
 					{
 						uint32_t n = i.ME + 1 - i.MB;
-						Emit(i, opX("inslwi", i.RC), g(i.RA), g(i.RS), hex(n), hex(i.MB));
+						Emit(i, opX("inslwi", Rc), g(i.RA), g(i.RS), hex(n), hex(i.MB));
 					}
 					else if (31 - i.ME == i.MB)
 					{
 						uint32_t b = i.SH + i.MB;
-						Emit(i, opX("clrslwi", i.RC), g(i.RA), g(i.RS), hex(b), hex(i.MB));
+						Emit(i, opX("clrslwi", Rc), g(i.RA), g(i.RS), hex(b), hex(i.MB));
 					}
 					else
 					{
 						uint32_t b = i.MB;
 						uint32_t n = i.ME + 1 - b;
 						if (i.SH == 32 - (b + n))
-							Emit(i, opX("insrwi", i.RC), g(i.RA), g(i.RS), hex(n), hex(b));
+							Emit(i, opX("insrwi", Rc), g(i.RA), g(i.RS), hex(n), hex(b));
 						else
-							Emit(i, opX("rlwinm", i.RC), g(i.RA), g(i.RS), hex(i.SH), hex(i.MB), hex(i.ME));
+							Emit(i, opX("rlwinm", Rc), g(i.RA), g(i.RS), hex(i.SH), hex(i.MB), hex(i.ME));
 					}
 				}
 			}
@@ -320,7 +328,7 @@ namespace PPCVM
 		
 		ILASB(slw);
 		ILASB(sraw);
-		BODY(srawix, Emit(i, opX("srawi", i.RC), g(i.RA), g(i.RS), hex(i.SH)));
+		BODY_RC(srawix, Emit(i, opX("srawi", Rc), g(i.RA), g(i.RS), hex(i.SH)));
 		ILASB(srw);
 		
 		IADAB(subf);
@@ -411,12 +419,12 @@ namespace PPCVM
 		BODY(mcrfs, Emit(i, "mcrfs", cr(i.CRFD), cr(i.CRFS)));
 		BODY(mcrxr, Emit(i, "mcrxr", cr(i.CRFD)));
 		BODY(mfcr, Emit(i, "mfcr", g(i.RD)));
-		BODY(mffsx, Emit(i, opX("mffs", i.RC), f(i.RD)));
+		BODY_RC(mffsx, Emit(i, opX("mffs", Rc), f(i.RD)));
 		
 		IMPL(mfspr)
 		{
 			OpcodeArgument d = g(i.RD);
-			uint8_t spr = static_cast<uint8_t>((i.RB << 5) | i.RA);
+			uint16_t spr = static_cast<uint16_t>((i.RB << 5) | i.RA);
 			switch (spr)
 			{
 				case 1: Emit(i, "mfxer", d); return;
@@ -424,6 +432,7 @@ namespace PPCVM
 				case 5: Emit(i, "mfrtcl", d); return;
 				case 8: Emit(i, "mflr", d); return;
 				case 9: Emit(i, "mfctr", d); return;
+				case 256: Emit(i, "mfvrsave", d); return;
 			}
 			Emit(i, "mfspr", d, ::spr(spr));
 		}
@@ -441,20 +450,21 @@ namespace PPCVM
 		}
 		
 		BODY(mtcrf, Emit(i, "mtcrf", cr(i.CRM), g(i.RS)));
-		BODY(mtfsb0x, Emit(i, opX("mtfsb0", i.RC), cr(i.CRBD)));
-		BODY(mtfsb1x, Emit(i, opX("mtfsb0", i.RC), cr(i.CRBD)));
-		BODY(mtfsfix, Emit(i, opX("mtfsfi", i.RC), cr(i.CRFD), hex(i.SR)));
-		BODY(mtfsfx, Emit(i, opX("mtfsf", i.RC), hex(i.FM), f(i.RB)));
+		BODY_RC(mtfsb0x, Emit(i, opX("mtfsb0", Rc), cr(i.CRBD)));
+		BODY_RC(mtfsb1x, Emit(i, opX("mtfsb1", Rc), cr(i.CRBD)));
+		BODY_RC(mtfsfix, Emit(i, opX("mtfsfi", Rc), cr(i.CRFD), hex(i.SR)));
+		BODY_RC(mtfsfx, Emit(i, opX("mtfsf", Rc), hex(i.FM), f(i.RB)));
 		
 		IMPL(mtspr)
 		{
 			OpcodeArgument d = g(i.RD);
-			uint8_t spr = static_cast<uint8_t>((i.RB << 5) | i.RA);
+			uint16_t spr = static_cast<uint16_t>((i.RB << 5) | i.RA);
 			switch (spr)
 			{
 				case 1: Emit(i, "mtxer", d); return;
 				case 8: Emit(i, "mtlr", d); return;
 				case 9: Emit(i, "mtctr", d); return;
+				case 256: Emit(i, "mtvrsave", d); return;
 			}
 			Emit(i, "mtspr", d, ::spr(spr));
 		}
@@ -463,11 +473,191 @@ namespace PPCVM
 		OP(rfid);
 		OP(sync);
 		
+#pragma mark -
+#pragma mark Vector Instructions
+#define VDAB(name)	BODY(name, Emit(i, #name, v(i.VD), v(i.VA), v(i.VB)))
+#define VDB(name)	BODY(name, Emit(i, #name, v(i.VD), v(i.VB)))
+#define VDBU(name)	BODY(name, Emit(i, #name, v(i.VD), v(i.VB), hex(i.VUIMM)))
+#define VDS(name)	BODY(name, Emit(i, #name, v(i.VD), hex(i.VSIMM)))
+#define VDABC(name)	BODY(name, Emit(i, #name, v(i.VD), v(i.VA), v(i.VB), v(i.VC)))
+#define VDACB(name)	BODY(name, Emit(i, #name, v(i.VD), v(i.VA), v(i.VC), v(i.VB)))
+#define VCMP(name)	BODY_RC(name##x, Emit(i, opX(#name, Rc), v(i.VD), v(i.VA), v(i.VB)))
+#define VLS(name)	BODY(name, Emit(i, #name, v(i.VD), g(i.RA), g(i.RB)))
+		
+		VLS(lvebx);
+		VLS(lvehx);
+		VLS(lvewx);
+		VLS(lvsl);
+		VLS(lvsr);
+		VLS(lvx);
+		VLS(lvxl);
+		BODY(mfvscr, Emit(i, "mfvscr", v(i.VD)));
+		BODY(mtvscr, Emit(i, "mtvscr", v(i.VB)));
+		VLS(stvebx);
+		VLS(stvehx);
+		VLS(stvewx);
+		VLS(stvx);
+		VLS(stvxl);
+		VDAB(vaddcuw);
+		VDAB(vaddfp);
+		VDAB(vaddsbs);
+		VDAB(vaddshs);
+		VDAB(vaddsws);
+		VDAB(vaddubm);
+		VDAB(vaddubs);
+		VDAB(vadduhm);
+		VDAB(vadduhs);
+		VDAB(vadduwm);
+		VDAB(vadduws);
+		VDAB(vand);
+		VDAB(vandc);
+		VDAB(vavgsb);
+		VDAB(vavgsh);
+		VDAB(vavgsw);
+		VDAB(vavgub);
+		VDAB(vavguh);
+		VDAB(vavguw);
+		VDBU(vcfsx);
+		VDBU(vcfux);
+		VCMP(vcmpbfp);
+		VCMP(vcmpeqfp);
+		VCMP(vcmpequb);
+		VCMP(vcmpequh);
+		VCMP(vcmpequw);
+		VCMP(vcmpgefp);
+		VCMP(vcmpgtfp);
+		VCMP(vcmpgtsb);
+		VCMP(vcmpgtsh);
+		VCMP(vcmpgtsw);
+		VCMP(vcmpgtub);
+		VCMP(vcmpgtuh);
+		VCMP(vcmpgtuw);
+		VDBU(vctsxs);
+		VDBU(vctuxs);
+		VDB(vexptefp);
+		VDB(vlogefp);
+		VDACB(vmaddfp);
+		VDAB(vmaxfp);
+		VDAB(vmaxsb);
+		VDAB(vmaxsh);
+		VDAB(vmaxsw);
+		VDAB(vmaxub);
+		VDAB(vmaxuh);
+		VDAB(vmaxuw);
+		VDABC(vmhaddshs);
+		VDABC(vmhraddshs);
+		VDAB(vminfp);
+		VDAB(vminsb);
+		VDAB(vminsh);
+		VDAB(vminsw);
+		VDAB(vminub);
+		VDAB(vminuh);
+		VDAB(vminuw);
+		VDABC(vmladduhm);
+		VDAB(vmrghb);
+		VDAB(vmrghh);
+		VDAB(vmrghw);
+		VDAB(vmrglb);
+		VDAB(vmrglh);
+		VDAB(vmrglw);
+		VDABC(vmsummbm);
+		VDABC(vmsumshm);
+		VDABC(vmsumshs);
+		VDABC(vmsumubm);
+		VDABC(vmsumuhm);
+		VDABC(vmsumuhs);
+		VDAB(vmulesb);
+		VDAB(vmulesh);
+		VDAB(vmuleub);
+		VDAB(vmuleuh);
+		VDAB(vmulosb);
+		VDAB(vmulosh);
+		VDAB(vmuloub);
+		VDAB(vmulouh);
+		VDACB(vnmsubfp);
+		VDAB(vnor);
+		VDAB(vor);
+		VDABC(vperm);
+		VDAB(vpkpx);
+		VDAB(vpkshss);
+		VDAB(vpkshus);
+		VDAB(vpkswss);
+		VDAB(vpkswus);
+		VDAB(vpkuhum);
+		VDAB(vpkuhus);
+		VDAB(vpkuwum);
+		VDAB(vpkuwus);
+		VDB(vrefp);
+		VDB(vrfim);
+		VDB(vrfin);
+		VDB(vrfip);
+		VDB(vrfiz);
+		VDAB(vrlb);
+		VDAB(vrlh);
+		VDAB(vrlw);
+		VDB(vrsqrtefp);
+		VDABC(vsel);
+		VDAB(vsl);
+		VDAB(vslb);
+		BODY(vsldoi, Emit(i, "vsldoi", v(i.VD), v(i.VA), v(i.VB), hex(i.SHB)));
+		VDAB(vslh);
+		VDAB(vslo);
+		VDAB(vslw);
+		VDBU(vspltb);
+		VDBU(vsplth);
+		VDS(vspltisb);
+		VDS(vspltish);
+		VDS(vspltisw);
+		VDBU(vspltw);
+		VDAB(vsr);
+		VDAB(vsrab);
+		VDAB(vsrah);
+		VDAB(vsraw);
+		VDAB(vsrb);
+		VDAB(vsrh);
+		VDAB(vsro);
+		VDAB(vsrw);
+		VDAB(vsubcuw);
+		VDAB(vsubfp);
+		VDAB(vsubsbs);
+		VDAB(vsubshs);
+		VDAB(vsubsws);
+		VDAB(vsububm);
+		VDAB(vsububs);
+		VDAB(vsubuhm);
+		VDAB(vsubuhs);
+		VDAB(vsubuwm);
+		VDAB(vsubuws);
+		VDAB(vsum2sws);
+		VDAB(vsum4sbs);
+		VDAB(vsum4shs);
+		VDAB(vsum4ubs);
+		VDAB(vsumsws);
+		VDB(vupkhpx);
+		VDB(vupkhsb);
+		VDB(vupkhsh);
+		VDB(vupklpx);
+		VDB(vupklsb);
+		VDB(vupklsh);
+		VDAB(vxor);
+		
+		IMPL(dss)
+		{
+			if (i.T)
+				Emit(i, "dssall");
+			else
+				Emit(i, "dss", hex(i.STRM));
+		}
+		
+		BODY(dst, Emit(i, i.T ? "dstt" : "dst", g(i.RA), g(i.RB), hex(i.STRM)));
+		BODY(dstst, Emit(i, i.T ? "dststt" : "dstst", g(i.RA), g(i.RB), hex(i.STRM)));
+		
 #pragma mark -
 #pragma mark Branching
+		template<bool LK>
 		IMPL(bcctrx)
 		{
-			std::string opcode = opLK("b" + branchName(i.BO, i.BI) + "ctr", i.LK);
+			std::string opcode = opLK("b" + branchName(i.BO, i.BI) + "ctr", LK);
 			uint8_t crN = i.BI >> 2;
 			if (crN == 0)
 				Emit(i, opcode);
@@ -475,9 +665,10 @@ namespace PPCVM
 				Emit(i, opcode, cr(crN));
 		}
 		
+		template<bool LK>
 		IMPL(bclrx)
 		{
-			std::string opcode = opLK("b" + branchName(i.BO, i.BI) + "lr", i.LK);
+			std::string opcode = opLK("b" + branchName(i.BO, i.BI) + "lr", LK);
 			uint8_t crN = i.BI >> 2;
 			if (crN == 0)
 				Emit(i, opcode);
@@ -485,13 +676,13 @@ namespace PPCVM
 				Emit(i, opcode, cr(crN));
 		}
 		
+		template<bool AA, bool LK>
 		IMPL(bcx)
 		{
 			OpcodeArgument target = hex(i.BD << 2);
-			std::string opcode = opLK("b" + branchName(i.BO, i.BI), i.LK);
+			std::string opcode = opLK("b" + branchName(i.BO, i.BI), LK);
 			
-			if (i.LK) opcode += 'l';
-			if (i.AA) opcode += 'a';
+			if (AA) opcode += 'a';
 			
 			uint8_t crN = i.BI >> 2;
 			if (crN == 0)
@@ -500,11 +691,12 @@ namespace PPCVM
 				Emit(i, opcode, cr(crN), target);
 		}
 		
+		template<bool AA, bool LK>
 		IMPL(bx)
 		{
 			std::string suffix;
-			if (i.LK) suffix += 'l';
-			if (i.AA) suffix += 'a';
+			if (LK) suffix += 'l';
+			if (AA) suffix += 'a';
 			
 			Emit(i, "b" + suffix, hex(i.LI << 2));
 		}
@@ -49,90 +49,90 @@ namespace PPCVM
 			void unknown(Instruction inst);
 			
 			// Floating Point Instructions
-			void fabsx(Instruction inst);
-			void faddsx(Instruction inst);
-			void faddx(Instruction inst);
+			template<bool Rc> void fabsx(Instruction inst);
+			template<bool Rc> void faddsx(Instruction inst);
+			template<bool Rc> void faddx(Instruction inst);
 			void fcmpo(Instruction inst);
 			void fcmpu(Instruction inst);
-			void fctiwx(Instruction inst);
-			void fctiwzx(Instruction inst);
-			void fdivsx(Instruction inst);
-			void fdivx(Instruction inst);
-			void fmaddsx(Instruction inst);
-			void fmaddx(Instruction inst);
-			void fmrx(Instruction inst);
-			void fmsubsx(Instruction inst);
-			void fmsubx(Instruction inst);
-			void fmulsx(Instruction inst);
-			void fmulx(Instruction inst);
-			void fnabsx(Instruction inst);
-			void fnegx(Instruction inst);
-			void fnmaddsx(Instruction inst);
-			void fnmaddx(Instruction inst);
-			void fnmsubsx(Instruction inst);
-			void fnmsubx(Instruction inst);
-			void fresx(Instruction inst);
-			void frspx(Instruction inst);
-			void frsqrtex(Instruction inst);
-			void fselx(Instruction inst);
-			void fsqrtsx(Instruction inst);
-			void fsqrtx(Instruction inst);
-			void fsubsx(Instruction inst);
-			void fsubx(Instruction inst);
+			template<bool Rc> void fctiwx(Instruction inst);
+			template<bool Rc> void fctiwzx(Instruction inst);
+			template<bool Rc> void fdivsx(Instruction inst);
+			template<bool Rc> void fdivx(Instruction inst);
+			template<bool Rc> void fmaddsx(Instruction inst);
+			template<bool Rc> void fmaddx(Instruction inst);
+			template<bool Rc> void fmrx(Instruction inst);
+			template<bool Rc> void fmsubsx(Instruction inst);
+			template<bool Rc> void fmsubx(Instruction inst);
+			template<bool Rc> void fmulsx(Instruction inst);
+			template<bool Rc> void fmulx(Instruction inst);
+			template<bool Rc> void fnabsx(Instruction inst);
+			template<bool Rc> void fnegx(Instruction inst);
+			template<bool Rc> void fnmaddsx(Instruction inst);
+			template<bool Rc> void fnmaddx(Instruction inst);
+			template<bool Rc> void fnmsubsx(Instruction inst);
+			template<bool Rc> void fnmsubx(Instruction inst);
+			template<bool Rc> void fresx(Instruction inst);
+			template<bool Rc> void frspx(Instruction inst);
+			template<bool Rc> void frsqrtex(Instruction inst);
+			template<bool Rc> void fselx(Instruction inst);
+			template<bool Rc> void fsqrtsx(Instruction inst);
+			template<bool Rc> void fsqrtx(Instruction inst);
+			template<bool Rc> void fsubsx(Instruction inst);
+			template<bool Rc> void fsubx(Instruction inst);
 			
 			// Integer Instructions
-			void addcx(Instruction inst);
-			void addex(Instruction inst);
+			template<bool OE, bool Rc> void addcx(Instruction inst);
+			template<bool OE, bool Rc> void addex(Instruction inst);
 			void addi(Instruction inst);
 			void addic_rc(Instruction inst);
 			void addic(Instruction inst);
 			void addis(Instruction inst);
-			void addmex(Instruction inst);
-			void addx(Instruction inst);
-			void addzex(Instruction inst);
-			void andcx(Instruction inst);
+			template<bool OE, bool Rc> void addmex(Instruction inst);
+			template<bool OE, bool Rc> void addx(Instruction inst);
+			template<bool OE, bool Rc> void addzex(Instruction inst);
+			template<bool Rc> void andcx(Instruction inst);
 			void andi_rc(Instruction inst);
 			void andis_rc(Instruction inst);
-			void andx(Instruction inst);
+			template<bool Rc> void andx(Instruction inst);
 			void cmp(Instruction inst);
 			void cmpi(Instruction inst);
 			void cmpl(Instruction inst);
 			void cmpli(Instruction inst);
-			void cntlzwx(Instruction inst);
-			void divwux(Instruction inst);
-			void divwx(Instruction inst);
-			void eqvx(Instruction inst);
-			void extsbx(Instruction inst);
-			void extshx(Instruction inst);
-			void mulhwux(Instruction inst);
-			void mulhwx(Instruction inst);
+			template<bool Rc> void cntlzwx(Instruction inst);
+			template<bool OE, bool Rc> void divwux(Instruction inst);
+			template<bool OE, bool Rc> void divwx(Instruction inst);
+			template<bool Rc> void eqvx(Instruction inst);
+			template<bool Rc> void extsbx(Instruction inst);
+			template<bool Rc> void extshx(Instruction inst);
+			template<bool Rc> void mulhwux(Instruction inst);
+			template<bool Rc> void mulhwx(Instruction inst);
 			void mulli(Instruction inst);
-			void mullwx(Instruction inst);
-			void nandx(Instruction inst);
-			void negx(Instruction inst);
-			void norx(Instruction inst);
-			void orcx(Instruction inst);
+			template<bool OE, bool Rc> void mullwx(Instruction inst);
+			template<bool Rc> void nandx(Instruction inst);
+			template<bool OE, bool Rc> void negx(Instruction inst);
+			template<bool Rc> void norx(Instruction inst);
+			template<bool Rc> void orcx(Instruction inst);
 			void ori(Instruction inst);
 			void oris(Instruction inst);
-			void orx(Instruction inst);
-			void rlwimix(Instruction inst);
-			void rlwinmx(Instruction inst);
-			void rlwnmx(Instruction inst);
-			void slwx(Instruction inst);
-			void srawix(Instruction inst);
-			void srawx(Instruction inst);
-			void srwx(Instruction inst);
-			void subfcx(Instruction inst);
-			void subfex(Instruction inst);
+			template<bool Rc> void orx(Instruction inst);
+			template<bool Rc> void rlwimix(Instruction inst);
+			template<bool Rc> void rlwinmx(Instruction inst);
+			template<bool Rc> void rlwnmx(Instruction inst);
+			template<bool Rc> void slwx(Instruction inst);
+			template<bool Rc> void srawix(Instruction inst);
+			template<bool Rc> void srawx(Instruction inst);
+			template<bool Rc> void srwx(Instruction inst);
+			template<bool OE, bool Rc> void subfcx(Instruction inst);
+			template<bool OE, bool Rc> void subfex(Instruction inst);
 			void subfic(Instruction inst);
-			void subfmex(Instruction inst);
-			void subfx(Instruction inst);
-			void subfzex(Instruction inst);
+			template<bool OE, bool Rc> void subfmex(Instruction inst);
+			template<bool OE, bool Rc> void subfx(Instruction inst);
+			template<bool OE, bool Rc> void subfzex(Instruction inst);
 			void tw(Instruction inst);
 			void twi(Instruction inst);
 			void xori(Instruction inst);
 			void xoris(Instruction inst);
-			void xorx(Instruction inst);
+			template<bool Rc> void xorx(Instruction inst);
 			
 			// Load/Store Instructions
 			void eieio(Instruction inst);
@@ -208,23 +208,184 @@ namespace PPCVM
 			void mcrfs(Instruction inst);
 			void mcrxr(Instruction inst);
 			void mfcr(Instruction inst);
-			void mffsx(Instruction inst);
+			template<bool Rc> void mffsx(Instruction inst);
 			void mfspr(Instruction inst);
 			void mftb(Instruction inst);
 			void mtcrf(Instruction inst);
-			void mtfsb0x(Instruction inst);
-			void mtfsb1x(Instruction inst);
-			void mtfsfix(Instruction inst);
-			void mtfsfx(Instruction inst);
+			template<bool Rc> void mtfsb0x(Instruction inst);
+			template<bool Rc> void mtfsb1x(Instruction inst);
+			template<bool Rc> void mtfsfix(Instruction inst);
+			template<bool Rc> void mtfsfx(Instruction inst);
 			void mtspr(Instruction inst);
 			void rfid(Instruction inst);
 			void sync(Instruction inst);
 			
+			// Vector Instructions
+			void dss(Instruction inst);
+			void dst(Instruction inst);
+			void dstst(Instruction inst);
+			void lvebx(Instruction inst);
+			void lvehx(Instruction inst);
+			void lvewx(Instruction inst);
+			void lvsl(Instruction inst);
+			void lvsr(Instruction inst);
+			void lvx(Instruction inst);
+			void lvxl(Instruction inst);
+			void mfvscr(Instruction inst);
+			void mtvscr(Instruction inst);
+			void stvebx(Instruction inst);
+			void stvehx(Instruction inst);
+			void stvewx(Instruction inst);
+			void stvx(Instruction inst);
+			void stvxl(Instruction inst);
+			void vaddcuw(Instruction inst);
+			void vaddfp(Instruction inst);
+			void vaddsbs(Instruction inst);
+			void vaddshs(Instruction inst);
+			void vaddsws(Instruction inst);
+			void vaddubm(Instruction inst);
+			void vaddubs(Instruction inst);
+			void vadduhm(Instruction inst);
+			void vadduhs(Instruction inst);
+			void vadduwm(Instruction inst);
+			void vadduws(Instruction inst);
+			void vand(Instruction inst);
+			void vandc(Instruction inst);
+			void vavgsb(Instruction inst);
+			void vavgsh(Instruction inst);
+			void vavgsw(Instruction inst);
+			void vavgub(Instruction inst);
+			void vavguh(Instruction inst);
+			void vavguw(Instruction inst);
+			void vcfsx(Instruction inst);
+			void vcfux(Instruction inst);
+			template<bool Rc> void vcmpbfpx(Instruction inst);
+			template<bool Rc> void vcmpeqfpx(Instruction inst);
+			template<bool Rc> void vcmpequbx(Instruction inst);
+			template<bool Rc> void vcmpequhx(Instruction inst);
+			template<bool Rc> void vcmpequwx(Instruction inst);
+			template<bool Rc> void vcmpgefpx(Instruction inst);
+			template<bool Rc> void vcmpgtfpx(Instruction inst);
+			template<bool Rc> void vcmpgtsbx(Instruction inst);
+			template<bool Rc> void vcmpgtshx(Instruction inst);
+			template<bool Rc> void vcmpgtswx(Instruction inst);
+			template<bool Rc> void vcmpgtubx(Instruction inst);
+			template<bool Rc> void vcmpgtuhx(Instruction inst);
+			template<bool Rc> void vcmpgtuwx(Instruction inst);
+			void vctsxs(Instruction inst);
+			void vctuxs(Instruction inst);
+			void vexptefp(Instruction inst);
+			void vlogefp(Instruction inst);
+			void vmaddfp(Instruction inst);
+			void vmaxfp(Instruction inst);
+			void vmaxsb(Instruction inst);
+			void vmaxsh(Instruction inst);
+			void vmaxsw(Instruction inst);
+			void vmaxub(Instruction inst);
+			void vmaxuh(Instruction inst);
+			void vmaxuw(Instruction inst);
+			void vmhaddshs(Instruction inst);
+			void vmhraddshs(Instruction inst);
+			void vminfp(Instruction inst);
+			void vminsb(Instruction inst);
+			void vminsh(Instruction inst);
+			void vminsw(Instruction inst);
+			void vminub(Instruction inst);
+			void vminuh(Instruction inst);
+			void vminuw(Instruction inst);
+			void vmladduhm(Instruction inst);
+			void vmrghb(Instruction inst);
+			void vmrghh(Instruction inst);
+			void vmrghw(Instruction inst);
+			void vmrglb(Instruction inst);
+			void vmrglh(Instruction inst);
+			void vmrglw(Instruction inst);
+			void vmsummbm(Instruction inst);
+			void vmsumshm(Instruction inst);
+			void vmsumshs(Instruction inst);
+			void vmsumubm(Instruction inst);
+			void vmsumuhm(Instruction inst);
+			void vmsumuhs(Instruction inst);
+			void vmulesb(Instruction inst);
+			void vmulesh(Instruction inst);
+			void vmuleub(Instruction inst);
+			void vmuleuh(Instruction inst);
+			void vmulosb(Instruction inst);
+			void vmulosh(Instruction inst);
+			void vmuloub(Instruction inst);
+			void vmulouh(Instruction inst);
+			void vnmsubfp(Instruction inst);
+			void vnor(Instruction inst);
+			void vor(Instruction inst);
+			void vperm(Instruction inst);
+			void vpkpx(Instruction inst);
+			void vpkshss(Instruction inst);
+			void vpkshus(Instruction inst);
+			void vpkswss(Instruction inst);
+			void vpkswus(Instruction inst);
+			void vpkuhum(Instruction inst);
+			void vpkuhus(Instruction inst);
+			void vpkuwum(Instruction inst);
+			void vpkuwus(Instruction inst);
+			void vrefp(Instruction inst);
+			void vrfim(Instruction inst);
+			void vrfin(Instruction inst);
+			void vrfip(Instruction inst);
+			void vrfiz(Instruction inst);
+			void vrlb(Instruction inst);
+			void vrlh(Instruction inst);
+			void vrlw(Instruction inst);
+			void vrsqrtefp(Instruction inst);
+			void vsel(Instruction inst);
+			void vsl(Instruction inst);
+			void vslb(Instruction inst);
+			void vsldoi(Instruction inst);
+			void vslh(Instruction inst);
+			void vslo(Instruction inst);
+			void vslw(Instruction inst);
+			void vspltb(Instruction inst);
+			void vsplth(Instruction inst);
+			void vspltisb(Instruction inst);
+			void vspltish(Instruction inst);
+			void vspltisw(Instruction inst);
+			void vspltw(Instruction inst);
+			void vsr(Instruction inst);
+			void vsrab(Instruction inst);
+			void vsrah(Instruction inst);
+			void vsraw(Instruction inst);
+			void vsrb(Instruction inst);
+			void vsrh(Instruction inst);
+			void vsro(Instruction inst);
+			void vsrw(Instruction inst);
+			void vsubcuw(Instruction inst);
+			void vsubfp(Instruction inst);
+			void vsubsbs(Instruction inst);
+			void vsubshs(Instruction inst);
+			void vsubsws(Instruction inst);
+			void vsububm(Instruction inst);
+			void vsububs(Instruction inst);
+			void vsubuhm(Instruction inst);
+			void vsubuhs(Instruction inst);
+			void vsubuwm(Instruction inst);
+			void vsubuws(Instruction inst);
+			void vsum2sws(Instruction inst);
+			void vsum4sbs(Instruction inst);
+			void vsum4shs(Instruction inst);
+			void vsum4ubs(Instruction inst);
+			void vsumsws(Instruction inst);
+			void vupkhpx(Instruction inst);
+			void vupkhsb(Instruction inst);
+			void vupkhsh(Instruction inst);
+			void vupklpx(Instruction inst);
+			void vupklsb(Instruction inst);
+			void vupklsh(Instruction inst);
+			void vxor(Instruction inst);
+			
 			// branching
-			void bcctrx(Instruction inst);
-			void bclrx(Instruction inst);
-			void bcx(Instruction inst);
-			void bx(Instruction inst);
+			template<bool LK> void bcctrx(Instruction inst);
+			template<bool LK> void bclrx(Instruction inst);
+			template<bool AA, bool LK> void bcx(Instruction inst);
+			template<bool AA, bool LK> void bx(Instruction inst);
 			void sc(Instruction inst);
 			
 			// supervisor mode (not implemented)
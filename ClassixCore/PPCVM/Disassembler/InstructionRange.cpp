@@ -29,7 +29,7 @@ namespace PPCVM
 	namespace Disassembly
 	{
 		InstructionRange::InstructionRange(Common::Allocator& allocator, const Common::UInt32* begin)
-		: Begin(begin), End(nullptr), allocator(allocator), TableOfContents(nullptr)
+		: allocator(allocator), Begin(begin), End(nullptr), TableOfContents(nullptr)
 		{
 			Instruction first = begin->Get();
 			IsFunction = InstructionDecoder::Decode(first).Opcode == "mflr";
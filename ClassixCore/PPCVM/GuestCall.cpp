@@ -0,0 +1,130 @@
+//
+// GuestCall.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include <cstring>
+#include <stdexcept>
+#include <pthread.h>
+#include "GuestCall.h"
+
+namespace
+{
+	using namespace PPCVM::Execution;
+	
+	pthread_once_t createOnce = PTHREAD_ONCE_INIT;
+	pthread_key_t currentRunner;
+	
+	// a linkage area (back chain, CR, LR, two reserved words and the TOC) and room for 8 arguments, rounded up
+	const uint32_t FrameSize = 64;
+	
+	void CreateKey()
+	{
+		if (pthread_key_create(&currentRunner, nullptr) != 0)
+			throw std::runtime_error("could not create the guest runner key");
+	}
+	
+	GuestRunner& RequireCurrentRunner()
+	{
+		GuestRunner* runner = GuestRunner::Current();
+		if (runner == nullptr)
+			throw std::logic_error("guest code can only be called from a native call");
+		return *runner;
+	}
+}
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		GuestRunner::Scope::Scope(GuestRunner& runner)
+		{
+			pthread_once(&createOnce, &CreateKey);
+			outer = static_cast<GuestRunner*>(pthread_getspecific(currentRunner));
+			pthread_setspecific(currentRunner, &runner);
+		}
+		
+		GuestRunner::Scope::~Scope()
+		{
+			pthread_setspecific(currentRunner, outer);
+		}
+		
+		GuestRunner* GuestRunner::Current()
+		{
+			pthread_once(&createOnce, &CreateKey);
+			return static_cast<GuestRunner*>(pthread_getspecific(currentRunner));
+		}
+		
+		GuestRunner::~GuestRunner()
+		{ }
+		
+		GuestCall::GuestCall(Common::Allocator& allocator, MachineState* state, uint32_t transitionVector)
+		: runner(RequireCurrentRunner()), state(*state), vector(transitionVector)
+		{
+			const Common::UInt32* words = allocator.ToPointer<const Common::UInt32>(transitionVector);
+			entryPoint = words[0].Get();
+			toc = words[1].Get();
+			Init(allocator);
+		}
+		
+		GuestCall::GuestCall(Common::Allocator& allocator, MachineState* state, uint32_t entryPoint, uint32_t toc)
+		: runner(RequireCurrentRunner()), state(*state), entryPoint(entryPoint), toc(toc), vector(0)
+		{
+			Init(allocator);
+		}
+		
+		void GuestCall::Init(Common::Allocator& allocator)
+		{
+			memcpy(savedGPR, state.gpr, sizeof savedGPR);
+			memcpy(savedFPR, state.fpr, sizeof savedFPR);
+			savedCR = state.GetCR();
+			savedXER = state.xer;
+			savedLR = state.lr;
+			savedCTR = state.ctr;
+			
+			// The native call doesn't have a frame of its own, so the callee's goes right below the stack pointer
+			// of whoever called the native call. Only the back chain needs to be set; the callee fills in the rest.
+			frame = (state.r1 - FrameSize) & ~15;
+			*allocator.ToPointer<Common::UInt32>(frame) = state.r1;
+		}
+		
+		uint32_t GuestCall::Call()
+		{
+			// like the glue of a call through a function pointer
+			state.r1 = frame;
+			state.r2 = toc;
+			state.r12 = vector;
+			state.ctr = entryPoint;
+			state.lr = runner.GetReturnAddress();
+			runner.Run(entryPoint);
+			return state.r3;
+		}
+		
+		GuestCall::~GuestCall()
+		{
+			memcpy(state.gpr, savedGPR, sizeof savedGPR);
+			memcpy(state.fpr, savedFPR, sizeof savedFPR);
+			state.SetCR(savedCR);
+			state.xer = savedXER;
+			state.lr = savedLR;
+			state.ctr = savedCTR;
+		}
+	}
+}
@@ -0,0 +1,122 @@
+//
+// GuestCall.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef __Classix__GuestCall__
+#define __Classix__GuestCall__
+
+#include <cstdint>
+#include "Allocator.h"
+#include "MachineState.h"
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		// Whatever runs guest code, as far as the native calls that it makes are concerned. An interpreter is the
+		// runner of the thread it executes on, so that its native calls can call back into the guest.
+		class GuestRunner
+		{
+		public:
+			// makes runner the current runner of this thread until the Scope goes away
+			class Scope
+			{
+				GuestRunner* outer;
+				
+			public:
+				explicit Scope(GuestRunner& runner);
+				Scope(const Scope& that) = delete;
+				~Scope();
+			};
+			
+			// the runner of this thread, or nullptr outside of guest code
+			static GuestRunner* Current();
+			
+			// guest code that branches to this address has returned to its native caller
+			virtual uint32_t GetReturnAddress() const = 0;
+			
+			// runs from address until the guest branches to GetReturnAddress(); has to be reentrant
+			virtual void Run(uint32_t address) = 0;
+			
+			virtual ~GuestRunner();
+		};
+		
+		// Calls a guest function from a native call, on the native call's machine state. The constructor saves the
+		// volatile registers and gives the callee a frame with a linkage area below the native call's stack
+		// pointer, and the destructor restores them (r3 included, so results go in after the GuestCall is gone).
+		// In between, each call only sets its arguments and runs the callee; a native qsort makes one GuestCall for
+		// the comparator.
+		class GuestCall
+		{
+			GuestRunner& runner;
+			MachineState& state;
+			uint32_t entryPoint;
+			uint32_t toc;
+			uint32_t vector;
+			uint32_t frame;
+			
+			uint32_t savedGPR[13]; // r0-r12
+			double savedFPR[14]; // f0-f13
+			uint32_t savedCR;
+			uint32_t savedXER;
+			uint32_t savedLR;
+			uint32_t savedCTR;
+			
+			void Init(Common::Allocator& allocator);
+			uint32_t Call();
+			
+		public:
+			// fixed-point arguments go in r3-r10
+			static const unsigned MaxArguments = 8;
+			
+			// transitionVector is the guest address of the function's transition vector, like a C function pointer
+			GuestCall(Common::Allocator& allocator, MachineState* state, uint32_t transitionVector);
+			GuestCall(Common::Allocator& allocator, MachineState* state, uint32_t entryPoint, uint32_t toc);
+			GuestCall(const GuestCall& that) = delete;
+			
+			// returns r3; floating-point results are in f1 (see FloatResult)
+			template<typename... TArgument>
+			uint32_t operator()(TArgument... arguments)
+			{
+				static_assert(sizeof...(TArgument) <= MaxArguments, "arguments that don't fit in registers aren't supported");
+				uint32_t values[] = {static_cast<uint32_t>(arguments)..., 0};
+				for (unsigned i = 0; i < sizeof...(TArgument); i++)
+					state.gpr[3 + i] = values[i];
+				return Call();
+			}
+			
+			// floating-point arguments go in f1-f13, and have to be set before each call
+			inline void SetFloatArgument(unsigned index, double value)
+			{
+				state.fpr[1 + index] = value;
+			}
+			
+			inline double FloatResult() const
+			{
+				return state.fpr[1];
+			}
+			
+			~GuestCall();
+		};
+	}
+}
+
+#endif /* defined(__Classix__GuestCall__) */
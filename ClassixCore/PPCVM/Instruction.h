@@ -29,10 +29,10 @@ namespace PPCVM
 	union Instruction
 	{
 		uint32_t hex;
-
+		
 		Instruction(uint32_t hex) : hex(hex) {}
 		Instruction() = default;
-
+		
 		struct
 		{
 			uint32_t Rc			:	1;
@@ -99,7 +99,7 @@ namespace PPCVM
 			uint32_t			:	5;
 			uint32_t			:	6;
 		};
-
+		
 		// Table 59
 		struct
 		{
@@ -111,7 +111,7 @@ namespace PPCVM
 			uint32_t			:	5;
 			uint32_t			:	6;
 		};
-
+		
 		struct
 		{	uint32_t			:	10;
 			uint32_t OE			:	1;
@@ -126,7 +126,7 @@ namespace PPCVM
 			uint32_t SPRL		:	5;
 			uint32_t			:	11;
 		};
-
+		
 		// rlwinmx
 		struct
 		{
@@ -136,7 +136,7 @@ namespace PPCVM
 			uint32_t SH			:	5;
 			uint32_t			:	16;
 		};
-
+		
 		// crxor
 		struct 
 		{
@@ -146,7 +146,7 @@ namespace PPCVM
 			uint32_t CRBD		:	5;
 			uint32_t			:	6;
 		};
-
+		
 		// mftb
 		struct 
 		{
@@ -154,7 +154,7 @@ namespace PPCVM
 			uint32_t TBR		:	10;
 			uint32_t			:	11;
 		};
-
+		
 		struct 
 		{
 			uint32_t			:	11;
@@ -162,7 +162,7 @@ namespace PPCVM
 			uint32_t TBRL		:	5;
 			uint32_t			:	11;
 		};
-
+		
 		struct 
 		{
 			uint32_t			:	18;
@@ -171,7 +171,7 @@ namespace PPCVM
 			uint32_t			:	3;
 			uint32_t			:	6;
 		};
-
+		
 		// float
 		struct 
 		{
@@ -201,7 +201,46 @@ namespace PPCVM
 			uint32_t FM			:	8;
 			uint32_t			:	7;
 		};
-
+		
+		// vector
+		struct
+		{
+			uint32_t VXO		:	11;
+			uint32_t VB			:	5;
+			uint32_t VA			:	5;
+			uint32_t VD			:	5;
+			uint32_t			:	6;
+		};
+		struct
+		{
+			uint32_t VAXO		:	6;
+			uint32_t VC			:	5;
+			uint32_t			:	21;
+		};
+		struct
+		{
+			uint32_t			:	6;
+			uint32_t SHB		:	4;
+			uint32_t VRc		:	1;
+			uint32_t			:	5;
+			uint32_t VUIMM		:	5;
+			uint32_t			:	11;
+		};
+		struct
+		{
+			uint32_t			:	16;
+			signed VSIMM		:	5;
+			uint32_t			:	11;
+		};
+		struct
+		{
+			uint32_t			:	21;
+			uint32_t STRM		:	2;
+			uint32_t			:	2;
+			uint32_t T			:	1;
+			uint32_t			:	6;
+		};
+		
 		// paired
 		struct 
 		{
@@ -213,19 +252,31 @@ namespace PPCVM
 			uint32_t W			:	1;
 			uint32_t			:	16;
 		};
-
+		
 		struct 
 		{
 			signed	SIMM_12		:	12;
 			uint32_t			:	20;
 		};
-
+		
 		struct 
 		{
 			uint32_t			:   11;
 			uint32_t NB			:	5;
 		};
 	};
+	
+	// the mask of rlwimi, rlwinm and rlwnm, from bit mStart to bit mStop (wrapping around when mStop < mStart)
+	inline uint32_t RotateMask(uint32_t mStart, uint32_t mStop)
+	{
+		uint32_t begin = 0xFFFFFFFF >> mStart;
+		// this is *probably* not necessary, since mStop is always encoded on 5 bits it cannot be greater than 31,
+		// but I'm scared to touch that code...
+		// hopefully, llvm is able to optimize that correctly anyways
+		uint32_t end = mStop < 31 ? (0xFFFFFFFF >> (mStop + 1)) : 0;
+		uint32_t mask = begin ^ end;
+		return mStop < mStart ? ~mask : mask;
+	}
 }
 
 #endif
\ No newline at end of file
@@ -23,6 +23,7 @@
 #define INSTRUCTIONDISPATCHER_H
 
 #include "Instruction.h"
+#include <cstddef>
 #include <iostream>
 
 namespace PPCVM
@@ -30,29 +31,106 @@ namespace PPCVM
 	template<typename TDispatchTo>
 	class InstructionDispatcher
 	{
+	public:
 		typedef void (TDispatchTo::*DispatchableMethod)(Instruction);
 		
-		static DispatchableMethod primaryTable[64];
-		static DispatchableMethod table19[1024];
-		static DispatchableMethod table31[1024];
-		static DispatchableMethod table59[32];
-		static DispatchableMethod table63[1024];
+	private:
+		// Handlers that depend on the Rc, OE, LK or AA bits are templates over them, and the tables are indexed with
+		// these bits too, so that each slot points to the exact variant and handlers never test them at runtime.
+		// The primary table has four slots per opcode (AA and LK; for other instructions, these bits are Rc or
+		// part of an immediate), and tables 19, 31, 59 and 63 have two (LK or Rc). OE is already part of SUBOP10,
+		// and Rc is already part of VXO for vector compares.
+		// Tables are built by constexpr functions, so that their completeness can be checked at compile time (see
+		// GetMethod), and the static tables that GetMethod reads are initialized with what they return.
+		template<size_t Size>
+		struct Table
+		{
+			DispatchableMethod slots[Size];
+		};
+		
+		static constexpr Table<256> PrimaryTable();
+		static constexpr Table<2048> Table4();
+		static constexpr Table<64> Table4VA();
+		static constexpr Table<2048> Table19();
+		static constexpr Table<2048> Table31();
+		static constexpr Table<64> Table59();
+		static constexpr Table<2048> Table63();
+		
+		static const Table<256> primaryTable;
+		static const Table<2048> table4;
+		static const Table<64> table4va;
+		static const Table<2048> table19;
+		static const Table<2048> table31;
+		static const Table<64> table59;
+		static const Table<2048> table63;
+		
+		// Every slot of a group is filled, or none of them is.
+		template<size_t Size>
+		static constexpr bool GroupFilled(const Table<Size>& table, size_t begin, size_t end, bool filled)
+		{
+			return begin == end || ((table.slots[begin] != nullptr) == filled && GroupFilled(table, begin + 1, end, filled));
+		}
+		
+		// Each group of `group` consecutive slots holds the variants of one instruction, so an instruction that has a
+		// handler has one for all of its variants. Splits the table in halves to keep the recursion shallow.
+		template<size_t Size>
+		static constexpr bool VariantsComplete(const Table<Size>& table, size_t group, size_t begin = 0, size_t end = Size)
+		{
+			return end - begin == group
+				? GroupFilled(table, begin, end, table.slots[begin] != nullptr)
+				: VariantsComplete(table, group, begin, begin + (end - begin) / 2) && VariantsComplete(table, group, begin + (end - begin) / 2, end);
+		}
 		
-		static void DisassembleIfAsked(Instruction inst);
+		// OE variants of XO-form instructions are 0x200 extended opcodes further, out of their group.
+		template<size_t Size>
+		static constexpr bool OEVariantsComplete(const Table<Size>&)
+		{
+			return true;
+		}
+		
+		template<size_t Size, typename... TOpcodes>
+		static constexpr bool OEVariantsComplete(const Table<Size>& table, size_t opcode, TOpcodes... opcodes)
+		{
+			return GroupFilled(table, opcode << 1, (opcode << 1) + 2, true)
+				&& GroupFilled(table, (opcode | 0x200) << 1, ((opcode | 0x200) << 1) + 2, true)
+				&& OEVariantsComplete(table, opcodes...);
+		}
+		
+		// Vector compares are the VX-form instructions whose extended opcode ends with 6; Rc is their bit 0x400.
+		template<size_t Size>
+		static constexpr bool VectorComparesComplete(const Table<Size>& table, size_t row = 0)
+		{
+			return row == 16 || ((table.slots[row << 6 | 6] != nullptr) == (table.slots[row << 6 | 6 | 0x400] != nullptr) && VectorComparesComplete(table, row + 1));
+		}
 		
 	public:
-		void Dispatch(Instruction inst)
+		// returns nullptr for instructions that have no handler
+		static DispatchableMethod GetMethod(Instruction inst)
 		{
-			DispatchableMethod method = nullptr;
+			// here, TDispatchTo is complete, and the table functions can be evaluated
+			static_assert(VariantsComplete(PrimaryTable(), 4), "an instruction of the primary table misses some AA/LK/Rc variants");
+			static_assert(VectorComparesComplete(Table4()), "a vector compare misses its Rc variant");
+			static_assert(VariantsComplete(Table19(), 2), "an instruction of table 19 misses its LK variant");
+			static_assert(VariantsComplete(Table31(), 2), "an instruction of table 31 misses its Rc variant");
+			static_assert(OEVariantsComplete(Table31(), 8, 10, 40, 104, 136, 138, 200, 202, 232, 234, 235, 266, 459, 491), "an XO-form instruction misses some OE variants");
+			static_assert(VariantsComplete(Table59(), 2), "an instruction of table 59 misses its Rc variant");
+			static_assert(VariantsComplete(Table63(), 2), "an instruction of table 63 misses its Rc variant");
+			
 			switch (inst.OPCD)
 			{
-				case 19: method = table19[inst.SUBOP10]; break;
-				case 31: method = table31[inst.SUBOP10]; break;
-				case 59: method = table59[inst.SUBOP5]; break;
-				case 63: method = table63[inst.SUBOP10]; break;
-				default: method = primaryTable[inst.OPCD]; break;
+				// VA-form vector instructions are the only ones with bit 0x20 set in the low 6 bits
+				case 4: return inst.VAXO & 0x20 ? table4va.slots[inst.VAXO] : table4.slots[inst.VXO];
+				case 19: return table19.slots[inst.SUBOP10 << 1 | inst.LK];
+				case 31: return table31.slots[inst.SUBOP10 << 1 | inst.Rc];
+				case 59: return table59.slots[inst.SUBOP5 << 1 | inst.Rc];
+				case 63: return table63.slots[inst.SUBOP10 << 1 | inst.Rc];
+				default: return primaryTable.slots[inst.OPCD << 2 | inst.AA << 1 | inst.LK];
 			}
-			
+		}
+		
+		void Dispatch(Instruction inst)
+		{
+			DispatchableMethod method = GetMethod(inst);
 			TDispatchTo* target = static_cast<TDispatchTo*>(this);
 			if (method == nullptr)
 			{
@@ -65,564 +143,793 @@ namespace PPCVM
 		}
 	};
 
+// Each macro fills all the slots of an instruction, one for each combination of its flag bits, so a table can't
+// miss a variant. Filling a slot twice makes clang warn about overridden initializers.
+#define VARIANT(x, ...)	&TDispatchTo::template x<__VA_ARGS__>
+#define PRIMARY(n, x)	[(n) << 2] = &TDispatchTo::x, [(n) << 2 | 1] = &TDispatchTo::x, [(n) << 2 | 2] = &TDispatchTo::x, [(n) << 2 | 3] = &TDispatchTo::x
+#define PRIMARY_RC(n, x)	[(n) << 2] = VARIANT(x, false), [(n) << 2 | 1] = VARIANT(x, true), [(n) << 2 | 2] = VARIANT(x, false), [(n) << 2 | 3] = VARIANT(x, true)
+#define PRIMARY_AA_LK(n, x)	[(n) << 2] = VARIANT(x, false, false), [(n) << 2 | 1] = VARIANT(x, false, true), [(n) << 2 | 2] = VARIANT(x, true, false), [(n) << 2 | 3] = VARIANT(x, true, true)
+#define EXTENDED(n, x)	[(n) << 1] = &TDispatchTo::x, [(n) << 1 | 1] = &TDispatchTo::x
+#define EXTENDED_RC(n, x)	[(n) << 1] = VARIANT(x, false), [(n) << 1 | 1] = VARIANT(x, true)
+#define EXTENDED_LK(n, x)	EXTENDED_RC(n, x)
+#define EXTENDED_OE_RC(n, x)	[(n) << 1] = VARIANT(x, false, false), [(n) << 1 | 1] = VARIANT(x, false, true), [((n) | 0x200) << 1] = VARIANT(x, true, false), [((n) | 0x200) << 1 | 1] = VARIANT(x, true, true)
+#define VECTOR_RC(n, x)	[n] = VARIANT(x, false), [(n) | 0x400] = VARIANT(x, true)
+	
 	template<typename TDispatchTo>
-	typename InstructionDispatcher<TDispatchTo>::DispatchableMethod InstructionDispatcher<TDispatchTo>::primaryTable[64] =
+	constexpr typename InstructionDispatcher<TDispatchTo>::template Table<256> InstructionDispatcher<TDispatchTo>::PrimaryTable()
 	{
-		[3] = &TDispatchTo::twi,
-		[7] = &TDispatchTo::mulli,
-		[8] = &TDispatchTo::subfic,
-		[10] = &TDispatchTo::cmpli,
-		[11] = &TDispatchTo::cmpi,
-		[12] = &TDispatchTo::addic,
-		[13] = &TDispatchTo::addic_rc,
-		[14] = &TDispatchTo::addi,
-		[15] = &TDispatchTo::addis,
-		[16] = &TDispatchTo::bcx,
-		[17] = &TDispatchTo::sc,
-		[18] = &TDispatchTo::bx,
-		[20] = &TDispatchTo::rlwimix,
-		[21] = &TDispatchTo::rlwinmx,
-		[23] = &TDispatchTo::rlwnmx,
-		[24] = &TDispatchTo::ori,
-		[25] = &TDispatchTo::oris,
-		[26] = &TDispatchTo::xori,
-		[27] = &TDispatchTo::xoris,
-		[28] = &TDispatchTo::andi_rc,
-		[29] = &TDispatchTo::andis_rc,
-		[32] = &TDispatchTo::lwz,
-		[33] = &TDispatchTo::lwzu,
-		[34] = &TDispatchTo::lbz,
-		[35] = &TDispatchTo::lbzu,
-		[36] = &TDispatchTo::stw,
-		[37] = &TDispatchTo::stwu,
-		[38] = &TDispatchTo::stb,
-		[39] = &TDispatchTo::stbu,
-		[40] = &TDispatchTo::lhz,
-		[41] = &TDispatchTo::lhzu,
-		[42] = &TDispatchTo::lha,
-		[43] = &TDispatchTo::lhau,
-		[44] = &TDispatchTo::sth,
-		[45] = &TDispatchTo::sthu,
-		[46] = &TDispatchTo::lmw,
-		[47] = &TDispatchTo::stmw,
-		[48] = &TDispatchTo::lfs,
-		[49] = &TDispatchTo::lfsu,
-		[50] = &TDispatchTo::lfd,
-		[51] = &TDispatchTo::lfdu,
-		[52] = &TDispatchTo::stfs,
-		[53] = &TDispatchTo::stfsu,
-		[54] = &TDispatchTo::stfd,
-		[55] = &TDispatchTo::stfdu,
-	};
-
+		return {{
+			PRIMARY(3, twi),
+			PRIMARY(7, mulli),
+			PRIMARY(8, subfic),
+			PRIMARY(10, cmpli),
+			PRIMARY(11, cmpi),
+			PRIMARY(12, addic),
+			PRIMARY(13, addic_rc),
+			PRIMARY(14, addi),
+			PRIMARY(15, addis),
+			PRIMARY_AA_LK(16, bcx),
+			PRIMARY(17, sc),
+			PRIMARY_AA_LK(18, bx),
+			PRIMARY_RC(20, rlwimix),
+			PRIMARY_RC(21, rlwinmx),
+			PRIMARY_RC(23, rlwnmx),
+			PRIMARY(24, ori),
+			PRIMARY(25, oris),
+			PRIMARY(26, xori),
+			PRIMARY(27, xoris),
+			PRIMARY(28, andi_rc),
+			PRIMARY(29, andis_rc),
+			PRIMARY(32, lwz),
+			PRIMARY(33, lwzu),
+			PRIMARY(34, lbz),
+			PRIMARY(35, lbzu),
+			PRIMARY(36, stw),
+			PRIMARY(37, stwu),
+			PRIMARY(38, stb),
+			PRIMARY(39, stbu),
+			PRIMARY(40, lhz),
+			PRIMARY(41, lhzu),
+			PRIMARY(42, lha),
+			PRIMARY(43, lhau),
+			PRIMARY(44, sth),
+			PRIMARY(45, sthu),
+			PRIMARY(46, lmw),
+			PRIMARY(47, stmw),
+			PRIMARY(48, lfs),
+			PRIMARY(49, lfsu),
+			PRIMARY(50, lfd),
+			PRIMARY(51, lfdu),
+			PRIMARY(52, stfs),
+			PRIMARY(53, stfsu),
+			PRIMARY(54, stfd),
+			PRIMARY(55, stfdu),
+		}};
+	}
+	
+	template<typename TDispatchTo>
+	const typename InstructionDispatcher<TDispatchTo>::template Table<256> InstructionDispatcher<TDispatchTo>::primaryTable = PrimaryTable();
+	
 	template<typename TDispatchTo>
-	typename InstructionDispatcher<TDispatchTo>::DispatchableMethod InstructionDispatcher<TDispatchTo>::table19[1024] =
+	constexpr typename InstructionDispatcher<TDispatchTo>::template Table<2048> InstructionDispatcher<TDispatchTo>::Table4()
 	{
-		[0] = &TDispatchTo::mcrf,
-		[16] = &TDispatchTo::bclrx,
-		[18] = &TDispatchTo::rfi,
-		[33] = &TDispatchTo::crnor,
-		[50] = &TDispatchTo::rfi,
-		[129] = &TDispatchTo::crandc,
-		[150] = &TDispatchTo::isync,
-		[193] = &TDispatchTo::crxor,
-		[225] = &TDispatchTo::crnand,
-		[257] = &TDispatchTo::crand,
-		[289] = &TDispatchTo::creqv,
-		[417] = &TDispatchTo::crorc,
-		[449] = &TDispatchTo::cror,
-		[528] = &TDispatchTo::bcctrx,
-	};
-
+		return {{
+			[0] = &TDispatchTo::vaddubm,
+			[2] = &TDispatchTo::vmaxub,
+			[4] = &TDispatchTo::vrlb,
+			VECTOR_RC(6, vcmpequbx),
+			[8] = &TDispatchTo::vmuloub,
+			[10] = &TDispatchTo::vaddfp,
+			[12] = &TDispatchTo::vmrghb,
+			[14] = &TDispatchTo::vpkuhum,
+			[64] = &TDispatchTo::vadduhm,
+			[66] = &TDispatchTo::vmaxuh,
+			[68] = &TDispatchTo::vrlh,
+			VECTOR_RC(70, vcmpequhx),
+			[72] = &TDispatchTo::vmulouh,
+			[74] = &TDispatchTo::vsubfp,
+			[76] = &TDispatchTo::vmrghh,
+			[78] = &TDispatchTo::vpkuwum,
+			[128] = &TDispatchTo::vadduwm,
+			[130] = &TDispatchTo::vmaxuw,
+			[132] = &TDispatchTo::vrlw,
+			VECTOR_RC(134, vcmpequwx),
+			[140] = &TDispatchTo::vmrghw,
+			[142] = &TDispatchTo::vpkuhus,
+			VECTOR_RC(198, vcmpeqfpx),
+			[206] = &TDispatchTo::vpkuwus,
+			[258] = &TDispatchTo::vmaxsb,
+			[260] = &TDispatchTo::vslb,
+			[264] = &TDispatchTo::vmulosb,
+			[266] = &TDispatchTo::vrefp,
+			[268] = &TDispatchTo::vmrglb,
+			[270] = &TDispatchTo::vpkshus,
+			[322] = &TDispatchTo::vmaxsh,
+			[324] = &TDispatchTo::vslh,
+			[328] = &TDispatchTo::vmulosh,
+			[330] = &TDispatchTo::vrsqrtefp,
+			[332] = &TDispatchTo::vmrglh,
+			[334] = &TDispatchTo::vpkswus,
+			[384] = &TDispatchTo::vaddcuw,
+			[386] = &TDispatchTo::vmaxsw,
+			[388] = &TDispatchTo::vslw,
+			[394] = &TDispatchTo::vexptefp,
+			[396] = &TDispatchTo::vmrglw,
+			[398] = &TDispatchTo::vpkshss,
+			[452] = &TDispatchTo::vsl,
+			VECTOR_RC(454, vcmpgefpx),
+			[458] = &TDispatchTo::vlogefp,
+			[462] = &TDispatchTo::vpkswss,
+			[512] = &TDispatchTo::vaddubs,
+			[514] = &TDispatchTo::vminub,
+			[516] = &TDispatchTo::vsrb,
+			VECTOR_RC(518, vcmpgtubx),
+			[520] = &TDispatchTo::vmuleub,
+			[522] = &TDispatchTo::vrfin,
+			[524] = &TDispatchTo::vspltb,
+			[526] = &TDispatchTo::vupkhsb,
+			[576] = &TDispatchTo::vadduhs,
+			[578] = &TDispatchTo::vminuh,
+			[580] = &TDispatchTo::vsrh,
+			VECTOR_RC(582, vcmpgtuhx),
+			[584] = &TDispatchTo::vmuleuh,
+			[586] = &TDispatchTo::vrfiz,
+			[588] = &TDispatchTo::vsplth,
+			[590] = &TDispatchTo::vupkhsh,
+			[640] = &TDispatchTo::vadduws,
+			[642] = &TDispatchTo::vminuw,
+			[644] = &TDispatchTo::vsrw,
+			VECTOR_RC(646, vcmpgtuwx),
+			[650] = &TDispatchTo::vrfip,
+			[652] = &TDispatchTo::vspltw,
+			[654] = &TDispatchTo::vupklsb,
+			[708] = &TDispatchTo::vsr,
+			VECTOR_RC(710, vcmpgtfpx),
+			[714] = &TDispatchTo::vrfim,
+			[718] = &TDispatchTo::vupklsh,
+			[768] = &TDispatchTo::vaddsbs,
+			[770] = &TDispatchTo::vminsb,
+			[772] = &TDispatchTo::vsrab,
+			VECTOR_RC(774, vcmpgtsbx),
+			[776] = &TDispatchTo::vmulesb,
+			[778] = &TDispatchTo::vcfux,
+			[780] = &TDispatchTo::vspltisb,
+			[782] = &TDispatchTo::vpkpx,
+			[832] = &TDispatchTo::vaddshs,
+			[834] = &TDispatchTo::vminsh,
+			[836] = &TDispatchTo::vsrah,
+			VECTOR_RC(838, vcmpgtshx),
+			[840] = &TDispatchTo::vmulesh,
+			[842] = &TDispatchTo::vcfsx,
+			[844] = &TDispatchTo::vspltish,
+			[846] = &TDispatchTo::vupkhpx,
+			[896] = &TDispatchTo::vaddsws,
+			[898] = &TDispatchTo::vminsw,
+			[900] = &TDispatchTo::vsraw,
+			VECTOR_RC(902, vcmpgtswx),
+			[906] = &TDispatchTo::vctuxs,
+			[908] = &TDispatchTo::vspltisw,
+			VECTOR_RC(966, vcmpbfpx),
+			[970] = &TDispatchTo::vctsxs,
+			[974] = &TDispatchTo::vupklpx,
+			[1024] = &TDispatchTo::vsububm,
+			[1026] = &TDispatchTo::vavgub,
+			[1028] = &TDispatchTo::vand,
+			[1034] = &TDispatchTo::vmaxfp,
+			[1036] = &TDispatchTo::vslo,
+			[1088] = &TDispatchTo::vsubuhm,
+			[1090] = &TDispatchTo::vavguh,
+			[1092] = &TDispatchTo::vandc,
+			[1098] = &TDispatchTo::vminfp,
+			[1100] = &TDispatchTo::vsro,
+			[1152] = &TDispatchTo::vsubuwm,
+			[1154] = &TDispatchTo::vavguw,
+			[1156] = &TDispatchTo::vor,
+			[1220] = &TDispatchTo::vxor,
+			[1282] = &TDispatchTo::vavgsb,
+			[1284] = &TDispatchTo::vnor,
+			[1346] = &TDispatchTo::vavgsh,
+			[1408] = &TDispatchTo::vsubcuw,
+			[1410] = &TDispatchTo::vavgsw,
+			[1536] = &TDispatchTo::vsububs,
+			[1540] = &TDispatchTo::mfvscr,
+			[1544] = &TDispatchTo::vsum4ubs,
+			[1600] = &TDispatchTo::vsubuhs,
+			[1604] = &TDispatchTo::mtvscr,
+			[1608] = &TDispatchTo::vsum4shs,
+			[1664] = &TDispatchTo::vsubuws,
+			[1672] = &TDispatchTo::vsum2sws,
+			[1792] = &TDispatchTo::vsubsbs,
+			[1800] = &TDispatchTo::vsum4sbs,
+			[1856] = &TDispatchTo::vsubshs,
+			[1920] = &TDispatchTo::vsubsws,
+			[1928] = &TDispatchTo::vsumsws,
+		}};
+	}
+	
+	template<typename TDispatchTo>
+	const typename InstructionDispatcher<TDispatchTo>::template Table<2048> InstructionDispatcher<TDispatchTo>::table4 = Table4();
+	
 	template<typename TDispatchTo>
-	typename InstructionDispatcher<TDispatchTo>::DispatchableMethod InstructionDispatcher<TDispatchTo>::table31[1024] =
+	constexpr typename InstructionDispatcher<TDispatchTo>::template Table<64> InstructionDispatcher<TDispatchTo>::Table4VA()
 	{
-		[0] = &TDispatchTo::cmp,
-		[4] = &TDispatchTo::tw,
-		[8] = &TDispatchTo::subfcx,
-		[10] = &TDispatchTo::addcx,
-		[11] = &TDispatchTo::mulhwux,
-		[19] = &TDispatchTo::mfcr,
-		[20] = &TDispatchTo::lwarx,
-		[23] = &TDispatchTo::lwzx,
-		[24] = &TDispatchTo::slwx,
-		[26] = &TDispatchTo::cntlzwx,
-		[28] = &TDispatchTo::andx,
-		[32] = &TDispatchTo::cmpl,
-		[40] = &TDispatchTo::subfx,
-		[54] = &TDispatchTo::dcbst,
-		[55] = &TDispatchTo::lwzux,
-		[60] = &TDispatchTo::andcx,
-		[75] = &TDispatchTo::mulhwx,
-		[83] = &TDispatchTo::mfmsr,
-		[86] = &TDispatchTo::dcbf,
-		[87] = &TDispatchTo::lbzx,
-		[104] = &TDispatchTo::negx,
-		[119] = &TDispatchTo::lbzux,
-		[124] = &TDispatchTo::norx,
-		[136] = &TDispatchTo::subfex,
-		[138] = &TDispatchTo::addex,
-		[144] = &TDispatchTo::mtcrf,
-		[146] = &TDispatchTo::mtmsr,
-		[150] = &TDispatchTo::stwcxd,
-		[151] = &TDispatchTo::stwx,
-		[183] = &TDispatchTo::stwux,
-		[200] = &TDispatchTo::subfzex,
-		[202] = &TDispatchTo::addzex,
-		[210] = &TDispatchTo::mtsr,
-		[215] = &TDispatchTo::stbx,
-		[232] = &TDispatchTo::subfmex,
-		[234] = &TDispatchTo::addmex,
-		[235] = &TDispatchTo::mullwx,
-		[242] = &TDispatchTo::mtsrin,
-		[246] = &TDispatchTo::dcbtst,
-		[247] = &TDispatchTo::stbux,
-		[266] = &TDispatchTo::addx,
-		[278] = &TDispatchTo::dcbt,
-		[279] = &TDispatchTo::lhzx,
-		[284] = &TDispatchTo::eqvx,
-		[306] = &TDispatchTo::tlbie,
-		[310] = &TDispatchTo::eciwx,
-		[311] = &TDispatchTo::lhzux,
-		[316] = &TDispatchTo::xorx,
-		[339] = &TDispatchTo::mfspr,
-		[343] = &TDispatchTo::lhax,
-		[370] = &TDispatchTo::tlbia,
-		[371] = &TDispatchTo::mftb,
-		[375] = &TDispatchTo::lhaux,
-		[407] = &TDispatchTo::sthx,
-		[412] = &TDispatchTo::orcx,
-		[438] = &TDispatchTo::ecowx,
-		[439] = &TDispatchTo::sthux,
-		[444] = &TDispatchTo::orx,
-		[459] = &TDispatchTo::divwux,
-		[467] = &TDispatchTo::mtspr,
-		[470] = &TDispatchTo::dcbi,
-		[476] = &TDispatchTo::nandx,
-		[491] = &TDispatchTo::divwx,
-		[512] = &TDispatchTo::mcrxr,
-		[533] = &TDispatchTo::lswx,
-		[534] = &TDispatchTo::lwbrx,
-		[535] = &TDispatchTo::lfsx,
-		[536] = &TDispatchTo::srwx,
-		[552] = &TDispatchTo::subfx,
-		[566] = &TDispatchTo::tlbsync,
-		[567] = &TDispatchTo::lfsux,
-		[595] = &TDispatchTo::mfsr,
-		[597] = &TDispatchTo::lswi,
-		[598] = &TDispatchTo::sync,
-		[599] = &TDispatchTo::lfdx,
-		[631] = &TDispatchTo::lfdux,
-		[659] = &TDispatchTo::mfsrin,
-		[661] = &TDispatchTo::stswx,
-		[662] = &TDispatchTo::stwbrx,
-		[663] = &TDispatchTo::stfsx,
-		[695] = &TDispatchTo::stfsux,
-		[725] = &TDispatchTo::stswi,
-		[727] = &TDispatchTo::stfdx,
-		[747] = &TDispatchTo::mullwx,
-		[758] = &TDispatchTo::dcba,
-		[759] = &TDispatchTo::stfdux,
-		[778] = &TDispatchTo::addx,
-		[790] = &TDispatchTo::lhbrx,
-		[792] = &TDispatchTo::srawx,
-		[824] = &TDispatchTo::srawix,
-		[854] = &TDispatchTo::eieio,
-		[918] = &TDispatchTo::sthbrx,
-		[922] = &TDispatchTo::extshx,
-		[954] = &TDispatchTo::extsbx,
-		[971] = &TDispatchTo::divwux,
-		[982] = &TDispatchTo::icbi,
-		[983] = &TDispatchTo::stfiwx,
-		[1003] = &TDispatchTo::divwx,
-		[1014] = &TDispatchTo::dcbz,
-	};
-
+		return {{
+			[32] = &TDispatchTo::vmhaddshs,
+			[33] = &TDispatchTo::vmhraddshs,
+			[34] = &TDispatchTo::vmladduhm,
+			[36] = &TDispatchTo::vmsumubm,
+			[37] = &TDispatchTo::vmsummbm,
+			[38] = &TDispatchTo::vmsumuhm,
+			[39] = &TDispatchTo::vmsumuhs,
+			[40] = &TDispatchTo::vmsumshm,
+			[41] = &TDispatchTo::vmsumshs,
+			[42] = &TDispatchTo::vsel,
+			[43] = &TDispatchTo::vperm,
+			[44] = &TDispatchTo::vsldoi,
+			[46] = &TDispatchTo::vmaddfp,
+			[47] = &TDispatchTo::vnmsubfp,
+		}};
+	}
+	
+	template<typename TDispatchTo>
+	const typename InstructionDispatcher<TDispatchTo>::template Table<64> InstructionDispatcher<TDispatchTo>::table4va = Table4VA();
+	
 	template<typename TDispatchTo>
-	typename InstructionDispatcher<TDispatchTo>::DispatchableMethod InstructionDispatcher<TDispatchTo>::table59[32] =
+	constexpr typename InstructionDispatcher<TDispatchTo>::template Table<2048> InstructionDispatcher<TDispatchTo>::Table19()
 	{
-		[18] = &TDispatchTo::fdivsx,
-		[20] = &TDispatchTo::fsubsx,
-		[21] = &TDispatchTo::faddsx,
-		[24] = &TDispatchTo::fresx,
-		[25] = &TDispatchTo::fmulsx,
-		[28] = &TDispatchTo::fmsubsx,
-		[29] = &TDispatchTo::fmaddsx,
-		[30] = &TDispatchTo::fnmsubsx,
-		[31] = &TDispatchTo::fnmaddsx,
-	};
-
+		return {{
+			EXTENDED(0, mcrf),
+			EXTENDED_LK(16, bclrx),
+			EXTENDED(18, rfi),
+			EXTENDED(33, crnor),
+			EXTENDED(50, rfi),
+			EXTENDED(129, crandc),
+			EXTENDED(150, isync),
+			EXTENDED(193, crxor),
+			EXTENDED(225, crnand),
+			EXTENDED(257, crand),
+			EXTENDED(289, creqv),
+			EXTENDED(417, crorc),
+			EXTENDED(449, cror),
+			EXTENDED_LK(528, bcctrx),
+		}};
+	}
+	
+	template<typename TDispatchTo>
+	const typename InstructionDispatcher<TDispatchTo>::template Table<2048> InstructionDispatcher<TDispatchTo>::table19 = Table19();
+	
 	template<typename TDispatchTo>
-	typename InstructionDispatcher<TDispatchTo>::DispatchableMethod InstructionDispatcher<TDispatchTo>::table63[1024] =
+	constexpr typename InstructionDispatcher<TDispatchTo>::template Table<2048> InstructionDispatcher<TDispatchTo>::Table31()
 	{
-		[0] = &TDispatchTo::fcmpu,
-		[12] = &TDispatchTo::frspx,
-		[14] = &TDispatchTo::fctiwx,
-		[15] = &TDispatchTo::fctiwzx,
-		[18] = &TDispatchTo::fdivx,
-		[20] = &TDispatchTo::fsubx,
-		[21] = &TDispatchTo::faddx,
-		[22] = &TDispatchTo::fsqrtx,
-		[23] = &TDispatchTo::fselx,
-		[25] = &TDispatchTo::fmulx,
-		[26] = &TDispatchTo::frsqrtex,
-		[28] = &TDispatchTo::fmsubx,
-		[29] = &TDispatchTo::fmaddx,
-		[30] = &TDispatchTo::fnmsubx,
-		[31] = &TDispatchTo::fnmaddx,
-		[32] = &TDispatchTo::fcmpo,
-		[38] = &TDispatchTo::mtfsb1x,
-		[40] = &TDispatchTo::fnegx,
-		[50] = &TDispatchTo::fdivx,
-		[52] = &TDispatchTo::fsubx,
-		[53] = &TDispatchTo::faddx,
-		[54] = &TDispatchTo::fsqrtx,
-		[55] = &TDispatchTo::fselx,
-		[57] = &TDispatchTo::fmulx,
-		[58] = &TDispatchTo::frsqrtex,
-		[60] = &TDispatchTo::fmsubx,
-		[61] = &TDispatchTo::fmaddx,
-		[62] = &TDispatchTo::fnmsubx,
-		[63] = &TDispatchTo::fnmaddx,
-		[64] = &TDispatchTo::mcrfs,
-		[70] = &TDispatchTo::mtfsb0x,
-		[72] = &TDispatchTo::fmrx,
-		[82] = &TDispatchTo::fdivx,
-		[84] = &TDispatchTo::fsubx,
-		[85] = &TDispatchTo::faddx,
-		[86] = &TDispatchTo::fsqrtx,
-		[87] = &TDispatchTo::fselx,
-		[89] = &TDispatchTo::fmulx,
-		[90] = &TDispatchTo::frsqrtex,
-		[92] = &TDispatchTo::fmsubx,
-		[93] = &TDispatchTo::fmaddx,
-		[94] = &TDispatchTo::fnmsubx,
-		[95] = &TDispatchTo::fnmaddx,
-		[114] = &TDispatchTo::fdivx,
-		[116] = &TDispatchTo::fsubx,
-		[117] = &TDispatchTo::faddx,
-		[118] = &TDispatchTo::fsqrtx,
-		[119] = &TDispatchTo::fselx,
-		[121] = &TDispatchTo::fmulx,
-		[122] = &TDispatchTo::frsqrtex,
-		[124] = &TDispatchTo::fmsubx,
-		[125] = &TDispatchTo::fmaddx,
-		[126] = &TDispatchTo::fnmsubx,
-		[127] = &TDispatchTo::fnmaddx,
-		[134] = &TDispatchTo::mtfsfix,
-		[136] = &TDispatchTo::fnabsx,
-		[146] = &TDispatchTo::fdivx,
-		[148] = &TDispatchTo::fsubx,
-		[149] = &TDispatchTo::faddx,
-		[150] = &TDispatchTo::fsqrtx,
-		[151] = &TDispatchTo::fselx,
-		[153] = &TDispatchTo::fmulx,
-		[154] = &TDispatchTo::frsqrtex,
-		[156] = &TDispatchTo::fmsubx,
-		[157] = &TDispatchTo::fmaddx,
-		[158] = &TDispatchTo::fnmsubx,
-		[159] = &TDispatchTo::fnmaddx,
-		[178] = &TDispatchTo::fdivx,
-		[180] = &TDispatchTo::fsubx,
-		[181] = &TDispatchTo::faddx,
-		[182] = &TDispatchTo::fsqrtx,
-		[183] = &TDispatchTo::fselx,
-		[185] = &TDispatchTo::fmulx,
-		[186] = &TDispatchTo::frsqrtex,
-		[188] = &TDispatchTo::fmsubx,
-		[189] = &TDispatchTo::fmaddx,
-		[190] = &TDispatchTo::fnmsubx,
-		[191] = &TDispatchTo::fnmaddx,
-		[210] = &TDispatchTo::fdivx,
-		[212] = &TDispatchTo::fsubx,
-		[213] = &TDispatchTo::faddx,
-		[214] = &TDispatchTo::fsqrtx,
-		[215] = &TDispatchTo::fselx,
-		[217] = &TDispatchTo::fmulx,
-		[218] = &TDispatchTo::frsqrtex,
-		[220] = &TDispatchTo::fmsubx,
-		[221] = &TDispatchTo::fmaddx,
-		[222] = &TDispatchTo::fnmsubx,
-		[223] = &TDispatchTo::fnmaddx,
-		[242] = &TDispatchTo::fdivx,
-		[244] = &TDispatchTo::fsubx,
-		[245] = &TDispatchTo::faddx,
-		[246] = &TDispatchTo::fsqrtx,
-		[247] = &TDispatchTo::fselx,
-		[249] = &TDispatchTo::fmulx,
-		[250] = &TDispatchTo::frsqrtex,
-		[252] = &TDispatchTo::fmsubx,
-		[253] = &TDispatchTo::fmaddx,
-		[254] = &TDispatchTo::fnmsubx,
-		[255] = &TDispatchTo::fnmaddx,
-		[264] = &TDispatchTo::fabsx,
-		[274] = &TDispatchTo::fdivx,
-		[276] = &TDispatchTo::fsubx,
-		[277] = &TDispatchTo::faddx,
-		[278] = &TDispatchTo::fsqrtx,
-		[279] = &TDispatchTo::fselx,
-		[281] = &TDispatchTo::fmulx,
-		[282] = &TDispatchTo::frsqrtex,
-		[284] = &TDispatchTo::fmsubx,
-		[285] = &TDispatchTo::fmaddx,
-		[286] = &TDispatchTo::fnmsubx,
-		[287] = &TDispatchTo::fnmaddx,
-		[306] = &TDispatchTo::fdivx,
-		[308] = &TDispatchTo::fsubx,
-		[309] = &TDispatchTo::faddx,
-		[310] = &TDispatchTo::fsqrtx,
-		[311] = &TDispatchTo::fselx,
-		[313] = &TDispatchTo::fmulx,
-		[314] = &TDispatchTo::frsqrtex,
-		[316] = &TDispatchTo::fmsubx,
-		[317] = &TDispatchTo::fmaddx,
-		[318] = &TDispatchTo::fnmsubx,
-		[319] = &TDispatchTo::fnmaddx,
-		[338] = &TDispatchTo::fdivx,
-		[340] = &TDispatchTo::fsubx,
-		[341] = &TDispatchTo::faddx,
-		[342] = &TDispatchTo::fsqrtx,
-		[343] = &TDispatchTo::fselx,
-		[345] = &TDispatchTo::fmulx,
-		[346] = &TDispatchTo::frsqrtex,
-		[348] = &TDispatchTo::fmsubx,
-		[349] = &TDispatchTo::fmaddx,
-		[350] = &TDispatchTo::fnmsubx,
-		[351] = &TDispatchTo::fnmaddx,
-		[370] = &TDispatchTo::fdivx,
-		[372] = &TDispatchTo::fsubx,
-		[373] = &TDispatchTo::faddx,
-		[374] = &TDispatchTo::fsqrtx,
-		[375] = &TDispatchTo::fselx,
-		[377] = &TDispatchTo::fmulx,
-		[378] = &TDispatchTo::frsqrtex,
-		[380] = &TDispatchTo::fmsubx,
-		[381] = &TDispatchTo::fmaddx,
-		[382] = &TDispatchTo::fnmsubx,
-		[383] = &TDispatchTo::fnmaddx,
-		[402] = &TDispatchTo::fdivx,
-		[404] = &TDispatchTo::fsubx,
-		[405] = &TDispatchTo::faddx,
-		[406] = &TDispatchTo::fsqrtx,
-		[407] = &TDispatchTo::fselx,
-		[409] = &TDispatchTo::fmulx,
-		[410] = &TDispatchTo::frsqrtex,
-		[412] = &TDispatchTo::fmsubx,
-		[413] = &TDispatchTo::fmaddx,
-		[414] = &TDispatchTo::fnmsubx,
-		[415] = &TDispatchTo::fnmaddx,
-		[434] = &TDispatchTo::fdivx,
-		[436] = &TDispatchTo::fsubx,
-		[437] = &TDispatchTo::faddx,
-		[438] = &TDispatchTo::fsqrtx,
-		[439] = &TDispatchTo::fselx,
-		[441] = &TDispatchTo::fmulx,
-		[442] = &TDispatchTo::frsqrtex,
-		[444] = &TDispatchTo::fmsubx,
-		[445] = &TDispatchTo::fmaddx,
-		[446] = &TDispatchTo::fnmsubx,
-		[447] = &TDispatchTo::fnmaddx,
-		[466] = &TDispatchTo::fdivx,
-		[468] = &TDispatchTo::fsubx,
-		[469] = &TDispatchTo::faddx,
-		[470] = &TDispatchTo::fsqrtx,
-		[471] = &TDispatchTo::fselx,
-		[473] = &TDispatchTo::fmulx,
-		[474] = &TDispatchTo::frsqrtex,
-		[476] = &TDispatchTo::fmsubx,
-		[477] = &TDispatchTo::fmaddx,
-		[478] = &TDispatchTo::fnmsubx,
-		[479] = &TDispatchTo::fnmaddx,
-		[498] = &TDispatchTo::fdivx,
-		[500] = &TDispatchTo::fsubx,
-		[501] = &TDispatchTo::faddx,
-		[502] = &TDispatchTo::fsqrtx,
-		[503] = &TDispatchTo::fselx,
-		[505] = &TDispatchTo::fmulx,
-		[506] = &TDispatchTo::frsqrtex,
-		[508] = &TDispatchTo::fmsubx,
-		[509] = &TDispatchTo::fmaddx,
-		[510] = &TDispatchTo::fnmsubx,
-		[511] = &TDispatchTo::fnmaddx,
-		[530] = &TDispatchTo::fdivx,
-		[532] = &TDispatchTo::fsubx,
-		[533] = &TDispatchTo::faddx,
-		[534] = &TDispatchTo::fsqrtx,
-		[535] = &TDispatchTo::fselx,
-		[537] = &TDispatchTo::fmulx,
-		[538] = &TDispatchTo::frsqrtex,
-		[540] = &TDispatchTo::fmsubx,
-		[541] = &TDispatchTo::fmaddx,
-		[542] = &TDispatchTo::fnmsubx,
-		[543] = &TDispatchTo::fnmaddx,
-		[562] = &TDispatchTo::fdivx,
-		[564] = &TDispatchTo::fsubx,
-		[565] = &TDispatchTo::faddx,
-		[566] = &TDispatchTo::fsqrtx,
-		[567] = &TDispatchTo::fselx,
-		[569] = &TDispatchTo::fmulx,
-		[570] = &TDispatchTo::frsqrtex,
-		[572] = &TDispatchTo::fmsubx,
-		[573] = &TDispatchTo::fmaddx,
-		[574] = &TDispatchTo::fnmsubx,
-		[575] = &TDispatchTo::fnmaddx,
-		[583] = &TDispatchTo::mffsx,
-		[594] = &TDispatchTo::fdivx,
-		[596] = &TDispatchTo::fsubx,
-		[597] = &TDispatchTo::faddx,
-		[598] = &TDispatchTo::fsqrtx,
-		[599] = &TDispatchTo::fselx,
-		[601] = &TDispatchTo::fmulx,
-		[602] = &TDispatchTo::frsqrtex,
-		[604] = &TDispatchTo::fmsubx,
-		[605] = &TDispatchTo::fmaddx,
-		[606] = &TDispatchTo::fnmsubx,
-		[607] = &TDispatchTo::fnmaddx,
-		[626] = &TDispatchTo::fdivx,
-		[628] = &TDispatchTo::fsubx,
-		[629] = &TDispatchTo::faddx,
-		[630] = &TDispatchTo::fsqrtx,
-		[631] = &TDispatchTo::fselx,
-		[633] = &TDispatchTo::fmulx,
-		[634] = &TDispatchTo::frsqrtex,
-		[636] = &TDispatchTo::fmsubx,
-		[637] = &TDispatchTo::fmaddx,
-		[638] = &TDispatchTo::fnmsubx,
-		[639] = &TDispatchTo::fnmaddx,
-		[658] = &TDispatchTo::fdivx,
-		[660] = &TDispatchTo::fsubx,
-		[661] = &TDispatchTo::faddx,
-		[662] = &TDispatchTo::fsqrtx,
-		[663] = &TDispatchTo::fselx,
-		[665] = &TDispatchTo::fmulx,
-		[666] = &TDispatchTo::frsqrtex,
-		[668] = &TDispatchTo::fmsubx,
-		[669] = &TDispatchTo::fmaddx,
-		[670] = &TDispatchTo::fnmsubx,
-		[671] = &TDispatchTo::fnmaddx,
-		[690] = &TDispatchTo::fdivx,
-		[692] = &TDispatchTo::fsubx,
-		[693] = &TDispatchTo::faddx,
-		[694] = &TDispatchTo::fsqrtx,
-		[695] = &TDispatchTo::fselx,
-		[697] = &TDispatchTo::fmulx,
-		[698] = &TDispatchTo::frsqrtex,
-		[700] = &TDispatchTo::fmsubx,
-		[701] = &TDispatchTo::fmaddx,
-		[702] = &TDispatchTo::fnmsubx,
-		[703] = &TDispatchTo::fnmaddx,
-		[711] = &TDispatchTo::mtfsfx,
-		[722] = &TDispatchTo::fdivx,
-		[724] = &TDispatchTo::fsubx,
-		[725] = &TDispatchTo::faddx,
-		[726] = &TDispatchTo::fsqrtx,
-		[727] = &TDispatchTo::fselx,
-		[729] = &TDispatchTo::fmulx,
-		[730] = &TDispatchTo::frsqrtex,
-		[732] = &TDispatchTo::fmsubx,
-		[733] = &TDispatchTo::fmaddx,
-		[734] = &TDispatchTo::fnmsubx,
-		[735] = &TDispatchTo::fnmaddx,
-		[754] = &TDispatchTo::fdivx,
-		[756] = &TDispatchTo::fsubx,
-		[757] = &TDispatchTo::faddx,
-		[758] = &TDispatchTo::fsqrtx,
-		[759] = &TDispatchTo::fselx,
-		[761] = &TDispatchTo::fmulx,
-		[762] = &TDispatchTo::frsqrtex,
-		[764] = &TDispatchTo::fmsubx,
-		[765] = &TDispatchTo::fmaddx,
-		[766] = &TDispatchTo::fnmsubx,
-		[767] = &TDispatchTo::fnmaddx,
-		[786] = &TDispatchTo::fdivx,
-		[788] = &TDispatchTo::fsubx,
-		[789] = &TDispatchTo::faddx,
-		[790] = &TDispatchTo::fsqrtx,
-		[791] = &TDispatchTo::fselx,
-		[793] = &TDispatchTo::fmulx,
-		[794] = &TDispatchTo::frsqrtex,
-		[796] = &TDispatchTo::fmsubx,
-		[797] = &TDispatchTo::fmaddx,
-		[798] = &TDispatchTo::fnmsubx,
-		[799] = &TDispatchTo::fnmaddx,
-		[818] = &TDispatchTo::fdivx,
-		[820] = &TDispatchTo::fsubx,
-		[821] = &TDispatchTo::faddx,
-		[822] = &TDispatchTo::fsqrtx,
-		[823] = &TDispatchTo::fselx,
-		[825] = &TDispatchTo::fmulx,
-		[826] = &TDispatchTo::frsqrtex,
-		[828] = &TDispatchTo::fmsubx,
-		[829] = &TDispatchTo::fmaddx,
-		[830] = &TDispatchTo::fnmsubx,
-		[831] = &TDispatchTo::fnmaddx,
-		[850] = &TDispatchTo::fdivx,
-		[852] = &TDispatchTo::fsubx,
-		[853] = &TDispatchTo::faddx,
-		[854] = &TDispatchTo::fsqrtx,
-		[855] = &TDispatchTo::fselx,
-		[857] = &TDispatchTo::fmulx,
-		[858] = &TDispatchTo::frsqrtex,
-		[860] = &TDispatchTo::fmsubx,
-		[861] = &TDispatchTo::fmaddx,
-		[862] = &TDispatchTo::fnmsubx,
-		[863] = &TDispatchTo::fnmaddx,
-		[882] = &TDispatchTo::fdivx,
-		[884] = &TDispatchTo::fsubx,
-		[885] = &TDispatchTo::faddx,
-		[886] = &TDispatchTo::fsqrtx,
-		[887] = &TDispatchTo::fselx,
-		[889] = &TDispatchTo::fmulx,
-		[890] = &TDispatchTo::frsqrtex,
-		[892] = &TDispatchTo::fmsubx,
-		[893] = &TDispatchTo::fmaddx,
-		[894] = &TDispatchTo::fnmsubx,
-		[895] = &TDispatchTo::fnmaddx,
-		[914] = &TDispatchTo::fdivx,
-		[916] = &TDispatchTo::fsubx,
-		[917] = &TDispatchTo::faddx,
-		[918] = &TDispatchTo::fsqrtx,
-		[919] = &TDispatchTo::fselx,
-		[921] = &TDispatchTo::fmulx,
-		[922] = &TDispatchTo::frsqrtex,
-		[924] = &TDispatchTo::fmsubx,
-		[925] = &TDispatchTo::fmaddx,
-		[926] = &TDispatchTo::fnmsubx,
-		[927] = &TDispatchTo::fnmaddx,
-		[946] = &TDispatchTo::fdivx,
-		[948] = &TDispatchTo::fsubx,
-		[949] = &TDispatchTo::faddx,
-		[950] = &TDispatchTo::fsqrtx,
-		[951] = &TDispatchTo::fselx,
-		[953] = &TDispatchTo::fmulx,
-		[954] = &TDispatchTo::frsqrtex,
-		[956] = &TDispatchTo::fmsubx,
-		[957] = &TDispatchTo::fmaddx,
-		[958] = &TDispatchTo::fnmsubx,
-		[959] = &TDispatchTo::fnmaddx,
-		[978] = &TDispatchTo::fdivx,
-		[980] = &TDispatchTo::fsubx,
-		[981] = &TDispatchTo::faddx,
-		[982] = &TDispatchTo::fsqrtx,
-		[983] = &TDispatchTo::fselx,
-		[985] = &TDispatchTo::fmulx,
-		[986] = &TDispatchTo::frsqrtex,
-		[988] = &TDispatchTo::fmsubx,
-		[989] = &TDispatchTo::fmaddx,
-		[990] = &TDispatchTo::fnmsubx,
-		[991] = &TDispatchTo::fnmaddx,
-		[1010] = &TDispatchTo::fdivx,
-		[1012] = &TDispatchTo::fsubx,
-		[1013] = &TDispatchTo::faddx,
-		[1014] = &TDispatchTo::fsqrtx,
-		[1015] = &TDispatchTo::fselx,
-		[1017] = &TDispatchTo::fmulx,
-		[1018] = &TDispatchTo::frsqrtex,
-		[1020] = &TDispatchTo::fmsubx,
-		[1021] = &TDispatchTo::fmaddx,
-		[1022] = &TDispatchTo::fnmsubx,
-		[1023] = &TDispatchTo::fnmaddx,
-	};
+		return {{
+			EXTENDED(0, cmp),
+			EXTENDED(4, tw),
+			EXTENDED(6, lvsl),
+			EXTENDED(7, lvebx),
+			EXTENDED_OE_RC(8, subfcx),
+			EXTENDED_OE_RC(10, addcx),
+			EXTENDED_RC(11, mulhwux),
+			EXTENDED(19, mfcr),
+			EXTENDED(20, lwarx),
+			EXTENDED(23, lwzx),
+			EXTENDED_RC(24, slwx),
+			EXTENDED_RC(26, cntlzwx),
+			EXTENDED_RC(28, andx),
+			EXTENDED(32, cmpl),
+			EXTENDED(38, lvsr),
+			EXTENDED(39, lvehx),
+			EXTENDED_OE_RC(40, subfx),
+			EXTENDED(54, dcbst),
+			EXTENDED(55, lwzux),
+			EXTENDED_RC(60, andcx),
+			EXTENDED(71, lvewx),
+			EXTENDED_RC(75, mulhwx),
+			EXTENDED(83, mfmsr),
+			EXTENDED(86, dcbf),
+			EXTENDED(87, lbzx),
+			EXTENDED(103, lvx),
+			EXTENDED_OE_RC(104, negx),
+			EXTENDED(119, lbzux),
+			EXTENDED_RC(124, norx),
+			EXTENDED(135, stvebx),
+			EXTENDED_OE_RC(136, subfex),
+			EXTENDED_OE_RC(138, addex),
+			EXTENDED(144, mtcrf),
+			EXTENDED(146, mtmsr),
+			EXTENDED(150, stwcxd),
+			EXTENDED(151, stwx),
+			EXTENDED(167, stvehx),
+			EXTENDED(183, stwux),
+			EXTENDED(199, stvewx),
+			EXTENDED_OE_RC(200, subfzex),
+			EXTENDED_OE_RC(202, addzex),
+			EXTENDED(210, mtsr),
+			EXTENDED(215, stbx),
+			EXTENDED(231, stvx),
+			EXTENDED_OE_RC(232, subfmex),
+			EXTENDED_OE_RC(234, addmex),
+			EXTENDED_OE_RC(235, mullwx),
+			EXTENDED(242, mtsrin),
+			EXTENDED(246, dcbtst),
+			EXTENDED(247, stbux),
+			EXTENDED_OE_RC(266, addx),
+			EXTENDED(278, dcbt),
+			EXTENDED(279, lhzx),
+			EXTENDED_RC(284, eqvx),
+			EXTENDED(306, tlbie),
+			EXTENDED(310, eciwx),
+			EXTENDED(311, lhzux),
+			EXTENDED_RC(316, xorx),
+			EXTENDED(339, mfspr),
+			EXTENDED(342, dst),
+			EXTENDED(343, lhax),
+			EXTENDED(359, lvxl),
+			EXTENDED(370, tlbia),
+			EXTENDED(371, mftb),
+			EXTENDED(374, dstst),
+			EXTENDED(375, lhaux),
+			EXTENDED(407, sthx),
+			EXTENDED_RC(412, orcx),
+			EXTENDED(438, ecowx),
+			EXTENDED(439, sthux),
+			EXTENDED_RC(444, orx),
+			EXTENDED_OE_RC(459, divwux),
+			EXTENDED(467, mtspr),
+			EXTENDED(470, dcbi),
+			EXTENDED_RC(476, nandx),
+			EXTENDED(487, stvxl),
+			EXTENDED_OE_RC(491, divwx),
+			EXTENDED(512, mcrxr),
+			EXTENDED(533, lswx),
+			EXTENDED(534, lwbrx),
+			EXTENDED(535, lfsx),
+			EXTENDED_RC(536, srwx),
+			EXTENDED(566, tlbsync),
+			EXTENDED(567, lfsux),
+			EXTENDED(595, mfsr),
+			EXTENDED(597, lswi),
+			EXTENDED(598, sync),
+			EXTENDED(599, lfdx),
+			EXTENDED(631, lfdux),
+			EXTENDED(659, mfsrin),
+			EXTENDED(661, stswx),
+			EXTENDED(662, stwbrx),
+			EXTENDED(663, stfsx),
+			EXTENDED(695, stfsux),
+			EXTENDED(725, stswi),
+			EXTENDED(727, stfdx),
+			EXTENDED(758, dcba),
+			EXTENDED(759, stfdux),
+			EXTENDED(790, lhbrx),
+			EXTENDED_RC(792, srawx),
+			EXTENDED(822, dss),
+			EXTENDED_RC(824, srawix),
+			EXTENDED(854, eieio),
+			EXTENDED(918, sthbrx),
+			EXTENDED_RC(922, extshx),
+			EXTENDED_RC(954, extsbx),
+			EXTENDED(982, icbi),
+			EXTENDED(983, stfiwx),
+			EXTENDED(1014, dcbz),
+		}};
+	}
+	
+	template<typename TDispatchTo>
+	const typename InstructionDispatcher<TDispatchTo>::template Table<2048> InstructionDispatcher<TDispatchTo>::table31 = Table31();
+	
+	template<typename TDispatchTo>
+	constexpr typename InstructionDispatcher<TDispatchTo>::template Table<64> InstructionDispatcher<TDispatchTo>::Table59()
+	{
+		return {{
+			EXTENDED_RC(18, fdivsx),
+			EXTENDED_RC(20, fsubsx),
+			EXTENDED_RC(21, faddsx),
+			EXTENDED_RC(22, fsqrtsx),
+			EXTENDED_RC(24, fresx),
+			EXTENDED_RC(25, fmulsx),
+			EXTENDED_RC(28, fmsubsx),
+			EXTENDED_RC(29, fmaddsx),
+			EXTENDED_RC(30, fnmsubsx),
+			EXTENDED_RC(31, fnmaddsx),
+		}};
+	}
+	
+	template<typename TDispatchTo>
+	const typename InstructionDispatcher<TDispatchTo>::template Table<64> InstructionDispatcher<TDispatchTo>::table59 = Table59();
+	
+	template<typename TDispatchTo>
+	constexpr typename InstructionDispatcher<TDispatchTo>::template Table<2048> InstructionDispatcher<TDispatchTo>::Table63()
+	{
+		return {{
+			EXTENDED(0, fcmpu),
+			EXTENDED_RC(12, frspx),
+			EXTENDED_RC(14, fctiwx),
+			EXTENDED_RC(15, fctiwzx),
+			EXTENDED_RC(18, fdivx),
+			EXTENDED_RC(20, fsubx),
+			EXTENDED_RC(21, faddx),
+			EXTENDED_RC(22, fsqrtx),
+			EXTENDED_RC(23, fselx),
+			EXTENDED_RC(25, fmulx),
+			EXTENDED_RC(26, frsqrtex),
+			EXTENDED_RC(28, fmsubx),
+			EXTENDED_RC(29, fmaddx),
+			EXTENDED_RC(30, fnmsubx),
+			EXTENDED_RC(31, fnmaddx),
+			EXTENDED(32, fcmpo),
+			EXTENDED_RC(38, mtfsb1x),
+			EXTENDED_RC(40, fnegx),
+			EXTENDED_RC(50, fdivx),
+			EXTENDED_RC(52, fsubx),
+			EXTENDED_RC(53, faddx),
+			EXTENDED_RC(54, fsqrtx),
+			EXTENDED_RC(55, fselx),
+			EXTENDED_RC(57, fmulx),
+			EXTENDED_RC(58, frsqrtex),
+			EXTENDED_RC(60, fmsubx),
+			EXTENDED_RC(61, fmaddx),
+			EXTENDED_RC(62, fnmsubx),
+			EXTENDED_RC(63, fnmaddx),
+			EXTENDED(64, mcrfs),
+			EXTENDED_RC(70, mtfsb0x),
+			EXTENDED_RC(72, fmrx),
+			EXTENDED_RC(82, fdivx),
+			EXTENDED_RC(84, fsubx),
+			EXTENDED_RC(85, faddx),
+			EXTENDED_RC(86, fsqrtx),
+			EXTENDED_RC(87, fselx),
+			EXTENDED_RC(89, fmulx),
+			EXTENDED_RC(90, frsqrtex),
+			EXTENDED_RC(92, fmsubx),
+			EXTENDED_RC(93, fmaddx),
+			EXTENDED_RC(94, fnmsubx),
+			EXTENDED_RC(95, fnmaddx),
+			EXTENDED_RC(114, fdivx),
+			EXTENDED_RC(116, fsubx),
+			EXTENDED_RC(117, faddx),
+			EXTENDED_RC(118, fsqrtx),
+			EXTENDED_RC(119, fselx),
+			EXTENDED_RC(121, fmulx),
+			EXTENDED_RC(122, frsqrtex),
+			EXTENDED_RC(124, fmsubx),
+			EXTENDED_RC(125, fmaddx),
+			EXTENDED_RC(126, fnmsubx),
+			EXTENDED_RC(127, fnmaddx),
+			EXTENDED_RC(134, mtfsfix),
+			EXTENDED_RC(136, fnabsx),
+			EXTENDED_RC(146, fdivx),
+			EXTENDED_RC(148, fsubx),
+			EXTENDED_RC(149, faddx),
+			EXTENDED_RC(150, fsqrtx),
+			EXTENDED_RC(151, fselx),
+			EXTENDED_RC(153, fmulx),
+			EXTENDED_RC(154, frsqrtex),
+			EXTENDED_RC(156, fmsubx),
+			EXTENDED_RC(157, fmaddx),
+			EXTENDED_RC(158, fnmsubx),
+			EXTENDED_RC(159, fnmaddx),
+			EXTENDED_RC(178, fdivx),
+			EXTENDED_RC(180, fsubx),
+			EXTENDED_RC(181, faddx),
+			EXTENDED_RC(182, fsqrtx),
+			EXTENDED_RC(183, fselx),
+			EXTENDED_RC(185, fmulx),
+			EXTENDED_RC(186, frsqrtex),
+			EXTENDED_RC(188, fmsubx),
+			EXTENDED_RC(189, fmaddx),
+			EXTENDED_RC(190, fnmsubx),
+			EXTENDED_RC(191, fnmaddx),
+			EXTENDED_RC(210, fdivx),
+			EXTENDED_RC(212, fsubx),
+			EXTENDED_RC(213, faddx),
+			EXTENDED_RC(214, fsqrtx),
+			EXTENDED_RC(215, fselx),
+			EXTENDED_RC(217, fmulx),
+			EXTENDED_RC(218, frsqrtex),
+			EXTENDED_RC(220, fmsubx),
+			EXTENDED_RC(221, fmaddx),
+			EXTENDED_RC(222, fnmsubx),
+			EXTENDED_RC(223, fnmaddx),
+			EXTENDED_RC(242, fdivx),
+			EXTENDED_RC(244, fsubx),
+			EXTENDED_RC(245, faddx),
+			EXTENDED_RC(246, fsqrtx),
+			EXTENDED_RC(247, fselx),
+			EXTENDED_RC(249, fmulx),
+			EXTENDED_RC(250, frsqrtex),
+			EXTENDED_RC(252, fmsubx),
+			EXTENDED_RC(253, fmaddx),
+			EXTENDED_RC(254, fnmsubx),
+			EXTENDED_RC(255, fnmaddx),
+			EXTENDED_RC(264, fabsx),
+			EXTENDED_RC(274, fdivx),
+			EXTENDED_RC(276, fsubx),
+			EXTENDED_RC(277, faddx),
+			EXTENDED_RC(278, fsqrtx),
+			EXTENDED_RC(279, fselx),
+			EXTENDED_RC(281, fmulx),
+			EXTENDED_RC(282, frsqrtex),
+			EXTENDED_RC(284, fmsubx),
+			EXTENDED_RC(285, fmaddx),
+			EXTENDED_RC(286, fnmsubx),
+			EXTENDED_RC(287, fnmaddx),
+			EXTENDED_RC(306, fdivx),
+			EXTENDED_RC(308, fsubx),
+			EXTENDED_RC(309, faddx),
+			EXTENDED_RC(310, fsqrtx),
+			EXTENDED_RC(311, fselx),
+			EXTENDED_RC(313, fmulx),
+			EXTENDED_RC(314, frsqrtex),
+			EXTENDED_RC(316, fmsubx),
+			EXTENDED_RC(317, fmaddx),
+			EXTENDED_RC(318, fnmsubx),
+			EXTENDED_RC(319, fnmaddx),
+			EXTENDED_RC(338, fdivx),
+			EXTENDED_RC(340, fsubx),
+			EXTENDED_RC(341, faddx),
+			EXTENDED_RC(342, fsqrtx),
+			EXTENDED_RC(343, fselx),
+			EXTENDED_RC(345, fmulx),
+			EXTENDED_RC(346, frsqrtex),
+			EXTENDED_RC(348, fmsubx),
+			EXTENDED_RC(349, fmaddx),
+			EXTENDED_RC(350, fnmsubx),
+			EXTENDED_RC(351, fnmaddx),
+			EXTENDED_RC(370, fdivx),
+			EXTENDED_RC(372, fsubx),
+			EXTENDED_RC(373, faddx),
+			EXTENDED_RC(374, fsqrtx),
+			EXTENDED_RC(375, fselx),
+			EXTENDED_RC(377, fmulx),
+			EXTENDED_RC(378, frsqrtex),
+			EXTENDED_RC(380, fmsubx),
+			EXTENDED_RC(381, fmaddx),
+			EXTENDED_RC(382, fnmsubx),
+			EXTENDED_RC(383, fnmaddx),
+			EXTENDED_RC(402, fdivx),
+			EXTENDED_RC(404, fsubx),
+			EXTENDED_RC(405, faddx),
+			EXTENDED_RC(406, fsqrtx),
+			EXTENDED_RC(407, fselx),
+			EXTENDED_RC(409, fmulx),
+			EXTENDED_RC(410, frsqrtex),
+			EXTENDED_RC(412, fmsubx),
+			EXTENDED_RC(413, fmaddx),
+			EXTENDED_RC(414, fnmsubx),
+			EXTENDED_RC(415, fnmaddx),
+			EXTENDED_RC(434, fdivx),
+			EXTENDED_RC(436, fsubx),
+			EXTENDED_RC(437, faddx),
+			EXTENDED_RC(438, fsqrtx),
+			EXTENDED_RC(439, fselx),
+			EXTENDED_RC(441, fmulx),
+			EXTENDED_RC(442, frsqrtex),
+			EXTENDED_RC(444, fmsubx),
+			EXTENDED_RC(445, fmaddx),
+			EXTENDED_RC(446, fnmsubx),
+			EXTENDED_RC(447, fnmaddx),
+			EXTENDED_RC(466, fdivx),
+			EXTENDED_RC(468, fsubx),
+			EXTENDED_RC(469, faddx),
+			EXTENDED_RC(470, fsqrtx),
+			EXTENDED_RC(471, fselx),
+			EXTENDED_RC(473, fmulx),
+			EXTENDED_RC(474, frsqrtex),
+			EXTENDED_RC(476, fmsubx),
+			EXTENDED_RC(477, fmaddx),
+			EXTENDED_RC(478, fnmsubx),
+			EXTENDED_RC(479, fnmaddx),
+			EXTENDED_RC(498, fdivx),
+			EXTENDED_RC(500, fsubx),
+			EXTENDED_RC(501, faddx),
+			EXTENDED_RC(502, fsqrtx),
+			EXTENDED_RC(503, fselx),
+			EXTENDED_RC(505, fmulx),
+			EXTENDED_RC(506, frsqrtex),
+			EXTENDED_RC(508, fmsubx),
+			EXTENDED_RC(509, fmaddx),
+			EXTENDED_RC(510, fnmsubx),
+			EXTENDED_RC(511, fnmaddx),
+			EXTENDED_RC(530, fdivx),
+			EXTENDED_RC(532, fsubx),
+			EXTENDED_RC(533, faddx),
+			EXTENDED_RC(534, fsqrtx),
+			EXTENDED_RC(535, fselx),
+			EXTENDED_RC(537, fmulx),
+			EXTENDED_RC(538, frsqrtex),
+			EXTENDED_RC(540, fmsubx),
+			EXTENDED_RC(541, fmaddx),
+			EXTENDED_RC(542, fnmsubx),
+			EXTENDED_RC(543, fnmaddx),
+			EXTENDED_RC(562, fdivx),
+			EXTENDED_RC(564, fsubx),
+			EXTENDED_RC(565, faddx),
+			EXTENDED_RC(566, fsqrtx),
+			EXTENDED_RC(567, fselx),
+			EXTENDED_RC(569, fmulx),
+			EXTENDED_RC(570, frsqrtex),
+			EXTENDED_RC(572, fmsubx),
+			EXTENDED_RC(573, fmaddx),
+			EXTENDED_RC(574, fnmsubx),
+			EXTENDED_RC(575, fnmaddx),
+			EXTENDED_RC(583, mffsx),
+			EXTENDED_RC(594, fdivx),
+			EXTENDED_RC(596, fsubx),
+			EXTENDED_RC(597, faddx),
+			EXTENDED_RC(598, fsqrtx),
+			EXTENDED_RC(599, fselx),
+			EXTENDED_RC(601, fmulx),
+			EXTENDED_RC(602, frsqrtex),
+			EXTENDED_RC(604, fmsubx),
+			EXTENDED_RC(605, fmaddx),
+			EXTENDED_RC(606, fnmsubx),
+			EXTENDED_RC(607, fnmaddx),
+			EXTENDED_RC(626, fdivx),
+			EXTENDED_RC(628, fsubx),
+			EXTENDED_RC(629, faddx),
+			EXTENDED_RC(630, fsqrtx),
+			EXTENDED_RC(631, fselx),
+			EXTENDED_RC(633, fmulx),
+			EXTENDED_RC(634, frsqrtex),
+			EXTENDED_RC(636, fmsubx),
+			EXTENDED_RC(637, fmaddx),
+			EXTENDED_RC(638, fnmsubx),
+			EXTENDED_RC(639, fnmaddx),
+			EXTENDED_RC(658, fdivx),
+			EXTENDED_RC(660, fsubx),
+			EXTENDED_RC(661, faddx),
+			EXTENDED_RC(662, fsqrtx),
+			EXTENDED_RC(663, fselx),
+			EXTENDED_RC(665, fmulx),
+			EXTENDED_RC(666, frsqrtex),
+			EXTENDED_RC(668, fmsubx),
+			EXTENDED_RC(669, fmaddx),
+			EXTENDED_RC(670, fnmsubx),
+			EXTENDED_RC(671, fnmaddx),
+			EXTENDED_RC(690, fdivx),
+			EXTENDED_RC(692, fsubx),
+			EXTENDED_RC(693, faddx),
+			EXTENDED_RC(694, fsqrtx),
+			EXTENDED_RC(695, fselx),
+			EXTENDED_RC(697, fmulx),
+			EXTENDED_RC(698, frsqrtex),
+			EXTENDED_RC(700, fmsubx),
+			EXTENDED_RC(701, fmaddx),
+			EXTENDED_RC(702, fnmsubx),
+			EXTENDED_RC(703, fnmaddx),
+			EXTENDED_RC(711, mtfsfx),
+			EXTENDED_RC(722, fdivx),
+			EXTENDED_RC(724, fsubx),
+			EXTENDED_RC(725, faddx),
+			EXTENDED_RC(726, fsqrtx),
+			EXTENDED_RC(727, fselx),
+			EXTENDED_RC(729, fmulx),
+			EXTENDED_RC(730, frsqrtex),
+			EXTENDED_RC(732, fmsubx),
+			EXTENDED_RC(733, fmaddx),
+			EXTENDED_RC(734, fnmsubx),
+			EXTENDED_RC(735, fnmaddx),
+			EXTENDED_RC(754, fdivx),
+			EXTENDED_RC(756, fsubx),
+			EXTENDED_RC(757, faddx),
+			EXTENDED_RC(758, fsqrtx),
+			EXTENDED_RC(759, fselx),
+			EXTENDED_RC(761, fmulx),
+			EXTENDED_RC(762, frsqrtex),
+			EXTENDED_RC(764, fmsubx),
+			EXTENDED_RC(765, fmaddx),
+			EXTENDED_RC(766, fnmsubx),
+			EXTENDED_RC(767, fnmaddx),
+			EXTENDED_RC(786, fdivx),
+			EXTENDED_RC(788, fsubx),
+			EXTENDED_RC(789, faddx),
+			EXTENDED_RC(790, fsqrtx),
+			EXTENDED_RC(791, fselx),
+			EXTENDED_RC(793, fmulx),
+			EXTENDED_RC(794, frsqrtex),
+			EXTENDED_RC(796, fmsubx),
+			EXTENDED_RC(797, fmaddx),
+			EXTENDED_RC(798, fnmsubx),
+			EXTENDED_RC(799, fnmaddx),
+			EXTENDED_RC(818, fdivx),
+			EXTENDED_RC(820, fsubx),
+			EXTENDED_RC(821, faddx),
+			EXTENDED_RC(822, fsqrtx),
+			EXTENDED_RC(823, fselx),
+			EXTENDED_RC(825, fmulx),
+			EXTENDED_RC(826, frsqrtex),
+			EXTENDED_RC(828, fmsubx),
+			EXTENDED_RC(829, fmaddx),
+			EXTENDED_RC(830, fnmsubx),
+			EXTENDED_RC(831, fnmaddx),
+			EXTENDED_RC(850, fdivx),
+			EXTENDED_RC(852, fsubx),
+			EXTENDED_RC(853, faddx),
+			EXTENDED_RC(854, fsqrtx),
+			EXTENDED_RC(855, fselx),
+			EXTENDED_RC(857, fmulx),
+			EXTENDED_RC(858, frsqrtex),
+			EXTENDED_RC(860, fmsubx),
+			EXTENDED_RC(861, fmaddx),
+			EXTENDED_RC(862, fnmsubx),
+			EXTENDED_RC(863, fnmaddx),
+			EXTENDED_RC(882, fdivx),
+			EXTENDED_RC(884, fsubx),
+			EXTENDED_RC(885, faddx),
+			EXTENDED_RC(886, fsqrtx),
+			EXTENDED_RC(887, fselx),
+			EXTENDED_RC(889, fmulx),
+			EXTENDED_RC(890, frsqrtex),
+			EXTENDED_RC(892, fmsubx),
+			EXTENDED_RC(893, fmaddx),
+			EXTENDED_RC(894, fnmsubx),
+			EXTENDED_RC(895, fnmaddx),
+			EXTENDED_RC(914, fdivx),
+			EXTENDED_RC(916, fsubx),
+			EXTENDED_RC(917, faddx),
+			EXTENDED_RC(918, fsqrtx),
+			EXTENDED_RC(919, fselx),
+			EXTENDED_RC(921, fmulx),
+			EXTENDED_RC(922, frsqrtex),
+			EXTENDED_RC(924, fmsubx),
+			EXTENDED_RC(925, fmaddx),
+			EXTENDED_RC(926, fnmsubx),
+			EXTENDED_RC(927, fnmaddx),
+			EXTENDED_RC(946, fdivx),
+			EXTENDED_RC(948, fsubx),
+			EXTENDED_RC(949, faddx),
+			EXTENDED_RC(950, fsqrtx),
+			EXTENDED_RC(951, fselx),
+			EXTENDED_RC(953, fmulx),
+			EXTENDED_RC(954, frsqrtex),
+			EXTENDED_RC(956, fmsubx),
+			EXTENDED_RC(957, fmaddx),
+			EXTENDED_RC(958, fnmsubx),
+			EXTENDED_RC(959, fnmaddx),
+			EXTENDED_RC(978, fdivx),
+			EXTENDED_RC(980, fsubx),
+			EXTENDED_RC(981, faddx),
+			EXTENDED_RC(982, fsqrtx),
+			EXTENDED_RC(983, fselx),
+			EXTENDED_RC(985, fmulx),
+			EXTENDED_RC(986, frsqrtex),
+			EXTENDED_RC(988, fmsubx),
+			EXTENDED_RC(989, fmaddx),
+			EXTENDED_RC(990, fnmsubx),
+			EXTENDED_RC(991, fnmaddx),
+			EXTENDED_RC(1010, fdivx),
+			EXTENDED_RC(1012, fsubx),
+			EXTENDED_RC(1013, faddx),
+			EXTENDED_RC(1014, fsqrtx),
+			EXTENDED_RC(1015, fselx),
+			EXTENDED_RC(1017, fmulx),
+			EXTENDED_RC(1018, frsqrtex),
+			EXTENDED_RC(1020, fmsubx),
+			EXTENDED_RC(1021, fmaddx),
+			EXTENDED_RC(1022, fnmsubx),
+			EXTENDED_RC(1023, fnmaddx),
+		}};
+	}
+	
+	template<typename TDispatchTo>
+	const typename InstructionDispatcher<TDispatchTo>::template Table<2048> InstructionDispatcher<TDispatchTo>::table63 = Table63();
+	
+#undef VARIANT
+#undef PRIMARY
+#undef PRIMARY_RC
+#undef PRIMARY_AA_LK
+#undef EXTENDED
+#undef EXTENDED_RC
+#undef EXTENDED_LK
+#undef EXTENDED_OE_RC
+#undef VECTOR_RC
 }
 
+// Dispatch targets that define their variant handlers away from where the tables are used instantiate them with these.
+#define INSTANTIATE_RC(T, x)	template void T::x<false>(PPCVM::Instruction); template void T::x<true>(PPCVM::Instruction)
+#define INSTANTIATE_LK(T, x)	INSTANTIATE_RC(T, x)
+#define INSTANTIATE_OE_RC(T, x)	template void T::x<false, false>(PPCVM::Instruction); template void T::x<false, true>(PPCVM::Instruction); \
+	template void T::x<true, false>(PPCVM::Instruction); template void T::x<true, true>(PPCVM::Instruction)
+#define INSTANTIATE_AA_LK(T, x)	INSTANTIATE_OE_RC(T, x)
+
 #endif
\ No newline at end of file
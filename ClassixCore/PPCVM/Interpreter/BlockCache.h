@@ -0,0 +1,175 @@
+//
+// BlockCache.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__BlockCache__
+#define __Classix__BlockCache__
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include "Instruction.h"
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		class Interpreter;
+		struct DecodedInstruction;
+
+		typedef void (Interpreter::*DecodedHandler)(const DecodedInstruction&);
+		typedef void (Interpreter::*InstructionHandler)(Instruction);
+
+		// An instruction that went through the dispatch tables once. When Handler is set, it's a specialized form
+		// that reads its operands from the pre-extracted fields instead of the instruction word. Otherwise, the
+		// instruction is executed by calling Method with Inst, just like the dispatcher would.
+		// MaterializesFlags is set on instructions that read CR or XER, or write them other than through LazyFlags.
+		struct DecodedInstruction
+		{
+			DecodedHandler Handler;
+			InstructionHandler Method;
+			Instruction Inst;
+			uint32_t Address;
+			uint8_t D;
+			uint8_t A;
+			uint8_t B;
+			int32_t Immediate;
+			uint32_t Mask;
+			bool MaterializesFlags;
+		};
+
+		// A basic block is a run of instructions that ends with a branch (or right before a native call).
+		struct DecodedBlock
+		{
+			uint32_t Address;
+			uint32_t Size;
+			std::vector<DecodedInstruction> Instructions;
+		};
+
+		// Blocks are keyed by guest address; TBlock needs an Address and a Size (in bytes). Invalidate() can be
+		// called from any thread: it only queues the range, and the owning thread applies it before it looks up
+		// its next block.
+		template<typename TBlock>
+		class BlockCache
+		{
+			std::unordered_map<uint32_t, TBlock> blocks;
+			
+			std::mutex pendingLock;
+			std::vector<std::pair<uint32_t, uint32_t>> pendingRanges;
+			std::atomic<bool> hasPendingRanges;
+			
+			void ApplyPendingInvalidations()
+			{
+				std::vector<std::pair<uint32_t, uint32_t>> ranges;
+				{
+					std::lock_guard<std::mutex> guard(pendingLock);
+					ranges.swap(pendingRanges);
+					hasPendingRanges.store(false, std::memory_order_release);
+				}
+				
+				for (const auto& range : ranges)
+					EraseRange(range.first, range.second);
+			}
+			
+			void EraseRange(uint32_t address, uint32_t size)
+			{
+				uint64_t end = static_cast<uint64_t>(address) + size;
+				
+				// small ranges (icbi, a written page) probe every address a block overlapping them could start at
+				uint64_t firstStart = address < (MaxBlockLength - 1) * 4 ? 0 : address - (MaxBlockLength - 1) * 4;
+				if ((end - firstStart) / 4 < blocks.size())
+				{
+					for (uint64_t start = firstStart & ~3ull; start < end; start += 4)
+					{
+						auto iter = blocks.find(static_cast<uint32_t>(start));
+						if (iter != blocks.end() && static_cast<uint64_t>(start) + iter->second.Size > address)
+							blocks.erase(iter);
+					}
+					return;
+				}
+				
+				for (auto iter = blocks.begin(); iter != blocks.end(); )
+				{
+					const TBlock& block = iter->second;
+					uint64_t blockEnd = static_cast<uint64_t>(block.Address) + block.Size;
+					if (block.Address < end && blockEnd > address)
+						iter = blocks.erase(iter);
+					else
+						iter++;
+				}
+			}
+			
+		public:
+			static const uint32_t MaxBlockLength = 256;
+			
+			BlockCache()
+			: hasPendingRanges(false)
+			{ }
+			
+			BlockCache(const BlockCache& that) = delete;
+			
+			inline const TBlock* Find(uint32_t address)
+			{
+				if (hasPendingRanges.load(std::memory_order_acquire))
+					ApplyPendingInvalidations();
+				
+				auto iter = blocks.find(address);
+				return iter == blocks.end() ? nullptr : &iter->second;
+			}
+			
+			const TBlock& Insert(TBlock&& block)
+			{
+				TBlock& slot = blocks[block.Address];
+				slot = std::move(block);
+				return slot;
+			}
+			
+			void Invalidate(uint32_t address, uint32_t size)
+			{
+				std::lock_guard<std::mutex> guard(pendingLock);
+				pendingRanges.emplace_back(address, size);
+				hasPendingRanges.store(true, std::memory_order_release);
+			}
+			
+			void Clear()
+			{
+				std::lock_guard<std::mutex> guard(pendingLock);
+				pendingRanges.clear();
+				pendingRanges.emplace_back(0, 0xffffffff);
+				hasPendingRanges.store(true, std::memory_order_release);
+			}
+			
+			// only safe from the owning thread
+			void EraseAll()
+			{
+				blocks.clear();
+			}
+			
+			size_t BlockCount() const
+			{
+				return blocks.size();
+			}
+		};
+	}
+}
+
+#endif /* defined(__Classix__BlockCache__) */
@@ -0,0 +1,148 @@
+//
+// ExecutionCounters.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include "ExecutionCounters.h"
+#include "InstructionDecoder.h"
+#include "NativeCall.h"
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+	using namespace PPCVM;
+	
+	struct SlotCount
+	{
+		std::string Slot;
+		uint32_t Encoding;
+		uint64_t Count;
+	};
+	
+	// Builds an instruction that lands in a dispatch slot, with arbitrary operands, to give the slot a mnemonic.
+	// The operands are picked so that branches always branch and CR operations don't collapse into crclr & co.
+	const uint32_t SampleOperands = (20 << 21) | (2 << 16) | (3 << 11);
+	
+	void AddSlots(std::vector<SlotCount>& into, const uint64_t* counts, size_t length, uint32_t opcode, const char* table, uint32_t (*encode)(uint32_t))
+	{
+		for (size_t i = 0; i < length; i++)
+		{
+			if (counts[i] == 0)
+				continue;
+			
+			std::stringstream ss;
+			ss << table << '/' << i;
+			SlotCount slot;
+			slot.Slot = ss.str();
+			slot.Encoding = (opcode << 26) | SampleOperands | encode(static_cast<uint32_t>(i));
+			slot.Count = counts[i];
+			into.push_back(slot);
+		}
+	}
+}
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		std::string ExecutionCounters::DefaultPath()
+		{
+			if (const char* path = getenv("CLASSIX_COUNTERS"))
+				return path;
+			return "";
+		}
+		
+		ExecutionCounters::ExecutionCounters()
+		{
+			memset(primaryTable, 0, sizeof primaryTable);
+			memset(table4, 0, sizeof table4);
+			memset(table4va, 0, sizeof table4va);
+			memset(table19, 0, sizeof table19);
+			memset(table31, 0, sizeof table31);
+			memset(table59, 0, sizeof table59);
+			memset(table63, 0, sizeof table63);
+		}
+		
+		void ExecutionCounters::WriteReport(std::ostream& into) const
+		{
+			std::vector<SlotCount> slots;
+			for (uint32_t i = 0; i < 64; i++)
+			{
+				if (primaryTable[i] == 0)
+					continue;
+				
+				SlotCount slot;
+				slot.Slot = std::to_string(i);
+				slot.Encoding = (i << 26) | SampleOperands;
+				slot.Count = primaryTable[i];
+				slots.push_back(slot);
+			}
+			
+			AddSlots(slots, table4, 2048, 4, "4", [](uint32_t i) { return i; });
+			AddSlots(slots, table4va, 64, 4, "4va", [](uint32_t i) { return (4u << 6) | i; });
+			AddSlots(slots, table19, 1024, 19, "19", [](uint32_t i) { return i << 1; });
+			AddSlots(slots, table31, 1024, 31, "31", [](uint32_t i) { return i << 1; });
+			AddSlots(slots, table59, 32, 59, "59", [](uint32_t i) { return (4u << 6) | (i << 1); });
+			AddSlots(slots, table63, 1024, 63, "63", [](uint32_t i) { return i << 1; });
+			
+			std::sort(slots.begin(), slots.end(), [](const SlotCount& a, const SlotCount& b) { return a.Count > b.Count; });
+			
+			uint64_t total = 0;
+			for (const SlotCount& slot : slots)
+				total += slot.Count;
+			
+			into << total << " instructions dispatched" << std::endl;
+			into << std::setw(14) << "count" << std::setw(8) << "%" << "  " << std::setw(8) << std::left << "slot" << "mnemonic" << std::right << std::endl;
+			into << std::fixed << std::setprecision(2);
+			for (const SlotCount& slot : slots)
+			{
+				Disassembly::DisassembledOpcode opcode = Disassembly::InstructionDecoder::Decode(Instruction(slot.Encoding));
+				into << std::setw(14) << slot.Count << std::setw(8) << slot.Count * 100.0 / total;
+				into << "  " << std::setw(8) << std::left << slot.Slot << opcode.Opcode << std::right << std::endl;
+			}
+			
+			std::vector<std::pair<const void*, NativeCounter>> natives(nativeCalls.begin(), nativeCalls.end());
+			std::sort(natives.begin(), natives.end(), [](const std::pair<const void*, NativeCounter>& a, const std::pair<const void*, NativeCounter>& b) {
+				return a.second.Time > b.second.Time;
+			});
+			
+			into << std::endl << natives.size() << " native functions called" << std::endl;
+			into << std::setw(14) << "calls" << std::setw(14) << "total ms" << std::setw(12) << "average us" << "  function" << std::endl;
+			for (const auto& pair : natives)
+			{
+				double micros = std::chrono::duration<double, std::micro>(pair.second.Time).count();
+				std::string name = NativeCallbackName(pair.first);
+				if (name.length() == 0)
+				{
+					std::stringstream ss;
+					ss << "native " << pair.first;
+					name = ss.str();
+				}
+				
+				into << std::setw(14) << pair.second.Calls << std::setw(14) << micros / 1000 << std::setw(12) << micros / pair.second.Calls;
+				into << "  " << name << std::endl;
+			}
+		}
+	}
+}
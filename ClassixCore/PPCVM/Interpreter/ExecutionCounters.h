@@ -0,0 +1,100 @@
+//
+// ExecutionCounters.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__ExecutionCounters__
+#define __Classix__ExecutionCounters__
+
+#include <cstdint>
+#include <string>
+#include <ostream>
+#include <chrono>
+#include <unordered_map>
+#include "Instruction.h"
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		// Counts how many times each slot of the dispatch tables runs, and how many times each native function is
+		// called and for how long. Only the interpreter thread touches the counters.
+		// Instructions that are never dispatched aren't counted: cached glue stubs and __ptr_glue count as their first
+		// lwz, and a loop idiom as the first instruction of its first iteration.
+		class ExecutionCounters
+		{
+		public:
+			typedef std::chrono::steady_clock Clock;
+			
+			struct NativeCounter
+			{
+				uint64_t Calls;
+				Clock::duration Time;
+			};
+			
+		private:
+			uint64_t primaryTable[64];
+			uint64_t table4[2048];
+			uint64_t table4va[64];
+			uint64_t table19[1024];
+			uint64_t table31[1024];
+			uint64_t table59[32];
+			uint64_t table63[1024];
+			std::unordered_map<const void*, NativeCounter> nativeCalls;
+			
+		public:
+			// $CLASSIX_COUNTERS, or an empty string when counting is off
+			static std::string DefaultPath();
+			
+			ExecutionCounters();
+			ExecutionCounters(const ExecutionCounters& that) = delete;
+			
+			// mirrors InstructionDispatcher::GetMethod, but counts all the variants of an instruction together
+			inline void CountInstruction(Instruction inst)
+			{
+				switch (inst.OPCD)
+				{
+					case 4:
+						if (inst.VAXO & 0x20)
+							table4va[inst.VAXO]++;
+						else
+							table4[inst.VXO]++;
+						break;
+					
+					case 19: table19[inst.SUBOP10]++; break;
+					case 31: table31[inst.SUBOP10]++; break;
+					case 59: table59[inst.SUBOP5]++; break;
+					case 63: table63[inst.SUBOP10]++; break;
+					default: primaryTable[inst.OPCD]++; break;
+				}
+			}
+			
+			inline void CountNativeCall(const void* callback, Clock::duration time)
+			{
+				NativeCounter& counter = nativeCalls[callback];
+				counter.Calls++;
+				counter.Time += time;
+			}
+			
+			void WriteReport(std::ostream& into) const;
+		};
+	}
+}
+
+#endif /* defined(__Classix__ExecutionCounters__) */
@@ -0,0 +1,157 @@
+//
+// ExecutionTrace.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include "ExecutionTrace.h"
+#include "NativeCall.h"
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <chrono>
+#include <stdexcept>
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		std::string ExecutionTrace::DefaultPath()
+		{
+			if (const char* path = getenv("CLASSIX_TRACE"))
+				return path;
+			return "";
+		}
+		
+		ExecutionTrace::Ring::Ring(ExecutionTrace& trace, uint32_t id)
+		: trace(trace), id(id), buffer(new TraceRecord[Capacity]), head(0), tail(0)
+		{ }
+		
+		void ExecutionTrace::Ring::WaitForRoom()
+		{
+			trace.writerWakeUp.notify_one();
+			while (head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire) == Capacity)
+				std::this_thread::yield();
+		}
+		
+		ExecutionTrace::ExecutionTrace(const std::string& path)
+		: lastWrittenRing(UINT32_MAX), stopping(false)
+		{
+			output = fopen(path.c_str(), "wb");
+			if (output == nullptr)
+				throw std::logic_error(strerror(errno));
+			
+			writer = std::thread(&ExecutionTrace::WriteLoop, this);
+		}
+		
+		ExecutionTrace::~ExecutionTrace()
+		{
+			{
+				std::lock_guard<std::mutex> guard(writerLock);
+				stopping = true;
+			}
+			writerWakeUp.notify_one();
+			writer.join();
+			fclose(output);
+		}
+		
+		ExecutionTrace::Ring* ExecutionTrace::CreateRing()
+		{
+			std::lock_guard<std::mutex> guard(ringsLock);
+			rings.emplace_back(new Ring(*this, static_cast<uint32_t>(rings.size())));
+			return rings.back().get();
+		}
+		
+		void ExecutionTrace::WriteLoop()
+		{
+			std::unique_lock<std::mutex> guard(writerLock);
+			while (true)
+			{
+				bool stop = stopping;
+				guard.unlock();
+				Flush();
+				guard.lock();
+				
+				if (stop)
+					break;
+				writerWakeUp.wait_for(guard, std::chrono::milliseconds(10));
+			}
+		}
+		
+		void ExecutionTrace::Flush()
+		{
+			std::lock_guard<std::mutex> guard(ringsLock);
+			for (auto& ring : rings)
+				Flush(*ring);
+		}
+		
+		void ExecutionTrace::Flush(Ring& ring)
+		{
+			size_t position = ring.tail.load(std::memory_order_relaxed);
+			size_t end = ring.head.load(std::memory_order_acquire);
+			if (position == end)
+				return;
+			
+			std::vector<TraceRecord> records;
+			records.reserve(end - position + 1);
+			if (ring.id != lastWrittenRing)
+			{
+				TraceRecord thread;
+				thread.Kind = TraceRecord::Thread;
+				thread.Address = ring.id;
+				thread.Value = 0;
+				records.push_back(thread);
+				lastWrittenRing = ring.id;
+			}
+			
+			for (; position != end; position++)
+			{
+				const TraceRecord& record = ring.buffer[position & (Ring::Capacity - 1)];
+				if (record.Kind == TraceRecord::NativeCall && namedCallbacks.count(record.Value) == 0)
+				{
+					fwrite(records.data(), sizeof(TraceRecord), records.size(), output);
+					records.clear();
+					WriteSymbol(record.Value);
+				}
+				records.push_back(record);
+			}
+			
+			// the records are copied out, so the interpreter can have the space back before the write finishes
+			ring.tail.store(end, std::memory_order_release);
+			fwrite(records.data(), sizeof(TraceRecord), records.size(), output);
+			fflush(output);
+		}
+		
+		void ExecutionTrace::WriteSymbol(uint64_t callback)
+		{
+			std::string name = NativeCallbackName(reinterpret_cast<const void*>(callback));
+			namedCallbacks.insert(callback);
+			
+			TraceRecord symbol;
+			symbol.Kind = TraceRecord::Symbol;
+			symbol.Address = static_cast<uint32_t>(name.length());
+			symbol.Value = callback;
+			
+			size_t padded = (name.length() + sizeof symbol - 1) / sizeof symbol * sizeof symbol;
+			name.resize(padded, '\0');
+			fwrite(&symbol, sizeof symbol, 1, output);
+			fwrite(name.data(), 1, name.length(), output);
+		}
+	}
+}
@@ -0,0 +1,140 @@
+//
+// ExecutionTrace.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__ExecutionTrace__
+#define __Classix__ExecutionTrace__
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_set>
+#include <vector>
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		// Trace files are a sequence of these, in host byte order. A Symbol record names the native callback in
+		// its Value, and is followed by Address bytes of name, padded to a multiple of sizeof(TraceRecord). It is
+		// written before the first NativeCall record that uses that callback. A Thread record says that the records
+		// after it, up to the next Thread record, come from the interpreter whose ring has the id in its Address.
+		struct TraceRecord
+		{
+			enum RecordKind : uint32_t
+			{
+				Instruction,
+				NativeCall,
+				Symbol,
+				Thread,
+			};
+			
+			uint32_t Kind;
+			uint32_t Address;
+			uint64_t Value;
+		};
+		
+		// Records what interpreters execute into ring buffers that a background thread writes to disk. Each
+		// interpreter gets its own ring with CreateRing(), so interpreters on different threads never share one; a
+		// ring has a single producer, the thread running its interpreter, and a single consumer, the writer thread.
+		// The interpreter thread only copies records into its ring; everything slow (file I/O, looking up native
+		// symbols) happens on the writer thread. If the writer falls behind, the interpreter waits for it rather
+		// than losing records.
+		class ExecutionTrace
+		{
+		public:
+			class Ring
+			{
+				friend class ExecutionTrace;
+				static const size_t Capacity = 1 << 16;
+				
+				ExecutionTrace& trace;
+				uint32_t id;
+				std::unique_ptr<TraceRecord[]> buffer;
+				std::atomic<size_t> head;
+				std::atomic<size_t> tail;
+				
+				Ring(ExecutionTrace& trace, uint32_t id);
+				void WaitForRoom();
+				
+				inline void Append(uint32_t kind, uint32_t address, uint64_t value)
+				{
+					size_t position = head.load(std::memory_order_relaxed);
+					if (position - tail.load(std::memory_order_acquire) == Capacity)
+						WaitForRoom();
+					
+					TraceRecord& record = buffer[position & (Capacity - 1)];
+					record.Kind = kind;
+					record.Address = address;
+					record.Value = value;
+					head.store(position + 1, std::memory_order_release);
+				}
+				
+			public:
+				Ring(const Ring& that) = delete;
+				
+				inline void RecordInstruction(uint32_t address, uint32_t instruction)
+				{
+					Append(TraceRecord::Instruction, address, instruction);
+				}
+				
+				inline void RecordNativeCall(uint32_t address, const void* callback)
+				{
+					Append(TraceRecord::NativeCall, address, reinterpret_cast<uintptr_t>(callback));
+				}
+			};
+			
+		private:
+			std::mutex ringsLock;
+			std::vector<std::unique_ptr<Ring>> rings;
+			
+			FILE* output;
+			std::unordered_set<uint64_t> namedCallbacks;
+			uint32_t lastWrittenRing;
+			std::mutex writerLock;
+			std::condition_variable writerWakeUp;
+			bool stopping;
+			std::thread writer;
+			
+			void WriteLoop();
+			void Flush();
+			void Flush(Ring& ring);
+			void WriteSymbol(uint64_t callback);
+			
+		public:
+			// $CLASSIX_TRACE, or an empty string when tracing is off
+			static std::string DefaultPath();
+			
+			explicit ExecutionTrace(const std::string& path);
+			ExecutionTrace(const ExecutionTrace& that) = delete;
+			~ExecutionTrace();
+			
+			// Rings live as long as the trace. Can be called from any thread, even while other rings are in use.
+			Ring* CreateRing();
+		};
+	}
+}
+
+#endif /* defined(__Classix__ExecutionTrace__) */
@@ -19,176 +19,506 @@
 // Classix. If not, see http://www.gnu.org/licenses/.
 //
 
+#include <cmath>
+#include <cstring>
+#include <cstdint>
 #include "Interpreter.h"
 #include "FloatingPointStatus.h"
 #include "TrapException.h"
 #include "InvalidInstructionException.h"
-#include "Todo.h"
 
-// a macro conveys best the ugliness of the kludge
-#define PRAY_NO_FLAGS_NO_EXCEPTIONS() \
-	do { if (inst.Rc) Panic("FPU flags and exceptions are not implemented"); } while(0)
+// Arithmetic is done with the host's double-precision operations, which have the same IEEE semantics as the
+// PowerPC ones. Single-precision instructions take double operands too, and round the result to single precision.
+// The FPSCR is mostly updated lazily (see LazyFlags.h); the code below only deals with invalid operations, which
+// are detected by checking for a NaN result, so that the common case is a single host operation and a compare.
+// FR and FI are not tracked.
 
-// I would like to state that single-precision instructions, as I understand them,
-// are very silly
+namespace
+{
+	using namespace PPCVM;
+	
+	const uint64_t QuietBit = 0x0008000000000000ull;
+	const uint64_t DefaultNaN = 0x7ff8000000000000ull;
+	
+	inline uint32_t Bit(FloatingPointStatus status)
+	{
+		return static_cast<uint32_t>(status);
+	}
+	
+	inline uint64_t ToBits(double value)
+	{
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof bits);
+		return bits;
+	}
+	
+	inline double FromBits(uint64_t bits)
+	{
+		double value;
+		memcpy(&value, &bits, sizeof value);
+		return value;
+	}
+	
+	inline bool IsSignalingNaN(double value)
+	{
+		return std::isnan(value) && (ToBits(value) & QuietBit) == 0;
+	}
+	
+	inline uint32_t SignalingBits(double a, double b, double c = 0)
+	{
+		return IsSignalingNaN(a) || IsSignalingNaN(b) || IsSignalingNaN(c) ? Bit(FloatingPointStatus::VXSNAN) : 0;
+	}
+	
+	// When an operand is a NaN, the PowerPC returns the first one of frA, frB and frC (quieted); the host might
+	// pick another one. Invalid operations on non-NaN operands return the default NaN, which is positive on the
+	// PowerPC but negative on x86.
+	double PropagateNaN(double a, double b, double c)
+	{
+		for (double operand : {a, b, c})
+		{
+			if (std::isnan(operand))
+				return FromBits(ToBits(operand) | QuietBit);
+		}
+		return FromBits(DefaultNaN);
+	}
+	
+	uint32_t InvalidAdd(double a, double b)
+	{
+		if (std::isinf(a) && std::isinf(b) && std::signbit(a) != std::signbit(b))
+			return Bit(FloatingPointStatus::VXISI);
+		return SignalingBits(a, b);
+	}
+	
+	uint32_t InvalidMultiply(double a, double c)
+	{
+		if ((std::isinf(a) && c == 0) || (a == 0 && std::isinf(c)))
+			return Bit(FloatingPointStatus::VXIMZ);
+		return SignalingBits(a, c);
+	}
+	
+	uint32_t InvalidDivide(double a, double b)
+	{
+		if (std::isinf(a) && std::isinf(b))
+			return Bit(FloatingPointStatus::VXIDI);
+		if (a == 0 && b == 0)
+			return Bit(FloatingPointStatus::VXZDZ);
+		return SignalingBits(a, b);
+	}
+	
+	uint32_t InvalidMultiplyAdd(double a, double c, double b)
+	{
+		// b is already negated for the subtracting forms
+		if (uint32_t product = InvalidMultiply(a, c))
+			return product | SignalingBits(a, b, c);
+		
+		if (!std::isnan(a) && !std::isnan(c) && (std::isinf(a) || std::isinf(c)) && std::isinf(b))
+		{
+			bool productSign = std::signbit(a) != std::signbit(c);
+			if (productSign != std::signbit(b))
+				return Bit(FloatingPointStatus::VXISI) | SignalingBits(a, b, c);
+		}
+		return SignalingBits(a, b, c);
+	}
+	
+	uint32_t InvalidSquareRoot(double b)
+	{
+		if (!std::isnan(b) && b < 0)
+			return Bit(FloatingPointStatus::VXSQRT);
+		return SignalingBits(b, 0);
+	}
+	
+	inline double RoundToSingle(double value)
+	{
+		return static_cast<float>(value);
+	}
+}
 
 namespace PPCVM
 {
 	namespace Execution
 	{
+		template<bool Rc>
+		inline void Interpreter::SetFloatingPointResult(Instruction inst, double result, bool single)
+		{
+			state.fpr[inst.FD] = result;
+			flags.SetFPRF(result, single);
+			if (Rc)
+				UpdateCR1();
+		}
+		
+		template<bool Rc>
+		void Interpreter::SetInvalidResult(Instruction inst, double result, uint32_t exceptions, bool single)
+		{
+			LazyFlags::RaiseFloatingPointExceptions(state, exceptions);
+			SetFloatingPointResult<Rc>(inst, single ? RoundToSingle(result) : result, single);
+		}
+		
+		void Interpreter::UpdateCR1()
+		{
+			flags.MaterializeFloatingPoint(state);
+			state.cr[1] = state.fpscr.hex >> 28;
+		}
+		
+		template<bool Rc>
 		void Interpreter::fabsx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			state.fpr[inst.FD] = std::fabs(state.fpr[inst.FB]);
+			if (Rc) UpdateCR1();
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::faddsx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			double a = state.fpr[inst.FA];
+			double b = state.fpr[inst.FB];
+			double result = a + b;
+			if (std::isnan(result))
+				return SetInvalidResult<Rc>(inst, PropagateNaN(a, b, 0), InvalidAdd(a, b), true);
+			SetFloatingPointResult<Rc>(inst, RoundToSingle(result), true);
 		}
 		
+		template<bool Rc>
 		void Interpreter::faddx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			double a = state.fpr[inst.FA];
+			double b = state.fpr[inst.FB];
+			double result = a + b;
+			if (std::isnan(result))
+				return SetInvalidResult<Rc>(inst, PropagateNaN(a, b, 0), InvalidAdd(a, b), false);
+			SetFloatingPointResult<Rc>(inst, result, false);
 		}
 		
 		void Interpreter::fcmpo(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			double a = state.fpr[inst.FA];
+			double b = state.fpr[inst.FB];
+			uint32_t exceptions = 0;
+			if (std::isnan(a) || std::isnan(b))
+			{
+				exceptions = SignalingBits(a, b);
+				// an enabled invalid operation exception on a signaling NaN takes precedence over VXVC
+				if (exceptions == 0 || !state.fpscr.VE)
+					exceptions |= Bit(FloatingPointStatus::VXVC);
+			}
+			Compare(inst, a, b, exceptions);
 		}
 		
 		void Interpreter::fcmpu(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			double a = state.fpr[inst.FA];
+			double b = state.fpr[inst.FB];
+			Compare(inst, a, b, SignalingBits(a, b));
 		}
 		
+		void Interpreter::Compare(Instruction inst, double a, double b, uint32_t exceptions)
+		{
+			uint8_t result;
+			if (a < b) result = 0b1000;
+			else if (a > b) result = 0b0100;
+			else if (a == b) result = 0b0010;
+			else result = 0b0001;
+			
+			// the comparison replaces FPCC, so it can't be overwritten by the FPRF of an earlier instruction
+			flags.MaterializeFloatingPoint(state);
+			state.fpscr.FPRF = (state.fpscr.FPRF & 0x10) | result;
+			state.cr[inst.CRFD] = result;
+			if (exceptions != 0)
+				LazyFlags::RaiseFloatingPointExceptions(state, exceptions);
+		}
+		
+		template<bool Rc>
+		void Interpreter::ConvertToInteger(Instruction inst, bool truncate)
+		{
+			double b = state.fpr[inst.FB];
+			int32_t value;
+			uint32_t exceptions = 0;
+			if (std::isnan(b))
+			{
+				value = INT32_MIN;
+				exceptions = Bit(FloatingPointStatus::VXCVI) | SignalingBits(b, 0);
+			}
+			else
+			{
+				// nearbyint rounds with the current rounding mode, which follows FPSCR[RN]
+				double rounded = truncate ? std::trunc(b) : std::nearbyint(b);
+				if (rounded > INT32_MAX)
+				{
+					value = INT32_MAX;
+					exceptions = Bit(FloatingPointStatus::VXCVI);
+				}
+				else if (rounded < INT32_MIN)
+				{
+					value = INT32_MIN;
+					exceptions = Bit(FloatingPointStatus::VXCVI);
+				}
+				else
+				{
+					value = static_cast<int32_t>(rounded);
+					if (rounded != b)
+						exceptions = Bit(FloatingPointStatus::XX);
+				}
+			}
+			
+			// the integer goes in the low word; the high word is undefined, but this is what the 750 puts there
+			state.fpr[inst.FD] = FromBits(0xfff8000000000000ull | static_cast<uint32_t>(value));
+			if (exceptions != 0)
+				LazyFlags::RaiseFloatingPointExceptions(state, exceptions);
+			if (Rc) UpdateCR1();
+		}
+		
+		template<bool Rc>
 		void Interpreter::fctiwx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			ConvertToInteger<Rc>(inst, false);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fctiwzx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			ConvertToInteger<Rc>(inst, true);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fdivsx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			double a = state.fpr[inst.FA];
+			double b = state.fpr[inst.FB];
+			double result = a / b;
+			if (std::isnan(result))
+				return SetInvalidResult<Rc>(inst, PropagateNaN(a, b, 0), InvalidDivide(a, b), true);
+			SetFloatingPointResult<Rc>(inst, RoundToSingle(result), true);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fdivx(Instruction inst)
 		{
-			state.fpr[inst.FS] = state.fpr[inst.FA] / state.fpr[inst.FB];
-			PRAY_NO_FLAGS_NO_EXCEPTIONS();
+			double a = state.fpr[inst.FA];
+			double b = state.fpr[inst.FB];
+			double result = a / b;
+			if (std::isnan(result))
+				return SetInvalidResult<Rc>(inst, PropagateNaN(a, b, 0), InvalidDivide(a, b), false);
+			SetFloatingPointResult<Rc>(inst, result, false);
 		}
 		
+		template<bool Rc>
+		void Interpreter::MultiplyAdd(Instruction inst, bool subtract, bool negate, bool single)
+		{
+			// std::fma is a single instruction on hosts with FMA, and a correctly rounded library call elsewhere.
+			// The single-precision forms round twice, which is off by one ulp in extremely rare cases.
+			double a = state.fpr[inst.FA];
+			double b = state.fpr[inst.FB];
+			double c = state.fpr[inst.FC];
+			double addend = subtract ? -b : b;
+			double result = std::fma(a, c, addend);
+			if (std::isnan(result))
+				return SetInvalidResult<Rc>(inst, PropagateNaN(a, b, c), InvalidMultiplyAdd(a, c, addend), single);
+			
+			if (single)
+				result = RoundToSingle(result);
+			SetFloatingPointResult<Rc>(inst, negate ? -result : result, single);
+		}
+		
+		template<bool Rc>
 		void Interpreter::fmaddsx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			MultiplyAdd<Rc>(inst, false, false, true);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fmaddx(Instruction inst)
 		{
-			state.fpr[inst.FS] = state.fpr[inst.FA] * state.fpr[inst.FC] + state.fpr[inst.FB];
-			PRAY_NO_FLAGS_NO_EXCEPTIONS();
+			MultiplyAdd<Rc>(inst, false, false, false);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fmrx(Instruction inst)
 		{
-			state.fpr[inst.FS] = state.fpr[inst.FB];
-			PRAY_NO_FLAGS_NO_EXCEPTIONS();
+			state.fpr[inst.FD] = state.fpr[inst.FB];
+			if (Rc) UpdateCR1();
 		}
 		
+		template<bool Rc>
 		void Interpreter::fmsubsx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			MultiplyAdd<Rc>(inst, true, false, true);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fmsubx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			MultiplyAdd<Rc>(inst, true, false, false);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fmulsx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			double a = state.fpr[inst.FA];
+			double c = state.fpr[inst.FC];
+			double result = a * c;
+			if (std::isnan(result))
+				return SetInvalidResult<Rc>(inst, PropagateNaN(a, 0, c), InvalidMultiply(a, c), true);
+			SetFloatingPointResult<Rc>(inst, RoundToSingle(result), true);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fmulx(Instruction inst)
 		{
-			state.fpr[inst.FS] = state.fpr[inst.FA] * state.fpr[inst.FC];
-			PRAY_NO_FLAGS_NO_EXCEPTIONS();
+			double a = state.fpr[inst.FA];
+			double c = state.fpr[inst.FC];
+			double result = a * c;
+			if (std::isnan(result))
+				return SetInvalidResult<Rc>(inst, PropagateNaN(a, 0, c), InvalidMultiply(a, c), false);
+			SetFloatingPointResult<Rc>(inst, result, false);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fnabsx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			state.fpr[inst.FD] = -std::fabs(state.fpr[inst.FB]);
+			if (Rc) UpdateCR1();
 		}
 		
+		template<bool Rc>
 		void Interpreter::fnegx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			state.fpr[inst.FD] = -state.fpr[inst.FB];
+			if (Rc) UpdateCR1();
 		}
 		
+		template<bool Rc>
 		void Interpreter::fnmaddsx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			MultiplyAdd<Rc>(inst, false, true, true);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fnmaddx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			MultiplyAdd<Rc>(inst, false, true, false);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fnmsubsx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			MultiplyAdd<Rc>(inst, true, true, true);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fnmsubx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			MultiplyAdd<Rc>(inst, true, true, false);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fresx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			// the estimate only has to be within 1/4096 of the reciprocal; the exact value is good enough
+			double b = state.fpr[inst.FB];
+			double result = 1.0 / b;
+			if (std::isnan(result))
+				return SetInvalidResult<Rc>(inst, PropagateNaN(0, b, 0), SignalingBits(b, 0), true);
+			SetFloatingPointResult<Rc>(inst, RoundToSingle(result), true);
 		}
 		
+		template<bool Rc>
 		void Interpreter::frspx(Instruction inst)
 		{
-			TODO("frsp should round with the correct rounding mode");
-			float single = static_cast<float>(state.fpr[inst.FB]);
-			state.fpr[inst.FS] = single;
-			PRAY_NO_FLAGS_NO_EXCEPTIONS();
+			// the conversion uses the host rounding mode, which follows FPSCR[RN]
+			double b = state.fpr[inst.FB];
+			if (std::isnan(b))
+				return SetInvalidResult<Rc>(inst, PropagateNaN(0, b, 0), SignalingBits(b, 0), true);
+			SetFloatingPointResult<Rc>(inst, RoundToSingle(b), true);
 		}
 		
+		template<bool Rc>
 		void Interpreter::frsqrtex(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			double b = state.fpr[inst.FB];
+			double result = 1.0 / std::sqrt(b);
+			if (std::isnan(result))
+				return SetInvalidResult<Rc>(inst, PropagateNaN(0, b, 0), InvalidSquareRoot(b), false);
+			SetFloatingPointResult<Rc>(inst, result, false);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fselx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			double a = state.fpr[inst.FA];
+			state.fpr[inst.FD] = a >= 0.0 ? state.fpr[inst.FC] : state.fpr[inst.FB];
+			if (Rc) UpdateCR1();
+		}
+		
+		template<bool Rc>
+		void Interpreter::fsqrtsx(Instruction inst)
+		{
+			double b = state.fpr[inst.FB];
+			double result = std::sqrt(b);
+			if (std::isnan(result))
+				return SetInvalidResult<Rc>(inst, PropagateNaN(0, b, 0), InvalidSquareRoot(b), true);
+			SetFloatingPointResult<Rc>(inst, RoundToSingle(result), true);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fsqrtx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			double b = state.fpr[inst.FB];
+			double result = std::sqrt(b);
+			if (std::isnan(result))
+				return SetInvalidResult<Rc>(inst, PropagateNaN(0, b, 0), InvalidSquareRoot(b), false);
+			SetFloatingPointResult<Rc>(inst, result, false);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fsubsx(Instruction inst)
 		{
-			float result = static_cast<float>(state.fpr[inst.FA]) - static_cast<float>(state.fpr[inst.FB]);
-			state.fpr[inst.FS] = result;
-			PRAY_NO_FLAGS_NO_EXCEPTIONS();
+			double a = state.fpr[inst.FA];
+			double b = state.fpr[inst.FB];
+			double result = a - b;
+			if (std::isnan(result))
+				return SetInvalidResult<Rc>(inst, PropagateNaN(a, b, 0), InvalidAdd(a, -b), true);
+			SetFloatingPointResult<Rc>(inst, RoundToSingle(result), true);
 		}
 		
+		template<bool Rc>
 		void Interpreter::fsubx(Instruction inst)
 		{
-			state.fpr[inst.FS] = state.fpr[inst.FA] - state.fpr[inst.FB];
-			PRAY_NO_FLAGS_NO_EXCEPTIONS();
+			double a = state.fpr[inst.FA];
+			double b = state.fpr[inst.FB];
+			double result = a - b;
+			if (std::isnan(result))
+				return SetInvalidResult<Rc>(inst, PropagateNaN(a, b, 0), InvalidAdd(a, -b), false);
+			SetFloatingPointResult<Rc>(inst, result, false);
 		}
+		
+#pragma mark -
+#pragma mark Variants
+		INSTANTIATE_RC(Interpreter, fabsx);
+		INSTANTIATE_RC(Interpreter, faddsx);
+		INSTANTIATE_RC(Interpreter, faddx);
+		INSTANTIATE_RC(Interpreter, fctiwx);
+		INSTANTIATE_RC(Interpreter, fctiwzx);
+		INSTANTIATE_RC(Interpreter, fdivsx);
+		INSTANTIATE_RC(Interpreter, fdivx);
+		INSTANTIATE_RC(Interpreter, fmaddsx);
+		INSTANTIATE_RC(Interpreter, fmaddx);
+		INSTANTIATE_RC(Interpreter, fmrx);
+		INSTANTIATE_RC(Interpreter, fmsubsx);
+		INSTANTIATE_RC(Interpreter, fmsubx);
+		INSTANTIATE_RC(Interpreter, fmulsx);
+		INSTANTIATE_RC(Interpreter, fmulx);
+		INSTANTIATE_RC(Interpreter, fnabsx);
+		INSTANTIATE_RC(Interpreter, fnegx);
+		INSTANTIATE_RC(Interpreter, fnmaddsx);
+		INSTANTIATE_RC(Interpreter, fnmaddx);
+		INSTANTIATE_RC(Interpreter, fnmsubsx);
+		INSTANTIATE_RC(Interpreter, fnmsubx);
+		INSTANTIATE_RC(Interpreter, fresx);
+		INSTANTIATE_RC(Interpreter, frspx);
+		INSTANTIATE_RC(Interpreter, frsqrtex);
+		INSTANTIATE_RC(Interpreter, fselx);
+		INSTANTIATE_RC(Interpreter, fsqrtsx);
+		INSTANTIATE_RC(Interpreter, fsqrtx);
+		INSTANTIATE_RC(Interpreter, fsubsx);
+		INSTANTIATE_RC(Interpreter, fsubx);
 	}
 }
@@ -66,27 +66,11 @@ namespace
 		state.cr[x] = result;
 	}
 	
-	inline void UpdateCR0(MachineState& state, uint32_t value)
-	{
-		UpdateCRx(state, 0, value);
-	}
-	
 	inline bool Carry(uint32_t a, uint32_t b)
 	{
 		return b > ~a;
 	}
 	
-	inline uint32_t Mask(uint32_t mStart, uint32_t mStop)
-	{
-		uint32_t begin = 0xFFFFFFFF >> mStart;
-		// this is *probably* not necessary, since mStop is always encoded on 5 bits it cannot be greater than 31,
-		// but I'm scared to touch that code...
-		// hopefully, llvm is able to optimize that correctly anyways
-		uint32_t end = mStop < 31 ? (0xFFFFFFFF >> (mStop + 1)) : 0;
-		uint32_t mask = begin ^ end;
-		return mStop < mStart ? ~mask : mask;
-	}
-	
 	template<typename IntType>
 	inline IntType RotateLeft(IntType base, uint32_t offset)
 	{
@@ -108,29 +92,31 @@ namespace PPCVM
 {
 	namespace Execution
 	{
+		template<bool OE, bool Rc>
 		void Interpreter::addcx(Instruction inst)
 		{
 			uint32_t a = state.gpr[inst.RA];
 			uint32_t b = state.gpr[inst.RB];
 			state.gpr[inst.RD] = a + b;
-			state.xer_ca = Carry(a,b);
-
-			if (inst.OE) Panic("OE: addcx");
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RD]);
+			flags.SetCarryFromAdd(a, b);
+			
+			if (OE) Panic("OE: addcx");
+			if (Rc) flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
+		template<bool OE, bool Rc>
 		void Interpreter::addex(Instruction inst)
 		{
 			int carry = state.xer_ca;
 			int a = state.gpr[inst.RA];
 			int b = state.gpr[inst.RB];
 			state.gpr[inst.RD] = a + b + carry;
-			state.xer_ca = Carry(a, b) || (carry != 0 && Carry(a + b, carry));
-
-			if (inst.OE) Panic("OE: addex");
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RD]);
+			flags.SetCarry(Carry(a, b) || (carry != 0 && Carry(a + b, carry)));
+			
+			if (OE) Panic("OE: addex");
+			if (Rc) flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
 		void Interpreter::addi(Instruction inst)
 		{
 			if (inst.RA)
@@ -138,22 +124,22 @@ namespace PPCVM
 			else
 				state.gpr[inst.RD] = inst.SIMM_16;
 		}
-
+		
 		void Interpreter::addic(Instruction inst)
 		{
 			uint32_t a = state.gpr[inst.RA];
 			uint32_t imm = (uint32_t)(int32_t)inst.SIMM_16;
 			TODO("According to Dolphin's 'ector', addic needs some verifying");
 			state.gpr[inst.RD] = a + imm;
-			state.xer_ca = Carry(a, imm);
+			flags.SetCarryFromAdd(a, imm);
 		}
-
+		
 		void Interpreter::addic_rc(Instruction inst)
 		{
 			addic(inst);
-			UpdateCR0(state, state.gpr[inst.RD]);
+			flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
 		void Interpreter::addis(Instruction inst)
 		{
 			if (inst.RA)
@@ -161,63 +147,68 @@ namespace PPCVM
 			else
 				state.gpr[inst.RD] = (inst.SIMM_16 << 16);
 		}
-
+		
+		template<bool OE, bool Rc>
 		void Interpreter::addmex(Instruction inst)
 		{
 			int carry = state.xer_ca;
 			int a = state.gpr[inst.RA];
 			state.gpr[inst.RD] = a + carry - 1;
-			state.xer_ca = Carry(a, carry - 1);
-
-			if (inst.OE) Panic("OE: addmex");
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RD]);
+			flags.SetCarry(Carry(a, carry - 1));
+			
+			if (OE) Panic("OE: addmex");
+			if (Rc) flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
+		template<bool OE, bool Rc>
 		void Interpreter::addx(Instruction inst)
 		{
 			state.gpr[inst.RD] = state.gpr[inst.RA] + state.gpr[inst.RB];
-
-			if (inst.OE) Panic("OE: addx");
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RD]);
+			
+			if (OE) Panic("OE: addx");
+			if (Rc) flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
+		template<bool OE, bool Rc>
 		void Interpreter::addzex(Instruction inst)
 		{
 			int carry = state.xer_ca;
 			int a = state.gpr[inst.RA];
 			state.gpr[inst.RD] = a + carry;
-			state.xer_ca = Carry(a, carry);
-
-			if (inst.OE) Panic("OE: addzex");
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RD]);
+			flags.SetCarry(Carry(a, carry));
+			
+			if (OE) Panic("OE: addzex");
+			if (Rc) flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::andcx(Instruction inst)
 		{
 			state.gpr[inst.RA] = state.gpr[inst.RS] & ~state.gpr[inst.RB];
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
 		void Interpreter::andi_rc(Instruction inst)
 		{
 			state.gpr[inst.RA] = state.gpr[inst.RS] & inst.UIMM;
-			UpdateCR0(state, state.gpr[inst.RA]);
+			flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
 		void Interpreter::andis_rc(Instruction inst)
 		{
 			state.gpr[inst.RA] = state.gpr[inst.RS] & ((uint32_t)inst.UIMM<<16);
-			UpdateCR0(state, state.gpr[inst.RA]);
+			flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::andx(Instruction inst)
 		{
 			state.gpr[inst.RA] = state.gpr[inst.RS] & state.gpr[inst.RB];
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
 		void Interpreter::cmp(Instruction inst)
 		{
 			int32_t a = (int32_t)state.gpr[inst.RA];
@@ -228,25 +219,25 @@ namespace PPCVM
 			if (state.xer_so) Panic("cmp getting overflow flag"); // fTemp |= 0x1
 			state.cr[inst.CRFD] = fTemp;
 		}
-
+		
 		void Interpreter::cmpi(Instruction inst)
 		{
 			UpdateCRx(state, inst.CRFD, state.gpr[inst.RA] - inst.SIMM_16);
 		}
-
+		
 		void Interpreter::cmpl(Instruction inst)
 		{
 			uint32_t a = state.gpr[inst.RA];
 			uint32_t b = state.gpr[inst.RB];
 			uint8_t fTemp = 0x8; // a < b
-
+				
 				//	if (a < b)  fTemp = 0x8;else
 			if (a > b)  fTemp = 0x4;
 			else if (a == b) fTemp = 0x2;
 			if (state.xer_so) Panic("cmpl getting overflow flag"); // fTemp |= 0x1;
 			state.cr[inst.CRFD] = fTemp;
 		}
-
+		
 		void Interpreter::cmpli(Instruction inst)
 		{
 			uint32_t a = state.gpr[inst.RA];
@@ -258,7 +249,8 @@ namespace PPCVM
 			if (state.xer_so) f |= 0x1;
 			state.cr[inst.CRFD] = f;
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::cntlzwx(Instruction inst)
 		{
 			uint32_t val = state.gpr[inst.RS];
@@ -268,34 +260,36 @@ namespace PPCVM
 				if (val & mask)
 					break;
 			state.gpr[inst.RA] = i;
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
+		template<bool OE, bool Rc>
 		void Interpreter::divwux(Instruction inst)
 		{
 			uint32_t a = state.gpr[inst.RA];
 			uint32_t b = state.gpr[inst.RB];
-
+			
 			if (b == 0)
 			{
-				if (inst.OE)
+				if (OE)
 					// should set OV
 					Panic("OE: divwux");
 				state.gpr[inst.RD] = 0;
 			}
 			else
 				state.gpr[inst.RD] = a / b;
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RD]);
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
+		template<bool OE, bool Rc>
 		void Interpreter::divwx(Instruction inst)
 		{
 			int32_t a = state.gpr[inst.RA];
 			int32_t b = state.gpr[inst.RB];
 			if (b == 0 || ((uint32_t)a == 0x80000000 && b == -1))
 			{
-				if (inst.OE)
+				if (OE)
 					// should set OV
 					Panic("OE: divwx");
 				if (((uint32_t)a & 0x80000000) && b == 0)
@@ -305,40 +299,45 @@ namespace PPCVM
 			}
 			else
 				state.gpr[inst.RD] = (uint32_t)(a / b);
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RD]);
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::eqvx(Instruction inst)
 		{
 			state.gpr[inst.RA] = ~(state.gpr[inst.RS] ^ state.gpr[inst.RB]);
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::extsbx(Instruction inst)
 		{
 			state.gpr[inst.RA] = (uint32_t)(int32_t)(int8_t)state.gpr[inst.RS];
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::extshx(Instruction inst)
 		{
 			state.gpr[inst.RA] = (uint32_t)(int32_t)(int16_t)state.gpr[inst.RS];
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::mulhwux(Instruction inst)
 		{
 			uint32_t a = state.gpr[inst.RA];
 			uint32_t b = state.gpr[inst.RB];
 			uint32_t d = (uint32_t)(((uint64_t)a * (uint64_t)b) >> 32);
 			state.gpr[inst.RD] = d;
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RD]);
+			if (Rc) flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::mulhwx(Instruction inst)
 		{
 			uint32_t a = state.gpr[inst.RA];
@@ -346,128 +345,137 @@ namespace PPCVM
 			// This can be done better. Not in plain C/C++ though.
 			uint32_t d = (uint32_t)((uint64_t)(((int64_t)(int32_t)a * (int64_t)(int32_t)b) ) >> 32);
 			state.gpr[inst.RD] = d;
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RD]);
+			if (Rc) flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
 		void Interpreter::mulli(Instruction inst)
 		{
 			state.gpr[inst.RD] = (int32_t)state.gpr[inst.RA] * inst.SIMM_16;
 		}
-
+		
+		template<bool OE, bool Rc>
 		void Interpreter::mullwx(Instruction inst)
 		{
 			uint32_t a = state.gpr[inst.RA];
 			uint32_t b = state.gpr[inst.RB];
 			uint32_t d = (uint32_t)((int32_t)a * (int32_t)b);
 			state.gpr[inst.RD] = d;
-
-			if (inst.OE) Panic("OE: mullwx");
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RD]);
+			
+			if (OE) Panic("OE: mullwx");
+			if (Rc) flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::nandx(Instruction inst)
 		{
 			state.gpr[inst.RA] = ~(state.gpr[inst.RS] & state.gpr[inst.RB]);
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
+		template<bool OE, bool Rc>
 		void Interpreter::negx(Instruction inst)
 		{
 			state.gpr[inst.RD] = (~state.gpr[inst.RA]) + 1;
 			if (state.gpr[inst.RD] == 0x80000000)
 			{
-				if (inst.OE) Panic("OE: negx");
+				if (OE) Panic("OE: negx");
 			}
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RD]);
+			if (Rc) flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::norx(Instruction inst)
 		{
 			state.gpr[inst.RA] = ~(state.gpr[inst.RS] | state.gpr[inst.RB]);
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::orcx(Instruction inst)
 		{
 			state.gpr[inst.RA] = state.gpr[inst.RS] | (~state.gpr[inst.RB]);
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
 		void Interpreter::ori(Instruction inst)
 		{
 			state.gpr[inst.RA] = state.gpr[inst.RS] | inst.UIMM;
 		}
-
+		
 		void Interpreter::oris(Instruction inst)
 		{
 			state.gpr[inst.RA] = state.gpr[inst.RS] | (inst.UIMM << 16);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::orx(Instruction inst)
 		{
 			state.gpr[inst.RA] = state.gpr[inst.RS] | state.gpr[inst.RB];
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::rlwimix(Instruction inst)
 		{
-			uint32_t mask = Mask(inst.MB,inst.ME);
+			uint32_t mask = RotateMask(inst.MB,inst.ME);
 			state.gpr[inst.RA] = (state.gpr[inst.RA] & ~mask) | (RotateLeft(state.gpr[inst.RS],inst.SH) & mask);
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::rlwinmx(Instruction inst)
 		{
 			uint32_t n = inst.SH;
 			uint32_t r = RotateLeft(state.gpr[inst.RS], n);
-			uint32_t m = Mask(inst.MB, inst.ME);
+			uint32_t m = RotateMask(inst.MB, inst.ME);
 			state.gpr[inst.RA] = r & m;
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::rlwnmx(Instruction inst)
 		{
-			uint32_t mask = Mask(inst.MB,inst.ME);
+			uint32_t mask = RotateMask(inst.MB,inst.ME);
 			state.gpr[inst.RA] = RotateLeft(state.gpr[inst.RS], state.gpr[inst.RB] & 0x1F) & mask;
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::slwx(Instruction inst)
 		{
 			uint32_t amount = state.gpr[inst.RB];
 			state.gpr[inst.RA] = (amount & 0x20) ? 0 : state.gpr[inst.RS] << amount;
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::srawix(Instruction inst)
 		{
 			int amount = inst.SH;
-
+			
 			if (amount != 0)
 			{
 				int32_t rrs = state.gpr[inst.RS];
 				state.gpr[inst.RA] = rrs >> amount;
-
-				if ((rrs < 0) && (rrs << (32 - amount)))
-					state.xer_ca = 1;
-				else
-					state.xer_ca = 0;
+				
+				flags.SetCarry((rrs < 0) && (rrs << (32 - amount)));
 			}
 			else
 			{
-				state.xer_ca = 0;
+				flags.SetCarry(false);
 				state.gpr[inst.RA] = state.gpr[inst.RS];
 			}
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::srawx(Instruction inst)
 		{
 			int rb = state.gpr[inst.RB];
@@ -476,12 +484,12 @@ namespace PPCVM
 				if (state.gpr[inst.RS] & 0x80000000)
 				{
 					state.gpr[inst.RA] = 0xFFFFFFFF;
-					state.xer_ca = 1;
+					flags.SetCarry(true);
 				}
 				else
 				{
 					state.gpr[inst.RA] = 0x00000000;
-					state.xer_ca = 0;
+					flags.SetCarry(false);
 				}
 			}
 			else
@@ -490,95 +498,100 @@ namespace PPCVM
 				if (amount == 0)
 				{
 					state.gpr[inst.RA] = state.gpr[inst.RS];
-					state.xer_ca = 0;
+					flags.SetCarry(false);
 				}
 				else
 				{
-					state.gpr[inst.RA] = (uint32_t)((int32_t)state.gpr[inst.RS] >> amount);
-					if (state.gpr[inst.RS] & 0x80000000)
-						state.xer_ca = 1;
-					else
-						state.xer_ca = 0;
+					uint32_t rs = state.gpr[inst.RS];
+					state.gpr[inst.RA] = (uint32_t)((int32_t)rs >> amount);
+					flags.SetCarry((rs & 0x80000000) != 0);
 				}
 			}
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::srwx(Instruction inst)
 		{
 			uint32_t amount = state.gpr[inst.RB];
 			state.gpr[inst.RA] = (amount & 0x20) ? 0 : (state.gpr[inst.RS] >> (amount & 0x1f));
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
 		}
-
+		
+		template<bool OE, bool Rc>
 		void Interpreter::subfcx(Instruction inst)
 		{
 			uint32_t a = state.gpr[inst.RA];
 			uint32_t b = state.gpr[inst.RB];
 			state.gpr[inst.RD] = b - a;
-			state.xer_ca = a == 0 || Carry(b, 0-a);
-
-			if (inst.OE) Panic("OE: subfcx");
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RD]);
+			flags.SetCarryFromSubtract(a, b);
+			
+			if (OE) Panic("OE: subfcx");
+			if (Rc) flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
+		template<bool OE, bool Rc>
 		void Interpreter::subfex(Instruction inst)
 		{
 			uint32_t a = state.gpr[inst.RA];
 			uint32_t b = state.gpr[inst.RB];
 			int carry = state.xer_ca;
 			state.gpr[inst.RD] = (~a) + b + carry;
-			state.xer_ca = Carry(~a, b) || Carry((~a) + b, carry);
-
-			if (inst.OE) Panic("OE: subfex");
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RD]);
+			flags.SetCarry(Carry(~a, b) || Carry((~a) + b, carry));
+			
+			if (OE) Panic("OE: subfex");
+			if (Rc) flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
 		void Interpreter::subfic(Instruction inst)
 		{
 			int32_t immediate = inst.SIMM_16;
-			state.gpr[inst.RD] = immediate - (signed)state.gpr[inst.RA];
-			state.xer_ca = (state.gpr[inst.RA] == 0) || (Carry(0-state.gpr[inst.RA], immediate));
+			uint32_t a = state.gpr[inst.RA];
+			state.gpr[inst.RD] = immediate - (signed)a;
+			flags.SetCarryFromSubtract(a, immediate);
 		}
-
+		
+		template<bool OE, bool Rc>
 		void Interpreter::subfmex(Instruction inst)
 		{
 			uint32_t a = state.gpr[inst.RA];
 			int carry = state.xer_ca;
 			state.gpr[inst.RD] = (~a) + carry - 1;
-			state.xer_ca = Carry(~a, carry - 1);
-
-			if (inst.OE) Panic("OE: subfmex");
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RD]);
+			flags.SetCarry(Carry(~a, carry - 1));
+			
+			if (OE) Panic("OE: subfmex");
+			if (Rc) flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
+		template<bool OE, bool Rc>
 		void Interpreter::subfx(Instruction inst)
 		{
 			state.gpr[inst.RD] = state.gpr[inst.RB] - state.gpr[inst.RA];
-
-			if (inst.OE) Panic("OE: subfx");
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RD]);
+			
+			if (OE) Panic("OE: subfx");
+			if (Rc) flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
+		template<bool OE, bool Rc>
 		void Interpreter::subfzex(Instruction inst)
 		{
 			uint32_t a = state.gpr[inst.RA];
 			int carry = state.xer_ca;
 			state.gpr[inst.RD] = (~a) + carry;
-			state.xer_ca = Carry(~a, carry);
-
-			if (inst.OE) Panic("OE: subfzex");
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RD]);
+			flags.SetCarry(Carry(~a, carry));
+			
+			if (OE) Panic("OE: subfzex");
+			if (Rc) flags.SetCR0(state.gpr[inst.RD]);
 		}
-
+		
 		void Interpreter::tw(Instruction inst)
 		{
 			int32_t a = state.gpr[inst.RA];
 			int32_t b = state.gpr[inst.RB];
 			int32_t TO = inst.TO;
-
+			
 			if (   ((a < b) && (TO & 0x10))
 				|| ((a > b) && (TO & 0x08))
 				|| ((a ==b) && (TO & 0x04))
@@ -588,13 +601,13 @@ namespace PPCVM
 				throw PPCVM::TrapException("tw");
 			}
 		}
-
+		
 		void Interpreter::twi(Instruction inst)
 		{
 			int32_t a = state.gpr[inst.RA];
 			int32_t b = inst.SIMM_16;
 			int32_t TO = inst.TO;
-
+			
 			if (   ((a < b) && (TO & 0x10))
 				|| ((a > b) && (TO & 0x08))
 				|| ((a ==b) && (TO & 0x04))
@@ -604,22 +617,115 @@ namespace PPCVM
 				throw PPCVM::TrapException("twi");
 			}
 		}
-
+		
 		void Interpreter::xori(Instruction inst)
 		{
 			state.gpr[inst.RA] = state.gpr[inst.RS] ^ inst.UIMM;
 		}
-
+		
 		void Interpreter::xoris(Instruction inst)
 		{
 			state.gpr[inst.RA] = state.gpr[inst.RS] ^ (inst.UIMM << 16);
 		}
-
+		
+		template<bool Rc>
 		void Interpreter::xorx(Instruction inst)
 		{
 			state.gpr[inst.RA] = state.gpr[inst.RS] ^ state.gpr[inst.RB];
-
-			if (inst.Rc) UpdateCR0(state, state.gpr[inst.RA]);
-		}		
+			
+			if (Rc) flags.SetCR0(state.gpr[inst.RA]);
+		}
+		
+#pragma mark -
+#pragma mark Predecoded
+		void Interpreter::li(const DecodedInstruction& inst)
+		{
+			state.gpr[inst.D] = inst.Immediate;
+		}
+		
+		void Interpreter::addi(const DecodedInstruction& inst)
+		{
+			state.gpr[inst.D] = state.gpr[inst.A] + inst.Immediate;
+		}
+		
+		void Interpreter::ori(const DecodedInstruction& inst)
+		{
+			state.gpr[inst.D] = state.gpr[inst.A] | inst.Immediate;
+		}
+		
+		void Interpreter::xori(const DecodedInstruction& inst)
+		{
+			state.gpr[inst.D] = state.gpr[inst.A] ^ inst.Immediate;
+		}
+		
+		void Interpreter::andi_rc(const DecodedInstruction& inst)
+		{
+			state.gpr[inst.D] = state.gpr[inst.A] & inst.Immediate;
+			flags.SetCR0(state.gpr[inst.D]);
+		}
+		
+		void Interpreter::cmpi(const DecodedInstruction& inst)
+		{
+			UpdateCRx(state, inst.D, state.gpr[inst.A] - inst.Immediate);
+		}
+		
+		void Interpreter::cmpli(const DecodedInstruction& inst)
+		{
+			uint32_t a = state.gpr[inst.A];
+			uint32_t b = inst.Immediate;
+			uint8_t f;
+			if (a < b)      f = 0x8;
+			else if (a > b) f = 0x4;
+			else            f = 0x2;
+			if (state.xer_so) f |= 0x1;
+			state.cr[inst.D] = f;
+		}
+		
+		void Interpreter::rlwinmx(const DecodedInstruction& inst)
+		{
+			state.gpr[inst.D] = RotateLeft(state.gpr[inst.A], inst.B) & inst.Mask;
+		}
+		
+		void Interpreter::orx(const DecodedInstruction& inst)
+		{
+			state.gpr[inst.D] = state.gpr[inst.A] | state.gpr[inst.B];
+		}
+		
+#pragma mark -
+#pragma mark Variants
+		INSTANTIATE_OE_RC(Interpreter, addcx);
+		INSTANTIATE_OE_RC(Interpreter, addex);
+		INSTANTIATE_OE_RC(Interpreter, addmex);
+		INSTANTIATE_OE_RC(Interpreter, addx);
+		INSTANTIATE_OE_RC(Interpreter, addzex);
+		INSTANTIATE_RC(Interpreter, andcx);
+		INSTANTIATE_RC(Interpreter, andx);
+		INSTANTIATE_RC(Interpreter, cntlzwx);
+		INSTANTIATE_OE_RC(Interpreter, divwux);
+		INSTANTIATE_OE_RC(Interpreter, divwx);
+		INSTANTIATE_RC(Interpreter, eqvx);
+		INSTANTIATE_RC(Interpreter, extsbx);
+		INSTANTIATE_RC(Interpreter, extshx);
+		INSTANTIATE_RC(Interpreter, mulhwux);
+		INSTANTIATE_RC(Interpreter, mulhwx);
+		INSTANTIATE_OE_RC(Interpreter, mullwx);
+		INSTANTIATE_RC(Interpreter, nandx);
+		INSTANTIATE_OE_RC(Interpreter, negx);
+		INSTANTIATE_RC(Interpreter, norx);
+		INSTANTIATE_RC(Interpreter, orcx);
+		INSTANTIATE_RC(Interpreter, orx);
+		INSTANTIATE_RC(Interpreter, rlwimix);
+		INSTANTIATE_RC(Interpreter, rlwinmx);
+		INSTANTIATE_RC(Interpreter, rlwnmx);
+		INSTANTIATE_RC(Interpreter, slwx);
+		INSTANTIATE_RC(Interpreter, srawix);
+		INSTANTIATE_RC(Interpreter, srawx);
+		INSTANTIATE_RC(Interpreter, srwx);
+		INSTANTIATE_OE_RC(Interpreter, subfcx);
+		INSTANTIATE_OE_RC(Interpreter, subfex);
+		INSTANTIATE_OE_RC(Interpreter, subfmex);
+		INSTANTIATE_OE_RC(Interpreter, subfx);
+		INSTANTIATE_OE_RC(Interpreter, subfzex);
+		INSTANTIATE_RC(Interpreter, xorx);
 	}
 }
\ No newline at end of file
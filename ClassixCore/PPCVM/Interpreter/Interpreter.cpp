@@ -25,10 +25,10 @@
 #include "NativeCall.h"
 #include "PanicException.h"
 #include "TrapException.h"
+#include "SamplingProfiler.h"
 #include <iostream>
 #include <sstream>
 #include <cassert>
-#include <dlfcn.h>
 #include "Todo.h"
 
 using namespace Common;
@@ -52,16 +52,109 @@ namespace
 		return (state.cr[bit / 4] >> (3 - (bit & 3))) & 1;
 	}
 	
-	const char* BaseName(const char* path)
+	inline bool EndsBlock(Instruction inst)
 	{
-		const char* lastPathComponent = path;
-		while (*path != 0)
+		switch (inst.OPCD)
 		{
-			if (*path == '/')
-				lastPathComponent = path + 1;
-			path++;
+			case 16: // bcx
+			case 17: // sc
+			case 18: // bx
+				return true;
+			
+			case 19: // bclrx, bcctrx, rfi, isync
+				return inst.SUBOP10 == 16 || inst.SUBOP10 == 528 || inst.SUBOP10 == 50 || inst.SUBOP10 == 150;
+			
+			default:
+				return false;
+		}
+	}
+	
+	inline bool ReadsOrWritesFlags(Instruction inst)
+	{
+		// Whether an instruction needs LazyFlags to be materialized before it runs. Instructions that write CR or
+		// XER directly are in there too: otherwise, flags materialized later would overwrite what they wrote.
+		switch (inst.OPCD)
+		{
+			case 10: // cmpli
+			case 11: // cmpi
+			case 16: // bcx
+			case 17: // sc
+			case 19: // CR logical operations, bclrx, bcctrx
+				return true;
+			
+			case 31:
+				switch (inst.SUBOP10 & 0x1ff)
+				{
+					case 136: // subfex
+					case 138: // addex
+					case 200: // subfzex
+					case 202: // addzex
+					case 232: // subfmex
+					case 234: // addmex
+						return true;
+				}
+				
+				switch (inst.SUBOP10)
+				{
+					case 0: // cmp
+					case 32: // cmpl
+					case 19: // mfcr
+					case 144: // mtcrf
+					case 150: // stwcx.
+					case 339: // mfspr
+					case 467: // mtspr
+					case 512: // mcrxr
+					case 533: // lswx
+					case 661: // stswx
+						return true;
+				}
+				return false;
+			
+			case 63:
+				// fcmpu, fcmpo, mcrfs
+				return inst.SUBOP10 == 0 || inst.SUBOP10 == 32 || inst.SUBOP10 == 64;
+			
+			default:
+				return false;
 		}
-		return lastPathComponent;
+	}
+	
+	// The glue that CFM compilers put in front of every cross-fragment call:
+	//	lwz r12, n(r2)
+	//	stw r2, 20(r1)
+	//	lwz r0, 0(r12)
+	//	lwz r2, 4(r12)
+	//	mtctr r0
+	//	bctr
+	const uint32_t CallStubLength = 6;
+	
+	inline bool IsCallStub(const Common::UInt32* address)
+	{
+		return (address[0].Get() & 0xffff0000) == 0x81820000
+			&& address[1].Get() == 0x90410014
+			&& address[2].Get() == 0x800c0000
+			&& address[3].Get() == 0x804c0004
+			&& address[4].Get() == 0x7c0903a6
+			&& address[5].Get() == 0x4e800420;
+	}
+	
+	// The glue that MPW and Metrowerks programs link in as __ptr_glue, to call through a function pointer:
+	//	lwz r0, 0(r12)
+	//	stw r2, 20(r1)
+	//	mtctr r0 (or lwz r2, 4(r12) first)
+	//	lwz r2, 4(r12)
+	//	bctr
+	// It ends with a tail call, which a routine hook can't make, so the interpreter runs it in one go instead.
+	const uint32_t PointerGlueLength = 5;
+	
+	inline bool IsPointerGlue(const Common::UInt32* address)
+	{
+		uint32_t third = address[2].Get();
+		uint32_t fourth = address[3].Get();
+		return address[0].Get() == 0x800c0000
+			&& address[1].Get() == 0x90410014
+			&& ((third == 0x7c0903a6 && fourth == 0x804c0004) || (third == 0x804c0004 && fourth == 0x7c0903a6))
+			&& address[4].Get() == 0x4e800420;
 	}
 	
 	enum 
@@ -78,24 +171,134 @@ namespace PPCVM
 	namespace Execution
 	{
 		Interpreter::Interpreter(Allocator& allocator, MachineState& state)
-		: state(state), allocator(allocator),
+		: state(state), allocator(allocator), memory(allocator), faultHandler(allocator), trace(nullptr), counters(nullptr),
 			endAddress(allocator.AllocateAuto("Interpreter End Address", 4)),
-			interruptAddress(allocator.AllocateAuto("Interpreter Interrupt Address", 4))
-		{ }
+			interruptAddress(allocator.AllocateAuto("Interpreter Interrupt Address", 4)),
+			sampleAddress(allocator.AllocateAuto("Interpreter Sample Address", 4)),
+			profiler(nullptr), sampling(false), activeNativeCall(nullptr), activeNativeReturn(0),
+			verifyIdioms(IdiomVerificationRequested())
+		{
+			codeListener = allocator.AddCodeListener([this](uint32_t address, uint32_t size)
+			{
+				blockCache.Invalidate(address, size);
+			});
+		}
 		
 		Interpreter::~Interpreter()
-		{ }
+		{
+			allocator.RemoveCodeListener(codeListener);
+		}
 		
 		const UInt32* Interpreter::GetEndAddress() const
 		{
 			return static_cast<const UInt32*>(*endAddress);
 		}
-
+		
+		const Interpreter::MemoryAccess& Interpreter::GetMemoryAccess() const
+		{
+			return memory;
+		}
+		
+		void Interpreter::SetTrace(ExecutionTrace* trace)
+		{
+			this->trace = trace == nullptr ? nullptr : trace->CreateRing();
+		}
+		
+		void Interpreter::SetCounters(ExecutionCounters* counters)
+		{
+			// cached glue stubs call a different handler when counting
+			this->counters = counters;
+			blockCache.Clear();
+		}
+		
+		void Interpreter::SetProfiler(SamplingProfiler* profiler)
+		{
+			this->profiler = profiler;
+		}
+		
+		bool Interpreter::RequestSample()
+		{
+			std::lock_guard<std::mutex> guard(samplingLock);
+			if (!sampling)
+				return false;
+			
+			// like Interrupt(), except that nothing is lost if a branch is already happening
+			const UInt32* expected = nullptr;
+			const UInt32* target = static_cast<UInt32*>(*sampleAddress);
+			return branchAddress.compare_exchange_strong(expected, target);
+		}
+		
+		const NativeCall* Interpreter::GetActiveNativeCall(uint32_t& returnAddress) const
+		{
+			returnAddress = activeNativeReturn.load(std::memory_order_relaxed);
+			return activeNativeCall.load(std::memory_order_acquire);
+		}
+		
+		bool Interpreter::SetSampling(bool sampling)
+		{
+			std::lock_guard<std::mutex> guard(samplingLock);
+			bool wasSampling = this->sampling;
+			this->sampling = sampling;
+			
+			// don't leave a sample request behind for ExecuteOne or ExecuteUntil
+			if (!sampling)
+			{
+				const UInt32* expected = static_cast<UInt32*>(*sampleAddress);
+				branchAddress.compare_exchange_strong(expected, nullptr);
+			}
+			return wasSampling;
+		}
+		
+		void Interpreter::TakeSample(const UInt32* address)
+		{
+			SamplingProfiler* profiler = this->profiler;
+			if (profiler == nullptr)
+				return;
+			
+			// Follow the back chain for return addresses. Functions save LR in their caller's frame, so the
+			// caller of a leaf function that hasn't saved it yet doesn't show up.
+			SamplingProfiler::Sample sample;
+			sample.Native = nullptr;
+			sample.Stack.push_back(allocator.ToIntPtr(address));
+			
+			uint32_t end = allocator.ToIntPtr(GetEndAddress());
+			uint32_t sp = state.r1;
+			while (sample.Stack.size() < 64 && allocator.IsAllocated(sp))
+			{
+				uint32_t caller = allocator.ToPointer<UInt32>(sp)->Get();
+				if (caller <= sp || !allocator.IsAllocated(caller + 8) || !allocator.IsAllocated(caller + 11))
+					break;
+				
+				uint32_t returnAddress = allocator.ToPointer<UInt32>(caller + 8)->Get();
+				if (returnAddress == end)
+					break;
+				
+				sample.Stack.push_back(returnAddress);
+				sp = caller;
+			}
+			profiler->AddSample(std::move(sample));
+		}
+		
+		void Interpreter::InvalidateCode(uint32_t address, uint32_t size)
+		{
+			allocator.InvalidateCode(address, size);
+		}
+		
+		void Interpreter::InvalidateCode(const void* address, size_t size)
+		{
+			allocator.InvalidateCode(allocator.ToIntPtr(address), static_cast<uint32_t>(size));
+		}
+		
+		void Interpreter::InvalidateAllCode()
+		{
+			blockCache.Clear();
+		}
+		
 		void Interpreter::Panic(const std::string& error)
 		{
 			throw PanicException(error);
 		}
-
+		
 		void Interpreter::unknown(Instruction inst)
 		{
 			throw InvalidInstructionException(inst);
@@ -106,6 +309,13 @@ namespace PPCVM
 			const UInt32* voidTarget = allocator.ToPointer<UInt32>(target);
 			const UInt32* oldBranch = branchAddress.exchange(voidTarget);
 			
+			// a sample request doesn't need to stop anything; take it now and let the branch happen
+			if (oldBranch == *sampleAddress)
+			{
+				TakeSample(currentAddress);
+				return;
+			}
+			
 			// We know Interrupt() was called if oldBranch is not null at this point. Normally this is picked up
 			// at branching time (with ExecuteUntilBranch returning), but if we're inside a branch instruction,
 			// we risk overwriting the branch, so check here too. Also, we can't risk letting the execution loop
@@ -131,36 +341,42 @@ namespace PPCVM
 		}
 		
 		const UInt32* Interpreter::ExecuteNative(const NativeCall* function)
+		{
+			return counters == nullptr ? CallNative<false>(function) : CallNative<true>(function);
+		}
+		
+		template<bool Counted>
+		const UInt32* Interpreter::CallNative(const NativeCall* function)
 		{
 			assert(function->Tag == NativeTag && "Invalid call header");
 			
-#ifdef DEBUG_DISASSEMBLE
-			if (getenv("DEBUG_DISASSEMBLE"))
+			if (trace != nullptr)
+				trace->RecordNativeCall(allocator.ToIntPtr(function), reinterpret_cast<const void*>(&function->Callback));
+			
+			flags.MaterializeAll(state);
+			activeNativeReturn.store(state.lr, std::memory_order_relaxed);
+			activeNativeCall.store(function, std::memory_order_release);
+			
+			// faults in library code aren't the guest's
+			MemoryFaultHandler::Scope nativeScope(nullptr);
+			void* libGlobals = allocator.ToPointer<void>(state.r2);
+			if (Counted)
 			{
-				Dl_info symInfo;
-				if (dladdr((const void*)function->Callback, &symInfo) != 0)
-				{
-					if (symInfo.dli_sname != nullptr)
-					{
-						std::cerr << "\t> Calling into [" << BaseName(symInfo.dli_fname) << "::" << symInfo.dli_sname << "]" << std::endl;
-					}
-					else
-					{
-						std::cerr << "\t> Calling into unidentified symbol from [" << symInfo.dli_fname << "]" << std::endl;
-					}
-				}
-				else
-				{
-					std::cerr << "\t> Calling into unknown native function" << std::endl;
-				}
+				auto start = ExecutionCounters::Clock::now();
+				function->Callback(libGlobals, &state);
+				counters->CountNativeCall(reinterpret_cast<const void*>(&function->Callback), ExecutionCounters::Clock::now() - start);
+			}
+			else
+			{
+				function->Callback(libGlobals, &state);
 			}
-#endif
 			
-			void* libGlobals = allocator.ToPointer<void>(state.r2);
-			function->Callback(libGlobals, &state);
+			activeNativeCall.store(nullptr, std::memory_order_relaxed);
+			flags.LoadRoundingMode(state);
 			return allocator.ToPointer<UInt32>(state.lr);
 		}
-
+		
+		template<bool Traced, bool Counted>
 		void Interpreter::ExecuteUntilBranch(const UInt32* address)
 		{
 			currentAddress = address;
@@ -169,10 +385,10 @@ namespace PPCVM
 			{
 				try
 				{
-					if (currentAddress->AsBigEndian == NativeTag)
+					if (IsNativeCall(currentAddress))
 					{
 						const NativeCall* call = reinterpret_cast<const NativeCall*>(currentAddress);
-						const UInt32* returnAddress = ExecuteNative(call);
+						const UInt32* returnAddress = CallNative<Counted>(call);
 						
 						// Native calls absolutely have to be atomic, so if we were interrupted in the middle of one,
 						// set currentAddress to the branch address and then give up. Otherwise set branchAddress
@@ -183,22 +399,268 @@ namespace PPCVM
 							currentAddress = returnAddress;
 							throw TrapException("interrupted");
 						}
+						else if (oldBranch == *sampleAddress)
+						{
+							TakeSample(currentAddress);
+						}
 					}
 					else
 					{
-						Instruction instruction = currentAddress->Get();
-						Dispatch(instruction);
-						currentAddress++;
+						const DecodedBlock& block = GetBlock(currentAddress);
+						for (const DecodedInstruction& decoded : block.Instructions)
+						{
+							if (Traced)
+								trace->RecordInstruction(decoded.Address, decoded.Inst.hex);
+							
+							if (Counted)
+								counters->CountInstruction(decoded.Inst);
+							
+							if (decoded.MaterializesFlags)
+								flags.Materialize(state);
+							
+							if (decoded.Handler != nullptr)
+								(this->*decoded.Handler)(decoded);
+							else
+								(this->*decoded.Method)(decoded.Inst);
+							
+							currentAddress++;
+							
+							// blocks end with a branch, so this only happens early when we're interrupted
+							if (branchAddress.load(std::memory_order_relaxed) != nullptr)
+								break;
+						}
 					}
 				}
 				catch (PPCRuntimeException& ex)
 				{
+					flags.MaterializeAll(state);
 					uint32_t pc = allocator.ToIntPtr(currentAddress);
 					throw InterpreterException(pc, ex);
 				}
 			} while (branchAddress == nullptr);
 		}
 		
+		const DecodedBlock& Interpreter::GetBlock(const UInt32* address)
+		{
+			uint32_t guestAddress = allocator.ToIntPtr(address);
+			allocator.DispatchCodeWrites();
+			if (const DecodedBlock* block = blockCache.Find(guestAddress))
+				return *block;
+			
+			return blockCache.Insert(DecodeBlock(address, guestAddress));
+		}
+		
+		DecodedBlock Interpreter::DecodeBlock(const UInt32* address, uint32_t guestAddress)
+		{
+			// Don't decode past the end of the allocation that holds the code. This also means that decoding never
+			// faults, which matters since a memory fault would skip the destructors of everything here.
+			auto details = allocator.GetDetails(guestAddress);
+			if (details == nullptr)
+				throw AccessViolationException(allocator, guestAddress, 4);
+			
+			uint32_t maxLength = BlockCache<DecodedBlock>::MaxBlockLength;
+			uint32_t remaining = static_cast<uint32_t>(details->Size() - allocator.GetAllocationOffset(guestAddress)) / 4;
+			if (remaining != 0 && remaining < maxLength)
+				maxLength = remaining;
+			
+			// watch before reading, so that no write can slip between the two
+			allocator.WatchCode(guestAddress, maxLength * 4);
+			
+			DecodedBlock block;
+			block.Address = guestAddress;
+			
+			// Glue stubs become a single instruction that calls the target directly. The block still covers all
+			// six words, so that rewriting any of them invalidates it.
+			if (maxLength >= CallStubLength && IsCallStub(address))
+			{
+				DecodedInstruction decoded = DecodeInstruction(address[0].Get(), guestAddress);
+				decoded.Handler = counters == nullptr ? &Interpreter::glue<false> : &Interpreter::glue<true>;
+				block.Instructions.push_back(decoded);
+				block.Size = CallStubLength * 4;
+				callStubs.erase(guestAddress);
+				return block;
+			}
+			
+			if (maxLength >= PointerGlueLength && IsPointerGlue(address))
+			{
+				DecodedInstruction decoded = DecodeInstruction(address[0].Get(), guestAddress);
+				decoded.Handler = counters == nullptr ? &Interpreter::ptrglue<false> : &Interpreter::ptrglue<true>;
+				block.Instructions.push_back(decoded);
+				block.Size = PointerGlueLength * 4;
+				return block;
+			}
+			
+			for (uint32_t i = 0; i < maxLength; i++)
+			{
+				// native calls are never part of a block; ExecuteUntilBranch handles them
+				if (IsNativeCall(&address[i]))
+					break;
+				
+				Instruction inst = address[i].Get();
+				block.Instructions.push_back(DecodeInstruction(inst, guestAddress + i * 4));
+				if (EndsBlock(inst))
+					break;
+			}
+			
+			// Loops that the host can do in one go start with a handler that does just that. When it can't (the loop
+			// would fault, or never end), it runs the first instruction instead and the loop goes on as usual.
+			// Loop bodies are usually decoded when they branch back to themselves for the first time, since the
+			// first iteration is part of the block before them.
+			LoopIdiom idiom;
+			if (MatchLoopIdiom(address, static_cast<uint32_t>(block.Instructions.size()), guestAddress, idiom))
+			{
+				DecodedInstruction& first = block.Instructions.front();
+				first.Handler = &Interpreter::loop;
+				first.MaterializesFlags |= idiom.Kind == LoopIdiom::Scan;
+				loopIdioms[guestAddress] = idiom;
+			}
+			
+			block.Size = static_cast<uint32_t>(block.Instructions.size() * 4);
+			return block;
+		}
+		
+		DecodedInstruction Interpreter::DecodeInstruction(Instruction inst, uint32_t guestAddress)
+		{
+			DecodedInstruction decoded;
+			decoded.Handler = nullptr;
+			decoded.Method = GetMethod(inst);
+			decoded.Inst = inst;
+			decoded.Address = guestAddress;
+			decoded.D = decoded.A = decoded.B = 0;
+			decoded.Immediate = 0;
+			decoded.Mask = 0;
+			decoded.MaterializesFlags = ReadsOrWritesFlags(inst);
+			
+			if (decoded.Method == nullptr)
+			{
+				decoded.Method = &Interpreter::unknown;
+				return decoded;
+			}
+			
+			switch (inst.OPCD)
+			{
+				case 10: // cmpli
+					decoded.Handler = &Interpreter::cmpli;
+					decoded.D = inst.CRFD;
+					decoded.A = inst.RA;
+					decoded.Immediate = inst.UIMM;
+					break;
+				
+				case 11: // cmpi
+					decoded.Handler = &Interpreter::cmpi;
+					decoded.D = inst.CRFD;
+					decoded.A = inst.RA;
+					decoded.Immediate = inst.SIMM_16;
+					break;
+				
+				case 14: // addi
+				case 15: // addis
+					if (inst.RA == 0)
+						decoded.Handler = &Interpreter::li;
+					else
+						decoded.Handler = &Interpreter::addi;
+					decoded.D = inst.RD;
+					decoded.A = inst.RA;
+					decoded.Immediate = inst.OPCD == 14 ? inst.SIMM_16 : (inst.SIMM_16 << 16);
+					break;
+				
+				case 16: // bcx
+				{
+					decoded.Handler = inst.LK ? &Interpreter::bcx<true> : &Interpreter::bcx<false>;
+					int16_t bd = static_cast<int16_t>(inst.BD << 2);
+					uint32_t target = SignExt16(bd);
+					decoded.Immediate = inst.AA ? target : target + guestAddress;
+					break;
+				}
+				
+				case 18: // bx
+				{
+					decoded.Handler = inst.LK ? &Interpreter::bx<true> : &Interpreter::bx<false>;
+					uint32_t target = SignExt26(inst.LI << 2);
+					decoded.Immediate = inst.AA ? target : target + guestAddress;
+					break;
+				}
+				
+				case 21: // rlwinmx
+					if (!inst.Rc)
+					{
+						decoded.Handler = &Interpreter::rlwinmx;
+						decoded.D = inst.RA;
+						decoded.A = inst.RS;
+						decoded.B = inst.SH;
+						decoded.Mask = RotateMask(inst.MB, inst.ME);
+					}
+					break;
+				
+				case 24: // ori
+				case 25: // oris
+				case 26: // xori
+				case 27: // xoris
+				case 28: // andi.
+				case 29: // andis.
+				{
+					static const DecodedHandler logicalHandlers[] = {&Interpreter::ori, &Interpreter::xori, &Interpreter::andi_rc};
+					decoded.Handler = logicalHandlers[(inst.OPCD - 24) / 2];
+					decoded.D = inst.RA;
+					decoded.A = inst.RS;
+					decoded.Immediate = (inst.OPCD & 1) ? inst.UIMM << 16 : inst.UIMM;
+					break;
+				}
+				
+				case 31:
+					if (inst.SUBOP10 == 444 && !inst.Rc) // orx
+					{
+						decoded.Handler = &Interpreter::orx;
+						decoded.D = inst.RA;
+						decoded.A = inst.RS;
+						decoded.B = inst.RB;
+					}
+					break;
+				
+				case 32: // lwz
+				case 33: // lwzu
+				case 34: // lbz
+				case 35: // lbzu
+				case 36: // stw
+				case 37: // stwu
+				case 38: // stb
+				case 39: // stbu
+				case 40: // lhz
+				case 44: // sth
+				{
+					// the r0 forms use an absolute address; leave them to the regular handlers
+					if (inst.RA == 0)
+						break;
+					
+					static const DecodedHandler memoryHandlers[] = {
+						&Interpreter::lwz, &Interpreter::lwzu, &Interpreter::lbz, &Interpreter::lbzu,
+						&Interpreter::stw, &Interpreter::stwu, &Interpreter::stb, &Interpreter::stbu,
+						&Interpreter::lhz, nullptr, nullptr, nullptr, &Interpreter::sth,
+					};
+					decoded.Handler = memoryHandlers[inst.OPCD - 32];
+					decoded.D = inst.RD;
+					decoded.A = inst.RA;
+					decoded.Immediate = inst.SIMM_16;
+					break;
+				}
+			}
+			return decoded;
+		}
+		
+		void Interpreter::ResolveCallStub(CallStub& stub, int32_t tocOffset)
+		{
+			stub.Toc = state.r2;
+			stub.Slot = memory.ToPointer<const UInt32>(state.r2 + tocOffset);
+			stub.Vector = stub.Slot->Get();
+			
+			const UInt32* vector = memory.ToArray<const UInt32>(stub.Vector, 2);
+			stub.Code = vector[0].Get();
+			stub.VectorToc = vector[1].Get();
+			
+			const UInt32* code = memory.ToPointer<const UInt32>(stub.Code & ~3);
+			stub.Native = IsNativeCall(code) ? reinterpret_cast<const NativeCall*>(code) : nullptr;
+		}
+		
 		UInt32* Interpreter::ExecuteOne(UInt32* address)
 		{
 			return const_cast<UInt32*>(ExecuteOne(static_cast<const UInt32*>(address)));
@@ -218,12 +680,18 @@ namespace PPCVM
 		const UInt32* Interpreter::ExecuteOne(const UInt32 *baseAddress, Instruction instruction)
 		{
 			// ExecuteOne is not interruptible
+			GuestRunner::Scope runnerScope(*this);
 			currentAddress = baseAddress;
 			branchAddress = nullptr;
+			flags.LoadRoundingMode(state);
+			
+			MemoryFaultHandler::Scope faultScope(&faultHandler);
+			if (sigsetjmp(faultScope.Target, 0) != 0)
+				ThrowMemoryFault(faultScope);
 			
 			try
 			{
-				if (baseAddress->AsBigEndian == NativeTag)
+				if (IsNativeCall(baseAddress))
 				{
 					assert(baseAddress->Get() == instruction.hex && "Should never replace a native call");
 					const NativeCall* call = reinterpret_cast<const NativeCall*>(baseAddress);
@@ -232,11 +700,13 @@ namespace PPCVM
 				else
 				{
 					Dispatch(instruction);
+					flags.MaterializeAll(state);
 					currentAddress++;
 				}
 			}
 			catch (PPCRuntimeException& ex)
 			{
+				flags.MaterializeAll(state);
 				uint32_t pc = allocator.ToIntPtr(currentAddress);
 				throw InterpreterException(pc, ex);
 			}
@@ -244,38 +714,151 @@ namespace PPCVM
 			const UInt32* br = branchAddress.load(std::memory_order_relaxed);
 			return br == nullptr ? currentAddress : br;
 		}
-
+		
 		void Interpreter::Execute(const UInt32* address)
 		{
+			GuestRunner::Scope runnerScope(*this);
+			if (profiler == nullptr)
+				return ExecuteBlocks(address);
+			
+			bool wasSampling = SetSampling(true);
+			try
+			{
+				ExecuteBlocks(address);
+			}
+			catch (...)
+			{
+				// a native call may have thrown, too
+				activeNativeCall.store(nullptr, std::memory_order_relaxed);
+				SetSampling(wasSampling);
+				throw;
+			}
+			SetSampling(wasSampling);
+		}
+		
+		uint32_t Interpreter::GetReturnAddress() const
+		{
+			return allocator.ToIntPtr(GetEndAddress());
+		}
+		
+		void Interpreter::Run(uint32_t address)
+		{
+			// Only native calls get here, so this is already the current runner, and sampling is on if it needs to be.
+			// The native call that called back into the guest is still running once the callee returns, and the loop
+			// that made it expects to find the addresses it left.
+			uint32_t nativeReturn = activeNativeReturn.load(std::memory_order_relaxed);
+			const NativeCall* nativeCall = activeNativeCall.load(std::memory_order_relaxed);
+			const UInt32* outerAddress = currentAddress;
+			
+			// An interrupt or a sample request posted during the native call is meant for that loop, and the callee's
+			// own loop would clear it.
 			const void* interrupt = *interruptAddress;
+			const void* sample = *sampleAddress;
+			const UInt32* posted = branchAddress.exchange(nullptr);
+			
+			try
+			{
+				ExecuteBlocks(allocator.ToPointer<const UInt32>(address));
+			}
+			catch (...)
+			{
+				currentAddress = outerAddress;
+				activeNativeReturn.store(nativeReturn, std::memory_order_relaxed);
+				activeNativeCall.store(nativeCall, std::memory_order_release);
+				throw;
+			}
+			
+			currentAddress = outerAddress;
+			activeNativeReturn.store(nativeReturn, std::memory_order_relaxed);
+			activeNativeCall.store(nativeCall, std::memory_order_release);
+			
+			// post it again, unless the callee was left with one that matters more
+			const UInt32* last = branchAddress.load();
+			const UInt32* restored;
+			do
+			{
+				restored = posted;
+				if (last == interrupt || (last == sample && posted != interrupt))
+					restored = last;
+			}
+			while (!branchAddress.compare_exchange_weak(last, restored));
+		}
+		
+		void Interpreter::ExecuteBlocks(const UInt32* address)
+		{
+			// guest memory faults land here; see MemoryFaultHandler
+			MemoryFaultHandler::Scope faultScope(&faultHandler);
+			if (sigsetjmp(faultScope.Target, 0) != 0)
+				ThrowMemoryFault(faultScope);
+			
+			// flags stay lazy across blocks; they only have to be exact once we return
+			const void* interrupt = *interruptAddress;
+			const void* sample = *sampleAddress;
+			flags.LoadRoundingMode(state);
+			
+			// tracing and counting are picked once here, so that the plain loop doesn't even check for them
+			static void (Interpreter::* const loops[2][2])(const UInt32*) = {
+				{ &Interpreter::ExecuteUntilBranch<false, false>, &Interpreter::ExecuteUntilBranch<false, true> },
+				{ &Interpreter::ExecuteUntilBranch<true, false>, &Interpreter::ExecuteUntilBranch<true, true> },
+			};
+			auto executeUntilBranch = loops[trace != nullptr][counters != nullptr];
+			
 			while (address != *endAddress)
 			{
-				ExecuteUntilBranch(address);
+				(this->*executeUntilBranch)(address);
 				
 				address = branchAddress.load();
-				if (address == interrupt)
+				if (address == sample)
+				{
+					// the block was cut short; pick up where it stopped
+					TakeSample(currentAddress);
+					address = currentAddress;
+				}
+				else if (address == interrupt)
+				{
+					flags.MaterializeAll(state);
 					throw TrapException("interrupted");
+				}
 			}
+			flags.MaterializeAll(state);
 		}
-
+		
+		void Interpreter::ThrowMemoryFault(const MemoryFaultHandler::Scope& scope)
+		{
+			flags.MaterializeAll(state);
+			uint32_t pc = allocator.ToIntPtr(currentAddress);
+			throw InterpreterException(pc, AccessViolationException(allocator, scope.GetFaultAddress(), 0));
+		}
+		
+		template<bool AA, bool LK>
 		void Interpreter::bx(Instruction inst)
 		{
 			uint32_t address = allocator.ToIntPtr(currentAddress);
-			if (inst.LK)
+			if (LK)
 				state.lr = address + 4;
 			
 			uint32_t target = SignExt26(inst.LI << 2);
-			if (!inst.AA)
+			if (!AA)
 				target += address;
 			
 			SetBranchAddress(target);
 		}
-
+		
+		template<bool LK>
+		void Interpreter::bx(const DecodedInstruction& inst)
+		{
+			if (LK)
+				state.lr = inst.Address + 4;
+			
+			SetBranchAddress(inst.Immediate);
+		}
+		
+		template<bool AA, bool LK>
 		void Interpreter::bcx(Instruction inst)
 		{
 			if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
 				state.ctr--;
-
+			
 			const bool true_false = ((inst.BO >> 3) & 1);
 			const bool only_counter_check = ((inst.BO >> 4) & 1);
 			const bool only_condition_check = ((inst.BO >> 2) & 1);
@@ -286,58 +869,134 @@ namespace PPCVM
 			uint32_t address = allocator.ToIntPtr(currentAddress);
 			if (counter && condition)
 			{
-				if (inst.LK)
+				if (LK)
 					state.lr = address + 4;
 				
 				int16_t bd = static_cast<int16_t>(inst.BD << 2);
 				uint32_t target = SignExt16(bd);
-				if (!inst.AA)
+				if (!AA)
 					target += address;
 				SetBranchAddress(target);
 			}
 		}
-
+		
+		template<bool LK>
+		void Interpreter::bcx(const DecodedInstruction& decoded)
+		{
+			Instruction inst = decoded.Inst;
+			if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
+				state.ctr--;
+			
+			const bool true_false = ((inst.BO >> 3) & 1);
+			const bool only_counter_check = ((inst.BO >> 4) & 1);
+			const bool only_condition_check = ((inst.BO >> 2) & 1);
+			int ctr_check = ((state.ctr != 0) ^ (inst.BO >> 1)) & 1;
+			bool counter = only_condition_check || ctr_check;
+			bool condition = only_counter_check || (GetCRBit(state, inst.BI) == uint32_t(true_false));
+			
+			if (counter && condition)
+			{
+				if (LK)
+					state.lr = decoded.Address + 4;
+				
+				SetBranchAddress(decoded.Immediate);
+			}
+		}
+		
+		template<bool Counted>
+		void Interpreter::glue(const DecodedInstruction& inst)
+		{
+			CallStub& stub = callStubs[inst.Address];
+			if (stub.Slot == nullptr || stub.Toc != state.r2 || stub.Slot->Get() != stub.Vector)
+				ResolveCallStub(stub, inst.Immediate);
+			
+			// leave the registers just like the glue would have
+			*memory.ToPointer<UInt32>(state.r1 + 20) = state.r2;
+			state.r12 = stub.Vector;
+			state.r0 = stub.Code;
+			state.ctr = stub.Code;
+			state.r2 = stub.VectorToc;
+			
+			if (stub.Native == nullptr)
+				SetBranchAddress(stub.Code & ~3);
+			else
+				CallNativeFromGlue<Counted>(stub.Native);
+		}
+		
+		template<bool Counted>
+		void Interpreter::ptrglue(const DecodedInstruction& inst)
+		{
+			// function pointers change from one call to the next, so there's nothing to cache
+			const UInt32* vector = memory.ToArray<const UInt32>(state.r12, 2);
+			uint32_t code = vector[0].Get();
+			*memory.ToPointer<UInt32>(state.r1 + 20) = state.r2;
+			state.r0 = code;
+			state.ctr = code;
+			state.r2 = vector[1].Get();
+			
+			const UInt32* target = memory.ToPointer<const UInt32>(code & ~3);
+			if (IsNativeCall(target))
+				CallNativeFromGlue<Counted>(reinterpret_cast<const NativeCall*>(target));
+			else
+				SetBranchAddress(code & ~3);
+		}
+		
+		template<bool Counted>
+		void Interpreter::CallNativeFromGlue(const NativeCall* function)
+		{
+			// Same as a native call from ExecuteUntilBranch: the call can't be interrupted, so if an interrupt
+			// came in meanwhile, report it from the return address.
+			const UInt32* returnAddress = CallNative<Counted>(function);
+			const void* oldBranch = branchAddress.exchange(returnAddress);
+			if (oldBranch == *interruptAddress)
+			{
+				currentAddress = returnAddress;
+				throw TrapException("interrupted");
+			}
+			else if (oldBranch == *sampleAddress)
+			{
+				TakeSample(currentAddress);
+			}
+		}
+		
+		template<bool LK>
 		void Interpreter::bclrx(Instruction inst)
 		{
 			if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
 				state.ctr--;
-
+			
 			int counter = ((inst.BO >> 2) | ((state.ctr != 0) ^ (inst.BO >> 1))) & 1;
 			int condition = ((inst.BO >> 4) | (GetCRBit(state, inst.BI) == ((inst.BO >> 3) & 1))) & 1;
-
+			
 			if (counter & condition)
 			{
-				if (inst.LK)
+				if (LK)
 					state.lr = allocator.ToIntPtr(currentAddress + 1);
 				
 				SetBranchAddress(state.lr & ~3);
 			}
 		}
-
+		
+		template<bool LK>
 		void Interpreter::bcctrx(Instruction inst)
 		{
 			int condition = ((inst.BO>>4) | (GetCRBit(state, inst.BI) == ((inst.BO>>3) & 1))) & 1;
-
+			
 			if (condition)
 			{
-				if (inst.LK)
+				if (LK)
 					state.lr = allocator.ToIntPtr(currentAddress + 1);
 				
 				SetBranchAddress(state.ctr & ~3);
 			}
 		}
-
-		void Interpreter::sc(Instruction inst)
-		{
-			throw InvalidInstructionException(inst);
-		}
 		
-		// supervisor mode instructions (not implemented)
-		void Interpreter::dcba(Instruction inst)
+		void Interpreter::sc(Instruction inst)
 		{
 			throw InvalidInstructionException(inst);
 		}
 		
+		// cache management and supervisor mode instructions (not implemented)
 		void Interpreter::dcbf(Instruction inst)
 		{
 			throw InvalidInstructionException(inst);
@@ -348,21 +1007,6 @@ namespace PPCVM
 			throw InvalidInstructionException(inst);
 		}
 		
-		void Interpreter::dcbt(Instruction inst)
-		{
-			throw InvalidInstructionException(inst);
-		}
-		
-		void Interpreter::dcbtst(Instruction inst)
-		{
-			throw InvalidInstructionException(inst);
-		}
-		
-		void Interpreter::dcbz(Instruction inst)
-		{
-			throw InvalidInstructionException(inst);
-		}
-		
 		void Interpreter::dcbi(Instruction inst)
 		{
 			throw InvalidInstructionException(inst);
@@ -378,11 +1022,6 @@ namespace PPCVM
 			throw InvalidInstructionException(inst);
 		}
 		
-		void Interpreter::icbi(Instruction inst)
-		{
-			throw InvalidInstructionException(inst);
-		}
-		
 		void Interpreter::mfmsr(Instruction inst)
 		{
 			throw InvalidInstructionException(inst);
@@ -432,5 +1071,12 @@ namespace PPCVM
 		{
 			throw InvalidInstructionException(inst);
 		}
+		
+#pragma mark -
+#pragma mark Variants
+		INSTANTIATE_AA_LK(Interpreter, bx);
+		INSTANTIATE_AA_LK(Interpreter, bcx);
+		INSTANTIATE_LK(Interpreter, bclrx);
+		INSTANTIATE_LK(Interpreter, bcctrx);
 	}
 }
@@ -23,6 +23,7 @@
 #define INTERPRETER_H
 
 #include "NativeCall.h"
+#include "GuestCall.h"
 #include "Allocator.h"
 #include "MachineState.h"
 #include "Instruction.h"
@@ -30,37 +31,142 @@
 #include "BigEndian.h"
 #include "PPCRuntimeException.h"
 #include "InterpreterException.h"
+#include "BlockCache.h"
+#include "MemoryAccess.h"
+#include "LazyFlags.h"
+#include "ExecutionTrace.h"
+#include "ExecutionCounters.h"
+#include "MemoryFaultHandler.h"
+#include "LoopIdioms.h"
 #include <string>
 #include <iostream>
 #include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace PPCVM
 {
 	namespace Execution
 	{
-		class Interpreter : public InstructionDispatcher<Interpreter>
+		class SamplingProfiler;
+		
+		class Interpreter : public InstructionDispatcher<Interpreter>, public GuestRunner
 		{
+		public:
+			// loads and stores go through this instead of the allocator; see MemoryAccess.h
+			typedef DefaultMemoryAccess MemoryAccess;
+			
+		private:
 			MachineState& state;
 			Common::Allocator& allocator;
+			MemoryAccess memory;
+			MemoryFaultHandler faultHandler;
+			LazyFlags flags;
+			ExecutionTrace::Ring* trace;
+			ExecutionCounters* counters;
 			Common::AutoAllocation endAddress;
 			Common::AutoAllocation interruptAddress;
+			Common::AutoAllocation sampleAddress;
+			
+			// sample requests are only accepted while Execute() runs, since nothing else knows what to do with them
+			SamplingProfiler* profiler;
+			std::mutex samplingLock;
+			bool sampling;
+			std::atomic<const NativeCall*> activeNativeCall;
+			std::atomic<uint32_t> activeNativeReturn;
 			
 			const Common::UInt32* currentAddress;
 			std::atomic<const Common::UInt32*> branchAddress;
 			
+			BlockCache<DecodedBlock> blockCache;
+			size_t codeListener;
+			
+			// A cross-fragment call stub (the CFM glue) with its transition vector already loaded. It stays valid as
+			// long as the caller's TOC and the TOC slot that points to the transition vector don't change.
+			struct CallStub
+			{
+				uint32_t Toc;
+				const Common::UInt32* Slot;
+				uint32_t Vector;
+				uint32_t Code;
+				uint32_t VectorToc;
+				const NativeCall* Native;
+			};
+			
+			std::unordered_map<uint32_t, CallStub> callStubs;
+			
+			// loops that run as a whole, by the address of their block; see LoopIdioms.h
+			std::unordered_map<uint32_t, LoopIdiom> loopIdioms;
+			bool verifyIdioms;
+			
+			// VerifyLoop's copies of the memory that a loop writes. They live here because a guest memory fault
+			// longjmps out of VerifyLoop without running destructors.
+			std::vector<uint8_t> verifyOriginal;
+			std::vector<uint8_t> verifyExpected;
+			
 			void SetBranchAddress(uint32_t branchAddress);
+			template<bool Traced, bool Counted>
 			void ExecuteUntilBranch(const Common::UInt32* address);
+			void ExecuteBlocks(const Common::UInt32* address);
+			void ThrowMemoryFault(const MemoryFaultHandler::Scope& scope) __attribute__((noreturn));
 			const Common::UInt32* ExecuteNative(const NativeCall* address);
+			template<bool Counted>
+			const Common::UInt32* CallNative(const NativeCall* address);
+			template<bool Counted>
+			void CallNativeFromGlue(const NativeCall* address);
+			bool SetSampling(bool sampling);
+			void TakeSample(const Common::UInt32* address);
+			
+			const DecodedBlock& GetBlock(const Common::UInt32* address);
+			DecodedBlock DecodeBlock(const Common::UInt32* address, uint32_t guestAddress);
+			DecodedInstruction DecodeInstruction(Instruction inst, uint32_t guestAddress);
+			void ResolveCallStub(CallStub& stub, int32_t tocOffset);
+			bool PlanLoop(const LoopIdiom& idiom, LoopPlan& plan);
+			void RunLoop(const LoopIdiom& idiom, const LoopPlan& plan);
+			uint32_t StepLoop(const LoopIdiom& idiom);
+			void VerifyLoop(const LoopIdiom& idiom, const LoopPlan& plan);
 			
 		public:
 			Interpreter(Common::Allocator& allocator, MachineState& state);
 			~Interpreter();
 			
 			const Common::UInt32* GetEndAddress() const;
+			const MemoryAccess& GetMemoryAccess() const;
+			
+			// Execute() records every instruction and native call into the trace when one is set, through a ring of
+			// its own. Passing nullptr turns tracing off. Not safe to call while the interpreter runs.
+			void SetTrace(ExecutionTrace* trace);
+			
+			// Execute() counts dispatched instructions and native calls when counters are set. Passing nullptr turns
+			// counting off. Not safe to call while the interpreter runs.
+			void SetCounters(ExecutionCounters* counters);
+			
+			// When set, every loop idiom also runs step by step, and the interpreter panics if the results differ.
+			// Starts out set when $CLASSIX_VERIFY_IDIOMS is. Not safe to call while the interpreter runs.
+			void SetIdiomVerification(bool verify);
+			
+			// Used by SamplingProfiler. RequestSample() can be called from any thread; the interpreter hands the
+			// sample to the profiler from its own thread, after its current instruction.
+			void SetProfiler(SamplingProfiler* profiler);
+			bool RequestSample();
+			const NativeCall* GetActiveNativeCall(uint32_t& returnAddress) const;
+			
+			// Must be called when guest code is modified behind the allocator's back, so that stale decoded blocks are
+			// thrown away. The first two tell every listener of the allocator, not just this interpreter.
+			// These are safe to call from other threads; the interpreter picks them up at its next block.
+			void InvalidateCode(uint32_t address, uint32_t size);
+			void InvalidateCode(const void* address, size_t size);
+			void InvalidateAllCode();
 			
 			void Execute(const Common::UInt32* address);
 			void Interrupt();
 			
+			// Native calls that call back into the guest (see GuestCall) end up here. Run can be nested in a native
+			// call of any of the Execute functions.
+			virtual uint32_t GetReturnAddress() const override;
+			virtual void Run(uint32_t address) override;
+			
 			Common::UInt32* ExecuteOne(Common::UInt32* address);
 			Common::UInt32* ExecuteOne(Common::UInt32* baseAddress, Instruction instruction);
 			const Common::UInt32* ExecuteOne(const Common::UInt32* address);
@@ -72,39 +178,47 @@ namespace PPCVM
 			// problems
 			void Panic(const std::string& errorMessage);
 			void unknown(Instruction inst);
-
+			
+			// floating-point helpers
+			template<bool Rc> void SetFloatingPointResult(Instruction inst, double result, bool single);
+			template<bool Rc> void SetInvalidResult(Instruction inst, double result, uint32_t exceptions, bool single);
+			void UpdateCR1();
+			void Compare(Instruction inst, double a, double b, uint32_t exceptions);
+			template<bool Rc> void ConvertToInteger(Instruction inst, bool truncate);
+			template<bool Rc> void MultiplyAdd(Instruction inst, bool subtract, bool negate, bool single);
+			
 			// Floating Point Instructions
-			void fabsx(Instruction inst);
-			void faddsx(Instruction inst);
-			void faddx(Instruction inst);
+			template<bool Rc> void fabsx(Instruction inst);
+			template<bool Rc> void faddsx(Instruction inst);
+			template<bool Rc> void faddx(Instruction inst);
 			void fcmpo(Instruction inst);
 			void fcmpu(Instruction inst);
-			void fctiwx(Instruction inst);
-			void fctiwzx(Instruction inst);
-			void fdivsx(Instruction inst);
-			void fdivx(Instruction inst);
-			void fmaddsx(Instruction inst);
-			void fmaddx(Instruction inst);
-			void fmrx(Instruction inst);
-			void fmsubsx(Instruction inst);
-			void fmsubx(Instruction inst);
-			void fmulsx(Instruction inst);
-			void fmulx(Instruction inst);
-			void fnabsx(Instruction inst);
-			void fnegx(Instruction inst);
-			void fnmaddsx(Instruction inst);
-			void fnmaddx(Instruction inst);
-			void fnmsubsx(Instruction inst);
-			void fnmsubx(Instruction inst);
-			void fresx(Instruction inst);
-			void frspx(Instruction inst);
-			void frsqrtex(Instruction inst);
-			void fselx(Instruction inst);
-			void fsqrtsx(Instruction inst);
-			void fsqrtx(Instruction inst);
-			void fsubsx(Instruction inst);
-			void fsubx(Instruction inst);
-
+			template<bool Rc> void fctiwx(Instruction inst);
+			template<bool Rc> void fctiwzx(Instruction inst);
+			template<bool Rc> void fdivsx(Instruction inst);
+			template<bool Rc> void fdivx(Instruction inst);
+			template<bool Rc> void fmaddsx(Instruction inst);
+			template<bool Rc> void fmaddx(Instruction inst);
+			template<bool Rc> void fmrx(Instruction inst);
+			template<bool Rc> void fmsubsx(Instruction inst);
+			template<bool Rc> void fmsubx(Instruction inst);
+			template<bool Rc> void fmulsx(Instruction inst);
+			template<bool Rc> void fmulx(Instruction inst);
+			template<bool Rc> void fnabsx(Instruction inst);
+			template<bool Rc> void fnegx(Instruction inst);
+			template<bool Rc> void fnmaddsx(Instruction inst);
+			template<bool Rc> void fnmaddx(Instruction inst);
+			template<bool Rc> void fnmsubsx(Instruction inst);
+			template<bool Rc> void fnmsubx(Instruction inst);
+			template<bool Rc> void fresx(Instruction inst);
+			template<bool Rc> void frspx(Instruction inst);
+			template<bool Rc> void frsqrtex(Instruction inst);
+			template<bool Rc> void fselx(Instruction inst);
+			template<bool Rc> void fsqrtsx(Instruction inst);
+			template<bool Rc> void fsqrtx(Instruction inst);
+			template<bool Rc> void fsubsx(Instruction inst);
+			template<bool Rc> void fsubx(Instruction inst);
+			
 			// Integer Instructions
 			void addi(Instruction inst);
 			void addic(Instruction inst);
@@ -121,44 +235,44 @@ namespace PPCVM
 			void twi(Instruction inst);
 			void xori(Instruction inst);
 			void xoris(Instruction inst);
-			void rlwimix(Instruction inst);
-			void rlwinmx(Instruction inst);
-			void rlwnmx(Instruction inst);
-			void andx(Instruction inst);
-			void andcx(Instruction inst);
+			template<bool Rc> void rlwimix(Instruction inst);
+			template<bool Rc> void rlwinmx(Instruction inst);
+			template<bool Rc> void rlwnmx(Instruction inst);
+			template<bool Rc> void andx(Instruction inst);
+			template<bool Rc> void andcx(Instruction inst);
 			void cmp(Instruction inst);
 			void cmpl(Instruction inst);
-			void cntlzwx(Instruction inst);
-			void eqvx(Instruction inst);
-			void extsbx(Instruction inst);
-			void extshx(Instruction inst);
-			void nandx(Instruction inst);
-			void norx(Instruction inst);
-			void orx(Instruction inst);
-			void orcx(Instruction inst);
-			void slwx(Instruction inst);
-			void srawx(Instruction inst);
-			void srawix(Instruction inst);
-			void srwx(Instruction inst);
+			template<bool Rc> void cntlzwx(Instruction inst);
+			template<bool Rc> void eqvx(Instruction inst);
+			template<bool Rc> void extsbx(Instruction inst);
+			template<bool Rc> void extshx(Instruction inst);
+			template<bool Rc> void nandx(Instruction inst);
+			template<bool Rc> void norx(Instruction inst);
+			template<bool Rc> void orx(Instruction inst);
+			template<bool Rc> void orcx(Instruction inst);
+			template<bool Rc> void slwx(Instruction inst);
+			template<bool Rc> void srawx(Instruction inst);
+			template<bool Rc> void srawix(Instruction inst);
+			template<bool Rc> void srwx(Instruction inst);
 			void tw(Instruction inst);
-			void xorx(Instruction inst);
-			void addx(Instruction inst);
-			void addcx(Instruction inst);
-			void addex(Instruction inst);
-			void addmex(Instruction inst);
-			void addzex(Instruction inst);
-			void divwx(Instruction inst);
-			void divwux(Instruction inst);
-			void mulhwx(Instruction inst);
-			void mulhwux(Instruction inst);
-			void mullwx(Instruction inst);
-			void negx(Instruction inst);
-			void subfx(Instruction inst);
-			void subfcx(Instruction inst);
-			void subfex(Instruction inst);
-			void subfmex(Instruction inst);
-			void subfzex(Instruction inst);
-
+			template<bool Rc> void xorx(Instruction inst);
+			template<bool OE, bool Rc> void addx(Instruction inst);
+			template<bool OE, bool Rc> void addcx(Instruction inst);
+			template<bool OE, bool Rc> void addex(Instruction inst);
+			template<bool OE, bool Rc> void addmex(Instruction inst);
+			template<bool OE, bool Rc> void addzex(Instruction inst);
+			template<bool OE, bool Rc> void divwx(Instruction inst);
+			template<bool OE, bool Rc> void divwux(Instruction inst);
+			template<bool Rc> void mulhwx(Instruction inst);
+			template<bool Rc> void mulhwux(Instruction inst);
+			template<bool OE, bool Rc> void mullwx(Instruction inst);
+			template<bool OE, bool Rc> void negx(Instruction inst);
+			template<bool OE, bool Rc> void subfx(Instruction inst);
+			template<bool OE, bool Rc> void subfcx(Instruction inst);
+			template<bool OE, bool Rc> void subfex(Instruction inst);
+			template<bool OE, bool Rc> void subfmex(Instruction inst);
+			template<bool OE, bool Rc> void subfzex(Instruction inst);
+			
 			// Load/Store Instructions
 			void lbz(Instruction inst);
 			void lbzu(Instruction inst);
@@ -218,14 +332,14 @@ namespace PPCVM
 			void stwcxd(Instruction inst);
 			void stwux(Instruction inst);
 			void stwx(Instruction inst);
-
+			
 			// System Registers Instructions
 			void mcrfs(Instruction inst);
-			void mffsx(Instruction inst);
-			void mtfsb0x(Instruction inst);
-			void mtfsb1x(Instruction inst);
-			void mtfsfix(Instruction inst);
-			void mtfsfx(Instruction inst);
+			template<bool Rc> void mffsx(Instruction inst);
+			template<bool Rc> void mtfsb0x(Instruction inst);
+			template<bool Rc> void mtfsb1x(Instruction inst);
+			template<bool Rc> void mtfsfix(Instruction inst);
+			template<bool Rc> void mtfsfx(Instruction inst);
 			void mcrxr(Instruction inst);
 			void mfcr(Instruction inst);
 			void mfspr(Instruction inst);
@@ -245,11 +359,172 @@ namespace PPCVM
 			void sync(Instruction inst);
 			void isync(Instruction inst);
 			
+			// Vector Instructions
+			void dss(Instruction inst);
+			void dst(Instruction inst);
+			void dstst(Instruction inst);
+			void lvebx(Instruction inst);
+			void lvehx(Instruction inst);
+			void lvewx(Instruction inst);
+			void lvsl(Instruction inst);
+			void lvsr(Instruction inst);
+			void lvx(Instruction inst);
+			void lvxl(Instruction inst);
+			void mfvscr(Instruction inst);
+			void mtvscr(Instruction inst);
+			void stvebx(Instruction inst);
+			void stvehx(Instruction inst);
+			void stvewx(Instruction inst);
+			void stvx(Instruction inst);
+			void stvxl(Instruction inst);
+			void vaddcuw(Instruction inst);
+			void vaddfp(Instruction inst);
+			void vaddsbs(Instruction inst);
+			void vaddshs(Instruction inst);
+			void vaddsws(Instruction inst);
+			void vaddubm(Instruction inst);
+			void vaddubs(Instruction inst);
+			void vadduhm(Instruction inst);
+			void vadduhs(Instruction inst);
+			void vadduwm(Instruction inst);
+			void vadduws(Instruction inst);
+			void vand(Instruction inst);
+			void vandc(Instruction inst);
+			void vavgsb(Instruction inst);
+			void vavgsh(Instruction inst);
+			void vavgsw(Instruction inst);
+			void vavgub(Instruction inst);
+			void vavguh(Instruction inst);
+			void vavguw(Instruction inst);
+			void vcfsx(Instruction inst);
+			void vcfux(Instruction inst);
+			template<bool Rc> void vcmpbfpx(Instruction inst);
+			template<bool Rc> void vcmpeqfpx(Instruction inst);
+			template<bool Rc> void vcmpequbx(Instruction inst);
+			template<bool Rc> void vcmpequhx(Instruction inst);
+			template<bool Rc> void vcmpequwx(Instruction inst);
+			template<bool Rc> void vcmpgefpx(Instruction inst);
+			template<bool Rc> void vcmpgtfpx(Instruction inst);
+			template<bool Rc> void vcmpgtsbx(Instruction inst);
+			template<bool Rc> void vcmpgtshx(Instruction inst);
+			template<bool Rc> void vcmpgtswx(Instruction inst);
+			template<bool Rc> void vcmpgtubx(Instruction inst);
+			template<bool Rc> void vcmpgtuhx(Instruction inst);
+			template<bool Rc> void vcmpgtuwx(Instruction inst);
+			void vctsxs(Instruction inst);
+			void vctuxs(Instruction inst);
+			void vexptefp(Instruction inst);
+			void vlogefp(Instruction inst);
+			void vmaddfp(Instruction inst);
+			void vmaxfp(Instruction inst);
+			void vmaxsb(Instruction inst);
+			void vmaxsh(Instruction inst);
+			void vmaxsw(Instruction inst);
+			void vmaxub(Instruction inst);
+			void vmaxuh(Instruction inst);
+			void vmaxuw(Instruction inst);
+			void vmhaddshs(Instruction inst);
+			void vmhraddshs(Instruction inst);
+			void vminfp(Instruction inst);
+			void vminsb(Instruction inst);
+			void vminsh(Instruction inst);
+			void vminsw(Instruction inst);
+			void vminub(Instruction inst);
+			void vminuh(Instruction inst);
+			void vminuw(Instruction inst);
+			void vmladduhm(Instruction inst);
+			void vmrghb(Instruction inst);
+			void vmrghh(Instruction inst);
+			void vmrghw(Instruction inst);
+			void vmrglb(Instruction inst);
+			void vmrglh(Instruction inst);
+			void vmrglw(Instruction inst);
+			void vmsummbm(Instruction inst);
+			void vmsumshm(Instruction inst);
+			void vmsumshs(Instruction inst);
+			void vmsumubm(Instruction inst);
+			void vmsumuhm(Instruction inst);
+			void vmsumuhs(Instruction inst);
+			void vmulesb(Instruction inst);
+			void vmulesh(Instruction inst);
+			void vmuleub(Instruction inst);
+			void vmuleuh(Instruction inst);
+			void vmulosb(Instruction inst);
+			void vmulosh(Instruction inst);
+			void vmuloub(Instruction inst);
+			void vmulouh(Instruction inst);
+			void vnmsubfp(Instruction inst);
+			void vnor(Instruction inst);
+			void vor(Instruction inst);
+			void vperm(Instruction inst);
+			void vpkpx(Instruction inst);
+			void vpkshss(Instruction inst);
+			void vpkshus(Instruction inst);
+			void vpkswss(Instruction inst);
+			void vpkswus(Instruction inst);
+			void vpkuhum(Instruction inst);
+			void vpkuhus(Instruction inst);
+			void vpkuwum(Instruction inst);
+			void vpkuwus(Instruction inst);
+			void vrefp(Instruction inst);
+			void vrfim(Instruction inst);
+			void vrfin(Instruction inst);
+			void vrfip(Instruction inst);
+			void vrfiz(Instruction inst);
+			void vrlb(Instruction inst);
+			void vrlh(Instruction inst);
+			void vrlw(Instruction inst);
+			void vrsqrtefp(Instruction inst);
+			void vsel(Instruction inst);
+			void vsl(Instruction inst);
+			void vslb(Instruction inst);
+			void vsldoi(Instruction inst);
+			void vslh(Instruction inst);
+			void vslo(Instruction inst);
+			void vslw(Instruction inst);
+			void vspltb(Instruction inst);
+			void vsplth(Instruction inst);
+			void vspltisb(Instruction inst);
+			void vspltish(Instruction inst);
+			void vspltisw(Instruction inst);
+			void vspltw(Instruction inst);
+			void vsr(Instruction inst);
+			void vsrab(Instruction inst);
+			void vsrah(Instruction inst);
+			void vsraw(Instruction inst);
+			void vsrb(Instruction inst);
+			void vsrh(Instruction inst);
+			void vsro(Instruction inst);
+			void vsrw(Instruction inst);
+			void vsubcuw(Instruction inst);
+			void vsubfp(Instruction inst);
+			void vsubsbs(Instruction inst);
+			void vsubshs(Instruction inst);
+			void vsubsws(Instruction inst);
+			void vsububm(Instruction inst);
+			void vsububs(Instruction inst);
+			void vsubuhm(Instruction inst);
+			void vsubuhs(Instruction inst);
+			void vsubuwm(Instruction inst);
+			void vsubuws(Instruction inst);
+			void vsum2sws(Instruction inst);
+			void vsum4sbs(Instruction inst);
+			void vsum4shs(Instruction inst);
+			void vsum4ubs(Instruction inst);
+			void vsumsws(Instruction inst);
+			void vupkhpx(Instruction inst);
+			void vupkhsb(Instruction inst);
+			void vupkhsh(Instruction inst);
+			void vupklpx(Instruction inst);
+			void vupklsb(Instruction inst);
+			void vupklsh(Instruction inst);
+			void vxor(Instruction inst);
+			
 			// branching
-			void bx(Instruction inst);
-			void bcx(Instruction inst);
-			void bcctrx(Instruction inst);
-			void bclrx(Instruction inst);
+			template<bool AA, bool LK> void bx(Instruction inst);
+			template<bool AA, bool LK> void bcx(Instruction inst);
+			template<bool LK> void bcctrx(Instruction inst);
+			template<bool LK> void bclrx(Instruction inst);
 			void sc(Instruction inst);
 			
 			// supervisor mode (not implemented)
@@ -273,13 +548,44 @@ namespace PPCVM
 			void tlbia(Instruction inst);
 			void tlbie(Instruction inst);
 			void tlbsync(Instruction inst);
+			
+			// predecoded forms (used from the block cache)
+			// D is the destination register (or the source register, for stores); A and B are source registers.
+			void li(const DecodedInstruction& inst);
+			void addi(const DecodedInstruction& inst);
+			void ori(const DecodedInstruction& inst);
+			void xori(const DecodedInstruction& inst);
+			void andi_rc(const DecodedInstruction& inst);
+			void cmpi(const DecodedInstruction& inst);
+			void cmpli(const DecodedInstruction& inst);
+			void rlwinmx(const DecodedInstruction& inst);
+			void orx(const DecodedInstruction& inst);
+			void lbz(const DecodedInstruction& inst);
+			void lbzu(const DecodedInstruction& inst);
+			void lhz(const DecodedInstruction& inst);
+			void lwz(const DecodedInstruction& inst);
+			void lwzu(const DecodedInstruction& inst);
+			void stb(const DecodedInstruction& inst);
+			void stbu(const DecodedInstruction& inst);
+			void sth(const DecodedInstruction& inst);
+			void stw(const DecodedInstruction& inst);
+			void stwu(const DecodedInstruction& inst);
+			template<bool LK> void bx(const DecodedInstruction& inst);
+			template<bool LK> void bcx(const DecodedInstruction& inst);
+			template<bool Counted>
+			void glue(const DecodedInstruction& inst);
+			template<bool Counted>
+			void ptrglue(const DecodedInstruction& inst);
+			void loop(const DecodedInstruction& inst);
 		};
 		
 		template<typename TBreakpointSet>
 		const Common::UInt32* Interpreter::ExecuteUntil(const Common::UInt32* address, const TBreakpointSet& breakpoints)
 		{
+			GuestRunner::Scope runnerScope(*this);
 			currentAddress = address;
 			branchAddress = nullptr;
+			flags.LoadRoundingMode(state);
 			
 			do
 			{
@@ -295,11 +601,13 @@ namespace PPCVM
 					else
 					{
 						Dispatch(instruction);
+						flags.MaterializeAll(state);
 						currentAddress++;
 					}
 				}
 				catch (Common::PPCRuntimeException& ex)
 				{
+					flags.MaterializeAll(state);
 					uint32_t pc = allocator.ToIntPtr(currentAddress);
 					throw InterpreterException(pc, ex);
 				}
@@ -0,0 +1,221 @@
+//
+// LazyFlags.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__LazyFlags__
+#define __Classix__LazyFlags__
+
+#include <cstdint>
+#include <cfenv>
+#include <cfloat>
+#include <cmath>
+#include "MachineState.h"
+#include "FloatingPointStatus.h"
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		// Rc=1 integer instructions and the carrying forms don't write CR0 and XER[CA] right away: they record the
+		// result or the operands, and Materialize() computes the flags into the MachineState once something is
+		// about to look at them. Most of the time, another instruction overwrites them before that happens.
+		// XER[SO] is never lazy, so CR0 can take it when it's materialized: anything that changes it materializes
+		// the pending flags first.
+		// The FPSCR works the same way, with MaterializeFloatingPoint(). Floating-point instructions run on the host
+		// FPU, whose sticky flags accumulate the overflow, underflow, zero-divide and inexact exceptions; those are
+		// folded into the FPSCR along with the FPRF of the last result when something reads the FPSCR. Invalid
+		// operations are rare and need to know the operands, so they are raised on the spot.
+		class LazyFlags
+		{
+			enum CarryKind : uint8_t
+			{
+				CarryNone,
+				CarryAdd, // a + b carries out
+				CarrySubtract, // b - a doesn't borrow
+				CarryValue, // a is the value
+			};
+			
+			bool cr0Pending;
+			CarryKind carryKind;
+			uint32_t cr0Result;
+			uint32_t carryA;
+			uint32_t carryB;
+			
+			bool fprfPending;
+			bool fprfSingle;
+			double fprfResult;
+			int hostRoundingMode;
+			
+			static uint32_t ClassifyResult(double result, bool single)
+			{
+				// FPRF values, from the PowerPC Programming Environments Manual, table 2-8
+				bool negative = std::signbit(result);
+				switch (std::fpclassify(result))
+				{
+					case FP_NAN: return 0x11;
+					case FP_INFINITE: return negative ? 0x09 : 0x05;
+					case FP_ZERO: return negative ? 0x12 : 0x02;
+					case FP_SUBNORMAL: return negative ? 0x18 : 0x14;
+				}
+				
+				if (single && std::fabs(result) < FLT_MIN)
+					return negative ? 0x18 : 0x14;
+				return negative ? 0x08 : 0x04;
+			}
+			
+		public:
+			LazyFlags()
+			: cr0Pending(false), carryKind(CarryNone), fprfPending(false), hostRoundingMode(FE_TONEAREST)
+			{ }
+			
+			inline void SetCR0(uint32_t result)
+			{
+				cr0Pending = true;
+				cr0Result = result;
+			}
+			
+			inline void SetCarryFromAdd(uint32_t a, uint32_t b)
+			{
+				carryKind = CarryAdd;
+				carryA = a;
+				carryB = b;
+			}
+			
+			inline void SetCarryFromSubtract(uint32_t a, uint32_t b)
+			{
+				carryKind = CarrySubtract;
+				carryA = a;
+				carryB = b;
+			}
+			
+			inline void SetCarry(bool carry)
+			{
+				carryKind = CarryValue;
+				carryA = carry;
+			}
+			
+			inline void SetFPRF(double result, bool single)
+			{
+				fprfPending = true;
+				fprfSingle = single;
+				fprfResult = result;
+			}
+			
+			// Sets exception bits, along with FX when one of them is new, and recomputes VX and FEX.
+			static void RaiseFloatingPointExceptions(MachineState& state, uint32_t exceptions)
+			{
+				const uint32_t fx = static_cast<uint32_t>(FloatingPointStatus::FX);
+				if ((exceptions & ~state.fpscr.hex) != 0)
+					state.fpscr.hex |= fx;
+				state.fpscr.hex |= exceptions;
+				UpdateFloatingPointSummary(state);
+			}
+			
+			static void UpdateFloatingPointSummary(MachineState& state)
+			{
+				const uint32_t invalidBits = 0x01f80700; // VXSNAN through VXVC, VXSOFT, VXSQRT, VXCVI
+				uint32_t fpscr = state.fpscr.hex;
+				if (fpscr & invalidBits)
+					fpscr |= static_cast<uint32_t>(FloatingPointStatus::VX);
+				else
+					fpscr &= ~static_cast<uint32_t>(FloatingPointStatus::VX);
+				
+				// VX, OX, UX, ZX and XX line up with VE, OE, UE, ZE and XE, 22 bits lower
+				if (((fpscr >> 22) & fpscr & 0xf8) != 0)
+					fpscr |= static_cast<uint32_t>(FloatingPointStatus::FEX);
+				else
+					fpscr &= ~static_cast<uint32_t>(FloatingPointStatus::FEX);
+				state.fpscr.hex = fpscr;
+			}
+			
+			// Applies FPSCR[RN] to the host FPU and forgets host exceptions that don't belong to the guest. Needs to be
+			// called when RN changes, when the interpreter is entered and after native calls, since host code shares
+			// the FPU with the guest thread.
+			inline void LoadRoundingMode(const MachineState& state)
+			{
+				// clearing costs a lot more than testing, and this runs for every guest call from native code
+				if (fetestexcept(FE_ALL_EXCEPT) != 0)
+					feclearexcept(FE_ALL_EXCEPT);
+				
+				static const int hostModes[] = {FE_TONEAREST, FE_TOWARDZERO, FE_UPWARD, FE_DOWNWARD};
+				int mode = hostModes[state.fpscr.RN];
+				if (mode != hostRoundingMode)
+				{
+					fesetround(mode);
+					hostRoundingMode = mode;
+				}
+			}
+			
+			inline void MaterializeFloatingPoint(MachineState& state)
+			{
+				if (!fprfPending)
+					return;
+				
+				uint32_t exceptions = 0;
+				int raised = fetestexcept(FE_OVERFLOW | FE_UNDERFLOW | FE_DIVBYZERO | FE_INEXACT);
+				if (raised != 0)
+				{
+					if (raised & FE_OVERFLOW) exceptions |= static_cast<uint32_t>(FloatingPointStatus::OX);
+					if (raised & FE_UNDERFLOW) exceptions |= static_cast<uint32_t>(FloatingPointStatus::UX);
+					if (raised & FE_DIVBYZERO) exceptions |= static_cast<uint32_t>(FloatingPointStatus::ZX);
+					if (raised & FE_INEXACT) exceptions |= static_cast<uint32_t>(FloatingPointStatus::XX);
+					feclearexcept(raised);
+					RaiseFloatingPointExceptions(state, exceptions);
+				}
+				
+				state.fpscr.FPRF = ClassifyResult(fprfResult, fprfSingle);
+				fprfPending = false;
+			}
+			
+			inline void Materialize(MachineState& state)
+			{
+				switch (carryKind)
+				{
+					case CarryNone: break;
+					case CarryAdd: state.xer_ca = carryB > ~carryA; break;
+					case CarrySubtract: state.xer_ca = carryB >= carryA; break;
+					case CarryValue: state.xer_ca = carryA; break;
+				}
+				carryKind = CarryNone;
+				
+				if (cr0Pending)
+				{
+					uint8_t field;
+					if (cr0Result == 0)
+						field = 0b0010;
+					else if ((cr0Result & 0x80000000) == 0x80000000)
+						field = 0b1000;
+					else
+						field = 0b0100;
+					state.cr[0] = field | state.xer_so;
+					cr0Pending = false;
+				}
+			}
+			
+			inline void MaterializeAll(MachineState& state)
+			{
+				Materialize(state);
+				MaterializeFloatingPoint(state);
+			}
+		};
+	}
+}
+
+#endif /* defined(__Classix__LazyFlags__) */
@@ -37,8 +37,17 @@
 // Classix. If not, see http://www.gnu.org/licenses/.
 //
 
+#include <algorithm>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
 #include "Interpreter.h"
 #include "BigEndian.h"
+#include "GuestLayout.h"
 
 using namespace Common;
 
@@ -52,45 +61,175 @@ namespace
 	const bool IsBigEndian = false;
 #endif
 	
+	// bytes aren't where they seem to be in swizzled guest memory; everything else goes through UInt32 and friends
 	template<typename T>
-	inline T* GetEffectivePointer(Common::Allocator& allocator, MachineState& state, Instruction inst)
+	inline T* Locate(T* pointer)
+	{
+		return pointer;
+	}
+	
+	inline uint8_t* Locate(uint8_t* pointer)
+	{
+		return GuestLayout::Byte(pointer);
+	}
+	
+	template<typename T>
+	inline T* GetEffectivePointer(const Execution::Interpreter::MemoryAccess& memory, MachineState& state, Instruction inst)
 	{
 		uint32_t address = inst.RA
 			? state.gpr[inst.RA] + inst.SIMM_16
 			: inst.SIMM_16;
-		return allocator.ToPointer<T>(address);
+		return Locate(memory.ToPointer<T>(address));
 	}
 	
 	template<typename T>
-	inline T* GetEffectiveArrayPointer(Common::Allocator& allocator, MachineState& state, Instruction inst, size_t count)
+	inline T* GetEffectiveArrayPointer(const Execution::Interpreter::MemoryAccess& memory, MachineState& state, Instruction inst, size_t count)
 	{
 		uint32_t address = inst.RA
 			? state.gpr[inst.RA] + inst.SIMM_16
 			: inst.SIMM_16;
-		return allocator.ToArray<T>(address, count);
+		return memory.ToArray<T>(address, count);
 	}
 	
 	template<typename T>
-	inline T* GetEffectivePointerU(Common::Allocator& allocator, MachineState& state, Instruction inst)
+	inline T* GetEffectivePointerU(const Execution::Interpreter::MemoryAccess& memory, MachineState& state, Instruction inst, uint32_t& address)
 	{
-		uint32_t address = state.gpr[inst.RA] + inst.SIMM_16;
-		return allocator.ToPointer<T>(address);
+		address = state.gpr[inst.RA] + inst.SIMM_16;
+		return Locate(memory.ToPointer<T>(address));
 	}
 	
 	template<typename T>
-	inline T* GetEffectivePointerX(Common::Allocator& allocator, MachineState& state, Instruction inst)
+	inline T* GetEffectivePointerX(const Execution::Interpreter::MemoryAccess& memory, MachineState& state, Instruction inst)
 	{
 		uint32_t address = inst.RA
 			? state.gpr[inst.RA] + state.gpr[inst.RB]
 			: state.gpr[inst.RB];
-		return allocator.ToPointer<T>(address);
+		return Locate(memory.ToPointer<T>(address));
 	}
 	
 	template<typename T>
-	inline T* GetEffectivePointerUX(Common::Allocator& allocator, MachineState& state, Instruction inst)
+	inline T* GetEffectivePointerUX(const Execution::Interpreter::MemoryAccess& memory, MachineState& state, Instruction inst, uint32_t& address)
+	{
+		address = state.gpr[inst.RA] + state.gpr[inst.RB];
+		return Locate(memory.ToPointer<T>(address));
+	}
+	
+	inline uint32_t GetEffectiveAddressX(MachineState& state, Instruction inst)
+	{
+		return inst.RA
+			? state.gpr[inst.RA] + state.gpr[inst.RB]
+			: state.gpr[inst.RB];
+	}
+	
+	const uint32_t CacheLineSize = 32;
+	
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && defined(__SSE2__)
+	inline __m128i SwapWords(__m128i words)
+	{
+#if defined(__SSSE3__)
+		return _mm_shuffle_epi8(words, _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3));
+#else
+		words = _mm_or_si128(_mm_slli_epi16(words, 8), _mm_srli_epi16(words, 8));
+		words = _mm_shufflelo_epi16(words, _MM_SHUFFLE(2, 3, 0, 1));
+		return _mm_shufflehi_epi16(words, _MM_SHUFFLE(2, 3, 0, 1));
+#endif
+	}
+#endif
+	
+	// Copies big-endian words to host-endian words or the other way around, which is the same thing.
+	// Neither side needs to be aligned.
+	inline void CopySwappedWords(void* into, const void* from, size_t count)
+	{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		uint8_t* dest = static_cast<uint8_t*>(into);
+		const uint8_t* src = static_cast<const uint8_t*>(from);
+#if defined(__SSE2__)
+		for (; count >= 4; count -= 4)
+		{
+			__m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), SwapWords(words));
+			src += 16;
+			dest += 16;
+		}
+#endif
+		
+		for (; count > 0; count--)
+		{
+			uint32_t word;
+			memcpy(&word, src, sizeof word);
+			word = BigToHost<uint32_t>::Swap(word);
+			memcpy(dest, &word, sizeof word);
+			src += 4;
+			dest += 4;
+		}
+#else
+		memcpy(into, from, count * sizeof(uint32_t));
+#endif
+	}
+	
+	// Moves whole words between guest memory and registers. In swizzled guest memory, aligned words already are in host
+	// byte order.
+	inline void LoadWords(uint32_t* into, const void* from, size_t count)
+	{
+#if CLASSIX_SWIZZLED_MEMORY
+		const uint8_t* src = static_cast<const uint8_t*>(from);
+		if ((reinterpret_cast<uintptr_t>(src) & 3) == 0)
+			memcpy(into, src, count * sizeof(uint32_t));
+		else for (size_t i = 0; i < count; i++)
+			into[i] = Swizzle::Load<uint32_t>(src + i * 4);
+#else
+		CopySwappedWords(into, from, count);
+#endif
+	}
+	
+	inline void StoreWords(void* into, const uint32_t* from, size_t count)
+	{
+#if CLASSIX_SWIZZLED_MEMORY
+		uint8_t* dest = static_cast<uint8_t*>(into);
+		if ((reinterpret_cast<uintptr_t>(dest) & 3) == 0)
+			memcpy(dest, from, count * sizeof(uint32_t));
+		else for (size_t i = 0; i < count; i++)
+			Swizzle::Store<uint32_t>(dest + i * 4, from[i]);
+#else
+		CopySwappedWords(into, from, count);
+#endif
+	}
+	
+	// lswi and lswx: registers fill from their most significant byte, and wrap from r31 to r0
+	void LoadString(MachineState& state, const uint8_t* from, uint32_t reg, uint32_t count)
+	{
+		while (count >= 4)
+		{
+			uint32_t words = std::min(count / 4, 32 - reg);
+			LoadWords(&state.gpr[reg], from, words);
+			from += words * 4;
+			count -= words * 4;
+			reg = (reg + words) & 31;
+		}
+		
+		if (count != 0)
+		{
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < count; i++)
+				value |= *GuestLayout::Byte(from + i) << (24 - i * 8);
+			state.gpr[reg] = value;
+		}
+	}
+	
+	// stswi and stswx
+	void StoreString(const MachineState& state, uint8_t* into, uint32_t reg, uint32_t count)
 	{
-		uint32_t address = state.gpr[inst.RA] + state.gpr[inst.RB];
-		return allocator.ToPointer<T>(address);
+		while (count >= 4)
+		{
+			uint32_t words = std::min(count / 4, 32 - reg);
+			StoreWords(into, &state.gpr[reg], words);
+			into += words * 4;
+			count -= words * 4;
+			reg = (reg + words) & 31;
+		}
+		
+		for (uint32_t i = 0; i < count; i++)
+			*GuestLayout::Byte(into + i) = static_cast<uint8_t>(state.gpr[reg] >> (24 - i * 8));
 	}
 }
 
@@ -98,462 +237,476 @@ namespace PPCVM
 {
 	namespace Execution
 	{
+		// dcba is only a hint, but zeroing the line is always a correct way to honor it
+		void Interpreter::dcba(Instruction inst)
+		{
+			dcbz(inst);
+		}
+		
+		void Interpreter::dcbt(Instruction inst)
+		{
+			__builtin_prefetch(memory.ToHint(GetEffectiveAddressX(state, inst)), 0);
+		}
+		
+		void Interpreter::dcbtst(Instruction inst)
+		{
+			__builtin_prefetch(memory.ToHint(GetEffectiveAddressX(state, inst)), 1);
+		}
+		
+		void Interpreter::dcbz(Instruction inst)
+		{
+			uint32_t line = GetEffectiveAddressX(state, inst) & ~(CacheLineSize - 1);
+			memset(memory.ToArray<uint8_t>(line, CacheLineSize), 0, CacheLineSize);
+		}
+		
 		void Interpreter::eieio(Instruction inst)
 		{
 			__sync_synchronize();
 		}
 		
+		void Interpreter::icbi(Instruction inst)
+		{
+			uint32_t line = GetEffectiveAddressX(state, inst) & ~(CacheLineSize - 1);
+			allocator.InvalidateCode(line, CacheLineSize);
+		}
+		
 		void Interpreter::lbz(Instruction inst)
 		{
-			state.gpr[inst.RD] = *GetEffectivePointer<uint8_t>(allocator, state, inst);
+			state.gpr[inst.RD] = *GetEffectivePointer<uint8_t>(memory, state, inst);
 		}
 		
 		void Interpreter::lbzu(Instruction inst)
 		{
-			uint8_t* address = GetEffectivePointerU<uint8_t>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			uint8_t* address = GetEffectivePointerU<uint8_t>(memory, state, inst, effectiveAddress);
 			state.gpr[inst.RD] = *address;
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::lbzux(Instruction inst)
 		{
-			uint8_t* address = GetEffectivePointerUX<uint8_t>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			uint8_t* address = GetEffectivePointerUX<uint8_t>(memory, state, inst, effectiveAddress);
 			state.gpr[inst.RD] = *address;
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::lbzx(Instruction inst)
 		{
-			state.gpr[inst.RD] = *GetEffectivePointerX<uint8_t>(allocator, state, inst);
+			state.gpr[inst.RD] = *GetEffectivePointerX<uint8_t>(memory, state, inst);
 		}
 		
 		void Interpreter::lfd(Instruction inst)
 		{
-			Real64* ptr = GetEffectivePointer<Real64>(allocator, state, inst);
+			Real64* ptr = GetEffectivePointer<Real64>(memory, state, inst);
 			state.fpr[inst.FD] = *ptr;
 		}
 		
 		void Interpreter::lfdu(Instruction inst)
 		{
-			Real64* address = GetEffectivePointerU<Real64>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			Real64* address = GetEffectivePointerU<Real64>(memory, state, inst, effectiveAddress);
 			state.fpr[inst.FD] = *address;
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::lfdux(Instruction inst)
 		{
-			Real64* address = GetEffectivePointerUX<Real64>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			Real64* address = GetEffectivePointerUX<Real64>(memory, state, inst, effectiveAddress);
 			state.fpr[inst.FD] = *address;
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::lfdx(Instruction inst)
 		{
-			Real64* address = GetEffectivePointerX<Real64>(allocator, state, inst);
+			Real64* address = GetEffectivePointerX<Real64>(memory, state, inst);
 			state.fpr[inst.FD] = *address;
 		}
 		
 		void Interpreter::lfs(Instruction inst)
 		{
-			state.fpr[inst.FD] = *GetEffectivePointer<Real32>(allocator, state, inst);
+			state.fpr[inst.FD] = *GetEffectivePointer<Real32>(memory, state, inst);
 		}
 		
 		void Interpreter::lfsu(Instruction inst)
 		{
-			Real32* address = GetEffectivePointerU<Real32>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			Real32* address = GetEffectivePointerU<Real32>(memory, state, inst, effectiveAddress);
 			state.fpr[inst.FD] = *address;
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::lfsux(Instruction inst)
 		{
-			Real32* address = GetEffectivePointerUX<Real32>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			Real32* address = GetEffectivePointerUX<Real32>(memory, state, inst, effectiveAddress);
 			state.fpr[inst.FD] = *address;
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::lfsx(Instruction inst)
 		{
-			Real32* address = GetEffectivePointerX<Real32>(allocator, state, inst);
+			Real32* address = GetEffectivePointerX<Real32>(memory, state, inst);
 			state.fpr[inst.FD] = *address;
 		}
 		
 		void Interpreter::lha(Instruction inst)
 		{
-			state.gpr[inst.RD] = *GetEffectivePointer<SInt16>(allocator, state, inst);
+			state.gpr[inst.RD] = *GetEffectivePointer<SInt16>(memory, state, inst);
 		}
 		
 		void Interpreter::lhau(Instruction inst)
 		{
-			SInt16* address = GetEffectivePointerU<SInt16>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			SInt16* address = GetEffectivePointerU<SInt16>(memory, state, inst, effectiveAddress);
 			state.gpr[inst.RD] = *address;
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::lhaux(Instruction inst)
 		{
-			SInt16* address = GetEffectivePointerUX<SInt16>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			SInt16* address = GetEffectivePointerUX<SInt16>(memory, state, inst, effectiveAddress);
 			state.gpr[inst.RD] = *address;
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::lhax(Instruction inst)
 		{
-			state.gpr[inst.RD] = *GetEffectivePointerX<SInt16>(allocator, state, inst);
+			state.gpr[inst.RD] = *GetEffectivePointerX<SInt16>(memory, state, inst);
 		}
 		
 		void Interpreter::lhbrx(Instruction inst)
 		{
-			uint16_t halfWord = *GetEffectivePointerX<uint16_t>(allocator, state, inst);
-			state.gpr[inst.RD] = HostToLittle<uint16_t>::Swap(halfWord);
+			uint16_t halfWord = *GetEffectivePointerX<UInt16>(memory, state, inst);
+			state.gpr[inst.RD] = CF::IntSwap<uint16_t>::Swap(halfWord);
 		}
 		
 		void Interpreter::lhz(Instruction inst)
 		{
-			state.gpr[inst.RD] = *GetEffectivePointer<UInt16>(allocator, state, inst);
+			state.gpr[inst.RD] = *GetEffectivePointer<UInt16>(memory, state, inst);
 		}
 		
 		void Interpreter::lhzu(Instruction inst)
 		{
-			UInt16* address = GetEffectivePointerU<UInt16>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			UInt16* address = GetEffectivePointerU<UInt16>(memory, state, inst, effectiveAddress);
 			state.gpr[inst.RD] = *address;
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::lhzux(Instruction inst)
 		{
-			UInt16* address = GetEffectivePointerUX<UInt16>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			UInt16* address = GetEffectivePointerUX<UInt16>(memory, state, inst, effectiveAddress);
 			state.gpr[inst.RD] = *address;
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::lhzx(Instruction inst)
 		{
-			state.gpr[inst.RD] = *GetEffectivePointerX<UInt16>(allocator, state, inst);
+			state.gpr[inst.RD] = *GetEffectivePointerX<UInt16>(memory, state, inst);
 		}
 		
 		void Interpreter::lmw(Instruction inst)
 		{
-			UInt32* address = GetEffectiveArrayPointer<UInt32>(allocator, state, inst, 32 - inst.RD);
-			for (int i = inst.RD; i < 32; i++)
-			{
-				state.gpr[i] = *address;
-				address++;
-			}
+			size_t count = 32 - inst.RD;
+			LoadWords(&state.gpr[inst.RD], GetEffectiveArrayPointer<UInt32>(memory, state, inst, count), count);
 		}
 		
 		void Interpreter::lswi(Instruction inst)
 		{
-			uint8_t* EA = inst.RA == 0 ? nullptr : reinterpret_cast<uint8_t*>(state.gpr[inst.RA]);
-			
-			uint32_t n;
-			if (inst.NB == 0)
-				n = 32;
-			else
-				n = inst.NB;
-			
-			int r = inst.RD - 1;
-			int i = 0;
-			while (n>0)
-			{
-				if (i==0)
-				{
-					r++;
-					r &= 31;
-					state.gpr[r] = 0;
-				}
-				
-				uint32_t TempValue = *EA << (24 - i);
-				
-				state.gpr[r] |= TempValue;
-				
-				i += 8;
-				if (i == 32)
-					i = 0;
-				EA++;
-				n--;
-			}
+			uint32_t count = inst.NB == 0 ? 32 : inst.NB;
+			uint32_t address = inst.RA == 0 ? 0 : state.gpr[inst.RA];
+			LoadString(state, memory.ToArray<uint8_t>(address, count), inst.RD, count);
 		}
 		
 		void Interpreter::lswx(Instruction inst)
 		{
-			// according to the guys behind the Dolphin InterpreterBase, this could be
-			// incorrect
-			uint8_t* address = GetEffectivePointerX<uint8_t>(allocator, state, inst);
-			uint32_t n = state.xer & 0x7f;
-			uint32_t r = inst.RD;
-			uint32_t i = 0;
-			
-			if (n != 0)
-			{
-				state.gpr[r] = 0;
-				do
-				{
-					uint32_t value = *address << (24 - i * 8);
-					state.gpr[r] |= value;
-					address++;
-					i++;
-					n--;
-					if (i == 4)
-					{
-						i = 0;
-						r++;
-						r %= 32;
-						state.gpr[r] = 0;
-					}
-				}
-				while (n > 0);
-			}
+			uint32_t count = state.xer & 0x7f;
+			if (count != 0)
+				LoadString(state, memory.ToArray<uint8_t>(GetEffectiveAddressX(state, inst), count), inst.RD, count);
 		}
 		
 		void Interpreter::lwarx(Instruction inst)
 		{
 			// since we emulate only one CPU, treat lwarx as a regular load
-			state.gpr[inst.RD] = *GetEffectivePointerX<UInt32>(allocator, state, inst);
+			state.gpr[inst.RD] = *GetEffectivePointerX<UInt32>(memory, state, inst);
 		}
 		
 		void Interpreter::lwbrx(Instruction inst)
 		{
-			uint32_t word = *GetEffectivePointerX<uint32_t>(allocator, state, inst);
-			state.gpr[inst.RD] = HostToLittle<uint32_t>::Swap(word);
+			uint32_t word = *GetEffectivePointerX<UInt32>(memory, state, inst);
+			state.gpr[inst.RD] = CF::IntSwap<uint32_t>::Swap(word);
 		}
 		
 		void Interpreter::lwz(Instruction inst)
 		{
-			state.gpr[inst.RD] = *GetEffectivePointer<UInt32>(allocator, state, inst);
+			state.gpr[inst.RD] = *GetEffectivePointer<UInt32>(memory, state, inst);
 		}
 		
 		void Interpreter::lwzu(Instruction inst)
 		{
-			UInt32* address = GetEffectivePointerU<UInt32>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			UInt32* address = GetEffectivePointerU<UInt32>(memory, state, inst, effectiveAddress);
 			state.gpr[inst.RD] = *address;
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::lwzux(Instruction inst)
 		{
-			UInt32* address = GetEffectivePointerUX<UInt32>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			UInt32* address = GetEffectivePointerUX<UInt32>(memory, state, inst, effectiveAddress);
 			state.gpr[inst.RD] = *address;
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::lwzx(Instruction inst)
 		{
-			state.gpr[inst.RD] = *GetEffectivePointerX<UInt32>(allocator, state, inst);
+			state.gpr[inst.RD] = *GetEffectivePointerX<UInt32>(memory, state, inst);
 		}
 		
 		void Interpreter::stb(Instruction inst)
 		{
-			*GetEffectivePointer<uint8_t>(allocator, state, inst) = static_cast<uint8_t>(state.gpr[inst.RS]);
+			*GetEffectivePointer<uint8_t>(memory, state, inst) = static_cast<uint8_t>(state.gpr[inst.RS]);
 		}
 		
 		void Interpreter::stbu(Instruction inst)
 		{
-			uint8_t* address = GetEffectivePointerU<uint8_t>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			uint8_t* address = GetEffectivePointerU<uint8_t>(memory, state, inst, effectiveAddress);
 			*address = static_cast<uint8_t>(state.gpr[inst.RS]);
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::stbux(Instruction inst)
 		{
-			uint8_t* address = GetEffectivePointerUX<uint8_t>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			uint8_t* address = GetEffectivePointerUX<uint8_t>(memory, state, inst, effectiveAddress);
 			*address = static_cast<uint8_t>(state.gpr[inst.RS]);
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::stbx(Instruction inst)
 		{
-			*GetEffectivePointerX<uint8_t>(allocator, state, inst) = static_cast<uint8_t>(state.gpr[inst.RS]);
+			*GetEffectivePointerX<uint8_t>(memory, state, inst) = static_cast<uint8_t>(state.gpr[inst.RS]);
 		}
 		
 		void Interpreter::stfd(Instruction inst)
 		{
-			Real64* address = GetEffectivePointer<Real64>(allocator, state, inst);
+			Real64* address = GetEffectivePointer<Real64>(memory, state, inst);
 			*address = state.fpr[inst.FS];
 		}
 		
 		void Interpreter::stfdu(Instruction inst)
 		{
-			Real64* address = GetEffectivePointerU<Real64>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			Real64* address = GetEffectivePointerU<Real64>(memory, state, inst, effectiveAddress);
 			*address = state.fpr[inst.FS];
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::stfdux(Instruction inst)
 		{
-			Real64* address = GetEffectivePointerUX<Real64>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			Real64* address = GetEffectivePointerUX<Real64>(memory, state, inst, effectiveAddress);
 			*address = state.fpr[inst.FS];
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::stfdx(Instruction inst)
 		{
-			*GetEffectivePointerX<Real64>(allocator, state, inst) = state.fpr[inst.RA];
+			*GetEffectivePointerX<Real64>(memory, state, inst) = state.fpr[inst.RA];
 		}
 		
 		void Interpreter::stfiwx(Instruction inst)
 		{
-			UInt32* address = GetEffectivePointerX<UInt32>(allocator, state, inst);
+			UInt32* address = GetEffectivePointerX<UInt32>(memory, state, inst);
 			uint32_t* fprAsInteger = reinterpret_cast<uint32_t*>(&state.fpr[inst.FS]);
 			*address = fprAsInteger[IsBigEndian ? 1 : 0];
 		}
 		
 		void Interpreter::stfs(Instruction inst)
 		{
-			Real32* address = GetEffectivePointer<Real32>(allocator, state, inst);
+			Real32* address = GetEffectivePointer<Real32>(memory, state, inst);
 			*address = static_cast<float>(state.fpr[inst.FS]);
 		}
 		
 		void Interpreter::stfsu(Instruction inst)
 		{
-			Real32* address = GetEffectivePointerU<Real32>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			Real32* address = GetEffectivePointerU<Real32>(memory, state, inst, effectiveAddress);
 			*address = static_cast<float>(state.fpr[inst.FS]);
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::stfsux(Instruction inst)
 		{
-			Real32* address = GetEffectivePointerUX<Real32>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			Real32* address = GetEffectivePointerUX<Real32>(memory, state, inst, effectiveAddress);
 			*address = static_cast<float>(state.fpr[inst.FS]);
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::stfsx(Instruction inst)
 		{
-			*GetEffectivePointerX<Real32>(allocator, state, inst) = static_cast<float>(state.fpr[inst.FS]);
+			*GetEffectivePointerX<Real32>(memory, state, inst) = static_cast<float>(state.fpr[inst.FS]);
 		}
 		
 		void Interpreter::sth(Instruction inst)
 		{
-			*GetEffectivePointer<UInt16>(allocator, state, inst) = static_cast<uint16_t>(state.gpr[inst.RS]);
+			*GetEffectivePointer<UInt16>(memory, state, inst) = static_cast<uint16_t>(state.gpr[inst.RS]);
 		}
 		
 		void Interpreter::sthbrx(Instruction inst)
 		{
-			uint16_t halfWord = HostToLittle<uint16_t>::Swap(static_cast<uint16_t>(state.gpr[inst.RS]));
-			*GetEffectivePointerX<uint16_t>(allocator, state, inst) = halfWord;
+			uint16_t halfWord = CF::IntSwap<uint16_t>::Swap(static_cast<uint16_t>(state.gpr[inst.RS]));
+			*GetEffectivePointerX<UInt16>(memory, state, inst) = halfWord;
 		}
 		
 		void Interpreter::sthu(Instruction inst)
 		{
-			UInt16* address = GetEffectivePointerU<UInt16>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			UInt16* address = GetEffectivePointerU<UInt16>(memory, state, inst, effectiveAddress);
 			*address = static_cast<uint16_t>(state.gpr[inst.RS]);
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::sthux(Instruction inst)
 		{
-			UInt16* address = GetEffectivePointerUX<UInt16>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			UInt16* address = GetEffectivePointerUX<UInt16>(memory, state, inst, effectiveAddress);
 			*address = static_cast<uint16_t>(state.gpr[inst.RS]);
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::sthx(Instruction inst)
 		{
-			*GetEffectivePointerX<UInt16>(allocator, state, inst) = static_cast<uint16_t>(state.gpr[inst.RS]);
+			*GetEffectivePointerX<UInt16>(memory, state, inst) = static_cast<uint16_t>(state.gpr[inst.RS]);
 		}
 		
 		void Interpreter::stmw(Instruction inst)
 		{
-			UInt32* address = GetEffectivePointer<UInt32>(allocator, state, inst);
-			for (int i = inst.RS; i < 32; i++)
-			{
-				*address = state.gpr[i];
-				address++;
-			}
+			size_t count = 32 - inst.RS;
+			StoreWords(GetEffectiveArrayPointer<UInt32>(memory, state, inst, count), &state.gpr[inst.RS], count);
 		}
 		
 		void Interpreter::stswi(Instruction inst)
 		{
-			uint8_t* EA = inst.RA == 0 ? nullptr : reinterpret_cast<uint8_t*>(state.gpr[inst.RA]);
-			
-			uint32_t n;
-			if (inst.NB == 0)
-				n = 32;
-			else
-				n = inst.NB;
-			
-			int r = inst.RS - 1;
-			int i = 0;
-			while (n > 0)
-			{
-				if (i == 0)
-				{
-					r++;
-					r &= 31;
-				}
-				
-				*EA = static_cast<uint8_t>(state.gpr[r] >> (24 - i));
-				
-				i += 8;
-				if (i == 32)
-					i = 0;
-				EA++;
-				n--;
-			}
+			uint32_t count = inst.NB == 0 ? 32 : inst.NB;
+			uint32_t address = inst.RA == 0 ? 0 : state.gpr[inst.RA];
+			StoreString(state, memory.ToArray<uint8_t>(address, count), inst.RS, count);
 		}
 		
 		void Interpreter::stswx(Instruction inst)
 		{
-			uint8_t* EA = GetEffectivePointerX<uint8_t>(allocator, state, inst);
-			uint32_t n = state.xer & 0x7F;
-			int r = inst.RS;
-			int i = 0;
-			
-			while (n > 0)
-			{
-				*EA = static_cast<uint8_t>(state.gpr[r] >> (24 - i));
-				
-				EA++;
-				n--;
-				i += 8;
-				if (i == 32)
-				{
-					i = 0;
-					r++;
-				}
-			}
+			uint32_t count = state.xer & 0x7f;
+			if (count != 0)
+				StoreString(state, memory.ToArray<uint8_t>(GetEffectiveAddressX(state, inst), count), inst.RS, count);
 		}
 		
 		void Interpreter::stw(Instruction inst)
 		{
-			*GetEffectivePointer<UInt32>(allocator, state, inst) = state.gpr[inst.RS];
+			*GetEffectivePointer<UInt32>(memory, state, inst) = state.gpr[inst.RS];
 		}
 		
 		void Interpreter::stwbrx(Instruction inst)
 		{
-			*GetEffectivePointerX<uint32_t>(allocator, state, inst) = HostToLittle<uint32_t>::Swap(state.gpr[inst.RS]);
+			*GetEffectivePointerX<UInt32>(memory, state, inst) = CF::IntSwap<uint32_t>::Swap(state.gpr[inst.RS]);
 		}
 		
 		void Interpreter::stwcxd(Instruction inst)
 		{
 			// since we emulate only one CPU, treat stwcxd as a regular store
-			*GetEffectivePointerX<UInt32>(allocator, state, inst) = state.gpr[inst.RS];
+			*GetEffectivePointerX<UInt32>(memory, state, inst) = state.gpr[inst.RS];
 			state.cr[0] = state.xer_so;
 		}
 		
 		void Interpreter::stwu(Instruction inst)
 		{
-			UInt32* address = GetEffectivePointerU<UInt32>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			UInt32* address = GetEffectivePointerU<UInt32>(memory, state, inst, effectiveAddress);
 			*address = state.gpr[inst.RS];
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::stwux(Instruction inst)
 		{
-			UInt32* address = GetEffectivePointerUX<UInt32>(allocator, state, inst);
+			uint32_t effectiveAddress;
+			UInt32* address = GetEffectivePointerUX<UInt32>(memory, state, inst, effectiveAddress);
 			*address = state.gpr[inst.RS];
-			state.gpr[inst.RA] = allocator.ToIntPtr(address);
+			state.gpr[inst.RA] = effectiveAddress;
 		}
 		
 		void Interpreter::stwx(Instruction inst)
 		{
-			*GetEffectivePointerX<UInt32>(allocator, state, inst) = state.gpr[inst.RS];
+			*GetEffectivePointerX<UInt32>(memory, state, inst) = state.gpr[inst.RS];
 		}
 		
 		void Interpreter::sync(Instruction inst)
 		{
 			__sync_synchronize();
-		}		
+		}
+		
+#pragma mark -
+#pragma mark Predecoded
+		void Interpreter::lbz(const DecodedInstruction& inst)
+		{
+			state.gpr[inst.D] = *Locate(memory.ToPointer<uint8_t>(state.gpr[inst.A] + inst.Immediate));
+		}
+		
+		void Interpreter::lbzu(const DecodedInstruction& inst)
+		{
+			uint32_t address = state.gpr[inst.A] + inst.Immediate;
+			state.gpr[inst.D] = *Locate(memory.ToPointer<uint8_t>(address));
+			state.gpr[inst.A] = address;
+		}
+		
+		void Interpreter::lhz(const DecodedInstruction& inst)
+		{
+			state.gpr[inst.D] = *memory.ToPointer<UInt16>(state.gpr[inst.A] + inst.Immediate);
+		}
+		
+		void Interpreter::lwz(const DecodedInstruction& inst)
+		{
+			state.gpr[inst.D] = *memory.ToPointer<UInt32>(state.gpr[inst.A] + inst.Immediate);
+		}
+		
+		void Interpreter::lwzu(const DecodedInstruction& inst)
+		{
+			uint32_t address = state.gpr[inst.A] + inst.Immediate;
+			state.gpr[inst.D] = *memory.ToPointer<UInt32>(address);
+			state.gpr[inst.A] = address;
+		}
+		
+		void Interpreter::stb(const DecodedInstruction& inst)
+		{
+			*Locate(memory.ToPointer<uint8_t>(state.gpr[inst.A] + inst.Immediate)) = static_cast<uint8_t>(state.gpr[inst.D]);
+		}
+		
+		void Interpreter::stbu(const DecodedInstruction& inst)
+		{
+			uint32_t address = state.gpr[inst.A] + inst.Immediate;
+			*Locate(memory.ToPointer<uint8_t>(address)) = static_cast<uint8_t>(state.gpr[inst.D]);
+			state.gpr[inst.A] = address;
+		}
+		
+		void Interpreter::sth(const DecodedInstruction& inst)
+		{
+			*memory.ToPointer<UInt16>(state.gpr[inst.A] + inst.Immediate) = static_cast<uint16_t>(state.gpr[inst.D]);
+		}
+		
+		void Interpreter::stw(const DecodedInstruction& inst)
+		{
+			*memory.ToPointer<UInt32>(state.gpr[inst.A] + inst.Immediate) = state.gpr[inst.D];
+		}
+		
+		void Interpreter::stwu(const DecodedInstruction& inst)
+		{
+			uint32_t address = state.gpr[inst.A] + inst.Immediate;
+			*memory.ToPointer<UInt32>(address) = state.gpr[inst.D];
+			state.gpr[inst.A] = address;
+		}
 	}
 }
\ No newline at end of file
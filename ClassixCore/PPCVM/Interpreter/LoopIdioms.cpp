@@ -0,0 +1,545 @@
+//
+// LoopIdioms.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include "LoopIdioms.h"
+#include "Interpreter.h"
+#include "GuestLayout.h"
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+
+using namespace Common;
+
+namespace
+{
+	using namespace PPCVM;
+	using namespace PPCVM::Execution;
+	
+	// lwzu, lbzu and lhzu; 0 for anything else
+	inline uint8_t LoadWithUpdateSize(Instruction inst)
+	{
+		switch (inst.OPCD)
+		{
+			case 33: return 4;
+			case 35: return 1;
+			case 41: return 2;
+			default: return 0;
+		}
+	}
+	
+	// stwu, stbu and sthu; 0 for anything else
+	inline uint8_t StoreWithUpdateSize(Instruction inst)
+	{
+		switch (inst.OPCD)
+		{
+			case 37: return 4;
+			case 39: return 1;
+			case 45: return 2;
+			default: return 0;
+		}
+	}
+	
+	// update forms that go through consecutive elements, and that don't use their base register for anything else
+	inline bool IsElementStep(Instruction inst, uint8_t size)
+	{
+		return inst.RA != 0 && inst.RA != inst.RD && (inst.SIMM_16 == size || inst.SIMM_16 == -size);
+	}
+	
+	// BO, ignoring the branch prediction bit
+	inline bool IsBdnz(Instruction bc)
+	{
+		return (bc.BO & 0x16) == 0x10;
+	}
+	
+	inline bool IsBdnzf(Instruction bc)
+	{
+		return (bc.BO & 0x1e) == 0;
+	}
+	
+	inline bool IsBf(Instruction bc)
+	{
+		return (bc.BO & 0x1c) == 0x04;
+	}
+	
+	// cmpwi, cmplwi, cmpw and cmplw
+	inline bool IsWordCompare(Instruction inst)
+	{
+		if (inst.L != 0)
+			return false;
+		return inst.OPCD == 10 || inst.OPCD == 11 || (inst.OPCD == 31 && (inst.SUBOP10 == 0 || inst.SUBOP10 == 32));
+	}
+	
+	// The lowest address of the count elements that an update form with this step goes through from base, if they
+	// don't wrap around.
+	bool GetElementRange(uint32_t base, int8_t step, uint32_t count, uint32_t& lowest)
+	{
+		int64_t first = static_cast<int64_t>(base) + step;
+		int64_t last = static_cast<int64_t>(base) + static_cast<int64_t>(step) * count;
+		int64_t low = std::min(first, last);
+		int64_t high = std::max(first, last) + std::abs(step);
+		if (low < 0 || high > 0x100000000ll)
+			return false;
+		
+		lowest = static_cast<uint32_t>(low);
+		return true;
+	}
+	
+	// Host functions go through ranges without checking them, so they must not fault: besides the exception that
+	// it would be, nothing here expects a memory fault to unwind it.
+	bool IsInOneAllocation(const Allocator& allocator, uint32_t address, uint64_t size)
+	{
+		auto details = allocator.GetDetails(address);
+		return details != nullptr && allocator.GetAllocationOffset(address) + size <= details->Size();
+	}
+	
+	inline uint32_t LoadElement(const uint8_t* address, uint8_t size)
+	{
+		switch (size)
+		{
+			case 1: return *GuestLayout::Byte(address);
+			case 2: return *reinterpret_cast<const UInt16*>(address);
+			default: return *reinterpret_cast<const UInt32*>(address);
+		}
+	}
+	
+	inline void StoreElement(uint8_t* address, uint8_t size, uint32_t value)
+	{
+		switch (size)
+		{
+			case 1: *GuestLayout::Byte(address) = static_cast<uint8_t>(value); break;
+			case 2: *reinterpret_cast<UInt16*>(address) = static_cast<uint16_t>(value); break;
+			default: *reinterpret_cast<UInt32*>(address) = value; break;
+		}
+	}
+	
+	// offset of the element that iteration i goes through, from the lowest of them
+	inline uint32_t ElementOffset(const LoopIdiom& idiom, uint32_t iterations, uint32_t i)
+	{
+		return idiom.Step > 0 ? i * idiom.Size : (iterations - 1 - i) * idiom.Size;
+	}
+}
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+#pragma mark -
+#pragma mark Matching
+		LoopIdiom::LoopIdiom()
+		: Kind(Copy), Size(0), Step(0), Value(0), Source(0), Destination(0), Accumulator(0), Xor(false), Counted(true), Compare(0), Address(0), Exit(0)
+		{ }
+		
+		const char* LoopIdiom::GetName() const
+		{
+			static const char* names[] = {"copy", "fill", "scan", "sum"};
+			return names[Kind];
+		}
+		
+		bool MatchLoopIdiom(const UInt32* code, uint32_t length, uint32_t address, LoopIdiom& idiom)
+		{
+			if (length < 2 || length > 3)
+				return false;
+			
+			// the block has to be the whole loop
+			Instruction branch = code[length - 1].Get();
+			if (branch.OPCD != 16 || branch.AA || branch.LK || branch.BD != -static_cast<int32_t>(length - 1))
+				return false;
+			
+			idiom.Address = address;
+			idiom.Exit = address + length * 4;
+			
+			Instruction first = code[0].Get();
+			if (length == 2)
+			{
+				uint8_t size = StoreWithUpdateSize(first);
+				if (size == 0 || !IsElementStep(first, size) || !IsBdnz(branch))
+					return false;
+				
+				idiom.Kind = LoopIdiom::Fill;
+				idiom.Size = size;
+				idiom.Step = static_cast<int8_t>(first.SIMM_16);
+				idiom.Value = first.RS;
+				idiom.Destination = first.RA;
+				idiom.Counted = true;
+				return true;
+			}
+			
+			uint8_t size = LoadWithUpdateSize(first);
+			if (size == 0 || !IsElementStep(first, size))
+				return false;
+			
+			idiom.Size = size;
+			idiom.Step = static_cast<int8_t>(first.SIMM_16);
+			idiom.Value = first.RD;
+			idiom.Source = first.RA;
+			
+			Instruction second = code[1].Get();
+			if (StoreWithUpdateSize(second) == size && IsBdnz(branch))
+			{
+				if (second.RS != idiom.Value || second.SIMM_16 != idiom.Step || second.RA == 0 || second.RA == idiom.Value || second.RA == idiom.Source)
+					return false;
+				
+				idiom.Kind = LoopIdiom::Copy;
+				idiom.Destination = second.RA;
+				idiom.Counted = true;
+				return true;
+			}
+			
+			if (second.OPCD == 31 && !second.Rc && (second.SUBOP10 == 266 || second.SUBOP10 == 316) && IsBdnz(branch))
+			{
+				// add rD, rA, rB and xor rA, rS, rB
+				bool isXor = second.SUBOP10 == 316;
+				uint8_t target = isXor ? second.RA : second.RD;
+				uint8_t left = isXor ? second.RS : second.RA;
+				uint8_t right = second.RB;
+				if (!((left == target && right == idiom.Value) || (left == idiom.Value && right == target)))
+					return false;
+				
+				if (target == idiom.Value || target == idiom.Source)
+					return false;
+				
+				idiom.Kind = LoopIdiom::Sum;
+				idiom.Accumulator = target;
+				idiom.Xor = isXor;
+				idiom.Counted = true;
+				return true;
+			}
+			
+			if (size == 1 && IsWordCompare(second) && second.RA == idiom.Value && branch.BI == second.CRFD * 4 + 2)
+			{
+				// the loop goes on while the byte isn't the one it's looking for
+				if (!IsBdnzf(branch) && !IsBf(branch))
+					return false;
+				
+				if (second.OPCD == 31 && (second.RB == idiom.Value || second.RB == idiom.Source))
+					return false;
+				
+				idiom.Kind = LoopIdiom::Scan;
+				idiom.Compare = second;
+				idiom.Counted = IsBdnzf(branch);
+				return true;
+			}
+			return false;
+		}
+		
+		bool IdiomVerificationRequested()
+		{
+			const char* verify = getenv("CLASSIX_VERIFY_IDIOMS");
+			return verify != nullptr && strcmp(verify, "0") != 0;
+		}
+		
+#pragma mark -
+#pragma mark Execution
+		void Interpreter::SetIdiomVerification(bool verify)
+		{
+			verifyIdioms = verify;
+		}
+		
+		bool Interpreter::PlanLoop(const LoopIdiom& idiom, LoopPlan& plan)
+		{
+			// with ctr = 0, the loop would go through 2^32 iterations
+			uint32_t count = state.ctr;
+			if (idiom.Counted && count == 0)
+				return false;
+			
+			plan.Iterations = count;
+			plan.ReadAddress = 0;
+			plan.WriteAddress = 0;
+			plan.WriteSize = 0;
+			uint64_t bytes = static_cast<uint64_t>(count) * idiom.Size;
+			
+			switch (idiom.Kind)
+			{
+				case LoopIdiom::Copy:
+				{
+					if (!GetElementRange(state.gpr[idiom.Source], idiom.Step, count, plan.ReadAddress) || !IsInOneAllocation(allocator, plan.ReadAddress, bytes))
+						return false;
+					
+					if (!GetElementRange(state.gpr[idiom.Destination], idiom.Step, count, plan.WriteAddress) || !IsInOneAllocation(allocator, plan.WriteAddress, bytes))
+						return false;
+					
+					// An overlapping copy is only a memmove if every element is read before something is written over
+					// it. Otherwise, it replicates a pattern, and that's left to the interpreter.
+					bool overlaps = plan.ReadAddress < plan.WriteAddress + bytes && plan.WriteAddress < plan.ReadAddress + bytes;
+					if (overlaps && (idiom.Step > 0) != (plan.WriteAddress < plan.ReadAddress))
+						return false;
+					
+					plan.WriteSize = static_cast<uint32_t>(bytes);
+					return true;
+				}
+				
+				case LoopIdiom::Fill:
+				{
+					if (!GetElementRange(state.gpr[idiom.Destination], idiom.Step, count, plan.WriteAddress) || !IsInOneAllocation(allocator, plan.WriteAddress, bytes))
+						return false;
+					
+					plan.WriteSize = static_cast<uint32_t>(bytes);
+					return true;
+				}
+				
+				case LoopIdiom::Sum:
+					return GetElementRange(state.gpr[idiom.Source], idiom.Step, count, plan.ReadAddress) && IsInOneAllocation(allocator, plan.ReadAddress, bytes);
+				
+				case LoopIdiom::Scan:
+				{
+					// look as far as the allocation goes, and no further than ctr allows
+					uint32_t first = state.gpr[idiom.Source] + idiom.Step;
+					auto details = allocator.GetDetails(first);
+					if (details == nullptr)
+						return false;
+					
+					uint64_t offset = allocator.GetAllocationOffset(first);
+					uint64_t available = idiom.Step > 0 ? details->Size() - offset : offset + 1;
+					uint32_t limit = static_cast<uint32_t>(idiom.Counted ? std::min<uint64_t>(count, available) : std::min<uint64_t>(available, 0xffffffff));
+					plan.ReadAddress = idiom.Step > 0 ? first : first - (limit - 1);
+					const uint8_t* scanned = memory.ToArray<const uint8_t>(plan.ReadAddress, limit);
+					
+					Instruction compare = idiom.Compare;
+					uint32_t target = compare.OPCD == 11 ? static_cast<uint32_t>(compare.SIMM_16)
+						: compare.OPCD == 10 ? compare.UIMM
+						: state.gpr[compare.RB];
+					
+					uint32_t found = 0;
+					if (target <= 0xff)
+					{
+						if (idiom.Step > 0 && !GuestLayout::Swizzled)
+						{
+							const void* match = memchr(scanned, static_cast<int>(target), limit);
+							if (match != nullptr)
+								found = static_cast<uint32_t>(static_cast<const uint8_t*>(match) - scanned) + 1;
+						}
+						else
+						{
+							for (uint32_t i = 0; i < limit && found == 0; i++)
+							{
+								if (*GuestLayout::Byte(scanned + ElementOffset(idiom, limit, i)) == target)
+									found = i + 1;
+							}
+						}
+					}
+					
+					// without a match, the loop has to end because of ctr, before it leaves the allocation
+					if (found != 0)
+						plan.Iterations = found;
+					else if (!idiom.Counted || count > available)
+						return false;
+					return true;
+				}
+			}
+			return false;
+		}
+		
+		void Interpreter::RunLoop(const LoopIdiom& idiom, const LoopPlan& plan)
+		{
+			uint32_t iterations = plan.Iterations;
+			uint32_t bytes = iterations * idiom.Size;
+			uint32_t advance = static_cast<uint32_t>(static_cast<int64_t>(idiom.Step) * iterations);
+			
+			switch (idiom.Kind)
+			{
+				case LoopIdiom::Copy:
+				{
+					const uint8_t* from = memory.ToArray<const uint8_t>(plan.ReadAddress, bytes);
+					uint8_t* to = memory.ToArray<uint8_t>(plan.WriteAddress, bytes);
+					
+					// nothing was written over the last element when the loop reads it
+					uint32_t last = LoadElement(from + ElementOffset(idiom, iterations, iterations - 1), idiom.Size);
+					if (!GuestLayout::Swizzled || (idiom.Size == 4 && ((plan.ReadAddress | plan.WriteAddress) & 3) == 0))
+					{
+						memmove(to, from, bytes);
+					}
+					else
+					{
+						for (uint32_t i = 0; i < iterations; i++)
+						{
+							uint32_t offset = ElementOffset(idiom, iterations, i);
+							StoreElement(to + offset, idiom.Size, LoadElement(from + offset, idiom.Size));
+						}
+					}
+					
+					state.gpr[idiom.Value] = last;
+					state.gpr[idiom.Source] += advance;
+					state.gpr[idiom.Destination] += advance;
+					break;
+				}
+				
+				case LoopIdiom::Fill:
+				{
+					uint8_t* to = memory.ToArray<uint8_t>(plan.WriteAddress, bytes);
+					uint32_t value = state.gpr[idiom.Value];
+					uint8_t byte = static_cast<uint8_t>(value);
+					bool uniform = idiom.Size == 1
+						|| (idiom.Size == 2 && (value & 0xffff) == byte * 0x0101u)
+						|| (idiom.Size == 4 && value == byte * 0x01010101u);
+					
+					// in swizzled memory, only whole words are in the same place for the host
+					if (uniform && (!GuestLayout::Swizzled || ((plan.WriteAddress | bytes) & 3) == 0))
+					{
+						memset(to, byte, bytes);
+					}
+					else
+					{
+						for (uint32_t i = 0; i < iterations; i++)
+							StoreElement(to + i * idiom.Size, idiom.Size, value);
+					}
+					
+					state.gpr[idiom.Destination] += advance;
+					break;
+				}
+				
+				case LoopIdiom::Sum:
+				{
+					const uint8_t* from = memory.ToArray<const uint8_t>(plan.ReadAddress, bytes);
+					uint32_t accumulator = state.gpr[idiom.Accumulator];
+					uint32_t element = 0;
+					for (uint32_t i = 0; i < iterations; i++)
+					{
+						element = LoadElement(from + ElementOffset(idiom, iterations, i), idiom.Size);
+						accumulator = idiom.Xor ? accumulator ^ element : accumulator + element;
+					}
+					
+					state.gpr[idiom.Accumulator] = accumulator;
+					state.gpr[idiom.Value] = element;
+					state.gpr[idiom.Source] += advance;
+					break;
+				}
+				
+				case LoopIdiom::Scan:
+				{
+					uint32_t address = state.gpr[idiom.Source] + advance;
+					state.gpr[idiom.Value] = *GuestLayout::Byte(memory.ToPointer<const uint8_t>(address));
+					state.gpr[idiom.Source] = address;
+					
+					// the CR field is whatever the last comparison left
+					Dispatch(idiom.Compare);
+					break;
+				}
+			}
+			
+			if (idiom.Counted)
+				state.ctr -= iterations;
+		}
+		
+		uint32_t Interpreter::StepLoop(const LoopIdiom& idiom)
+		{
+			const UInt32* begin = allocator.ToPointer<const UInt32>(idiom.Address);
+			const UInt32* end = allocator.ToPointer<const UInt32>(idiom.Exit);
+			uint32_t iterations = 0;
+			
+			for (;;)
+			{
+				for (currentAddress = begin; currentAddress != end; currentAddress++)
+					Dispatch(currentAddress->Get());
+				iterations++;
+				
+				// an interrupt that came in meanwhile stays there for the caller
+				const UInt32* expected = begin;
+				if (!branchAddress.compare_exchange_strong(expected, nullptr))
+					break;
+			}
+			
+			currentAddress = begin;
+			return iterations;
+		}
+		
+		void Interpreter::VerifyLoop(const LoopIdiom& idiom, const LoopPlan& plan)
+		{
+			// In swizzled memory, the bytes of a partial word aren't where they seem to be, so the whole words
+			// are kept.
+			uint32_t low = plan.WriteAddress;
+			uint32_t high = plan.WriteAddress + plan.WriteSize;
+			if (GuestLayout::Swizzled && plan.WriteSize != 0)
+			{
+				low &= ~3;
+				high = (high + 3) & ~3;
+			}
+			
+			// This runs under the interpreter's fault handler, so nothing that needs a destructor may exist while the
+			// loop runs. The copies are members, and they're sized before guest memory is read into them.
+			uint8_t* written = plan.WriteSize == 0 ? nullptr : memory.ToArray<uint8_t>(low, high - low);
+			verifyOriginal.resize(high - low);
+			verifyExpected.resize(high - low);
+			std::copy(written, written + (high - low), verifyOriginal.begin());
+			MachineState before = state;
+			
+			// run the idiom, put everything back, then go through the loop one instruction at a time
+			RunLoop(idiom, plan);
+			MachineState expected = state;
+			std::copy(written, written + (high - low), verifyExpected.begin());
+			
+			state = before;
+			std::copy(verifyOriginal.begin(), verifyOriginal.end(), written);
+			uint32_t iterations = StepLoop(idiom);
+			
+			// both runs have touched everything that's compared below, so nothing past this point can fault
+			std::stringstream differences;
+			if (iterations != plan.Iterations)
+				differences << " iterations (" << plan.Iterations << " instead of " << iterations << ")";
+			
+			for (int i = 0; i < 32; i++)
+			{
+				if (expected.gpr[i] != state.gpr[i])
+					differences << " r" << i << " (0x" << std::hex << expected.gpr[i] << " instead of 0x" << state.gpr[i] << ")" << std::dec;
+			}
+			
+			if (memcmp(expected.cr, state.cr, sizeof state.cr) != 0)
+				differences << " cr";
+			
+			if (expected.xer != state.xer)
+				differences << " xer";
+			
+			if (expected.ctr != state.ctr)
+				differences << " ctr (" << expected.ctr << " instead of " << state.ctr << ")";
+			
+			if (!std::equal(verifyExpected.begin(), verifyExpected.end(), written))
+				differences << " memory";
+			
+			std::string result = differences.str();
+			if (result.length() != 0)
+			{
+				std::stringstream message;
+				message << idiom.GetName() << " loop at 0x" << std::hex << idiom.Address << " doesn't match step-by-step execution:" << result;
+				Panic(message.str());
+			}
+		}
+		
+		void Interpreter::loop(const DecodedInstruction& inst)
+		{
+			const LoopIdiom& idiom = loopIdioms[inst.Address];
+			LoopPlan plan;
+			if (!PlanLoop(idiom, plan))
+			{
+				// one iteration at a time, like any other block
+				(this->*inst.Method)(inst.Inst);
+				return;
+			}
+			
+			if (verifyIdioms)
+				VerifyLoop(idiom, plan);
+			else
+				RunLoop(idiom, plan);
+			
+			SetBranchAddress(idiom.Exit);
+		}
+	}
+}
@@ -0,0 +1,86 @@
+//
+// LoopIdioms.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__LoopIdioms__
+#define __Classix__LoopIdioms__
+
+#include <cstdint>
+#include "BigEndian.h"
+#include "Instruction.h"
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		// A loop that is a whole block branching back to its own start, and that does something the host has a
+		// library function for. The interpreter runs all of its iterations at once, and leaves registers and memory
+		// just like running them one by one would have:
+		//	Copy:	lXzu rT, d(rS); stXu rT, d(rD); bdnz			(memcpy, in either direction)
+		//	Fill:	stXu rT, d(rD); bdnz							(memset)
+		//	Scan:	lbzu rT, d(rS); cmp[l]w[i] crF, rT, x; bdnzf/bf eq	(memchr, strlen)
+		//	Sum:	lXzu rT, d(rS); add/xor rA, rA, rT; bdnz		(checksums)
+		// X is b, h or w, and d is the element size or its negative.
+		struct LoopIdiom
+		{
+			enum IdiomKind : uint8_t
+			{
+				Copy,
+				Fill,
+				Scan,
+				Sum,
+			};
+			
+			IdiomKind Kind;
+			uint8_t Size;
+			int8_t Step;
+			uint8_t Value;
+			uint8_t Source;
+			uint8_t Destination;
+			uint8_t Accumulator;
+			bool Xor;
+			bool Counted;
+			Instruction Compare; // replayed once the scan is over, to set the CR field
+			uint32_t Address;
+			uint32_t Exit;
+			
+			LoopIdiom();
+			const char* GetName() const;
+		};
+		
+		// What running a loop idiom from the current state would do. Addresses are the lowest that the loop goes
+		// through; only Copy and Fill loops write anything.
+		struct LoopPlan
+		{
+			uint32_t Iterations;
+			uint32_t ReadAddress;
+			uint32_t WriteAddress;
+			uint32_t WriteSize;
+		};
+		
+		// code points to a decoded block of length instructions, at guest address address
+		bool MatchLoopIdiom(const Common::UInt32* code, uint32_t length, uint32_t address, LoopIdiom& idiom);
+		
+		// $CLASSIX_VERIFY_IDIOMS checks every loop idiom against step-by-step execution, unless it's 0
+		bool IdiomVerificationRequested();
+	}
+}
+
+#endif /* defined(__Classix__LoopIdioms__) */
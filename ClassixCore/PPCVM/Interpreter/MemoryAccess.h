@@ -0,0 +1,159 @@
+//
+// MemoryAccess.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__MemoryAccess__
+#define __Classix__MemoryAccess__
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include "Allocator.h"
+#include "FlatAllocator.h"
+#include "NativeAllocator.h"
+#include "AccessViolationException.h"
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		// Memory access policies turn guest addresses into host pointers for the interpreter's loads and stores.
+		// The policy is chosen at compile time, so that the translation inlines into each handler instead of going
+		// through the virtual Allocator::IntPtrToPointer.
+		
+		// Validates every access against the allocator. Slow, but bad accesses become AccessViolationExceptions.
+		class CheckedMemoryAccess
+		{
+			Common::Allocator& allocator;
+			
+		public:
+			explicit CheckedMemoryAccess(Common::Allocator& allocator)
+			: allocator(allocator)
+			{ }
+			
+			template<typename T>
+			inline T* ToPointer(uint32_t address) const
+			{
+				Common::AccessViolationException::Check(allocator, address, sizeof(T));
+				return allocator.ToPointer<T>(address);
+			}
+			
+			template<typename T>
+			inline T* ToArray(uint32_t address, size_t count) const
+			{
+				Common::AccessViolationException::Check(allocator, address, sizeof(T) * count);
+				return allocator.ToArray<T>(address, count);
+			}
+			
+			// cache hints never fault, so they get nullptr instead of an exception
+			inline const void* ToHint(uint32_t address) const
+			{
+				return allocator.IsAllocated(address) ? allocator.ToPointer<const uint8_t>(address) : nullptr;
+			}
+		};
+		
+		// Guest addresses are host addresses. Only valid with the NativeAllocator, on 32-bits hosts.
+		class UncheckedMemoryAccess
+		{
+			static void CheckAllocator(Common::Allocator& allocator)
+			{
+				if (sizeof(void*) != sizeof(uint32_t))
+					throw std::logic_error("Guest addresses are only host addresses in a 32-bits environment");
+				if (dynamic_cast<Common::NativeAllocator*>(&allocator) == nullptr)
+					throw std::logic_error("Unchecked memory access needs a NativeAllocator");
+			}
+			
+		public:
+			explicit UncheckedMemoryAccess(Common::Allocator& allocator)
+			{
+				CheckAllocator(allocator);
+			}
+			
+			template<typename T>
+			inline T* ToPointer(uint32_t address) const
+			{
+				return reinterpret_cast<T*>(static_cast<uintptr_t>(address));
+			}
+			
+			template<typename T>
+			inline T* ToArray(uint32_t address, size_t) const
+			{
+				return ToPointer<T>(address);
+			}
+			
+			inline const void* ToHint(uint32_t address) const
+			{
+				return ToPointer<const uint8_t>(address);
+			}
+		};
+		
+		// Guest addresses are offsets into the arena of a FlatAllocator. Address 0 needs no special case, since the
+		// bottom of the arena is never mapped.
+		class FlatMemoryAccess
+		{
+			uint8_t* base;
+			
+			static uint8_t* GetArenaBase(Common::Allocator& allocator)
+			{
+				if (auto flat = dynamic_cast<Common::FlatAllocator*>(&allocator))
+					return flat->GetBase();
+				throw std::logic_error("Flat memory access needs a FlatAllocator");
+			}
+			
+		public:
+			explicit FlatMemoryAccess(Common::Allocator& allocator)
+			: base(GetArenaBase(allocator))
+			{ }
+			
+			inline uint8_t* GetBase() const
+			{
+				return base;
+			}
+			
+			template<typename T>
+			inline T* ToPointer(uint32_t address) const
+			{
+				return reinterpret_cast<T*>(base + address);
+			}
+			
+			template<typename T>
+			inline T* ToArray(uint32_t address, size_t) const
+			{
+				return ToPointer<T>(address);
+			}
+			
+			inline const void* ToHint(uint32_t address) const
+			{
+				return ToPointer<const uint8_t>(address);
+			}
+		};
+		
+		// Define CLASSIX_CHECKED_MEMORY_ACCESS to get a checked release build.
+#if defined(DEBUG) || defined(CLASSIX_CHECKED_MEMORY_ACCESS)
+		typedef CheckedMemoryAccess DefaultMemoryAccess;
+#elif defined(__LP64__)
+		typedef FlatMemoryAccess DefaultMemoryAccess;
+#else
+		typedef UncheckedMemoryAccess DefaultMemoryAccess;
+#endif
+	}
+}
+
+#endif /* defined(__Classix__MemoryAccess__) */
@@ -0,0 +1,125 @@
+//
+// MemoryFaultHandler.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include "MemoryFaultHandler.h"
+#include "FlatAllocator.h"
+#include <cstring>
+#include <stdexcept>
+#include <signal.h>
+#include <pthread.h>
+
+namespace
+{
+	using namespace PPCVM::Execution;
+	
+	pthread_once_t installOnce = PTHREAD_ONCE_INIT;
+	pthread_key_t innermostScope;
+	struct sigaction previousSegv;
+	struct sigaction previousBus;
+	
+	void OnFault(int signal, siginfo_t* info, void* context)
+	{
+		// writes to watched code are retried, wherever they come from
+		if (Common::FlatAllocator::HandleWriteFault(info->si_addr))
+			return;
+		
+		if (MemoryFaultHandler::HandleFault(info->si_addr))
+			return;
+		
+		// not ours: hand it to whoever had it before, or let it crash the usual way
+		const struct sigaction& previous = signal == SIGSEGV ? previousSegv : previousBus;
+		if (previous.sa_flags & SA_SIGINFO)
+			previous.sa_sigaction(signal, info, context);
+		else if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN)
+			previous.sa_handler(signal);
+		else
+			sigaction(signal, &previous, nullptr);
+	}
+	
+	void Install()
+	{
+		if (pthread_key_create(&innermostScope, nullptr) != 0)
+			throw std::runtime_error("could not create the fault handler scope key");
+		
+		// SA_NODEFER, because siglongjmp out of the handler doesn't restore the signal mask
+		struct sigaction action;
+		memset(&action, 0, sizeof action);
+		action.sa_sigaction = &OnFault;
+		action.sa_flags = SA_SIGINFO | SA_NODEFER;
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGSEGV, &action, &previousSegv);
+		sigaction(SIGBUS, &action, &previousBus);
+	}
+}
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		MemoryFaultHandler::Scope::Scope(const MemoryFaultHandler* handler)
+		: handler(handler), faultAddress(0)
+		{
+			outer = static_cast<Scope*>(pthread_getspecific(innermostScope));
+			pthread_setspecific(innermostScope, this);
+		}
+		
+		MemoryFaultHandler::Scope::~Scope()
+		{
+			pthread_setspecific(innermostScope, outer);
+		}
+		
+		MemoryFaultHandler::MemoryFaultHandler(const Common::Allocator& allocator)
+		{
+			// guest addresses are offsets into the flat arena, or host addresses on 32-bits hosts
+			if (auto flat = dynamic_cast<const Common::FlatAllocator*>(&allocator))
+			{
+				guestBase = reinterpret_cast<uintptr_t>(flat->GetBase());
+				guestSize = static_cast<uintptr_t>(Common::FlatAllocator::ArenaSize);
+			}
+			else if (sizeof(void*) == sizeof(uint32_t))
+			{
+				guestBase = 0;
+				guestSize = UINTPTR_MAX;
+			}
+			else
+			{
+				guestBase = 0;
+				guestSize = 0;
+			}
+			
+			pthread_once(&installOnce, &Install);
+		}
+		
+		bool MemoryFaultHandler::HandleFault(const void* hostAddress)
+		{
+			Scope* scope = static_cast<Scope*>(pthread_getspecific(innermostScope));
+			if (scope == nullptr || scope->handler == nullptr)
+				return false;
+			
+			uintptr_t offset = reinterpret_cast<uintptr_t>(hostAddress) - scope->handler->guestBase;
+			if (offset >= scope->handler->guestSize)
+				return false;
+			
+			scope->faultAddress = static_cast<uint32_t>(offset);
+			siglongjmp(scope->Target, 1);
+		}
+	}
+}
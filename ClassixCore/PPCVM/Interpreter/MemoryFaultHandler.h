@@ -0,0 +1,78 @@
+//
+// MemoryFaultHandler.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__MemoryFaultHandler__
+#define __Classix__MemoryFaultHandler__
+
+#include <cstdint>
+#include <csetjmp>
+#include "Allocator.h"
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		// Turns SIGSEGV and SIGBUS on guest memory into something the interpreter can report, so that release builds
+		// catch bad guest pointers without checking every access. This works because the FlatAllocator leaves
+		// everything that isn't allocated inaccessible.
+		// A fault jumps back to the innermost Scope of the faulting thread with siglongjmp. That's only safe because
+		// instruction handlers don't own anything that needs to be destroyed; native calls open a Scope without a
+		// handler, so that faults in library code go to whoever handled them before.
+		// Writes to code that the FlatAllocator watches fault too; these are resolved before anything else.
+		class MemoryFaultHandler
+		{
+			uintptr_t guestBase;
+			uintptr_t guestSize;
+			
+		public:
+			class Scope
+			{
+				friend class MemoryFaultHandler;
+				
+				const MemoryFaultHandler* handler;
+				Scope* outer;
+				volatile uint32_t faultAddress;
+				
+			public:
+				sigjmp_buf Target;
+				
+				explicit Scope(const MemoryFaultHandler* handler);
+				Scope(const Scope& that) = delete;
+				
+				// the guest address that faulted, once Target has been jumped to
+				inline uint32_t GetFaultAddress() const
+				{
+					return faultAddress;
+				}
+				
+				~Scope();
+			};
+			
+			// installs the signal handlers the first time
+			explicit MemoryFaultHandler(const Common::Allocator& allocator);
+			MemoryFaultHandler(const MemoryFaultHandler& that) = delete;
+			
+			static bool HandleFault(const void* hostAddress);
+		};
+	}
+}
+
+#endif /* defined(__Classix__MemoryFaultHandler__) */
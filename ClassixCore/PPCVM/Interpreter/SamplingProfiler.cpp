@@ -0,0 +1,104 @@
+//
+// SamplingProfiler.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include "SamplingProfiler.h"
+#include "Interpreter.h"
+#include <cstdlib>
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		bool SamplingProfiler::Sample::operator<(const Sample& that) const
+		{
+			if (Native != that.Native)
+				return Native < that.Native;
+			return Stack < that.Stack;
+		}
+		
+		std::string SamplingProfiler::DefaultPath()
+		{
+			if (const char* path = getenv("CLASSIX_PROFILE"))
+				return path;
+			return "";
+		}
+		
+		SamplingProfiler::SamplingProfiler(Interpreter& interpreter, std::chrono::microseconds interval)
+		: interpreter(interpreter), interval(interval), stopping(false)
+		{
+			interpreter.SetProfiler(this);
+			sampler = std::thread(&SamplingProfiler::SampleLoop, this);
+		}
+		
+		SamplingProfiler::~SamplingProfiler()
+		{
+			Stop();
+		}
+		
+		void SamplingProfiler::SampleLoop()
+		{
+			std::unique_lock<std::mutex> guard(samplerLock);
+			while (!stopping)
+			{
+				samplerWakeUp.wait_for(guard, interval);
+				
+				uint32_t returnAddress;
+				if (const NativeCall* call = interpreter.GetActiveNativeCall(returnAddress))
+				{
+					Sample sample;
+					sample.Native = reinterpret_cast<const void*>(&call->Callback);
+					sample.Stack.push_back(returnAddress);
+					AddSample(std::move(sample));
+				}
+				else
+				{
+					// this fails when the interpreter isn't in Execute(), or is already branching somewhere
+					interpreter.RequestSample();
+				}
+			}
+		}
+		
+		void SamplingProfiler::AddSample(Sample&& sample)
+		{
+			std::lock_guard<std::mutex> guard(samplesLock);
+			samples[std::move(sample)]++;
+		}
+		
+		std::map<SamplingProfiler::Sample, uint64_t> SamplingProfiler::Stop()
+		{
+			if (sampler.joinable())
+			{
+				{
+					std::lock_guard<std::mutex> guard(samplerLock);
+					stopping = true;
+				}
+				samplerWakeUp.notify_one();
+				sampler.join();
+				interpreter.SetProfiler(nullptr);
+			}
+			
+			std::lock_guard<std::mutex> guard(samplesLock);
+			std::map<Sample, uint64_t> result;
+			result.swap(samples);
+			return result;
+		}
+	}
+}
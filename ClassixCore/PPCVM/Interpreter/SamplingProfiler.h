@@ -0,0 +1,88 @@
+//
+// SamplingProfiler.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__SamplingProfiler__
+#define __Classix__SamplingProfiler__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		class Interpreter;
+		
+		// Periodically asks an interpreter where it is. When the interpreter is running guest code, the request is
+		// delivered like an interrupt: the interpreter picks it up after its current instruction, records the PC and
+		// the return addresses it finds on the guest stack, and carries on. Between samples, this costs nothing to
+		// the interpreter. When the interpreter is inside a native call, the sampler thread records the call
+		// itself, since the interpreter isn't going to answer until it returns.
+		class SamplingProfiler
+		{
+		public:
+			// Guest addresses, innermost first. Native is the NativeCallback of the call that was running, if any;
+			// then Stack starts with the guest address the call returns to.
+			struct Sample
+			{
+				const void* Native;
+				std::vector<uint32_t> Stack;
+				
+				bool operator<(const Sample& that) const;
+			};
+			
+		private:
+			Interpreter& interpreter;
+			std::chrono::microseconds interval;
+			
+			std::mutex samplesLock;
+			std::map<Sample, uint64_t> samples;
+			
+			std::mutex samplerLock;
+			std::condition_variable samplerWakeUp;
+			bool stopping;
+			std::thread sampler;
+			
+			void SampleLoop();
+			
+		public:
+			// $CLASSIX_PROFILE, or an empty string when profiling is off
+			static std::string DefaultPath();
+			
+			SamplingProfiler(Interpreter& interpreter, std::chrono::microseconds interval);
+			SamplingProfiler(const SamplingProfiler& that) = delete;
+			~SamplingProfiler();
+			
+			void AddSample(Sample&& sample);
+			
+			// stops sampling and hands out what was collected
+			std::map<Sample, uint64_t> Stop();
+		};
+	}
+}
+
+#endif /* defined(__Classix__SamplingProfiler__) */
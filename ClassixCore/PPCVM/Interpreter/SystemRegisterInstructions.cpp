@@ -38,6 +38,7 @@
 //
 
 #include <cassert>
+#include <cstring>
 #include <sstream>
 #include "Interpreter.h"
 #include "InvalidInstructionException.h"
@@ -73,6 +74,16 @@ namespace
 	{
 		state.cr[field] = value;
 	}
+	
+	// FEX and VX are summaries, and can't be written directly
+	const uint32_t FPSCRSummaryBits = 0x60000000;
+	// FX and the exception bits, which mcrfs clears
+	const uint32_t FPSCRStickyBits = 0x9ff80700;
+	
+	inline uint32_t FPSCRFieldMask(int field)
+	{
+		return 0xf0000000 >> (field * 4);
+	}
 }
 
 namespace PPCVM
@@ -83,56 +94,62 @@ namespace PPCVM
 		{
 			SetCRBit(state, inst.CRBD, GetCRBit(state, inst.CRBA) & GetCRBit(state, inst.CRBB));
 		}
-
+		
 		void Interpreter::crandc(Instruction inst)
 		{
 			SetCRBit(state, inst.CRBD, GetCRBit(state, inst.CRBA) & (1 ^ GetCRBit(state, inst.CRBB)));
 		}
-
+		
 		void Interpreter::creqv(Instruction inst)
 		{
 			SetCRBit(state, inst.CRBD, 1 ^ (GetCRBit(state, inst.CRBA) ^ GetCRBit(state, inst.CRBB)));
 		}
-
+		
 		void Interpreter::crnand(Instruction inst)
 		{
 			SetCRBit(state, inst.CRBD, 1 ^ (GetCRBit(state, inst.CRBA) & GetCRBit(state, inst.CRBB)));
 		}
-
+		
 		void Interpreter::crnor(Instruction inst)
 		{
 			SetCRBit(state, inst.CRBD, 1 ^ (GetCRBit(state, inst.CRBA) | GetCRBit(state, inst.CRBB)));
 		}
-
+		
 		void Interpreter::cror(Instruction inst)
 		{
 			SetCRBit(state, inst.CRBD, (GetCRBit(state, inst.CRBA) | GetCRBit(state, inst.CRBB)));
 		}
-
+		
 		void Interpreter::crorc(Instruction inst)
 		{
 			SetCRBit(state, inst.CRBD, (GetCRBit(state, inst.CRBA) | (1 ^ GetCRBit(state, inst.CRBB))));
 		}
-
+		
 		void Interpreter::crxor(Instruction inst)
 		{
 			SetCRBit(state, inst.CRBD, (GetCRBit(state, inst.CRBA) ^ GetCRBit(state, inst.CRBB)));
 		}
-
+		
 		void Interpreter::isync(Instruction inst)
 		{
+			// isync ends its block, so the next instruction is fetched after the writes are applied
 			__sync_synchronize();
+			allocator.DispatchCodeWrites();
 		}
-
+		
 		void Interpreter::mcrf(Instruction inst)
 		{
 			uint8_t cr_f = GetCRField(state, inst.CRFS);
 			SetCRField(state, inst.CRFD, cr_f);
 		}
-
+		
 		void Interpreter::mcrfs(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			flags.MaterializeFloatingPoint(state);
+			uint32_t mask = FPSCRFieldMask(inst.CRFS);
+			SetCRField(state, inst.CRFD, (state.fpscr.hex & mask) >> (28 - inst.CRFS * 4));
+			state.fpscr.hex &= ~(mask & FPSCRStickyBits);
+			LazyFlags::UpdateFloatingPointSummary(state);
 		}
 		
 		void Interpreter::mcrxr(Instruction inst)
@@ -146,36 +163,44 @@ namespace PPCVM
 			state.gpr[inst.RD] = state.GetCR();
 		}
 		
+		template<bool Rc>
 		void Interpreter::mffsx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			flags.MaterializeFloatingPoint(state);
+			uint64_t bits = 0xfff8000000000000ull | state.fpscr.hex;
+			memcpy(&state.fpr[inst.FD], &bits, sizeof bits);
+			if (Rc) UpdateCR1();
 		}
 		
 		void Interpreter::mfspr(Instruction inst)
 		{
-			uint8_t spr = static_cast<uint8_t>((inst.RB << 5) | inst.RA);
+			uint16_t spr = static_cast<uint16_t>((inst.RB << 5) | inst.RA);
 			switch (spr)
 			{
 				case 1: // xer
 					state.gpr[inst.RD] = state.xer;
 					break;
-					
+				
 				case 4: // rtcu
 					state.gpr[inst.RD] = state.GetRTCU();
 					break;
-					
+				
 				case 5: // rtcl
 					state.gpr[inst.RD] = state.GetRTCL();
 					break;
-					
+				
 				case 8: // lr
 					state.gpr[inst.RD] = state.lr;
 					break;
-					
+				
 				case 9: // ctr
 					state.gpr[inst.RD] = state.ctr;
 					break;
-					
+				
+				case 256: // vrsave
+					state.gpr[inst.RD] = state.vrsave;
+					break;
+				
 				default:
 				{
 					std::stringstream message;
@@ -209,43 +234,86 @@ namespace PPCVM
 			}
 		}
 		
+		template<bool Rc>
 		void Interpreter::mtfsb0x(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			flags.MaterializeFloatingPoint(state);
+			uint32_t bit = 0x80000000 >> inst.CRBD;
+			state.fpscr.hex &= ~(bit & ~FPSCRSummaryBits);
+			LazyFlags::UpdateFloatingPointSummary(state);
+			flags.LoadRoundingMode(state);
+			if (Rc) UpdateCR1();
 		}
 		
+		template<bool Rc>
 		void Interpreter::mtfsb1x(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			flags.MaterializeFloatingPoint(state);
+			uint32_t bit = 0x80000000 >> inst.CRBD;
+			if (bit & FPSCRStickyBits & ~0x80000000)
+				LazyFlags::RaiseFloatingPointExceptions(state, bit);
+			else
+			{
+				state.fpscr.hex |= bit & ~FPSCRSummaryBits;
+				LazyFlags::UpdateFloatingPointSummary(state);
+			}
+			flags.LoadRoundingMode(state);
+			if (Rc) UpdateCR1();
 		}
 		
+		template<bool Rc>
 		void Interpreter::mtfsfix(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			flags.MaterializeFloatingPoint(state);
+			uint32_t mask = FPSCRFieldMask(inst.CRFD) & ~FPSCRSummaryBits;
+			uint32_t value = ((inst.hex >> 12) & 0xf) << (28 - inst.CRFD * 4);
+			state.fpscr.hex = (state.fpscr.hex & ~mask) | (value & mask);
+			LazyFlags::UpdateFloatingPointSummary(state);
+			flags.LoadRoundingMode(state);
+			if (Rc) UpdateCR1();
 		}
 		
+		template<bool Rc>
 		void Interpreter::mtfsfx(Instruction inst)
 		{
-			throw InvalidInstructionException(inst);
+			flags.MaterializeFloatingPoint(state);
+			uint32_t mask = 0;
+			for (int field = 0; field < 8; field++)
+			{
+				if (inst.FM & (0x80 >> field))
+					mask |= FPSCRFieldMask(field);
+			}
+			mask &= ~FPSCRSummaryBits;
+			
+			uint64_t bits;
+			memcpy(&bits, &state.fpr[inst.FB], sizeof bits);
+			state.fpscr.hex = (state.fpscr.hex & ~mask) | (static_cast<uint32_t>(bits) & mask);
+			LazyFlags::UpdateFloatingPointSummary(state);
+			flags.LoadRoundingMode(state);
+			if (Rc) UpdateCR1();
 		}
 		
 		void Interpreter::mtspr(Instruction inst)
 		{
-			uint8_t spr = static_cast<uint8_t>((inst.RB << 5) | inst.RA);
+			uint16_t spr = static_cast<uint16_t>((inst.RB << 5) | inst.RA);
 			switch (spr)
 			{
 				case 1: // xer
 					state.xer = state.gpr[inst.RD];
 					break;
-					
+				
 				case 8: // lr
 					state.lr = state.gpr[inst.RD];
 					break;
-					
+				
 				case 9: // ctr
 					state.ctr = state.gpr[inst.RD];
 					break;
-					
+				
+				case 256: // vrsave
+					state.vrsave = state.gpr[inst.RD];
+					break;
+				
 				default:
 				{
 					std::stringstream message;
@@ -254,5 +322,13 @@ namespace PPCVM
 				}
 			}
 		}
+		
+#pragma mark -
+#pragma mark Variants
+		INSTANTIATE_RC(Interpreter, mffsx);
+		INSTANTIATE_RC(Interpreter, mtfsb0x);
+		INSTANTIATE_RC(Interpreter, mtfsb1x);
+		INSTANTIATE_RC(Interpreter, mtfsfix);
+		INSTANTIATE_RC(Interpreter, mtfsfx);
 	}
 }
@@ -0,0 +1,143 @@
+//
+// ExecutionCountersTests.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include <map>
+#include <new>
+#include <sstream>
+#include "UnitTest.h"
+#include "GuestMachine.h"
+#include "ExecutionCounters.h"
+#include "NativeCall.h"
+
+using namespace Encode;
+using PPCVM::Execution::ExecutionCounters;
+using PPCVM::Execution::NativeCall;
+
+namespace
+{
+	void Increment(void*, PPCVM::MachineState* state)
+	{
+		state->r3++;
+	}
+	
+	struct Report
+	{
+		uint64_t total;
+		std::map<std::string, uint64_t> slots;
+		uint64_t nativeFunctions;
+		uint64_t nativeCalls;
+	};
+	
+	Report ReadReport(const ExecutionCounters& counters)
+	{
+		std::stringstream text;
+		counters.WriteReport(text);
+		
+		Report report;
+		std::string line;
+		std::getline(text, line);
+		report.total = std::stoull(line);
+		std::getline(text, line); // header
+		while (std::getline(text, line) && !line.empty())
+		{
+			std::stringstream fields(line);
+			uint64_t count;
+			double percent;
+			std::string slot;
+			fields >> count >> percent >> slot;
+			report.slots[slot] = count;
+		}
+		
+		std::getline(text, line);
+		report.nativeFunctions = std::stoull(line);
+		std::getline(text, line); // header
+		report.nativeCalls = 0;
+		while (std::getline(text, line) && !line.empty())
+		{
+			std::stringstream fields(line);
+			uint64_t calls;
+			fields >> calls;
+			report.nativeCalls += calls;
+		}
+		return report;
+	}
+}
+
+TEST(ExecutionCounters, CountsDispatchSlotsAndNativeCalls)
+{
+	GuestMachine machine;
+	Common::Allocator& allocator = machine.allocator;
+	uint8_t* callMemory = allocator.Allocate("Native call", sizeof(NativeCall));
+	new (callMemory) NativeCall(Increment);
+	uint32_t call = allocator.ToIntPtr(callMemory);
+	
+	ExecutionCounters counters;
+	machine.interpreter.SetCounters(&counters);
+	machine.Load({
+		Mfspr(31, 8),					// mflr r31
+		D(15, 12, 0, call >> 16),		// lis r12, call@h
+		D(24, 12, 12, call & 0xffff),	// ori r12, r12, call@l
+		D(14, 5, 0, 3),					// li r5, 3
+		Mtspr(9, 12),					// loop: mtctr r12
+		Bctrl,							// bctrl
+		D(13, 5, 5, -1),				// addic. r5, r5, -1
+		BC(4, 2, -12),					// bne loop
+		Mtspr(8, 31),					// mtlr r31
+		Blr,
+	});
+	machine.Run();
+	machine.interpreter.SetCounters(nullptr);
+	allocator.Deallocate(callMemory);
+	CHECK_EQUAL(machine.state.r3, 3u);
+	
+	Report report = ReadReport(counters);
+	CHECK_EQUAL(report.total, 18u);
+	CHECK_EQUAL(report.slots.size(), 9u);
+	CHECK_EQUAL(report.slots["31/339"], 1u);
+	CHECK_EQUAL(report.slots["15"], 1u);
+	CHECK_EQUAL(report.slots["24"], 1u);
+	CHECK_EQUAL(report.slots["14"], 1u);
+	CHECK_EQUAL(report.slots["31/467"], 4u); // mtctr and mtlr share a slot
+	CHECK_EQUAL(report.slots["19/528"], 3u);
+	CHECK_EQUAL(report.slots["13"], 3u);
+	CHECK_EQUAL(report.slots["16"], 3u);
+	CHECK_EQUAL(report.slots["19/16"], 1u);
+	CHECK_EQUAL(report.nativeFunctions, 1u);
+	CHECK_EQUAL(report.nativeCalls, 3u);
+}
+
+TEST(ExecutionCounters, SteppingDoesntCount)
+{
+	GuestMachine machine;
+	ExecutionCounters counters;
+	machine.interpreter.SetCounters(&counters);
+	machine.Load({
+		D(14, 3, 0, 1),					// li r3, 1
+		Blr,
+	});
+	machine.Step();
+	machine.interpreter.SetCounters(nullptr);
+	
+	Report report = ReadReport(counters);
+	CHECK_EQUAL(report.total, 0u);
+	CHECK_EQUAL(report.nativeFunctions, 0u);
+}
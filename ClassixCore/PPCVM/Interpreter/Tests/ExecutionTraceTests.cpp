@@ -0,0 +1,74 @@
+//
+// ExecutionTraceTests.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <unistd.h>
+#include "UnitTest.h"
+#include "ExecutionTrace.h"
+
+using PPCVM::Execution::ExecutionTrace;
+using PPCVM::Execution::TraceRecord;
+
+TEST(ExecutionTrace, ThreadsKeepTheirRecordsInOrder)
+{
+	char path[] = "/tmp/ExecutionTraceTests.XXXXXX";
+	int fd = mkstemp(path);
+	CHECK(fd != -1);
+	close(fd);
+	
+	// more records than a ring holds, so that both threads have to wait for the writer
+	const uint32_t recordCount = 200000;
+	{
+		ExecutionTrace trace(path);
+		ExecutionTrace::Ring* rings[] = {trace.CreateRing(), trace.CreateRing()};
+		auto produce = [&](uint32_t ring) {
+			for (uint32_t i = 0; i < recordCount; i++)
+				rings[ring]->RecordInstruction(i, ring);
+		};
+		
+		std::thread first(produce, 0);
+		std::thread second(produce, 1);
+		first.join();
+		second.join();
+	}
+	
+	FILE* input = fopen(path, "rb");
+	uint32_t expected[2] = {0, 0};
+	uint32_t ring = UINT32_MAX;
+	bool ordered = true;
+	TraceRecord record;
+	while (fread(&record, sizeof record, 1, input) == 1)
+	{
+		if (record.Kind == TraceRecord::Thread)
+			ring = record.Address;
+		else if (ring > 1 || record.Kind != TraceRecord::Instruction || record.Value != ring || record.Address != expected[ring]++)
+			ordered = false;
+	}
+	fclose(input);
+	unlink(path);
+	
+	CHECK(ordered);
+	CHECK_EQUAL(expected[0], recordCount);
+	CHECK_EQUAL(expected[1], recordCount);
+}
@@ -0,0 +1,200 @@
+//
+// FloatingPointTests.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include <cfenv>
+#include <cmath>
+#include <sstream>
+#include "UnitTest.h"
+#include "GuestMachine.h"
+#include "FloatingPointStatus.h"
+
+using namespace Encode;
+
+namespace
+{
+	inline uint32_t Lfd(uint32_t frt, int32_t offset)
+	{
+		return D(50, frt, 2, offset);
+	}
+	
+	inline uint32_t Mffs(uint32_t frt)
+	{
+		return FX(63, 583, frt, 0, 0);
+	}
+	
+	inline uint32_t Mtfsfi(uint32_t field, uint32_t value)
+	{
+		return 63u << 26 | field << 23 | value << 12 | 134u << 1;
+	}
+	
+	// mffs and fctiw put their result in the low word of the register
+	inline uint32_t LowWord(double value)
+	{
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof bits);
+		return static_cast<uint32_t>(bits);
+	}
+	
+	inline uint32_t FPRF(uint32_t fpscr)
+	{
+		return (fpscr & static_cast<uint32_t>(FloatingPointStatus::FPRF)) >> 12;
+	}
+	
+	struct Outcome
+	{
+		double fpr[32];
+		uint32_t fpscr;
+		uint32_t cr;
+	};
+	
+	Outcome Run(bool step, const std::vector<uint32_t>& program, const std::vector<double>& data)
+	{
+		GuestMachine machine;
+		machine.Load(program);
+		for (size_t i = 0; i < data.size(); i++)
+		{
+			uint64_t bits;
+			memcpy(&bits, &data[i], sizeof bits);
+			machine.DataWord(i * 8) = static_cast<uint32_t>(bits >> 32);
+			machine.DataWord(i * 8 + 4) = static_cast<uint32_t>(bits);
+		}
+		
+		if (step)
+			machine.Step();
+		else
+			machine.Run();
+		
+		// the guest's rounding mode stays on the host FPU when the interpreter returns
+		fesetround(FE_TONEAREST);
+		
+		Outcome outcome;
+		memcpy(outcome.fpr, machine.state.fpr, sizeof outcome.fpr);
+		outcome.fpscr = machine.state.fpscr.hex;
+		outcome.cr = machine.state.GetCR();
+		return outcome;
+	}
+	
+	// Stepping folds the host exceptions and the FPRF into the FPSCR after every instruction; decoded blocks wait
+	// until something reads it. Both have to come out the same, bit for bit.
+	Outcome CheckLazyMatchesEager(const std::vector<uint32_t>& program, const std::vector<double>& data)
+	{
+		Outcome eager = Run(true, program, data);
+		Outcome lazy = Run(false, program, data);
+		
+		std::stringstream differences;
+		if (memcmp(lazy.fpr, eager.fpr, sizeof lazy.fpr) != 0)
+			differences << " fprs differ";
+		if (lazy.fpscr != eager.fpscr)
+			differences << " fpscr=" << std::hex << lazy.fpscr << " (not " << eager.fpscr << ")";
+		if (lazy.cr != eager.cr)
+			differences << " cr=" << std::hex << lazy.cr << " (not " << eager.cr << ")";
+		
+		if (!differences.str().empty())
+			UnitTest::Fail(__FILE__, __LINE__, "lazy FPSCR disagrees with stepping:" + differences.str());
+		return lazy;
+	}
+}
+
+TEST(FloatingPoint, RoundingFollowsFPSCR)
+{
+	Outcome outcome = CheckLazyMatchesEager({
+		Lfd(1, 0),						// lfd f1, 0(r2)
+		Lfd(2, 8),						// lfd f2, 8(r2)
+		Lfd(3, 16),						// lfd f3, 16(r2)
+		FA(63, 21, 4, 1, 2, 0),			// fadd f4, f1, f2
+		Mtfsfi(7, 2),					// mtfsfi 7, 2 (toward +infinity)
+		FA(63, 21, 5, 1, 2, 0),			// fadd f5, f1, f2
+		FA(63, 21, 6, 3, 2, 0),			// fadd f6, f3, f2
+		FA(59, 21, 7, 1, 2, 0),			// fadds f7, f1, f2
+		Mtfsfi(7, 3),					// mtfsfi 7, 3 (toward -infinity)
+		FA(63, 20, 8, 1, 2, 0),			// fsub f8, f1, f2
+		FA(63, 20, 9, 3, 2, 0),			// fsub f9, f3, f2
+		Mtfsfi(7, 1),					// mtfsfi 7, 1 (toward zero)
+		FA(63, 20, 10, 3, 2, 0),		// fsub f10, f3, f2
+		FX(63, 15, 11, 0, 5),			// fctiwz f11, f5
+		FX(63, 14, 12, 0, 9),			// fctiw f12, f9
+		Mtfsfi(7, 0),					// mtfsfi 7, 0
+		FA(63, 21, 13, 1, 2, 0),		// fadd f13, f1, f2
+		Blr,
+	}, {1.0, ldexp(1.0, -60), -1.0});
+	
+	CHECK_EQUAL(outcome.fpr[4], 1.0);
+	CHECK_EQUAL(outcome.fpr[5], nextafter(1.0, 2.0));
+	CHECK_EQUAL(outcome.fpr[6], nextafter(-1.0, 0.0));
+	CHECK_EQUAL(outcome.fpr[7], static_cast<double>(nextafterf(1.0f, 2.0f)));
+	CHECK_EQUAL(outcome.fpr[8], nextafter(1.0, 0.0));
+	CHECK_EQUAL(outcome.fpr[9], -1.0 - ldexp(1.0, -52));
+	CHECK_EQUAL(outcome.fpr[10], -1.0);
+	CHECK_EQUAL(outcome.fpr[13], 1.0);
+	CHECK_EQUAL(LowWord(outcome.fpr[11]), 1u);
+	CHECK_EQUAL(LowWord(outcome.fpr[12]), 0xffffffffu); // -1, rounded toward zero
+	CHECK_EQUAL(outcome.fpscr & static_cast<uint32_t>(FloatingPointStatus::RN), 0u);
+	CHECK(outcome.fpscr & static_cast<uint32_t>(FloatingPointStatus::XX));
+}
+
+TEST(FloatingPoint, ResultFlagsClassifyResults)
+{
+	Outcome outcome = CheckLazyMatchesEager({
+		Lfd(1, 0),						// lfd f1, 0(r2)
+		Lfd(2, 8),						// lfd f2, 8(r2)
+		Lfd(3, 16),						// lfd f3, 16(r2)
+		Lfd(4, 24),						// lfd f4, 24(r2)
+		FA(63, 20, 5, 1, 1, 0),			// fsub f5, f1, f1
+		Mffs(20),						// mffs f20
+		FA(63, 20, 6, 2, 1, 0),			// fsub f6, f2, f1
+		Mffs(21),						// mffs f21
+		FA(63, 25, 7, 3, 0, 1),			// fmul f7, f3, f1
+		Mffs(22),						// mffs f22
+		FA(59, 25, 8, 4, 0, 4),			// fmuls f8, f4, f4
+		Mffs(23),						// mffs f23
+		FA(63, 18, 9, 1, 2, 0),			// fdiv f9, f1, f2
+		Mffs(24),						// mffs f24
+		FA(63, 20, 10, 2, 1, 0),		// fsub f10, f2, f1
+		FA(63, 21, 11, 2, 9, 0),		// fadd f11, f2, f9
+		FA(63, 18, 12, 2, 2, 0),		// fdiv f12, f2, f2
+		Mffs(25),						// mffs f25
+		FA(63, 21, 13, 1, 1, 0, true),	// fadd. f13, f1, f1
+		Blr,
+	}, {1.0, 0.0, ldexp(1.0, -1074), ldexp(1.0, -65)});
+	
+	CHECK_EQUAL(FPRF(LowWord(outcome.fpr[20])), 0x02u); // +0
+	CHECK_EQUAL(FPRF(LowWord(outcome.fpr[21])), 0x08u); // -normal
+	CHECK_EQUAL(FPRF(LowWord(outcome.fpr[22])), 0x14u); // +denormal
+	CHECK_EQUAL(FPRF(LowWord(outcome.fpr[23])), 0x14u); // normal as a double, denormal as a single
+	CHECK_EQUAL(FPRF(LowWord(outcome.fpr[24])), 0x05u); // +infinity
+	CHECK_EQUAL(FPRF(LowWord(outcome.fpr[25])), 0x11u); // quiet NaN
+	CHECK_EQUAL(FPRF(outcome.fpscr), 0x04u); // +normal
+	
+	// the division by zero and the invalid 0/0 are sticky; 1/0 didn't overflow
+	uint32_t fpscr = outcome.fpscr;
+	CHECK(!(LowWord(outcome.fpr[23]) & static_cast<uint32_t>(FloatingPointStatus::ZX)));
+	CHECK(LowWord(outcome.fpr[24]) & static_cast<uint32_t>(FloatingPointStatus::ZX));
+	CHECK(fpscr & static_cast<uint32_t>(FloatingPointStatus::FX));
+	CHECK(fpscr & static_cast<uint32_t>(FloatingPointStatus::ZX));
+	CHECK(fpscr & static_cast<uint32_t>(FloatingPointStatus::VXZDZ));
+	CHECK(fpscr & static_cast<uint32_t>(FloatingPointStatus::VX));
+	CHECK(!(fpscr & static_cast<uint32_t>(FloatingPointStatus::OX)));
+	CHECK(!(fpscr & static_cast<uint32_t>(FloatingPointStatus::FEX)));
+	
+	// fadd. copies FX, FEX, VX and OX to CR1
+	CHECK_EQUAL((outcome.cr >> 24) & 0xf, 0b1010u);
+}
@@ -0,0 +1,188 @@
+//
+// LazyFlagsTests.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include <sstream>
+#include "UnitTest.h"
+#include "GuestMachine.h"
+
+using namespace Encode;
+
+namespace
+{
+	// Stepping materializes CR0 and XER[CA] after every instruction, so it's the eager reference; decoded blocks
+	// leave them pending until something looks at them.
+	struct Flags
+	{
+		uint32_t gpr[32];
+		uint32_t cr;
+		uint32_t xer;
+		bool carry;
+	};
+	
+	Flags Run(bool step, const std::vector<uint32_t>& program)
+	{
+		GuestMachine machine;
+		machine.Load(program);
+		if (step)
+			machine.Step();
+		else
+			machine.Run();
+		
+		Flags flags;
+		for (int i = 0; i < 32; i++)
+			flags.gpr[i] = machine.state.gpr[i];
+		flags.cr = machine.state.GetCR();
+		flags.xer = machine.state.xer;
+		flags.carry = machine.state.xer_ca;
+		return flags;
+	}
+	
+	// an XER value with these bits, whatever the order of MachineState's bit fields
+	uint32_t XerWith(bool summaryOverflow, bool carry)
+	{
+		PPCVM::MachineState state;
+		state.xer = 0;
+		state.xer_so = summaryOverflow;
+		state.xer_ca = carry;
+		return state.xer;
+	}
+	
+	Flags CheckLazyMatchesEager(const std::vector<uint32_t>& program)
+	{
+		Flags eager = Run(true, program);
+		Flags lazy = Run(false, program);
+		
+		std::stringstream differences;
+		// r1 and r2 point into each machine's own allocations
+		for (int i = 3; i < 32; i++)
+		{
+			if (lazy.gpr[i] != eager.gpr[i])
+				differences << " r" << i << "=" << std::hex << lazy.gpr[i] << " (not " << eager.gpr[i] << ")";
+		}
+		
+		if (lazy.cr != eager.cr)
+			differences << " cr=" << std::hex << lazy.cr << " (not " << eager.cr << ")";
+		if (lazy.xer != eager.xer)
+			differences << " xer=" << std::hex << lazy.xer << " (not " << eager.xer << ")";
+		
+		if (!differences.str().empty())
+			UnitTest::Fail(__FILE__, __LINE__, "lazy flags disagree with stepping:" + differences.str());
+		return lazy;
+	}
+}
+
+TEST(LazyFlags, CarryingSequencesMatchStepping)
+{
+	Flags flags = CheckLazyMatchesEager({
+		D(14, 3, 0, -1),			// li r3, -1
+		D(14, 4, 0, 1),				// li r4, 1
+		XO(10, 5, 3, 4, 0, 0),		// addc r5, r3, r4
+		XO(138, 6, 3, 3, 0, 0),		// adde r6, r3, r3
+		XO(202, 7, 4, 0, 0, 0),		// addze r7, r4
+		XO(8, 8, 4, 3, 0, 0),		// subfc r8, r4, r3
+		XO(136, 9, 3, 4, 0, 0),		// subfe r9, r3, r4
+		XO(234, 10, 4, 0, 0, 0),	// addme r10, r4
+		XO(200, 11, 4, 0, 0, 0),	// subfze r11, r4
+		D(12, 12, 3, 2),			// addic r12, r3, 2
+		X(824, 3, 13, 4),			// srawi r13, r3, 4
+		XO(138, 14, 4, 4, 0, 0),	// adde r14, r4, r4
+		D(14, 15, 0, -16),			// li r15, -16
+		X(824, 15, 16, 4),			// srawi r16, r15, 4
+		XO(138, 17, 4, 4, 0, 0),	// adde r17, r4, r4
+		D(8, 18, 4, 0),				// subfic r18, r4, 0
+		XO(136, 19, 4, 3, 0, 0),	// subfe r19, r4, r3
+		Mfspr(20, 1),				// mfxer r20
+		Blr,
+	});
+	
+	CHECK_EQUAL(flags.gpr[5], 0u);
+	CHECK_EQUAL(flags.gpr[6], 0xffffffffu);
+	CHECK_EQUAL(flags.gpr[7], 2u);
+	CHECK_EQUAL(flags.gpr[8], 0xfffffffeu);
+	CHECK_EQUAL(flags.gpr[9], 2u);
+	CHECK_EQUAL(flags.gpr[10], 0u);
+	CHECK_EQUAL(flags.gpr[11], 0xffffffffu);
+	CHECK_EQUAL(flags.gpr[14], 3u); // srawi of a negative number that shifts out ones carries
+	CHECK_EQUAL(flags.gpr[17], 2u); // and it doesn't when it shifts out zeroes
+	CHECK_EQUAL(flags.gpr[18], 0xffffffffu);
+	CHECK_EQUAL(flags.gpr[19], 0xfffffffdu);
+	CHECK(flags.carry);
+	CHECK_EQUAL(flags.gpr[20], XerWith(false, true));
+}
+
+TEST(LazyFlags, RecordFormsMatchStepping)
+{
+	Flags flags = CheckLazyMatchesEager({
+		D(14, 3, 0, 5),				// li r3, 5
+		D(14, 4, 0, -5),			// li r4, -5
+		XO(266, 5, 3, 4, 0, 1),		// add. r5, r3, r4
+		Mfcr(20),					// mfcr r20
+		XO(40, 6, 3, 4, 0, 1),		// subf. r6, r3, r4
+		X(444, 3, 7, 4),			// or r7, r3, r4
+		Mfcr(21),					// mfcr r21
+		X(28, 3, 8, 3, 1),			// and. r8, r3, r3
+		D(13, 9, 4, 5),				// addic. r9, r4, 5
+		Mfcr(22),					// mfcr r22
+		Mfspr(23, 1),				// mfxer r23
+		XO(266, 10, 3, 3, 0, 1),	// add. r10, r3, r3
+		BC(12, 1, 8),				// bgt skip
+		D(14, 24, 0, 1),			// li r24, 1
+		XO(40, 11, 3, 4, 0, 1),		// skip: subf. r11, r3, r4
+		BC(12, 0, 8),				// blt skip2
+		D(14, 25, 0, 1),			// li r25, 1
+		Blr,						// skip2: blr
+	});
+	
+	CHECK_EQUAL(flags.gpr[20], 0x20000000u);
+	CHECK_EQUAL(flags.gpr[21], 0x80000000u);
+	CHECK_EQUAL(flags.gpr[22], 0x20000000u);
+	CHECK_EQUAL(flags.gpr[24], 0u);
+	CHECK_EQUAL(flags.gpr[25], 0u);
+	CHECK_EQUAL(flags.cr, 0x80000000u);
+	CHECK(flags.carry); // from addic.
+}
+
+TEST(LazyFlags, PendingFlagsDontOverwriteLaterWrites)
+{
+	Flags flags = CheckLazyMatchesEager({
+		D(14, 3, 0, 1),				// li r3, 1
+		XO(266, 5, 3, 3, 0, 1),		// add. r5, r3, r3
+		X(0, 0, 3, 3),				// cmpw r3, r3
+		Mfcr(20),					// mfcr r20
+		XO(266, 5, 3, 3, 0, 1),		// add. r5, r3, r3
+		D(14, 4, 0, XerWith(true, false)),	// li r4, SO
+		Mtspr(1, 4),				// mtxer r4
+		Mfcr(21),					// mfcr r21
+		XO(266, 6, 3, 3, 0, 1),		// add. r6, r3, r3
+		Mfcr(22),					// mfcr r22
+		D(14, 8, 0, XerWith(false, true)),	// li r8, CA
+		XO(10, 7, 3, 3, 0, 0),		// addc r7, r3, r3
+		Mtspr(1, 8),				// mtxer r8
+		XO(138, 9, 3, 3, 0, 0),		// adde r9, r3, r3
+		Blr,
+	});
+	
+	CHECK_EQUAL(flags.gpr[20], 0x20000000u);
+	CHECK_EQUAL(flags.gpr[21], 0x40000000u); // SO was clear when add. ran
+	CHECK_EQUAL(flags.gpr[22], 0x50000000u);
+	CHECK_EQUAL(flags.gpr[9], 3u); // mtxer set CA after addc cleared it
+}
@@ -0,0 +1,172 @@
+//
+// LoadStoreTests.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include "UnitTest.h"
+#include "GuestMachine.h"
+
+using namespace Encode;
+
+namespace
+{
+	const uint32_t CacheLineSize = 32;
+	
+	void FillData(GuestMachine& machine, uint8_t value)
+	{
+		memset(machine.allocator.ToPointer<uint8_t>(machine.data), value, GuestMachine::DataSize);
+	}
+	
+	// the guest writes bytes 1, 2, 3... from `offset`
+	void WriteSequence(GuestMachine& machine, uint32_t offset, uint32_t size)
+	{
+		std::vector<uint8_t> bytes(size);
+		for (uint32_t i = 0; i < size; i++)
+			bytes[i] = static_cast<uint8_t>(i + 1);
+		machine.WriteData(offset, bytes.data(), size);
+	}
+	
+	uint32_t SequenceWord(uint32_t index)
+	{
+		uint32_t first = index * 4 + 1;
+		return first << 24 | (first + 1) << 16 | (first + 2) << 8 | (first + 3);
+	}
+}
+
+TEST(LoadStore, DcbzZeroesTheWholeLine)
+{
+	GuestMachine machine;
+	FillData(machine, 0xaa);
+	// r4 points in the middle of a line
+	uint32_t address = machine.data + 0x105;
+	uint32_t line = (address & ~(CacheLineSize - 1)) - machine.data;
+	machine.Load({
+		X(1014, 0, 0, 4),		// dcbz 0, r4
+		X(758, 0, 3, 5),		// dcba r3, r5
+		X(278, 0, 0, 6),		// dcbt 0, r6
+		Blr,
+	});
+	machine.state.r3 = machine.data;
+	machine.state.r4 = address;
+	machine.state.r5 = 0x200 + 31;
+	machine.state.r6 = 0;			// a hint about an address that isn't mapped doesn't fault
+	machine.Run();
+	
+	std::vector<uint8_t> bytes = machine.ReadData(0, GuestMachine::DataSize);
+	for (uint32_t i = 0; i < GuestMachine::DataSize; i++)
+	{
+		bool zeroed = (i >= line && i < line + CacheLineSize) || (i >= 0x200 && i < 0x200 + CacheLineSize);
+		if (bytes[i] != (zeroed ? 0 : 0xaa))
+		{
+			CHECK_EQUAL(static_cast<int>(bytes[i]), zeroed ? 0 : 0xaa);
+			break;
+		}
+	}
+}
+
+TEST(LoadStore, MultipleWordsRoundTrip)
+{
+	// alignment changes the paths that stmw and lmw take, and r13 gives enough words for the vector loop and a tail
+	for (uint32_t misalignment = 0; misalignment < 4; misalignment++)
+	{
+		GuestMachine machine;
+		uint32_t offset = 0x100 + misalignment;
+		machine.Load({
+			D(47, 13, 2, offset),	// stmw r13, offset(r2)
+			D(46, 14, 2, offset + 4 + 0x100),	// lmw r14, offset+0x104(r2)
+			Blr,
+		});
+		for (int i = 13; i < 32; i++)
+			machine.state.gpr[i] = 0x01020304 * i;
+		WriteSequence(machine, offset + 0x100, 19 * 4);
+		machine.Run();
+		
+		std::vector<uint8_t> stored = machine.ReadData(offset, 19 * 4);
+		for (int i = 13; i < 32; i++)
+		{
+			uint32_t word = stored[(i - 13) * 4] << 24 | stored[(i - 13) * 4 + 1] << 16 | stored[(i - 13) * 4 + 2] << 8 | stored[(i - 13) * 4 + 3];
+			CHECK_EQUAL(word, 0x01020304u * i);
+		}
+		
+		// lmw r14 skipped the first word of the sequence
+		CHECK_EQUAL(machine.state.r13, 0x01020304u * 13);
+		for (int i = 14; i < 32; i++)
+			CHECK_EQUAL(machine.state.gpr[i], SequenceWord(i - 13));
+		
+		// nothing is written past the last register
+		CHECK_EQUAL(machine.ReadData(offset + 19 * 4, 1)[0], 0);
+	}
+}
+
+TEST(LoadStore, StringsFillFromTheMostSignificantByteAndWrap)
+{
+	GuestMachine machine;
+	WriteSequence(machine, 0x10, 32);
+	machine.Load({
+		X(597, 5, 3, 7),		// lswi r5, r3, 7
+		X(597, 30, 3, 10),		// lswi r30, r3, 10
+		X(533, 8, 0, 3),		// lswx r8, 0, r3
+		Blr,
+	});
+	machine.state.r3 = machine.data + 0x10;
+	machine.state.xer = 5;		// byte count
+	machine.Run();
+	
+	CHECK_EQUAL(machine.state.r5, SequenceWord(0));
+	CHECK_EQUAL(machine.state.r6, 0x05060700u);
+	
+	// r31 wraps to r0, and the last partial register is zero-extended
+	CHECK_EQUAL(machine.state.r30, SequenceWord(0));
+	CHECK_EQUAL(machine.state.r31, SequenceWord(1));
+	CHECK_EQUAL(machine.state.r0, 0x090a0000u);
+	
+	CHECK_EQUAL(machine.state.r8, SequenceWord(0));
+	CHECK_EQUAL(machine.state.r9, 0x05000000u);
+}
+
+TEST(LoadStore, StoreStringWritesOnlyItsBytes)
+{
+	GuestMachine machine;
+	FillData(machine, 0xaa);
+	machine.Load({
+		X(725, 30, 3, 11),		// stswi r30, r3, 11
+		X(661, 5, 0, 4),		// stswx r5, 0, r4
+		Blr,
+	});
+	machine.state.r3 = machine.data + 0x21;
+	machine.state.r4 = machine.data + 0x40;
+	machine.state.r30 = 0x01020304;
+	machine.state.r31 = 0x05060708;
+	machine.state.r0 = 0x090a0bff;
+	machine.state.r5 = 0x11121314;
+	machine.state.r6 = 0x15161718;
+	machine.state.xer = 6;		// byte count
+	machine.Run();
+	
+	std::vector<uint8_t> stored = machine.ReadData(0x20, 13);
+	const uint8_t expected[] = {0xaa, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 0xaa};
+	for (size_t i = 0; i < sizeof expected; i++)
+		CHECK_EQUAL(static_cast<int>(stored[i]), static_cast<int>(expected[i]));
+	
+	stored = machine.ReadData(0x40, 7);
+	const uint8_t expectedX[] = {0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0xaa};
+	for (size_t i = 0; i < sizeof expectedX; i++)
+		CHECK_EQUAL(static_cast<int>(stored[i]), static_cast<int>(expectedX[i]));
+}
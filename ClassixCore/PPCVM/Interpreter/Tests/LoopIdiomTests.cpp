@@ -0,0 +1,354 @@
+//
+// LoopIdiomTests.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include <cstdlib>
+#include <exception>
+#include <sstream>
+#include "UnitTest.h"
+#include "GuestMachine.h"
+#include "ExecutionCounters.h"
+#include "LoopIdioms.h"
+
+using namespace Encode;
+using PPCVM::Execution::ExecutionCounters;
+
+namespace
+{
+	enum RunMode
+	{
+		Stepped,
+		Replaced,
+		Verified,
+	};
+	
+	struct Outcome
+	{
+		PPCVM::MachineState state;
+		std::vector<uint8_t> data;
+		uint64_t dispatched;
+		std::string error;
+	};
+	
+	// The bytes that the loops go through. There's no 0 and no 'x' in there, so that scans can place their own.
+	std::vector<uint8_t> Contents()
+	{
+		std::vector<uint8_t> bytes(0x200);
+		for (size_t i = 0; i < bytes.size(); i++)
+			bytes[i] = static_cast<uint8_t>(1 + i * 37 % 0x77);
+		return bytes;
+	}
+	
+	// setup, then a loop that branches back to its start with BO and BI, then blr
+	std::vector<uint32_t> Program(std::initializer_list<uint32_t> setup, std::initializer_list<uint32_t> loop, uint32_t bo, uint32_t bi)
+	{
+		std::vector<uint32_t> program(setup);
+		program.insert(program.end(), loop);
+		program.push_back(BC(bo, bi, -static_cast<int32_t>(loop.size() * 4)));
+		program.push_back(Blr);
+		return program;
+	}
+	
+	inline uint32_t Pointer(uint32_t reg, int32_t offset)
+	{
+		return D(14, reg, 2, offset); // addi reg, r2, offset
+	}
+	
+	Outcome RunProgram(const std::vector<uint32_t>& program, const std::vector<uint8_t>& contents, RunMode mode)
+	{
+		GuestMachine machine;
+		machine.WriteData(0, contents.data(), contents.size());
+		machine.Load(program);
+		machine.interpreter.SetIdiomVerification(mode == Verified);
+		
+		Outcome outcome;
+		outcome.dispatched = 0;
+		try
+		{
+			if (mode == Stepped)
+			{
+				const Common::UInt32* end = machine.interpreter.GetEndAddress();
+				for (const Common::UInt32* pc = machine.Entry(); pc != end; outcome.dispatched++)
+					pc = machine.interpreter.ExecuteOne(pc);
+			}
+			else
+			{
+				ExecutionCounters counters;
+				machine.interpreter.SetCounters(&counters);
+				machine.Run();
+				machine.interpreter.SetCounters(nullptr);
+				
+				std::stringstream report;
+				counters.WriteReport(report);
+				report >> outcome.dispatched;
+			}
+		}
+		catch (std::exception& ex)
+		{
+			outcome.error = ex.what();
+		}
+		
+		outcome.state = machine.state;
+		outcome.data = machine.ReadData(0, contents.size());
+		return outcome;
+	}
+	
+	// Runs the program one instruction at a time, and through decoded blocks with and without verification, and
+	// checks that it always ends the same way. When replaced is set, the loop must have run as a host operation.
+	void CheckLoop(const char* file, int line, const std::vector<uint32_t>& program, const std::vector<uint8_t>& contents, bool replaced)
+	{
+		Outcome stepped = RunProgram(program, contents, Stepped);
+		if (!stepped.error.empty())
+			return UnitTest::Fail(file, line, "stepping raised " + stepped.error);
+		
+		for (RunMode mode : {Replaced, Verified})
+		{
+			std::string name = mode == Replaced ? "replaced loop" : "verified loop";
+			Outcome outcome = RunProgram(program, contents, mode);
+			if (!outcome.error.empty())
+			{
+				UnitTest::Fail(file, line, name + " raised " + outcome.error);
+				continue;
+			}
+			
+			for (int i = 0; i < 32; i++)
+			{
+				if (outcome.state.gpr[i] != stepped.state.gpr[i])
+					UnitTest::Fail(file, line, name + " left r" + std::to_string(i) + " = " + UnitTest::Describe(outcome.state.gpr[i]) + ", expected " + UnitTest::Describe(stepped.state.gpr[i]));
+			}
+			
+			if (outcome.state.ctr != stepped.state.ctr)
+				UnitTest::Fail(file, line, name + " left ctr = " + UnitTest::Describe(outcome.state.ctr) + ", expected " + UnitTest::Describe(stepped.state.ctr));
+			
+			if (memcmp(outcome.state.cr, stepped.state.cr, sizeof stepped.state.cr) != 0 || outcome.state.xer != stepped.state.xer)
+				UnitTest::Fail(file, line, name + " left different flags");
+			
+			if (outcome.data != stepped.data)
+				UnitTest::Fail(file, line, name + " left different memory");
+			
+			// going through the loop one iteration at a time dispatches at least twice as many instructions
+			if (mode == Replaced && replaced != (outcome.dispatched * 2 < stepped.dispatched))
+				UnitTest::Fail(file, line, name + " dispatched " + UnitTest::Describe(outcome.dispatched) + " instructions, stepping dispatched " + UnitTest::Describe(stepped.dispatched));
+		}
+	}
+}
+
+#define CHECK_LOOP(program, contents, replaced) CheckLoop(__FILE__, __LINE__, program, contents, replaced)
+
+TEST(LoopIdioms, CopyLoopsMatchStepping)
+{
+	std::vector<uint8_t> contents = Contents();
+	
+	// bytes, at odd addresses
+	CHECK_LOOP(Program({
+		Pointer(3, 0x0f),
+		Pointer(4, 0x102),
+		D(14, 0, 0, 37),	// li r0, 37
+		Mtspr(9, 0),		// mtctr r0
+	}, {
+		D(35, 5, 3, 1),		// lbzu r5, 1(r3)
+		D(39, 5, 4, 1),		// stbu r5, 1(r4)
+	}, 16, 0), contents, true);	// bdnz
+	
+	// halfwords, going down
+	CHECK_LOOP(Program({
+		Pointer(3, 0x40),
+		Pointer(4, 0x180),
+		D(14, 0, 0, 20),	// li r0, 20
+		Mtspr(9, 0),		// mtctr r0
+	}, {
+		D(41, 5, 3, -2),	// lhzu r5, -2(r3)
+		D(45, 5, 4, -2),	// sthu r5, -2(r4)
+	}, 16, 0), contents, true);
+	
+	// words, moved down over themselves: every word is read before it's written over
+	CHECK_LOOP(Program({
+		Pointer(3, 0x3c),
+		Pointer(4, 0x2c),
+		D(14, 0, 0, 16),	// li r0, 16
+		Mtspr(9, 0),		// mtctr r0
+	}, {
+		D(33, 5, 3, 4),		// lwzu r5, 4(r3)
+		D(37, 5, 4, 4),		// stwu r5, 4(r4)
+	}, 16, 0), contents, true);
+	
+	// bytes, moved up over themselves: that repeats the first byte, and the interpreter does it
+	CHECK_LOOP(Program({
+		Pointer(3, 0x0f),
+		Pointer(4, 0x10),
+		D(14, 0, 0, 20),	// li r0, 20
+		Mtspr(9, 0),		// mtctr r0
+	}, {
+		D(35, 5, 3, 1),		// lbzu r5, 1(r3)
+		D(39, 5, 4, 1),		// stbu r5, 1(r4)
+	}, 16, 0), contents, false);
+}
+
+TEST(LoopIdioms, FillLoopsMatchStepping)
+{
+	std::vector<uint8_t> contents = Contents();
+	
+	CHECK_LOOP(Program({
+		Pointer(4, 0x102),
+		D(14, 6, 0, 0xa5),	// li r6, 0xa5
+		D(14, 0, 0, 29),	// li r0, 29
+		Mtspr(9, 0),		// mtctr r0
+	}, {
+		D(39, 6, 4, 1),		// stbu r6, 1(r4)
+	}, 16, 0), contents, true);
+	
+	// halfwords whose bytes differ, going down
+	CHECK_LOOP(Program({
+		Pointer(4, 0x140),
+		D(14, 6, 0, 0x1234),	// li r6, 0x1234
+		D(14, 0, 0, 11),		// li r0, 11
+		Mtspr(9, 0),			// mtctr r0
+	}, {
+		D(45, 6, 4, -2),		// sthu r6, -2(r4)
+	}, 16, 0), contents, true);
+	
+	CHECK_LOOP(Program({
+		Pointer(4, 0xfc),
+		D(14, 6, 0, -1),	// li r6, -1
+		D(14, 0, 0, 16),	// li r0, 16
+		Mtspr(9, 0),		// mtctr r0
+	}, {
+		D(37, 6, 4, 4),		// stwu r6, 4(r4)
+	}, 16, 0), contents, true);
+}
+
+TEST(LoopIdioms, ScanLoopsMatchStepping)
+{
+	std::vector<uint8_t> contents = Contents();
+	contents[0x4d] = 0;
+	contents[0x93] = 'x';
+	
+	// strlen
+	CHECK_LOOP(Program({
+		Pointer(3, 0x1f),
+	}, {
+		D(35, 5, 3, 1),		// lbzu r5, 1(r3)
+		D(11, 0, 5, 0),		// cmpwi r5, 0
+	}, 4, 2), contents, true);	// bne
+	
+	// memchr that finds its byte
+	CHECK_LOOP(Program({
+		Pointer(3, 0x5f),
+		D(14, 0, 0, 100),	// li r0, 100
+		Mtspr(9, 0),		// mtctr r0
+	}, {
+		D(35, 5, 3, 1),		// lbzu r5, 1(r3)
+		D(10, 4, 5, 'x'),	// cmplwi cr1, r5, 'x'
+	}, 0, 6), contents, true);	// bdnzf cr1[eq]
+	
+	// and one that runs out of ctr first
+	CHECK_LOOP(Program({
+		Pointer(3, 0x5f),
+		D(14, 0, 0, 30),	// li r0, 30
+		Mtspr(9, 0),		// mtctr r0
+	}, {
+		D(35, 5, 3, 1),		// lbzu r5, 1(r3)
+		D(10, 4, 5, 'x'),	// cmplwi cr1, r5, 'x'
+	}, 0, 6), contents, true);
+	
+	// going down, for a byte in a register
+	CHECK_LOOP(Program({
+		Pointer(3, 0xc0),
+		D(14, 7, 0, 'x'),	// li r7, 'x'
+	}, {
+		D(35, 5, 3, -1),	// lbzu r5, -1(r3)
+		X(0, 0, 5, 7),		// cmpw r5, r7
+	}, 4, 2), contents, true);
+}
+
+TEST(LoopIdioms, SumLoopsMatchStepping)
+{
+	std::vector<uint8_t> contents = Contents();
+	
+	CHECK_LOOP(Program({
+		Pointer(3, 0x0b),
+		D(14, 6, 0, 0x1234),	// li r6, 0x1234
+		D(14, 0, 0, 50),		// li r0, 50
+		Mtspr(9, 0),			// mtctr r0
+	}, {
+		D(35, 5, 3, 1),					// lbzu r5, 1(r3)
+		XO(266, 6, 6, 5, false, false),	// add r6, r6, r5
+	}, 16, 0), contents, true);
+	
+	CHECK_LOOP(Program({
+		Pointer(3, 0x7c),
+		D(14, 6, 0, -1),	// li r6, -1
+		D(14, 0, 0, 20),	// li r0, 20
+		Mtspr(9, 0),		// mtctr r0
+	}, {
+		D(33, 5, 3, 4),		// lwzu r5, 4(r3)
+		X(316, 6, 6, 5),	// xor r6, r6, r5
+	}, 16, 0), contents, true);
+	
+	CHECK_LOOP(Program({
+		Pointer(3, 0x100),
+		D(14, 0, 0, 25),	// li r0, 25
+		Mtspr(9, 0),		// mtctr r0
+	}, {
+		D(41, 5, 3, -2),				// lhzu r5, -2(r3)
+		XO(266, 6, 5, 6, false, false),	// add r6, r5, r6
+	}, 16, 0), contents, true);
+}
+
+TEST(LoopIdioms, LoopsThatWouldFaultRunStepByStep)
+{
+	// the copy goes past the end of the data, so it faults in the middle, after some bytes were written
+	GuestMachine machine;
+	machine.Load(Program({
+		Pointer(3, 0x10),
+		Pointer(4, GuestMachine::DataSize - 0x11),
+		D(14, 0, 0, 0x20),	// li r0, 0x20
+		Mtspr(9, 0),		// mtctr r0
+	}, {
+		D(35, 5, 3, 1),		// lbzu r5, 1(r3)
+		D(39, 5, 4, 1),		// stbu r5, 1(r4)
+	}, 16, 0));
+	machine.interpreter.SetIdiomVerification(true);
+	
+	bool faulted = false;
+	try
+	{
+		machine.Run();
+	}
+	catch (std::exception&)
+	{
+		faulted = true;
+	}
+	CHECK(faulted);
+	CHECK_EQUAL(machine.state.r4, machine.data + GuestMachine::DataSize - 1);
+	CHECK_EQUAL(machine.state.ctr, 0x10u);
+}
+
+TEST(LoopIdioms, VerificationFollowsTheEnvironment)
+{
+	unsetenv("CLASSIX_VERIFY_IDIOMS");
+	CHECK(!PPCVM::Execution::IdiomVerificationRequested());
+	setenv("CLASSIX_VERIFY_IDIOMS", "1", 1);
+	CHECK(PPCVM::Execution::IdiomVerificationRequested());
+	setenv("CLASSIX_VERIFY_IDIOMS", "0", 1);
+	CHECK(!PPCVM::Execution::IdiomVerificationRequested());
+	unsetenv("CLASSIX_VERIFY_IDIOMS");
+}
@@ -0,0 +1,141 @@
+//
+// MemoryFaultTests.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include "UnitTest.h"
+#include "GuestMachine.h"
+#include "AccessViolationException.h"
+#include "InterpreterException.h"
+
+using namespace Encode;
+
+namespace
+{
+	struct Fault
+	{
+		bool caught;
+		uint32_t pc;
+		uint32_t address;
+	};
+	
+	// Runs the loaded program, through decoded blocks or one instruction at a time, and reports where it faulted.
+	Fault RunUntilFault(GuestMachine& machine, bool step)
+	{
+		Fault fault = { false, 0, 0 };
+		try
+		{
+			if (step)
+				machine.Step();
+			else
+				machine.Run();
+		}
+		catch (PPCVM::Execution::InterpreterException& ex)
+		{
+			auto violation = std::dynamic_pointer_cast<Common::AccessViolationException>(ex.GetReason());
+			fault.caught = violation != nullptr;
+			fault.pc = ex.GetPC();
+			fault.address = violation == nullptr ? 0 : violation->GetAddress();
+		}
+		return fault;
+	}
+}
+
+TEST(MemoryFault, NullPointerReportsGuestPCAndAddress)
+{
+	for (int step = 0; step < 2; step++)
+	{
+		GuestMachine machine;
+		machine.Load({
+			D(14, 5, 0, 1),		// li r5, 1
+			D(14, 4, 0, 0x10),	// li r4, 0x10
+			D(32, 3, 4, 4),		// lwz r3, 4(r4)
+			D(14, 5, 0, 2),		// li r5, 2
+			Blr,
+		});
+		Fault fault = RunUntilFault(machine, step);
+		CHECK(fault.caught);
+		CHECK_EQUAL(fault.pc, machine.code + 8);
+		CHECK_EQUAL(fault.address, 0x14u);
+		
+		// the faulting instruction and the ones after it didn't run
+		CHECK_EQUAL(machine.state.r3, 0u);
+		CHECK_EQUAL(machine.state.r5, 1u);
+	}
+}
+
+TEST(MemoryFault, GuardPageCatchesOverruns)
+{
+	// allocations of a page or more end right before an inaccessible page
+	static_assert(GuestMachine::DataSize >= Common::FlatAllocator::GuardThreshold, "data would have no guard page");
+	for (int step = 0; step < 2; step++)
+	{
+		GuestMachine machine;
+		machine.Load({
+			D(36, 3, 2, GuestMachine::DataSize - 4),	// stw r3, DataSize-4(r2)
+			D(36, 3, 2, GuestMachine::DataSize),		// stw r3, DataSize(r2)
+			Blr,
+		});
+		machine.state.r3 = 0x12345678;
+		Fault fault = RunUntilFault(machine, step);
+		CHECK(fault.caught);
+		CHECK_EQUAL(fault.pc, machine.code + 4);
+		CHECK_EQUAL(fault.address, machine.data + GuestMachine::DataSize);
+		CHECK_EQUAL(machine.DataWord(GuestMachine::DataSize - 4).Get(), 0x12345678u);
+	}
+}
+
+TEST(MemoryFault, PendingFlagsAreMaterialized)
+{
+	GuestMachine machine;
+	machine.Load({
+		D(12, 3, 3, -1),		// addic r3, r3, -1
+		D(28, 4, 3, 0),			// andi. r4, r3, 0
+		D(32, 5, 0, 0x20),		// lwz r5, 0x20(0)
+		Blr,
+	});
+	machine.state.r3 = 1;
+	Fault fault = RunUntilFault(machine, false);
+	CHECK(fault.caught);
+	CHECK_EQUAL(fault.pc, machine.code + 8);
+	CHECK(machine.state.xer_ca);
+	CHECK_EQUAL(machine.state.GetCR() >> 28, 2u);
+}
+
+TEST(MemoryFault, InterpreterRecoversAfterAFault)
+{
+	GuestMachine machine;
+	machine.Load({
+		D(32, 3, 0, 0),			// lwz r3, 0(0)
+		Blr,
+	});
+	CHECK(RunUntilFault(machine, false).caught);
+	
+	// a fault doesn't leave a stale recovery point behind, so the next one is caught the same way
+	CHECK(RunUntilFault(machine, false).caught);
+	
+	machine.Load({
+		D(32, 3, 2, 0),			// lwz r3, 0(r2)
+		Blr,
+	});
+	machine.DataWord(0) = 42;
+	CHECK(!RunUntilFault(machine, false).caught);
+	CHECK_EQUAL(machine.state.r3, 42u);
+}
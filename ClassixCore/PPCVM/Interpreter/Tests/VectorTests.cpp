@@ -0,0 +1,267 @@
+//
+// VectorTests.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include <cmath>
+#include <limits>
+#include "UnitTest.h"
+#include "GuestMachine.h"
+
+using namespace Encode;
+
+// Vector registers are stored byte-reversed, so these tests load and store them with lvx and stvx, and only look
+// at memory: element order mistakes can't cancel out.
+namespace
+{
+	inline uint32_t Lvx(uint32_t vd, uint32_t ra, uint32_t rb)
+	{
+		return X(103, vd, ra, rb);
+	}
+	
+	inline uint32_t Stvx(uint32_t vs, uint32_t ra, uint32_t rb)
+	{
+		return X(231, vs, ra, rb);
+	}
+	
+	inline uint32_t Li(uint32_t rt, int32_t value)
+	{
+		return D(14, rt, 0, value);
+	}
+	
+	void WriteBytes(GuestMachine& machine, uint32_t offset, std::initializer_list<uint8_t> bytes)
+	{
+		std::vector<uint8_t> vector(bytes);
+		machine.WriteData(offset, vector.data(), vector.size());
+	}
+	
+	void WriteFloat(GuestMachine& machine, uint32_t offset, float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof bits);
+		machine.DataWord(offset) = bits;
+	}
+	
+	void CheckBytes(GuestMachine& machine, uint32_t offset, std::initializer_list<uint8_t> expected, int line)
+	{
+		std::vector<uint8_t> actual = machine.ReadData(offset, expected.size());
+		if (actual != std::vector<uint8_t>(expected))
+		{
+			std::stringstream message;
+			message << "bytes at data+0x" << std::hex << offset << " are";
+			for (uint8_t byte : actual)
+				message << " " << std::setw(2) << std::setfill('0') << unsigned(byte);
+			UnitTest::Fail(__FILE__, line, message.str());
+		}
+	}
+}
+
+TEST(Vector, MisalignedLoadWithPermute)
+{
+	GuestMachine machine;
+	CHECK_EQUAL(machine.data % 16, 0u);
+	for (uint8_t i = 0; i < 0x30; i++)
+		machine.WriteData(i, &i, 1);
+	
+	machine.Load({
+		D(14, 3, 2, 0x13),				// addi r3, r2, 0x13
+		Li(4, 0),						// li r4, 0
+		Li(5, 16),						// li r5, 16
+		Lvx(1, 3, 4),					// lvx v1, r3, r4
+		Lvx(2, 3, 5),					// lvx v2, r3, r5
+		X(6, 3, 3, 4),					// lvsl v3, r3, r4
+		VA(43, 4, 1, 2, 3),				// vperm v4, v1, v2, v3
+		X(38, 5, 3, 4),					// lvsr v5, r3, r4
+		VA(44, 6, 1, 2, 5),				// vsldoi v6, v1, v2, 5
+		Li(6, 0x100),					// li r6, 0x100
+		Stvx(4, 2, 6),					// stvx v4, r2, r6
+		Li(6, 0x110),					// li r6, 0x110
+		Stvx(3, 2, 6),					// stvx v3, r2, r6
+		Li(6, 0x120),					// li r6, 0x120
+		Stvx(5, 2, 6),					// stvx v5, r2, r6
+		Li(6, 0x13b),					// li r6, 0x13b
+		Stvx(6, 2, 6),					// stvx v6, r2, r6 (stores at 0x130)
+		Li(6, 0x144),					// li r6, 0x144
+		X(199, 1, 2, 6),				// stvewx v1, r2, r6 (word 1 of v1)
+		Blr,
+	});
+	machine.Run();
+	
+	CheckBytes(machine, 0x100, {0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22}, __LINE__);
+	CheckBytes(machine, 0x110, {3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18}, __LINE__);
+	CheckBytes(machine, 0x120, {13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28}, __LINE__);
+	CheckBytes(machine, 0x130, {0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24}, __LINE__);
+	CheckBytes(machine, 0x140, {0, 0, 0, 0, 0x14, 0x15, 0x16, 0x17, 0, 0, 0, 0}, __LINE__);
+}
+
+TEST(Vector, SaturationIsSticky)
+{
+	GuestMachine machine;
+	WriteBytes(machine, 0x00, {0xf0, 0x10, 0x80, 0x7f, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
+	WriteBytes(machine, 0x10, {0x20, 0x10, 0x80, 0x01, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1});
+	machine.DataWord(0x20) = 0x7fffffff;
+	machine.DataWord(0x24) = 0x80000000;
+	machine.DataWord(0x28) = 0x00012345;
+	machine.DataWord(0x2c) = 0xffff8000;
+	machine.DataWord(0x30) = 1;
+	machine.DataWord(0x34) = 0xffffffff;
+	machine.DataWord(0x38) = 0;
+	machine.DataWord(0x3c) = 0;
+	
+	machine.Load({
+		Li(4, 0x00),					// li r4, 0x00
+		Lvx(1, 2, 4),					// lvx v1, r2, r4
+		Li(4, 0x10),					// li r4, 0x10
+		Lvx(2, 2, 4),					// lvx v2, r2, r4
+		Li(4, 0x20),					// li r4, 0x20
+		Lvx(3, 2, 4),					// lvx v3, r2, r4
+		Li(4, 0x30),					// li r4, 0x30
+		Lvx(4, 2, 4),					// lvx v4, r2, r4
+		VX(0, 10, 1, 2),				// vaddubm v10, v1, v2
+		VX(1540, 20, 0, 0),				// mfvscr v20
+		VX(512, 11, 1, 2),				// vaddubs v11, v1, v2
+		VX(1540, 21, 0, 0),				// mfvscr v21
+		VX(0, 12, 1, 2),				// vaddubm v12, v1, v2
+		VX(1540, 22, 0, 0),				// mfvscr v22
+		VX(908, 0, 0, 0),				// vspltisw v0, 0
+		VX(1604, 0, 0, 0),				// mtvscr v0
+		VX(896, 13, 3, 4),				// vaddsws v13, v3, v4
+		VX(1536, 14, 2, 1),				// vsububs v14, v2, v1
+		VX(462, 15, 3, 4),				// vpkswss v15, v3, v4
+		VX(1540, 23, 0, 0),				// mfvscr v23
+		Li(4, 0x100),					// li r4, 0x100
+		Stvx(10, 2, 4),					// stvx v10, r2, r4
+		Li(4, 0x110),					// li r4, 0x110
+		Stvx(11, 2, 4),					// stvx v11, r2, r4
+		Li(4, 0x120),					// li r4, 0x120
+		Stvx(13, 2, 4),					// stvx v13, r2, r4
+		Li(4, 0x130),					// li r4, 0x130
+		Stvx(14, 2, 4),					// stvx v14, r2, r4
+		Li(4, 0x140),					// li r4, 0x140
+		Stvx(15, 2, 4),					// stvx v15, r2, r4
+		Li(4, 0x150),					// li r4, 0x150
+		Stvx(20, 2, 4),					// stvx v20, r2, r4
+		Li(4, 0x160),					// li r4, 0x160
+		Stvx(21, 2, 4),					// stvx v21, r2, r4
+		Li(4, 0x170),					// li r4, 0x170
+		Stvx(22, 2, 4),					// stvx v22, r2, r4
+		Li(4, 0x180),					// li r4, 0x180
+		Stvx(23, 2, 4),					// stvx v23, r2, r4
+		Blr,
+	});
+	machine.Run();
+	
+	CheckBytes(machine, 0x100, {0x10, 0x20, 0x00, 0x80, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12}, __LINE__);
+	CheckBytes(machine, 0x110, {0xff, 0x20, 0xff, 0x80, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12}, __LINE__);
+	CHECK_EQUAL(machine.DataWord(0x120), 0x7fffffffu);
+	CHECK_EQUAL(machine.DataWord(0x124), 0x80000000u);
+	CHECK_EQUAL(machine.DataWord(0x128), 0x00012345u);
+	CHECK_EQUAL(machine.DataWord(0x12c), 0xffff8000u);
+	CheckBytes(machine, 0x130, {0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, __LINE__);
+	CheckBytes(machine, 0x140, {0x7f, 0xff, 0x80, 0x00, 0x7f, 0xff, 0x80, 0x00, 0x00, 0x01, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00}, __LINE__);
+	
+	// the VSCR is in the last word of mfvscr's result
+	CHECK_EQUAL(machine.DataWord(0x15c), 0u);
+	CHECK_EQUAL(machine.DataWord(0x16c), 1u);
+	CHECK_EQUAL(machine.DataWord(0x17c), 1u); // modular arithmetic doesn't clear it
+	CHECK_EQUAL(machine.DataWord(0x18c), 1u);
+	CHECK_EQUAL(machine.state.vscr, 1u);
+}
+
+TEST(Vector, CompareRecordSetsCR6)
+{
+	GuestMachine machine;
+	WriteBytes(machine, 0x00, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16});
+	WriteBytes(machine, 0x10, {1, 2, 3, 4, 0, 0, 0, 0, 9, 10, 11, 12, 0, 0, 0, 0});
+	
+	machine.Load({
+		Li(4, 0x00),					// li r4, 0x00
+		Lvx(1, 2, 4),					// lvx v1, r2, r4
+		Li(4, 0x10),					// li r4, 0x10
+		Lvx(2, 2, 4),					// lvx v2, r2, r4
+		VX(134 | 0x400, 3, 1, 1),		// vcmpequw. v3, v1, v1
+		Mfcr(20),						// mfcr r20
+		VX(134 | 0x400, 4, 1, 2),		// vcmpequw. v4, v1, v2
+		Mfcr(21),						// mfcr r21
+		VX(1284, 5, 0, 0),				// vnor v5, v0, v0 (all ones)
+		VX(6 | 0x400, 5, 2, 5),			// vcmpequb. v5, v2, v5
+		Mfcr(22),						// mfcr r22
+		VX(134, 6, 1, 2),				// vcmpequw v6, v1, v2
+		Mfcr(23),						// mfcr r23
+		Li(5, 0x100),					// li r5, 0x100
+		Stvx(4, 2, 5),					// stvx v4, r2, r5
+		Blr,
+	});
+	machine.Run();
+	
+	CHECK_EQUAL(machine.state.gpr[20], 0x80u); // all true
+	CHECK_EQUAL(machine.state.gpr[21], 0x00u); // some true
+	CHECK_EQUAL(machine.state.gpr[22], 0x20u); // all false
+	CHECK_EQUAL(machine.state.gpr[23], 0x20u); // without Rc, CR6 doesn't change
+	CheckBytes(machine, 0x100, {0xff, 0xff, 0xff, 0xff, 0, 0, 0, 0, 0xff, 0xff, 0xff, 0xff, 0, 0, 0, 0}, __LINE__);
+}
+
+TEST(Vector, ElementOrderAndConversions)
+{
+	GuestMachine machine;
+	WriteBytes(machine, 0x00, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15});
+	WriteBytes(machine, 0x10, {16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31});
+	WriteFloat(machine, 0x20, 3e9f);
+	WriteFloat(machine, 0x24, -2.75f);
+	WriteFloat(machine, 0x28, std::numeric_limits<float>::quiet_NaN());
+	WriteFloat(machine, 0x2c, -3e9f);
+	
+	machine.Load({
+		Li(4, 0x00),					// li r4, 0x00
+		Lvx(1, 2, 4),					// lvx v1, r2, r4
+		Li(4, 0x10),					// li r4, 0x10
+		Lvx(2, 2, 4),					// lvx v2, r2, r4
+		Li(4, 0x20),					// li r4, 0x20
+		Lvx(3, 2, 4),					// lvx v3, r2, r4
+		VX(524, 10, 5, 1),				// vspltb v10, v1, 5
+		VX(12, 11, 1, 2),				// vmrghb v11, v1, v2
+		VX(396, 12, 1, 2),				// vmrglw v12, v1, v2
+		VX(970, 13, 1, 3),				// vctsxs v13, v3, 1
+		VX(780, 14, 0x1d, 0),			// vspltisb v14, -3
+		VX(526, 15, 0, 14),				// vupkhsb v15, v14
+		Li(4, 0x100),					// li r4, 0x100
+		Stvx(10, 2, 4),					// stvx v10, r2, r4
+		Li(4, 0x110),					// li r4, 0x110
+		Stvx(11, 2, 4),					// stvx v11, r2, r4
+		Li(4, 0x120),					// li r4, 0x120
+		Stvx(12, 2, 4),					// stvx v12, r2, r4
+		Li(4, 0x130),					// li r4, 0x130
+		Stvx(13, 2, 4),					// stvx v13, r2, r4
+		Li(4, 0x140),					// li r4, 0x140
+		Stvx(15, 2, 4),					// stvx v15, r2, r4
+		Blr,
+	});
+	machine.Run();
+	
+	CheckBytes(machine, 0x100, {5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5}, __LINE__);
+	CheckBytes(machine, 0x110, {0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23}, __LINE__);
+	CheckBytes(machine, 0x120, {8, 9, 10, 11, 24, 25, 26, 27, 12, 13, 14, 15, 28, 29, 30, 31}, __LINE__);
+	CHECK_EQUAL(machine.DataWord(0x130), 0x7fffffffu); // saturated
+	CHECK_EQUAL(machine.DataWord(0x134), static_cast<uint32_t>(-5)); // -5.5, truncated
+	CHECK_EQUAL(machine.DataWord(0x138), 0u); // NaN
+	CHECK_EQUAL(machine.DataWord(0x13c), 0x80000000u);
+	CHECK_EQUAL(machine.state.vscr, 1u);
+	CheckBytes(machine, 0x140, {0xff, 0xfd, 0xff, 0xfd, 0xff, 0xfd, 0xff, 0xfd, 0xff, 0xfd, 0xff, 0xfd, 0xff, 0xfd, 0xff, 0xfd}, __LINE__);
+}
@@ -0,0 +1,1508 @@
+//
+// VectorInstructions.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <emmintrin.h>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#if defined(__FMA__)
+#include <immintrin.h>
+#endif
+#include "Interpreter.h"
+#include "BigEndian.h"
+#include "GuestLayout.h"
+
+// AltiVec instructions map to SSE2 whenever SSE2 has a matching operation. Since vector registers are stored
+// byte-reversed (see MachineState.h), element-wise operations work as they are; only the instructions that move
+// elements around (merges, splats, packs, permutes, and loads and stores) need to care about the order, and they
+// usually just swap their operands. What SSE2 can't do in a handful of instructions is done one element at a time.
+// The non-Java mode bit of the VSCR is ignored, and the floating-point estimates are exact.
+
+using namespace Common;
+
+namespace
+{
+	using namespace PPCVM;
+	
+	const uint32_t VSCR_SAT = 0x00000001;
+	
+	inline __m128i Get(const VectorRegister& v)
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(v.u8));
+	}
+	
+	inline __m128 GetFloat(const VectorRegister& v)
+	{
+		return _mm_loadu_ps(v.f32);
+	}
+	
+	inline void Set(VectorRegister& v, __m128i value)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(v.u8), value);
+	}
+	
+	inline void Set(VectorRegister& v, __m128 value)
+	{
+		_mm_storeu_ps(v.f32, value);
+	}
+	
+	inline __m128i Select(__m128i mask, __m128i ifSet, __m128i ifClear)
+	{
+		return _mm_or_si128(_mm_and_si128(mask, ifSet), _mm_andnot_si128(mask, ifClear));
+	}
+	
+	inline bool Differs(__m128i a, __m128i b)
+	{
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xffff;
+	}
+	
+	// SSE2 only has signed comparisons; flipping the sign bit turns them into unsigned ones
+	inline __m128i CompareGreaterU8(__m128i a, __m128i b)
+	{
+		const __m128i bias = _mm_set1_epi8(-128);
+		return _mm_cmpgt_epi8(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+	}
+	
+	inline __m128i CompareGreaterU16(__m128i a, __m128i b)
+	{
+		const __m128i bias = _mm_set1_epi16(-32768);
+		return _mm_cmpgt_epi16(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+	}
+	
+	inline __m128i CompareGreaterU32(__m128i a, __m128i b)
+	{
+		const __m128i bias = _mm_set1_epi32(std::numeric_limits<int32_t>::min());
+		return _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+	}
+	
+	template<typename T>
+	inline T* Elements(VectorRegister& v)
+	{
+		return reinterpret_cast<T*>(v.u8);
+	}
+	
+	template<typename T>
+	inline const T* Elements(const VectorRegister& v)
+	{
+		return reinterpret_cast<const T*>(v.u8);
+	}
+	
+	template<typename T, typename TFunction>
+	inline void ForEach(VectorRegister& d, const VectorRegister& b, TFunction&& function)
+	{
+		const T* y = Elements<T>(b);
+		T* result = Elements<T>(d);
+		for (size_t i = 0; i < 16 / sizeof(T); i++)
+			result[i] = function(y[i]);
+	}
+	
+	template<typename T, typename TFunction>
+	inline void ForEach(VectorRegister& d, const VectorRegister& a, const VectorRegister& b, TFunction&& function)
+	{
+		const T* x = Elements<T>(a);
+		const T* y = Elements<T>(b);
+		T* result = Elements<T>(d);
+		for (size_t i = 0; i < 16 / sizeof(T); i++)
+			result[i] = function(x[i], y[i]);
+	}
+	
+	template<typename T>
+	inline T Saturate(int64_t value, bool& saturated)
+	{
+		if (value > std::numeric_limits<T>::max())
+		{
+			saturated = true;
+			return std::numeric_limits<T>::max();
+		}
+		if (value < std::numeric_limits<T>::min())
+		{
+			saturated = true;
+			return std::numeric_limits<T>::min();
+		}
+		return static_cast<T>(value);
+	}
+	
+	// Packs b into the low half of the result and a into the high half, which puts a first in AltiVec order.
+	template<typename TFrom, typename TTo>
+	bool Pack(VectorRegister& d, const VectorRegister& a, const VectorRegister& b)
+	{
+		const size_t count = 16 / sizeof(TFrom);
+		const TFrom* x = Elements<TFrom>(a);
+		const TFrom* y = Elements<TFrom>(b);
+		
+		bool saturated = false;
+		VectorRegister result;
+		TTo* to = Elements<TTo>(result);
+		for (size_t i = 0; i < count; i++)
+		{
+			to[i] = Saturate<TTo>(y[i], saturated);
+			to[count + i] = Saturate<TTo>(x[i], saturated);
+		}
+		d = result;
+		return saturated;
+	}
+	
+	inline void SetSaturation(MachineState& state, bool saturated)
+	{
+		if (saturated)
+			state.vscr |= VSCR_SAT;
+	}
+	
+	template<bool Rc>
+	void SetCompareResult(MachineState& state, Instruction inst, __m128i result)
+	{
+		Set(state.vr[inst.VD], result);
+		if (Rc)
+		{
+			int bits = _mm_movemask_epi8(result);
+			state.cr[6] = bits == 0xffff ? 0b1000 : bits == 0 ? 0b0010 : 0;
+		}
+	}
+	
+	inline uint32_t GetEffectiveAddress(MachineState& state, Instruction inst)
+	{
+		return (inst.RA == 0 ? 0 : state.gpr[inst.RA]) + state.gpr[inst.RB];
+	}
+	
+	inline uint16_t PackPixel(uint32_t pixel)
+	{
+		return ((pixel >> 9) & 0xfc00) | ((pixel >> 6) & 0x3e0) | ((pixel >> 3) & 0x1f);
+	}
+	
+	inline uint32_t UnpackPixel(uint16_t pixel)
+	{
+		uint32_t alpha = pixel & 0x8000 ? 0xff000000 : 0;
+		return alpha | ((pixel & 0x7c00) << 6) | ((pixel & 0x3e0) << 3) | (pixel & 0x1f);
+	}
+	
+	// AltiVec rounds to nearest regardless of the rounding mode, which belongs to the FPSCR
+	inline float RoundToNearest(float value)
+	{
+		if (!std::isfinite(value))
+			return value;
+		return std::copysign(value - std::remainder(value, 1.0f), value);
+	}
+}
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+#pragma mark -
+#pragma mark Loads and Stores
+		void Interpreter::lvebx(Instruction inst)
+		{
+			uint32_t address = GetEffectiveAddress(state, inst);
+			state.vr[inst.VD].u8[15 - (address & 15)] = *GuestLayout::Byte(memory.ToPointer<uint8_t>(address));
+		}
+		
+		void Interpreter::lvehx(Instruction inst)
+		{
+			uint32_t address = GetEffectiveAddress(state, inst) & ~1;
+			state.vr[inst.VD].u16[7 - ((address & 15) >> 1)] = memory.ToPointer<UInt16>(address)->Get();
+		}
+		
+		void Interpreter::lvewx(Instruction inst)
+		{
+			uint32_t address = GetEffectiveAddress(state, inst) & ~3;
+			state.vr[inst.VD].u32[3 - ((address & 15) >> 2)] = memory.ToPointer<UInt32>(address)->Get();
+		}
+		
+		void Interpreter::lvsl(Instruction inst)
+		{
+			uint8_t shift = GetEffectiveAddress(state, inst) & 15;
+			for (int i = 0; i < 16; i++)
+				state.vr[inst.VD].u8[i] = shift + 15 - i;
+		}
+		
+		void Interpreter::lvsr(Instruction inst)
+		{
+			uint8_t shift = GetEffectiveAddress(state, inst) & 15;
+			for (int i = 0; i < 16; i++)
+				state.vr[inst.VD].u8[i] = 31 - shift - i;
+		}
+		
+		void Interpreter::lvx(Instruction inst)
+		{
+			// two big-endian doublewords, in reverse order, are the whole vector reversed
+			const UInt64* address = memory.ToArray<UInt64>(GetEffectiveAddress(state, inst) & ~15, 2);
+			VectorRegister& d = state.vr[inst.VD];
+			d.u64[1] = address[0];
+			d.u64[0] = address[1];
+		}
+		
+		void Interpreter::lvxl(Instruction inst)
+		{
+			lvx(inst);
+		}
+		
+		void Interpreter::stvebx(Instruction inst)
+		{
+			uint32_t address = GetEffectiveAddress(state, inst);
+			*GuestLayout::Byte(memory.ToPointer<uint8_t>(address)) = state.vr[inst.VD].u8[15 - (address & 15)];
+		}
+		
+		void Interpreter::stvehx(Instruction inst)
+		{
+			uint32_t address = GetEffectiveAddress(state, inst) & ~1;
+			*memory.ToPointer<UInt16>(address) = state.vr[inst.VD].u16[7 - ((address & 15) >> 1)];
+		}
+		
+		void Interpreter::stvewx(Instruction inst)
+		{
+			uint32_t address = GetEffectiveAddress(state, inst) & ~3;
+			*memory.ToPointer<UInt32>(address) = state.vr[inst.VD].u32[3 - ((address & 15) >> 2)];
+		}
+		
+		void Interpreter::stvx(Instruction inst)
+		{
+			UInt64* address = memory.ToArray<UInt64>(GetEffectiveAddress(state, inst) & ~15, 2);
+			const VectorRegister& d = state.vr[inst.VD];
+			address[0] = d.u64[1];
+			address[1] = d.u64[0];
+		}
+		
+		void Interpreter::stvxl(Instruction inst)
+		{
+			stvx(inst);
+		}
+		
+		// data stream touches are only hints
+		void Interpreter::dss(Instruction inst)
+		{
+		}
+		
+		void Interpreter::dst(Instruction inst)
+		{
+		}
+		
+		void Interpreter::dstst(Instruction inst)
+		{
+		}
+		
+#pragma mark -
+#pragma mark Status and Control
+		void Interpreter::mfvscr(Instruction inst)
+		{
+			VectorRegister& d = state.vr[inst.VD];
+			Set(d, _mm_setzero_si128());
+			d.u32[0] = state.vscr;
+		}
+		
+		void Interpreter::mtvscr(Instruction inst)
+		{
+			state.vscr = state.vr[inst.VB].u32[0];
+		}
+		
+#pragma mark -
+#pragma mark Integer Arithmetic
+		void Interpreter::vaddubm(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_add_epi8(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vadduhm(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_add_epi16(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vadduwm(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_add_epi32(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vaddcuw(Instruction inst)
+		{
+			// a + b carries out when b > ~a
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			__m128i notA = _mm_xor_si128(a, _mm_set1_epi32(-1));
+			Set(state.vr[inst.VD], _mm_srli_epi32(CompareGreaterU32(b, notA), 31));
+		}
+		
+		void Interpreter::vaddubs(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			__m128i result = _mm_adds_epu8(a, b);
+			SetSaturation(state, Differs(result, _mm_add_epi8(a, b)));
+			Set(state.vr[inst.VD], result);
+		}
+		
+		void Interpreter::vadduhs(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			__m128i result = _mm_adds_epu16(a, b);
+			SetSaturation(state, Differs(result, _mm_add_epi16(a, b)));
+			Set(state.vr[inst.VD], result);
+		}
+		
+		void Interpreter::vadduws(Instruction inst)
+		{
+			bool saturated = false;
+			ForEach<uint32_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [&](uint32_t a, uint32_t b) {
+				return Saturate<uint32_t>(int64_t(a) + b, saturated);
+			});
+			SetSaturation(state, saturated);
+		}
+		
+		void Interpreter::vaddsbs(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			__m128i result = _mm_adds_epi8(a, b);
+			SetSaturation(state, Differs(result, _mm_add_epi8(a, b)));
+			Set(state.vr[inst.VD], result);
+		}
+		
+		void Interpreter::vaddshs(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			__m128i result = _mm_adds_epi16(a, b);
+			SetSaturation(state, Differs(result, _mm_add_epi16(a, b)));
+			Set(state.vr[inst.VD], result);
+		}
+		
+		void Interpreter::vaddsws(Instruction inst)
+		{
+			bool saturated = false;
+			ForEach<int32_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [&](int32_t a, int32_t b) {
+				return Saturate<int32_t>(int64_t(a) + b, saturated);
+			});
+			SetSaturation(state, saturated);
+		}
+		
+		void Interpreter::vsububm(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_sub_epi8(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vsubuhm(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_sub_epi16(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vsubuwm(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_sub_epi32(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vsubcuw(Instruction inst)
+		{
+			// a - b doesn't borrow unless b > a
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			Set(state.vr[inst.VD], _mm_andnot_si128(CompareGreaterU32(b, a), _mm_set1_epi32(1)));
+		}
+		
+		void Interpreter::vsububs(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			__m128i result = _mm_subs_epu8(a, b);
+			SetSaturation(state, Differs(result, _mm_sub_epi8(a, b)));
+			Set(state.vr[inst.VD], result);
+		}
+		
+		void Interpreter::vsubuhs(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			__m128i result = _mm_subs_epu16(a, b);
+			SetSaturation(state, Differs(result, _mm_sub_epi16(a, b)));
+			Set(state.vr[inst.VD], result);
+		}
+		
+		void Interpreter::vsubuws(Instruction inst)
+		{
+			bool saturated = false;
+			ForEach<uint32_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [&](uint32_t a, uint32_t b) {
+				return Saturate<uint32_t>(int64_t(a) - b, saturated);
+			});
+			SetSaturation(state, saturated);
+		}
+		
+		void Interpreter::vsubsbs(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			__m128i result = _mm_subs_epi8(a, b);
+			SetSaturation(state, Differs(result, _mm_sub_epi8(a, b)));
+			Set(state.vr[inst.VD], result);
+		}
+		
+		void Interpreter::vsubshs(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			__m128i result = _mm_subs_epi16(a, b);
+			SetSaturation(state, Differs(result, _mm_sub_epi16(a, b)));
+			Set(state.vr[inst.VD], result);
+		}
+		
+		void Interpreter::vsubsws(Instruction inst)
+		{
+			bool saturated = false;
+			ForEach<int32_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [&](int32_t a, int32_t b) {
+				return Saturate<int32_t>(int64_t(a) - b, saturated);
+			});
+			SetSaturation(state, saturated);
+		}
+		
+		void Interpreter::vmaxub(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_max_epu8(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vmaxuh(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			Set(state.vr[inst.VD], Select(CompareGreaterU16(a, b), a, b));
+		}
+		
+		void Interpreter::vmaxuw(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			Set(state.vr[inst.VD], Select(CompareGreaterU32(a, b), a, b));
+		}
+		
+		void Interpreter::vmaxsb(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			Set(state.vr[inst.VD], Select(_mm_cmpgt_epi8(a, b), a, b));
+		}
+		
+		void Interpreter::vmaxsh(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_max_epi16(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vmaxsw(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			Set(state.vr[inst.VD], Select(_mm_cmpgt_epi32(a, b), a, b));
+		}
+		
+		void Interpreter::vminub(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_min_epu8(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vminuh(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			Set(state.vr[inst.VD], Select(CompareGreaterU16(a, b), b, a));
+		}
+		
+		void Interpreter::vminuw(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			Set(state.vr[inst.VD], Select(CompareGreaterU32(a, b), b, a));
+		}
+		
+		void Interpreter::vminsb(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			Set(state.vr[inst.VD], Select(_mm_cmpgt_epi8(a, b), b, a));
+		}
+		
+		void Interpreter::vminsh(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_min_epi16(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vminsw(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			Set(state.vr[inst.VD], Select(_mm_cmpgt_epi32(a, b), b, a));
+		}
+		
+		void Interpreter::vavgub(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_avg_epu8(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vavguh(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_avg_epu16(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vavguw(Instruction inst)
+		{
+			ForEach<uint32_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [](uint32_t a, uint32_t b) {
+				return static_cast<uint32_t>((uint64_t(a) + b + 1) >> 1);
+			});
+		}
+		
+		void Interpreter::vavgsb(Instruction inst)
+		{
+			ForEach<int8_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [](int8_t a, int8_t b) {
+				return static_cast<int8_t>((a + b + 1) >> 1);
+			});
+		}
+		
+		void Interpreter::vavgsh(Instruction inst)
+		{
+			ForEach<int16_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [](int16_t a, int16_t b) {
+				return static_cast<int16_t>((a + b + 1) >> 1);
+			});
+		}
+		
+		void Interpreter::vavgsw(Instruction inst)
+		{
+			ForEach<int32_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [](int32_t a, int32_t b) {
+				return static_cast<int32_t>((int64_t(a) + b + 1) >> 1);
+			});
+		}
+		
+#pragma mark -
+#pragma mark Integer Multiply
+		// AltiVec's even elements are odd elements here, and conversely.
+		void Interpreter::vmuleub(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			VectorRegister result;
+			for (int i = 0; i < 8; i++)
+				result.u16[i] = a.u8[i * 2 + 1] * b.u8[i * 2 + 1];
+			state.vr[inst.VD] = result;
+		}
+		
+		void Interpreter::vmuleuh(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			VectorRegister result;
+			for (int i = 0; i < 4; i++)
+				result.u32[i] = uint32_t(a.u16[i * 2 + 1]) * b.u16[i * 2 + 1];
+			state.vr[inst.VD] = result;
+		}
+		
+		void Interpreter::vmulesb(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			VectorRegister result;
+			for (int i = 0; i < 8; i++)
+				result.s16[i] = a.s8[i * 2 + 1] * b.s8[i * 2 + 1];
+			state.vr[inst.VD] = result;
+		}
+		
+		void Interpreter::vmulesh(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			VectorRegister result;
+			for (int i = 0; i < 4; i++)
+				result.s32[i] = a.s16[i * 2 + 1] * b.s16[i * 2 + 1];
+			state.vr[inst.VD] = result;
+		}
+		
+		void Interpreter::vmuloub(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			VectorRegister result;
+			for (int i = 0; i < 8; i++)
+				result.u16[i] = a.u8[i * 2] * b.u8[i * 2];
+			state.vr[inst.VD] = result;
+		}
+		
+		void Interpreter::vmulouh(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			VectorRegister result;
+			for (int i = 0; i < 4; i++)
+				result.u32[i] = uint32_t(a.u16[i * 2]) * b.u16[i * 2];
+			state.vr[inst.VD] = result;
+		}
+		
+		void Interpreter::vmulosb(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			VectorRegister result;
+			for (int i = 0; i < 8; i++)
+				result.s16[i] = a.s8[i * 2] * b.s8[i * 2];
+			state.vr[inst.VD] = result;
+		}
+		
+		void Interpreter::vmulosh(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			VectorRegister result;
+			for (int i = 0; i < 4; i++)
+				result.s32[i] = a.s16[i * 2] * b.s16[i * 2];
+			state.vr[inst.VD] = result;
+		}
+		
+		void Interpreter::vmhaddshs(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			const VectorRegister& c = state.vr[inst.VC];
+			bool saturated = false;
+			VectorRegister result;
+			for (int i = 0; i < 8; i++)
+				result.s16[i] = Saturate<int16_t>(((a.s16[i] * b.s16[i]) >> 15) + c.s16[i], saturated);
+			state.vr[inst.VD] = result;
+			SetSaturation(state, saturated);
+		}
+		
+		void Interpreter::vmhraddshs(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			const VectorRegister& c = state.vr[inst.VC];
+			bool saturated = false;
+			VectorRegister result;
+			for (int i = 0; i < 8; i++)
+				result.s16[i] = Saturate<int16_t>(((a.s16[i] * b.s16[i] + 0x4000) >> 15) + c.s16[i], saturated);
+			state.vr[inst.VD] = result;
+			SetSaturation(state, saturated);
+		}
+		
+		void Interpreter::vmladduhm(Instruction inst)
+		{
+			__m128i product = _mm_mullo_epi16(Get(state.vr[inst.VA]), Get(state.vr[inst.VB]));
+			Set(state.vr[inst.VD], _mm_add_epi16(product, Get(state.vr[inst.VC])));
+		}
+		
+		void Interpreter::vmsumubm(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			const VectorRegister& c = state.vr[inst.VC];
+			VectorRegister result;
+			for (int i = 0; i < 4; i++)
+			{
+				uint32_t sum = c.u32[i];
+				for (int j = i * 4; j < i * 4 + 4; j++)
+					sum += a.u8[j] * b.u8[j];
+				result.u32[i] = sum;
+			}
+			state.vr[inst.VD] = result;
+		}
+		
+		void Interpreter::vmsummbm(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			const VectorRegister& c = state.vr[inst.VC];
+			VectorRegister result;
+			for (int i = 0; i < 4; i++)
+			{
+				uint32_t sum = c.u32[i];
+				for (int j = i * 4; j < i * 4 + 4; j++)
+					sum += a.s8[j] * b.u8[j];
+				result.u32[i] = sum;
+			}
+			state.vr[inst.VD] = result;
+		}
+		
+		void Interpreter::vmsumuhm(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			const VectorRegister& c = state.vr[inst.VC];
+			VectorRegister result;
+			for (int i = 0; i < 4; i++)
+				result.u32[i] = c.u32[i] + uint32_t(a.u16[i * 2]) * b.u16[i * 2] + uint32_t(a.u16[i * 2 + 1]) * b.u16[i * 2 + 1];
+			state.vr[inst.VD] = result;
+		}
+		
+		void Interpreter::vmsumuhs(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			const VectorRegister& c = state.vr[inst.VC];
+			bool saturated = false;
+			VectorRegister result;
+			for (int i = 0; i < 4; i++)
+			{
+				int64_t sum = int64_t(c.u32[i]) + uint32_t(a.u16[i * 2]) * b.u16[i * 2] + uint32_t(a.u16[i * 2 + 1]) * b.u16[i * 2 + 1];
+				result.u32[i] = Saturate<uint32_t>(sum, saturated);
+			}
+			state.vr[inst.VD] = result;
+			SetSaturation(state, saturated);
+		}
+		
+		void Interpreter::vmsumshm(Instruction inst)
+		{
+			// pmaddwd adds the products of adjacent halfwords, which is exactly what this needs
+			__m128i products = _mm_madd_epi16(Get(state.vr[inst.VA]), Get(state.vr[inst.VB]));
+			Set(state.vr[inst.VD], _mm_add_epi32(products, Get(state.vr[inst.VC])));
+		}
+		
+		void Interpreter::vmsumshs(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			const VectorRegister& c = state.vr[inst.VC];
+			bool saturated = false;
+			VectorRegister result;
+			for (int i = 0; i < 4; i++)
+			{
+				int64_t sum = int64_t(c.s32[i]) + a.s16[i * 2] * b.s16[i * 2] + int64_t(a.s16[i * 2 + 1] * b.s16[i * 2 + 1]);
+				result.s32[i] = Saturate<int32_t>(sum, saturated);
+			}
+			state.vr[inst.VD] = result;
+			SetSaturation(state, saturated);
+		}
+		
+		void Interpreter::vsum4ubs(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			bool saturated = false;
+			VectorRegister result;
+			for (int i = 0; i < 4; i++)
+			{
+				int64_t sum = b.u32[i];
+				for (int j = i * 4; j < i * 4 + 4; j++)
+					sum += a.u8[j];
+				result.u32[i] = Saturate<uint32_t>(sum, saturated);
+			}
+			state.vr[inst.VD] = result;
+			SetSaturation(state, saturated);
+		}
+		
+		void Interpreter::vsum4sbs(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			bool saturated = false;
+			VectorRegister result;
+			for (int i = 0; i < 4; i++)
+			{
+				int64_t sum = b.s32[i];
+				for (int j = i * 4; j < i * 4 + 4; j++)
+					sum += a.s8[j];
+				result.s32[i] = Saturate<int32_t>(sum, saturated);
+			}
+			state.vr[inst.VD] = result;
+			SetSaturation(state, saturated);
+		}
+		
+		void Interpreter::vsum4shs(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			bool saturated = false;
+			VectorRegister result;
+			for (int i = 0; i < 4; i++)
+			{
+				int64_t sum = int64_t(b.s32[i]) + a.s16[i * 2] + a.s16[i * 2 + 1];
+				result.s32[i] = Saturate<int32_t>(sum, saturated);
+			}
+			state.vr[inst.VD] = result;
+			SetSaturation(state, saturated);
+		}
+		
+		void Interpreter::vsum2sws(Instruction inst)
+		{
+			// AltiVec words 1 and 3 are words 2 and 0 here
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			bool saturated = false;
+			VectorRegister result;
+			result.s32[0] = Saturate<int32_t>(int64_t(a.s32[0]) + a.s32[1] + b.s32[0], saturated);
+			result.s32[1] = 0;
+			result.s32[2] = Saturate<int32_t>(int64_t(a.s32[2]) + a.s32[3] + b.s32[2], saturated);
+			result.s32[3] = 0;
+			state.vr[inst.VD] = result;
+			SetSaturation(state, saturated);
+		}
+		
+		void Interpreter::vsumsws(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			bool saturated = false;
+			int64_t sum = int64_t(a.s32[0]) + a.s32[1] + a.s32[2] + a.s32[3] + b.s32[0];
+			int32_t result = Saturate<int32_t>(sum, saturated);
+			
+			VectorRegister& d = state.vr[inst.VD];
+			Set(d, _mm_setzero_si128());
+			d.s32[0] = result;
+			SetSaturation(state, saturated);
+		}
+		
+#pragma mark -
+#pragma mark Logic, Shifts and Rotations
+		void Interpreter::vand(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_and_si128(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vandc(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_andnot_si128(Get(state.vr[inst.VB]), Get(state.vr[inst.VA])));
+		}
+		
+		void Interpreter::vnor(Instruction inst)
+		{
+			__m128i result = _mm_or_si128(Get(state.vr[inst.VA]), Get(state.vr[inst.VB]));
+			Set(state.vr[inst.VD], _mm_xor_si128(result, _mm_set1_epi32(-1)));
+		}
+		
+		void Interpreter::vor(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_or_si128(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vxor(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_xor_si128(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vrlb(Instruction inst)
+		{
+			ForEach<uint8_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [](uint8_t a, uint8_t b) {
+				unsigned shift = b & 7;
+				return static_cast<uint8_t>((a << shift) | (a >> ((8 - shift) & 7)));
+			});
+		}
+		
+		void Interpreter::vrlh(Instruction inst)
+		{
+			ForEach<uint16_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [](uint16_t a, uint16_t b) {
+				unsigned shift = b & 15;
+				return static_cast<uint16_t>((a << shift) | (a >> ((16 - shift) & 15)));
+			});
+		}
+		
+		void Interpreter::vrlw(Instruction inst)
+		{
+			ForEach<uint32_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [](uint32_t a, uint32_t b) {
+				unsigned shift = b & 31;
+				return (a << shift) | (a >> ((32 - shift) & 31));
+			});
+		}
+		
+		void Interpreter::vslb(Instruction inst)
+		{
+			ForEach<uint8_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [](uint8_t a, uint8_t b) {
+				return static_cast<uint8_t>(a << (b & 7));
+			});
+		}
+		
+		void Interpreter::vslh(Instruction inst)
+		{
+			ForEach<uint16_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [](uint16_t a, uint16_t b) {
+				return static_cast<uint16_t>(a << (b & 15));
+			});
+		}
+		
+		void Interpreter::vslw(Instruction inst)
+		{
+			ForEach<uint32_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [](uint32_t a, uint32_t b) {
+				return a << (b & 31);
+			});
+		}
+		
+		void Interpreter::vsrb(Instruction inst)
+		{
+			ForEach<uint8_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [](uint8_t a, uint8_t b) {
+				return static_cast<uint8_t>(a >> (b & 7));
+			});
+		}
+		
+		void Interpreter::vsrh(Instruction inst)
+		{
+			ForEach<uint16_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [](uint16_t a, uint16_t b) {
+				return static_cast<uint16_t>(a >> (b & 15));
+			});
+		}
+		
+		void Interpreter::vsrw(Instruction inst)
+		{
+			ForEach<uint32_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [](uint32_t a, uint32_t b) {
+				return a >> (b & 31);
+			});
+		}
+		
+		void Interpreter::vsrab(Instruction inst)
+		{
+			ForEach<int8_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [](int8_t a, int8_t b) {
+				return static_cast<int8_t>(a >> (b & 7));
+			});
+		}
+		
+		void Interpreter::vsrah(Instruction inst)
+		{
+			ForEach<int16_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [](int16_t a, int16_t b) {
+				return static_cast<int16_t>(a >> (b & 15));
+			});
+		}
+		
+		void Interpreter::vsraw(Instruction inst)
+		{
+			ForEach<int32_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB], [](int32_t a, int32_t b) {
+				return a >> (b & 31);
+			});
+		}
+		
+		// Stored this way, a vector register is a little-endian 128-bit integer, so the whole-register shifts are
+		// regular shifts.
+		void Interpreter::vsl(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			unsigned shift = state.vr[inst.VB].u8[0] & 7;
+			uint64_t high = a.u64[1];
+			uint64_t low = a.u64[0];
+			if (shift != 0)
+			{
+				high = (high << shift) | (low >> (64 - shift));
+				low <<= shift;
+			}
+			
+			VectorRegister& d = state.vr[inst.VD];
+			d.u64[1] = high;
+			d.u64[0] = low;
+		}
+		
+		void Interpreter::vsr(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			unsigned shift = state.vr[inst.VB].u8[0] & 7;
+			uint64_t high = a.u64[1];
+			uint64_t low = a.u64[0];
+			if (shift != 0)
+			{
+				low = (low >> shift) | (high << (64 - shift));
+				high >>= shift;
+			}
+			
+			VectorRegister& d = state.vr[inst.VD];
+			d.u64[1] = high;
+			d.u64[0] = low;
+		}
+		
+		void Interpreter::vslo(Instruction inst)
+		{
+			unsigned shift = (state.vr[inst.VB].u8[0] >> 3) & 15;
+			uint8_t buffer[32] = {};
+			memcpy(buffer + 16, state.vr[inst.VA].u8, 16);
+			memcpy(state.vr[inst.VD].u8, buffer + 16 - shift, 16);
+		}
+		
+		void Interpreter::vsro(Instruction inst)
+		{
+			unsigned shift = (state.vr[inst.VB].u8[0] >> 3) & 15;
+			uint8_t buffer[32] = {};
+			memcpy(buffer, state.vr[inst.VA].u8, 16);
+			memcpy(state.vr[inst.VD].u8, buffer + shift, 16);
+		}
+		
+#pragma mark -
+#pragma mark Comparisons
+		template<bool Rc>
+		void Interpreter::vcmpequbx(Instruction inst)
+		{
+			SetCompareResult<Rc>(state, inst, _mm_cmpeq_epi8(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		template<bool Rc>
+		void Interpreter::vcmpequhx(Instruction inst)
+		{
+			SetCompareResult<Rc>(state, inst, _mm_cmpeq_epi16(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		template<bool Rc>
+		void Interpreter::vcmpequwx(Instruction inst)
+		{
+			SetCompareResult<Rc>(state, inst, _mm_cmpeq_epi32(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		template<bool Rc>
+		void Interpreter::vcmpgtubx(Instruction inst)
+		{
+			SetCompareResult<Rc>(state, inst, CompareGreaterU8(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		template<bool Rc>
+		void Interpreter::vcmpgtuhx(Instruction inst)
+		{
+			SetCompareResult<Rc>(state, inst, CompareGreaterU16(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		template<bool Rc>
+		void Interpreter::vcmpgtuwx(Instruction inst)
+		{
+			SetCompareResult<Rc>(state, inst, CompareGreaterU32(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		template<bool Rc>
+		void Interpreter::vcmpgtsbx(Instruction inst)
+		{
+			SetCompareResult<Rc>(state, inst, _mm_cmpgt_epi8(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		template<bool Rc>
+		void Interpreter::vcmpgtshx(Instruction inst)
+		{
+			SetCompareResult<Rc>(state, inst, _mm_cmpgt_epi16(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		template<bool Rc>
+		void Interpreter::vcmpgtswx(Instruction inst)
+		{
+			SetCompareResult<Rc>(state, inst, _mm_cmpgt_epi32(Get(state.vr[inst.VA]), Get(state.vr[inst.VB])));
+		}
+		
+		template<bool Rc>
+		void Interpreter::vcmpeqfpx(Instruction inst)
+		{
+			__m128 result = _mm_cmpeq_ps(GetFloat(state.vr[inst.VA]), GetFloat(state.vr[inst.VB]));
+			SetCompareResult<Rc>(state, inst, _mm_castps_si128(result));
+		}
+		
+		template<bool Rc>
+		void Interpreter::vcmpgefpx(Instruction inst)
+		{
+			__m128 result = _mm_cmpge_ps(GetFloat(state.vr[inst.VA]), GetFloat(state.vr[inst.VB]));
+			SetCompareResult<Rc>(state, inst, _mm_castps_si128(result));
+		}
+		
+		template<bool Rc>
+		void Interpreter::vcmpgtfpx(Instruction inst)
+		{
+			__m128 result = _mm_cmpgt_ps(GetFloat(state.vr[inst.VA]), GetFloat(state.vr[inst.VB]));
+			SetCompareResult<Rc>(state, inst, _mm_castps_si128(result));
+		}
+		
+		template<bool Rc>
+		void Interpreter::vcmpbfpx(Instruction inst)
+		{
+			// bit 0 is set when a > b, bit 1 when a < -b; NaNs set both
+			__m128 a = GetFloat(state.vr[inst.VA]);
+			__m128 b = GetFloat(state.vr[inst.VB]);
+			__m128 negativeB = _mm_xor_ps(b, _mm_set1_ps(-0.0f));
+			__m128i lessOrEqual = _mm_castps_si128(_mm_cmple_ps(a, b));
+			__m128i greaterOrEqual = _mm_castps_si128(_mm_cmpge_ps(a, negativeB));
+			__m128i result = _mm_or_si128(
+				_mm_andnot_si128(lessOrEqual, _mm_set1_epi32(0x80000000)),
+				_mm_andnot_si128(greaterOrEqual, _mm_set1_epi32(0x40000000)));
+			
+			Set(state.vr[inst.VD], result);
+			if (Rc)
+			{
+				bool inBounds = _mm_movemask_epi8(_mm_cmpeq_epi32(result, _mm_setzero_si128())) == 0xffff;
+				state.cr[6] = inBounds ? 0b0010 : 0;
+			}
+		}
+		
+#pragma mark -
+#pragma mark Floating Point
+		void Interpreter::vaddfp(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_add_ps(GetFloat(state.vr[inst.VA]), GetFloat(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vsubfp(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_sub_ps(GetFloat(state.vr[inst.VA]), GetFloat(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vmaddfp(Instruction inst)
+		{
+			__m128 a = GetFloat(state.vr[inst.VA]);
+			__m128 b = GetFloat(state.vr[inst.VB]);
+			__m128 c = GetFloat(state.vr[inst.VC]);
+#if defined(__FMA__)
+			Set(state.vr[inst.VD], _mm_fmadd_ps(a, c, b));
+#else
+			Set(state.vr[inst.VD], _mm_add_ps(_mm_mul_ps(a, c), b));
+#endif
+		}
+		
+		void Interpreter::vnmsubfp(Instruction inst)
+		{
+			__m128 a = GetFloat(state.vr[inst.VA]);
+			__m128 b = GetFloat(state.vr[inst.VB]);
+			__m128 c = GetFloat(state.vr[inst.VC]);
+#if defined(__FMA__)
+			Set(state.vr[inst.VD], _mm_fnmadd_ps(a, c, b));
+#else
+			Set(state.vr[inst.VD], _mm_sub_ps(b, _mm_mul_ps(a, c)));
+#endif
+		}
+		
+		void Interpreter::vmaxfp(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_max_ps(GetFloat(state.vr[inst.VA]), GetFloat(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vminfp(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_min_ps(GetFloat(state.vr[inst.VA]), GetFloat(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vrefp(Instruction inst)
+		{
+			// rcpps isn't as precise as AltiVec promises
+			Set(state.vr[inst.VD], _mm_div_ps(_mm_set1_ps(1), GetFloat(state.vr[inst.VB])));
+		}
+		
+		void Interpreter::vrsqrtefp(Instruction inst)
+		{
+			__m128 root = _mm_sqrt_ps(GetFloat(state.vr[inst.VB]));
+			Set(state.vr[inst.VD], _mm_div_ps(_mm_set1_ps(1), root));
+		}
+		
+		void Interpreter::vexptefp(Instruction inst)
+		{
+			ForEach<float>(state.vr[inst.VD], state.vr[inst.VB], [](float b) { return std::exp2(b); });
+		}
+		
+		void Interpreter::vlogefp(Instruction inst)
+		{
+			ForEach<float>(state.vr[inst.VD], state.vr[inst.VB], [](float b) { return std::log2(b); });
+		}
+		
+		void Interpreter::vrfin(Instruction inst)
+		{
+			ForEach<float>(state.vr[inst.VD], state.vr[inst.VB], RoundToNearest);
+		}
+		
+		void Interpreter::vrfim(Instruction inst)
+		{
+			ForEach<float>(state.vr[inst.VD], state.vr[inst.VB], [](float b) { return std::floor(b); });
+		}
+		
+		void Interpreter::vrfip(Instruction inst)
+		{
+			ForEach<float>(state.vr[inst.VD], state.vr[inst.VB], [](float b) { return std::ceil(b); });
+		}
+		
+		void Interpreter::vrfiz(Instruction inst)
+		{
+			ForEach<float>(state.vr[inst.VD], state.vr[inst.VB], [](float b) { return std::trunc(b); });
+		}
+		
+		void Interpreter::vcfsx(Instruction inst)
+		{
+			__m128 value = _mm_cvtepi32_ps(Get(state.vr[inst.VB]));
+			float scale = std::ldexp(1.0f, -static_cast<int>(inst.VUIMM));
+			Set(state.vr[inst.VD], _mm_mul_ps(value, _mm_set1_ps(scale)));
+		}
+		
+		void Interpreter::vcfux(Instruction inst)
+		{
+			int scale = inst.VUIMM;
+			VectorRegister& d = state.vr[inst.VD];
+			const VectorRegister& b = state.vr[inst.VB];
+			for (int i = 0; i < 4; i++)
+				d.f32[i] = std::ldexp(static_cast<float>(b.u32[i]), -scale);
+		}
+		
+		void Interpreter::vctsxs(Instruction inst)
+		{
+			int scale = inst.VUIMM;
+			bool saturated = false;
+			VectorRegister& d = state.vr[inst.VD];
+			const VectorRegister& b = state.vr[inst.VB];
+			for (int i = 0; i < 4; i++)
+			{
+				double value = std::trunc(std::ldexp(static_cast<double>(b.f32[i]), scale));
+				if (std::isnan(value))
+					d.s32[i] = 0;
+				else
+					d.s32[i] = Saturate<int32_t>(static_cast<int64_t>(std::fmax(std::fmin(value, 0x1p40), -0x1p40)), saturated);
+			}
+			SetSaturation(state, saturated);
+		}
+		
+		void Interpreter::vctuxs(Instruction inst)
+		{
+			int scale = inst.VUIMM;
+			bool saturated = false;
+			VectorRegister& d = state.vr[inst.VD];
+			const VectorRegister& b = state.vr[inst.VB];
+			for (int i = 0; i < 4; i++)
+			{
+				double value = std::trunc(std::ldexp(static_cast<double>(b.f32[i]), scale));
+				if (std::isnan(value))
+					d.u32[i] = 0;
+				else
+					d.u32[i] = Saturate<uint32_t>(static_cast<int64_t>(std::fmax(std::fmin(value, 0x1p40), -0x1p40)), saturated);
+			}
+			SetSaturation(state, saturated);
+		}
+		
+#pragma mark -
+#pragma mark Permutations
+		void Interpreter::vmrghb(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_unpackhi_epi8(Get(state.vr[inst.VB]), Get(state.vr[inst.VA])));
+		}
+		
+		void Interpreter::vmrghh(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_unpackhi_epi16(Get(state.vr[inst.VB]), Get(state.vr[inst.VA])));
+		}
+		
+		void Interpreter::vmrghw(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_unpackhi_epi32(Get(state.vr[inst.VB]), Get(state.vr[inst.VA])));
+		}
+		
+		void Interpreter::vmrglb(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_unpacklo_epi8(Get(state.vr[inst.VB]), Get(state.vr[inst.VA])));
+		}
+		
+		void Interpreter::vmrglh(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_unpacklo_epi16(Get(state.vr[inst.VB]), Get(state.vr[inst.VA])));
+		}
+		
+		void Interpreter::vmrglw(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_unpacklo_epi32(Get(state.vr[inst.VB]), Get(state.vr[inst.VA])));
+		}
+		
+		void Interpreter::vspltb(Instruction inst)
+		{
+			int8_t element = state.vr[inst.VB].s8[15 - (inst.VUIMM & 15)];
+			Set(state.vr[inst.VD], _mm_set1_epi8(element));
+		}
+		
+		void Interpreter::vsplth(Instruction inst)
+		{
+			int16_t element = state.vr[inst.VB].s16[7 - (inst.VUIMM & 7)];
+			Set(state.vr[inst.VD], _mm_set1_epi16(element));
+		}
+		
+		void Interpreter::vspltw(Instruction inst)
+		{
+			int32_t element = state.vr[inst.VB].s32[3 - (inst.VUIMM & 3)];
+			Set(state.vr[inst.VD], _mm_set1_epi32(element));
+		}
+		
+		void Interpreter::vspltisb(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_set1_epi8(inst.VSIMM));
+		}
+		
+		void Interpreter::vspltish(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_set1_epi16(inst.VSIMM));
+		}
+		
+		void Interpreter::vspltisw(Instruction inst)
+		{
+			Set(state.vr[inst.VD], _mm_set1_epi32(inst.VSIMM));
+		}
+		
+		void Interpreter::vperm(Instruction inst)
+		{
+			// Byte i of the result is byte c[i] of a:b. With everything reversed, that's byte 31 - c[i] of b:a.
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			__m128i index = _mm_andnot_si128(Get(state.vr[inst.VC]), _mm_set1_epi8(0x1f));
+#if defined(__SSSE3__)
+			// pshufb only looks at the low 4 bits of the index (unless the top bit is set, which it isn't)
+			__m128i fromA = _mm_shuffle_epi8(a, index);
+			__m128i fromB = _mm_shuffle_epi8(b, index);
+			__m128i useA = _mm_cmpgt_epi8(index, _mm_set1_epi8(15));
+			Set(state.vr[inst.VD], Select(useA, fromA, fromB));
+#else
+			uint8_t table[32];
+			uint8_t indices[16];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(table), b);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(table + 16), a);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(indices), index);
+			
+			VectorRegister& d = state.vr[inst.VD];
+			for (int i = 0; i < 16; i++)
+				d.u8[i] = table[indices[i]];
+#endif
+		}
+		
+		void Interpreter::vsel(Instruction inst)
+		{
+			__m128i mask = Get(state.vr[inst.VC]);
+			Set(state.vr[inst.VD], Select(mask, Get(state.vr[inst.VB]), Get(state.vr[inst.VA])));
+		}
+		
+		void Interpreter::vsldoi(Instruction inst)
+		{
+			uint8_t buffer[32];
+			memcpy(buffer, state.vr[inst.VB].u8, 16);
+			memcpy(buffer + 16, state.vr[inst.VA].u8, 16);
+			memcpy(state.vr[inst.VD].u8, buffer + 16 - inst.SHB, 16);
+		}
+		
+#pragma mark -
+#pragma mark Packing and Unpacking
+		void Interpreter::vpkuhum(Instruction inst)
+		{
+			__m128i lowBytes = _mm_set1_epi16(0xff);
+			__m128i a = _mm_and_si128(Get(state.vr[inst.VA]), lowBytes);
+			__m128i b = _mm_and_si128(Get(state.vr[inst.VB]), lowBytes);
+			Set(state.vr[inst.VD], _mm_packus_epi16(b, a));
+		}
+		
+		void Interpreter::vpkuwum(Instruction inst)
+		{
+			// sign-extending the low halfwords first keeps packssdw from saturating
+			__m128i a = _mm_srai_epi32(_mm_slli_epi32(Get(state.vr[inst.VA]), 16), 16);
+			__m128i b = _mm_srai_epi32(_mm_slli_epi32(Get(state.vr[inst.VB]), 16), 16);
+			Set(state.vr[inst.VD], _mm_packs_epi32(b, a));
+		}
+		
+		void Interpreter::vpkuhus(Instruction inst)
+		{
+			SetSaturation(state, Pack<uint16_t, uint8_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB]));
+		}
+		
+		void Interpreter::vpkuwus(Instruction inst)
+		{
+			SetSaturation(state, Pack<uint32_t, uint16_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB]));
+		}
+		
+		void Interpreter::vpkshss(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			__m128i result = _mm_packs_epi16(b, a);
+			__m128i low = _mm_srai_epi16(_mm_unpacklo_epi8(result, result), 8);
+			__m128i high = _mm_srai_epi16(_mm_unpackhi_epi8(result, result), 8);
+			SetSaturation(state, Differs(low, b) || Differs(high, a));
+			Set(state.vr[inst.VD], result);
+		}
+		
+		void Interpreter::vpkshus(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			__m128i result = _mm_packus_epi16(b, a);
+			__m128i low = _mm_unpacklo_epi8(result, _mm_setzero_si128());
+			__m128i high = _mm_unpackhi_epi8(result, _mm_setzero_si128());
+			SetSaturation(state, Differs(low, b) || Differs(high, a));
+			Set(state.vr[inst.VD], result);
+		}
+		
+		void Interpreter::vpkswss(Instruction inst)
+		{
+			__m128i a = Get(state.vr[inst.VA]);
+			__m128i b = Get(state.vr[inst.VB]);
+			__m128i result = _mm_packs_epi32(b, a);
+			__m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(result, result), 16);
+			__m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(result, result), 16);
+			SetSaturation(state, Differs(low, b) || Differs(high, a));
+			Set(state.vr[inst.VD], result);
+		}
+		
+		void Interpreter::vpkswus(Instruction inst)
+		{
+			SetSaturation(state, Pack<int32_t, uint16_t>(state.vr[inst.VD], state.vr[inst.VA], state.vr[inst.VB]));
+		}
+		
+		void Interpreter::vpkpx(Instruction inst)
+		{
+			const VectorRegister& a = state.vr[inst.VA];
+			const VectorRegister& b = state.vr[inst.VB];
+			VectorRegister result;
+			for (int i = 0; i < 4; i++)
+			{
+				result.u16[i] = PackPixel(b.u32[i]);
+				result.u16[i + 4] = PackPixel(a.u32[i]);
+			}
+			state.vr[inst.VD] = result;
+		}
+		
+		void Interpreter::vupkhsb(Instruction inst)
+		{
+			__m128i b = Get(state.vr[inst.VB]);
+			Set(state.vr[inst.VD], _mm_srai_epi16(_mm_unpackhi_epi8(b, b), 8));
+		}
+		
+		void Interpreter::vupkhsh(Instruction inst)
+		{
+			__m128i b = Get(state.vr[inst.VB]);
+			Set(state.vr[inst.VD], _mm_srai_epi32(_mm_unpackhi_epi16(b, b), 16));
+		}
+		
+		void Interpreter::vupklsb(Instruction inst)
+		{
+			__m128i b = Get(state.vr[inst.VB]);
+			Set(state.vr[inst.VD], _mm_srai_epi16(_mm_unpacklo_epi8(b, b), 8));
+		}
+		
+		void Interpreter::vupklsh(Instruction inst)
+		{
+			__m128i b = Get(state.vr[inst.VB]);
+			Set(state.vr[inst.VD], _mm_srai_epi32(_mm_unpacklo_epi16(b, b), 16));
+		}
+		
+		void Interpreter::vupkhpx(Instruction inst)
+		{
+			const VectorRegister& b = state.vr[inst.VB];
+			VectorRegister result;
+			for (int i = 0; i < 4; i++)
+				result.u32[i] = UnpackPixel(b.u16[i + 4]);
+			state.vr[inst.VD] = result;
+		}
+		
+		void Interpreter::vupklpx(Instruction inst)
+		{
+			const VectorRegister& b = state.vr[inst.VB];
+			VectorRegister result;
+			for (int i = 0; i < 4; i++)
+				result.u32[i] = UnpackPixel(b.u16[i]);
+			state.vr[inst.VD] = result;
+		}
+		
+#pragma mark -
+#pragma mark Variants
+		INSTANTIATE_RC(Interpreter, vcmpequbx);
+		INSTANTIATE_RC(Interpreter, vcmpequhx);
+		INSTANTIATE_RC(Interpreter, vcmpequwx);
+		INSTANTIATE_RC(Interpreter, vcmpgtubx);
+		INSTANTIATE_RC(Interpreter, vcmpgtuhx);
+		INSTANTIATE_RC(Interpreter, vcmpgtuwx);
+		INSTANTIATE_RC(Interpreter, vcmpgtsbx);
+		INSTANTIATE_RC(Interpreter, vcmpgtshx);
+		INSTANTIATE_RC(Interpreter, vcmpgtswx);
+		INSTANTIATE_RC(Interpreter, vcmpeqfpx);
+		INSTANTIATE_RC(Interpreter, vcmpgefpx);
+		INSTANTIATE_RC(Interpreter, vcmpgtfpx);
+		INSTANTIATE_RC(Interpreter, vcmpbfpx);
+	}
+}
@@ -26,6 +26,21 @@
 
 namespace PPCVM
 {
+	// Vector registers are kept with their 16 bytes in reverse order. This way, the host sees each element with
+	// the right value and can use its own SIMD instructions on them, but element n of an AltiVec vector that has
+	// N elements is found at index N - 1 - n of these arrays.
+	union VectorRegister
+	{
+		uint8_t u8[16];
+		int8_t s8[16];
+		uint16_t u16[8];
+		int16_t s16[8];
+		uint32_t u32[4];
+		int32_t s32[4];
+		uint64_t u64[2];
+		float f32[4];
+	};
+	
 	struct MachineState
 	{
 		union
@@ -95,6 +110,11 @@ namespace PPCVM
 			unsigned hex;
 		} fpscr;
 		
+		// vector unit
+		VectorRegister vr[32];
+		uint32_t vscr;
+		uint32_t vrsave;
+		
 		MachineState();
 		
 		uint32_t GetCR() const;
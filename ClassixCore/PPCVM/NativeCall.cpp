@@ -20,9 +20,37 @@
 //
 
 #include "NativeCall.h"
+#include <dlfcn.h>
+
+namespace
+{
+	const char* BaseName(const char* path)
+	{
+		const char* lastPathComponent = path;
+		while (*path != 0)
+		{
+			if (*path == '/')
+				lastPathComponent = path + 1;
+			path++;
+		}
+		return lastPathComponent;
+	}
+}
 
 extern const uint32_t PPCVM::Execution::NativeTag = 0x4e544956; // 'NTIV'
 
+std::string PPCVM::Execution::NativeCallbackName(const void* callback)
+{
+	Dl_info symInfo;
+	if (dladdr(callback, &symInfo) == 0)
+		return "";
+	
+	std::string name = BaseName(symInfo.dli_fname);
+	if (symInfo.dli_sname != nullptr)
+		name = name + "::" + symInfo.dli_sname;
+	return name;
+}
+
 PPCVM::Execution::NativeCall::NativeCall(NativeCallback& cb)
 : Callback(cb)
 {
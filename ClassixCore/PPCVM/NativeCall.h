@@ -22,6 +22,7 @@
 #ifndef pefdump_NativeCall_h
 #define pefdump_NativeCall_h
 
+#include <string>
 #include "MachineState.h"
 
 namespace PPCVM
@@ -31,6 +32,9 @@ namespace PPCVM
 		extern const uint32_t NativeTag;
 		typedef void NativeCallback(void*, MachineState*);
 		
+		// "library::symbol" for a native callback, as far as dladdr can tell, or an empty string
+		std::string NativeCallbackName(const void* callback);
+		
 		struct NativeCall
 		{
 			uint32_t Tag;
@@ -43,6 +47,12 @@ namespace PPCVM
 			: NativeCall(reinterpret_cast<NativeCall&>(cb))
 			{ }
 		};
+		
+		// NativeCalls live in host memory and their tag is stored as is, whatever the guest memory layout
+		inline bool IsNativeCall(const void* address)
+		{
+			return *static_cast<const uint32_t*>(address) == NativeTag;
+		}
 	}
 }
 
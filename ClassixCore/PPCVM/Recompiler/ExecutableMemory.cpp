@@ -0,0 +1,69 @@
+//
+// ExecutableMemory.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include <sys/mman.h>
+#include <errno.h>
+#include <cstring>
+#include <stdexcept>
+
+#include "ExecutableMemory.h"
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		ExecutableMemory::ExecutableMemory(size_t size)
+		: begin(nullptr), size(size), used(0)
+		{
+			if (size == 0)
+				return;
+			
+			void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANON, -1, 0);
+			if (address == MAP_FAILED)
+				throw std::logic_error(strerror(errno));
+			
+			begin = static_cast<uint8_t*>(address);
+		}
+		
+		void* ExecutableMemory::Write(const uint8_t* code, size_t codeSize)
+		{
+			// keep entry points 16-bytes aligned
+			size_t start = (used + 15) & ~size_t(15);
+			if (start + codeSize > size)
+				return nullptr;
+			
+			memcpy(begin + start, code, codeSize);
+			used = start + codeSize;
+			return begin + start;
+		}
+		
+		void ExecutableMemory::Reset()
+		{
+			used = 0;
+		}
+		
+		ExecutableMemory::~ExecutableMemory()
+		{
+			if (begin != nullptr)
+				munmap(begin, size);
+		}
+	}
+}
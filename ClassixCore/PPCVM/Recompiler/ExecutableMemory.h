@@ -0,0 +1,53 @@
+//
+// ExecutableMemory.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__ExecutableMemory__
+#define __Classix__ExecutableMemory__
+
+#include <cstdint>
+#include <cstddef>
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		// A single mapping that recompiled code is copied into. It's never freed piecewise: when it's full,
+		// the owner throws away every block and calls Reset().
+		class ExecutableMemory
+		{
+			uint8_t* begin;
+			size_t size;
+			size_t used;
+			
+		public:
+			ExecutableMemory(size_t size);
+			ExecutableMemory(const ExecutableMemory& that) = delete;
+			
+			// returns nullptr when there's not enough room left
+			void* Write(const uint8_t* code, size_t codeSize);
+			void Reset();
+			
+			~ExecutableMemory();
+		};
+	}
+}
+
+#endif /* defined(__Classix__ExecutableMemory__) */
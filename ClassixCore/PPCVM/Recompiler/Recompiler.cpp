@@ -0,0 +1,859 @@
+//
+// Recompiler.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include "Recompiler.h"
+#include "NativeCall.h"
+#include "TrapException.h"
+#include "InterpreterException.h"
+#include "AccessViolationException.h"
+#include <cstddef>
+#include <stdexcept>
+
+using namespace Common;
+
+namespace
+{
+	using namespace PPCVM;
+	using namespace PPCVM::Execution;
+	
+	const size_t CodeMemorySize = 16 * 1024 * 1024;
+	
+	// both are callee-saved, so they survive calls to the helpers
+	const X86Reg StateReg = X86Reg::BX;
+	const X86Reg ContextReg = X86Reg::BP;
+	
+	const int32_t XEROffset = offsetof(MachineState, xer);
+	const int32_t LROffset = offsetof(MachineState, lr);
+	const int32_t CTROffset = offsetof(MachineState, ctr);
+	const int32_t InterpretNextOffset = offsetof(Recompiler::Context, InterpretNext);
+	const int32_t ArenaBaseOffset = offsetof(Recompiler::Context, ArenaBase);
+	const int32_t FaultAddressOffset = offsetof(Recompiler::Context, FaultAddress);
+	
+	inline int32_t GPROffset(int gpr)
+	{
+		return static_cast<int32_t>(offsetof(MachineState, gpr) + gpr * sizeof(uint32_t));
+	}
+	
+	inline int32_t CROffset(int field)
+	{
+		return static_cast<int32_t>(offsetof(MachineState, cr) + field);
+	}
+	
+	inline uint32_t SignExt16(int16_t x)
+	{
+		return static_cast<uint32_t>(static_cast<int32_t>(x));
+	}
+	
+	inline uint32_t SignExt26(uint32_t x)
+	{
+		return (x & 0x02000000) ? (x | 0xfc000000) : x;
+	}
+	
+	inline bool EndsBlock(Instruction inst)
+	{
+		return inst.OPCD == 16 || inst.OPCD == 18 || (inst.OPCD == 19 && (inst.SUBOP10 == 16 || inst.SUBOP10 == 528));
+	}
+	
+	enum
+	{
+		BO_BRANCH_IF_CTR_0		=  2, // 3
+		BO_DONT_DECREMENT_FLAG	=  4, // 2
+		BO_BRANCH_IF_TRUE		=  8, // 1
+		BO_DONT_CHECK_CONDITION	= 16, // 0
+	};
+	
+	// only the flat arena can be accessed from compiled code without calling back into the allocator
+	uint8_t* GetArenaBase(const FlatMemoryAccess& memory)
+	{
+		return memory.GetBase();
+	}
+	
+	template<typename TMemoryAccess>
+	uint8_t* GetArenaBase(const TMemoryAccess& memory)
+	{
+		return nullptr;
+	}
+	
+	uint8_t* TranslateAddress(Recompiler::Context* context, uint32_t address, uint32_t size)
+	{
+		// Exceptions can't unwind through recompiled code. Returning nullptr makes the interpreter redo the
+		// access, and it will throw the exception itself.
+		try
+		{
+			return context->Allocator->ToArray<uint8_t>(address, size);
+		}
+		catch (...)
+		{
+			return nullptr;
+		}
+	}
+}
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		bool Recompiler::IsSupported()
+		{
+			// the emitted loads and stores assume big-endian guest memory
+#if defined(__x86_64__) && !CLASSIX_SWIZZLED_MEMORY
+			return true;
+#else
+			return false;
+#endif
+		}
+		
+		Recompiler::Recompiler(Allocator& allocator, MachineState& state, Interpreter& interpreter)
+		: state(state), allocator(allocator), interpreter(interpreter), faultHandler(allocator), memory(IsSupported() ? CodeMemorySize : 0), interrupted(false)
+		{
+			context.Allocator = &allocator;
+			context.ArenaBase = GetArenaBase(interpreter.GetMemoryAccess());
+			context.InterpretNext = 0;
+			context.FaultAddress = 0;
+			
+			// bitfield layout is up to the compiler, so ask it where the summary overflow bit is
+			MachineState probe;
+			probe.xer = 0;
+			probe.xer_so = 1;
+			summaryOverflowMask = probe.xer;
+			
+			codeListener = allocator.AddCodeListener([this](uint32_t address, uint32_t size)
+			{
+				blockCache.Invalidate(address, size);
+			});
+		}
+		
+		Recompiler::~Recompiler()
+		{
+			allocator.RemoveCodeListener(codeListener);
+		}
+		
+		void Recompiler::InvalidateCode(uint32_t address, uint32_t size)
+		{
+			allocator.InvalidateCode(address, size);
+		}
+		
+		void Recompiler::InvalidateCode(const void* address, size_t size)
+		{
+			allocator.InvalidateCode(allocator.ToIntPtr(address), static_cast<uint32_t>(size));
+		}
+		
+		void Recompiler::InvalidateAllCode()
+		{
+			blockCache.Clear();
+		}
+		
+		void Recompiler::Interrupt()
+		{
+			interrupted = true;
+		}
+		
+		void Recompiler::Execute(const UInt32* address)
+		{
+			if (!IsSupported())
+			{
+				interpreter.Execute(address);
+				return;
+			}
+			
+			// native calls that call back into the guest have the interpreter run the callee
+			GuestRunner::Scope runnerScope(interpreter);
+			uint32_t pc = allocator.ToIntPtr(address);
+			const uint32_t end = allocator.ToIntPtr(interpreter.GetEndAddress());
+			interrupted = false;
+			
+			// Compiled code reads and writes the arena directly, so bad guest pointers land here. Only members are
+			// used once Target has been jumped to; compiled code doesn't own anything that would need destruction.
+			MemoryFaultHandler::Scope faultScope(&faultHandler);
+			if (sigsetjmp(faultScope.Target, 0) != 0)
+				throw InterpreterException(context.FaultAddress, AccessViolationException(allocator, faultScope.GetFaultAddress(), 0));
+			
+			while (pc != end)
+			{
+				if (interrupted.exchange(false))
+					throw TrapException("interrupted");
+				
+				context.FaultAddress = pc;
+				const UInt32* code = allocator.ToPointer<UInt32>(pc);
+				if (IsNativeCall(code))
+				{
+					pc = ExecuteNative(reinterpret_cast<const NativeCall*>(code), pc);
+					continue;
+				}
+				
+				const CompiledBlock& block = GetBlock(pc);
+				if (block.Code == nullptr)
+				{
+					pc = allocator.ToIntPtr(interpreter.ExecuteOne(code));
+					continue;
+				}
+				
+				context.InterpretNext = 0;
+				pc = block.Code(&state, &context);
+				if (context.InterpretNext != 0)
+					pc = allocator.ToIntPtr(interpreter.ExecuteOne(allocator.ToPointer<UInt32>(pc)));
+			}
+		}
+		
+		uint32_t Recompiler::ExecuteNative(const NativeCall* function, uint32_t address)
+		{
+			try
+			{
+				// faults in library code aren't the guest's
+				MemoryFaultHandler::Scope nativeScope(nullptr);
+				void* libGlobals = allocator.ToPointer<void>(state.r2);
+				function->Callback(libGlobals, &state);
+			}
+			catch (PPCRuntimeException& ex)
+			{
+				throw InterpreterException(address, ex);
+			}
+			return state.lr;
+		}
+		
+		const Recompiler::CompiledBlock& Recompiler::GetBlock(uint32_t address)
+		{
+			allocator.DispatchCodeWrites();
+			if (const CompiledBlock* block = blockCache.Find(address))
+				return *block;
+			
+			return blockCache.Insert(Compile(address));
+		}
+		
+		Recompiler::CompiledBlock Recompiler::Compile(uint32_t address)
+		{
+			// don't translate past the end of the allocation that holds the code
+			uint32_t maxLength = BlockCache<CompiledBlock>::MaxBlockLength;
+			if (auto details = allocator.GetDetails(address))
+			{
+				uint32_t remaining = static_cast<uint32_t>(details->Size() - allocator.GetAllocationOffset(address)) / 4;
+				if (remaining != 0 && remaining < maxLength)
+					maxLength = remaining;
+			}
+			
+			allocator.WatchCode(address, maxLength * 4);
+			const UInt32* code = allocator.ToPointer<UInt32>(address);
+			emitter.Clear();
+			fallbackExits.clear();
+			EmitPrologue();
+			
+			uint32_t count = 0;
+			bool endsWithBranch = false;
+			while (count < maxLength && !IsNativeCall(&code[count]))
+			{
+				Instruction inst = code[count].Get();
+				if (!CompileInstruction(inst, address + count * 4))
+					break;
+				
+				count++;
+				if (EndsBlock(inst))
+				{
+					endsWithBranch = true;
+					break;
+				}
+			}
+			
+			CompiledBlock block;
+			block.Address = address;
+			if (count == 0)
+			{
+				block.Code = nullptr;
+				block.Size = 4;
+				return block;
+			}
+			
+			if (!endsWithBranch)
+				EmitExit(address + count * 4);
+			
+			for (const FallbackExit& exit : fallbackExits)
+				EmitFallback(exit.Label, exit.Address);
+			
+			void* entry = memory.Write(emitter.Data(), emitter.Size());
+			if (entry == nullptr)
+			{
+				// Out of room. Nothing is running compiled code at this point, so just start over.
+				blockCache.EraseAll();
+				memory.Reset();
+				entry = memory.Write(emitter.Data(), emitter.Size());
+				if (entry == nullptr)
+					throw std::logic_error("Recompiled block doesn't fit in executable memory");
+			}
+			
+			block.Code = reinterpret_cast<CompiledCode>(entry);
+			block.Size = count * 4;
+			return block;
+		}
+		
+#pragma mark -
+#pragma mark Code Generation Helpers
+		void Recompiler::EmitPrologue()
+		{
+			// entered with rsp = 8 mod 16; keep it 16-bytes aligned for the helper calls
+			emitter.Push(StateReg);
+			emitter.Push(ContextReg);
+			emitter.AdjustStack(-8);
+			emitter.Mov64(StateReg, X86Reg::DI);
+			emitter.Mov64(ContextReg, X86Reg::SI);
+		}
+		
+		void Recompiler::EmitEpilogue()
+		{
+			emitter.AdjustStack(8);
+			emitter.Pop(ContextReg);
+			emitter.Pop(StateReg);
+			emitter.Ret();
+		}
+		
+		void Recompiler::EmitExit(uint32_t address)
+		{
+			emitter.Mov(X86Reg::AX, address);
+			EmitEpilogue();
+		}
+		
+		void Recompiler::EmitFallback(X86Emitter::Label label, uint32_t address)
+		{
+			emitter.Bind(label);
+			emitter.Store(ContextReg, InterpretNextOffset, 1);
+			EmitExit(address);
+		}
+		
+		void Recompiler::EmitLoadGPR(X86Reg reg, int gpr)
+		{
+			emitter.Load(reg, StateReg, GPROffset(gpr));
+		}
+		
+		void Recompiler::EmitStoreGPR(int gpr, X86Reg reg)
+		{
+			emitter.Store(StateReg, GPROffset(gpr), reg);
+		}
+		
+		void Recompiler::EmitUpdateCR(int field, bool isSigned)
+		{
+			// expects flags set by a cmp or test; clobbers ECX and EDX
+			emitter.Mov(X86Reg::DX, 0b0010);
+			emitter.Mov(X86Reg::CX, 0b1000);
+			emitter.CMov(isSigned ? X86Condition::Less : X86Condition::Below, X86Reg::DX, X86Reg::CX);
+			emitter.Mov(X86Reg::CX, 0b0100);
+			emitter.CMov(isSigned ? X86Condition::Greater : X86Condition::Above, X86Reg::DX, X86Reg::CX);
+			emitter.Test(StateReg, XEROffset, summaryOverflowMask);
+			emitter.SetCC(X86Condition::NotEqual, X86Reg::CX);
+			emitter.Or8(X86Reg::DX, X86Reg::CX);
+			emitter.Store8(StateReg, CROffset(field), X86Reg::DX);
+		}
+		
+		void Recompiler::EmitUpdateCR0(X86Reg value)
+		{
+			emitter.Test(value, value);
+			EmitUpdateCR(0, true);
+		}
+		
+		void Recompiler::EmitEffectiveAddress(Instruction inst, bool indexed)
+		{
+			// into ESI, which is also where the helpers expect the address
+			if (inst.RA == 0)
+			{
+				if (indexed)
+					EmitLoadGPR(X86Reg::SI, inst.RB);
+				else
+					emitter.Mov(X86Reg::SI, SignExt16(inst.SIMM_16));
+			}
+			else
+			{
+				EmitLoadGPR(X86Reg::SI, inst.RA);
+				if (indexed)
+					emitter.Alu(X86Alu::Add, X86Reg::SI, StateReg, GPROffset(inst.RB));
+				else if (inst.SIMM_16 != 0)
+					emitter.Alu(X86Alu::Add, X86Reg::SI, SignExt16(inst.SIMM_16));
+			}
+		}
+		
+		void Recompiler::EmitTranslate(uint32_t size, uint32_t address)
+		{
+			// host pointer in RAX; a failed translation sends the instruction to the interpreter
+			if (context.ArenaBase != nullptr)
+			{
+				// if the access faults, Execute reports it at this instruction
+				emitter.Store(ContextReg, FaultAddressOffset, address);
+				// the 32-bits move clears the upper half of RAX
+				emitter.Mov(X86Reg::AX, X86Reg::SI);
+				emitter.Add64(X86Reg::AX, ContextReg, ArenaBaseOffset);
+				return;
+			}
+			
+			emitter.Mov64(X86Reg::DI, ContextReg);
+			emitter.Mov(X86Reg::DX, size);
+			emitter.Call(reinterpret_cast<const void*>(&TranslateAddress));
+			emitter.Test64(X86Reg::AX, X86Reg::AX);
+			fallbackExits.push_back({emitter.Jump(X86Condition::Equal), address});
+		}
+		
+		void Recompiler::EmitLoad(Instruction inst, uint32_t address, uint32_t size, bool indexed, bool update, bool algebraic)
+		{
+			EmitEffectiveAddress(inst, indexed);
+			EmitTranslate(size, address);
+			switch (size)
+			{
+				case 1:
+					emitter.Load8(X86Reg::AX, X86Reg::AX, 0);
+					break;
+					
+				case 2:
+					emitter.Load16(X86Reg::AX, X86Reg::AX, 0);
+					emitter.ByteSwap16(X86Reg::AX);
+					if (algebraic)
+						emitter.SignExtend16(X86Reg::AX, X86Reg::AX);
+					break;
+					
+				case 4:
+					emitter.Load(X86Reg::AX, X86Reg::AX, 0);
+					emitter.ByteSwap(X86Reg::AX);
+					break;
+			}
+			
+			if (update)
+				EmitEffectiveAddress(inst, indexed);
+			
+			EmitStoreGPR(inst.RD, X86Reg::AX);
+			
+			if (update)
+				EmitStoreGPR(inst.RA, X86Reg::SI);
+		}
+		
+		void Recompiler::EmitStore(Instruction inst, uint32_t address, uint32_t size, bool indexed, bool update)
+		{
+			EmitEffectiveAddress(inst, indexed);
+			EmitTranslate(size, address);
+			EmitLoadGPR(X86Reg::CX, inst.RS);
+			switch (size)
+			{
+				case 1:
+					emitter.Store8(X86Reg::AX, 0, X86Reg::CX);
+					break;
+					
+				case 2:
+					emitter.ByteSwap16(X86Reg::CX);
+					emitter.Store16(X86Reg::AX, 0, X86Reg::CX);
+					break;
+					
+				case 4:
+					emitter.ByteSwap(X86Reg::CX);
+					emitter.Store(X86Reg::AX, 0, X86Reg::CX);
+					break;
+			}
+			
+			if (update)
+			{
+				EmitEffectiveAddress(inst, indexed);
+				EmitStoreGPR(inst.RA, X86Reg::SI);
+			}
+		}
+		
+		void Recompiler::EmitBranchCondition(Instruction inst, bool checkCounter, std::vector<X86Emitter::Label>& notTaken)
+		{
+			if (checkCounter && (inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
+			{
+				emitter.Dec(StateReg, CTROffset);
+				notTaken.push_back(emitter.Jump((inst.BO & BO_BRANCH_IF_CTR_0) ? X86Condition::NotEqual : X86Condition::Equal));
+			}
+			
+			if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
+			{
+				emitter.Test8(StateReg, CROffset(inst.BI / 4), static_cast<uint8_t>(8 >> (inst.BI & 3)));
+				notTaken.push_back(emitter.Jump((inst.BO & BO_BRANCH_IF_TRUE) ? X86Condition::Equal : X86Condition::NotEqual));
+			}
+		}
+		
+#pragma mark -
+#pragma mark Instructions
+		bool Recompiler::CompileInstruction(Instruction inst, uint32_t address)
+		{
+			// Every case must decide whether it's supported before it emits anything.
+			switch (inst.OPCD)
+			{
+				case 7: // mulli
+					EmitLoadGPR(X86Reg::AX, inst.RA);
+					emitter.IMul(X86Reg::AX, X86Reg::AX, inst.SIMM_16);
+					EmitStoreGPR(inst.RD, X86Reg::AX);
+					return true;
+					
+				case 10: // cmpli
+					EmitLoadGPR(X86Reg::AX, inst.RA);
+					emitter.Alu(X86Alu::Cmp, X86Reg::AX, static_cast<uint32_t>(inst.UIMM));
+					EmitUpdateCR(inst.CRFD, false);
+					return true;
+					
+				case 11: // cmpi
+					// the interpreter compares the sign of the difference, so do the same
+					EmitLoadGPR(X86Reg::AX, inst.RA);
+					emitter.Alu(X86Alu::Sub, X86Reg::AX, SignExt16(inst.SIMM_16));
+					emitter.Test(X86Reg::AX, X86Reg::AX);
+					EmitUpdateCR(inst.CRFD, true);
+					return true;
+					
+				case 14: // addi
+				case 15: // addis
+				{
+					uint32_t immediate = inst.OPCD == 14 ? SignExt16(inst.SIMM_16) : SignExt16(inst.SIMM_16) << 16;
+					if (inst.RA == 0)
+					{
+						emitter.Store(StateReg, GPROffset(inst.RD), immediate);
+					}
+					else
+					{
+						EmitLoadGPR(X86Reg::AX, inst.RA);
+						emitter.Alu(X86Alu::Add, X86Reg::AX, immediate);
+						EmitStoreGPR(inst.RD, X86Reg::AX);
+					}
+					return true;
+				}
+					
+				case 16: // bcx
+				{
+					uint32_t target = SignExt16(static_cast<int16_t>(inst.BD << 2));
+					if (!inst.AA)
+						target += address;
+					
+					std::vector<X86Emitter::Label> notTaken;
+					EmitBranchCondition(inst, true, notTaken);
+					if (inst.LK)
+						emitter.Store(StateReg, LROffset, address + 4);
+					EmitExit(target);
+					
+					for (X86Emitter::Label label : notTaken)
+						emitter.Bind(label);
+					EmitExit(address + 4);
+					return true;
+				}
+					
+				case 18: // bx
+				{
+					uint32_t target = SignExt26(inst.LI << 2);
+					if (!inst.AA)
+						target += address;
+					
+					if (inst.LK)
+						emitter.Store(StateReg, LROffset, address + 4);
+					EmitExit(target);
+					return true;
+				}
+					
+				case 19:
+				{
+					// bclrl sets LR before it reads it in the interpreter; leave it there
+					bool isBclr = inst.SUBOP10 == 16 && !inst.LK;
+					bool isBcctr = inst.SUBOP10 == 528;
+					if (!isBclr && !isBcctr)
+						return false;
+					
+					std::vector<X86Emitter::Label> notTaken;
+					EmitBranchCondition(inst, isBclr, notTaken);
+					emitter.Load(X86Reg::AX, StateReg, isBclr ? LROffset : CTROffset);
+					emitter.Alu(X86Alu::And, X86Reg::AX, ~3u);
+					if (inst.LK)
+						emitter.Store(StateReg, LROffset, address + 4);
+					EmitEpilogue();
+					
+					for (X86Emitter::Label label : notTaken)
+						emitter.Bind(label);
+					EmitExit(address + 4);
+					return true;
+				}
+					
+				case 20: // rlwimix
+				{
+					uint32_t mask = RotateMask(inst.MB, inst.ME);
+					EmitLoadGPR(X86Reg::AX, inst.RS);
+					if (inst.SH != 0)
+						emitter.Shift(X86Shift::Rol, X86Reg::AX, inst.SH);
+					emitter.Alu(X86Alu::And, X86Reg::AX, mask);
+					EmitLoadGPR(X86Reg::CX, inst.RA);
+					emitter.Alu(X86Alu::And, X86Reg::CX, ~mask);
+					emitter.Alu(X86Alu::Or, X86Reg::AX, X86Reg::CX);
+					EmitStoreGPR(inst.RA, X86Reg::AX);
+					if (inst.Rc) EmitUpdateCR0(X86Reg::AX);
+					return true;
+				}
+					
+				case 21: // rlwinmx
+				{
+					uint32_t mask = RotateMask(inst.MB, inst.ME);
+					EmitLoadGPR(X86Reg::AX, inst.RS);
+					if (inst.SH != 0)
+						emitter.Shift(X86Shift::Rol, X86Reg::AX, inst.SH);
+					if (mask != 0xffffffff)
+						emitter.Alu(X86Alu::And, X86Reg::AX, mask);
+					EmitStoreGPR(inst.RA, X86Reg::AX);
+					if (inst.Rc) EmitUpdateCR0(X86Reg::AX);
+					return true;
+				}
+					
+				case 23: // rlwnmx
+				{
+					uint32_t mask = RotateMask(inst.MB, inst.ME);
+					EmitLoadGPR(X86Reg::AX, inst.RS);
+					EmitLoadGPR(X86Reg::CX, inst.RB);
+					emitter.ShiftCL(X86Shift::Rol, X86Reg::AX);
+					if (mask != 0xffffffff)
+						emitter.Alu(X86Alu::And, X86Reg::AX, mask);
+					EmitStoreGPR(inst.RA, X86Reg::AX);
+					if (inst.Rc) EmitUpdateCR0(X86Reg::AX);
+					return true;
+				}
+					
+				case 24: // ori
+				case 25: // oris
+				case 26: // xori
+				case 27: // xoris
+				case 28: // andi.
+				case 29: // andis.
+				{
+					static const X86Alu operations[] = {X86Alu::Or, X86Alu::Xor, X86Alu::And};
+					uint32_t immediate = (inst.OPCD & 1) ? static_cast<uint32_t>(inst.UIMM) << 16 : inst.UIMM;
+					
+					// ori 0, 0, 0 is the canonical nop
+					if (inst.OPCD == 24 && inst.RA == inst.RS && immediate == 0)
+						return true;
+					
+					EmitLoadGPR(X86Reg::AX, inst.RS);
+					emitter.Alu(operations[(inst.OPCD - 24) / 2], X86Reg::AX, immediate);
+					EmitStoreGPR(inst.RA, X86Reg::AX);
+					if (inst.OPCD >= 28) EmitUpdateCR0(X86Reg::AX);
+					return true;
+				}
+					
+				case 31:
+					break;
+					
+				case 32: // lwz
+				case 33: // lwzu
+				case 34: // lbz
+				case 35: // lbzu
+				case 40: // lhz
+				case 41: // lhzu
+				case 42: // lha
+				case 43: // lhau
+				{
+					static const uint32_t sizes[] = {4, 4, 1, 1, 0, 0, 0, 0, 2, 2, 2, 2};
+					bool update = inst.OPCD & 1;
+					if (update && inst.RA == 0)
+						return false;
+					
+					EmitLoad(inst, address, sizes[inst.OPCD - 32], false, update, inst.OPCD >= 42);
+					return true;
+				}
+					
+				case 36: // stw
+				case 37: // stwu
+				case 38: // stb
+				case 39: // stbu
+				case 44: // sth
+				case 45: // sthu
+				{
+					static const uint32_t sizes[] = {4, 4, 1, 1, 0, 0, 0, 0, 2, 2};
+					bool update = inst.OPCD & 1;
+					if (update && inst.RA == 0)
+						return false;
+					
+					EmitStore(inst, address, sizes[inst.OPCD - 36], false, update);
+					return true;
+				}
+					
+				default:
+					return false;
+			}
+			
+			// opcode 31 (the OE forms of XO-form instructions have a different SUBOP10, so they are unsupported)
+			switch (inst.SUBOP10)
+			{
+				case 0: // cmp
+				case 32: // cmpl
+				{
+					// the interpreter panics when XER[SO] is set
+					emitter.Test(StateReg, XEROffset, summaryOverflowMask);
+					fallbackExits.push_back({emitter.Jump(X86Condition::NotEqual), address});
+					EmitLoadGPR(X86Reg::AX, inst.RA);
+					emitter.Alu(X86Alu::Cmp, X86Reg::AX, StateReg, GPROffset(inst.RB));
+					EmitUpdateCR(inst.CRFD, inst.SUBOP10 == 0);
+					return true;
+				}
+					
+				case 266: // addx
+				case 40: // subfx
+				{
+					bool isAdd = inst.SUBOP10 == 266;
+					EmitLoadGPR(X86Reg::AX, isAdd ? inst.RA : inst.RB);
+					emitter.Alu(isAdd ? X86Alu::Add : X86Alu::Sub, X86Reg::AX, StateReg, GPROffset(isAdd ? inst.RB : inst.RA));
+					EmitStoreGPR(inst.RD, X86Reg::AX);
+					if (inst.Rc) EmitUpdateCR0(X86Reg::AX);
+					return true;
+				}
+					
+				case 104: // negx
+					EmitLoadGPR(X86Reg::AX, inst.RA);
+					emitter.Neg(X86Reg::AX);
+					EmitStoreGPR(inst.RD, X86Reg::AX);
+					if (inst.Rc) EmitUpdateCR0(X86Reg::AX);
+					return true;
+					
+				case 235: // mullwx
+					EmitLoadGPR(X86Reg::AX, inst.RA);
+					EmitLoadGPR(X86Reg::CX, inst.RB);
+					emitter.IMul(X86Reg::AX, X86Reg::CX);
+					EmitStoreGPR(inst.RD, X86Reg::AX);
+					if (inst.Rc) EmitUpdateCR0(X86Reg::AX);
+					return true;
+					
+				case 75: // mulhwx
+				case 11: // mulhwux
+					EmitLoadGPR(X86Reg::AX, inst.RA);
+					EmitLoadGPR(X86Reg::CX, inst.RB);
+					if (inst.SUBOP10 == 75)
+						emitter.WideIMul(X86Reg::CX);
+					else
+						emitter.WideMul(X86Reg::CX);
+					emitter.Mov(X86Reg::AX, X86Reg::DX);
+					EmitStoreGPR(inst.RD, X86Reg::AX);
+					if (inst.Rc) EmitUpdateCR0(X86Reg::AX);
+					return true;
+					
+				case 28: // andx
+				case 60: // andcx
+				case 124: // norx
+				case 284: // eqvx
+				case 316: // xorx
+				case 412: // orcx
+				case 444: // orx
+				case 476: // nandx
+				{
+					X86Alu op;
+					bool complementB = false;
+					bool complementResult = false;
+					switch (inst.SUBOP10)
+					{
+						case 28: op = X86Alu::And; break;
+						case 60: op = X86Alu::And; complementB = true; break;
+						case 124: op = X86Alu::Or; complementResult = true; break;
+						case 284: op = X86Alu::Xor; complementResult = true; break;
+						case 316: op = X86Alu::Xor; break;
+						case 412: op = X86Alu::Or; complementB = true; break;
+						case 444: op = X86Alu::Or; break;
+						default: op = X86Alu::And; complementResult = true; break;
+					}
+					
+					EmitLoadGPR(X86Reg::AX, inst.RS);
+					if (complementB)
+					{
+						EmitLoadGPR(X86Reg::CX, inst.RB);
+						emitter.Not(X86Reg::CX);
+						emitter.Alu(op, X86Reg::AX, X86Reg::CX);
+					}
+					else if (inst.RS != inst.RB || op == X86Alu::Xor)
+					{
+						emitter.Alu(op, X86Reg::AX, StateReg, GPROffset(inst.RB));
+					}
+					
+					if (complementResult)
+						emitter.Not(X86Reg::AX);
+					
+					EmitStoreGPR(inst.RA, X86Reg::AX);
+					if (inst.Rc) EmitUpdateCR0(X86Reg::AX);
+					return true;
+				}
+					
+				case 24: // slwx
+				case 536: // srwx
+					EmitLoadGPR(X86Reg::AX, inst.RS);
+					EmitLoadGPR(X86Reg::CX, inst.RB);
+					emitter.ShiftCL(inst.SUBOP10 == 24 ? X86Shift::Shl : X86Shift::Shr, X86Reg::AX);
+					emitter.Alu(X86Alu::Xor, X86Reg::DX, X86Reg::DX);
+					emitter.Alu(X86Alu::And, X86Reg::CX, 0x20);
+					emitter.CMov(X86Condition::NotEqual, X86Reg::AX, X86Reg::DX);
+					EmitStoreGPR(inst.RA, X86Reg::AX);
+					if (inst.Rc) EmitUpdateCR0(X86Reg::AX);
+					return true;
+					
+				case 26: // cntlzwx
+					EmitLoadGPR(X86Reg::CX, inst.RS);
+					emitter.Mov(X86Reg::DX, 63);
+					emitter.Bsr(X86Reg::AX, X86Reg::CX);
+					emitter.CMov(X86Condition::Equal, X86Reg::AX, X86Reg::DX);
+					emitter.Alu(X86Alu::Xor, X86Reg::AX, 31);
+					EmitStoreGPR(inst.RA, X86Reg::AX);
+					if (inst.Rc) EmitUpdateCR0(X86Reg::AX);
+					return true;
+					
+				case 954: // extsbx
+				case 922: // extshx
+					EmitLoadGPR(X86Reg::AX, inst.RS);
+					if (inst.SUBOP10 == 954)
+						emitter.SignExtend8(X86Reg::AX, X86Reg::AX);
+					else
+						emitter.SignExtend16(X86Reg::AX, X86Reg::AX);
+					EmitStoreGPR(inst.RA, X86Reg::AX);
+					if (inst.Rc) EmitUpdateCR0(X86Reg::AX);
+					return true;
+					
+				case 339: // mfspr
+				case 467: // mtspr
+				{
+					uint32_t spr = (inst.RB << 5) | inst.RA;
+					if (spr != 8 && spr != 9)
+						return false;
+					
+					int32_t offset = spr == 8 ? LROffset : CTROffset;
+					if (inst.SUBOP10 == 339)
+					{
+						emitter.Load(X86Reg::AX, StateReg, offset);
+						EmitStoreGPR(inst.RD, X86Reg::AX);
+					}
+					else
+					{
+						EmitLoadGPR(X86Reg::AX, inst.RS);
+						emitter.Store(StateReg, offset, X86Reg::AX);
+					}
+					return true;
+				}
+					
+				case 23: // lwzx
+				case 87: // lbzx
+				case 279: // lhzx
+				case 343: // lhax
+				{
+					uint32_t size = inst.SUBOP10 == 23 ? 4 : inst.SUBOP10 == 87 ? 1 : 2;
+					EmitLoad(inst, address, size, true, false, inst.SUBOP10 == 343);
+					return true;
+				}
+					
+				case 151: // stwx
+				case 215: // stbx
+				case 407: // sthx
+				{
+					uint32_t size = inst.SUBOP10 == 151 ? 4 : inst.SUBOP10 == 215 ? 1 : 2;
+					EmitStore(inst, address, size, true, false);
+					return true;
+				}
+					
+				default:
+					return false;
+			}
+		}
+	}
+}
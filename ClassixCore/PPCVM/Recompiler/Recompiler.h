@@ -0,0 +1,127 @@
+//
+// Recompiler.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__Recompiler__
+#define __Classix__Recompiler__
+
+#include <atomic>
+#include <vector>
+#include "Allocator.h"
+#include "MachineState.h"
+#include "Instruction.h"
+#include "Interpreter.h"
+#include "MemoryFaultHandler.h"
+#include "BlockCache.h"
+#include "ExecutableMemory.h"
+#include "X86Emitter.h"
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		// Translates guest basic blocks to x86-64 code. MachineState stays the canonical register file: compiled
+		// code loads and stores guest registers around every instruction, so control can go back to the
+		// interpreter between any two instructions. Whatever the recompiler can't translate (and any memory
+		// access that the allocator refuses) runs through Interpreter::ExecuteOne, which also takes care of reporting
+		// errors. Compiled code that accesses the flat arena directly is covered by a MemoryFaultHandler instead, and
+		// its faults are reported at the instruction that caused them.
+		// On hosts that aren't x86-64, Execute simply hands everything to the interpreter.
+		class Recompiler
+		{
+		public:
+			// second argument of compiled code
+			struct Context
+			{
+				Common::Allocator* Allocator;
+				uint8_t* ArenaBase; // when set, guest memory is accessed inline instead of through the allocator
+				uint32_t InterpretNext; // set when the returned address must go through the interpreter
+				uint32_t FaultAddress; // address of the instruction to blame if guest memory faults
+			};
+			
+			typedef uint32_t (*CompiledCode)(MachineState* state, Context* context);
+			
+		private:
+			struct CompiledBlock
+			{
+				CompiledCode Code; // nullptr when the first instruction isn't supported
+				uint32_t Address;
+				uint32_t Size;
+			};
+			
+			struct FallbackExit
+			{
+				X86Emitter::Label Label;
+				uint32_t Address;
+			};
+			
+			MachineState& state;
+			Common::Allocator& allocator;
+			Interpreter& interpreter;
+			MemoryFaultHandler faultHandler;
+			Context context;
+			
+			ExecutableMemory memory;
+			X86Emitter emitter;
+			std::vector<FallbackExit> fallbackExits;
+			BlockCache<CompiledBlock> blockCache;
+			size_t codeListener;
+			std::atomic<bool> interrupted;
+			uint32_t summaryOverflowMask;
+			
+			uint32_t ExecuteNative(const NativeCall* function, uint32_t address);
+			const CompiledBlock& GetBlock(uint32_t address);
+			CompiledBlock Compile(uint32_t address);
+			bool CompileInstruction(Instruction inst, uint32_t address);
+			
+			void EmitPrologue();
+			void EmitEpilogue();
+			void EmitExit(uint32_t address);
+			void EmitFallback(X86Emitter::Label label, uint32_t address);
+			void EmitLoadGPR(X86Reg reg, int gpr);
+			void EmitStoreGPR(int gpr, X86Reg reg);
+			void EmitUpdateCR(int field, bool isSigned);
+			void EmitUpdateCR0(X86Reg value);
+			void EmitEffectiveAddress(Instruction inst, bool indexed);
+			void EmitTranslate(uint32_t size, uint32_t address);
+			void EmitLoad(Instruction inst, uint32_t address, uint32_t size, bool indexed, bool update, bool algebraic);
+			void EmitStore(Instruction inst, uint32_t address, uint32_t size, bool indexed, bool update);
+			void EmitBranchCondition(Instruction inst, bool checkCounter, std::vector<X86Emitter::Label>& notTaken);
+			
+		public:
+			static bool IsSupported();
+			
+			Recompiler(Common::Allocator& allocator, MachineState& state, Interpreter& interpreter);
+			Recompiler(const Recompiler& that) = delete;
+			~Recompiler();
+			
+			// Must be called when guest code is modified behind the allocator's back. The first two tell every
+			// listener of the allocator. Safe to call from other threads.
+			void InvalidateCode(uint32_t address, uint32_t size);
+			void InvalidateCode(const void* address, size_t size);
+			void InvalidateAllCode();
+			
+			void Execute(const Common::UInt32* address);
+			void Interrupt();
+		};
+	}
+}
+
+#endif /* defined(__Classix__Recompiler__) */
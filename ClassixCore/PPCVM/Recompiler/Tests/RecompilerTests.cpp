@@ -0,0 +1,248 @@
+//
+// RecompilerTests.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include <sstream>
+#include "UnitTest.h"
+#include "GuestMachine.h"
+#include "Recompiler.h"
+
+using namespace Encode;
+using PPCVM::Execution::Recompiler;
+
+namespace
+{
+	// Each program runs three times from the same start: one instruction at a time, through decoded blocks, and
+	// through the recompiler. The registers and the data must come out the same.
+	struct Outcome
+	{
+		uint32_t gpr[32];
+		uint32_t cr;
+		uint32_t xer;
+		uint32_t ctr;
+		std::vector<uint8_t> data;
+	};
+	
+	enum class Engine
+	{
+		Step,
+		Blocks,
+		Recompiler,
+	};
+	
+	const char* EngineName(Engine engine)
+	{
+		switch (engine)
+		{
+			case Engine::Step: return "stepping";
+			case Engine::Blocks: return "decoded blocks";
+			case Engine::Recompiler: return "the recompiler";
+		}
+		return "?";
+	}
+	
+	Outcome Run(Engine engine, const std::vector<uint32_t>& program, const std::vector<uint32_t>& data)
+	{
+		GuestMachine machine;
+		machine.Load(program);
+		for (size_t i = 0; i < data.size(); i++)
+			machine.DataWord(i * 4) = data[i];
+		
+		switch (engine)
+		{
+			case Engine::Step: machine.Step(); break;
+			case Engine::Blocks: machine.Run(); break;
+			case Engine::Recompiler:
+			{
+				Recompiler recompiler(machine.allocator, machine.state, machine.interpreter);
+				recompiler.Execute(machine.Entry());
+				break;
+			}
+		}
+		
+		Outcome outcome;
+		for (int i = 0; i < 32; i++)
+			outcome.gpr[i] = machine.state.gpr[i];
+		
+		// r1 and r2 point into the machine's own allocations
+		outcome.gpr[1] -= machine.stack;
+		outcome.gpr[2] -= machine.data;
+		outcome.cr = machine.state.GetCR();
+		outcome.xer = machine.state.xer;
+		outcome.ctr = machine.state.ctr;
+		outcome.data = machine.ReadData(0, GuestMachine::DataSize);
+		return outcome;
+	}
+	
+	void CheckSame(Engine engine, const Outcome& actual, const Outcome& expected)
+	{
+		std::stringstream differences;
+		for (int i = 0; i < 32; i++)
+		{
+			if (actual.gpr[i] != expected.gpr[i])
+				differences << " r" << i << "=" << std::hex << actual.gpr[i] << " (not " << expected.gpr[i] << ")";
+		}
+		
+		if (actual.cr != expected.cr)
+			differences << " cr=" << std::hex << actual.cr << " (not " << expected.cr << ")";
+		if (actual.xer != expected.xer)
+			differences << " xer=" << std::hex << actual.xer << " (not " << expected.xer << ")";
+		if (actual.ctr != expected.ctr)
+			differences << " ctr=" << std::hex << actual.ctr << " (not " << expected.ctr << ")";
+		
+		for (size_t i = 0; i < actual.data.size(); i++)
+		{
+			if (actual.data[i] != expected.data[i])
+			{
+				differences << " data differs first at offset " << std::hex << i;
+				break;
+			}
+		}
+		
+		if (!differences.str().empty())
+			UnitTest::Fail(__FILE__, __LINE__, std::string(EngineName(engine)) + " disagrees with stepping:" + differences.str());
+	}
+	
+	void CheckEngines(const std::vector<uint32_t>& program, const std::vector<uint32_t>& data = std::vector<uint32_t>())
+	{
+		Outcome reference = Run(Engine::Step, program, data);
+		CheckSame(Engine::Blocks, Run(Engine::Blocks, program, data), reference);
+		
+		// on other hosts, the recompiler hands everything to the interpreter, and there's nothing more to compare
+		if (Recompiler::IsSupported())
+			CheckSame(Engine::Recompiler, Run(Engine::Recompiler, program, data), reference);
+	}
+}
+
+TEST(Recompiler, IntegerArithmeticMatchesInterpreter)
+{
+	CheckEngines({
+		D(14, 3, 0, 100),			// li r3, 100
+		D(15, 4, 0, 0x8000),		// lis r4, 0x8000
+		D(14, 4, 4, -1),			// addi r4, r4, -1
+		XO(266, 5, 3, 4, 0, 1),		// add. r5, r3, r4
+		XO(40, 6, 3, 4, 0, 0),		// subf r6, r3, r4
+		XO(104, 7, 3, 0, 0, 0),		// neg r7, r3
+		XO(235, 8, 4, 3, 0, 0),		// mullw r8, r4, r3
+		X(75, 9, 4, 3),				// mulhw r9, r4, r3
+		X(11, 10, 4, 7),			// mulhwu r10, r4, r7
+		D(7, 11, 7, -3),			// mulli r11, r7, -3
+		D(14, 19, 0, 4),			// li r19, 4
+		X(24, 4, 18, 19),			// slw r18, r4, r19
+		X(536, 7, 20, 19),			// srw r20, r7, r19
+		X(26, 3, 21, 0),			// cntlzw r21, r3
+		X(954, 7, 22, 0),			// extsb r22, r7
+		X(922, 4, 23, 0),			// extsh r23, r4
+		M(21, 4, 24, 8, 4, 27),		// rlwinm r24, r4, 8, 4, 27
+		M(20, 3, 24, 16, 0, 7),		// rlwimi r24, r3, 16, 0, 7
+		M(23, 4, 25, 19, 28, 3, 1),	// rlwnm. r25, r4, r19, 28, 3
+		D(24, 3, 26, 0xffff),		// ori r26, r3, 0xffff
+		D(25, 3, 27, 0x1234),		// oris r27, r3, 0x1234
+		D(26, 4, 28, 0xaaaa),		// xori r28, r4, 0xaaaa
+		D(12, 30, 4, 1),			// addic r30, r4, 1
+		D(8, 31, 3, 50),			// subfic r31, r3, 50
+		Mfcr(0),					// mfcr r0
+		Blr,
+	});
+}
+
+TEST(Recompiler, LogicalAndComparesMatchInterpreter)
+{
+	CheckEngines({
+		D(14, 3, 0, 100),			// li r3, 100
+		D(14, 7, 0, -100),			// li r7, -100
+		D(15, 4, 0, 0x7fff),		// lis r4, 0x7fff
+		X(28, 3, 12, 7, 1),			// and. r12, r3, r7
+		X(444, 3, 13, 4),			// or r13, r3, r4
+		X(316, 4, 14, 7, 1),		// xor. r14, r4, r7
+		X(124, 3, 15, 3),			// nor r15, r3, r3
+		X(60, 4, 16, 3),			// andc r16, r4, r3
+		X(284, 7, 17, 3),			// eqv r17, r7, r3
+		X(412, 7, 18, 3, 1),		// orc. r18, r7, r3
+		X(476, 7, 19, 4),			// nand r19, r7, r4
+		X(0, 1 << 2, 3, 7),			// cmpw cr1, r3, r7
+		X(32, 2 << 2, 3, 7),		// cmplw cr2, r3, r7
+		D(11, 3 << 2, 7, -100),		// cmpwi cr3, r7, -100
+		D(10, 4 << 2, 3, 200),		// cmplwi cr4, r3, 200
+		D(28, 4, 29, 0x0ff0),		// andi. r29, r4, 0x0ff0
+		D(29, 4, 30, 0x7000),		// andis. r30, r4, 0x7000
+		Mfcr(0),					// mfcr r0
+		Blr,
+	});
+}
+
+TEST(Recompiler, LoadsStoresAndLoopsMatchInterpreter)
+{
+	std::vector<uint32_t> data;
+	for (uint32_t i = 0; i < 16; i++)
+		data.push_back(0x9e3779b9 * (i + 1));
+	
+	CheckEngines({
+		D(14, 3, 0, 0),				// li r3, 0
+		D(14, 4, 0, 16),			// li r4, 16
+		Mtspr(9, 4),				// mtctr r4
+		D(14, 5, 2, -4),			// addi r5, r2, -4
+		D(33, 6, 5, 4),				// loop: lwzu r6, 4(r5)
+		XO(266, 3, 3, 6, 0, 0),		// add r3, r3, r6
+		D(36, 3, 5, 0x100),			// stw r3, 0x100(r5)
+		BC(16, 0, -12),				// bdnz loop
+		D(40, 7, 2, 2),				// lhz r7, 2(r2)
+		D(42, 8, 2, 6),				// lha r8, 6(r2)
+		D(34, 9, 2, 3),				// lbz r9, 3(r2)
+		D(44, 8, 2, 0x200),			// sth r8, 0x200(r2)
+		D(38, 7, 2, 0x203),			// stb r7, 0x203(r2)
+		D(14, 10, 0, 0x204),		// li r10, 0x204
+		X(151, 3, 2, 10),			// stwx r3, r2, r10
+		X(23, 11, 2, 10),			// lwzx r11, r2, r10
+		X(87, 12, 2, 10),			// lbzx r12, r2, r10
+		X(343, 13, 2, 10),			// lhax r13, r2, r10
+		X(279, 14, 2, 10),			// lhzx r14, r2, r10
+		D(14, 15, 0, 0x208),		// li r15, 0x208
+		X(407, 8, 2, 15),			// sthx r8, r2, r15
+		X(215, 9, 2, 15),			// stbx r9, r2, r15
+		D(35, 16, 5, -7),			// lbzu r16, -7(r5)
+		D(41, 17, 5, 2),			// lhzu r17, 2(r5)
+		D(43, 18, 5, 2),			// lhau r18, 2(r5)
+		D(39, 16, 5, 0x101),		// stbu r16, 0x101(r5)
+		D(45, 17, 5, 2),			// sthu r17, 2(r5)
+		D(37, 18, 5, 2),			// stwu r18, 2(r5)
+		Blr,
+	}, data);
+}
+
+TEST(Recompiler, BranchesMatchInterpreter)
+{
+	CheckEngines({
+		Mfspr(31, 8),				// mflr r31
+		D(14, 3, 0, 0),				// li r3, 0
+		D(14, 4, 0, 10),			// li r4, 10
+		D(14, 3, 3, 3),				// loop: addi r3, r3, 3
+		B(20, true),				// bl sub
+		D(13, 4, 4, -1),			// addic. r4, r4, -1
+		BC(4, 2, -12),				// bne loop
+		Mtspr(8, 31),				// mtlr r31
+		Blr,
+		XO(266, 6, 6, 3, 0, 0),		// sub: add r6, r6, r3
+		D(10, 5 << 2, 6, 50),		// cmplwi cr5, r6, 50
+		BC(12, 20, 8),				// blt cr5, skip
+		D(14, 7, 7, 1),				// addi r7, r7, 1
+		Blr,						// skip: blr
+	});
+}
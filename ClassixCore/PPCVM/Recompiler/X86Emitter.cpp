@@ -0,0 +1,437 @@
+//
+// X86Emitter.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include "X86Emitter.h"
+#include <cstring>
+#include <cassert>
+
+namespace
+{
+	using namespace PPCVM::Execution;
+
+	inline uint8_t Index(X86Reg reg)
+	{
+		return static_cast<uint8_t>(reg);
+	}
+
+	inline uint8_t Index(X86Alu op)
+	{
+		return static_cast<uint8_t>(op);
+	}
+
+	inline uint8_t Index(X86Shift op)
+	{
+		return static_cast<uint8_t>(op);
+	}
+
+	inline uint8_t Index(X86Condition condition)
+	{
+		return static_cast<uint8_t>(condition);
+	}
+
+	enum
+	{
+		REX_W = 0x48,
+		OperandSizePrefix = 0x66,
+		TwoByteEscape = 0x0f,
+	};
+}
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		void X86Emitter::Byte(uint8_t byte)
+		{
+			code.push_back(byte);
+		}
+
+		void X86Emitter::Dword(uint32_t dword)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				code.push_back(static_cast<uint8_t>(dword));
+				dword >>= 8;
+			}
+		}
+
+		void X86Emitter::Qword(uint64_t qword)
+		{
+			Dword(static_cast<uint32_t>(qword));
+			Dword(static_cast<uint32_t>(qword >> 32));
+		}
+
+		void X86Emitter::ModRM(uint8_t mod, uint8_t reg, uint8_t rm)
+		{
+			Byte(static_cast<uint8_t>((mod << 6) | ((reg & 7) << 3) | (rm & 7)));
+		}
+
+		void X86Emitter::RegisterOperand(uint8_t reg, X86Reg rm)
+		{
+			ModRM(3, reg, Index(rm));
+		}
+
+		void X86Emitter::MemoryOperand(uint8_t reg, X86Reg base, int32_t displacement)
+		{
+			// always use a displacement, so that [ebp] doesn't turn into [rip+disp32]
+			bool shortDisplacement = displacement >= -128 && displacement <= 127;
+			ModRM(shortDisplacement ? 1 : 2, reg, Index(base));
+			if (base == X86Reg::SP)
+				Byte(0x24);
+
+			if (shortDisplacement)
+				Byte(static_cast<uint8_t>(displacement));
+			else
+				Dword(static_cast<uint32_t>(displacement));
+		}
+
+		const uint8_t* X86Emitter::Data() const
+		{
+			return code.data();
+		}
+
+		size_t X86Emitter::Size() const
+		{
+			return code.size();
+		}
+
+		void X86Emitter::Clear()
+		{
+			code.clear();
+		}
+
+#pragma mark -
+#pragma mark Prologue and Epilogue
+		void X86Emitter::Push(X86Reg reg)
+		{
+			Byte(0x50 + Index(reg));
+		}
+
+		void X86Emitter::Pop(X86Reg reg)
+		{
+			Byte(0x58 + Index(reg));
+		}
+
+		void X86Emitter::Ret()
+		{
+			Byte(0xc3);
+		}
+
+		void X86Emitter::Mov64(X86Reg dest, X86Reg source)
+		{
+			Byte(REX_W);
+			Byte(0x89);
+			RegisterOperand(Index(source), dest);
+		}
+
+		void X86Emitter::AdjustStack(int8_t amount)
+		{
+			Byte(REX_W);
+			Byte(0x83);
+			RegisterOperand(0, X86Reg::SP);
+			Byte(static_cast<uint8_t>(amount));
+		}
+
+		void X86Emitter::Call(const void* function)
+		{
+			// mov rax, imm64; call rax
+			Byte(REX_W);
+			Byte(0xb8 + Index(X86Reg::AX));
+			Qword(reinterpret_cast<uintptr_t>(function));
+			Byte(0xff);
+			RegisterOperand(2, X86Reg::AX);
+		}
+
+		void X86Emitter::Test64(X86Reg a, X86Reg b)
+		{
+			Byte(REX_W);
+			Byte(0x85);
+			RegisterOperand(Index(b), a);
+		}
+
+		void X86Emitter::Add64(X86Reg dest, X86Reg base, int32_t displacement)
+		{
+			Byte(REX_W);
+			Byte(0x03);
+			MemoryOperand(Index(dest), base, displacement);
+		}
+
+#pragma mark -
+#pragma mark Moves
+		void X86Emitter::Mov(X86Reg dest, X86Reg source)
+		{
+			Byte(0x89);
+			RegisterOperand(Index(source), dest);
+		}
+
+		void X86Emitter::Mov(X86Reg dest, uint32_t immediate)
+		{
+			Byte(0xb8 + Index(dest));
+			Dword(immediate);
+		}
+
+		void X86Emitter::Load(X86Reg dest, X86Reg base, int32_t displacement)
+		{
+			Byte(0x8b);
+			MemoryOperand(Index(dest), base, displacement);
+		}
+
+		void X86Emitter::Store(X86Reg base, int32_t displacement, X86Reg source)
+		{
+			Byte(0x89);
+			MemoryOperand(Index(source), base, displacement);
+		}
+
+		void X86Emitter::Store(X86Reg base, int32_t displacement, uint32_t immediate)
+		{
+			Byte(0xc7);
+			MemoryOperand(0, base, displacement);
+			Dword(immediate);
+		}
+
+		void X86Emitter::Load8(X86Reg dest, X86Reg base, int32_t displacement)
+		{
+			Byte(TwoByteEscape);
+			Byte(0xb6);
+			MemoryOperand(Index(dest), base, displacement);
+		}
+
+		void X86Emitter::Load16(X86Reg dest, X86Reg base, int32_t displacement)
+		{
+			Byte(TwoByteEscape);
+			Byte(0xb7);
+			MemoryOperand(Index(dest), base, displacement);
+		}
+
+		void X86Emitter::Store8(X86Reg base, int32_t displacement, X86Reg source)
+		{
+			assert(Index(source) < 4 && "Only AL, CL, DL and BL are addressable without a REX prefix");
+			Byte(0x88);
+			MemoryOperand(Index(source), base, displacement);
+		}
+
+		void X86Emitter::Store8(X86Reg base, int32_t displacement, uint8_t immediate)
+		{
+			Byte(0xc6);
+			MemoryOperand(0, base, displacement);
+			Byte(immediate);
+		}
+
+		void X86Emitter::Store16(X86Reg base, int32_t displacement, X86Reg source)
+		{
+			Byte(OperandSizePrefix);
+			Byte(0x89);
+			MemoryOperand(Index(source), base, displacement);
+		}
+
+		void X86Emitter::SignExtend8(X86Reg dest, X86Reg source)
+		{
+			assert(Index(source) < 4 && "Only AL, CL, DL and BL are addressable without a REX prefix");
+			Byte(TwoByteEscape);
+			Byte(0xbe);
+			RegisterOperand(Index(dest), source);
+		}
+
+		void X86Emitter::SignExtend16(X86Reg dest, X86Reg source)
+		{
+			Byte(TwoByteEscape);
+			Byte(0xbf);
+			RegisterOperand(Index(dest), source);
+		}
+
+		void X86Emitter::ByteSwap(X86Reg reg)
+		{
+			Byte(TwoByteEscape);
+			Byte(0xc8 + Index(reg));
+		}
+
+		void X86Emitter::ByteSwap16(X86Reg reg)
+		{
+			// rol r16, 8
+			Byte(OperandSizePrefix);
+			Byte(0xc1);
+			RegisterOperand(Index(X86Shift::Rol), reg);
+			Byte(8);
+		}
+
+		void X86Emitter::CMov(X86Condition condition, X86Reg dest, X86Reg source)
+		{
+			Byte(TwoByteEscape);
+			Byte(0x40 + Index(condition));
+			RegisterOperand(Index(dest), source);
+		}
+
+		void X86Emitter::SetCC(X86Condition condition, X86Reg dest)
+		{
+			assert(Index(dest) < 4 && "Only AL, CL, DL and BL are addressable without a REX prefix");
+			Byte(TwoByteEscape);
+			Byte(0x90 + Index(condition));
+			RegisterOperand(0, dest);
+		}
+
+#pragma mark -
+#pragma mark Arithmetic
+		void X86Emitter::Alu(X86Alu op, X86Reg dest, X86Reg source)
+		{
+			Byte(static_cast<uint8_t>((Index(op) << 3) | 1));
+			RegisterOperand(Index(source), dest);
+		}
+
+		void X86Emitter::Alu(X86Alu op, X86Reg dest, uint32_t immediate)
+		{
+			int32_t signedImmediate = static_cast<int32_t>(immediate);
+			if (signedImmediate >= -128 && signedImmediate <= 127)
+			{
+				Byte(0x83);
+				RegisterOperand(Index(op), dest);
+				Byte(static_cast<uint8_t>(immediate));
+			}
+			else
+			{
+				Byte(0x81);
+				RegisterOperand(Index(op), dest);
+				Dword(immediate);
+			}
+		}
+
+		void X86Emitter::Alu(X86Alu op, X86Reg dest, X86Reg base, int32_t displacement)
+		{
+			Byte(static_cast<uint8_t>((Index(op) << 3) | 3));
+			MemoryOperand(Index(dest), base, displacement);
+		}
+
+		void X86Emitter::Or8(X86Reg dest, X86Reg source)
+		{
+			assert(Index(dest) < 4 && Index(source) < 4 && "Only AL, CL, DL and BL are addressable without a REX prefix");
+			Byte(0x08);
+			RegisterOperand(Index(source), dest);
+		}
+
+		void X86Emitter::Shift(X86Shift op, X86Reg reg, uint8_t amount)
+		{
+			Byte(0xc1);
+			RegisterOperand(Index(op), reg);
+			Byte(amount);
+		}
+
+		void X86Emitter::ShiftCL(X86Shift op, X86Reg reg)
+		{
+			Byte(0xd3);
+			RegisterOperand(Index(op), reg);
+		}
+
+		void X86Emitter::Not(X86Reg reg)
+		{
+			Byte(0xf7);
+			RegisterOperand(2, reg);
+		}
+
+		void X86Emitter::Neg(X86Reg reg)
+		{
+			Byte(0xf7);
+			RegisterOperand(3, reg);
+		}
+
+		void X86Emitter::IMul(X86Reg dest, X86Reg source)
+		{
+			Byte(TwoByteEscape);
+			Byte(0xaf);
+			RegisterOperand(Index(dest), source);
+		}
+
+		void X86Emitter::IMul(X86Reg dest, X86Reg source, int32_t immediate)
+		{
+			Byte(0x69);
+			RegisterOperand(Index(dest), source);
+			Dword(static_cast<uint32_t>(immediate));
+		}
+
+		void X86Emitter::WideMul(X86Reg source)
+		{
+			Byte(0xf7);
+			RegisterOperand(4, source);
+		}
+
+		void X86Emitter::WideIMul(X86Reg source)
+		{
+			Byte(0xf7);
+			RegisterOperand(5, source);
+		}
+
+		void X86Emitter::Bsr(X86Reg dest, X86Reg source)
+		{
+			Byte(TwoByteEscape);
+			Byte(0xbd);
+			RegisterOperand(Index(dest), source);
+		}
+
+		void X86Emitter::Test(X86Reg a, X86Reg b)
+		{
+			Byte(0x85);
+			RegisterOperand(Index(b), a);
+		}
+
+		void X86Emitter::Test(X86Reg base, int32_t displacement, uint32_t immediate)
+		{
+			Byte(0xf7);
+			MemoryOperand(0, base, displacement);
+			Dword(immediate);
+		}
+
+		void X86Emitter::Test8(X86Reg base, int32_t displacement, uint8_t immediate)
+		{
+			Byte(0xf6);
+			MemoryOperand(0, base, displacement);
+			Byte(immediate);
+		}
+
+		void X86Emitter::Dec(X86Reg base, int32_t displacement)
+		{
+			Byte(0xff);
+			MemoryOperand(1, base, displacement);
+		}
+
+#pragma mark -
+#pragma mark Control Flow
+		X86Emitter::Label X86Emitter::Jump()
+		{
+			Byte(0xe9);
+			Label label = code.size();
+			Dword(0);
+			return label;
+		}
+
+		X86Emitter::Label X86Emitter::Jump(X86Condition condition)
+		{
+			Byte(TwoByteEscape);
+			Byte(0x80 + Index(condition));
+			Label label = code.size();
+			Dword(0);
+			return label;
+		}
+
+		void X86Emitter::Bind(Label label)
+		{
+			int32_t displacement = static_cast<int32_t>(code.size() - (label + 4));
+			memcpy(&code[label], &displacement, sizeof displacement);
+		}
+	}
+}
@@ -0,0 +1,144 @@
+//
+// X86Emitter.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__X86Emitter__
+#define __Classix__X86Emitter__
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace PPCVM
+{
+	namespace Execution
+	{
+		// Only the 8 legacy registers are used, which means that no instruction needs a REX prefix except for
+		// the few 64-bits operations on pointers.
+		enum class X86Reg : uint8_t
+		{
+			AX = 0, CX, DX, BX, SP, BP, SI, DI
+		};
+
+		enum class X86Condition : uint8_t
+		{
+			Overflow = 0x0,
+			Below = 0x2,
+			AboveOrEqual = 0x3,
+			Equal = 0x4,
+			NotEqual = 0x5,
+			BelowOrEqual = 0x6,
+			Above = 0x7,
+			Sign = 0x8,
+			NotSign = 0x9,
+			Less = 0xc,
+			GreaterOrEqual = 0xd,
+			LessOrEqual = 0xe,
+			Greater = 0xf,
+		};
+
+		enum class X86Alu : uint8_t
+		{
+			Add = 0, Or = 1, And = 4, Sub = 5, Xor = 6, Cmp = 7
+		};
+
+		enum class X86Shift : uint8_t
+		{
+			Rol = 0, Ror = 1, Shl = 4, Shr = 5, Sar = 7
+		};
+
+		// Tiny x86-64 assembler that only knows the forms the recompiler needs. Unless said otherwise, operations
+		// are 32-bits wide, and memory operands are always [base + displacement].
+		class X86Emitter
+		{
+		public:
+			typedef size_t Label;
+
+		private:
+			std::vector<uint8_t> code;
+
+			void Byte(uint8_t byte);
+			void Dword(uint32_t dword);
+			void Qword(uint64_t qword);
+			void ModRM(uint8_t mod, uint8_t reg, uint8_t rm);
+			void RegisterOperand(uint8_t reg, X86Reg rm);
+			void MemoryOperand(uint8_t reg, X86Reg base, int32_t displacement);
+
+		public:
+			const uint8_t* Data() const;
+			size_t Size() const;
+			void Clear();
+
+			// prologue/epilogue material
+			void Push(X86Reg reg);
+			void Pop(X86Reg reg);
+			void Ret();
+			void Mov64(X86Reg dest, X86Reg source);
+			void AdjustStack(int8_t amount);
+			void Call(const void* function);
+			void Test64(X86Reg a, X86Reg b);
+			void Add64(X86Reg dest, X86Reg base, int32_t displacement);
+
+			// moves
+			void Mov(X86Reg dest, X86Reg source);
+			void Mov(X86Reg dest, uint32_t immediate);
+			void Load(X86Reg dest, X86Reg base, int32_t displacement);
+			void Store(X86Reg base, int32_t displacement, X86Reg source);
+			void Store(X86Reg base, int32_t displacement, uint32_t immediate);
+			void Load8(X86Reg dest, X86Reg base, int32_t displacement); // zero-extends
+			void Load16(X86Reg dest, X86Reg base, int32_t displacement); // zero-extends
+			void Store8(X86Reg base, int32_t displacement, X86Reg source);
+			void Store8(X86Reg base, int32_t displacement, uint8_t immediate);
+			void Store16(X86Reg base, int32_t displacement, X86Reg source);
+			void SignExtend8(X86Reg dest, X86Reg source);
+			void SignExtend16(X86Reg dest, X86Reg source);
+			void ByteSwap(X86Reg reg);
+			void ByteSwap16(X86Reg reg); // swaps the two low bytes, leaves the rest alone
+			void CMov(X86Condition condition, X86Reg dest, X86Reg source);
+			void SetCC(X86Condition condition, X86Reg dest); // dest must be AL, CL, DL or BL
+
+			// arithmetic
+			void Alu(X86Alu op, X86Reg dest, X86Reg source);
+			void Alu(X86Alu op, X86Reg dest, uint32_t immediate);
+			void Alu(X86Alu op, X86Reg dest, X86Reg base, int32_t displacement);
+			void Or8(X86Reg dest, X86Reg source);
+			void Shift(X86Shift op, X86Reg reg, uint8_t amount);
+			void ShiftCL(X86Shift op, X86Reg reg);
+			void Not(X86Reg reg);
+			void Neg(X86Reg reg);
+			void IMul(X86Reg dest, X86Reg source);
+			void IMul(X86Reg dest, X86Reg source, int32_t immediate);
+			void WideMul(X86Reg source); // EDX:EAX = EAX * source (unsigned)
+			void WideIMul(X86Reg source); // EDX:EAX = EAX * source (signed)
+			void Bsr(X86Reg dest, X86Reg source);
+			void Test(X86Reg a, X86Reg b);
+			void Test(X86Reg base, int32_t displacement, uint32_t immediate);
+			void Test8(X86Reg base, int32_t displacement, uint8_t immediate);
+			void Dec(X86Reg base, int32_t displacement);
+
+			// control flow; jumps have a 32-bits displacement that Bind patches
+			Label Jump();
+			Label Jump(X86Condition condition);
+			void Bind(Label label);
+		};
+	}
+}
+
+#endif /* defined(__Classix__X86Emitter__) */
@@ -0,0 +1,203 @@
+//
+// GuestCallTests.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include <new>
+#include <stdexcept>
+#include "UnitTest.h"
+#include "GuestMachine.h"
+#include "GuestCall.h"
+#include "NativeCall.h"
+#include "InterpreterException.h"
+
+using namespace Encode;
+using PPCVM::Execution::GuestCall;
+using PPCVM::Execution::NativeCall;
+
+namespace
+{
+	// The TOC of every guest function below, and the globals of the native call. The guest reads the first words.
+	struct Context
+	{
+		Common::UInt32 inner; // transition vector that Outer passes to Apply
+		Common::UInt32 apply; // the native call
+		Common::Allocator* allocator;
+		unsigned applied;
+	};
+	
+	// r3 = f(r4) + f(r4 + 1), with f the transition vector in r3
+	void Apply(void* globals, PPCVM::MachineState* state)
+	{
+		Context* context = static_cast<Context*>(globals);
+		context->applied++;
+		uint32_t x = state->r4;
+		uint32_t result;
+		{
+			GuestCall f(*context->allocator, state, state->r3);
+			result = f(x);
+			result += f(x + 1);
+		}
+		state->r3 = result;
+	}
+	
+	const uint32_t OuterOffset = 0x28;
+	const uint32_t TripleOffset = 0x5c;
+	const uint32_t FaultOffset = 0x64;
+	
+	struct NestedCalls
+	{
+		GuestMachine machine;
+		Context* context;
+		uint32_t outerVector;
+		uint32_t tripleVector;
+		uint32_t faultVector;
+		
+		NestedCalls()
+		{
+			Common::Allocator& allocator = machine.allocator;
+			context = reinterpret_cast<Context*>(allocator.Allocate("Guest call context", sizeof(Context)));
+			uint8_t* callMemory = allocator.Allocate("Apply", sizeof(NativeCall));
+			new (callMemory) NativeCall(Apply);
+			context->apply = allocator.ToIntPtr(callMemory);
+			context->allocator = &allocator;
+			context->applied = 0;
+			
+			outerVector = MakeVector(0x100, OuterOffset);
+			tripleVector = MakeVector(0x108, TripleOffset);
+			faultVector = MakeVector(0x110, FaultOffset);
+		}
+		
+		uint32_t MakeVector(uint32_t offset, uint32_t entry)
+		{
+			machine.DataWord(offset) = machine.code + entry;
+			machine.DataWord(offset + 4) = machine.allocator.ToIntPtr(context);
+			return machine.data + offset;
+		}
+		
+		// main calls Apply(Outer, 5), and Outer(x) calls Apply(inner, x) + 1000
+		void Load(uint32_t inner)
+		{
+			context->inner = inner;
+			machine.Load({
+				// main
+				Mfspr(0, 8),			// mflr r0
+				D(36, 0, 1, 8),			// stw r0, 8(r1)
+				D(37, 1, 1, -64),		// stwu r1, -64(r1)
+				D(14, 5, 0, 0x55),		// li r5, 0x55
+				Mtspr(9, 12),			// mtctr r12
+				Bctrl,					// bctrl
+				D(14, 1, 1, 64),		// addi r1, r1, 64
+				D(32, 0, 1, 8),			// lwz r0, 8(r1)
+				Mtspr(8, 0),			// mtlr r0
+				Blr,
+				// Outer
+				Mfspr(0, 8),			// mflr r0
+				D(36, 0, 1, 8),			// stw r0, 8(r1)
+				D(37, 1, 1, -64),		// stwu r1, -64(r1)
+				X(444, 3, 4, 3),		// mr r4, r3
+				D(32, 3, 2, 0),			// lwz r3, 0(r2)
+				D(32, 12, 2, 4),		// lwz r12, 4(r2)
+				Mtspr(9, 12),			// mtctr r12
+				Bctrl,					// bctrl
+				D(14, 3, 3, 1000),		// addi r3, r3, 1000
+				D(14, 1, 1, 64),		// addi r1, r1, 64
+				D(32, 0, 1, 8),			// lwz r0, 8(r1)
+				Mtspr(8, 0),			// mtlr r0
+				Blr,
+				// Triple
+				D(7, 3, 3, 3),			// mulli r3, r3, 3
+				Blr,
+				// Fault
+				D(32, 3, 0, 0),			// lwz r3, 0(0)
+				Blr,
+			});
+			
+			machine.state.r2 = machine.allocator.ToIntPtr(context);
+			machine.state.r3 = outerVector;
+			machine.state.r4 = 5;
+			machine.state.r12 = context->apply;
+			machine.state.r31 = 0x31;
+		}
+	};
+}
+
+TEST(GuestCall, CallsNestInsideNativeCalls)
+{
+	NestedCalls calls;
+	calls.Load(calls.tripleVector);
+	uint32_t stackPointer = calls.machine.state.r1;
+	calls.machine.Run();
+	
+	// Outer(5) + Outer(6) = (15 + 18 + 1000) + (18 + 21 + 1000)
+	CHECK_EQUAL(calls.machine.state.r3, 2072u);
+	CHECK_EQUAL(calls.context->applied, 3u);
+	
+	// what the native call's GuestCall saved is back, and main got to its end
+	CHECK_EQUAL(calls.machine.state.r1, stackPointer);
+	CHECK_EQUAL(calls.machine.state.r2, calls.machine.allocator.ToIntPtr(calls.context));
+	CHECK_EQUAL(calls.machine.state.r5, 0x55u);
+	CHECK_EQUAL(calls.machine.state.r31, 0x31u);
+	CHECK_EQUAL(calls.machine.state.lr, calls.machine.allocator.ToIntPtr(calls.machine.interpreter.GetEndAddress()));
+}
+
+TEST(GuestCall, FaultsUnwindNestedCalls)
+{
+	NestedCalls calls;
+	calls.Load(calls.faultVector);
+	uint32_t stackPointer = calls.machine.state.r1;
+	
+	bool faulted = false;
+	try
+	{
+		calls.machine.Run();
+	}
+	catch (PPCVM::Execution::InterpreterException&)
+	{
+		faulted = true;
+	}
+	CHECK(faulted);
+	CHECK_EQUAL(calls.context->applied, 2u);
+	
+	// both GuestCalls put back what they saved on the way out, which is what main had when it called Apply
+	CHECK_EQUAL(calls.machine.state.r1, stackPointer - 64);
+	CHECK_EQUAL(calls.machine.state.r3, calls.outerVector);
+	CHECK_EQUAL(calls.machine.state.r5, 0x55u);
+	
+	// and the interpreter can go on
+	calls.Load(calls.tripleVector);
+	calls.machine.Run();
+	CHECK_EQUAL(calls.machine.state.r3, 2072u);
+}
+
+TEST(GuestCall, NeedsARunner)
+{
+	GuestMachine machine;
+	bool refused = false;
+	try
+	{
+		GuestCall call(machine.allocator, &machine.state, machine.code, machine.data);
+	}
+	catch (std::logic_error&)
+	{
+		refused = true;
+	}
+	CHECK(refused);
+}
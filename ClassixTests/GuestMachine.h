@@ -0,0 +1,186 @@
+//
+// GuestMachine.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__GuestMachine__
+#define __Classix__GuestMachine__
+
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <vector>
+#include "FlatAllocator.h"
+#include "GuestLayout.h"
+#include "Interpreter.h"
+#include "MachineState.h"
+
+// Enough of a machine to run short guest routines: a flat arena, an interpreter, some code, some data and a stack.
+// Routines return with blr to the interpreter's end address.
+class GuestMachine
+{
+public:
+	Common::FlatAllocator allocator;
+	PPCVM::MachineState state;
+	PPCVM::Execution::Interpreter interpreter;
+	uint32_t code;
+	uint32_t data;
+	uint32_t stack;
+	
+	static const uint32_t CodeSize = 0x1000;
+	static const uint32_t DataSize = 0x1000;
+	static const uint32_t StackSize = 0x1000;
+	
+	GuestMachine()
+	: interpreter(allocator, state)
+	{
+		Common::Allocator& memory = allocator;
+		code = memory.ToIntPtr(memory.Allocate("Test code", CodeSize));
+		data = memory.ToIntPtr(memory.Allocate("Test data", DataSize));
+		stack = memory.ToIntPtr(memory.Allocate("Test stack", StackSize));
+		memset(allocator.ToPointer<void>(data), 0, DataSize);
+	}
+	
+	// Replaces the code, and resets the registers the way they are when a routine starts: r1 points to the stack,
+	// r2 to the data, and the link register to the interpreter's end address. Everything else is zero.
+	void Load(const std::vector<uint32_t>& program)
+	{
+		Common::UInt32* words = allocator.ToPointer<Common::UInt32>(code);
+		for (size_t i = 0; i < program.size(); i++)
+			words[i] = program[i];
+		interpreter.InvalidateCode(code, CodeSize);
+		
+		state = PPCVM::MachineState();
+		state.r1 = stack + StackSize - 64;
+		state.r2 = data;
+		state.lr = allocator.ToIntPtr(interpreter.GetEndAddress());
+	}
+	
+	const Common::UInt32* Entry()
+	{
+		return allocator.ToPointer<Common::UInt32>(code);
+	}
+	
+	// through decoded blocks
+	void Run()
+	{
+		interpreter.Execute(Entry());
+	}
+	
+	// one instruction at a time, which materializes the flags after every instruction
+	void Step()
+	{
+		const Common::UInt32* end = interpreter.GetEndAddress();
+		for (const Common::UInt32* pc = Entry(); pc != end; )
+			pc = interpreter.ExecuteOne(pc);
+	}
+	
+	std::vector<uint8_t> ReadData(uint32_t offset, size_t size)
+	{
+		std::vector<uint8_t> bytes(size);
+		Common::GuestLayout::CopyFromGuest(bytes.data(), allocator.ToPointer<void>(data + offset), size);
+		return bytes;
+	}
+	
+	void WriteData(uint32_t offset, const void* bytes, size_t size)
+	{
+		Common::GuestLayout::CopyToGuest(allocator.ToPointer<void>(data + offset), bytes, size);
+	}
+	
+	Common::UInt32& DataWord(uint32_t offset)
+	{
+		return *allocator.ToPointer<Common::UInt32>(data + offset);
+	}
+};
+
+// Instruction encodings, so that tests can spell out their guest code. Only the fields; the mnemonic goes in a
+// comment next to each use.
+namespace Encode
+{
+	inline uint32_t D(uint32_t opcode, uint32_t rt, uint32_t ra, int32_t immediate)
+	{
+		return opcode << 26 | rt << 21 | ra << 16 | (immediate & 0xffff);
+	}
+	
+	inline uint32_t X(uint32_t xo, uint32_t rt, uint32_t ra, uint32_t rb, bool rc = false)
+	{
+		return 31u << 26 | rt << 21 | ra << 16 | rb << 11 | xo << 1 | rc;
+	}
+	
+	inline uint32_t XO(uint32_t xo, uint32_t rt, uint32_t ra, uint32_t rb, bool oe, bool rc)
+	{
+		return 31u << 26 | rt << 21 | ra << 16 | rb << 11 | oe << 10 | xo << 1 | rc;
+	}
+	
+	inline uint32_t M(uint32_t opcode, uint32_t rs, uint32_t ra, uint32_t sh, uint32_t mb, uint32_t me, bool rc = false)
+	{
+		return opcode << 26 | rs << 21 | ra << 16 | sh << 11 | mb << 6 | me << 1 | rc;
+	}
+	
+	// floating-point X-form (opcode 63 or 59)
+	inline uint32_t FX(uint32_t opcode, uint32_t xo, uint32_t frt, uint32_t fra, uint32_t frb, bool rc = false)
+	{
+		return opcode << 26 | frt << 21 | fra << 16 | frb << 11 | xo << 1 | rc;
+	}
+	
+	inline uint32_t FA(uint32_t opcode, uint32_t xo, uint32_t frt, uint32_t fra, uint32_t frb, uint32_t frc, bool rc = false)
+	{
+		return opcode << 26 | frt << 21 | fra << 16 | frb << 11 | frc << 6 | xo << 1 | rc;
+	}
+	
+	inline uint32_t VX(uint32_t xo, uint32_t vd, uint32_t va, uint32_t vb)
+	{
+		return 4u << 26 | vd << 21 | va << 16 | vb << 11 | xo;
+	}
+	
+	inline uint32_t VA(uint32_t xo, uint32_t vd, uint32_t va, uint32_t vb, uint32_t vc)
+	{
+		return 4u << 26 | vd << 21 | va << 16 | vb << 11 | vc << 6 | xo;
+	}
+	
+	inline uint32_t BC(uint32_t bo, uint32_t bi, int32_t offset)
+	{
+		return 16u << 26 | bo << 21 | bi << 16 | (offset & 0xfffc);
+	}
+	
+	inline uint32_t B(int32_t offset, bool link = false)
+	{
+		return 18u << 26 | (offset & 0x03fffffc) | link;
+	}
+	
+	const uint32_t Blr = 0x4e800020;
+	const uint32_t Bctrl = 0x4e800421;
+	
+	inline uint32_t Mfspr(uint32_t rt, uint32_t spr)
+	{
+		return X(339, rt, spr & 0x1f, spr >> 5);
+	}
+	
+	inline uint32_t Mtspr(uint32_t spr, uint32_t rs)
+	{
+		return X(467, rs, spr & 0x1f, spr >> 5);
+	}
+	
+	inline uint32_t Mfcr(uint32_t rt)
+	{
+		return X(19, rt, 0, 0);
+	}
+}
+
+#endif /* defined(__Classix__GuestMachine__) */
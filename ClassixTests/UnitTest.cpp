@@ -0,0 +1,85 @@
+//
+// UnitTest.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include "UnitTest.h"
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+namespace
+{
+	UnitTest::Test* firstTest = nullptr;
+	UnitTest::Test** lastTest = &firstTest;
+	int currentFailures = 0;
+}
+
+namespace UnitTest
+{
+	Test::Test(const char* group, const char* name, void (*function)())
+	: group(group), name(name), function(function), next(nullptr)
+	{
+		*lastTest = this;
+		lastTest = &next;
+	}
+	
+	int Test::RunAll(int filterCount, const char** filters)
+	{
+		int ran = 0;
+		int failed = 0;
+		for (Test* test = firstTest; test != nullptr; test = test->next)
+		{
+			std::string fullName = std::string(test->group) + "." + test->name;
+			bool selected = filterCount == 0;
+			for (int i = 0; i < filterCount && !selected; i++)
+				selected = fullName.compare(0, strlen(filters[i]), filters[i]) == 0;
+			
+			if (!selected)
+				continue;
+			
+			currentFailures = 0;
+			try
+			{
+				test->function();
+			}
+			catch (std::exception& ex)
+			{
+				fprintf(stderr, "%s: uncaught exception: %s\n", fullName.c_str(), ex.what());
+				currentFailures++;
+			}
+			
+			ran++;
+			if (currentFailures != 0)
+			{
+				fprintf(stderr, "%s: FAILED\n", fullName.c_str());
+				failed++;
+			}
+		}
+		
+		printf("%i test(s), %i failure(s)\n", ran, failed);
+		return failed;
+	}
+	
+	void Fail(const char* file, int line, const std::string& message)
+	{
+		fprintf(stderr, "%s:%i: %s\n", file, line, message.c_str());
+		currentFailures++;
+	}
+}
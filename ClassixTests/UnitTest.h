@@ -0,0 +1,89 @@
+//
+// UnitTest.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__UnitTest__
+#define __Classix__UnitTest__
+
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+// Tests live in a Tests directory next to the code that they test, and they all end up in the ClassixTests tool.
+// TEST(Group, Name) defines one, and it registers itself. Failed checks are reported and counted, but they don't
+// stop the test; an exception does.
+namespace UnitTest
+{
+	class Test
+	{
+		const char* group;
+		const char* name;
+		void (*function)();
+		Test* next;
+		
+	public:
+		Test(const char* group, const char* name, void (*function)());
+		
+		// runs every test, or the ones whose "Group.Name" starts with one of the filters; returns the failure count
+		static int RunAll(int filterCount, const char** filters);
+	};
+	
+	void Fail(const char* file, int line, const std::string& message);
+	
+	template<typename T>
+	typename std::enable_if<std::is_integral<T>::value, std::string>::type Describe(const T& value)
+	{
+		std::stringstream ss;
+		ss << static_cast<long long>(value) << " (0x" << std::hex << static_cast<unsigned long long>(value) << ")";
+		return ss.str();
+	}
+	
+	template<typename T>
+	typename std::enable_if<!std::is_integral<T>::value, std::string>::type Describe(const T& value)
+	{
+		std::stringstream ss;
+		ss << std::setprecision(17) << value;
+		return ss.str();
+	}
+	
+	template<typename T, typename U>
+	void CheckEqual(const char* file, int line, const char* expression, const T& actual, const U& expected)
+	{
+		if (actual == expected)
+			return;
+		
+		Fail(file, line, std::string(expression) + " is " + Describe(actual) + ", expected " + Describe(expected));
+	}
+}
+
+#define TEST(group, name) \
+	static void group##_##name(); \
+	static UnitTest::Test group##_##name##_Registration(#group, #name, group##_##name); \
+	static void group##_##name()
+	
+#define CHECK(condition) \
+	((condition) ? (void)0 : UnitTest::Fail(__FILE__, __LINE__, #condition " is false"))
+	
+#define CHECK_EQUAL(actual, expected) \
+	UnitTest::CheckEqual(__FILE__, __LINE__, #actual, (actual), (expected))
+	
+#endif /* defined(__Classix__UnitTest__) */
@@ -1,8 +1,8 @@
 //
-// InstructionDispatcher.cpp
+// main.cpp
 // Classix
 //
-// Copyright (C) 2012 Félix Cloutier
+// Copyright (C) 2013 Félix Cloutier
 //
 // This file is part of Classix.
 //
@@ -19,16 +19,11 @@
 // Classix. If not, see http://www.gnu.org/licenses/.
 //
 
-#include <iostream>
-#include "InstructionDecoder.h"
+#include <cstdlib>
+#include "UnitTest.h"
 
-namespace PPCVM
+// usage: ClassixTests [Group[.Name] ...]
+int main(int argc, const char** argv)
 {
-	void DisassembleIfAsked(Instruction inst)
-	{
-		if (getenv("DEBUG_DISASSEMBLE"))
-		{
-			std::cerr << '\t' << Disassembly::InstructionDecoder::Decode(inst) << std::endl;
-		}
-	}
+	return UnitTest::Test::RunAll(argc - 1, argv + 1) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -23,21 +23,27 @@
 #define Classix_CommonDefinitions_h
 
 #include "BigEndian.h"
+#include "GuestLayout.h"
 #include <string>
 
-template<typename... TArgument>
-void PACK_EXPAND_identity(TArgument&&...) {}
+// Evaluates each expansion of x in order. Function arguments are evaluated in no particular order (GCC goes right to
+// left), but the elements of a braced list are evaluated left to right, and the order matters when x writes to the pipe.
+struct PACK_EXPAND_sequence
+{
+	template<typename... TArgument>
+	PACK_EXPAND_sequence(TArgument&&...) {}
+};
 
-#define PACK_EXPAND(x) PACK_EXPAND_identity((x)...)
+#define PACK_EXPAND(x) PACK_EXPAND_sequence { (x)... }
 
 // I'm sooooo looking forward to generalized attributes, so I don't have to use __attribute__((packed)).
 
 namespace InterfaceLib
 {
+	// pascalString is in guest memory
 	inline std::string PascalStringToCPPString(const char* pascalString)
 	{
-		uint8_t length = static_cast<uint8_t>(*pascalString);
-		return std::string(pascalString + 1, pascalString + 1 + length);
+		return Common::GuestLayout::ReadPascalString(pascalString);
 	}
 	
 	typedef Common::SInt16 Bits16[16];
@@ -143,7 +143,7 @@ void InterfaceLib_GetNewDialog(InterfaceLib::Globals* globals, MachineState* sta
 			port = globals->allocator.ToPointer<UGrafPort>(portAddress);
 		}
 		
-		bool visible = dialog->visibility == 1;
+		bool visible = *Common::GuestLayout::Byte(&dialog->visibility) == 1;
 		globals->ipc().PerformAction<void>(IPCMessage::CreateDialog, portAddress, rect, visible, title);
 	}
 	 */
@@ -194,10 +194,7 @@ void InterfaceLib_ParamText(InterfaceLib::Globals* globals, MachineState* state)
 	for (size_t i = 0; i < globals->dialogParams.size(); i++)
 	{
 		const char* pascalString = globals->allocator.ToPointer<char>(state->gpr[3 + i]);
-		uint8_t length = *pascalString;
-		pascalString++;
-		
-		globals->dialogParams[i] = std::string(pascalString, pascalString + length);
+		globals->dialogParams[i] = InterfaceLib::PascalStringToCPPString(pascalString);
 	}
 }
 
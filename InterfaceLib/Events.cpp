@@ -27,14 +27,14 @@ using namespace InterfaceLib;
 
 void InterfaceLib_Button(InterfaceLib::Globals* globals, MachineState* state)
 {
-	globals->ipc().PerformAction<void>(IPCMessage::RefreshWindows);
+	globals->ipc().PostAction(IPCMessage::RefreshWindows);
 	state->r3 = globals->ipc().PerformAction<bool>(IPCMessage::IsMouseDown);
 }
 
 void InterfaceLib_EventAvail(InterfaceLib::Globals* globals, MachineState* state)
 {
 	// same as GetNextEvent, but without discarding the event if it's matched, and without a timeout
-	globals->ipc().PerformAction<void>(IPCMessage::RefreshWindows);
+	globals->ipc().PostAction(IPCMessage::RefreshWindows);
 	
 	EventMask mask = static_cast<EventMask>(state->r3);
 	MacRegion empty;
@@ -84,7 +84,7 @@ void InterfaceLib_GetMouse(InterfaceLib::Globals* globals, MachineState* state)
 
 void InterfaceLib_GetNextEvent(InterfaceLib::Globals* globals, MachineState* state)
 {
-	globals->ipc().PerformAction<void>(IPCMessage::RefreshWindows);
+	globals->ipc().PostAction(IPCMessage::RefreshWindows);
 	
 	EventMask mask = static_cast<EventMask>(state->r3);
 	uint32_t timeout = 0xffffffff;
@@ -200,7 +200,7 @@ void InterfaceLib_SystemEvent(InterfaceLib::Globals* globals, MachineState* stat
 
 void InterfaceLib_SystemTask(InterfaceLib::Globals* globals, MachineState* state)
 {
-	globals->ipc().PerformAction<void>(IPCMessage::RefreshWindows);
+	globals->ipc().PostAction(IPCMessage::RefreshWindows);
 }
 
 void InterfaceLib_WaitMouseUp(InterfaceLib::Globals* globals, MachineState* state)
@@ -210,7 +210,7 @@ void InterfaceLib_WaitMouseUp(InterfaceLib::Globals* globals, MachineState* stat
 
 void InterfaceLib_WaitNextEvent(InterfaceLib::Globals* globals, MachineState* state)
 {
-	globals->ipc().PerformAction<void>(IPCMessage::RefreshWindows);
+	globals->ipc().PostAction(IPCMessage::RefreshWindows);
 	
 	MacRegion emptyRegion;
 	emptyRegion.rgnSize = 10;
@@ -125,7 +125,7 @@ namespace
 			
 			size_t paletteSize = sizeof(Palette) + sizeof(ColorInfo) * palette->pmEntries;
 			uint8_t* paletteBytes = allocator.Allocate(namePrefix + "palette", paletteSize);
-			memcpy(paletteBytes, palette, paletteSize);
+			Common::GuestLayout::Move(paletteBytes, palette, paletteSize);
 			this->palette = reinterpret_cast<Palette*>(paletteBytes);
 			
 			size_t colorTableSize = sizeof(ColorTable) + sizeof(ColorSpec) * palette->pmEntries;
@@ -110,7 +110,7 @@ void InterfaceLib___LibraryInit(InterfaceLib::Globals* globals, PPCVM::MachineSt
 	if (state->r3 > 0)
 	{
 		const Common::UInt32* argv = globals->allocator.ToPointer<Common::UInt32>(state->r4);
-		std::string programPath = globals->allocator.ToPointer<char>(argv[0]);
+		std::string programPath = Common::GuestLayout::ReadString(globals->allocator.ToPointer<char>(argv[0]));
 		std::string programName = programPath.substr(programPath.find_last_of('/') + 1);
 		globals->resources().LoadFileResources(programPath);
 		globals->uiChannel = new InterfaceLib::UIChannel(programName);
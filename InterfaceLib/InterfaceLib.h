@@ -54,6 +54,7 @@ namespace InterfaceLib
 		Globals(Common::Allocator& allocator, OSEnvironment::Managers& managers);
 		
 		inline UIChannel& ipc() { return *uiChannel; }
+		inline OSEnvironment::MemoryManager& memory() { return managers.MemoryManager(); }
 		inline OSEnvironment::ResourceManager& resources() { return managers.ResourceManager(); }
 		inline OSEnvironment::Gestalt& gestalt() { return managers.Gestalt(); }
 		
@@ -19,14 +19,78 @@
 // Classix. If not, see http://www.gnu.org/licenses/.
 //
 
-#include <sstream>
+#include <cstring>
 #include "Prototypes.h"
 #include "NotImplementedException.h"
 #include "InterfaceLib.h"
 
+namespace
+{
+	uint8_t* Dereference(InterfaceLib::Globals* globals, uint32_t handle)
+	{
+		uint32_t pointer = *globals->allocator.ToPointer<Common::UInt32>(handle);
+		return globals->allocator.ToPointer<uint8_t>(pointer);
+	}
+	
+	uint32_t CopyToNewHandle(InterfaceLib::Globals* globals, const uint8_t* source, uint32_t size)
+	{
+		// the source may be a block of the zone; lock it so that making room doesn't move it
+		uint32_t sourceAddress = globals->allocator.ToIntPtr(source);
+		uint32_t sourceHandle = globals->memory().RecoverHandle(sourceAddress);
+		uint8_t sourceState = 0;
+		if (sourceHandle != 0)
+		{
+			sourceState = globals->memory().HGetState(sourceHandle);
+			globals->memory().SetHandleFlag(sourceHandle, OSEnvironment::handleLocked, true);
+		}
+	
+		uint32_t handle = globals->memory().NewHandle(size, false);
+		if (handle != 0)
+			Common::GuestLayout::Move(Dereference(globals, handle), globals->allocator.ToPointer<uint8_t>(sourceAddress), size);
+	
+		if (sourceHandle != 0)
+			globals->memory().HSetState(sourceHandle, sourceState);
+		return handle;
+	}
+	
+	int32_t AppendToHandle(InterfaceLib::Globals* globals, uint32_t handle, const uint8_t* source, uint32_t size)
+	{
+		uint32_t sourceAddress = globals->allocator.ToIntPtr(source);
+		uint32_t sourceHandle = globals->memory().RecoverHandle(sourceAddress);
+		uint8_t sourceState = 0;
+		if (sourceHandle != 0)
+		{
+			sourceState = globals->memory().HGetState(sourceHandle);
+			globals->memory().SetHandleFlag(sourceHandle, OSEnvironment::handleLocked, true);
+		}
+	
+		uint32_t oldSize = globals->memory().GetHandleSize(handle);
+		int16_t error = globals->memory().MemError();
+		if (error == 0)
+		{
+			globals->memory().SetHandleSize(handle, oldSize + size);
+			error = globals->memory().MemError();
+			if (error == 0)
+				Common::GuestLayout::Move(Dereference(globals, handle) + oldSize, globals->allocator.ToPointer<uint8_t>(sourceAddress), size);
+		}
+	
+		if (sourceHandle != 0)
+			globals->memory().HSetState(sourceHandle, sourceState);
+		return error;
+	}
+	
+	void MaxMem(InterfaceLib::Globals* globals, MachineState* state)
+	{
+		uint32_t growAddress = state->r3;
+		state->r3 = globals->memory().MaxMem();
+		if (growAddress != 0)
+			*globals->allocator.ToPointer<Common::UInt32>(growAddress) = globals->memory().GrowSpace();
+	}
+}
+
 void InterfaceLib_ApplicationZone(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().Zone();
 }
 
 void InterfaceLib_BlockMove(InterfaceLib::Globals* globals, MachineState* state)
@@ -34,7 +98,7 @@ void InterfaceLib_BlockMove(InterfaceLib::Globals* globals, MachineState* state)
 	const uint8_t* source = globals->allocator.ToPointer<uint8_t>(state->r3);
 	uint8_t* destination = globals->allocator.ToPointer<uint8_t>(state->r4);
 	size_t size = state->r5;
-	memmove(destination, source, size);
+	Common::GuestLayout::Move(destination, source, size);
 }
 
 void InterfaceLib_BlockMoveData(InterfaceLib::Globals* globals, MachineState* state)
@@ -42,17 +106,17 @@ void InterfaceLib_BlockMoveData(InterfaceLib::Globals* globals, MachineState* st
 	void* src = globals->allocator.ToPointer<void>(state->r3);
 	void* dst = globals->allocator.ToPointer<void>(state->r4);
 	uint32_t size = state->r5;
-	memmove(dst, src, size);
+	Common::GuestLayout::Move(dst, src, size);
 }
 
 void InterfaceLib_CompactMem(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().CompactMem(state->r3);
 }
 
 void InterfaceLib_CompactMemSys(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().CompactMem(state->r3);
 }
 
 void InterfaceLib_DebuggerEnter(InterfaceLib::Globals* globals, MachineState* state)
@@ -92,19 +156,20 @@ void InterfaceLib_DeferUserFn(InterfaceLib::Globals* globals, MachineState* stat
 
 void InterfaceLib_DisposeHandle(InterfaceLib::Globals* globals, MachineState* state)
 {
-	uint8_t* pointer = globals->allocator.ToPointer<uint8_t>(state->r3);
-	pointer -= 4;
-	globals->allocator.Deallocate(pointer);
+	// resource handles are zone handles too, but their catalog has to forget them
+	uint32_t handle = state->r3;
+	if (!globals->resources().DisposeResource(handle))
+		globals->memory().DisposeHandle(handle);
 }
 
 void InterfaceLib_DisposePtr(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().DisposePtr(state->r3);
 }
 
 void InterfaceLib_EmptyHandle(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().EmptyHandle(state->r3);
 }
 
 void InterfaceLib_EnterSupervisorMode(InterfaceLib::Globals* globals, MachineState* state)
@@ -119,12 +184,12 @@ void InterfaceLib_FlushMemory(InterfaceLib::Globals* globals, MachineState* stat
 
 void InterfaceLib_FreeMem(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().FreeMem();
 }
 
 void InterfaceLib_FreeMemSys(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().FreeMem();
 }
 
 void InterfaceLib_GetApplLimit(InterfaceLib::Globals* globals, MachineState* state)
@@ -134,7 +199,7 @@ void InterfaceLib_GetApplLimit(InterfaceLib::Globals* globals, MachineState* sta
 
 void InterfaceLib_GetHandleSize(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().GetHandleSize(state->r3);
 }
 
 void InterfaceLib_GetPageState(InterfaceLib::Globals* globals, MachineState* state)
@@ -149,7 +214,7 @@ void InterfaceLib_GetPhysical(InterfaceLib::Globals* globals, MachineState* stat
 
 void InterfaceLib_GetPtrSize(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().GetPtrSize(state->r3);
 }
 
 void InterfaceLib_GetVolumeVirtualMemoryInfo(InterfaceLib::Globals* globals, MachineState* state)
@@ -159,7 +224,7 @@ void InterfaceLib_GetVolumeVirtualMemoryInfo(InterfaceLib::Globals* globals, Mac
 
 void InterfaceLib_GetZone(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().Zone();
 }
 
 void InterfaceLib_GZSaveHnd(InterfaceLib::Globals* globals, MachineState* state)
@@ -169,42 +234,53 @@ void InterfaceLib_GZSaveHnd(InterfaceLib::Globals* globals, MachineState* state)
 
 void InterfaceLib_HandAndHand(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	uint32_t source = state->r3;
+	uint32_t destination = state->r4;
+	uint32_t size = globals->memory().GetHandleSize(source);
+	state->r3 = AppendToHandle(globals, destination, Dereference(globals, source), size);
 }
 
 void InterfaceLib_HandleZone(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().Zone();
 }
 
 void InterfaceLib_HandToHand(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	Common::UInt32& handle = *globals->allocator.ToPointer<Common::UInt32>(state->r3);
+	uint32_t size = globals->memory().GetHandleSize(handle);
+	uint32_t copy = CopyToNewHandle(globals, Dereference(globals, handle), size);
+	if (copy != 0)
+		handle = copy;
+	state->r3 = copy == 0 ? OSEnvironment::memFullErr : 0;
 }
 
 void InterfaceLib_HClrRBit(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().SetHandleFlag(state->r3, OSEnvironment::handleIsResource, false);
 }
 
 void InterfaceLib_HGetState(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().HGetState(state->r3);
 }
 
 void InterfaceLib_HLock(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	// locking resources also keeps them from being released
+	globals->memory().SetHandleFlag(state->r3, OSEnvironment::handleLocked, true);
 }
 
 void InterfaceLib_HLockHi(InterfaceLib::Globals* globals, MachineState* state)
 {
-	// do nothing
+	uint32_t handle = state->r3;
+	globals->memory().MoveHHi(handle);
+	globals->memory().SetHandleFlag(handle, OSEnvironment::handleLocked, true);
 }
 
 void InterfaceLib_HNoPurge(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().SetHandleFlag(state->r3, OSEnvironment::handlePurgeable, false);
 }
 
 void InterfaceLib_HoldMemory(InterfaceLib::Globals* globals, MachineState* state)
@@ -214,22 +290,22 @@ void InterfaceLib_HoldMemory(InterfaceLib::Globals* globals, MachineState* state
 
 void InterfaceLib_HPurge(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().SetHandleFlag(state->r3, OSEnvironment::handlePurgeable, true);
 }
 
 void InterfaceLib_HSetRBit(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().SetHandleFlag(state->r3, OSEnvironment::handleIsResource, true);
 }
 
 void InterfaceLib_HSetState(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().HSetState(state->r3, static_cast<uint8_t>(state->r4));
 }
 
 void InterfaceLib_HUnlock(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().SetHandleFlag(state->r3, OSEnvironment::handleLocked, false);
 }
 
 void InterfaceLib_InitApplZone(InterfaceLib::Globals* globals, MachineState* state)
@@ -244,7 +320,7 @@ void InterfaceLib_InitZone(InterfaceLib::Globals* globals, MachineState* state)
 
 void InterfaceLib_InlineGetHandleSize(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().GetHandleSize(state->r3);
 }
 
 void InterfaceLib_LockMemory(InterfaceLib::Globals* globals, MachineState* state)
@@ -279,94 +355,87 @@ void InterfaceLib_MaxApplZone(InterfaceLib::Globals* globals, MachineState* stat
 
 void InterfaceLib_MaxBlock(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().MaxBlock();
 }
 
 void InterfaceLib_MaxBlockSys(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().MaxBlock();
 }
 
 void InterfaceLib_MaxMem(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	MaxMem(globals, state);
 }
 
 void InterfaceLib_MaxMemSys(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	MaxMem(globals, state);
 }
 
 void InterfaceLib_MemError(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = static_cast<int32_t>(globals->memory().MemError());
 }
 
 void InterfaceLib_MoreMasters(InterfaceLib::Globals* globals, MachineState* state)
 {
-	// do nothing
+	globals->memory().MoreMasters();
 }
 
 void InterfaceLib_MoveHHi(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().MoveHHi(state->r3);
 }
 
 void InterfaceLib_NewEmptyHandle(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().NewEmptyHandle();
 }
 
 void InterfaceLib_NewEmptyHandleSys(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().NewEmptyHandle();
 }
 
 void InterfaceLib_NewHandle(InterfaceLib::Globals* globals, MachineState* state)
 {
-	size_t size = state->r3 + sizeof(uint32_t);
-	std::stringstream handleName;
-	handleName << "InterfaceLib Handle [" << state->r3 << " + 4]";
-	uint8_t* bytes = globals->allocator.Allocate(handleName.str(), size);
-	Common::UInt32& pointer = *reinterpret_cast<Common::UInt32*>(bytes);
-	pointer = globals->allocator.ToIntPtr(bytes) + 4;
-	state->r3 = globals->allocator.ToIntPtr(&pointer);
+	state->r3 = globals->memory().NewHandle(state->r3, false);
 }
 
 void InterfaceLib_NewHandleClear(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().NewHandle(state->r3, true);
 }
 
 void InterfaceLib_NewHandleSys(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().NewHandle(state->r3, false);
 }
 
 void InterfaceLib_NewHandleSysClear(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().NewHandle(state->r3, true);
 }
 
 void InterfaceLib_NewPtr(InterfaceLib::Globals* globals, MachineState* state)
 {
-	void* ptr = globals->allocator.Allocate("Program Allocation", state->r3);
-	state->r3 = globals->allocator.ToIntPtr(ptr);
+	state->r3 = globals->memory().NewPtr(state->r3, false);
 }
 
 void InterfaceLib_NewPtrClear(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().NewPtr(state->r3, true);
 }
 
 void InterfaceLib_NewPtrSys(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().NewPtr(state->r3, false);
 }
 
 void InterfaceLib_NewPtrSysClear(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().NewPtr(state->r3, true);
 }
 
 void InterfaceLib_PageFaultFatal(InterfaceLib::Globals* globals, MachineState* state)
@@ -376,77 +445,103 @@ void InterfaceLib_PageFaultFatal(InterfaceLib::Globals* globals, MachineState* s
 
 void InterfaceLib_PtrAndHand(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	const uint8_t* source = globals->allocator.ToPointer<uint8_t>(state->r3);
+	state->r3 = AppendToHandle(globals, state->r4, source, state->r5);
 }
 
 void InterfaceLib_PtrToHand(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	const uint8_t* source = globals->allocator.ToPointer<uint8_t>(state->r3);
+	Common::UInt32& handle = *globals->allocator.ToPointer<Common::UInt32>(state->r4);
+	handle = CopyToNewHandle(globals, source, state->r5);
+	state->r3 = handle == 0 ? OSEnvironment::memFullErr : 0;
 }
 
 void InterfaceLib_PtrToXHand(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	const uint8_t* source = globals->allocator.ToPointer<uint8_t>(state->r3);
+	uint32_t handle = state->r4;
+	uint32_t size = state->r5;
+	globals->memory().SetHandleSize(handle, size);
+	if (globals->memory().MemError() == 0)
+		Common::GuestLayout::Move(Dereference(globals, handle), source, size);
+	state->r3 = static_cast<int32_t>(globals->memory().MemError());
 }
 
 void InterfaceLib_PtrZone(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().Zone();
 }
 
 void InterfaceLib_PurgeMem(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().PurgeMem(state->r3);
 }
 
 void InterfaceLib_PurgeMemSys(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().PurgeMem(state->r3);
 }
 
 void InterfaceLib_PurgeSpace(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	uint32_t total;
+	uint32_t contiguous;
+	globals->memory().PurgeSpace(total, contiguous);
+	*globals->allocator.ToPointer<Common::UInt32>(state->r3) = total;
+	*globals->allocator.ToPointer<Common::UInt32>(state->r4) = contiguous;
 }
 
 void InterfaceLib_PurgeSpaceContiguous(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	uint32_t total;
+	uint32_t contiguous;
+	globals->memory().PurgeSpace(total, contiguous);
+	state->r3 = contiguous;
 }
 
 void InterfaceLib_PurgeSpaceSysContiguous(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	uint32_t total;
+	uint32_t contiguous;
+	globals->memory().PurgeSpace(total, contiguous);
+	state->r3 = contiguous;
 }
 
 void InterfaceLib_PurgeSpaceSysTotal(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	uint32_t total;
+	uint32_t contiguous;
+	globals->memory().PurgeSpace(total, contiguous);
+	state->r3 = total;
 }
 
 void InterfaceLib_PurgeSpaceTotal(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	uint32_t total;
+	uint32_t contiguous;
+	globals->memory().PurgeSpace(total, contiguous);
+	state->r3 = total;
 }
 
 void InterfaceLib_ReallocateHandle(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().ReallocateHandle(state->r3, state->r4);
 }
 
 void InterfaceLib_ReallocateHandleSys(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().ReallocateHandle(state->r3, state->r4);
 }
 
 void InterfaceLib_RecoverHandle(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().RecoverHandle(state->r3);
 }
 
 void InterfaceLib_RecoverHandleSys(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().RecoverHandle(state->r3);
 }
 
 void InterfaceLib_ReleaseMemoryData(InterfaceLib::Globals* globals, MachineState* state)
@@ -456,12 +551,13 @@ void InterfaceLib_ReleaseMemoryData(InterfaceLib::Globals* globals, MachineState
 
 void InterfaceLib_ReserveMem(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	// the zone has no reserved area; making room at the bottom is the best we can do
+	globals->memory().PurgeMem(state->r3);
 }
 
 void InterfaceLib_ReserveMemSys(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().PurgeMem(state->r3);
 }
 
 void InterfaceLib_SetApplBase(InterfaceLib::Globals* globals, MachineState* state)
@@ -481,12 +577,12 @@ void InterfaceLib_SetGrowZone(InterfaceLib::Globals* globals, MachineState* stat
 
 void InterfaceLib_SetHandleSize(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().SetHandleSize(state->r3, state->r4);
 }
 
 void InterfaceLib_SetPtrSize(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().SetPtrSize(state->r3, state->r4);
 }
 
 void InterfaceLib_SetZone(InterfaceLib::Globals* globals, MachineState* state)
@@ -501,37 +597,44 @@ void InterfaceLib_StackSpace(InterfaceLib::Globals* globals, MachineState* state
 
 void InterfaceLib_SystemZone(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	// there is only one zone
+	state->r3 = globals->memory().Zone();
 }
 
 void InterfaceLib_TempDisposeHandle(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().DisposeHandle(state->r3);
+	*globals->allocator.ToPointer<Common::SInt16>(state->r4) = globals->memory().MemError();
 }
 
 void InterfaceLib_TempFreeMem(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	state->r3 = globals->memory().FreeMem();
 }
 
 void InterfaceLib_TempHLock(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().SetHandleFlag(state->r3, OSEnvironment::handleLocked, true);
+	*globals->allocator.ToPointer<Common::SInt16>(state->r4) = globals->memory().MemError();
 }
 
 void InterfaceLib_TempHUnlock(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->memory().SetHandleFlag(state->r3, OSEnvironment::handleLocked, false);
+	*globals->allocator.ToPointer<Common::SInt16>(state->r4) = globals->memory().MemError();
 }
 
 void InterfaceLib_TempMaxMem(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	MaxMem(globals, state);
 }
 
 void InterfaceLib_TempNewHandle(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	// temporary memory comes from the application zone
+	uint32_t handle = globals->memory().NewHandle(state->r3, false);
+	*globals->allocator.ToPointer<Common::SInt16>(state->r4) = globals->memory().MemError();
+	state->r3 = handle;
 }
 
 void InterfaceLib_TempTopMem(InterfaceLib::Globals* globals, MachineState* state)
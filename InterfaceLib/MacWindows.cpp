@@ -105,7 +105,7 @@ void InterfaceLib_EndUpdate(InterfaceLib::Globals* globals, MachineState* state)
 	uint32_t key = state->r3;
 	UGrafPort& port = *globals->allocator.ToPointer<UGrafPort>(key);
 	CGRect dirtyRect = globals->grafPorts.EndUpdate(port);
-	globals->ipc().PerformAction<void>(IPCMessage::SetDirtyRect, key, dirtyRect);
+	globals->ipc().PostAction(IPCMessage::SetDirtyRect, key, dirtyRect);
 }
 
 void InterfaceLib_FrontWindow(InterfaceLib::Globals* globals, MachineState* state)
@@ -44,7 +44,7 @@ void InterfaceLib_CheckItem(InterfaceLib::Globals* globals, MachineState* state)
 	uint16_t menuIndex = menu->menuId;
 	uint16_t itemIndex = static_cast<uint16_t>(state->r4 - 1); // Classic menus are 1-based
 	bool check = state->r5;
-	globals->ipc().PerformAction<void>(IPCMessage::CheckItem, menuIndex, itemIndex, check);
+	globals->ipc().PostAction(IPCMessage::CheckItem, menuIndex, itemIndex, check);
 }
 
 void InterfaceLib_ClearMenuBar(InterfaceLib::Globals* globals, MachineState* state)
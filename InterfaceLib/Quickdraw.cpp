@@ -358,7 +358,7 @@ void InterfaceLib_FrameOval(InterfaceLib::Globals* globals, MachineState* state)
 	uint32_t key = globals->allocator.ToIntPtr(&port);
 	if (globals->grafPorts.UpdateRegion(port, cgRect) == false)
 	{
-		globals->ipc().PerformAction<void>(IPCMessage::SetDirtyRect, key, cgRect);
+		globals->ipc().PostAction(IPCMessage::SetDirtyRect, key, cgRect);
 	}
 }
 
@@ -494,7 +494,7 @@ void InterfaceLib_GrafDevice(InterfaceLib::Globals* globals, MachineState* state
 
 void InterfaceLib_HideCursor(InterfaceLib::Globals* globals, MachineState* state)
 {
-	globals->ipc().PerformAction<void>(IPCMessage::SetCursorVisibility, false);
+	globals->ipc().PostAction(IPCMessage::SetCursorVisibility, false);
 }
 
 void InterfaceLib_HidePen(InterfaceLib::Globals* globals, MachineState* state)
@@ -899,7 +899,7 @@ void InterfaceLib_PaintOval(InterfaceLib::Globals* globals, MachineState* state)
 	uint32_t key = globals->allocator.ToIntPtr(&port);
 	if (globals->grafPorts.UpdateRegion(port, cgRect) == false)
 	{
-		globals->ipc().PerformAction<void>(IPCMessage::SetDirtyRect, key, cgRect);
+		globals->ipc().PostAction(IPCMessage::SetDirtyRect, key, cgRect);
 	}
 }
 
@@ -1168,7 +1168,7 @@ void InterfaceLib_ShieldCursor(InterfaceLib::Globals* globals, MachineState* sta
 
 void InterfaceLib_ShowCursor(InterfaceLib::Globals* globals, MachineState* state)
 {
-	globals->ipc().PerformAction<void>(IPCMessage::SetCursorVisibility, true);
+	globals->ipc().PostAction(IPCMessage::SetCursorVisibility, true);
 }
 
 void InterfaceLib_ShowPen(InterfaceLib::Globals* globals, MachineState* state)
@@ -77,7 +77,7 @@ void InterfaceLib_DrawString(InterfaceLib::Globals* globals, MachineState* state
 	CGRect dirtyRect = CGRectMake(point.x, point.y, endPoint.x - point.x, port.color.txSize);
 	if (globals->grafPorts.UpdateRegion(port, dirtyRect) == false)
 	{
-		globals->ipc().PerformAction<void>(IPCMessage::SetDirtyRect, key, dirtyRect);
+		globals->ipc().PostAction(IPCMessage::SetDirtyRect, key, dirtyRect);
 	}
 }
 
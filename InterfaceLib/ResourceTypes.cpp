@@ -35,8 +35,8 @@ namespace InterfaceLib
 	const Resources::MENU::Item* Resources::MENU::GetFirstItem() const
 	{
 		const uint8_t* stringBase = &titleLength;
-		const char* itemBase = reinterpret_cast<const char*>(stringBase + 1 + *stringBase);
-		return *itemBase == 0 ? nullptr : reinterpret_cast<const Item*>(itemBase);
+		const char* itemBase = reinterpret_cast<const char*>(stringBase + 1 + *Common::GuestLayout::Byte(stringBase));
+		return *Common::GuestLayout::Byte(itemBase) == 0 ? nullptr : reinterpret_cast<const Item*>(itemBase);
 	}
 	
 	const Resources::cfrg::Member* Resources::cfrg::GetFirstMember() const
@@ -68,36 +68,36 @@ namespace InterfaceLib
 	{
 		const uint8_t* base = reinterpret_cast<const uint8_t*>(this);
 		const Str255* string = reinterpret_cast<const Str255*>(base);
-		return *(base + 1 + string->length);
+		return *Common::GuestLayout::Byte(base + 1 + *Common::GuestLayout::Byte(&string->length));
 	}
 	
 	uint8_t Resources::MENU::Item::GetKeyEquivalent() const
 	{
 		const uint8_t* base = reinterpret_cast<const uint8_t*>(this);
 		const Str255* string = reinterpret_cast<const Str255*>(base);
-		return *(base + 1 + string->length + 1);
+		return *Common::GuestLayout::Byte(base + 1 + *Common::GuestLayout::Byte(&string->length) + 1);
 	}
 	
 	uint8_t Resources::MENU::Item::GetCharacterMark() const
 	{
 		const uint8_t* base = reinterpret_cast<const uint8_t*>(this);
 		const Str255* string = reinterpret_cast<const Str255*>(base);
-		return *(base + 1 + string->length + 2);
+		return *Common::GuestLayout::Byte(base + 1 + *Common::GuestLayout::Byte(&string->length) + 2);
 	}
 	
 	uint8_t Resources::MENU::Item::GetTextStyle() const
 	{
 		const uint8_t* base = reinterpret_cast<const uint8_t*>(this);
 		const Str255* string = reinterpret_cast<const Str255*>(base);
-		return *(base + 1 + string->length + 3);
+		return *Common::GuestLayout::Byte(base + 1 + *Common::GuestLayout::Byte(&string->length) + 3);
 	}
 	
 	const Resources::MENU::Item* Resources::MENU::Item::GetNextItem() const
 	{
 		const uint8_t* base = reinterpret_cast<const uint8_t*>(this);
 		const Str255* string = reinterpret_cast<const Str255*>(base);
-		const uint8_t* nextBase = base + 1 + string->length + 4;
-		return *nextBase == 0 ? nullptr : reinterpret_cast<const Item*>(nextBase);
+		const uint8_t* nextBase = base + 1 + *Common::GuestLayout::Byte(&string->length) + 4;
+		return *Common::GuestLayout::Byte(nextBase) == 0 ? nullptr : reinterpret_cast<const Item*>(nextBase);
 	}
 	
 	std::string Resources::DLOG::GetTitle() const
@@ -107,7 +107,7 @@ namespace InterfaceLib
 	}
 	
 	Resources::DITL::Enumerator::Enumerator(const DITL& ditl)
-	: ditl(ditl), index(0)
+	: index(0), ditl(ditl)
 	{
 		ptr = reinterpret_cast<const uint8_t*>(&ditl) + sizeof(Common::SInt16);
 	}
@@ -123,7 +123,7 @@ namespace InterfaceLib
 			throw std::logic_error("Incrementing past limits of enumerator");
 		
 		const uint8_t* newPtr = ptr + 12;
-		Control::Type type = static_cast<Control::Type>(*newPtr & 0x7f);
+		Control::Type type = static_cast<Control::Type>(*Common::GuestLayout::Byte(newPtr) & 0x7f);
 		switch (type)
 		{
 			case Control::Button:
@@ -132,7 +132,7 @@ namespace InterfaceLib
 			case Control::StaticText:
 			case Control::EditText:
 				newPtr += 1; // bitstring
-				newPtr += 1 + *newPtr; // pstring
+				newPtr += 1 + *Common::GuestLayout::Byte(newPtr); // pstring
 				break;
 				
 			default:
@@ -152,8 +152,9 @@ namespace InterfaceLib
 	{
 		Control control;
 		control.bounds = *reinterpret_cast<const Rect*>(ptr + 4);
-		control.enabled = ptr[12] >> 7;
-		control.type = static_cast<Control::Type>(ptr[12] & 0x7f);
+		uint8_t flags = *Common::GuestLayout::Byte(ptr + 12);
+		control.enabled = flags >> 7;
+		control.type = static_cast<Control::Type>(flags & 0x7f);
 		
 		switch (control.type)
 		{
@@ -40,7 +40,7 @@ namespace Resources
 		
 		inline operator std::string() const
 		{
-			return std::string(string, length);
+			return Common::GuestLayout::ReadPascalString(this);
 		}
 	};
 	
@@ -21,6 +21,17 @@
 
 #include "Prototypes.h"
 #include "NotImplementedException.h"
+#include "InterfaceLib.h"
+
+using namespace OSEnvironment;
+
+namespace
+{
+	uint32_t ResourceHandle(ResourceEntry* entry)
+	{
+		return entry == nullptr ? 0 : entry->handle;
+	}
+}
 
 void InterfaceLib_AddResource(InterfaceLib::Globals* globals, MachineState* state)
 {
@@ -69,7 +80,7 @@ void InterfaceLib_CurResFile(InterfaceLib::Globals* globals, MachineState* state
 
 void InterfaceLib_DetachResource(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->resources().DetachResource(state->r3);
 }
 
 void InterfaceLib_FSCreateResFile(InterfaceLib::Globals* globals, MachineState* state)
@@ -119,7 +130,8 @@ void InterfaceLib_Get1NamedResource(InterfaceLib::Globals* globals, MachineState
 
 void InterfaceLib_Get1Resource(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	// there is no current resource file yet, so this searches every open file
+	InterfaceLib_GetResource(globals, state);
 }
 
 void InterfaceLib_GetIndResource(InterfaceLib::Globals* globals, MachineState* state)
@@ -164,7 +176,9 @@ void InterfaceLib_GetResInfo(InterfaceLib::Globals* globals, MachineState* state
 
 void InterfaceLib_GetResource(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	Common::FourCharCode type(state->r3);
+	uint16_t identifier = static_cast<uint16_t>(state->r4);
+	state->r3 = ResourceHandle(globals->resources().GetRawResource(type, identifier));
 }
 
 void InterfaceLib_GetResourceSizeOnDisk(InterfaceLib::Globals* globals, MachineState* state)
@@ -209,7 +223,7 @@ void InterfaceLib_ReadPartialResource(InterfaceLib::Globals* globals, MachineSta
 
 void InterfaceLib_ReleaseResource(InterfaceLib::Globals* globals, MachineState* state)
 {
-	throw PPCVM::NotImplementedException(__func__);
+	globals->resources().ReleaseResource(state->r3);
 }
 
 void InterfaceLib_RemoveResource(InterfaceLib::Globals* globals, MachineState* state)
@@ -0,0 +1,260 @@
+//
+// SharedRingBuffer.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__SharedRingBuffer__
+#define __Classix__SharedRingBuffer__
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <string>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+// This file is shared with InterfaceLibHead, which is why everything is inline.
+
+namespace InterfaceLib
+{
+	// Single-producer, single-consumer byte queue in memory that InterfaceLib shares with its head process.
+	// Positions only ever grow and wrap around naturally; the difference between them is the amount of pending data.
+	struct SharedRing
+	{
+		static const uint32_t Capacity = 0x40000;
+		
+		std::atomic<uint32_t> readPosition;
+		std::atomic<uint32_t> writePosition;
+		uint8_t data[Capacity];
+	};
+	
+	struct SharedChannelMemory
+	{
+		SharedRing requests;
+		SharedRing replies;
+	};
+	
+	// Each side has a doorbell that the other side rings when it might be asleep: the producer rings when the consumer
+	// had caught up, and the consumer rings when it makes room in a ring that the producer had filled. A burst of
+	// messages costs a single ring, and a side waits on the same doorbell whether it reads or writes; it looks at
+	// the ring again every time, so a ring meant for the other kind of wait is harmless.
+	// On Linux, doorbells are eventfds, and the pipes are only there to tell when the other side has gone away.
+	// Elsewhere, the pipes are the doorbells, which lets the head watch its doorbell with a dispatch source.
+	struct Doorbells
+	{
+		int ring; // rings the other side
+		int wait; // rung by the other side
+		int hangup; // reaches end of file once the other side has gone away
+		
+		static Doorbells FromPipes(int read, int write)
+		{
+			return Doorbells { write, read, read };
+		}
+	};
+	
+	// Creates the doorbells of the requests and of the replies, where they aren't pipes; returns false otherwise.
+	// The descriptors survive exec.
+	inline bool CreateEventDoorbells(int (&fds)[2])
+	{
+#ifdef __linux__
+		fds[0] = eventfd(0, 0);
+		fds[1] = eventfd(0, 0);
+		if (fds[0] != -1 && fds[1] != -1)
+			return true;
+		
+		if (fds[0] != -1)
+			close(fds[0]);
+		if (fds[1] != -1)
+			close(fds[1]);
+#endif
+		fds[0] = -1;
+		fds[1] = -1;
+		return false;
+	}
+	
+	// eventfds only take 8-bytes writes, and pipes don't mind
+	inline void RingDoorbell(const Doorbells& doorbells)
+	{
+		uint64_t bell = 1;
+		::write(doorbells.ring, &bell, sizeof bell);
+	}
+	
+	// returns false once the other side has gone away
+	inline bool WaitDoorbell(const Doorbells& doorbells)
+	{
+		if (doorbells.wait != doorbells.hangup)
+		{
+			// nothing is ever written to the pipes when they aren't the doorbells, so they can only hang up
+			pollfd fds[] = { { doorbells.wait, POLLIN, 0 }, { doorbells.hangup, POLLIN, 0 } };
+			while (poll(fds, 2, -1) == -1)
+			{
+				if (errno != EINTR)
+					return false;
+			}
+			
+			if ((fds[0].revents & POLLIN) == 0)
+				return false;
+		}
+		
+		uint8_t bells[64];
+		ssize_t count;
+		do
+		{
+			count = ::read(doorbells.wait, bells, sizeof bells);
+		} while (count == -1 && errno == EINTR);
+		return count > 0;
+	}
+	
+	class RingWriter
+	{
+		SharedRing& ring;
+		Doorbells doorbells;
+		
+	public:
+		RingWriter(SharedRing& ring, Doorbells doorbells)
+		: ring(ring), doorbells(doorbells)
+		{ }
+		
+		// returns false if the other end has hung up
+		bool Write(const void* bytes, size_t size)
+		{
+			const uint8_t* from = static_cast<const uint8_t*>(bytes);
+			while (size != 0)
+			{
+				uint32_t write = ring.writePosition.load(std::memory_order_relaxed);
+				uint32_t space = SharedRing::Capacity - (write - ring.readPosition.load());
+				if (space == 0)
+				{
+					// the message doesn't fit in what the reader left; it rings once it makes room
+					if (!WaitDoorbell(doorbells))
+						return false;
+					continue;
+				}
+				
+				uint32_t count = static_cast<uint32_t>(std::min<size_t>(space, size));
+				uint32_t offset = write % SharedRing::Capacity;
+				uint32_t firstPart = std::min(count, SharedRing::Capacity - offset);
+				memcpy(&ring.data[offset], from, firstPart);
+				memcpy(&ring.data[0], from + firstPart, count - firstPart);
+				
+				ring.writePosition.store(write + count);
+				if (ring.readPosition.load() == write)
+					RingDoorbell(doorbells);
+				
+				from += count;
+				size -= count;
+			}
+			return true;
+		}
+	};
+	
+	class RingReader
+	{
+		SharedRing& ring;
+		Doorbells doorbells;
+		
+	public:
+		RingReader(SharedRing& ring, Doorbells doorbells)
+		: ring(ring), doorbells(doorbells)
+		{ }
+		
+		bool IsEmpty() const
+		{
+			return ring.readPosition.load() == ring.writePosition.load();
+		}
+		
+		// returns false if the other end has hung up
+		bool Read(void* into, size_t size)
+		{
+			uint8_t* to = static_cast<uint8_t*>(into);
+			while (size != 0)
+			{
+				uint32_t read = ring.readPosition.load(std::memory_order_relaxed);
+				uint32_t available = ring.writePosition.load() - read;
+				if (available == 0)
+				{
+					if (!WaitDoorbell(doorbells))
+						return false;
+					continue;
+				}
+				
+				uint32_t count = static_cast<uint32_t>(std::min<size_t>(available, size));
+				uint32_t offset = read % SharedRing::Capacity;
+				uint32_t firstPart = std::min(count, SharedRing::Capacity - offset);
+				memcpy(to, &ring.data[offset], firstPart);
+				memcpy(to + firstPart, &ring.data[0], count - firstPart);
+				
+				ring.readPosition.store(read + count);
+				if (ring.writePosition.load() - read == SharedRing::Capacity)
+					RingDoorbell(doorbells);
+				
+				to += count;
+				size -= count;
+			}
+			return true;
+		}
+	};
+	
+	// Returns a file descriptor that survives exec, or -1.
+	inline int CreateSharedChannelMemory()
+	{
+#ifdef __linux__
+		int fd = memfd_create("InterfaceLib UIChannel", 0);
+#else
+		std::string name = "/InterfaceLib." + std::to_string(getpid());
+		int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+		if (fd != -1)
+		{
+			shm_unlink(name.c_str());
+			fcntl(fd, F_SETFD, 0);
+		}
+#endif
+		if (fd == -1)
+			return -1;
+		
+		if (ftruncate(fd, sizeof(SharedChannelMemory)) == -1)
+		{
+			close(fd);
+			return -1;
+		}
+		return fd;
+	}
+	
+	// Returns nullptr on failure. A freshly created (zero-filled) mapping is two empty rings.
+	inline SharedChannelMemory* MapSharedChannelMemory(int fd)
+	{
+		void* memory = mmap(nullptr, sizeof(SharedChannelMemory), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		return memory == MAP_FAILED ? nullptr : static_cast<SharedChannelMemory*>(memory);
+	}
+	
+	inline void UnmapSharedChannelMemory(SharedChannelMemory* memory)
+	{
+		munmap(memory, sizeof(SharedChannelMemory));
+	}
+}
+
+#endif /* defined(__Classix__SharedRingBuffer__) */
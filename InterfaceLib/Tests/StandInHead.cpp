@@ -0,0 +1,298 @@
+//
+// StandInHead.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+// A head process that takes the place of InterfaceLibHead (through INTERFACELIB_HEAD) where there is no Cocoa.
+// It speaks the same protocol over the same transports, but it only implements a handful of messages, and the
+// state it reports is its own:
+//  * Beep counts beeps;
+//  * SetCursorVisibility sets a flag;
+//  * IsMouseDown answers with that flag;
+//  * FindFrontWindow answers with the number of beeps so far;
+//  * CloseWindow answers with nothing, like the real thing;
+//  * InsertMenu checks that the title is the pattern that UIChannelTest sends, and counts its bytes;
+//  * RefreshWindows answers with the number of title bytes so far;
+//  * DragWindow makes the stand-in quit on the spot, like a head that crashed.
+// This is enough to check that requests, replies and posted actions make it across, and in order, that messages
+// bigger than the rings make it too, and that InterfaceLib notices when the head goes away.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "CommonDefinitions.h"
+#include "SharedRingBuffer.h"
+
+using namespace InterfaceLib;
+
+namespace
+{
+	// same as UIChannelTest's
+	char TitleByte(size_t index)
+	{
+		return static_cast<char>('a' + index % 26);
+	}
+	
+	bool ReadExact(int fd, void* into, size_t size)
+	{
+		uint8_t* bytes = static_cast<uint8_t*>(into);
+		while (size != 0)
+		{
+			ssize_t count = ::read(fd, bytes, size);
+			if (count < 1)
+				return false;
+			bytes += count;
+			size -= count;
+		}
+		return true;
+	}
+	
+	// same as CXILApplication's BackendChannel
+	class BackendChannel
+	{
+		int read, write;
+		SharedChannelMemory* shared;
+		Doorbells doorbells;
+		std::vector<uint8_t> outgoing;
+		
+	public:
+		BackendChannel(int read, int write, SharedChannelMemory* shared, Doorbells doorbells)
+		: read(read), write(write), shared(shared), doorbells(doorbells)
+		{}
+		
+		bool IsShared() const
+		{
+			return shared != nullptr;
+		}
+		
+		bool AnswerDoorbell()
+		{
+			return WaitDoorbell(doorbells);
+		}
+		
+		bool HasPendingMessages() const
+		{
+			return !RingReader(shared->requests, doorbells).IsEmpty();
+		}
+		
+		bool ReadBytes(void* into, size_t size)
+		{
+			if (shared != nullptr)
+				return RingReader(shared->requests, doorbells).Read(into, size);
+			return ReadExact(read, into, size);
+		}
+		
+		template<typename T>
+		bool Read(T& into)
+		{
+			return ReadBytes(&into, sizeof into);
+		}
+		
+		template<typename T>
+		void Write(const T& from)
+		{
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&from);
+			outgoing.insert(outgoing.end(), bytes, bytes + sizeof from);
+		}
+		
+		void Flush()
+		{
+			if (shared != nullptr)
+			{
+				if (!RingWriter(shared->replies, doorbells).Write(outgoing.data(), outgoing.size()))
+					exit(EXIT_SUCCESS);
+			}
+			else
+				::write(write, outgoing.data(), outgoing.size());
+			outgoing.clear();
+		}
+	};
+	
+	class StandInHead
+	{
+		BackendChannel& channel;
+		uint32_t beeps;
+		uint32_t titleBytes;
+		bool isCursorVisible;
+		
+		template<typename T>
+		T Param()
+		{
+			T value;
+			if (!channel.Read(value))
+				exit(EXIT_SUCCESS);
+			return value;
+		}
+		
+		void ExpectDone()
+		{
+			char done[4];
+			if (!channel.Read(done))
+				exit(EXIT_SUCCESS);
+			
+			if (memcmp(done, "DONE", sizeof done) != 0)
+			{
+				fprintf(stderr, "*** Expected a DONE, got %.4s\n", done);
+				abort();
+			}
+		}
+		
+		void SendDone()
+		{
+			char done[] = {'D', 'O', 'N', 'E'};
+			channel.Write(done);
+			channel.Flush();
+		}
+		
+	public:
+		StandInHead(BackendChannel& channel)
+		: channel(channel), beeps(0), titleBytes(0), isCursorVisible(true)
+		{}
+		
+		// returns false once InterfaceLib has gone away
+		bool ProcessIPCMessage()
+		{
+			if (!channel.IsShared())
+				return ProcessOneIPCMessage();
+			
+			if (!channel.AnswerDoorbell())
+				return false;
+			
+			while (channel.HasPendingMessages())
+			{
+				if (!ProcessOneIPCMessage())
+					return false;
+			}
+			return true;
+		}
+		
+		bool ProcessOneIPCMessage()
+		{
+			IPCMessage messageType;
+			if (!channel.Read(messageType))
+				return false;
+			
+			switch (messageType)
+			{
+				case IPCMessage::Beep:
+					ExpectDone();
+					beeps++;
+					break;
+				
+				case IPCMessage::SetCursorVisibility:
+					isCursorVisible = Param<bool>();
+					ExpectDone();
+					break;
+				
+				case IPCMessage::IsMouseDown:
+					ExpectDone();
+					channel.Write(isCursorVisible);
+					break;
+				
+				case IPCMessage::FindFrontWindow:
+					ExpectDone();
+					channel.Write(beeps);
+					break;
+				
+				case IPCMessage::CloseWindow:
+					Param<uint32_t>();
+					ExpectDone();
+					break;
+				
+				case IPCMessage::InsertMenu:
+				{
+					Param<uint32_t>();
+					std::string title(Param<uint32_t>(), '\0');
+					if (!title.empty() && !channel.ReadBytes(&title[0], title.size()))
+						exit(EXIT_SUCCESS);
+					ExpectDone();
+					
+					for (size_t i = 0; i < title.size(); i++)
+					{
+						if (title[i] != TitleByte(i))
+						{
+							fprintf(stderr, "*** Menu title differs at byte %zu\n", i);
+							abort();
+						}
+					}
+					titleBytes += title.size();
+					break;
+				}
+				
+				case IPCMessage::RefreshWindows:
+					ExpectDone();
+					channel.Write(titleBytes);
+					break;
+				
+				case IPCMessage::DragWindow:
+					_exit(EXIT_SUCCESS);
+				
+				default:
+					fprintf(stderr, "*** Message type %u has no implementation\n", static_cast<unsigned>(messageType));
+					abort();
+			}
+			
+			SendDone();
+			return true;
+		}
+	};
+}
+
+int main(int argc, const char** argv)
+{
+	if (argc != 3 && argc != 4 && argc != 6)
+	{
+		fprintf(stderr, "usage: %s readFd writeFd [sharedFd [requestsDoorbellFd repliesDoorbellFd]]\n", argv[0]);
+		fprintf(stderr, "This is a stand-in for InterfaceLibHead. Please let InterfaceLib launch it.\n");
+		return EXIT_FAILURE;
+	}
+	
+	int readHandle = atoi(argv[1]);
+	int writeHandle = atoi(argv[2]);
+	
+	// a third descriptor means that InterfaceLib set up shared memory
+	SharedChannelMemory* sharedMemory = nullptr;
+	if (argc >= 4)
+	{
+		int sharedHandle = atoi(argv[3]);
+		sharedMemory = MapSharedChannelMemory(sharedHandle);
+		close(sharedHandle);
+		if (sharedMemory == nullptr)
+		{
+			fprintf(stderr, "Could not map the memory shared with InterfaceLib.\n");
+			return EXIT_FAILURE;
+		}
+	}
+	
+	// the other two are eventfds, and the pipes only tell when InterfaceLib has gone away
+	Doorbells doorbells = Doorbells::FromPipes(readHandle, writeHandle);
+	if (argc == 6)
+		doorbells = Doorbells { atoi(argv[5]), atoi(argv[4]), readHandle };
+	
+	BackendChannel channel(readHandle, writeHandle, sharedMemory, doorbells);
+	StandInHead head(channel);
+	while (head.ProcessIPCMessage())
+		;
+	
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+//
+// UIChannelTest.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+// Runs UIChannel against StandInHead, once over the shared memory rings and once over plain pipes.
+// In Xcode, building the UIChannelTest target builds StandInHead and runs both. Neither needs Cocoa, so this works on
+// Linux too; from the repository root:
+//
+//   c++ -std=c++11 -IInterfaceLib -IClassixCore/Common InterfaceLib/Tests/StandInHead.cpp -o StandInHead
+//   c++ -std=c++11 -IInterfaceLib -IClassixCore/Common InterfaceLib/Tests/UIChannelTest.cpp InterfaceLib/UIChannel.cpp -o UIChannelTest
+//   ./UIChannelTest ./StandInHead
+//
+// (add -framework CoreFoundation to the second line on OS X)
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <signal.h>
+
+#include "UIChannel.h"
+
+using namespace InterfaceLib;
+
+namespace
+{
+	int failures = 0;
+	
+	// same as StandInHead's
+	char TitleByte(size_t index)
+	{
+		return static_cast<char>('a' + index % 26);
+	}
+	
+	std::string Title(size_t size)
+	{
+		std::string title(size, '\0');
+		for (size_t i = 0; i < size; i++)
+			title[i] = TitleByte(i);
+		return title;
+	}
+	
+	template<typename T>
+	void Check(const char* transport, const char* what, const T& actual, const T& expected)
+	{
+		if (actual == expected)
+			return;
+		
+		fprintf(stderr, "%s: %s: got %llu, expected %llu\n", transport, what,
+				static_cast<unsigned long long>(actual), static_cast<unsigned long long>(expected));
+		failures++;
+	}
+	
+	void RunChannel(const char* transport)
+	{
+		UIChannel channel("UIChannelTest");
+		
+		Check(transport, "request before anything", channel.PerformAction<uint32_t>(IPCMessage::FindFrontWindow), 0u);
+		
+		// posted actions are only acknowledged before the next reply, or past MaxPostedActions of them
+		channel.PostAction(IPCMessage::Beep);
+		Check(transport, "reply after one posted action", channel.PerformAction<uint32_t>(IPCMessage::FindFrontWindow), 1u);
+		
+		// that's several times MaxPostedActions, and enough bytes to wrap the rings around
+		const uint32_t beeps = 40000;
+		for (uint32_t i = 0; i < beeps; i++)
+			channel.PostAction(IPCMessage::Beep);
+		Check(transport, "reply after a burst of posted actions", channel.PerformAction<uint32_t>(IPCMessage::FindFrontWindow), beeps + 1);
+		
+		// arguments of posted actions
+		channel.PostAction(IPCMessage::SetCursorVisibility, false);
+		Check(transport, "posted argument", channel.PerformAction<bool>(IPCMessage::IsMouseDown), false);
+		channel.PostAction(IPCMessage::SetCursorVisibility, true);
+		Check(transport, "posted argument", channel.PerformAction<bool>(IPCMessage::IsMouseDown), true);
+		
+		// requests without a reply value, mixed with posted actions
+		channel.PostAction(IPCMessage::Beep);
+		channel.PerformAction<void>(IPCMessage::CloseWindow, static_cast<uint32_t>(128));
+		channel.PerformAction<void>(IPCMessage::Beep);
+		Check(transport, "void requests", channel.PerformAction<uint32_t>(IPCMessage::FindFrontWindow), beeps + 3);
+		
+		// messages several times bigger than a ring have to wait for the head to make room, more than once
+		const size_t titleSize = SharedRing::Capacity * 3 + 123;
+		channel.PostAction(IPCMessage::InsertMenu, static_cast<uint32_t>(1), Title(titleSize));
+		channel.PerformAction<void>(IPCMessage::InsertMenu, static_cast<uint32_t>(2), Title(17));
+		Check(transport, "big messages", channel.PerformAction<uint32_t>(IPCMessage::RefreshWindows), static_cast<uint32_t>(titleSize + 17));
+	}
+	
+	void RunHangUp(const char* transport)
+	{
+		UIChannel channel("UIChannelTest");
+		channel.PostAction(IPCMessage::DragWindow);
+		
+		// the head is gone, so this can't fit in the ring or the pipe, and nobody will ever make room
+		try
+		{
+			channel.PerformAction<void>(IPCMessage::InsertMenu, static_cast<uint32_t>(1), Title(SharedRing::Capacity * 2));
+		}
+		catch (std::runtime_error&)
+		{
+			return;
+		}
+		
+		fprintf(stderr, "%s: the head went away, but the channel didn't notice\n", transport);
+		failures++;
+	}
+	
+	void Run(const char* transport)
+	{
+		try
+		{
+			RunChannel(transport);
+			RunHangUp(transport);
+		}
+		catch (std::exception& ex)
+		{
+			fprintf(stderr, "%s: %s\n", transport, ex.what());
+			failures++;
+		}
+	}
+}
+
+int main(int argc, const char** argv)
+{
+	if (argc == 2)
+		setenv("INTERFACELIB_HEAD", argv[1], true);
+	
+	if (getenv("INTERFACELIB_HEAD") == nullptr)
+	{
+		fprintf(stderr, "usage: %s path/to/StandInHead\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	
+	// writing to a pipe that the head closed should fail, not kill the process
+	signal(SIGPIPE, SIG_IGN);
+	
+	unsetenv("INTERFACELIB_PIPE_CHANNEL");
+	Run("shared memory");
+	
+	setenv("INTERFACELIB_PIPE_CHANNEL", "1", true);
+	Run("pipes");
+	
+	if (failures != 0)
+	{
+		fprintf(stderr, "%i failure(s)\n", failures);
+		return EXIT_FAILURE;
+	}
+	
+	printf("UIChannel: all passed\n");
+	return EXIT_SUCCESS;
+}
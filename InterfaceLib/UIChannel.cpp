@@ -19,14 +19,19 @@
 // Classix. If not, see http://www.gnu.org/licenses/.
 //
 
+#ifdef __APPLE__
 #include <CoreFoundation/CoreFoundation.h>
+#endif
 #include <sstream>
+#include <cstdlib>
+#include <cerrno>
 #include <unistd.h>
 
 #include "UIChannel.h"
 
 namespace
 {
+#ifdef __APPLE__
 	std::string CFStringToStdString(CFStringRef string, CFStringEncoding encoding = kCFStringEncodingMacRoman) noexcept
 	{
 		if (const char* ptr = CFStringGetCStringPtr(string, encoding))
@@ -47,26 +52,85 @@ namespace
 		CFRelease(path);
 		return result;
 	}
+#endif
 	
-	void LaunchHead(const std::string& dockName, int readPipe, int writePipe) noexcept
+	std::string HeadPath()
 	{
+		// lets a stand-in head process take the place of the real one, which only exists on OS X
+		if (const char* path = getenv("INTERFACELIB_HEAD"))
+			return path;
+		
+#ifdef __APPLE__
 		CFBundleRef bundle = CFBundleGetBundleWithIdentifier(CFSTR("com.felixcloutier.InterfaceLib"));
 		CFURLRef url = CFBundleCopyResourceURL(bundle, CFSTR("InterfaceLibHead"), CFSTR("app"), nullptr);
+		return CFURLToStdString(url) + "/Contents/MacOS/InterfaceLibHead";
+#else
+		return "InterfaceLibHead";
+#endif
+	}
+	
+	void LaunchHead(const std::string& dockName, int readPipe, int writePipe, int sharedMemory, const int (&eventDoorbells)[2]) noexcept
+	{
+		std::string processPath = HeadPath();
+		std::string readFd = std::to_string(readPipe);
+		std::string writeFd = std::to_string(writePipe);
+		std::string sharedFd = std::to_string(sharedMemory);
+		std::string requestsFd = std::to_string(eventDoorbells[0]);
+		std::string repliesFd = std::to_string(eventDoorbells[1]);
 		
-		std::stringstream processPath;
-		std::stringstream readFd;
-		std::stringstream writeFd;
-		readFd << readPipe;
-		writeFd << writePipe;
-		processPath << CFURLToStdString(url) << "/Contents/MacOS/InterfaceLibHead";
-		execl(processPath.str().c_str(),
-			  processPath.str().c_str(), readFd.str().c_str(), writeFd.str().c_str(), nullptr);
+		// The head uses the shared memory transport when it gets a third descriptor, and eventfd doorbells when it
+		// gets two more. It goes by the name of the program.
+		const char* arguments[] = {
+			dockName.c_str(), readFd.c_str(), writeFd.c_str(),
+			sharedMemory == -1 ? nullptr : sharedFd.c_str(),
+			eventDoorbells[0] == -1 ? nullptr : requestsFd.c_str(),
+			repliesFd.c_str(),
+			nullptr
+		};
+		execv(processPath.c_str(), const_cast<char* const*>(arguments));
+	}
+	
+	bool ReadExact(int fd, void* into, size_t size)
+	{
+		uint8_t* bytes = static_cast<uint8_t*>(into);
+		while (size != 0)
+		{
+			ssize_t count = ::read(fd, bytes, size);
+			if (count < 1)
+			{
+				if (count == -1 && errno == EINTR)
+					continue;
+				return false;
+			}
+			bytes += count;
+			size -= count;
+		}
+		return true;
+	}
+	
+	bool WriteExact(int fd, const void* from, size_t size)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(from);
+		while (size != 0)
+		{
+			ssize_t count = ::write(fd, bytes, size);
+			if (count < 1)
+			{
+				if (count == -1 && errno == EINTR)
+					continue;
+				return false;
+			}
+			bytes += count;
+			size -= count;
+		}
+		return true;
 	}
 }
 
 namespace InterfaceLib
 {
 	UIChannel::UIChannel(const std::string& dockName)
+	: shared(nullptr), eventDoorbells{-1, -1}, postedActions(0)
 	{
 		if (pipe(read.fd) == -1)
 			throw std::runtime_error(strerror(errno));
@@ -78,6 +142,21 @@ namespace InterfaceLib
 			throw std::runtime_error(strerror(errno));
 		}
 		
+		int sharedMemory = getenv("INTERFACELIB_PIPE_CHANNEL") == nullptr ? CreateSharedChannelMemory() : -1;
+		if (sharedMemory != -1)
+		{
+			shared = MapSharedChannelMemory(sharedMemory);
+			if (shared == nullptr)
+			{
+				close(sharedMemory);
+				sharedMemory = -1;
+			}
+		}
+		
+		doorbells = Doorbells::FromPipes(read.read, write.write);
+		if (shared != nullptr && CreateEventDoorbells(eventDoorbells))
+			doorbells = Doorbells { eventDoorbells[0], eventDoorbells[1], read.read };
+		
 		head = fork();
 		if (head == -1)
 		{
@@ -85,23 +164,82 @@ namespace InterfaceLib
 			close(read.write);
 			close(write.read);
 			close(write.write);
+			if (shared != nullptr)
+			{
+				UnmapSharedChannelMemory(shared);
+				close(sharedMemory);
+			}
+			CloseEventDoorbells();
 			throw std::runtime_error("Failed to fork the head process");
 		}
 		else if (head == 0)
 		{
 			close(write.write);
 			close(read.read);
-			LaunchHead(dockName, write.read, read.write);
+			LaunchHead(dockName, write.read, read.write, sharedMemory, eventDoorbells);
+			_exit(EXIT_FAILURE);
 		}
 		else
 		{
 			close(write.read);
 			close(read.write);
+			if (sharedMemory != -1)
+				close(sharedMemory);
+		}
+	}
+	
+	void UIChannel::CloseEventDoorbells()
+	{
+		for (int fd : eventDoorbells)
+		{
+			if (fd != -1)
+				close(fd);
 		}
 	}
 	
+	size_t UIChannel::Append(const void* bytes, size_t size)
+	{
+		const uint8_t* begin = static_cast<const uint8_t*>(bytes);
+		outgoing.insert(outgoing.end(), begin, begin + size);
+		return size;
+	}
+	
+	void UIChannel::Flush()
+	{
+		bool sent = shared != nullptr
+			? RingWriter(shared->requests, doorbells).Write(outgoing.data(), outgoing.size())
+			: WriteExact(write.write, outgoing.data(), outgoing.size());
+		
+		if (!sent)
+			throw std::runtime_error("Lost connection to the head process");
+	}
+	
+	void UIChannel::Receive(void* into, size_t size)
+	{
+		bool received = shared != nullptr
+			? RingReader(shared->replies, doorbells).Read(into, size)
+			: ReadExact(read.read, into, size);
+		
+		if (!received)
+			throw std::runtime_error("Lost connection to the head process");
+	}
+	
+	void UIChannel::ExpectDone()
+	{
+		char done[4];
+		Receive(done, sizeof done);
+		if (memcmp(done, "DONE", sizeof done) != 0)
+			throw std::logic_error("Wrong return type for action");
+	}
+	
+	void UIChannel::CollectPostedActions()
+	{
+		for (; postedActions != 0; postedActions--)
+			ExpectDone();
+	}
+	
 	template<>
-	void UIChannel::ReturnNonVoid(const uint8_t* buffer) {}
+	void UIChannel::ReturnNonVoid(const uint8_t*) {}
 	
 	template<>
 	size_t UIChannel::WriteToPipe(const MacRegion& region)
@@ -109,7 +247,7 @@ namespace InterfaceLib
 		size_t total = WriteToPipe(region.rgnSize);
 		total += WriteToPipe(region.rgnBBox);
 		const char* bytes = reinterpret_cast<const char*>(&region) + sizeof region;
-		total += ::write(write.write, bytes, region.rgnSize - 10);
+		total += Append(bytes, region.rgnSize - 10);
 		return total;
 	}
 	
@@ -118,7 +256,7 @@ namespace InterfaceLib
 	{
 		uint32_t length = static_cast<uint32_t>(string.length());
 		size_t total = WriteToPipe(length);
-		total += ::write(write.write, string.data(), length);
+		total += Append(string.data(), length);
 		return total;
 	}
 	
@@ -126,5 +264,8 @@ namespace InterfaceLib
 	{
 		close(write.write);
 		close(read.read);
+		CloseEventDoorbells();
+		if (shared != nullptr)
+			UnmapSharedChannelMemory(shared);
 	}
 }
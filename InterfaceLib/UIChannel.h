@@ -28,9 +28,13 @@
 #include <tuple>
 #include <unistd.h>
 #include "CommonDefinitions.h"
+#include "SharedRingBuffer.h"
 
 namespace InterfaceLib
 {
+	// Messages go to the head process either through rings in shared memory, with doorbells to wake either side up,
+	// or through the pipes themselves when shared memory isn't available (or INTERFACELIB_PIPE_CHANNEL is set).
+	// Either way, a message is sent with a single call, and the bytes are the same.
 	class UIChannel
 	{
 		union Pipe
@@ -61,13 +65,14 @@ namespace InterfaceLib
 		template<typename TTupleType>
 		struct TupleReader
 		{
-			int fd;
+			UIChannel& channel;
 			TTupleType storage;
 			
 			template<typename TElement>
 			inline size_t ReadOne(size_t index, TElement& into)
 			{
-				return ::read(fd, &into, sizeof into);
+				channel.Receive(&into, sizeof into);
+				return sizeof into;
 			}
 			
 			template<size_t... Ns>
@@ -76,7 +81,7 @@ namespace InterfaceLib
 				PACK_EXPAND(ReadOne(Ns, std::get<Ns>(storage)));
 			}
 			
-			TupleReader(int fd) : fd(fd)
+			TupleReader(UIChannel& channel) : channel(channel)
 			{ }
 			
 			inline void Read()
@@ -91,7 +96,7 @@ namespace InterfaceLib
 		size_t WriteToPipe(const T& argument)
 		{
 			static_assert(!std::is_pointer<T>::value, "Using WriteToPipe with a pointer type");
-			return ::write(write.write, &argument, sizeof argument);
+			return Append(&argument, sizeof argument);
 		}
 		
 		template<typename T>
@@ -110,12 +115,39 @@ namespace InterfaceLib
 			return *reinterpret_cast<const T*>(buffer);
 		}
 		
+		size_t Append(const void* bytes, size_t size);
+		void Flush();
+		void Receive(void* into, size_t size);
+		void ExpectDone();
+		void CollectPostedActions();
+		void CloseEventDoorbells();
+		
+		template<typename... TArgument>
+		void Send(IPCMessage message, TArgument&&... argument)
+		{
+			char doneReference[4] = {'D', 'O', 'N', 'E'};
+			
+			outgoing.clear();
+			WriteToPipe(message);
+			PACK_EXPAND(WriteToPipe(argument));
+			WriteToPipe(doneReference);
+			Flush();
+		}
+		
 		// fields
 		Pipe read;
 		Pipe write;
 		pid_t head;
+		SharedChannelMemory* shared;
+		int eventDoorbells[2]; // requests, replies; -1 where the pipes are the doorbells
+		Doorbells doorbells;
+		std::vector<uint8_t> outgoing;
+		uint32_t postedActions;
 		
 	public:
+		// past that many unacknowledged posted actions, PostAction waits for the head to catch up
+		static const uint32_t MaxPostedActions = 1024;
+		
 		UIChannel(const std::string& dockName);
 		
 		template<typename TReturnType, typename... TArgument>
@@ -123,41 +155,38 @@ namespace InterfaceLib
 		{
 			static_assert(!std::is_pointer<TReturnType>::value, "Using DoMessage with a pointer type");
 			
-			char doneReference[4] = {'D', 'O', 'N', 'E'};
-			
-			::write(write.write, &message, sizeof message);
-			PACK_EXPAND(WriteToPipe(argument));
-			::write(write.write, doneReference, sizeof doneReference);
+			Send(message, argument...);
+			CollectPostedActions();
 			
 			uint8_t response[sizeof(TReturnType)];
 			if (!std::is_void<TReturnType>::value)
-				::read(read.read, response, sizeof response);
-			
-			char done[4];
-			::read(read.read, done, sizeof done);
-			if (memcmp(done, doneReference, sizeof doneReference) != 0)
-				throw std::logic_error("Wrong return type for action");
+				Receive(response, sizeof response);
 			
+			ExpectDone();
 			return ReturnNonVoid<TReturnType>(response);
 		}
 		
+		// Like PerformAction<void>, but doesn't wait for the head to process the action. This is only suitable for
+		// actions that the head completes right away; their acknowledgements are collected before the next reply.
+		template<typename... TArgument>
+		void PostAction(IPCMessage message, TArgument&&... argument)
+		{
+			Send(message, argument...);
+			postedActions++;
+			if (postedActions == MaxPostedActions)
+				CollectPostedActions();
+		}
+		
 		template<typename TTupleType, typename... TArgument>
 		TTupleType PerformComplexAction(IPCMessage message, TArgument&&... argument)
 		{
-			char doneReference[4] = {'D', 'O', 'N', 'E'};
+			Send(message, argument...);
+			CollectPostedActions();
 			
-			::write(write.write, &message, sizeof message);
-			PACK_EXPAND(WriteToPipe(argument));
-			::write(write.write, doneReference, sizeof doneReference);
-			
-			TupleReader<TTupleType> reader(read.read);
+			TupleReader<TTupleType> reader(*this);
 			reader.Read();
 			
-			char done[4];
-			::read(read.read, done, sizeof done);
-			if (memcmp(done, doneReference, sizeof doneReference) != 0)
-				throw std::logic_error("Wrong return type for action");
-			
+			ExpectDone();
 			return reader.storage;
 		}
 		
@@ -170,6 +199,9 @@ namespace InterfaceLib
 		typedef typename UIChannel::Indices<> Type;
 	};
 	
+	template<>
+	void UIChannel::ReturnNonVoid(const uint8_t*);
+	
 	template<>
 	size_t UIChannel::WriteToPipe(const std::string& argument);
 	
@@ -370,18 +370,18 @@ void InterfaceLib_dragwindow(InterfaceLib::Globals* globals, MachineState* state
 
 void InterfaceLib_DrawMenuBar(InterfaceLib::Globals* globals, MachineState* state)
 {
-	globals->ipc().PerformAction<void>(IPCMessage::ClearMenus);
+	globals->ipc().PostAction(IPCMessage::ClearMenus);
 	for (const Resources::MENU* menu : globals->menus)
 	{
 		uint16_t menuId = menu->menuId;
-		globals->ipc().PerformAction<void>(IPCMessage::InsertMenu, menuId, menu->GetTitle());
+		globals->ipc().PostAction(IPCMessage::InsertMenu, menuId, menu->GetTitle());
 		size_t i = 1;
 		for (const auto* menuItem = menu->GetFirstItem(); menuItem != nullptr; menuItem = menuItem->GetNextItem())
 		{
 			std::string title = menuItem->GetTitle();
 			char keyEquivalent = menuItem->GetKeyEquivalent();
 			bool enabled = (menu->enableFlags & (1 << i)) != 0;
-			globals->ipc().PerformAction<void>(IPCMessage::InsertMenuItem, menuId, title, keyEquivalent, enabled);
+			globals->ipc().PostAction(IPCMessage::InsertMenuItem, menuId, title, keyEquivalent, enabled);
 			i++;
 		}
 	}
@@ -552,7 +552,7 @@ void InterfaceLib_GetMenu(InterfaceLib::Globals* globals, MachineState* state)
 {
 	uint16_t key = static_cast<uint16_t>(state->r3);
 	ResourceEntry* entry = globals->resources().GetRawResource("MENU", key);
-	state->r3 = globals->allocator.ToIntPtr(&entry->handle());
+	state->r3 = entry == nullptr ? 0 : entry->handle;
 }
 
 void InterfaceLib_getmenuitemtext(InterfaceLib::Globals* globals, MachineState* state)
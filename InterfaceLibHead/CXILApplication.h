@@ -31,6 +31,7 @@
 
 // IPC messages implementation
 -(void)processIPCMessage;
+-(void)processOneIPCMessage;
 
 // get a copy of the next EventRecord matching the EventMask without altering the queue
 -(void)peekNextEvent;
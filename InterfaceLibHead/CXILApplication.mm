@@ -26,7 +26,9 @@
 #include <list>
 #include <stack>
 #include <unordered_map>
+#include <vector>
 #include "CommonDefinitions.h"
+#include "SharedRingBuffer.h"
 #include "CFOwningRef.h"
 #include "Todo.h"
 
@@ -128,25 +130,66 @@ namespace
 		return true;
 	}
 	
+	// With shared memory, messages come and go through rings and the pipes are only doorbells.
+	// Replies are buffered until Flush, so that each one takes a single write at most.
 	class BackendChannel
 	{
 		int read, write;
+		InterfaceLib::SharedChannelMemory* shared;
+		InterfaceLib::Doorbells doorbells;
+		std::vector<uint8_t> outgoing;
 		
 	public:
-		BackendChannel(int read, int write) : read(read), write(write) {}
+		BackendChannel(int read, int write, InterfaceLib::SharedChannelMemory* shared)
+		: read(read), write(write), shared(shared), doorbells(InterfaceLib::Doorbells::FromPipes(read, write))
+		{}
+		
+		bool IsShared() const
+		{
+			return shared != nullptr;
+		}
+		
+		// when shared, the dispatch source watches the doorbell; returns false if InterfaceLib has gone away
+		bool AnswerDoorbell()
+		{
+			return InterfaceLib::WaitDoorbell(doorbells);
+		}
+		
+		bool HasPendingMessages() const
+		{
+			return !InterfaceLib::RingReader(shared->requests, doorbells).IsEmpty();
+		}
+		
+		bool ReadBytes(void* into, size_t size)
+		{
+			if (shared != nullptr)
+				return InterfaceLib::RingReader(shared->requests, doorbells).Read(into, size);
+			return ReadExact(read, into, size);
+		}
 		
 		template<typename T>
 		bool Read(T& into)
 		{
-			return ReadExact(read, &into, sizeof into);
+			return ReadBytes(&into, sizeof into);
 		}
 		
 		template<typename T>
 		bool Write(const T& from)
 		{
-			::write(write, &from, sizeof from);
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&from);
+			outgoing.insert(outgoing.end(), bytes, bytes + sizeof from);
 			return true;
 		}
+		
+		void Flush()
+		{
+			// if InterfaceLib has gone away, the dispatch source will notice the hangup
+			if (shared != nullptr)
+				InterfaceLib::RingWriter(shared->replies, doorbells).Write(outgoing.data(), outgoing.size());
+			else
+				::write(write, outgoing.data(), outgoing.size());
+			outgoing.clear();
+		}
 	};
 	
 	template<>
@@ -159,7 +202,7 @@ namespace
 			return false;
 		
 		size_t rest = region.rgnSize - 10;
-		if (!ReadExact(read, &region.rgnData, rest))
+		if (!ReadBytes(&region.rgnData, rest))
 			return false;
 		
 		memset(&region.rgnData[rest], 0, sizeof region.rgnData - rest);
@@ -174,7 +217,7 @@ namespace
 			return false;
 		
 		std::unique_ptr<char> buffer(new char[length]);
-		if (!ReadExact(read, buffer.get(), length))
+		if (!ReadBytes(buffer.get(), length))
 			return false;
 		
 		into = std::string(buffer.get(), length);
@@ -243,7 +286,7 @@ const size_t ipcSelectorCount = sizeof ipcSelectors / sizeof(SEL);
 		return nil;
 	
 	NSArray* arguments = NSProcessInfo.processInfo.arguments;
-	if (arguments.count != 3)
+	if (arguments.count != 3 && arguments.count != 4)
 	{
 		NSLog(@"InterfaceLibHead is not meant to be run directly. Please let InterfaceLib launch it.");
 		NSLog(@"Bad arguments passed to main().");
@@ -264,7 +307,21 @@ const size_t ipcSelectorCount = sizeof ipcSelectors / sizeof(SEL);
 	dispatch_source_set_event_handler(ipcSource, ^{ [self processIPCMessage]; });
 	dispatch_resume(ipcSource);
 	
-	channel = new BackendChannel(readHandle, writeHandle);
+	// a third descriptor means that InterfaceLib set up shared memory
+	InterfaceLib::SharedChannelMemory* sharedMemory = nullptr;
+	if (arguments.count == 4)
+	{
+		int sharedHandle = [arguments[3] intValue];
+		sharedMemory = InterfaceLib::MapSharedChannelMemory(sharedHandle);
+		close(sharedHandle);
+		if (sharedMemory == nullptr)
+		{
+			NSLog(@"Could not map the memory shared with InterfaceLib.");
+			return nil;
+		}
+	}
+	
+	channel = new BackendChannel(readHandle, writeHandle, sharedMemory);
 	
 	screenBounds = NSScreen.mainScreen.frame;
 	
@@ -456,6 +513,7 @@ const size_t ipcSelectorCount = sizeof ipcSelectors / sizeof(SEL);
 {
 	char done[] = {'D', 'O', 'N', 'E'};
 	channel->Write(done);
+	channel->Flush();
 }
 
 -(void)expectDone
@@ -472,6 +530,21 @@ const size_t ipcSelectorCount = sizeof ipcSelectors / sizeof(SEL);
 }
 
 -(void)processIPCMessage
+{
+	if (!channel->IsShared())
+	{
+		[self processOneIPCMessage];
+		return;
+	}
+	
+	if (!channel->AnswerDoorbell())
+		[self terminate:self];
+	
+	while (channel->HasPendingMessages())
+		[self processOneIPCMessage];
+}
+
+-(void)processOneIPCMessage
 {
 	unsigned messageType;
 	if (!channel->Read(messageType))
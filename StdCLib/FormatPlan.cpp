@@ -0,0 +1,159 @@
+//
+// FormatPlan.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include "FormatPlan.h"
+#include "NotImplementedException.h"
+#include <cctype>
+#include <cstring>
+
+namespace StdCLib
+{
+	FormatPlan ParseFormat(const char* format)
+	{
+		FormatPlan plan;
+		plan.source = format;
+		
+		std::string literal;
+		const char* iter = format;
+		while (*iter != 0)
+		{
+			if (*iter != '%')
+			{
+				literal += *iter;
+				iter++;
+				continue;
+			}
+			
+			if (iter[1] == '%')
+			{
+				literal += '%';
+				iter += 2;
+				continue;
+			}
+			
+			const char* conversionStart = iter;
+			FormatConversion conversion;
+			conversion.specifier = "%";
+			conversion.starCount = 0;
+			iter++;
+			
+			while (*iter != 0 && strchr("-+ #0'", *iter) != nullptr)
+				conversion.specifier += *iter++;
+			
+			if (*iter == '*')
+			{
+				conversion.starCount++;
+				conversion.specifier += *iter++;
+			}
+			else while (isdigit(*iter))
+				conversion.specifier += *iter++;
+			
+			if (*iter == '$')
+				throw PPCVM::NotImplementedException(__func__, "Positional arguments are not supported in format strings");
+			
+			if (*iter == '.')
+			{
+				conversion.specifier += *iter++;
+				if (*iter == '*')
+				{
+					conversion.starCount++;
+					conversion.specifier += *iter++;
+				}
+				else while (isdigit(*iter))
+					conversion.specifier += *iter++;
+			}
+			
+			// longs, size_t and ptrdiff_t are 32 bits wide on the guest, so most length modifiers go away
+			std::string length;
+			while (*iter != 0 && strchr("hlLqjzt", *iter) != nullptr)
+				length += *iter++;
+			
+			bool isLongLong = length == "ll" || length == "q" || length == "j";
+			conversion.isPlainString = false;
+			char type = *iter;
+			switch (type)
+			{
+				case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+					conversion.argument = isLongLong ? FormatArgument::DoubleWord : FormatArgument::Word;
+					if (isLongLong)
+						conversion.specifier += "ll";
+					else if (length == "h" || length == "hh")
+						conversion.specifier += length;
+					conversion.specifier += type;
+					break;
+					
+				case 'D': case 'O': case 'U':
+					conversion.argument = FormatArgument::Word;
+					conversion.specifier += static_cast<char>(tolower(type));
+					break;
+					
+				case 'c': case 'C':
+					conversion.argument = FormatArgument::Word;
+					conversion.specifier += 'c';
+					break;
+					
+				case 'p':
+					conversion.argument = FormatArgument::Word;
+					conversion.specifier.insert(1, "#");
+					conversion.specifier += 'x';
+					break;
+					
+				case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+					if (length == "L")
+						throw PPCVM::NotImplementedException(__func__, "Long doubles are not supported in format strings");
+					conversion.argument = FormatArgument::Double;
+					conversion.specifier += type;
+					break;
+					
+				case 's': case 'S':
+					conversion.argument = FormatArgument::String;
+					conversion.isPlainString = conversion.specifier.length() == 1;
+					conversion.specifier += 's';
+					break;
+					
+				case 'n':
+					if (length == "hh")
+						conversion.argument = FormatArgument::ByteCharCount;
+					else if (length == "h")
+						conversion.argument = FormatArgument::HalfWordCharCount;
+					else if (isLongLong)
+						conversion.argument = FormatArgument::DoubleWordCharCount;
+					else
+						conversion.argument = FormatArgument::CharCount;
+					break;
+					
+				default:
+					// not something we know how to format; print it as is
+					if (type != 0)
+						iter++;
+					literal.append(conversionStart, iter);
+					continue;
+			}
+			
+			iter++;
+			conversion.literal.swap(literal);
+			plan.conversions.push_back(std::move(conversion));
+		}
+		
+		plan.trailing.swap(literal);
+		return plan;
+	}
+}
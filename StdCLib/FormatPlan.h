@@ -0,0 +1,66 @@
+//
+// FormatPlan.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef __Classix__FormatPlan__
+#define __Classix__FormatPlan__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace StdCLib
+{
+	// Format strings are parsed once and cached by guest address. Each conversion keeps the specifier to hand
+	// to snprintf, and the kind of argument that it consumes.
+	enum class FormatArgument : uint8_t
+	{
+		Word,
+		DoubleWord,
+		Double,
+		String,
+		CharCount, // %n
+		ByteCharCount, // %hhn
+		HalfWordCharCount, // %hn
+		DoubleWordCharCount, // %lln, %qn and %jn
+	};
+	
+	struct FormatConversion
+	{
+		std::string literal; // text that comes before the conversion
+		std::string specifier;
+		FormatArgument argument;
+		uint8_t starCount; // each '*' width or precision takes a word before the argument
+		bool isPlainString; // "%s" is simply appended
+	};
+	
+	struct FormatPlan
+	{
+		std::string source;
+		std::vector<FormatConversion> conversions;
+		std::string trailing;
+	};
+	
+	// Splits a printf format string into conversions. Guest longs, size_t and ptrdiff_t are 32 bits wide, so the
+	// specifiers are rewritten for the host where that matters.
+	FormatPlan ParseFormat(const char* format);
+}
+
+#endif /* defined(__Classix__FormatPlan__) */
@@ -0,0 +1,82 @@
+//
+// Sorting.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include "Sorting.h"
+#include "GuestCall.h"
+#include "GuestLayout.h"
+#include "AccessViolationException.h"
+#include <algorithm>
+#include <vector>
+
+namespace StdCLib
+{
+	void Sort(Common::Allocator& allocator, PPCVM::MachineState* state, uint32_t base, uint32_t count, uint32_t size, uint32_t compare)
+	{
+		if (count < 2 || size == 0)
+			return;
+		
+		// the array has to fit in guest memory, which also keeps the offsets below from wrapping around
+		uint64_t total = static_cast<uint64_t>(count) * size;
+		if (total > static_cast<uint64_t>(UINT32_MAX - base) + 1 || total > SIZE_MAX)
+			throw Common::AccessViolationException(allocator, base, static_cast<size_t>(std::min<uint64_t>(total, SIZE_MAX)));
+		
+		// Sort the addresses of the elements, then move the elements where they belong. The comparator is
+		// called through the same GuestCall every time.
+		std::vector<uint32_t> order(count);
+		for (uint32_t i = 0; i < count; i++)
+			order[i] = base + i * size;
+		
+		{
+			PPCVM::Execution::GuestCall comparator(allocator, state, compare);
+			std::stable_sort(order.begin(), order.end(), [&comparator](uint32_t a, uint32_t b)
+			{
+				return static_cast<int32_t>(comparator(a, b)) < 0;
+			});
+		}
+		
+		std::vector<uint8_t> sorted(static_cast<size_t>(total));
+		for (uint32_t i = 0; i < count; i++)
+			Common::GuestLayout::CopyFromGuest(&sorted[static_cast<size_t>(i) * size], allocator.ToPointer<const uint8_t>(order[i]), size);
+		Common::GuestLayout::CopyToGuest(allocator.ToPointer<uint8_t>(base), sorted.data(), sorted.size());
+	}
+	
+	uint32_t Search(Common::Allocator& allocator, PPCVM::MachineState* state, uint32_t key, uint32_t base, uint32_t count, uint32_t size, uint32_t compare)
+	{
+		uint32_t low = 0;
+		uint32_t high = count;
+		PPCVM::Execution::GuestCall comparator(allocator, state, compare);
+		while (low < high)
+		{
+			uint32_t middle = low + (high - low) / 2;
+			uint32_t element = base + middle * size;
+			int32_t result = static_cast<int32_t>(comparator(key, element));
+			if (result == 0)
+				return element;
+			
+			if (result < 0)
+				high = middle;
+			else
+				low = middle + 1;
+		}
+		return 0;
+	}
+}
@@ -0,0 +1,40 @@
+//
+// Sorting.h
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef __Classix__Sorting__
+#define __Classix__Sorting__
+
+#include <cstdint>
+#include "Allocator.h"
+#include "MachineState.h"
+
+namespace StdCLib
+{
+	// qsort and bsearch. The comparator is a guest function pointer, and it's called on the machine state of the
+	// native call that these run in (see GuestCall).
+	void Sort(Common::Allocator& allocator, PPCVM::MachineState* state, uint32_t base, uint32_t count, uint32_t size, uint32_t compare);
+	
+	// returns the guest address of a matching element, or 0
+	uint32_t Search(Common::Allocator& allocator, PPCVM::MachineState* state, uint32_t key, uint32_t base, uint32_t count, uint32_t size, uint32_t compare);
+}
+
+#endif /* defined(__Classix__Sorting__) */
@@ -21,12 +21,15 @@
 
 #include <cstdlib>
 #include <cfloat>
+#include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <deque>
 #include <map>
+#include <unordered_map>
+#include <vector>
 #include <string>
 #include <sstream>
-#include <regex>
 #include <cstring>
 
 #include <dlfcn.h>
@@ -36,9 +39,13 @@
 
 #include "MachineState.h"
 #include "BigEndian.h"
+#include "GuestLayout.h"
+#include "GuestCall.h"
 #include "Structures.h"
 #include "StdCLib.h"
 #include "StdCLibFunctions.h"
+#include "FormatPlan.h"
+#include "Sorting.h"
 #include "SymbolResolver.h"
 #include "NotImplementedException.h"
 #include "Todo.h"
@@ -176,6 +183,7 @@ namespace StdCLib
 	{
 		Scalars scalars;
 		std::deque<PEF::TransitionVector> atExit;
+		std::unordered_map<uint32_t, FormatPlan> formatPlans;
 		Common::Allocator& allocator;
 		
 		static std::map<off_t, std::string> FieldOffsets;
@@ -185,7 +193,7 @@ namespace StdCLib
 		: allocator(*allocator)
 		{
 			memset(&scalars, 0, sizeof scalars);
-			memcpy(&scalars.cType, cTypeCharClasses, sizeof scalars.cType);
+			Common::GuestLayout::CopyToGuest(&scalars.cType, cTypeCharClasses, sizeof scalars.cType);
 			
 			scalars.__p_CType = this->allocator.ToIntPtr(&scalars.cType);
 			
@@ -330,64 +338,179 @@ namespace StdCLib
 		{}
 	};
 	
-	std::string StringPrintF(const std::string& formatString, Globals& globals, const uint32_t* gpr, const double* fpr)
-	{
-		TODO("Handle vararg calls better");
-		std::string doubleTypes = "aAeEfFgG";
-		std::regex rx("%([0-9]+\\$)?(#?)(0?)(-?)( ?)(\\+?)('?)([0-9]?)(\\.[0-9]*)?[hLljtzq]*[diouxXDOUeEfFgGaAcCsSpn]");
-		std::smatch match;
+	// Walks variadic arguments the way the PowerPC calling convention lays them out: words go in r3-r10, then in
+	// the caller's parameter area, and doubles go in f1-f13 while still taking two words. A va_list is simply a
+	// pointer to the next argument in memory.
+	class ArgumentCursor
+	{
+		const Common::Allocator& allocator;
+		const MachineState& state;
+		uint32_t nextWord; // counting from r3
+		uint32_t nextFPR;
+		uint32_t listAddress;
+		
+		ArgumentCursor(const Common::Allocator& allocator, const MachineState& state, uint32_t firstWord, uint32_t listAddress)
+		: allocator(allocator), state(state), nextWord(firstWord), nextFPR(1), listAddress(listAddress)
+		{ }
 		
-		std::stringstream result;
-		std::string::const_iterator lastMatchEnd = formatString.begin();
-		std::string::const_iterator matchStart = formatString.begin();
-		while (std::regex_search(matchStart, formatString.cend(), match, rx))
+		uint32_t ReadWord(uint32_t address) const
 		{
-			matchStart += match.position();
-			result << std::string(lastMatchEnd, matchStart);
-			
-			char* out = nullptr;
-			const std::string& formatSpecifier = match[0].str();
-			auto reverseIter = formatSpecifier.rbegin();
-			if (*reverseIter == 's' || *reverseIter == 'S')
+			return *allocator.ToPointer<const Common::UInt32>(address);
+		}
+		
+	public:
+		static ArgumentCursor FromRegisters(const Common::Allocator& allocator, const MachineState& state, uint32_t firstWord)
+		{
+			return ArgumentCursor(allocator, state, firstWord, 0);
+		}
+		
+		static ArgumentCursor FromList(const Common::Allocator& allocator, const MachineState& state, uint32_t vaList)
+		{
+			return ArgumentCursor(allocator, state, 0, vaList);
+		}
+		
+		uint32_t NextWord()
+		{
+			if (listAddress != 0)
 			{
-				const char* pointer = globals.allocator.ToPointer<char>(*gpr);
-				asprintf(&out, formatSpecifier.c_str(), pointer);
-				gpr++;
+				uint32_t word = ReadWord(listAddress);
+				listAddress += 4;
+				return word;
 			}
-			else if (doubleTypes.find_first_of(*reverseIter) != std::string::npos)
+			
+			uint32_t index = nextWord++;
+			if (index < 8)
+				return state.gpr[3 + index];
+			
+			// the parameter area comes after the 24-bytes linkage area, and has room for the register words too
+			return ReadWord(state.r1 + 24 + index * 4);
+		}
+		
+		uint64_t NextDoubleWord()
+		{
+			uint64_t high = NextWord();
+			return (high << 32) | NextWord();
+		}
+		
+		double NextDouble()
+		{
+			if (listAddress == 0 && nextFPR <= 13)
 			{
-				if (*(reverseIter + 1) == 'L')
-					throw PPCVM::NotImplementedException(__func__, "Long doubles are not supported in format strings");
-				
-				asprintf(&out, formatSpecifier.c_str(), *fpr);
-				fpr++;
+				nextWord += 2;
+				return state.fpr[nextFPR++];
 			}
-			else
+			
+			uint64_t bits = NextDoubleWord();
+			double value;
+			memcpy(&value, &bits, sizeof value);
+			return value;
+		}
+	};
+	
+	const FormatPlan& GetFormatPlan(Globals& globals, uint32_t formatAddress)
+	{
+		std::string format = Common::GuestLayout::ReadString(globals.allocator.ToPointer<const char>(formatAddress));
+		auto iter = globals.formatPlans.find(formatAddress);
+		
+		// the string may have changed since it was parsed (programs sometimes build formats with sprintf)
+		if (iter != globals.formatPlans.end() && iter->second.source == format)
+			return iter->second;
+		
+		FormatPlan& plan = globals.formatPlans[formatAddress];
+		plan = ParseFormat(format.c_str());
+		return plan;
+	}
+	
+	template<typename... TArguments>
+	void AppendFormatted(std::string& into, const char* specifier, TArguments... arguments)
+	{
+		char buffer[64];
+		int length = snprintf(buffer, sizeof buffer, specifier, arguments...);
+		if (length < 0)
+			return;
+		
+		if (static_cast<size_t>(length) < sizeof buffer)
+		{
+			into.append(buffer, length);
+			return;
+		}
+		
+		size_t offset = into.size();
+		into.resize(offset + length + 1);
+		snprintf(&into[offset], length + 1, specifier, arguments...);
+		into.resize(offset + length);
+	}
+	
+	template<typename T>
+	void AppendConversion(std::string& into, const FormatConversion& conversion, const int* stars, T value)
+	{
+		const char* specifier = conversion.specifier.c_str();
+		switch (conversion.starCount)
+		{
+			case 0: AppendFormatted(into, specifier, value); break;
+			case 1: AppendFormatted(into, specifier, stars[0], value); break;
+			default: AppendFormatted(into, specifier, stars[0], stars[1], value); break;
+		}
+	}
+	
+	std::string FormatString(Globals& globals, uint32_t formatAddress, ArgumentCursor& arguments)
+	{
+		const FormatPlan& plan = GetFormatPlan(globals, formatAddress);
+		
+		std::string result;
+		for (const FormatConversion& conversion : plan.conversions)
+		{
+			result += conversion.literal;
+			
+			int stars[2];
+			for (uint8_t i = 0; i < conversion.starCount; i++)
+				stars[i] = static_cast<int32_t>(arguments.NextWord());
+			
+			switch (conversion.argument)
 			{
-				if (*(reverseIter + 1) == 'l' && *(reverseIter + 2) == 'l')
-				{
-					uint64_t argument = ((uint64_t)gpr[0] << 32) | gpr[1];
-					asprintf(&out, formatSpecifier.c_str(), argument);
-					gpr += 2;
-				}
-				else
+				case FormatArgument::Word:
+					AppendConversion(result, conversion, stars, arguments.NextWord());
+					break;
+					
+				case FormatArgument::DoubleWord:
+					AppendConversion(result, conversion, stars, static_cast<unsigned long long>(arguments.NextDoubleWord()));
+					break;
+					
+				case FormatArgument::Double:
+					AppendConversion(result, conversion, stars, arguments.NextDouble());
+					break;
+					
+				case FormatArgument::String:
 				{
-					asprintf(&out, formatSpecifier.c_str(), *gpr);
-					gpr++;
+					uint32_t address = arguments.NextWord();
+					std::string string = address == 0 ? "(null)" : Common::GuestLayout::ReadString(globals.allocator.ToPointer<const char>(address));
+					if (conversion.isPlainString)
+						result += string;
+					else
+						AppendConversion(result, conversion, stars, string.c_str());
+					break;
 				}
+					
+				case FormatArgument::CharCount:
+					*globals.allocator.ToPointer<Common::SInt32>(arguments.NextWord()) = static_cast<int32_t>(result.size());
+					break;
+					
+				case FormatArgument::ByteCharCount:
+					*Common::GuestLayout::Byte(globals.allocator.ToPointer<int8_t>(arguments.NextWord())) = static_cast<int8_t>(result.size());
+					break;
+					
+				case FormatArgument::HalfWordCharCount:
+					*globals.allocator.ToPointer<Common::SInt16>(arguments.NextWord()) = static_cast<int16_t>(result.size());
+					break;
+					
+				case FormatArgument::DoubleWordCharCount:
+					*globals.allocator.ToPointer<Common::SInt64>(arguments.NextWord()) = static_cast<int64_t>(result.size());
+					break;
 			}
-			
-			result << out;
-			free(out);
-			
-			lastMatchEnd = matchStart;
-			matchStart += match.length();
 		}
 		
-		if (matchStart != formatString.end())
-			result << std::string(matchStart, formatString.end());
-		
-		return result.str();
+		result += plan.trailing;
+		return result;
 	}
 }
 
@@ -561,8 +684,8 @@ extern "C"
 
 	void StdCLib__BreakPoint(StdCLib::Globals* globals, MachineState* state)
 	{
-		const char* reason = ToPointer<char>(state->r3);
-		printf("Interrupted by %s", reason);
+		std::string reason = Common::GuestLayout::ReadString(ToPointer<char>(state->r3));
+		printf("Interrupted by %s", reason.c_str());
 		asm("int $3");
 	}
 
@@ -844,7 +967,7 @@ extern "C"
 
 	void StdCLib_bsearch(StdCLib::Globals* globals, MachineState* state)
 	{
-		throw PPCVM::NotImplementedException(__func__);
+		state->r3 = StdCLib::Search(globals->allocator, state, state->r3, state->r4, state->r5, state->r6, state->r7);
 	}
 
 	void StdCLib_calloc(StdCLib::Globals* globals, MachineState* state)
@@ -904,6 +1027,15 @@ extern "C"
 
 	void StdCLib_exit(StdCLib::Globals* globals, MachineState* state)
 	{
+		// last registered, first called; handlers may register more handlers
+		while (globals->atExit.size() != 0)
+		{
+			PEF::TransitionVector vector = globals->atExit.back();
+			globals->atExit.pop_back();
+			PPCVM::Execution::GuestCall handler(globals->allocator, state, vector.EntryPoint, vector.TableOfContents);
+			handler();
+		}
+		
 		state->r3 = ToIntPtr(globals->scalars.__target_for_exit);
 		state->r4 = 1;
 		StdCLib_longjmp(globals, state);
@@ -976,26 +1108,28 @@ extern "C"
 
 	void StdCLib_fgets(StdCLib::Globals* globals, MachineState* state)
 	{
-		char* buffer = ToPointer<char>(state->r3);
 		int32_t size = state->r4;
 		FILE* fptr = MakeFilePtr(globals, state->r5);
 		
-		char* result = fgets(buffer, size, fptr);
-		state->r3 = ToIntPtr(result);
+		std::string buffer(std::max(size, 1), '\0');
+		if (fgets(&buffer[0], size, fptr) == nullptr)
+			state->r3 = 0;
+		else
+			Common::GuestLayout::WriteString(ToPointer<char>(state->r3), buffer.c_str());
 		globals->scalars.errno_ = errno;
 	}
 
 	void StdCLib_fopen(StdCLib::Globals* globals, MachineState* state)
 	{
-		const char* filename = ToPointer<const char>(state->r3);
-		const char* mode = ToPointer<const char>(state->r4);
+		std::string filename = Common::GuestLayout::ReadString(ToPointer<const char>(state->r3));
+		std::string mode = Common::GuestLayout::ReadString(ToPointer<const char>(state->r4));
 		
 		for (int i = 0; i < StdCLib::NFILE; i++)
 		{
 			auto& ioBuffer = globals->scalars._iob[i];
 			if (ioBuffer.fptr == nullptr)
 			{
-				ioBuffer.fptr = fopen(filename, mode);
+				ioBuffer.fptr = fopen(filename.c_str(), mode.c_str());
 				state->r3 = ToIntPtr(&ioBuffer);
 				globals->scalars.errno_ = errno;
 				return;
@@ -1009,9 +1143,9 @@ extern "C"
 	void StdCLib_fprintf(StdCLib::Globals* globals, MachineState* state)
 	{
 		FILE* fptr = MakeFilePtr(globals, state->r3);
-		const char* formatString = ToPointer<const char>(state->r4);
-		// gah, let's just print the format string for now.
-		state->r3 = fputs(formatString, fptr);
+		auto arguments = StdCLib::ArgumentCursor::FromRegisters(globals->allocator, *state, 2);
+		std::string toPrint = StdCLib::FormatString(*globals, state->r4, arguments);
+		state->r3 = static_cast<uint32_t>(fwrite(toPrint.data(), 1, toPrint.size(), fptr));
 		globals->scalars.errno_ = errno;
 	}
 
@@ -1145,8 +1279,8 @@ extern "C"
 	# error This will break in 64 bits because getenv() will return a value out of the address space
 	#endif
 		
-		const char* name = ToPointer<const char>(state->r3);
-		char* env = getenv(name);
+		std::string name = Common::GuestLayout::ReadString(ToPointer<const char>(state->r3));
+		char* env = getenv(name.c_str());
 		state->r3 = ToIntPtr(env);
 		globals->scalars.errno_ = errno;
 	}
@@ -1355,7 +1489,7 @@ extern "C"
 		const void* s1 = ToPointer<const void>(state->r3);
 		const void* s2 = ToPointer<const void>(state->r4);
 		size_t size = state->r5;
-		state->r3 = memcmp(s1, s2, size);
+		state->r3 = Common::GuestLayout::Compare(s1, s2, size);
 	}
 
 	void StdCLib_memcpy(StdCLib::Globals* globals, MachineState* state)
@@ -1363,7 +1497,7 @@ extern "C"
 		void* s1 = ToPointer<void>(state->r3);
 		const void* s2 = ToPointer<const void>(state->r4);
 		size_t size = state->r5;
-		state->r3 = ToIntPtr(memcpy(s1, s2, size));
+		Common::GuestLayout::Move(s1, s2, size);
 	}
 
 	void StdCLib_memmove(StdCLib::Globals* globals, MachineState* state)
@@ -1468,9 +1602,9 @@ extern "C"
 
 	void StdCLib_printf(StdCLib::Globals* globals, MachineState* state)
 	{
-		const char* formatString = ToPointer<const char>(state->r3);
-		std::string toPrint = StdCLib::StringPrintF(formatString, *globals, state->gpr + 4, state->fpr);
-		state->r3 = printf("%s", toPrint.c_str());
+		auto arguments = StdCLib::ArgumentCursor::FromRegisters(globals->allocator, *state, 1);
+		std::string toPrint = StdCLib::FormatString(*globals, state->r3, arguments);
+		state->r3 = static_cast<uint32_t>(fwrite(toPrint.data(), 1, toPrint.size(), stdout));
 		globals->scalars.errno_ = errno;
 	}
 
@@ -1486,8 +1620,8 @@ extern "C"
 
 	void StdCLib_puts(StdCLib::Globals* globals, MachineState* state)
 	{
-		const char* address = ToPointer<const char>(state->r3);
-		state->r3 = puts(address);
+		std::string string = Common::GuestLayout::ReadString(ToPointer<const char>(state->r3));
+		state->r3 = puts(string.c_str());
 		globals->scalars.errno_ = errno;
 	}
 
@@ -1498,7 +1632,7 @@ extern "C"
 
 	void StdCLib_qsort(StdCLib::Globals* globals, MachineState* state)
 	{
-		throw PPCVM::NotImplementedException(__func__);
+		StdCLib::Sort(globals->allocator, state, state->r3, state->r4, state->r5, state->r6);
 	}
 
 	void StdCLib_raise(StdCLib::Globals* globals, MachineState* state)
@@ -1588,7 +1722,11 @@ extern "C"
 
 	void StdCLib_sprintf(StdCLib::Globals* globals, MachineState* state)
 	{
-		throw PPCVM::NotImplementedException(__func__);
+		char* buffer = ToPointer<char>(state->r3);
+		auto arguments = StdCLib::ArgumentCursor::FromRegisters(globals->allocator, *state, 2);
+		std::string result = StdCLib::FormatString(*globals, state->r4, arguments);
+		Common::GuestLayout::WriteString(buffer, result);
+		state->r3 = static_cast<uint32_t>(result.size());
 	}
 
 	void StdCLib_srand(StdCLib::Globals* globals, MachineState* state)
@@ -1608,15 +1746,18 @@ extern "C"
 
 	void StdCLib_strchr(StdCLib::Globals* globals, MachineState* state)
 	{
-		const char* s = ToPointer<const char>(state->r3);
-		state->r3 = ToIntPtr(strchr(s, state->r4));
+		// like strchr, finding the null finds the end of the string
+		std::string s = Common::GuestLayout::ReadString(ToPointer<const char>(state->r3));
+		char c = static_cast<char>(state->r4);
+		size_t index = c == 0 ? s.size() : s.find(c);
+		state->r3 = index == std::string::npos ? 0 : state->r3 + static_cast<uint32_t>(index);
 	}
 
 	void StdCLib_strcmp(StdCLib::Globals* globals, MachineState* state)
 	{
-		const char* s1 = ToPointer<const char>(state->r3);
-		const char* s2 = ToPointer<const char>(state->r4);
-		state->r3 = strcmp(s1, s2);
+		std::string s1 = Common::GuestLayout::ReadString(ToPointer<const char>(state->r3));
+		std::string s2 = Common::GuestLayout::ReadString(ToPointer<const char>(state->r4));
+		state->r3 = s1.compare(s2);
 	}
 
 	void StdCLib_strcoll(StdCLib::Globals* globals, MachineState* state)
@@ -1627,8 +1768,8 @@ extern "C"
 	void StdCLib_strcpy(StdCLib::Globals* globals, MachineState* state)
 	{
 		char* s1 = ToPointer<char>(state->r3);
-		const char* s2 = ToPointer<const char>(state->r4);
-		state->r3 = ToIntPtr(strcpy(s1, s2));
+		std::string s2 = Common::GuestLayout::ReadString(ToPointer<const char>(state->r4));
+		Common::GuestLayout::WriteString(s1, s2);
 	}
 
 	void StdCLib_strcspn(StdCLib::Globals* globals, MachineState* state)
@@ -1648,8 +1789,8 @@ extern "C"
 
 	void StdCLib_strlen(StdCLib::Globals* globals, MachineState* state)
 	{
-		char* s = ToPointer<char>(state->r3);
-		state->r3 = strlen(s);
+		const char* s = ToPointer<const char>(state->r3);
+		state->r3 = static_cast<uint32_t>(Common::GuestLayout::StringLength(s));
 	}
 
 	void StdCLib_strncat(StdCLib::Globals* globals, MachineState* state)
@@ -1674,10 +1815,10 @@ extern "C"
 
 	void StdCLib_strrchr(StdCLib::Globals* globals, MachineState* state)
 	{
-		const char* s = ToPointer<const char>(state->r3);
-		int c = state->r4;
-		char* result = strrchr(s, c);
-		state->r3 = ToIntPtr(result);
+		std::string s = Common::GuestLayout::ReadString(ToPointer<const char>(state->r3));
+		char c = static_cast<char>(state->r4);
+		size_t index = c == 0 ? s.size() : s.rfind(c);
+		state->r3 = index == std::string::npos ? 0 : state->r3 + static_cast<uint32_t>(index);
 	}
 
 	void StdCLib_strspn(StdCLib::Globals* globals, MachineState* state)
@@ -1797,17 +1938,28 @@ extern "C"
 
 	void StdCLib_vfprintf(StdCLib::Globals* globals, MachineState* state)
 	{
-		throw PPCVM::NotImplementedException(__func__);
+		FILE* fptr = MakeFilePtr(globals, state->r3);
+		auto arguments = StdCLib::ArgumentCursor::FromList(globals->allocator, *state, state->r5);
+		std::string toPrint = StdCLib::FormatString(*globals, state->r4, arguments);
+		state->r3 = static_cast<uint32_t>(fwrite(toPrint.data(), 1, toPrint.size(), fptr));
+		globals->scalars.errno_ = errno;
 	}
 
 	void StdCLib_vprintf(StdCLib::Globals* globals, MachineState* state)
 	{
-		throw PPCVM::NotImplementedException(__func__);
+		auto arguments = StdCLib::ArgumentCursor::FromList(globals->allocator, *state, state->r4);
+		std::string toPrint = StdCLib::FormatString(*globals, state->r3, arguments);
+		state->r3 = static_cast<uint32_t>(fwrite(toPrint.data(), 1, toPrint.size(), stdout));
+		globals->scalars.errno_ = errno;
 	}
 
 	void StdCLib_vsprintf(StdCLib::Globals* globals, MachineState* state)
 	{
-		throw PPCVM::NotImplementedException(__func__);
+		char* buffer = ToPointer<char>(state->r3);
+		auto arguments = StdCLib::ArgumentCursor::FromList(globals->allocator, *state, state->r5);
+		std::string result = StdCLib::FormatString(*globals, state->r4, arguments);
+		Common::GuestLayout::WriteString(buffer, result);
+		state->r3 = static_cast<uint32_t>(result.size());
 	}
 
 	void StdCLib_wcstombs(StdCLib::Globals* globals, MachineState* state)
@@ -0,0 +1,142 @@
+//
+// FormatPlanTests.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+#include "UnitTest.h"
+#include "FormatPlan.h"
+#include "NotImplementedException.h"
+
+using namespace StdCLib;
+
+namespace
+{
+	// the plan of a format string with a single conversion
+	FormatConversion ParseOne(const char* format)
+	{
+		FormatPlan plan = ParseFormat(format);
+		CHECK_EQUAL(plan.conversions.size(), 1u);
+		return plan.conversions.empty() ? FormatConversion() : plan.conversions[0];
+	}
+	
+	bool Throws(const char* format)
+	{
+		try
+		{
+			ParseFormat(format);
+			return false;
+		}
+		catch (PPCVM::NotImplementedException&)
+		{
+			return true;
+		}
+	}
+}
+
+TEST(FormatPlan, SplitsLiteralsAndConversions)
+{
+	FormatPlan plan = ParseFormat("a=%d, b=%s; 100%% done\n");
+	CHECK_EQUAL(plan.source, std::string("a=%d, b=%s; 100%% done\n"));
+	CHECK_EQUAL(plan.conversions.size(), 2u);
+	if (plan.conversions.size() == 2)
+	{
+		CHECK_EQUAL(plan.conversions[0].literal, std::string("a="));
+		CHECK_EQUAL(plan.conversions[0].specifier, std::string("%d"));
+		CHECK(plan.conversions[0].argument == FormatArgument::Word);
+		CHECK_EQUAL(plan.conversions[1].literal, std::string(", b="));
+		CHECK(plan.conversions[1].argument == FormatArgument::String);
+		CHECK(plan.conversions[1].isPlainString);
+	}
+	CHECK_EQUAL(plan.trailing, std::string("; 100% done\n"));
+}
+
+TEST(FormatPlan, KeepsFlagsWidthAndPrecision)
+{
+	FormatConversion conversion = ParseOne("%-+ #0'12.5x");
+	CHECK_EQUAL(conversion.specifier, std::string("%-+ #0'12.5x"));
+	CHECK_EQUAL(conversion.starCount, 0);
+	
+	conversion = ParseOne("%*.*f");
+	CHECK_EQUAL(conversion.specifier, std::string("%*.*f"));
+	CHECK_EQUAL(conversion.starCount, 2);
+	CHECK(conversion.argument == FormatArgument::Double);
+	
+	conversion = ParseOne("%.*s");
+	CHECK_EQUAL(conversion.starCount, 1);
+	CHECK(!conversion.isPlainString);
+}
+
+TEST(FormatPlan, RewritesLengthModifiersForTheHost)
+{
+	// guest longs are 32 bits wide
+	FormatConversion conversion = ParseOne("%ld");
+	CHECK_EQUAL(conversion.specifier, std::string("%d"));
+	CHECK(conversion.argument == FormatArgument::Word);
+	
+	conversion = ParseOne("%zu");
+	CHECK_EQUAL(conversion.specifier, std::string("%u"));
+	
+	conversion = ParseOne("%hhx");
+	CHECK_EQUAL(conversion.specifier, std::string("%hhx"));
+	CHECK(conversion.argument == FormatArgument::Word);
+	
+	conversion = ParseOne("%hd");
+	CHECK_EQUAL(conversion.specifier, std::string("%hd"));
+	
+	for (const char* format : { "%lld", "%qd", "%jd" })
+	{
+		conversion = ParseOne(format);
+		CHECK_EQUAL(conversion.specifier, std::string("%lld"));
+		CHECK(conversion.argument == FormatArgument::DoubleWord);
+	}
+	
+	conversion = ParseOne("%D");
+	CHECK_EQUAL(conversion.specifier, std::string("%d"));
+	
+	conversion = ParseOne("%8p");
+	CHECK_EQUAL(conversion.specifier, std::string("%#8x"));
+	
+	conversion = ParseOne("%lc");
+	CHECK_EQUAL(conversion.specifier, std::string("%c"));
+}
+
+TEST(FormatPlan, CharCountsHonorLengthModifiers)
+{
+	CHECK(ParseOne("%n").argument == FormatArgument::CharCount);
+	CHECK(ParseOne("%ln").argument == FormatArgument::CharCount);
+	CHECK(ParseOne("%hhn").argument == FormatArgument::ByteCharCount);
+	CHECK(ParseOne("%hn").argument == FormatArgument::HalfWordCharCount);
+	CHECK(ParseOne("%lln").argument == FormatArgument::DoubleWordCharCount);
+	CHECK(ParseOne("%qn").argument == FormatArgument::DoubleWordCharCount);
+	CHECK(ParseOne("%jn").argument == FormatArgument::DoubleWordCharCount);
+}
+
+TEST(FormatPlan, PrintsUnknownConversionsAsIs)
+{
+	FormatPlan plan = ParseFormat("x%ky%");
+	CHECK(plan.conversions.empty());
+	CHECK_EQUAL(plan.trailing, std::string("x%ky%"));
+}
+
+TEST(FormatPlan, RejectsWhatItCannotFormat)
+{
+	CHECK(Throws("%1$d"));
+	CHECK(Throws("%Lf"));
+	CHECK(!Throws("%Ld"));
+}
@@ -0,0 +1,222 @@
+//
+// SortingTests.cpp
+// Classix
+//
+// Copyright (C) 2013 Félix Cloutier
+//
+// This file is part of Classix.
+//
+// Classix is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// Classix is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// Classix. If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include <new>
+#include <vector>
+#include "UnitTest.h"
+#include "GuestMachine.h"
+#include "NativeCall.h"
+#include "Sorting.h"
+
+using namespace Encode;
+using PPCVM::Execution::NativeCall;
+
+namespace
+{
+	// what the native calls below get as their globals
+	struct Context
+	{
+		Common::Allocator* allocator;
+	};
+	
+	// qsort(r3 = base, r4 = count, r5 = size, r6 = compare)
+	void QSort(void* globals, PPCVM::MachineState* state)
+	{
+		Context* context = static_cast<Context*>(globals);
+		StdCLib::Sort(*context->allocator, state, state->r3, state->r4, state->r5, state->r6);
+	}
+	
+	// bsearch(r3 = key, r4 = base, r5 = count, r6 = size, r7 = compare)
+	void BSearch(void* globals, PPCVM::MachineState* state)
+	{
+		Context* context = static_cast<Context*>(globals);
+		state->r3 = StdCLib::Search(*context->allocator, state, state->r3, state->r4, state->r5, state->r6, state->r7);
+	}
+	
+	const uint32_t CompareOffset = 0x24;
+	const uint32_t VectorOffset = 0x100;
+	const uint32_t KeyOffset = 0x110;
+	const uint32_t ArrayOffset = 0x400;
+	
+	// Elements are a key and a tag, and the comparator only looks at the key. The native calls run with their
+	// arguments already in place, and main calls them through r12 like any imported function.
+	struct SortingMachine
+	{
+		GuestMachine machine;
+		Context* context;
+		uint32_t qsort;
+		uint32_t bsearch;
+		uint32_t compare;
+		
+		SortingMachine()
+		{
+			Common::Allocator& allocator = machine.allocator;
+			context = reinterpret_cast<Context*>(allocator.Allocate("Sorting context", sizeof(Context)));
+			context->allocator = &allocator;
+			qsort = MakeCall("qsort", QSort);
+			bsearch = MakeCall("bsearch", BSearch);
+			
+			machine.DataWord(VectorOffset) = machine.code + CompareOffset;
+			machine.DataWord(VectorOffset + 4) = machine.data;
+			compare = machine.data + VectorOffset;
+		}
+		
+		uint32_t MakeCall(const char* name, PPCVM::Execution::NativeCallback& callback)
+		{
+			Common::Allocator& allocator = machine.allocator;
+			uint8_t* callMemory = allocator.Allocate(name, sizeof(NativeCall));
+			new (callMemory) NativeCall(callback);
+			return allocator.ToIntPtr(callMemory);
+		}
+		
+		void Load(uint32_t call)
+		{
+			machine.Load({
+				// main
+				Mfspr(0, 8),			// mflr r0
+				D(36, 0, 1, 8),			// stw r0, 8(r1)
+				D(37, 1, 1, -64),		// stwu r1, -64(r1)
+				Mtspr(9, 12),			// mtctr r12
+				Bctrl,					// bctrl
+				D(14, 1, 1, 64),		// addi r1, r1, 64
+				D(32, 0, 1, 8),			// lwz r0, 8(r1)
+				Mtspr(8, 0),			// mtlr r0
+				Blr,
+				// compare
+				D(32, 5, 3, 0),			// lwz r5, 0(r3)
+				D(32, 6, 4, 0),			// lwz r6, 0(r4)
+				XO(40, 3, 6, 5, false, false), // subf r3, r6, r5
+				Blr,
+			});
+			
+			machine.state.r2 = machine.allocator.ToIntPtr(context);
+			machine.state.r12 = call;
+			machine.state.r31 = 0x31;
+		}
+		
+		uint32_t Key(uint32_t index)
+		{
+			return machine.DataWord(ArrayOffset + index * 8);
+		}
+		
+		uint32_t Tag(uint32_t index)
+		{
+			return machine.DataWord(ArrayOffset + index * 8 + 4);
+		}
+		
+		// keys 0, 2, 4... so that odd keys are missing
+		void FillSorted(uint32_t count)
+		{
+			for (uint32_t i = 0; i < count; i++)
+			{
+				machine.DataWord(ArrayOffset + i * 8) = i * 2;
+				machine.DataWord(ArrayOffset + i * 8 + 4) = i;
+			}
+		}
+		
+		uint32_t Search(uint32_t key, uint32_t count)
+		{
+			Load(bsearch);
+			machine.DataWord(KeyOffset) = key;
+			machine.state.r3 = machine.data + KeyOffset;
+			machine.state.r4 = machine.data + ArrayOffset;
+			machine.state.r5 = count;
+			machine.state.r6 = 8;
+			machine.state.r7 = compare;
+			machine.Run();
+			return machine.state.r3;
+		}
+	};
+}
+
+TEST(Sorting, QSortCallsTheGuestComparator)
+{
+	const uint32_t count = 200;
+	SortingMachine sorting;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		sorting.machine.DataWord(ArrayOffset + i * 8) = (i * 37) % 50;
+		sorting.machine.DataWord(ArrayOffset + i * 8 + 4) = i;
+	}
+	
+	sorting.Load(sorting.qsort);
+	uint32_t stackPointer = sorting.machine.state.r1;
+	sorting.machine.state.r3 = sorting.machine.data + ArrayOffset;
+	sorting.machine.state.r4 = count;
+	sorting.machine.state.r5 = 8;
+	sorting.machine.state.r6 = sorting.compare;
+	sorting.machine.Run();
+	
+	// sorted, and every element is still whole
+	std::vector<bool> seen(count);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (i > 0)
+			CHECK(sorting.Key(i - 1) <= sorting.Key(i));
+		
+		uint32_t tag = sorting.Tag(i);
+		CHECK(tag < count && !seen[tag]);
+		CHECK_EQUAL(sorting.Key(i), (tag * 37) % 50);
+		if (tag < count)
+			seen[tag] = true;
+	}
+	
+	// and the comparator calls left no trace
+	CHECK_EQUAL(sorting.machine.state.r1, stackPointer);
+	CHECK_EQUAL(sorting.machine.state.r2, sorting.machine.allocator.ToIntPtr(sorting.context));
+	CHECK_EQUAL(sorting.machine.state.r31, 0x31u);
+}
+
+TEST(Sorting, QSortLeavesShortArraysAlone)
+{
+	SortingMachine sorting;
+	sorting.machine.DataWord(ArrayOffset) = 7;
+	sorting.Load(sorting.qsort);
+	sorting.machine.state.r3 = sorting.machine.data + ArrayOffset;
+	sorting.machine.state.r4 = 1;
+	sorting.machine.state.r5 = 8;
+	sorting.machine.state.r6 = sorting.compare;
+	sorting.machine.Run();
+	CHECK_EQUAL(sorting.Key(0), 7u);
+}
+
+TEST(Sorting, BSearchFindsPresentKeys)
+{
+	SortingMachine sorting;
+	sorting.FillSorted(100);
+	for (uint32_t i = 0; i < 100; i += 9)
+		CHECK_EQUAL(sorting.Search(i * 2, 100), sorting.machine.data + ArrayOffset + i * 8);
+	
+	// both ends
+	CHECK_EQUAL(sorting.Search(0, 100), sorting.machine.data + ArrayOffset);
+	CHECK_EQUAL(sorting.Search(198, 100), sorting.machine.data + ArrayOffset + 99 * 8);
+	CHECK_EQUAL(sorting.machine.state.r31, 0x31u);
+}
+
+TEST(Sorting, BSearchReturnsNullForMissingKeys)
+{
+	SortingMachine sorting;
+	sorting.FillSorted(100);
+	CHECK_EQUAL(sorting.Search(11, 100), 0u);
+	CHECK_EQUAL(sorting.Search(199, 100), 0u);
+	CHECK_EQUAL(sorting.Search(0, 0), 0u);
+}